@@ -28,6 +28,7 @@
 #include "vmime/text.hpp"
 
 #include "vmime/utility/random.hpp"
+#include "vmime/utility/sync/autoLock.hpp"
 
 #include "vmime/utility/seekableInputStreamRegionAdapter.hpp"
 #include "vmime/utility/outputStreamAdapter.hpp"
@@ -37,14 +38,258 @@
 #include "vmime/emptyContentHandler.hpp"
 #include "vmime/stringContentHandler.hpp"
 #include "vmime/streamContentHandler.hpp"
+#include "vmime/cachedContentHandler.hpp"
+
+#include "vmime/headerFieldFactory.hpp"
+#include "vmime/platform.hpp"
+
+#include "vmime/utility/encoder/encoderFactory.hpp"
+#include "vmime/utility/windowedInputStream.hpp"
 
 
 namespace vmime
 {
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+
+// View of the region of a stream which contains a part, so that the part
+// can be parsed on another thread: data is fetched from the stream under a
+// lock shared by all the views of the stream. The part keeps referencing
+// the stream through this view, instead of a copy of its contents.
+class partStreamView : public utility::windowedInputStream
+{
+public:
+
+	partStreamView(shared_ptr <utility::seekableInputStream> stream,
+	               const size_t begin, const size_t length,
+	               shared_ptr <utility::sync::criticalSection> lock)
+		: windowedInputStream(length), m_stream(stream), m_begin(begin),
+		  m_length(length), m_lock(lock)
+	{
+		setWindowSize(64 * 1024);
+		setMaxReadAhead(256 * 1024);
+		setCachedWindowCount(2);
+	}
+
+protected:
+
+	void fetch(const size_t offset, const size_t length, string& data)
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		const size_t count = std::min(length, m_length - std::min(offset, m_length));
+
+		data.resize(count);
+
+		m_stream->seek(m_begin + offset);
+
+		size_t total = 0;
+
+		while (total < count && !m_stream->eof())
+		{
+			const size_t n = m_stream->read
+				(reinterpret_cast <byte_t*>(&data[total]), count - total);
+
+			if (n == 0)
+				break;
+
+			total += n;
+		}
+
+		data.resize(total);
+	}
+
+private:
+
+	shared_ptr <utility::seekableInputStream> m_stream;
+	const size_t m_begin;
+	const size_t m_length;
+
+	shared_ptr <utility::sync::criticalSection> m_lock;
+};
+
+
+// Parts of a multipart body which are parsed on a pool of threads
+class partParsingQueue : public object
+{
+public:
+
+	struct job
+	{
+		shared_ptr <bodyPart> part;
+		shared_ptr <partStreamView> stream;
+		size_t start;
+		size_t end;
+		bool failed;
+	};
+
+	partParsingQueue(const parsingContext& ctx)
+		: m_ctx(ctx), m_next(0),
+		  m_lock(platform::getHandler()->createCriticalSection()),
+		  m_streamLock(platform::getHandler()->createCriticalSection())
+	{
+		// Parts are not split further on other threads
+		m_ctx.setParallelParsingThreadCount(0);
+	}
+
+	void addJob(shared_ptr <bodyPart> part, shared_ptr <utility::parserInputStreamAdapter> parser,
+	            const size_t start, const size_t end)
+	{
+		m_jobs.push_back(job());
+
+		job& j = m_jobs.back();
+		j.part = part;
+		j.stream = make_shared <partStreamView>
+			(parser->getUnderlyingStream(), start, end - start, m_streamLock);
+		j.start = start;
+		j.end = end;
+		j.failed = false;
+	}
+
+	size_t getJobCount() const
+	{
+		return m_jobs.size();
+	}
+
+	job& getJobAt(const size_t index)
+	{
+		return m_jobs[index];
+	}
+
+	// Parse jobs until the queue is empty
+	void processJobs()
+	{
+		for (job* j = nextJob() ; j != NULL ; j = nextJob())
+		{
+			try
+			{
+				j->part->parse(m_ctx, j->stream, 0, j->end - j->start, NULL);
+			}
+			catch (...)
+			{
+				// Part will be parsed again on the calling thread
+				j->failed = true;
+			}
+
+			// Only keep the most recently used data in memory
+			j->stream->setCachedWindowCount(1);
+		}
+	}
+
+private:
+
+	job* nextJob()
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		if (m_next >= m_jobs.size())
+			return NULL;
+
+		return &m_jobs[m_next++];
+	}
+
+
+	parsingContext m_ctx;
+
+	std::vector <job> m_jobs;
+	size_t m_next;
+
+	shared_ptr <utility::sync::criticalSection> m_lock;
+	shared_ptr <utility::sync::criticalSection> m_streamLock;
+};
+
+
+class partParsingWorker : public utility::sync::runnable
+{
+public:
+
+	partParsingWorker(shared_ptr <partParsingQueue> queue)
+		: m_queue(queue)
+	{
+	}
+
+	void run()
+	{
+		m_queue->processJobs();
+	}
+
+private:
+
+	shared_ptr <partParsingQueue> m_queue;
+};
+
+
+// Checks whether the data written to it can be sent as "8bit" (RFC-6152):
+// no NUL characters, CRLF line endings only, and lines no longer than the
+// SMTP limit
+class eightBitCheckOutputStream : public utility::outputStream
+{
+public:
+
+	eightBitCheckOutputStream()
+		: m_lineLength(0), m_prevCR(false), m_safe(true)
+	{
+	}
+
+	bool isSafe() const
+	{
+		return m_safe && !m_prevCR;
+	}
+
+	void flush()
+	{
+		// Nothing to do
+	}
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count)
+	{
+		for (size_t i = 0 ; m_safe && i < count ; ++i)
+		{
+			const byte_t c = data[i];
+
+			if (m_prevCR)
+			{
+				// Bare CR
+				if (c != '\n')
+					m_safe = false;
+
+				m_prevCR = false;
+				m_lineLength = 0;
+			}
+			else if (c == '\r')
+			{
+				m_prevCR = true;
+			}
+			else if (c == '\n' || c == '\0' || ++m_lineLength > lineLengthLimits::max)
+			{
+				// Bare LF, NUL or line too long
+				m_safe = false;
+			}
+		}
+	}
+
+private:
+
+	size_t m_lineLength;
+	bool m_prevCR;
+	bool m_safe;
+};
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
 body::body()
-	: m_contents(make_shared <emptyContentHandler>())
+	: m_contents(make_shared <emptyContentHandler>()), m_eightBitSafe(false)
 {
 }
 
@@ -54,81 +299,94 @@ body::~body()
 }
 
 
-// static
 size_t body::findNextBoundaryPosition
 	(shared_ptr <utility::parserInputStreamAdapter> parser, const string& boundary,
 	 const size_t position, const size_t end,
 	 size_t* boundaryStart, size_t* boundaryEnd)
 {
-	size_t pos = position;
+	// Bytes before the search position which are needed to recognize
+	// a boundary: "[CR]LF--", and transport padding
+	static const size_t CONTEXT_SIZE = 64;
+
+	// Search in chunks of growing size, so that close boundaries
+	// are found without reading much data
+	size_t chunkSize = 4096;
 
-	while (pos != npos && pos < end)
+	for (size_t pos = position ; pos < end ; )
 	{
-		pos = parser->findNext(boundary, pos);
+		const size_t searchEnd = std::min(end, pos + chunkSize);
+
+		const size_t chunkStart = (pos >= CONTEXT_SIZE) ? pos - CONTEXT_SIZE : 0;
+		// Also read the byte which follows a boundary ending at 'searchEnd'
+		const size_t chunkEnd = searchEnd + boundary.length() + 1;
 
-		if (pos == npos)
-			break;  // not found
+		const string chunk = parser->extract(chunkStart, chunkEnd);
 
-		if (pos != 0)
+		size_t start, stop;
+		const size_t found = findBoundaryInBuffer(chunk, boundary, pos - chunkStart, &start, &stop);
+
+		if (found != npos && chunkStart + found < searchEnd)
 		{
-			// Skip transport padding bytes (SPACE or HTAB), if any
-			size_t advance = 0;
+			*boundaryStart = chunkStart + start;
+			*boundaryEnd = chunkStart + stop;
 
-			while (pos != 0)
-			{
-				parser->seek(pos - advance - 1);
+			return chunkStart + found;
+		}
 
-				const byte_t c = parser->peekByte();
+		pos = searchEnd;
 
-				if (c == ' ' || c == '\t')
-					++advance;
-				else
-					break;
-			}
+		if (chunkSize < 1024 * 1024)
+			chunkSize *= 2;
+	}
 
-			// Ensure the bytes before boundary are "[LF]--": boundary should be
-			// at the beginning of a line, and should start with "--"
-			if (pos - advance >= 3)
-			{
-				parser->seek(pos - advance - 3);
+	return npos;
+}
 
-				if (parser->matchBytes("\n--", 3))
-				{
-					parser->seek(pos + boundary.length());
 
-					const byte_t next = parser->peekByte();
+// static
+size_t body::findBoundaryInBuffer
+	(const string& buffer, const string& boundary, const size_t position,
+	 size_t* boundaryStart, size_t* boundaryEnd)
+{
+	size_t pos = position;
 
-					// Boundary should be followed by a new line or a dash
-					if (next == '\r' || next == '\n' || next == '-')
-					{
-						// Get rid of the "[CR]" just before "[LF]--", if any
-						if (pos - advance >= 4)
-						{
-							parser->seek(pos - advance - 4);
+	while ((pos = buffer.find(boundary, pos)) != string::npos)
+	{
+		// Skip transport padding bytes (SPACE or HTAB), if any
+		size_t start = pos;
 
-							if (parser->peekByte() == '\r')
-								advance++;
-						}
+		while (start != 0 && (buffer[start - 1] == ' ' || buffer[start - 1] == '\t'))
+			--start;
 
-						*boundaryStart = pos - advance - 3;
-						*boundaryEnd = pos + boundary.length();
+		// Boundary should be at the beginning of a line, should start
+		// with "--", and should be followed by a new line or a dash
+		const size_t next = pos + boundary.length();
 
-						return pos;
-					}
-				}
-			}
+		if (start >= 3 && buffer.compare(start - 3, 3, "\n--") == 0 && next < buffer.length() &&
+		    (buffer[next] == '\r' || buffer[next] == '\n' || buffer[next] == '-'))
+		{
+			start -= 3;
+
+			// Get rid of the "[CR]" just before "[LF]--", if any
+			if (start != 0 && buffer[start - 1] == '\r')
+				--start;
+
+			*boundaryStart = start;
+			*boundaryEnd = next;
+
+			return pos;
 		}
 
 		// Boundary is a prefix of another, continue the search
-		pos++;
+		++pos;
 	}
 
-	return pos;
+	return npos;
 }
 
 
 void body::parseImpl
-	(const parsingContext& /* ctx */,
+	(const parsingContext& ctx,
 	 shared_ptr <utility::parserInputStreamAdapter> parser,
 	 const size_t position, const size_t end, size_t* newPosition)
 {
@@ -247,6 +505,13 @@ void body::parseImpl
 
 		bool lastPart = false;
 
+		// Large parts are parsed on other threads once all the
+		// boundaries have been found
+		shared_ptr <partParsingQueue> parallelParts;
+
+		if (ctx.getParallelParsingThreadCount() != 0)
+			parallelParts = make_shared <partParsingQueue>(ctx);
+
 		// Find the first boundary
 		size_t boundaryStart, boundaryEnd;
 		pos = findNextBoundaryPosition(parser, boundary, pos, end, &boundaryStart, &boundaryEnd);
@@ -304,7 +569,10 @@ void body::parseImpl
 				if (partEnd < partStart)
 					std::swap(partStart, partEnd);
 
-				part->parse(parser, partStart, partEnd, NULL);
+				if (parallelParts && partEnd - partStart >= ctx.getParallelParsingThreshold())
+					parallelParts->addJob(part, parser, partStart, partEnd);
+				else
+					part->parse(ctx, parser, partStart, partEnd, NULL);
 
 				m_parts.push_back(part);
 			}
@@ -325,7 +593,7 @@ void body::parseImpl
 
 			try
 			{
-				part->parse(parser, partStart, end);
+				part->parse(ctx, parser, partStart, end);
 			}
 			catch (std::exception&)
 			{
@@ -342,6 +610,64 @@ void body::parseImpl
 
 			m_epilogText = text.getWholeBuffer();
 		}
+
+		if (parallelParts && parallelParts->getJobCount() != 0)
+		{
+			// Make sure shared instances are created before threads are started
+			headerFieldFactory::getInstance();
+			utility::encoder::encoderFactory::getInstance();
+			parsingContext::getDefaultContext();
+
+			// The calling thread also parses parts
+			const size_t threadCount =
+				std::min(ctx.getParallelParsingThreadCount(), parallelParts->getJobCount()) - 1;
+
+			std::vector <shared_ptr <utility::sync::thread> > threads;
+
+			try
+			{
+				for (size_t i = 0 ; i < threadCount ; ++i)
+				{
+					shared_ptr <utility::sync::thread> thread =
+						platform::getHandler()->createThread
+							(make_shared <partParsingWorker>(parallelParts));
+
+					// Threads not supported by the platform handler
+					if (!thread)
+						break;
+
+					threads.push_back(thread);
+				}
+			}
+			catch (exceptions::system_error&)
+			{
+				// Continue with the threads already started
+			}
+
+			parallelParts->processJobs();
+
+			for (size_t i = 0 ; i < threads.size() ; ++i)
+				threads[i]->join();
+
+			for (size_t i = 0, n = parallelParts->getJobCount() ; i < n ; ++i)
+			{
+				partParsingQueue::job& j = parallelParts->getJobAt(i);
+
+				if (j.failed)
+				{
+					// Parse again to report the error on this thread
+					parsingContext partCtx(ctx);
+					partCtx.setParallelParsingThreadCount(0);
+
+					j.part->parse(partCtx, parser, j.start, j.end, NULL);
+				}
+				else
+				{
+					// Parsed bounds are relative to the view of the part
+					j.part->offsetParsedBounds(j.start);
+				}
+			}
+		}
 	}
 	// Treat the contents as 'simple' data
 	else
@@ -489,15 +815,21 @@ void body::generateImpl
 	// Simple body
 	else
 	{
-		// Generate the contents
-		shared_ptr <contentHandler> contents = m_contents->clone();
-		contents->setContentTypeHint(getContentType());
-
-		contents->generate(os, getEncoding(), ctx.getMaxLineLength());
+		generateContents(ctx, os, getGeneratedEncoding(ctx));
 	}
 }
 
 
+void body::generateContents
+	(const generationContext& ctx, utility::outputStream& os, const encoding& enc) const
+{
+	shared_ptr <contentHandler> contents = m_contents->clone();
+	contents->setContentTypeHint(getContentType());
+
+	contents->generate(os, enc, ctx.getMaxLineLength());
+}
+
+
 size_t body::getGeneratedSize(const generationContext& ctx)
 {
 	// MIME-Multipart
@@ -544,8 +876,24 @@ size_t body::getGeneratedSize(const generationContext& ctx)
 	// Simple body
 	else
 	{
-		shared_ptr <utility::encoder::encoder> srcEncoder = m_contents->getEncoding().getEncoder();
-		shared_ptr <utility::encoder::encoder> dstEncoder = getEncoding().getEncoder();
+		const encoding enc = getGeneratedEncoding(ctx);
+
+		// Exact size is known if encoded contents are cached
+		if (dynamicCast <const cachedContentHandler>(m_contents))
+		{
+			shared_ptr <cachedContentHandler> contents =
+				dynamicCast <cachedContentHandler>(m_contents->clone());
+
+			contents->setContentTypeHint(getContentType());
+
+			size_t size = 0;
+
+			if (contents->getGeneratedSize(enc, ctx.getMaxLineLength(), &size))
+				return size;
+		}
+
+		shared_ptr <const utility::encoder::encoder> srcEncoder = m_contents->getEncoding().getSharedEncoder();
+		shared_ptr <const utility::encoder::encoder> dstEncoder = enc.getSharedEncoder();
 
 		return dstEncoder->getEncodedSize(srcEncoder->getDecodedSize(m_contents->getLength()));
 	}
@@ -743,6 +1091,65 @@ const encoding body::getEncoding() const
 }
 
 
+const encoding body::getGeneratedEncoding(const generationContext& ctx) const
+{
+	const encoding enc = getEncoding();
+
+	// Multipart bodies are never encoded
+	if (getPartCount() != 0 ||
+	    ctx.getTransferEncodingSupport() == generationContext::TRANSFER_7BIT)
+	{
+		return enc;
+	}
+
+	if (enc != encoding(encodingTypes::BASE64) &&
+	    enc != encoding(encodingTypes::QUOTED_PRINTABLE))
+	{
+		return enc;
+	}
+
+	// Signed or encrypted contents must be sent exactly as they are
+	// (RFC-1847), including the transfer encoding of all sub-parts
+	for (const bodyPart* p = m_part ? m_part->getParentPart() : NULL ;
+	     p != NULL ; p = p->getParentPart())
+	{
+		const mediaType type = p->getBody()->getContentType();
+
+		if (type.getType() == mediaTypes::MULTIPART &&
+		    (type.getSubType() == mediaTypes::MULTIPART_SIGNED ||
+		     type.getSubType() == mediaTypes::MULTIPART_ENCRYPTED))
+		{
+			return enc;
+		}
+	}
+
+	// Any data can be sent as-is
+	if (ctx.getTransferEncodingSupport() == generationContext::TRANSFER_BINARY)
+		return vmime::encoding(encodingTypes::BINARY);
+
+	// 8-bit: only text is eligible, and it must not contain NUL
+	// characters, bare CR or LF, nor lines longer than the SMTP limit
+	if (enc != encoding(encodingTypes::QUOTED_PRINTABLE) || !m_contents->isBuffered())
+		return enc;
+
+	// Contents are scanned only once, although the encoding is needed
+	// both to compute the generated size and to generate the part
+	if (m_eightBitCheckedContents != m_contents)
+	{
+		eightBitCheckOutputStream check;
+		m_contents->extract(check);
+
+		m_eightBitCheckedContents = m_contents;
+		m_eightBitSafe = check.isSafe();
+	}
+
+	if (!m_eightBitSafe)
+		return enc;
+
+	return vmime::encoding(encodingTypes::EIGHT_BIT);
+}
+
+
 void body::setParentPart(bodyPart* parent)
 {
 	m_part = parent;
@@ -50,6 +50,7 @@ class bodyPart;
 class VMIME_EXPORT body : public component
 {
 	friend class bodyPart;
+	friend class messageStreamParser;
 
 public:
 
@@ -261,6 +262,21 @@ public:
 	  */
 	const encoding getEncoding() const;
 
+	/** Return the encoding which will actually be used for the body
+	  * contents when generating them in the specified context. This is
+	  * the same as getEncoding(), unless the context allows 8-bit or
+	  * binary data (see generationContext::setTransferEncodingSupport())
+	  * and the contents do not need a 7-bit transfer encoding. Parts of
+	  * a "multipart/signed" or "multipart/encrypted" body (RFC-1847) are
+	  * always generated unchanged. This may require reading the whole
+	  * contents once; the result is remembered until the contents are
+	  * replaced.
+	  *
+	  * @param ctx generation context
+	  * @return encoding used for generated body contents
+	  */
+	const encoding getGeneratedEncoding(const generationContext& ctx) const;
+
 	/** Generate a new random boundary string.
 	  *
 	  * @return randomly generated boundary string
@@ -289,12 +305,27 @@ private:
 
 	void setParentPart(bodyPart* parent);
 
+	/** Generate the contents of a simple (non-multipart) body, using
+	  * the specified transfer encoding.
+	  *
+	  * @param ctx generation context
+	  * @param os output stream
+	  * @param enc encoding, as returned by getGeneratedEncoding()
+	  */
+	void generateContents
+		(const generationContext& ctx, utility::outputStream& os, const encoding& enc) const;
+
 
 	string m_prologText;
 	string m_epilogText;
 
 	shared_ptr <const contentHandler> m_contents;
 
+	// Contents last checked by getGeneratedEncoding(), and whether
+	// they can be sent as 8-bit data
+	mutable shared_ptr <const contentHandler> m_eightBitCheckedContents;
+	mutable bool m_eightBitSafe;
+
 	bodyPart* m_part;
 
 	std::vector <shared_ptr <bodyPart> > m_parts;
@@ -322,6 +353,24 @@ protected:
 		 const size_t position, const size_t end,
 		 size_t* boundaryStart, size_t* boundaryEnd);
 
+	/** Finds the next boundary in a buffer. This is used by
+	  * findNextBoundaryPosition() and by messageStreamParser. A boundary
+	  * which ends at the end of the buffer is not recognized, as the
+	  * byte which follows it is not known.
+	  *
+	  * @param buffer buffer in which to search
+	  * @param boundary boundary string (without "--" nor CR/LF)
+	  * @param position start position in the buffer
+	  * @param boundaryStart will hold the start position of the boundary (including any
+	  * CR/LF and "--" before the boundary)
+	  * @param boundaryEnd will hold the end position of the boundary (position just
+	  * before the CRLF or "--" which follows)
+	  * @return the position of the boundary string, or npos if not found
+	  */
+	static size_t findBoundaryInBuffer
+		(const string& buffer, const string& boundary, const size_t position,
+		 size_t* boundaryStart, size_t* boundaryEnd);
+
 	// Component parsing & assembling
 	void parseImpl
 		(const parsingContext& ctx,
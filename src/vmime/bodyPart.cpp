@@ -59,11 +59,27 @@ void bodyPart::generateImpl
 	(const generationContext& ctx, utility::outputStream& os,
 	 const size_t /* curLinePos */, size_t* newLinePos) const
 {
-	m_header->generate(ctx, os);
+	const encoding enc = m_body->getGeneratedEncoding(ctx);
+
+	// If the transfer encoding has been relaxed for this context,
+	// the header must announce it (do not modify this part, though)
+	if (enc != m_body->getEncoding())
+	{
+		shared_ptr <header> hdr = vmime::clone(m_header);
+		hdr->ContentTransferEncoding()->setValue(enc);
+		hdr->generate(ctx, os);
+	}
+	else
+	{
+		m_header->generate(ctx, os);
+	}
 
 	os << CRLF;
 
-	m_body->generate(ctx, os);
+	if (m_body->getPartCount() != 0)
+		m_body->generate(ctx, os);
+	else
+		m_body->generateContents(ctx, os, enc);
 
 	if (newLinePos)
 		*newLinePos = 0;
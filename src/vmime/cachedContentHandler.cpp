@@ -0,0 +1,277 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/cachedContentHandler.hpp"
+
+#include "vmime/security/digest/messageDigestFactory.hpp"
+
+
+namespace vmime
+{
+
+
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+// Output stream which computes a digest of the data written into it
+class digestOutputStream : public utility::outputStream
+{
+public:
+
+	digestOutputStream(shared_ptr <security::digest::messageDigest> md)
+		: m_md(md)
+	{
+	}
+
+	void flush()
+	{
+		// Nothing to do
+	}
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count)
+	{
+		m_md->update(data, count);
+	}
+
+private:
+
+	shared_ptr <security::digest::messageDigest> m_md;
+};
+
+
+// Output stream which forwards data to another stream, and keeps a
+// copy of it as long as it does not exceed a maximum size
+class copyingOutputStream : public utility::outputStream
+{
+public:
+
+	copyingOutputStream(utility::outputStream& os, const size_t maxSize)
+		: m_os(os), m_maxSize(maxSize), m_complete(true)
+	{
+	}
+
+	bool isComplete() const
+	{
+		return m_complete;
+	}
+
+	const string& getData() const
+	{
+		return m_data;
+	}
+
+	void flush()
+	{
+		m_os.flush();
+	}
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count)
+	{
+		m_os.write(data, count);
+
+		if (!m_complete)
+			return;
+
+		if (count > m_maxSize - m_data.length())
+		{
+			// Too large to be cached
+			m_complete = false;
+
+			string().swap(m_data);
+		}
+		else
+		{
+			m_data.append(reinterpret_cast <const char*>(data), count);
+		}
+	}
+
+private:
+
+	utility::outputStream& m_os;
+	const size_t m_maxSize;
+
+	string m_data;
+	bool m_complete;
+};
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+cachedContentHandler::cachedContentHandler
+	(shared_ptr <contentHandler> contents, shared_ptr <encodedContentCache> cache)
+	: m_contents(contents), m_cache(cache)
+{
+	if (m_contents->isBuffered() && !m_contents->isEmpty())
+	{
+		shared_ptr <security::digest::messageDigest> md =
+			security::digest::messageDigestFactory::getInstance()->create("sha1");
+
+		digestOutputStream dos(md);
+		m_contents->extractRaw(dos);
+
+		md->finalize();
+
+		m_hash = md->getHexDigest();
+	}
+}
+
+
+cachedContentHandler::~cachedContentHandler()
+{
+}
+
+
+shared_ptr <contentHandler> cachedContentHandler::clone() const
+{
+	// Contents are not supposed to change, so the hash is still valid
+	shared_ptr <cachedContentHandler> cch = make_shared <cachedContentHandler>(*this);
+	cch->m_contents = m_contents->clone();
+
+	return cch;
+}
+
+
+shared_ptr <const contentHandler> cachedContentHandler::getContents() const
+{
+	return m_contents;
+}
+
+
+shared_ptr <encodedContentCache> cachedContentHandler::getCache() const
+{
+	return m_cache;
+}
+
+
+const string& cachedContentHandler::getContentHash() const
+{
+	return m_hash;
+}
+
+
+const string cachedContentHandler::makeKey(const vmime::encoding& enc, const size_t maxLineLength) const
+{
+	return encodedContentCache::makeKey
+		(m_hash, m_contents->getEncoding().getName(), enc.getName(), maxLineLength,
+		 m_contents->getContentTypeHint().getType() == mediaTypes::TEXT);
+}
+
+
+bool cachedContentHandler::getGeneratedSize
+	(const vmime::encoding& enc, const size_t maxLineLength, size_t* size) const
+{
+	if (m_hash.empty())
+		return false;
+
+	return m_cache->getSize(makeKey(enc, maxLineLength), size);
+}
+
+
+void cachedContentHandler::generate(utility::outputStream& os, const vmime::encoding& enc,
+	const size_t maxLineLength) const
+{
+	if (m_hash.empty())
+	{
+		m_contents->generate(os, enc, maxLineLength);
+		return;
+	}
+
+	const string key = makeKey(enc, maxLineLength);
+
+	if (m_cache->write(key, os))
+		return;
+
+	// Not in cache: encode data, and store it if it fits in the cache
+	copyingOutputStream cos(os, m_cache->getMaxStorableSize());
+	m_contents->generate(cos, enc, maxLineLength);
+
+	if (cos.isComplete())
+		m_cache->put(key, cos.getData());
+}
+
+
+void cachedContentHandler::extract(utility::outputStream& os,
+	utility::progressListener* progress) const
+{
+	m_contents->extract(os, progress);
+}
+
+
+void cachedContentHandler::extractRaw(utility::outputStream& os,
+	utility::progressListener* progress) const
+{
+	m_contents->extractRaw(os, progress);
+}
+
+
+size_t cachedContentHandler::getLength() const
+{
+	return m_contents->getLength();
+}
+
+
+bool cachedContentHandler::isEncoded() const
+{
+	return m_contents->isEncoded();
+}
+
+
+const vmime::encoding& cachedContentHandler::getEncoding() const
+{
+	return m_contents->getEncoding();
+}
+
+
+bool cachedContentHandler::isEmpty() const
+{
+	return m_contents->isEmpty();
+}
+
+
+bool cachedContentHandler::isBuffered() const
+{
+	return m_contents->isBuffered();
+}
+
+
+void cachedContentHandler::setContentTypeHint(const mediaType& type)
+{
+	m_contents->setContentTypeHint(type);
+}
+
+
+const mediaType cachedContentHandler::getContentTypeHint() const
+{
+	return m_contents->getContentTypeHint();
+}
+
+
+} // vmime
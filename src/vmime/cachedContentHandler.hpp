@@ -0,0 +1,128 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_CACHEDCONTENTHANDLER_HPP_INCLUDED
+#define VMIME_CACHEDCONTENTHANDLER_HPP_INCLUDED
+
+
+#include "vmime/contentHandler.hpp"
+#include "vmime/encodedContentCache.hpp"
+
+
+namespace vmime
+{
+
+
+/** A content handler which wraps another content handler, and uses
+  * an encodedContentCache to avoid encoding the same data more than
+  * once when generating messages.
+  *
+  * The contents of the wrapped handler are hashed once, when this
+  * object is constructed; they must not change afterwards. If the
+  * wrapped handler is not buffered (ie. data can be read only once),
+  * the cache is bypassed.
+  */
+
+class VMIME_EXPORT cachedContentHandler : public contentHandler
+{
+public:
+
+	/** Creates a new content handler.
+	  *
+	  * @param contents content handler which provides the data
+	  * @param cache cache in which encoded data is stored; it can
+	  * be shared between several content handlers
+	  */
+	cachedContentHandler
+		(shared_ptr <contentHandler> contents,
+		 shared_ptr <encodedContentCache> cache);
+
+	~cachedContentHandler();
+
+	shared_ptr <contentHandler> clone() const;
+
+	/** Return the wrapped content handler.
+	  *
+	  * @return content handler which provides the data
+	  */
+	shared_ptr <const contentHandler> getContents() const;
+
+	/** Return the cache used by this content handler.
+	  *
+	  * @return encoded content cache
+	  */
+	shared_ptr <encodedContentCache> getCache() const;
+
+	/** Return the hash of the contents, which identifies them
+	  * in the cache.
+	  *
+	  * @return hexadecimal SHA-1 digest of the raw contents, or an
+	  * empty string if the contents could not be hashed
+	  */
+	const string& getContentHash() const;
+
+	/** Return the exact size of the generated data, if it is
+	  * already in the cache.
+	  *
+	  * @param enc encoding for output
+	  * @param maxLineLength maximum line length for output
+	  * @param size will receive the size of generated data
+	  * @return true if the size is known, false otherwise
+	  */
+	bool getGeneratedSize(const vmime::encoding& enc, const size_t maxLineLength, size_t* size) const;
+
+
+	void generate(utility::outputStream& os, const vmime::encoding& enc, const size_t maxLineLength = lineLengthLimits::infinite) const;
+
+	void extract(utility::outputStream& os, utility::progressListener* progress = NULL) const;
+	void extractRaw(utility::outputStream& os, utility::progressListener* progress = NULL) const;
+
+	size_t getLength() const;
+
+	bool isEncoded() const;
+
+	const vmime::encoding& getEncoding() const;
+
+	bool isEmpty() const;
+
+	bool isBuffered() const;
+
+	void setContentTypeHint(const mediaType& type);
+	const mediaType getContentTypeHint() const;
+
+private:
+
+	const string makeKey(const vmime::encoding& enc, const size_t maxLineLength) const;
+
+
+	shared_ptr <contentHandler> m_contents;
+	shared_ptr <encodedContentCache> m_cache;
+
+	string m_hash;
+};
+
+
+} // vmime
+
+
+#endif // VMIME_CACHEDCONTENTHANDLER_HPP_INCLUDED
@@ -25,20 +25,80 @@
 
 #include "vmime/charsetConverter_idna.hpp"
 
+#include "vmime/utility/instrumentation.hpp"
+
 
 namespace vmime
 {
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+
+/** Wraps a charset converter to report the time spent in conversions.
+  */
+class instrumentedCharsetConverter : public charsetConverter
+{
+public:
+
+	instrumentedCharsetConverter(shared_ptr <charsetConverter> conv,
+	                             const charset& source, const charset& dest)
+		: m_conv(conv), m_label(source.getName() + ">" + dest.getName())
+	{
+	}
+
+	void convert(const string& in, string& out)
+	{
+		utility::instrumentation::span span
+			(utility::instrumentation::CHARSET_CONVERSION_DURATION, m_label);
+
+		m_conv->convert(in, out);
+	}
+
+	void convert(utility::inputStream& in, utility::outputStream& out)
+	{
+		utility::instrumentation::span span
+			(utility::instrumentation::CHARSET_CONVERSION_DURATION, m_label);
+
+		m_conv->convert(in, out);
+	}
+
+	shared_ptr <utility::charsetFilteredOutputStream> getFilteredOutputStream(utility::outputStream& os)
+	{
+		return m_conv->getFilteredOutputStream(os);
+	}
+
+private:
+
+	shared_ptr <charsetConverter> m_conv;
+	const string m_label;
+};
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
 // static
 shared_ptr <charsetConverter> charsetConverter::create
 	(const charset& source, const charset& dest,
 	 const charsetConverterOptions& opts)
 {
+	shared_ptr <charsetConverter> conv;
+
 	if (source == "idna" || dest == "idna")
-		return make_shared <charsetConverter_idna>(source, dest, opts);
+		conv = make_shared <charsetConverter_idna>(source, dest, opts);
 	else
-		return createGenericConverter(source, dest, opts);
+		conv = createGenericConverter(source, dest, opts);
+
+	if (utility::instrumentation::isEnabled())
+		return make_shared <instrumentedCharsetConverter>(conv, source, dest);
+
+	return conv;
 }
 
 
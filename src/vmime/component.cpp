@@ -27,14 +27,42 @@
 #include "vmime/utility/streamUtils.hpp"
 #include "vmime/utility/inputStreamStringAdapter.hpp"
 #include "vmime/utility/outputStreamAdapter.hpp"
+#include "vmime/utility/instrumentation.hpp"
 
 #include <sstream>
+#include <typeinfo>
 
 
 namespace vmime
 {
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+
+// Measures the duration of parsing a component, labelled
+// with the type of the component
+class parseSpan : public utility::instrumentation::span
+{
+public:
+
+	parseSpan(const component& comp)
+		: span(utility::instrumentation::PARSE_DURATION)
+	{
+		if (isActive())
+			setLabel(utility::instrumentation::getTypeName(typeid(comp)));
+	}
+};
+
+
+} // unnamed namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
 component::component()
 	: m_parsedOffset(0), m_parsedLength(0)
 {
@@ -66,6 +94,8 @@ void component::parse
 	 shared_ptr <utility::inputStream> inputStream, const size_t position,
 	 const size_t end, size_t* newPosition)
 {
+	parseSpan span(*this);
+
 	m_parsedOffset = m_parsedLength = 0;
 
 	shared_ptr <utility::seekableInputStream> seekableStream =
@@ -94,6 +124,8 @@ void component::parse
 
 void component::parse(const string& buffer)
 {
+	parseSpan span(*this);
+
 	m_parsedOffset = m_parsedLength = 0;
 
 	parseImpl(parsingContext::getDefaultContext(), buffer, 0, buffer.length(), NULL);
@@ -102,6 +134,8 @@ void component::parse(const string& buffer)
 
 void component::parse(const parsingContext& ctx, const string& buffer)
 {
+	parseSpan span(*this);
+
 	m_parsedOffset = m_parsedLength = 0;
 
 	parseImpl(ctx, buffer, 0, buffer.length(), NULL);
@@ -112,6 +146,8 @@ void component::parse
 	(const string& buffer, const size_t position,
 	 const size_t end, size_t* newPosition)
 {
+	parseSpan span(*this);
+
 	m_parsedOffset = m_parsedLength = 0;
 
 	parseImpl(parsingContext::getDefaultContext(), buffer, position, end, newPosition);
@@ -123,6 +159,8 @@ void component::parse
 	 const string& buffer, const size_t position,
 	 const size_t end, size_t* newPosition)
 {
+	parseSpan span(*this);
+
 	m_parsedOffset = m_parsedLength = 0;
 
 	parseImpl(ctx, buffer, position, end, newPosition);
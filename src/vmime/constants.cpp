@@ -54,6 +54,8 @@ namespace mediaTypes
 	const char* const MULTIPART_PARALLEL = "parallel";
 	const char* const MULTIPART_DIGEST = "digest";
 	const char* const MULTIPART_REPORT = "report";  // RFC-1892
+	const char* const MULTIPART_SIGNED = "signed";  // RFC-1847
+	const char* const MULTIPART_ENCRYPTED = "encrypted";  // RFC-1847
 
 	const char* const MESSAGE_RFC822 = "rfc822";
 	const char* const MESSAGE_PARTIAL = "partial";
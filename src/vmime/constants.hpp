@@ -65,6 +65,8 @@ namespace vmime
 		extern VMIME_EXPORT const char* const MULTIPART_PARALLEL;
 		extern VMIME_EXPORT const char* const MULTIPART_DIGEST;
 		extern VMIME_EXPORT const char* const MULTIPART_REPORT;  // RFC-1892
+		extern VMIME_EXPORT const char* const MULTIPART_SIGNED;  // RFC-1847
+		extern VMIME_EXPORT const char* const MULTIPART_ENCRYPTED;  // RFC-1847
 
 		extern VMIME_EXPORT const char* const MESSAGE_RFC822;
 		extern VMIME_EXPORT const char* const MESSAGE_PARTIAL;
@@ -0,0 +1,331 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/encodedContentCache.hpp"
+
+#include "vmime/platform.hpp"
+#include "vmime/utility/sync/autoLock.hpp"
+#include "vmime/utility/streamUtils.hpp"
+#include "vmime/utility/random.hpp"
+
+
+namespace vmime
+{
+
+
+const size_t encodedContentCache::DEFAULT_MAX_MEMORY_SIZE = 64 * 1024 * 1024;
+
+
+encodedContentCache::encodedContentCache(const size_t maxMemorySize)
+	: m_maxMemorySize(maxMemorySize), m_memorySize(0),
+	  m_hitCount(0), m_missCount(0),
+	  m_lock(platform::getHandler()->createCriticalSection())
+{
+}
+
+
+encodedContentCache::~encodedContentCache()
+{
+	try
+	{
+		clear();
+	}
+	catch (...)
+	{
+		// Don't throw in destructor
+	}
+}
+
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+
+void encodedContentCache::setSpillDirectory(const utility::file::path& dir)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	m_spillDir = dir;
+}
+
+
+const utility::file::path encodedContentCache::getSpillDirectory() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	return m_spillDir;
+}
+
+#endif // VMIME_HAVE_FILESYSTEM_FEATURES
+
+
+// static
+const string encodedContentCache::makeKey
+	(const string& contentHash, const string& srcEncoding,
+	 const string& dstEncoding, const size_t maxLineLength, const bool text)
+{
+	std::ostringstream oss;
+	oss.imbue(std::locale::classic());
+
+	oss << contentHash << '|' << srcEncoding << '|' << dstEncoding
+	    << '|' << maxLineLength << '|' << (text ? 't' : 'b');
+
+	return oss.str();
+}
+
+
+shared_ptr <encodedContentCache::entry> encodedContentCache::find(const string& key) const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	EntryMap::const_iterator it = m_entries.find(key);
+
+	if (it == m_entries.end())
+	{
+		++m_missCount;
+		return null;
+	}
+
+	++m_hitCount;
+
+	return (*it).second;
+}
+
+
+bool encodedContentCache::write(const string& key, utility::outputStream& os) const
+{
+	shared_ptr <entry> e = find(key);
+
+	if (!e)
+		return false;
+
+	// Entries are never modified once stored, so data can
+	// be written without holding the lock
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+	if (e->file)
+	{
+		shared_ptr <utility::inputStream> is = e->file->getFileReader()->getInputStream();
+		utility::bufferedStreamCopy(*is, os);
+
+		return true;
+	}
+#endif // VMIME_HAVE_FILESYSTEM_FEATURES
+
+	os.write(e->data.data(), e->data.length());
+
+	return true;
+}
+
+
+bool encodedContentCache::getSize(const string& key, size_t* size) const
+{
+	shared_ptr <entry> e = find(key);
+
+	if (!e)
+		return false;
+
+	*size = e->size;
+
+	return true;
+}
+
+
+size_t encodedContentCache::getMaxStorableSize() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+	if (!m_spillDir.isEmpty())
+		return static_cast <size_t>(-1);
+#endif // VMIME_HAVE_FILESYSTEM_FEATURES
+
+	return (m_memorySize < m_maxMemorySize) ? m_maxMemorySize - m_memorySize : 0;
+}
+
+
+void encodedContentCache::put(const string& key, const string& data)
+{
+	shared_ptr <entry> e = make_shared <entry>();
+	e->size = data.length();
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+	utility::file::path spillDir;
+#endif // VMIME_HAVE_FILESYSTEM_FEATURES
+
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		if (m_entries.find(key) != m_entries.end())
+			return;  // already stored by another thread
+
+		if (m_memorySize + data.length() <= m_maxMemorySize)
+		{
+			e->data = data;
+			m_memorySize += data.length();
+
+			m_entries.insert(EntryMap::value_type(key, e));
+
+			return;
+		}
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+		spillDir = m_spillDir;
+#endif // VMIME_HAVE_FILESYSTEM_FEATURES
+	}
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+
+	if (spillDir.isEmpty())
+		return;  // does not fit
+
+	// Write data to a new file, without holding the lock
+	e->file = spill(spillDir, data);
+
+	if (!e->file)
+		return;  // not cached
+
+	bool stored = false;
+
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+		stored = m_entries.insert(EntryMap::value_type(key, e)).second;
+	}
+
+	// Stored by another thread in the meantime
+	if (!stored)
+		removeFile(e->file);
+
+#endif // VMIME_HAVE_FILESYSTEM_FEATURES
+}
+
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+
+// static
+shared_ptr <utility::file> encodedContentCache::spill
+	(const utility::file::path& dir, const string& data)
+{
+	shared_ptr <utility::fileSystemFactory> fsf =
+		platform::getHandler()->getFileSystemFactory();
+
+	// The file is created exclusively, so a random name is chosen
+	// until no file with this name exists
+	shared_ptr <utility::file> file;
+
+	for (int attempt = 0 ; !file && attempt < 10 ; ++attempt)
+	{
+		shared_ptr <utility::file> f = fsf->create(dir / utility::file::path::component
+			("vmime-encoded-" + utility::random::getString(16)));
+
+		try
+		{
+			f->createFile();
+			file = f;
+		}
+		catch (exceptions::filesystem_exception&)
+		{
+			// Name already used, or directory not writable
+		}
+	}
+
+	if (!file)
+		return null;
+
+	try
+	{
+		shared_ptr <utility::outputStream> os = file->getFileWriter()->getOutputStream();
+		os->write(data.data(), data.length());
+		os->flush();
+	}
+	catch (exception&)
+	{
+		removeFile(file);
+		return null;
+	}
+
+	return file;
+}
+
+
+// static
+void encodedContentCache::removeFile(shared_ptr <utility::file> file)
+{
+	try
+	{
+		file->remove();
+	}
+	catch (exception&)
+	{
+		// Ignore
+	}
+}
+
+#endif // VMIME_HAVE_FILESYSTEM_FEATURES
+
+
+void encodedContentCache::clear()
+{
+	EntryMap entries;
+
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		entries.swap(m_entries);
+		m_memorySize = 0;
+	}
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+	for (EntryMap::iterator it = entries.begin() ; it != entries.end() ; ++it)
+	{
+		if ((*it).second->file)
+			removeFile((*it).second->file);
+	}
+#endif // VMIME_HAVE_FILESYSTEM_FEATURES
+}
+
+
+size_t encodedContentCache::getEntryCount() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	return m_entries.size();
+}
+
+
+size_t encodedContentCache::getMemorySize() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	return m_memorySize;
+}
+
+
+size_t encodedContentCache::getHitCount() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	return m_hitCount;
+}
+
+
+size_t encodedContentCache::getMissCount() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	return m_missCount;
+}
+
+
+} // vmime
@@ -0,0 +1,204 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_ENCODEDCONTENTCACHE_HPP_INCLUDED
+#define VMIME_ENCODEDCONTENTCACHE_HPP_INCLUDED
+
+
+#include "vmime/base.hpp"
+#include "vmime/utility/stream.hpp"
+#include "vmime/utility/sync/criticalSection.hpp"
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+	#include "vmime/utility/file.hpp"
+#endif
+
+
+namespace vmime
+{
+
+
+/** Stores the encoded form of some contents, so that the same data
+  * does not need to be encoded again each time a message which
+  * contains it is generated (eg. the same attachment sent to many
+  * recipients).
+  *
+  * Entries are identified by a key built with makeKey() from a hash
+  * of the contents and the encoding parameters. Encoded data is kept
+  * in memory up to a configurable limit; past this limit, it may be
+  * spilled to files in a temporary directory.
+  *
+  * This class is thread-safe. It is used by cachedContentHandler.
+  */
+
+class VMIME_EXPORT encodedContentCache : public object
+{
+public:
+
+	/** Default maximum size of data kept in memory (64 MB). */
+	static const size_t DEFAULT_MAX_MEMORY_SIZE;
+
+	/** Construct a new cache.
+	  *
+	  * @param maxMemorySize maximum number of encoded bytes kept in memory
+	  */
+	encodedContentCache(const size_t maxMemorySize = DEFAULT_MAX_MEMORY_SIZE);
+
+	~encodedContentCache();
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+
+	/** Set the directory in which encoded data that does not fit
+	  * in memory will be stored. The directory must exist. By default,
+	  * no directory is set and such data is not cached.
+	  *
+	  * @param dir path of an existing directory
+	  */
+	void setSpillDirectory(const utility::file::path& dir);
+
+	/** Return the directory in which encoded data that does not fit
+	  * in memory is stored.
+	  *
+	  * @return spill directory, or an empty path if none is set
+	  */
+	const utility::file::path getSpillDirectory() const;
+
+#endif // VMIME_HAVE_FILESYSTEM_FEATURES
+
+	/** Build the key which identifies some encoded contents.
+	  *
+	  * @param contentHash hash of the (raw) contents
+	  * @param srcEncoding name of the encoding of the raw contents
+	  * @param dstEncoding name of the output encoding
+	  * @param maxLineLength maximum line length for output
+	  * @param text whether the contents are encoded in text mode
+	  * @return cache key
+	  */
+	static const string makeKey
+		(const string& contentHash, const string& srcEncoding,
+		 const string& dstEncoding, const size_t maxLineLength, const bool text);
+
+	/** Write the encoded data stored for the specified key.
+	  *
+	  * @param key cache key
+	  * @param os output stream
+	  * @return true if the key was found and data has been written,
+	  * or false if the key was not found in the cache
+	  */
+	bool write(const string& key, utility::outputStream& os) const;
+
+	/** Return the size of the encoded data stored for the specified key.
+	  *
+	  * @param key cache key
+	  * @param size will receive the size of encoded data
+	  * @return true if the key was found, false otherwise
+	  */
+	bool getSize(const string& key, size_t* size) const;
+
+	/** Return the size of the largest encoded data which can currently
+	  * be stored in the cache, so that callers do not need to keep a
+	  * copy of data which would not be stored.
+	  *
+	  * @return maximum size of data, or (size_t) -1 if data that does
+	  * not fit in memory can be spilled to files
+	  */
+	size_t getMaxStorableSize() const;
+
+	/** Store encoded data in the cache. If the data does not fit in
+	  * memory and no spill directory is set, or if the data cannot be
+	  * written to the spill directory, it is not stored.
+	  *
+	  * @param key cache key
+	  * @param data encoded data
+	  */
+	void put(const string& key, const string& data);
+
+	/** Remove all entries from the cache, and delete spilled files.
+	  */
+	void clear();
+
+	/** Return the number of entries in the cache.
+	  *
+	  * @return number of entries
+	  */
+	size_t getEntryCount() const;
+
+	/** Return the number of encoded bytes currently kept in memory.
+	  *
+	  * @return size of data in memory
+	  */
+	size_t getMemorySize() const;
+
+	/** Return the number of lookups which found an entry.
+	  *
+	  * @return number of cache hits
+	  */
+	size_t getHitCount() const;
+
+	/** Return the number of lookups which did not find an entry.
+	  *
+	  * @return number of cache misses
+	  */
+	size_t getMissCount() const;
+
+private:
+
+	struct entry
+	{
+		string data;
+		size_t size;
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+		shared_ptr <utility::file> file;
+#endif
+	};
+
+	shared_ptr <entry> find(const string& key) const;
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+	static shared_ptr <utility::file> spill(const utility::file::path& dir, const string& data);
+	static void removeFile(shared_ptr <utility::file> file);
+#endif
+
+	typedef std::map <string, shared_ptr <entry> > EntryMap;
+
+	EntryMap m_entries;
+
+	size_t m_maxMemorySize;
+	size_t m_memorySize;
+
+	mutable size_t m_hitCount;
+	mutable size_t m_missCount;
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+	utility::file::path m_spillDir;
+#endif
+
+	shared_ptr <utility::sync::criticalSection> m_lock;
+};
+
+
+} // vmime
+
+
+#endif // VMIME_ENCODEDCONTENTCACHE_HPP_INCLUDED
@@ -95,7 +95,7 @@ void encoding::generateImpl
 shared_ptr <utility::encoder::encoder> encoding::getEncoder() const
 {
 	shared_ptr <utility::encoder::encoder> encoder =
-		utility::encoder::encoderFactory::getInstance()->create(generate());
+		utility::encoder::encoderFactory::getInstance()->create(m_name);
 
 	// FIXME: this should not be here (move me into QP encoder instead?)
 	if (m_usage == USAGE_TEXT && m_name == encodingTypes::QUOTED_PRINTABLE)
@@ -105,6 +105,12 @@ shared_ptr <utility::encoder::encoder> encoding::getEncoder() const
 }
 
 
+shared_ptr <const utility::encoder::encoder> encoding::getSharedEncoder() const
+{
+	return utility::encoder::encoderFactory::getInstance()->getSharedInstance(m_name);
+}
+
+
 encoding& encoding::operator=(const encoding& other)
 {
 	copyFrom(other);
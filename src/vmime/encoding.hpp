@@ -125,6 +125,17 @@ public:
 	  */
 	shared_ptr <utility::encoder::encoder> getEncoder() const;
 
+	/** Return the shared, read-only encoder object for the current
+	  * encoding type. Use this instead of getEncoder() when you only
+	  * need to call const functions on the encoder (eg. to compute
+	  * the encoded size of some data), to avoid an allocation.
+	  *
+	  * @throw exceptions::no_encoder_available if no encoder
+	  * is registered for the encoding
+	  * @return shared encoder object for the encoding type
+	  */
+	shared_ptr <const utility::encoder::encoder> getSharedEncoder() const;
+
 private:
 
 	string m_name;
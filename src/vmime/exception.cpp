@@ -551,6 +551,22 @@ exception* command_error::clone() const { return new command_error(*this); }
 const char* command_error::name() const throw() { return "command_error"; }
 
 
+//
+// partial_command_error
+//
+
+partial_command_error::~partial_command_error() throw() {}
+partial_command_error::partial_command_error(const string& command, const string& response,
+                                             const string& completed, const exception& other)
+	: command_error(command, response, "partially applied", other),
+	  m_completed(completed) {}
+
+const string& partial_command_error::completed() const { return (m_completed); }
+
+exception* partial_command_error::clone() const { return new partial_command_error(*this); }
+const char* partial_command_error::name() const throw() { return "partial_command_error"; }
+
+
 //
 // invalid_response
 //
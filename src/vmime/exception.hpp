@@ -662,6 +662,34 @@ private:
 };
 
 
+/** Command error: a command addressing several messages was split into
+  * several commands, and some of them failed after others had already
+  * been applied (this is specific to the underlying protocol).
+  */
+
+class VMIME_EXPORT partial_command_error : public command_error
+{
+public:
+
+	partial_command_error(const string& command, const string& response, const string& completed, const exception& other = NO_EXCEPTION);
+	~partial_command_error() throw();
+
+	/** Return the messages on which the command has been applied.
+	  * The format is protocol-dependent (eg. an IMAP sequence set).
+	  *
+	  * @return messages on which the command has been applied
+	  */
+	const string& completed() const;
+
+	exception* clone() const;
+	const char* name() const throw();
+
+private:
+
+	string m_completed;
+};
+
+
 /** The server returned an invalid response.
   */
 
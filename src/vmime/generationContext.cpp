@@ -32,7 +32,8 @@ generationContext::generationContext()
 	: m_maxLineLength(lineLengthLimits::convenient),
 	  m_prologText("This is a multi-part message in MIME format. Your mail reader " \
 	               "does not understand MIME message format."),
-	  m_epilogText("")
+	  m_epilogText(""),
+	  m_transferEncodingSupport(TRANSFER_7BIT)
 {
 }
 
@@ -41,7 +42,8 @@ generationContext::generationContext(const generationContext& ctx)
 	: context(ctx),
 	  m_maxLineLength(ctx.m_maxLineLength),
 	  m_prologText(ctx.m_prologText),
-	  m_epilogText(ctx.m_epilogText)
+	  m_epilogText(ctx.m_epilogText),
+	  m_transferEncodingSupport(ctx.m_transferEncodingSupport)
 {
 }
 
@@ -89,6 +91,18 @@ void generationContext::setEpilogText(const string& epilogText)
 }
 
 
+generationContext::TransferEncodingSupport generationContext::getTransferEncodingSupport() const
+{
+	return m_transferEncodingSupport;
+}
+
+
+void generationContext::setTransferEncodingSupport(const TransferEncodingSupport support)
+{
+	m_transferEncodingSupport = support;
+}
+
+
 generationContext& generationContext::operator=(const generationContext& ctx)
 {
 	copyFrom(ctx);
@@ -103,6 +117,7 @@ void generationContext::copyFrom(const generationContext& ctx)
 	m_maxLineLength = ctx.m_maxLineLength;
 	m_prologText = ctx.m_prologText;
 	m_epilogText = ctx.m_epilogText;
+	m_transferEncodingSupport = ctx.m_transferEncodingSupport;
 }
 
 
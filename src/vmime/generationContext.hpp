@@ -42,6 +42,18 @@ public:
 	generationContext();
 	generationContext(const generationContext& ctx);
 
+	/** Kind of data the transport can carry without having to apply
+	  * a 7-bit transfer encoding (quoted-printable or base64) to it.
+	  */
+	enum TransferEncodingSupport
+	{
+		TRANSFER_7BIT,     /**< Only 7-bit data (default). */
+		TRANSFER_8BIT,     /**< 8-bit data in lines of at most 998 bytes
+		                        (eg. SMTP with 8BITMIME extension). */
+		TRANSFER_BINARY    /**< Arbitrary binary data (eg. SMTP with
+		                        BINARYMIME and CHUNKING extensions). */
+	};
+
 	/** Returns the current maximum line length used when generating messages.
 	  *
 	  * @return current maximum line length, in bytes
@@ -82,6 +94,24 @@ public:
 	  */
 	void setEpilogText(const string& epilogText);
 
+	/** Returns the kind of data the generator is allowed to emit
+	  * without transfer encoding.
+	  *
+	  * @return transfer encoding support level
+	  */
+	TransferEncodingSupport getTransferEncodingSupport() const;
+
+	/** Sets the kind of data the generator is allowed to emit without
+	  * transfer encoding. When 8-bit or binary data is allowed, body
+	  * parts which would otherwise be encoded in quoted-printable or
+	  * base64 are sent as "8bit" or "binary", provided their contents
+	  * are suitable. Default is TRANSFER_7BIT; change it only if the
+	  * transport is known to support it.
+	  *
+	  * @param support transfer encoding support level
+	  */
+	void setTransferEncodingSupport(const TransferEncodingSupport support);
+
 	/** Returns the default context used for generating messages.
 	  *
 	  * @return a reference to the default generation context
@@ -97,6 +127,8 @@ protected:
 
 	string m_prologText;
 	string m_epilogText;
+
+	TransferEncodingSupport m_transferEncodingSupport;
 };
 
 
@@ -229,6 +229,10 @@ shared_ptr <headerField> headerField::parseNext
 					contentsEnd--;
 				}
 
+				// Skip fields which have not been selected
+				if (!ctx.isHeaderFieldSelected(name))
+					continue;
+
 				// Return a new field
 				shared_ptr <headerField> field = headerFieldFactory::getInstance()->create(name);
 
@@ -64,6 +64,12 @@ protected:
 
 public:
 
+	/** Returns the factory instance. Fields and values must be
+	  * registered before the factory is used by several threads at
+	  * the same time (for example, when parsing in parallel).
+	  *
+	  * @return factory instance
+	  */
 	static shared_ptr <headerFieldFactory> getInstance();
 
 #ifndef VMIME_BUILDING_DOC
@@ -31,13 +31,166 @@
 #include "vmime/emptyContentHandler.hpp"
 #include "vmime/stringContentHandler.hpp"
 
-#include "vmime/utility/outputStreamAdapter.hpp"
+#include "vmime/utility/outputStream.hpp"
+#include "vmime/utility/urlUtils.hpp"
+
+#include <set>
 
 
 namespace vmime
 {
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+
+/** Scans HTML text in a single pass, and records which of the known
+  * Content-Id and Content-Location values are referenced in it.
+  *
+  * The text is split into tokens at characters which cannot appear in
+  * an URL (whitespace, quotes, angle brackets and parentheses), which
+  * covers quoted and unquoted attribute values and CSS "url(...)".
+  */
+class htmlReferenceScanner : public utility::outputStream
+{
+public:
+
+	htmlReferenceScanner(const std::set <string>& ids, const std::set <string>& locations)
+		: m_ids(ids), m_locations(locations), m_overflow(false)
+	{
+	}
+
+	void flush()
+	{
+		endToken();
+	}
+
+	bool isIdReferenced(const string& id) const
+	{
+		return m_foundIds.find(id) != m_foundIds.end();
+	}
+
+	bool isLocationReferenced(const string& location) const
+	{
+		return m_foundLocations.find(location) != m_foundLocations.end();
+	}
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count)
+	{
+		for (size_t i = 0 ; i < count ; ++i)
+		{
+			const char c = static_cast <char>(data[i]);
+
+			switch (c)
+			{
+			case ' ': case '\t': case '\r': case '\n': case '\f':
+			case '"': case '\'':
+			case '<': case '>':
+			case '(': case ')':
+
+				endToken();
+				break;
+
+			default:
+
+				if (m_overflow)
+					break;
+
+				// Skip very long tokens (eg. "data:" URLs)
+				if (m_token.length() >= MAX_TOKEN_LENGTH)
+				{
+					m_token.clear();
+					m_overflow = true;
+				}
+				else
+				{
+					m_token += c;
+				}
+
+				break;
+			}
+		}
+	}
+
+private:
+
+	static const size_t MAX_TOKEN_LENGTH = 2048;
+
+	void endToken()
+	{
+		if (!m_overflow && !m_token.empty())
+			processToken();
+
+		m_token.clear();
+		m_overflow = false;
+	}
+
+	void processToken()
+	{
+		// Content-Location: token is the whole attribute value, or
+		// follows "attr=" if the value is not quoted
+		if (m_locations.find(m_token) != m_locations.end())
+			m_foundLocations.insert(m_token);
+
+		const size_t eq = m_token.find('=');
+
+		if (eq != string::npos)
+		{
+			const string value(m_token.begin() + eq + 1, m_token.end());
+
+			if (m_locations.find(value) != m_locations.end())
+				m_foundLocations.insert(value);
+		}
+
+		// Content-Id: "cid:" prefix is not case-sensitive
+		for (size_t pos = 0 ; pos + 4 <= m_token.length() ; ++pos)
+		{
+			if ((m_token[pos + 0] == 'c' || m_token[pos + 0] == 'C') &&
+			    (m_token[pos + 1] == 'i' || m_token[pos + 1] == 'I') &&
+			    (m_token[pos + 2] == 'd' || m_token[pos + 2] == 'D') &&
+			     m_token[pos + 3] == ':')
+			{
+				const string id(m_token.begin() + pos + 4, m_token.end());
+
+				if (m_ids.find(id) != m_ids.end())
+					m_foundIds.insert(id);
+
+				// "cid:" URLs may be %-encoded (RFC-2392)
+				if (id.find('%') != string::npos)
+				{
+					const string decodedId = utility::urlUtils::decode(id);
+
+					if (m_ids.find(decodedId) != m_ids.end())
+						m_foundIds.insert(decodedId);
+				}
+
+				break;
+			}
+		}
+	}
+
+
+	const std::set <string>& m_ids;
+	const std::set <string>& m_locations;
+
+	std::set <string> m_foundIds;
+	std::set <string> m_foundLocations;
+
+	string m_token;
+	bool m_overflow;
+};
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
 htmlTextPart::htmlTextPart()
 	: m_plainText(make_shared <emptyContentHandler>()),
 	  m_text(make_shared <emptyContentHandler>())
@@ -190,13 +343,30 @@ void htmlTextPart::parse(shared_ptr <const bodyPart> message, shared_ptr <const
 
 	findEmbeddedParts(*message, cidParts, locParts);
 
-	// Extract HTML text
-	std::ostringstream oss;
-	utility::outputStreamAdapter adapter(oss);
+	// Collect the identifiers of the parts which may be referenced
+	std::set <string> ids, locations;
+
+	for (std::vector <shared_ptr <const bodyPart> >::const_iterator p = cidParts.begin() ; p != cidParts.end() ; ++p)
+	{
+		const shared_ptr <const headerField> midField =
+			(*p)->getHeader()->findField(fields::CONTENT_ID);
+
+		ids.insert(midField->getValue <messageId>()->getId());
+	}
+
+	for (std::vector <shared_ptr <const bodyPart> >::const_iterator p = locParts.begin() ; p != locParts.end() ; ++p)
+	{
+		const shared_ptr <const headerField> locField =
+			(*p)->getHeader()->findField(fields::CONTENT_LOCATION);
+
+		locations.insert(locField->getValue <text>()->getWholeBuffer());
+	}
 
-	textPart->getBody()->getContents()->extract(adapter);
+	// Scan HTML text for references to these parts
+	htmlReferenceScanner scanner(ids, locations);
 
-	const string data = oss.str();
+	textPart->getBody()->getContents()->extract(scanner);
+	scanner.flush();
 
 	m_text = textPart->getBody()->getContents()->clone();
 
@@ -209,8 +379,7 @@ void htmlTextPart::parse(shared_ptr <const bodyPart> message, shared_ptr <const
 	else
 		m_charset = charset();
 
-	// Extract embedded objects. The algorithm is quite simple: for each previously
-	// found inline part, we check if its CID/Location is contained in the HTML text.
+	// Extract embedded objects referenced in the HTML text
 	for (std::vector <shared_ptr <const bodyPart> >::const_iterator p = cidParts.begin() ; p != cidParts.end() ; ++p)
 	{
 		const shared_ptr <const headerField> midField =
@@ -218,8 +387,7 @@ void htmlTextPart::parse(shared_ptr <const bodyPart> message, shared_ptr <const
 
 		const messageId mid = *midField->getValue <messageId>();
 
-		if (data.find("CID:" + mid.getId()) != string::npos ||
-		    data.find("cid:" + mid.getId()) != string::npos)
+		if (scanner.isIdReferenced(mid.getId()))
 		{
 			// This part is referenced in the HTML text.
 			// Add it to the embedded object list.
@@ -235,7 +403,7 @@ void htmlTextPart::parse(shared_ptr <const bodyPart> message, shared_ptr <const
 		const text loc = *locField->getValue <text>();
 		const string locStr = loc.getWholeBuffer();
 
-		if (data.find(locStr) != string::npos)
+		if (scanner.isLocationReferenced(locStr))
 		{
 			// This part is referenced in the HTML text.
 			// Add it to the embedded object list.
@@ -0,0 +1,85 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_MESSAGESTREAMHANDLER_HPP_INCLUDED
+#define VMIME_MESSAGESTREAMHANDLER_HPP_INCLUDED
+
+
+#include "vmime/base.hpp"
+#include "vmime/mediaType.hpp"
+
+
+namespace vmime
+{
+
+
+/** Receives the events generated by a messageStreamParser.
+  *
+  * For each part (including the message itself), onPartBegin() is
+  * called when the header has been read, followed by onHeaderField()
+  * for each field of the header. Then, either the sub-parts are
+  * reported (for a multipart body), or the body contents are reported
+  * by calls to onBodyChunk(). Finally, onPartEnd() is called.
+  */
+
+class VMIME_EXPORT messageStreamHandler : public object
+{
+public:
+
+	virtual ~messageStreamHandler() { }
+
+	/** Called when a new part starts, after its header has been read.
+	  *
+	  * @param type media type of the part, as specified in the
+	  * "Content-Type" field, or the default type if there is none
+	  */
+	virtual void onPartBegin(const mediaType& type) = 0;
+
+	/** Called for each field of the header of the current part.
+	  *
+	  * @param name field name
+	  * @param rawValue field value, as found in the message (it is
+	  * neither decoded nor unfolded)
+	  */
+	virtual void onHeaderField(const string& name, const string& rawValue) = 0;
+
+	/** Called with the contents of the body of the current part.
+	  * This is not called for multipart bodies. Contents are not decoded
+	  * (they are still encoded with the "Content-Transfer-Encoding" of
+	  * the part).
+	  *
+	  * @param data pointer to body data
+	  * @param count number of bytes of body data
+	  */
+	virtual void onBodyChunk(const byte_t* data, const size_t count) = 0;
+
+	/** Called when the current part ends.
+	  */
+	virtual void onPartEnd() = 0;
+};
+
+
+} // vmime
+
+
+#endif // VMIME_MESSAGESTREAMHANDLER_HPP_INCLUDED
@@ -0,0 +1,428 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/messageStreamParser.hpp"
+
+#include "vmime/body.hpp"
+#include "vmime/headerField.hpp"
+#include "vmime/contentTypeField.hpp"
+
+#include "vmime/utility/stringUtils.hpp"
+
+#include <algorithm>
+
+
+namespace vmime
+{
+
+
+const size_t messageStreamParser::MAX_HEADER_SIZE = 1024 * 1024;
+
+
+// Number of bytes kept before the current position, which are
+// needed to recognize a boundary at the current position
+static const size_t CONTEXT_SIZE = 16;
+
+
+messageStreamParser::messageStreamParser(shared_ptr <messageStreamHandler> handler)
+	: m_handler(handler), m_ctx(NULL), m_stream(NULL), m_pos(0), m_scanPos(0), m_eof(false)
+{
+}
+
+
+void messageStreamParser::parse(utility::inputStream& is)
+{
+	parse(parsingContext::getDefaultContext(), is);
+}
+
+
+void messageStreamParser::parse(const parsingContext& ctx, utility::inputStream& is)
+{
+	m_ctx = &ctx;
+	m_stream = &is;
+
+	m_buffer.clear();
+	m_pos = 0;
+	m_eof = false;
+
+	m_scanBoundaries.clear();
+	m_scanPos = 0;
+
+	std::vector <string> boundaries;
+	parsePart(boundaries, mediaType(mediaTypes::TEXT, mediaTypes::TEXT_PLAIN));
+
+	m_buffer.clear();
+
+	m_ctx = NULL;
+	m_stream = NULL;
+}
+
+
+void messageStreamParser::parsePart
+	(const std::vector <string>& boundaries, const mediaType& defaultType)
+{
+	const string header = readHeader(boundaries);
+
+	// Parse header fields
+	std::vector <std::pair <string, string> > fields;
+
+	mediaType type = defaultType;
+	string boundary;
+
+	for (size_t pos = 0 ; pos < header.length() ; )
+	{
+		const size_t fieldStart = pos;
+
+		shared_ptr <headerField> field =
+			headerField::parseNext(*m_ctx, header, pos, header.length(), &pos);
+
+		if (field == NULL)
+			break;
+
+		// Extract raw value (after the colon, without end-of-line)
+		const string raw(header.begin() + fieldStart, header.begin() + pos);
+
+		size_t valueStart = raw.find(':');
+		size_t valueEnd = raw.length();
+
+		valueStart = (valueStart == string::npos ? raw.length() : valueStart + 1);
+
+		while (valueStart < valueEnd && (raw[valueStart] == ' ' || raw[valueStart] == '\t'))
+			++valueStart;
+
+		while (valueEnd > valueStart && (raw[valueEnd - 1] == '\r' || raw[valueEnd - 1] == '\n'))
+			--valueEnd;
+
+		fields.push_back(std::make_pair(field->getName(),
+			string(raw.begin() + valueStart, raw.begin() + valueEnd)));
+
+		if (utility::stringUtils::isStringEqualNoCase(field->getName(), fields::CONTENT_TYPE))
+		{
+			shared_ptr <contentTypeField> ctf = dynamicCast <contentTypeField>(field);
+
+			if (ctf)
+			{
+				type = *ctf->getValue <mediaType>();
+
+				if (ctf->hasBoundary())
+					boundary = ctf->getBoundary();
+			}
+		}
+	}
+
+	m_handler->onPartBegin(type);
+
+	for (std::vector <std::pair <string, string> >::const_iterator it = fields.begin() ;
+	     it != fields.end() ; ++it)
+	{
+		m_handler->onHeaderField(it->first, it->second);
+	}
+
+	if (type.getType() == mediaTypes::MULTIPART && !boundary.empty())
+		parseMultipart(boundaries, boundary, type);
+	else
+		readUntilBoundary(boundaries, /* report */ true, NULL);
+
+	m_handler->onPartEnd();
+}
+
+
+void messageStreamParser::parseMultipart
+	(const std::vector <string>& boundaries, const string& boundary, const mediaType& type)
+{
+	std::vector <string> partBoundaries(boundaries);
+	partBoundaries.push_back(boundary);
+
+	const size_t boundaryIndex = partBoundaries.size() - 1;
+
+	// RFC-2046: default type for parts of a "multipart/digest" is "message/rfc822"
+	const mediaType partType =
+		(type.getSubType() == mediaTypes::MULTIPART_DIGEST)
+			? mediaType(mediaTypes::MESSAGE, mediaTypes::MESSAGE_RFC822)
+			: mediaType(mediaTypes::TEXT, mediaTypes::TEXT_PLAIN);
+
+	// Skip prolog text
+	size_t boundaryLength = 0;
+	size_t index = readUntilBoundary(partBoundaries, /* report */ false, &boundaryLength);
+
+	while (index == boundaryIndex)
+	{
+		// Last part: skip epilog text
+		if (skipBoundary(boundaryLength))
+		{
+			readUntilBoundary(boundaries, /* report */ false, NULL);
+			return;
+		}
+
+		parsePart(partBoundaries, partType);
+
+		// Part ends at a boundary of this body, at a boundary of an
+		// enclosing body (missing last boundary), or at end of input
+		index = readUntilBoundary(partBoundaries, /* report */ false, &boundaryLength);
+	}
+}
+
+
+const string messageStreamParser::readHeader(const std::vector <string>& boundaries)
+{
+	size_t searchOffset = 0;
+
+	for (;;)
+	{
+		const size_t available = getAvailable();
+
+		// Header ends with an empty line...
+		size_t headerLength = string::npos;
+		size_t skipLength = 0;
+
+		if (available >= 1 && m_buffer[m_pos] == '\n')
+		{
+			headerLength = 0;
+			skipLength = 1;
+		}
+		else if (available >= 2 && m_buffer[m_pos] == '\r' && m_buffer[m_pos + 1] == '\n')
+		{
+			headerLength = 0;
+			skipLength = 2;
+		}
+		else
+		{
+			const size_t lf = m_buffer.find("\n\n", m_pos + searchOffset);
+			const size_t crlf = m_buffer.find("\n\r\n", m_pos + searchOffset);
+
+			if (lf != string::npos && (crlf == string::npos || lf < crlf))
+			{
+				headerLength = lf + 1 - m_pos;
+				skipLength = 1;
+			}
+			else if (crlf != string::npos)
+			{
+				headerLength = crlf + 1 - m_pos;
+				skipLength = 2;
+			}
+		}
+
+		// ...or at a boundary, if the part has no body
+		size_t boundaryStart, boundaryEnd;
+
+		if (findBoundary(boundaries, &boundaryStart, &boundaryEnd) != string::npos &&
+		    (headerLength == string::npos || boundaryStart - m_pos < headerLength))
+		{
+			headerLength = boundaryStart - m_pos;
+			skipLength = 0;
+		}
+
+		// Header is too large, or input is truncated
+		if (headerLength == string::npos && (m_eof || available >= MAX_HEADER_SIZE))
+			headerLength = available;
+
+		if (headerLength != string::npos)
+		{
+			const string header(m_buffer.begin() + m_pos, m_buffer.begin() + m_pos + headerLength);
+			m_pos += headerLength + skipLength;
+
+			return header;
+		}
+
+		searchOffset = (available >= 2 ? available - 2 : 0);
+
+		fill(available + 1);
+	}
+}
+
+
+size_t messageStreamParser::readUntilBoundary
+	(const std::vector <string>& boundaries, const bool report, size_t* boundaryLength)
+{
+	// The end of the window may contain the beginning of a boundary
+	size_t margin = 0;
+
+	for (std::vector <string>::const_iterator it = boundaries.begin() ; it != boundaries.end() ; ++it)
+		margin = std::max(margin, it->length() + 8);
+
+	for (;;)
+	{
+		size_t boundaryStart, boundaryEnd;
+		const size_t index = findBoundary(boundaries, &boundaryStart, &boundaryEnd);
+
+		if (index != string::npos)
+		{
+			if (report && boundaryStart > m_pos)
+				m_handler->onBodyChunk(reinterpret_cast <const byte_t*>(m_buffer.data() + m_pos), boundaryStart - m_pos);
+
+			m_pos = boundaryStart;
+
+			if (boundaryLength)
+				*boundaryLength = boundaryEnd - boundaryStart;
+
+			return index;
+		}
+
+		if (m_eof)
+		{
+			if (report && m_pos < m_buffer.length())
+				m_handler->onBodyChunk(reinterpret_cast <const byte_t*>(m_buffer.data() + m_pos), m_buffer.length() - m_pos);
+
+			m_pos = m_buffer.length();
+
+			return string::npos;
+		}
+
+		if (getAvailable() > margin)
+		{
+			const size_t end = m_buffer.length() - margin;
+
+			if (report)
+				m_handler->onBodyChunk(reinterpret_cast <const byte_t*>(m_buffer.data() + m_pos), end - m_pos);
+
+			m_pos = end;
+		}
+
+		fill(getAvailable() + 1);
+	}
+}
+
+
+size_t messageStreamParser::findBoundary
+	(const std::vector <string>& boundaries, size_t* boundaryStart, size_t* boundaryEnd)
+{
+	if (boundaries.empty() || m_pos >= m_buffer.length())
+		return string::npos;
+
+	// No boundary starts before 'm_scanPos': resume the search from there,
+	// unless the boundaries have changed since the last search
+	if (boundaries != m_scanBoundaries)
+	{
+		m_scanBoundaries = boundaries;
+		m_scanPos = 0;
+	}
+
+	const size_t searchPos = std::max(m_pos, m_scanPos);
+
+	size_t found = string::npos;
+	size_t foundPos = string::npos;
+	size_t maxLength = 0;
+
+	for (size_t i = 0 ; i < boundaries.size() ; ++i)
+	{
+		maxLength = std::max(maxLength, boundaries[i].length());
+
+		size_t start = 0, end = 0;
+
+		const size_t pos = body::findBoundaryInBuffer
+			(m_buffer, boundaries[i], searchPos, &start, &end);
+
+		if (pos == string::npos)
+			continue;
+
+		foundPos = std::min(foundPos, pos);
+
+		// CR/LF before the boundary may have already been read
+		start = std::max(start, m_pos);
+
+		if (found == string::npos || start < *boundaryStart)
+		{
+			found = i;
+
+			*boundaryStart = start;
+			*boundaryEnd = end;
+		}
+	}
+
+	// A boundary may end after the data available so far
+	if (foundPos != string::npos)
+		m_scanPos = foundPos;
+	else if (m_buffer.length() > maxLength)
+		m_scanPos = std::max(searchPos, m_buffer.length() - maxLength);
+	else
+		m_scanPos = searchPos;
+
+	return found;
+}
+
+
+bool messageStreamParser::skipBoundary(const size_t boundaryLength)
+{
+	m_pos += boundaryLength;
+
+	// Check whether it is the last part (boundary terminated by "--")
+	bool last = false;
+
+	if (fill(2) && m_buffer[m_pos] == '-' && m_buffer[m_pos + 1] == '-')
+	{
+		last = true;
+		m_pos += 2;
+	}
+
+	// Skip transport padding and end of boundary line
+	while (fill(1) && (m_buffer[m_pos] == ' ' || m_buffer[m_pos] == '\t'))
+		++m_pos;
+
+	if (fill(2) && m_buffer[m_pos] == '\r' && m_buffer[m_pos + 1] == '\n')
+		m_pos += 2;
+	else if (fill(1) && m_buffer[m_pos] == '\n')
+		++m_pos;
+
+	return last;
+}
+
+
+bool messageStreamParser::fill(const size_t count)
+{
+	if (getAvailable() >= count)
+		return true;
+
+	// Discard data which has already been read
+	if (m_pos > CONTEXT_SIZE)
+	{
+		const size_t discard = m_pos - CONTEXT_SIZE;
+
+		m_buffer.erase(0, discard);
+		m_pos = CONTEXT_SIZE;
+
+		m_scanPos = (m_scanPos > discard ? m_scanPos - discard : 0);
+	}
+
+	byte_t buffer[16384];
+
+	while (!m_eof && getAvailable() < count)
+	{
+		const size_t n = m_stream->read(buffer, sizeof(buffer));
+
+		if (n != 0)
+			m_buffer.append(reinterpret_cast <const char*>(buffer), n);
+		else if (m_stream->eof())
+			m_eof = true;
+	}
+
+	return getAvailable() >= count;
+}
+
+
+size_t messageStreamParser::getAvailable() const
+{
+	return m_buffer.length() - m_pos;
+}
+
+
+} // vmime
@@ -0,0 +1,110 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_MESSAGESTREAMPARSER_HPP_INCLUDED
+#define VMIME_MESSAGESTREAMPARSER_HPP_INCLUDED
+
+
+#include "vmime/base.hpp"
+#include "vmime/parsingContext.hpp"
+#include "vmime/messageStreamHandler.hpp"
+
+#include "vmime/utility/inputStream.hpp"
+
+
+namespace vmime
+{
+
+
+/** Parses a message from a forward-only stream, and reports its
+  * structure and contents to a handler as they are read, without
+  * building a message object.
+  *
+  * Memory use is bounded: only the header of the current part and a
+  * small window of the input are kept in memory.
+  */
+
+class VMIME_EXPORT messageStreamParser : public object
+{
+public:
+
+	/** Maximum size of the header of a part. Data exceeding this
+	  * limit is treated as the beginning of the body of the part.
+	  */
+	static const size_t MAX_HEADER_SIZE;
+
+	/** Construct a new parser.
+	  *
+	  * @param handler object which receives parsing events
+	  */
+	messageStreamParser(shared_ptr <messageStreamHandler> handler);
+
+	/** Parse a message from the specified stream, until the end
+	  * of the stream is reached.
+	  *
+	  * @param is input stream
+	  */
+	void parse(utility::inputStream& is);
+
+	/** Parse a message from the specified stream, until the end
+	  * of the stream is reached.
+	  *
+	  * @param ctx parsing context
+	  * @param is input stream
+	  */
+	void parse(const parsingContext& ctx, utility::inputStream& is);
+
+private:
+
+	void parsePart(const std::vector <string>& boundaries, const mediaType& defaultType);
+	void parseMultipart(const std::vector <string>& boundaries, const string& boundary, const mediaType& type);
+
+	const string readHeader(const std::vector <string>& boundaries);
+
+	size_t readUntilBoundary(const std::vector <string>& boundaries, const bool report, size_t* boundaryLength);
+	size_t findBoundary(const std::vector <string>& boundaries, size_t* boundaryStart, size_t* boundaryEnd);
+	bool skipBoundary(const size_t boundaryLength);
+
+	bool fill(const size_t count);
+	size_t getAvailable() const;
+
+
+	shared_ptr <messageStreamHandler> m_handler;
+
+	const parsingContext* m_ctx;
+	utility::inputStream* m_stream;
+
+	string m_buffer;
+	size_t m_pos;
+
+	std::vector <string> m_scanBoundaries;  // boundaries of the last search
+	size_t m_scanPos;                       // no boundary starts before this position
+
+	bool m_eof;
+};
+
+
+} // vmime
+
+
+#endif // VMIME_MESSAGESTREAMPARSER_HPP_INCLUDED
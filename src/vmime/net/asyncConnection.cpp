@@ -0,0 +1,283 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/net/asyncConnection.hpp"
+#include "vmime/net/asyncEngine.hpp"
+
+#include <algorithm>
+
+
+namespace vmime {
+namespace net {
+
+
+asyncConnection::pendingResponse::pendingResponse()
+	: multiLine(false)
+{
+}
+
+
+asyncConnection::asyncConnection()
+	: m_literalRemaining(0)
+{
+}
+
+
+asyncConnection::~asyncConnection()
+{
+}
+
+
+void asyncConnection::sendCommand(const string& command, shared_ptr <asyncResponseHandler> handler)
+{
+	pendingResponse resp;
+	resp.handler = handler;
+
+	m_outBuffer += prepareCommand(command, resp);
+	m_pending.push_back(resp);
+
+	// Data will be sent when the socket is writable
+	shared_ptr <asyncEngine> engine = m_engine.lock();
+
+	if (engine)
+		engine->notifyOutputPending(dynamicCast <asyncConnection>(shared_from_this()));
+}
+
+
+void asyncConnection::expectResponse(shared_ptr <asyncResponseHandler> handler)
+{
+	pendingResponse resp;
+	resp.handler = handler;
+
+	m_pending.push_back(resp);
+}
+
+
+void asyncConnection::setUnsolicitedResponseHandler(shared_ptr <asyncResponseHandler> handler)
+{
+	m_unsolicitedHandler = handler;
+}
+
+
+size_t asyncConnection::getPendingResponseCount() const
+{
+	return m_pending.size();
+}
+
+
+bool asyncConnection::isConnected() const
+{
+	return m_socket != NULL;
+}
+
+
+shared_ptr <socket> asyncConnection::getSocket() const
+{
+	return m_socket;
+}
+
+
+void asyncConnection::attach(shared_ptr <socket> sok, shared_ptr <asyncEngine> engine)
+{
+	m_socket = sok;
+	m_engine = engine;
+}
+
+
+void asyncConnection::detach()
+{
+	m_socket = null;
+	m_engine.reset();
+
+	m_inBuffer.clear();
+	m_currentLine.clear();
+	m_literalRemaining = 0;
+}
+
+
+void asyncConnection::processInput()
+{
+	byte_t buffer[16384];
+
+	while (m_socket)
+	{
+		// Read until no more data is available; this also drains data
+		// buffered by a security layer
+		const size_t count = m_socket->receiveRaw(buffer, sizeof(buffer));
+
+		if (count == 0)
+			break;
+
+		m_inBuffer.append(reinterpret_cast <const char*>(buffer), count);
+
+		parseInput();
+	}
+}
+
+
+void asyncConnection::parseInput()
+{
+	size_t pos = 0;
+
+	while (pos < m_inBuffer.length())
+	{
+		// Raw data (literal)
+		if (m_literalRemaining != 0)
+		{
+			const size_t count = std::min(m_literalRemaining, m_inBuffer.length() - pos);
+
+			m_currentLine.append(m_inBuffer, pos, count);
+
+			pos += count;
+			m_literalRemaining -= count;
+
+			continue;
+		}
+
+		// Line
+		const size_t eol = m_inBuffer.find('\n', pos);
+
+		if (eol == string::npos)
+			break;
+
+		size_t end = eol;
+
+		if (end > pos && m_inBuffer[end - 1] == '\r')
+			--end;
+
+		m_currentLine.append(m_inBuffer, pos, end - pos);
+		pos = eol + 1;
+
+		size_t literalSize = 0;
+
+		if (getLiteralSize(m_currentLine, literalSize))
+		{
+			m_currentLine += "\r\n";
+			m_literalRemaining = literalSize;
+
+			continue;
+		}
+
+		string line;
+		line.swap(m_currentLine);
+
+		dispatchLine(line);
+
+		// Connection may have been closed by the handler
+		if (!m_socket)
+			return;
+	}
+
+	m_inBuffer.erase(0, pos);
+}
+
+
+void asyncConnection::dispatchLine(const string& line)
+{
+	shared_ptr <asyncConnection> thisConn = dynamicCast <asyncConnection>(shared_from_this());
+
+	if (m_pending.empty())
+	{
+		if (m_unsolicitedHandler)
+			m_unsolicitedHandler->onResponse(thisConn, std::vector <string>(1, line));
+
+		return;
+	}
+
+	if (processResponseLine(m_pending.front(), line))
+	{
+		// Remove the response before calling the handler, which may
+		// queue other commands
+		pendingResponse resp;
+		std::swap(resp.lines, m_pending.front().lines);
+		resp.handler = m_pending.front().handler;
+
+		m_pending.pop_front();
+
+		if (resp.handler)
+			resp.handler->onResponse(thisConn, resp.lines);
+	}
+}
+
+
+void asyncConnection::processOutput()
+{
+	while (m_socket && !m_outBuffer.empty())
+	{
+		const size_t count = m_socket->sendRawNonBlocking
+			(reinterpret_cast <const byte_t*>(m_outBuffer.data()), m_outBuffer.length());
+
+		if (count == 0)
+			break;
+
+		m_outBuffer.erase(0, count);
+	}
+}
+
+
+bool asyncConnection::hasPendingOutput() const
+{
+	return !m_outBuffer.empty();
+}
+
+
+bool asyncConnection::getLiteralSize(const string& /* line */, size_t& /* size */) const
+{
+	return false;
+}
+
+
+void asyncConnection::fail(const exception& e)
+{
+	detach();
+
+	m_outBuffer.clear();
+
+	std::deque <pendingResponse> pending;
+	pending.swap(m_pending);
+
+	shared_ptr <asyncConnection> thisConn = dynamicCast <asyncConnection>(shared_from_this());
+
+	for (std::deque <pendingResponse>::iterator it = pending.begin() ; it != pending.end() ; ++it)
+	{
+		if (it->handler)
+			it->handler->onError(thisConn, e);
+	}
+
+	if (m_unsolicitedHandler)
+		m_unsolicitedHandler->onError(thisConn, e);
+}
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
@@ -0,0 +1,225 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_ASYNCCONNECTION_HPP_INCLUDED
+#define VMIME_NET_ASYNCCONNECTION_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include <deque>
+#include <vector>
+
+#include "vmime/base.hpp"
+
+#include "vmime/net/socket.hpp"
+#include "vmime/net/asyncResponseHandler.hpp"
+
+
+namespace vmime {
+namespace net {
+
+
+class asyncEngine;
+
+
+/** A connection to a server which does not block the calling thread.
+  *
+  * Commands are queued with sendCommand(), and the handler is called
+  * when the complete response has been received. Commands can be
+  * pipelined: responses are matched to commands in order.
+  *
+  * Subclasses implement the framing of a specific protocol. Connections
+  * are driven by an asyncEngine, which calls processInput() and
+  * processOutput() when the socket is ready.
+  */
+class VMIME_EXPORT asyncConnection : public object
+{
+public:
+
+	virtual ~asyncConnection();
+
+	/** Queue a command to be sent to the server.
+	  *
+	  * @param command command line, without end-of-line sequence
+	  * @param handler handler to be notified of the response (may be NULL)
+	  */
+	void sendCommand(const string& command, shared_ptr <asyncResponseHandler> handler);
+
+	/** Wait for a response without sending a command (for example,
+	  * the greeting sent by the server after connection).
+	  *
+	  * @param handler handler to be notified of the response (may be NULL)
+	  */
+	void expectResponse(shared_ptr <asyncResponseHandler> handler);
+
+	/** Set the handler which receives the lines sent by the server
+	  * while no response is expected (for example, IMAP untagged
+	  * responses received during IDLE). Each line is notified separately.
+	  * The handler is also notified when the connection fails.
+	  *
+	  * @param handler handler for unsolicited responses, or NULL
+	  * to ignore them
+	  */
+	void setUnsolicitedResponseHandler(shared_ptr <asyncResponseHandler> handler);
+
+	/** Return whether a response denotes a successful completion,
+	  * according to the protocol.
+	  *
+	  * @param lines response lines, as passed to onResponse()
+	  * @return true if the command succeeded, false otherwise
+	  */
+	virtual bool isSuccessResponse(const std::vector <string>& lines) const = 0;
+
+	/** Return the number of responses not received yet.
+	  *
+	  * @return number of pending responses
+	  */
+	size_t getPendingResponseCount() const;
+
+	/** Return whether the connection is established.
+	  *
+	  * @return true if the connection is established, false otherwise
+	  */
+	bool isConnected() const;
+
+	/** Return the socket used by this connection.
+	  *
+	  * @return socket, or NULL if not connected
+	  */
+	shared_ptr <socket> getSocket() const;
+
+
+	/** Attach an established connection to this object. This is called
+	  * by the engine, and may be called again to replace the socket when
+	  * a security layer is added.
+	  *
+	  * @param sok connected socket
+	  * @param engine engine which drives this connection
+	  */
+	void attach(shared_ptr <socket> sok, shared_ptr <asyncEngine> engine);
+
+	/** Detach the socket from this object. This is called by the engine.
+	  */
+	void detach();
+
+	/** Read and process all available data. This is called by the
+	  * engine when data is available for reading.
+	  */
+	void processInput();
+
+	/** Send as much pending data as possible. This is called by the
+	  * engine when data can be written.
+	  */
+	void processOutput();
+
+	/** Return whether some data has not been sent yet.
+	  *
+	  * @return true if data is waiting to be sent, false otherwise
+	  */
+	bool hasPendingOutput() const;
+
+	/** Detach the socket, and notify all pending handlers (and the
+	  * handler for unsolicited responses) of an error.
+	  * This is called by the engine when the connection fails.
+	  *
+	  * @param e error
+	  */
+	void fail(const exception& e);
+
+protected:
+
+	asyncConnection();
+
+	/** A response which has not been received completely yet. */
+	struct pendingResponse
+	{
+		pendingResponse();
+
+		string tag;          /**< Protocol-specific response identifier. */
+		bool multiLine;      /**< Protocol-specific framing flag. */
+		std::vector <string> lines;
+
+		shared_ptr <asyncResponseHandler> handler;
+	};
+
+	/** Prepare a command for sending, and set up the matching
+	  * response information.
+	  *
+	  * @param command command line, as passed to sendCommand()
+	  * @param resp response information
+	  * @return data to send, including the end-of-line sequence
+	  */
+	virtual const string prepareCommand(const string& command, pendingResponse& resp) = 0;
+
+	/** Add a line to a response.
+	  *
+	  * @param resp response being received
+	  * @param line received line, without end-of-line sequence
+	  * @return true if the response is complete, false otherwise
+	  */
+	virtual bool processResponseLine(pendingResponse& resp, const string& line) = 0;
+
+	/** Return whether a line is followed by raw data (for example,
+	  * an IMAP literal), and its size. This data is included in the
+	  * line passed to processResponseLine(), along with the next line.
+	  *
+	  * @param line line received so far
+	  * @param size will receive the number of raw bytes which follow
+	  * (may be zero)
+	  * @return true if raw data follows the line, false otherwise
+	  */
+	virtual bool getLiteralSize(const string& line, size_t& size) const;
+
+private:
+
+	void parseInput();
+	void dispatchLine(const string& line);
+
+
+	shared_ptr <socket> m_socket;
+	weak_ptr <asyncEngine> m_engine;
+
+	std::deque <pendingResponse> m_pending;
+	shared_ptr <asyncResponseHandler> m_unsolicitedHandler;
+
+	string m_outBuffer;
+
+	string m_inBuffer;
+	string m_currentLine;
+	size_t m_literalRemaining;
+};
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
+
+#endif // VMIME_NET_ASYNCCONNECTION_HPP_INCLUDED
@@ -0,0 +1,139 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_ASYNCENGINE_HPP_INCLUDED
+#define VMIME_NET_ASYNCENGINE_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/base.hpp"
+
+#include "vmime/net/asyncConnection.hpp"
+
+#if VMIME_HAVE_TLS_SUPPORT
+#	include "vmime/net/tls/TLSSession.hpp"
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+
+namespace vmime {
+namespace net {
+
+
+/** An event loop which drives many asynchronous connections
+  * from a single thread.
+  *
+  * All the functions of the engine and of the connections it drives
+  * must be called from the same thread (usually, from response handlers
+  * called by run() or runOnce()).
+  */
+class VMIME_EXPORT asyncEngine : public object
+{
+public:
+
+	virtual ~asyncEngine() { }
+
+	/** Start connecting to a server. Commands may be queued on the
+	  * connection before it is established; they are sent as soon as
+	  * the connection is ready. If the connection fails, all pending
+	  * handlers are notified with onError().
+	  *
+	  * @param conn connection
+	  * @param address server address
+	  * @param port server port
+	  */
+	virtual void connect(shared_ptr <asyncConnection> conn, const string& address, const port_t port) = 0;
+
+#if VMIME_HAVE_TLS_SUPPORT
+
+	/** Start connecting to a server, and negotiate a TLS security
+	  * layer as soon as the connection is established (for example,
+	  * for IMAPS or POP3S).
+	  *
+	  * @param conn connection
+	  * @param address server address
+	  * @param port server port
+	  * @param tlsSession TLS session to use
+	  */
+	virtual void connectTLS(shared_ptr <asyncConnection> conn, const string& address,
+		const port_t port, shared_ptr <tls::TLSSession> tlsSession) = 0;
+
+	/** Negotiate a TLS security layer on an established connection,
+	  * after the server accepted a STARTTLS command.
+	  *
+	  * @param conn connection
+	  * @param tlsSession TLS session to use
+	  */
+	virtual void startTLS(shared_ptr <asyncConnection> conn, shared_ptr <tls::TLSSession> tlsSession) = 0;
+
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+	/** Close a connection. Pending handlers are notified with onError().
+	  *
+	  * @param conn connection
+	  */
+	virtual void disconnect(shared_ptr <asyncConnection> conn) = 0;
+
+	/** Wait for activity on the connections, and process it.
+	  *
+	  * @param msecs maximum time to wait, in milliseconds,
+	  * or -1 to wait indefinitely
+	  * @return number of connections on which activity occurred
+	  */
+	virtual size_t runOnce(const int msecs) = 0;
+
+	/** Process activity on the connections until stop() is called,
+	  * or until there is no more connection.
+	  */
+	virtual void run() = 0;
+
+	/** Make run() return as soon as possible.
+	  */
+	virtual void stop() = 0;
+
+	/** Return the number of connections driven by this engine.
+	  *
+	  * @return number of connections
+	  */
+	virtual size_t getConnectionCount() const = 0;
+
+	/** Called by connections when data has been queued for sending.
+	  *
+	  * @param conn connection
+	  */
+	virtual void notifyOutputPending(shared_ptr <asyncConnection> conn) = 0;
+};
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
+
+#endif // VMIME_NET_ASYNCENGINE_HPP_INCLUDED
@@ -0,0 +1,81 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_ASYNCRESPONSEHANDLER_HPP_INCLUDED
+#define VMIME_NET_ASYNCRESPONSEHANDLER_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include <vector>
+
+#include "vmime/base.hpp"
+#include "vmime/exception.hpp"
+
+
+namespace vmime {
+namespace net {
+
+
+class asyncConnection;
+
+
+/** Receives the completion of an asynchronous operation
+  * (see asyncConnection).
+  */
+class VMIME_EXPORT asyncResponseHandler : public object
+{
+public:
+
+	virtual ~asyncResponseHandler() { }
+
+	/** Called when the complete response to a command has been received.
+	  * The handler may send other commands on the connection.
+	  *
+	  * @param conn connection on which the response was received
+	  * @param lines response lines, without end-of-line sequences
+	  */
+	virtual void onResponse(shared_ptr <asyncConnection> conn, const std::vector <string>& lines) = 0;
+
+	/** Called when the command could not be completed because of
+	  * an error (connection failed or closed, socket error...).
+	  *
+	  * @param conn connection on which the error occurred
+	  * @param e error
+	  */
+	virtual void onError(shared_ptr <asyncConnection> conn, const exception& e) = 0;
+};
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
+
+#endif // VMIME_NET_ASYNCRESPONSEHANDLER_HPP_INCLUDED
@@ -0,0 +1,105 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/net/dsnAttributes.hpp"
+
+
+namespace vmime {
+namespace net {
+
+
+dsnAttributes::dsnAttributes()
+	: m_notifyFlags(0),
+	  m_returnType(RETURN_DEFAULT),
+	  m_sendOriginalRecipient(false)
+{
+}
+
+
+int dsnAttributes::getNotifyFlags() const
+{
+	return m_notifyFlags;
+}
+
+
+void dsnAttributes::setNotifyFlags(const int flags)
+{
+	m_notifyFlags = flags;
+}
+
+
+int dsnAttributes::getReturnType() const
+{
+	return m_returnType;
+}
+
+
+void dsnAttributes::setReturnType(const int type)
+{
+	m_returnType = type;
+}
+
+
+const string& dsnAttributes::getEnvelopeId() const
+{
+	return m_envelopeId;
+}
+
+
+void dsnAttributes::setEnvelopeId(const string& id)
+{
+	m_envelopeId = id;
+}
+
+
+bool dsnAttributes::getSendOriginalRecipient() const
+{
+	return m_sendOriginalRecipient;
+}
+
+
+void dsnAttributes::setSendOriginalRecipient(const bool send)
+{
+	m_sendOriginalRecipient = send;
+}
+
+
+bool dsnAttributes::isEmpty() const
+{
+	return m_notifyFlags == 0 && m_returnType == RETURN_DEFAULT &&
+		m_envelopeId.empty() && !m_sendOriginalRecipient;
+}
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
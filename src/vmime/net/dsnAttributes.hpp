@@ -0,0 +1,150 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_DSNATTRIBUTES_HPP_INCLUDED
+#define VMIME_NET_DSNATTRIBUTES_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/types.hpp"
+
+
+namespace vmime {
+namespace net {
+
+
+/** Holds a set of attributes for Delivery Status Notifications (DSN),
+  * as defined in RFC-3461. They are only used if the transport
+  * supports it (eg. SMTP servers with DSN extension).
+  */
+class VMIME_EXPORT dsnAttributes : public object
+{
+public:
+
+	/** Conditions for which a notification should be sent.
+	  */
+	enum NotifyFlags
+	{
+		NOTIFY_NEVER   = (1 << 0),   /**< Never send a notification. */
+		NOTIFY_SUCCESS = (1 << 1),   /**< Notify on successful delivery. */
+		NOTIFY_FAILURE = (1 << 2),   /**< Notify on delivery failure. */
+		NOTIFY_DELAY   = (1 << 3)    /**< Notify on delayed delivery. */
+	};
+
+	/** Which part of the message should be returned with a notification.
+	  */
+	enum ReturnTypes
+	{
+		RETURN_DEFAULT,   /**< Let the server decide. */
+		RETURN_FULL,      /**< Return the full message. */
+		RETURN_HEADERS    /**< Return only the message header. */
+	};
+
+
+	/** Construct a new dsnAttributes object. By default, no DSN
+	  * parameter is sent and the server behaviour applies.
+	  */
+	dsnAttributes();
+
+	/** Return the conditions for which a notification is requested.
+	  *
+	  * @return combination of one or more flags (see dsnAttributes::NotifyFlags
+	  * enum), or 0 to use the server default
+	  */
+	int getNotifyFlags() const;
+
+	/** Set the conditions for which a notification is requested.
+	  * NOTIFY_NEVER must not be combined with other flags.
+	  *
+	  * @param flags combination of one or more flags (see dsnAttributes::NotifyFlags
+	  * enum), or 0 to use the server default
+	  */
+	void setNotifyFlags(const int flags);
+
+	/** Return which part of the message is returned with a notification.
+	  *
+	  * @return return type (see dsnAttributes::ReturnTypes enum)
+	  */
+	int getReturnType() const;
+
+	/** Set which part of the message is returned with a notification.
+	  *
+	  * @param type return type (see dsnAttributes::ReturnTypes enum)
+	  */
+	void setReturnType(const int type);
+
+	/** Return the envelope identifier which is included in notifications.
+	  *
+	  * @return envelope identifier, or empty if none
+	  */
+	const string& getEnvelopeId() const;
+
+	/** Set the envelope identifier which is included in notifications.
+	  *
+	  * @param id envelope identifier, or empty if none
+	  */
+	void setEnvelopeId(const string& id);
+
+	/** Return whether the original recipient address is sent
+	  * along with each recipient (ORCPT parameter).
+	  *
+	  * @return true if the original recipient is sent, false otherwise
+	  */
+	bool getSendOriginalRecipient() const;
+
+	/** Set whether the original recipient address is sent
+	  * along with each recipient (ORCPT parameter).
+	  *
+	  * @param send true to send the original recipient, false otherwise
+	  */
+	void setSendOriginalRecipient(const bool send);
+
+	/** Return whether no DSN attribute has been set.
+	  *
+	  * @return true if no DSN parameter needs to be sent, false otherwise
+	  */
+	bool isEmpty() const;
+
+private:
+
+	int m_notifyFlags;
+	int m_returnType;
+	string m_envelopeId;
+	bool m_sendOriginalRecipient;
+};
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
+
+
+#endif // VMIME_NET_DSNATTRIBUTES_HPP_INCLUDED
@@ -29,6 +29,8 @@
 
 #include "vmime/net/fetchAttributes.hpp"
 
+#include "vmime/constants.hpp"
+
 #include "vmime/utility/stringUtils.hpp"
 
 #include <algorithm>
@@ -88,6 +90,43 @@ const std::vector <string> fetchAttributes::getHeaderFields() const
 }
 
 
+const std::vector <string> fetchAttributes::getRequiredHeaderFields() const
+{
+	std::vector <string> fields;
+
+	if (has(ENVELOPE))
+	{
+		fields.push_back(vmime::fields::FROM);
+		fields.push_back(vmime::fields::SENDER);
+		fields.push_back(vmime::fields::REPLY_TO);
+		fields.push_back(vmime::fields::TO);
+		fields.push_back(vmime::fields::CC);
+		fields.push_back(vmime::fields::BCC);
+		fields.push_back(vmime::fields::DATE);
+		fields.push_back(vmime::fields::SUBJECT);
+	}
+
+	if (has(CONTENT_INFO))
+		fields.push_back(vmime::fields::CONTENT_TYPE);
+
+	if (has(IMPORTANCE))
+	{
+		fields.push_back("Importance");
+		fields.push_back(vmime::fields::X_PRIORITY);
+	}
+
+	fields.insert(fields.end(), m_headers.begin(), m_headers.end());
+
+	return fields;
+}
+
+
+bool fetchAttributes::isHeaderRequired() const
+{
+	return has(ENVELOPE | CONTENT_INFO | FULL_HEADER | IMPORTANCE) || !m_headers.empty();
+}
+
+
 } // net
 } // vmime
 
@@ -86,8 +86,9 @@ public:
 	void add(const int attribs);
 
 	/** Adds the specified header field to the set of attributes to fetch.
-	  * Fetching custom header fields is not supported by all protocols.
-	  * At this time, only IMAP supports this.
+	  * With IMAP, only the requested fields are sent by the server. With
+	  * POP3 and maildir, the whole header is read but only the requested
+	  * fields are parsed.
 	  *
 	  * @param header name of header field (eg. "X-Mailer")
 	  */
@@ -125,6 +126,23 @@ public:
 	  */
 	const std::vector <string> getHeaderFields() const;
 
+	/** Returns the header fields which hold the requested attributes:
+	  * the fields needed for ENVELOPE, CONTENT_INFO and IMPORTANCE,
+	  * followed by the custom header fields. This is not meaningful
+	  * if FULL_HEADER is requested, as all fields are needed then.
+	  *
+	  * @return list of header names (eg. "From", "x-mailer")
+	  */
+	const std::vector <string> getRequiredHeaderFields() const;
+
+	/** Returns true if the set contains attributes which are taken
+	  * from the message header (ENVELOPE, CONTENT_INFO, FULL_HEADER,
+	  * IMPORTANCE or custom header fields).
+	  *
+	  * @return true if the header has to be fetched
+	  */
+	bool isHeaderRequired() const;
+
 private:
 
 	int m_predefinedAttribs;
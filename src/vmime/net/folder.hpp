@@ -305,6 +305,8 @@ public:
 	  * @return a message set containing the number(s) or UID(s) of the copied message(s),
 	  * or an empty set if the information could not be obtained (ie. the server does not
 	  * support returning the number or UID of a copied message)
+	  * @throw exceptions::partial_command_error if the messages were copied
+	  * using several commands, and only some of them succeeded
 	  * @throw exceptions::net_exception if an error occurs
 	  */
 	virtual messageSet copyMessages
@@ -0,0 +1,164 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+
+#include "vmime/net/imap/IMAPAsyncConnection.hpp"
+#include "vmime/net/imap/IMAPTag.hpp"
+#include "vmime/net/imap/IMAPUtils.hpp"
+
+#include "vmime/utility/stringUtils.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+IMAPAsyncConnection::IMAPAsyncConnection()
+	: m_tag(make_shared <IMAPTag>())
+{
+}
+
+
+IMAPAsyncConnection::~IMAPAsyncConnection()
+{
+}
+
+
+void IMAPAsyncConnection::expectGreeting(shared_ptr <asyncResponseHandler> handler)
+{
+	expectResponse(handler);
+}
+
+
+void IMAPAsyncConnection::login
+	(const string& username, const string& password, shared_ptr <asyncResponseHandler> handler)
+{
+	sendCommand("LOGIN " + IMAPUtils::quoteString(username)
+		+ " " + IMAPUtils::quoteString(password), handler);
+}
+
+
+const string IMAPAsyncConnection::prepareCommand(const string& command, pendingResponse& resp)
+{
+	++(*m_tag);
+	resp.tag = string(*m_tag);
+
+	return resp.tag + " " + command + "\r\n";
+}
+
+
+bool IMAPAsyncConnection::processResponseLine(pendingResponse& resp, const string& line)
+{
+	resp.lines.push_back(line);
+
+	// Greeting
+	if (resp.tag.empty())
+		return true;
+
+	// Continuation request
+	if (!line.empty() && line[0] == '+')
+		return true;
+
+	// Tagged completion
+	return line.length() > resp.tag.length() &&
+	       line.compare(0, resp.tag.length(), resp.tag) == 0 &&
+	       line[resp.tag.length()] == ' ';
+}
+
+
+bool IMAPAsyncConnection::getLiteralSize(const string& line, size_t& size) const
+{
+	// Literal: "{<size>}" or "{<size>+}" at end of line
+	if (line.empty() || line[line.length() - 1] != '}')
+		return false;
+
+	const size_t begin = line.find_last_of('{');
+
+	if (begin == string::npos)
+		return false;
+
+	size_t value = 0;
+	bool digits = false;
+
+	for (size_t i = begin + 1 ; i < line.length() - 1 ; ++i)
+	{
+		const char c = line[i];
+
+		if (c >= '0' && c <= '9')
+		{
+			value = value * 10 + (c - '0');
+			digits = true;
+		}
+		else if (!(c == '+' && i == line.length() - 2))
+		{
+			return false;
+		}
+	}
+
+	if (!digits)
+		return false;
+
+	size = value;
+
+	return true;
+}
+
+
+bool IMAPAsyncConnection::isSuccessResponse(const std::vector <string>& lines) const
+{
+	if (lines.empty())
+		return false;
+
+	const string& line = lines.back();
+
+	// Continuation request
+	if (!line.empty() && line[0] == '+')
+		return true;
+
+	// Status follows the tag (or "*" for the greeting)
+	const size_t sp = line.find(' ');
+
+	if (sp == string::npos)
+		return false;
+
+	const size_t end = line.find(' ', sp + 1);
+	const string status = utility::stringUtils::toUpper
+		(string(line.begin() + sp + 1, end == string::npos ? line.end() : line.begin() + end));
+
+	return status == "OK" || (line[0] == '*' && status == "PREAUTH");
+}
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
@@ -0,0 +1,96 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_IMAP_IMAPASYNCCONNECTION_HPP_INCLUDED
+#define VMIME_NET_IMAP_IMAPASYNCCONNECTION_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+
+#include "vmime/net/asyncConnection.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+class IMAPTag;
+
+
+/** An asynchronous connection to an IMAP server (see asyncEngine).
+  *
+  * Commands are automatically prefixed with a tag. A response is made
+  * of the untagged lines received before the tagged completion line.
+  * Literals are included in the line they belong to. A continuation
+  * request ("+") also completes the response, so that the handler
+  * can send the continuation data.
+  */
+class VMIME_EXPORT IMAPAsyncConnection : public asyncConnection
+{
+public:
+
+	IMAPAsyncConnection();
+	~IMAPAsyncConnection();
+
+	/** Wait for the greeting sent by the server after connection.
+	  *
+	  * @param handler handler to be notified of the greeting
+	  */
+	void expectGreeting(shared_ptr <asyncResponseHandler> handler);
+
+	/** Authenticate with the LOGIN command.
+	  *
+	  * @param username user name
+	  * @param password password
+	  * @param handler handler to be notified of the response
+	  */
+	void login(const string& username, const string& password, shared_ptr <asyncResponseHandler> handler);
+
+	bool isSuccessResponse(const std::vector <string>& lines) const;
+
+protected:
+
+	const string prepareCommand(const string& command, pendingResponse& resp);
+	bool processResponseLine(pendingResponse& resp, const string& line);
+	bool getLiteralSize(const string& line, size_t& size) const;
+
+private:
+
+	shared_ptr <IMAPTag> m_tag;
+};
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+#endif // VMIME_NET_IMAP_IMAPASYNCCONNECTION_HPP_INCLUDED
@@ -0,0 +1,107 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+
+#include "vmime/net/imap/IMAPCache.hpp"
+
+#include "vmime/utility/outputStreamStringAdapter.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+
+// Keeps the contents in memory until they are committed
+class memoryPartContentsWriter : public IMAPCache::partContentsWriter
+{
+public:
+
+	memoryPartContentsWriter(IMAPCache* cache, const string& mailbox, const vmime_uint32 uidValidity,
+	                         const message::uid& uid, const string& section)
+		: m_cache(cache), m_mailbox(mailbox), m_uidValidity(uidValidity),
+		  m_uid(uid), m_section(section), m_stream(m_data)
+	{
+	}
+
+	utility::outputStream& getOutputStream()
+	{
+		return m_stream;
+	}
+
+	void commit()
+	{
+		m_stream.flush();
+		m_cache->putPartContents(m_mailbox, m_uidValidity, m_uid, m_section, m_data);
+	}
+
+private:
+
+	IMAPCache* m_cache;
+
+	const string m_mailbox;
+	const vmime_uint32 m_uidValidity;
+	const message::uid m_uid;
+	const string m_section;
+
+	string m_data;
+	utility::outputStreamStringAdapter m_stream;
+};
+
+
+} // unnamed namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+IMAPCache::messageInfo::messageInfo()
+	: attributes(0), size(0), flags(0), modSequence(0), highestModSequence(0)
+{
+}
+
+
+shared_ptr <IMAPCache::partContentsWriter> IMAPCache::createPartContentsWriter
+	(const string& mailbox, const vmime_uint32 uidValidity,
+	 const message::uid& uid, const string& section)
+{
+	return make_shared <memoryPartContentsWriter>(this, mailbox, uidValidity, uid, section);
+}
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
@@ -0,0 +1,206 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_NET_IMAP_IMAPCACHE_HPP_INCLUDED
+#define VMIME_NET_IMAP_IMAPCACHE_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+
+#include "vmime/types.hpp"
+
+#include "vmime/net/message.hpp"
+
+#include "vmime/utility/outputStream.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+/** Local cache for IMAP message data, which survives the store being
+  * closed and reopened.
+  *
+  * Entries are identified by the mailbox name, the mailbox UIDVALIDITY
+  * and the message UID. As messages cannot change on the server once
+  * they have been stored (only their flags can), the structure, the
+  * header and the contents can be reused until UIDVALIDITY changes.
+  *
+  * Implementations must be thread-safe.
+  */
+
+class VMIME_EXPORT IMAPCache : public object
+{
+public:
+
+	/** Cacheable data about a message.
+	  */
+	class VMIME_EXPORT messageInfo
+	{
+	public:
+
+		messageInfo();
+
+		/** Set of fetchAttributes::Attributes flags which tell
+		  * which of the following items are available. */
+		int attributes;
+
+		/** Serialized MIME structure of the message (STRUCTURE). */
+		string structure;
+
+		/** Message header (ENVELOPE, CONTENT_INFO, IMPORTANCE or
+		  * FULL_HEADER). */
+		string header;
+
+		/** Size of the message (SIZE). */
+		size_t size;
+
+		/** Message flags (FLAGS). */
+		int flags;
+
+		/** Modification sequence of the message, if known. */
+		vmime_uint64 modSequence;
+
+		/** Highest modification sequence of the mailbox at the time
+		  * the flags were fetched. Cached flags are only used if it
+		  * has not changed since then. */
+		vmime_uint64 highestModSequence;
+	};
+
+
+	/** Stores the contents of a message section into the cache while
+	  * they are received from the server.
+	  */
+	class VMIME_EXPORT partContentsWriter : public object
+	{
+	public:
+
+		virtual ~partContentsWriter() { }
+
+		/** Return the stream into which the contents are written.
+		  *
+		  * @return output stream
+		  */
+		virtual utility::outputStream& getOutputStream() = 0;
+
+		/** Store the contents written so far. If this is not called
+		  * (eg. the fetch failed), the contents are discarded when
+		  * the writer is destroyed.
+		  */
+		virtual void commit() = 0;
+	};
+
+
+	virtual ~IMAPCache() { }
+
+	/** Called when a mailbox is opened. Entries stored for another
+	  * UIDVALIDITY value can be discarded.
+	  *
+	  * @param mailbox mailbox name
+	  * @param uidValidity current UIDVALIDITY of the mailbox
+	  */
+	virtual void validateMailbox(const string& mailbox, const vmime_uint32 uidValidity) = 0;
+
+	/** Retrieve the cached data about a message.
+	  *
+	  * @param mailbox mailbox name
+	  * @param uidValidity UIDVALIDITY of the mailbox
+	  * @param uid message UID
+	  * @param info will receive the cached data
+	  * @return true if data was found for this message, false otherwise
+	  */
+	virtual bool getMessageInfo(const string& mailbox, const vmime_uint32 uidValidity,
+		const message::uid& uid, messageInfo& info) = 0;
+
+	/** Store data about a message. Any previous data is replaced.
+	  *
+	  * @param mailbox mailbox name
+	  * @param uidValidity UIDVALIDITY of the mailbox
+	  * @param uid message UID
+	  * @param info data to store
+	  */
+	virtual void putMessageInfo(const string& mailbox, const vmime_uint32 uidValidity,
+		const message::uid& uid, const messageInfo& info) = 0;
+
+	/** Retrieve the cached contents of a message section.
+	  *
+	  * @param mailbox mailbox name
+	  * @param uidValidity UIDVALIDITY of the mailbox
+	  * @param uid message UID
+	  * @param section IMAP section specification (eg. "1.2", "TEXT")
+	  * @param os stream into which the contents will be written
+	  * @return true if the contents were found, false otherwise
+	  */
+	virtual bool getPartContents(const string& mailbox, const vmime_uint32 uidValidity,
+		const message::uid& uid, const string& section, utility::outputStream& os) = 0;
+
+	/** Store the contents of a message section. Implementations may
+	  * choose not to store contents.
+	  *
+	  * @param mailbox mailbox name
+	  * @param uidValidity UIDVALIDITY of the mailbox
+	  * @param uid message UID
+	  * @param section IMAP section specification (eg. "1.2", "TEXT")
+	  * @param data section contents
+	  */
+	virtual void putPartContents(const string& mailbox, const vmime_uint32 uidValidity,
+		const message::uid& uid, const string& section, const string& data) = 0;
+
+	/** Create a writer for storing the contents of a message section
+	  * while they are received. The default implementation keeps the
+	  * contents in memory and calls putPartContents() on commit.
+	  *
+	  * @param mailbox mailbox name
+	  * @param uidValidity UIDVALIDITY of the mailbox
+	  * @param uid message UID
+	  * @param section IMAP section specification (eg. "1.2", "TEXT")
+	  * @return writer, or NULL if the contents are not to be stored
+	  */
+	virtual shared_ptr <partContentsWriter> createPartContentsWriter
+		(const string& mailbox, const vmime_uint32 uidValidity,
+		 const message::uid& uid, const string& section);
+
+	/** Remove all data cached about a message.
+	  *
+	  * @param mailbox mailbox name
+	  * @param uidValidity UIDVALIDITY of the mailbox
+	  * @param uid message UID
+	  */
+	virtual void removeMessage(const string& mailbox, const vmime_uint32 uidValidity,
+		const message::uid& uid) = 0;
+};
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+#endif // VMIME_NET_IMAP_IMAPCACHE_HPP_INCLUDED
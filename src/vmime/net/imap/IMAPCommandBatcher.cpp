@@ -0,0 +1,407 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+
+#include "vmime/net/imap/IMAPCommandBatcher.hpp"
+#include "vmime/net/imap/IMAPConnection.hpp"
+#include "vmime/net/imap/IMAPServiceInfos.hpp"
+#include "vmime/net/imap/IMAPStore.hpp"
+#include "vmime/net/imap/IMAPUtils.hpp"
+
+#include "vmime/net/numberSet.hpp"
+
+#include "vmime/exception.hpp"
+
+#include <map>
+#include <set>
+#include <stdexcept>
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+
+class batchMessageSetEnumerator : public messageSetEnumerator
+{
+public:
+
+	batchMessageSetEnumerator()
+		: m_uid(false), m_splittable(true)
+	{
+	}
+
+	void enumerateNumberMessageRange(const vmime::net::numberMessageRange& range)
+	{
+		if (range.getLast() == -1)
+			m_splittable = false;
+		else
+			m_set.add(range.getFirst(), range.getLast());
+	}
+
+	void enumerateUIDMessageRange(const vmime::net::UIDMessageRange& range)
+	{
+		m_uid = true;
+
+		const string first = range.getFirst();
+		const string last = range.getLast();
+
+		try
+		{
+			m_set.unionWith(numberSet::fromSequenceSet(first == last ? first : first + ":" + last));
+		}
+		catch (std::invalid_argument&)
+		{
+			// "*" or non-numeric UID: the set cannot be split
+			m_splittable = false;
+		}
+	}
+
+	const numberSet& set() const
+	{
+		return m_set;
+	}
+
+	bool isUID() const
+	{
+		return m_uid;
+	}
+
+	bool isSplittable() const
+	{
+		return m_splittable;
+	}
+
+private:
+
+	numberSet m_set;
+	bool m_uid;
+	bool m_splittable;
+};
+
+
+size_t digitCount(numberSet::value_type value)
+{
+	size_t count = 1;
+
+	while (value >= 10)
+	{
+		value /= 10;
+		++count;
+	}
+
+	return count;
+}
+
+
+} // unnamed namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+const size_t IMAPCommandBatcher::DEFAULT_MAX_COMMAND_LENGTH;
+const size_t IMAPCommandBatcher::DEFAULT_MAX_MESSAGES_PER_COMMAND;
+const size_t IMAPCommandBatcher::DEFAULT_MAX_COMMANDS_IN_FLIGHT;
+
+
+IMAPCommandBatcher::IMAPCommandBatcher()
+	: m_maxCommandLength(DEFAULT_MAX_COMMAND_LENGTH),
+	  m_maxMessagesPerCommand(DEFAULT_MAX_MESSAGES_PER_COMMAND),
+	  m_maxCommandsInFlight(DEFAULT_MAX_COMMANDS_IN_FLIGHT)
+{
+}
+
+
+IMAPCommandBatcher::IMAPCommandBatcher(shared_ptr <IMAPConnection> cnt)
+	: m_maxCommandLength(DEFAULT_MAX_COMMAND_LENGTH),
+	  m_maxMessagesPerCommand(DEFAULT_MAX_MESSAGES_PER_COMMAND),
+	  m_maxCommandsInFlight(DEFAULT_MAX_COMMANDS_IN_FLIGHT)
+{
+	shared_ptr <IMAPStore> store = cnt->getStore();
+
+	if (store)
+	{
+		const IMAPServiceInfos& infos =
+			dynamic_cast <const IMAPServiceInfos&>(store->getInfos());
+		const IMAPServiceInfos::props& props = infos.getProperties();
+
+		shared_ptr <session> sess = cnt->getSession();
+
+		m_maxCommandLength = infos.getPropertyValue <size_t>
+			(sess, props.PROPERTY_OPTIONS_BATCH_MAXCOMMANDLENGTH);
+		m_maxMessagesPerCommand = infos.getPropertyValue <size_t>
+			(sess, props.PROPERTY_OPTIONS_BATCH_MAXMESSAGES);
+		m_maxCommandsInFlight = infos.getPropertyValue <size_t>
+			(sess, props.PROPERTY_OPTIONS_BATCH_MAXINFLIGHT);
+	}
+}
+
+
+void IMAPCommandBatcher::setMaxCommandLength(const size_t len)
+{
+	m_maxCommandLength = len;
+}
+
+
+size_t IMAPCommandBatcher::getMaxCommandLength() const
+{
+	return m_maxCommandLength;
+}
+
+
+void IMAPCommandBatcher::setMaxMessagesPerCommand(const size_t count)
+{
+	m_maxMessagesPerCommand = count;
+}
+
+
+size_t IMAPCommandBatcher::getMaxMessagesPerCommand() const
+{
+	return m_maxMessagesPerCommand;
+}
+
+
+void IMAPCommandBatcher::setMaxCommandsInFlight(const size_t count)
+{
+	m_maxCommandsInFlight = count;
+}
+
+
+size_t IMAPCommandBatcher::getMaxCommandsInFlight() const
+{
+	return m_maxCommandsInFlight;
+}
+
+
+const std::vector <messageSet> IMAPCommandBatcher::split
+	(const messageSet& msgs, const size_t reservedLength) const
+{
+	std::vector <messageSet> chunks;
+
+	batchMessageSetEnumerator en;
+	msgs.enumerate(en);
+
+	if (!en.isSplittable() || en.set().isEmpty())
+	{
+		chunks.push_back(msgs);
+		return chunks;
+	}
+
+	const size_t maxLength = (m_maxCommandLength > reservedLength)
+		? m_maxCommandLength - reservedLength : 1;
+	const vmime_uint64 maxCount = (m_maxMessagesPerCommand != 0)
+		? m_maxMessagesPerCommand : static_cast <vmime_uint64>(-1);
+
+	const numberSet& set = en.set();
+
+	numberSet chunk;
+	size_t chunkLength = 0;
+	vmime_uint64 chunkCount = 0;
+
+	for (size_t i = 0, n = set.getRangeCount() ; i < n ; ++i)
+	{
+		const numberSet::range& r = set.getRangeAt(i);
+
+		numberSet::value_type first = r.first;
+
+		for (;;)
+		{
+			// Cut the range so that the chunk does not exceed the
+			// maximum message count
+			numberSet::value_type last = r.second;
+
+			const vmime_uint64 remaining = maxCount - chunkCount;
+
+			if (static_cast <vmime_uint64>(last) - first + 1 > remaining)
+				last = static_cast <numberSet::value_type>(first + remaining - 1);
+
+			size_t length = digitCount(first);
+
+			if (last != first)
+				length += 1 + digitCount(last);
+
+			if (!chunk.isEmpty())
+				length += 1;  // ','
+
+			// Start a new chunk if this one is full
+			if (!chunk.isEmpty() && (chunkLength + length > maxLength || remaining == 0))
+			{
+				chunks.push_back(en.isUID() ? messageSet::byUID(chunk) : messageSet::byNumber(chunk));
+
+				chunk.clear();
+				chunkLength = 0;
+				chunkCount = 0;
+
+				continue;
+			}
+
+			chunk.add(first, last);
+			chunkLength += length;
+			chunkCount += static_cast <vmime_uint64>(last) - first + 1;
+
+			if (last == r.second)
+				break;
+
+			first = last + 1;
+		}
+	}
+
+	if (!chunk.isEmpty())
+		chunks.push_back(en.isUID() ? messageSet::byUID(chunk) : messageSet::byNumber(chunk));
+
+	return chunks;
+}
+
+
+const std::vector <string> IMAPCommandBatcher::buildCommands
+	(const messageSet& msgs, const string& prefix, const string& suffix) const
+{
+	const std::vector <messageSet> chunks = split(msgs, prefix.length() + suffix.length());
+
+	std::vector <string> commands;
+	commands.reserve(chunks.size());
+
+	for (std::vector <messageSet>::const_iterator it = chunks.begin() ; it != chunks.end() ; ++it)
+		commands.push_back(prefix + IMAPUtils::messageSetToSequenceSet(*it) + suffix);
+
+	return commands;
+}
+
+
+void IMAPCommandBatcher::execute(shared_ptr <IMAPConnection> cnt, const string& name,
+	const std::vector <string>& commands, responseHandler& handler) const
+{
+	const size_t maxInFlight = (m_maxCommandsInFlight != 0) ? m_maxCommandsInFlight : 1;
+
+	std::map <string, size_t> inFlight;  // tag -> command index
+	std::set <string> tags;
+
+	size_t next = 0;
+
+	bool failed = false;
+	string errorLog;
+
+	while (next < commands.size() || !inFlight.empty())
+	{
+		// Fill the window, unless a command has failed
+		while (!failed && next < commands.size() && inFlight.size() < maxInFlight)
+		{
+			const string tag = cnt->sendCommand(commands[next]);
+
+			inFlight[tag] = next++;
+			tags.insert(tag);
+		}
+
+		if (inFlight.empty())
+			break;
+
+		// Wait for the completion of any of the commands in flight
+		string tag;
+		std::auto_ptr <IMAPParser::response> resp(cnt->readResponse(tags, tag));
+
+		const size_t index = inFlight[tag];
+
+		inFlight.erase(tag);
+		tags.erase(tag);
+
+		if (resp->isBad() || resp->response_done()->response_tagged()->
+			resp_cond_state()->status() != IMAPParser::resp_cond_state::OK)
+		{
+			if (!failed && handler.handleError(index, resp.get()))
+				continue;
+
+			if (!failed)
+			{
+				failed = true;
+				errorLog = resp->getErrorLog();
+			}
+
+			continue;
+		}
+
+		if (failed)
+		{
+			// This command was applied although another one failed:
+			// let the handler know, but do not report its errors
+			try
+			{
+				handler.handleResponse(index, resp.get());
+			}
+			catch (...)
+			{
+				// Ignore
+			}
+
+			continue;
+		}
+
+		try
+		{
+			handler.handleResponse(index, resp.get());
+		}
+		catch (...)
+		{
+			// Read the remaining responses so that the connection
+			// stays usable, then propagate the error
+			try
+			{
+				while (!inFlight.empty())
+				{
+					string t;
+					delete cnt->readResponse(tags, t);
+
+					inFlight.erase(t);
+					tags.erase(t);
+				}
+			}
+			catch (...)
+			{
+				// Ignore
+			}
+
+			throw;
+		}
+	}
+
+	if (failed)
+		throw exceptions::command_error(name, errorLog, "bad response");
+}
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
@@ -0,0 +1,205 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_NET_IMAP_IMAPCOMMANDBATCHER_HPP_INCLUDED
+#define VMIME_NET_IMAP_IMAPCOMMANDBATCHER_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+
+#include "vmime/types.hpp"
+
+#include "vmime/net/messageSet.hpp"
+#include "vmime/net/imap/IMAPParser.hpp"
+
+#include <vector>
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+class IMAPConnection;
+
+
+/** Splits commands addressing large message sets (FETCH, STORE, COPY)
+  * into several smaller commands, and runs them with a bounded number
+  * of commands in flight.
+  *
+  * Some servers reject command lines longer than a few kilobytes, and
+  * a single command on a huge set keeps the whole response in memory
+  * before it can be processed.
+  */
+
+class VMIME_EXPORT IMAPCommandBatcher
+{
+public:
+
+	/** Receives the response to each command of a batch.
+	  */
+	class VMIME_EXPORT responseHandler
+	{
+	public:
+
+		virtual ~responseHandler() { }
+
+		/** Called when a command of the batch has completed
+		  * successfully. Responses are handled in the order in
+		  * which they are received.
+		  *
+		  * @param index index of the command in the batch
+		  * @param resp server response to the command
+		  */
+		virtual void handleResponse(const size_t index, const IMAPParser::response* resp) = 0;
+
+		/** Called when a command of the batch has failed. By default,
+		  * the batch is aborted.
+		  *
+		  * @param index index of the command in the batch
+		  * @param resp server response to the command
+		  * @return true to ignore the error and go on with the
+		  * next commands, or false to abort the batch
+		  */
+		virtual bool handleError(const size_t /* index */, const IMAPParser::response* /* resp */)
+		{
+			return false;
+		}
+	};
+
+
+	static const size_t DEFAULT_MAX_COMMAND_LENGTH = 8192;
+	static const size_t DEFAULT_MAX_MESSAGES_PER_COMMAND = 1000;
+	static const size_t DEFAULT_MAX_COMMANDS_IN_FLIGHT = 1;
+
+
+	/** Construct a batcher with default limits.
+	  */
+	IMAPCommandBatcher();
+
+	/** Construct a batcher using the limits set in the session
+	  * properties of the specified connection.
+	  *
+	  * @param cnt IMAP connection
+	  */
+	IMAPCommandBatcher(shared_ptr <IMAPConnection> cnt);
+
+	/** Set the maximum length of a command, excluding the tag
+	  * and the line terminator.
+	  *
+	  * @param len maximum command length
+	  */
+	void setMaxCommandLength(const size_t len);
+
+	/** Return the maximum length of a command.
+	  *
+	  * @return maximum command length
+	  */
+	size_t getMaxCommandLength() const;
+
+	/** Set the maximum number of messages a single command
+	  * may address. Zero means no limit.
+	  *
+	  * @param count maximum number of messages per command
+	  */
+	void setMaxMessagesPerCommand(const size_t count);
+
+	/** Return the maximum number of messages a single command
+	  * may address.
+	  *
+	  * @return maximum number of messages per command
+	  */
+	size_t getMaxMessagesPerCommand() const;
+
+	/** Set how many commands may be sent before waiting for
+	  * their completion. A value of 1 disables pipelining.
+	  *
+	  * @param count maximum number of commands in flight
+	  */
+	void setMaxCommandsInFlight(const size_t count);
+
+	/** Return how many commands may be sent before waiting
+	  * for their completion.
+	  *
+	  * @return maximum number of commands in flight
+	  */
+	size_t getMaxCommandsInFlight() const;
+
+	/** Split a message set into sets small enough to fit the limits.
+	  * Sets containing a range which extends to the last message in
+	  * the folder are returned unchanged.
+	  *
+	  * @param msgs message set to split
+	  * @param reservedLength length of the command text, without
+	  * the sequence set
+	  * @return list of message sets, in ascending order
+	  */
+	const std::vector <messageSet> split(const messageSet& msgs, const size_t reservedLength) const;
+
+	/** Split a message set and build one command for each part.
+	  * Each command is made of the prefix, the IMAP sequence set
+	  * and the suffix.
+	  *
+	  * @param msgs message set
+	  * @param prefix command text before the sequence set (eg. "STORE ")
+	  * @param suffix command text after the sequence set
+	  * @return list of commands
+	  */
+	const std::vector <string> buildCommands
+		(const messageSet& msgs, const string& prefix, const string& suffix) const;
+
+	/** Send the specified commands and wait for their completion.
+	  * If a command fails and the handler does not ignore the error,
+	  * no more commands are sent and the remaining responses are read
+	  * before an exception is thrown. Commands in flight which succeed
+	  * meanwhile are still passed to the handler.
+	  *
+	  * @param cnt IMAP connection
+	  * @param name command name, for error reporting
+	  * @param commands commands to send
+	  * @param handler receives the response to each command
+	  * @throw exceptions::command_error if a command failed
+	  */
+	void execute(shared_ptr <IMAPConnection> cnt, const string& name,
+		const std::vector <string>& commands, responseHandler& handler) const;
+
+private:
+
+	size_t m_maxCommandLength;
+	size_t m_maxMessagesPerCommand;
+	size_t m_maxCommandsInFlight;
+};
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+#endif // VMIME_NET_IMAP_IMAPCOMMANDBATCHER_HPP_INCLUDED
@@ -36,6 +36,7 @@
 #include "vmime/platform.hpp"
 
 #include "vmime/utility/stringUtils.hpp"
+#include "vmime/utility/instrumentation.hpp"
 
 #include "vmime/net/defaultConnectionInfos.hpp"
 
@@ -68,7 +69,8 @@ namespace imap {
 IMAPConnection::IMAPConnection(shared_ptr <IMAPStore> store, shared_ptr <security::authenticator> auth)
 	: m_store(store), m_auth(auth), m_socket(null), m_parser(null), m_tag(null),
 	  m_hierarchySeparator('\0'), m_state(STATE_NONE), m_timeoutHandler(null),
-	  m_secured(false), m_firstTag(true), m_capabilitiesFetched(false), m_noModSeq(false)
+	  m_secured(false), m_firstTag(true), m_capabilitiesFetched(false), m_noModSeq(false),
+	  m_awaitingResponse(false)
 {
 }
 
@@ -262,7 +264,7 @@ void IMAPConnection::authenticate()
 	send(true, "LOGIN " + IMAPUtils::quoteString(username)
 		+ " " + IMAPUtils::quoteString(password), true);
 
-	std::auto_ptr <IMAPParser::response> resp(m_parser->readResponse());
+	std::auto_ptr <IMAPParser::response> resp(readResponse());
 
 	if (resp->isBad())
 	{
@@ -359,7 +361,7 @@ void IMAPConnection::authenticateSASL()
 
 		for (bool cont = true ; cont ; )
 		{
-			std::auto_ptr <IMAPParser::response> resp(m_parser->readResponse());
+			std::auto_ptr <IMAPParser::response> resp(readResponse());
 
 			if (resp->response_done() &&
 			    resp->response_done()->response_tagged() &&
@@ -466,7 +468,7 @@ void IMAPConnection::startTLS()
 	{
 		send(true, "STARTTLS", true);
 
-		std::auto_ptr <IMAPParser::response> resp(m_parser->readResponse());
+		std::auto_ptr <IMAPParser::response> resp(readResponse());
 
 		if (resp->isBad() || resp->response_done()->response_tagged()->
 			resp_cond_state()->status() != IMAPParser::resp_cond_state::OK)
@@ -482,6 +484,9 @@ void IMAPConnection::startTLS()
 		shared_ptr <tls::TLSSocket> tlsSocket =
 			tlsSession->getSocket(m_socket);
 
+		tlsSocket->setServerIdentity(tls::TLSSessionCache::makeServerIdentity
+			(m_cntInfos->getHost(), m_cntInfos->getPort()));
+
 		tlsSocket->handshake();
 
 		m_socket = tlsSocket;
@@ -565,7 +570,7 @@ void IMAPConnection::fetchCapabilities()
 {
 	send(true, "CAPABILITY", true);
 
-	std::auto_ptr <IMAPParser::response> resp(m_parser->readResponse());
+	std::auto_ptr <IMAPParser::response> resp(readResponse());
 
 	if (resp->response_done()->response_tagged()->
 		resp_cond_state()->status() == IMAPParser::resp_cond_state::OK)
@@ -668,6 +673,9 @@ void IMAPConnection::internalDisconnect()
 
 	m_secured = false;
 	m_cntInfos = null;
+
+	m_awaitingResponse = false;
+	m_pendingCommands.clear();
 }
 
 
@@ -675,7 +683,7 @@ void IMAPConnection::initHierarchySeparator()
 {
 	send(true, "LIST \"\" \"\"", true);
 
-	std::auto_ptr <IMAPParser::response> resp(m_parser->readResponse());
+	std::auto_ptr <IMAPParser::response> resp(readResponse());
 
 	if (resp->isBad() || resp->response_done()->response_tagged()->
 		resp_cond_state()->status() != IMAPParser::resp_cond_state::OK)
@@ -718,35 +726,26 @@ void IMAPConnection::send(bool tag, const string& what, bool end)
 	if (tag && !m_firstTag)
 		++(*m_tag);
 
-#if VMIME_DEBUG
-	std::ostringstream oss;
+	// Send the whole command at once, instead of issuing
+	// a separate send for each piece
+	string buffer;
+	buffer.reserve(what.length() + 16);
 
 	if (tag)
 	{
-		oss << string(*m_tag);
-		oss << " ";
+		buffer += string(*m_tag);
+		buffer += " ";
 	}
 
-	oss << what;
+	buffer += what;
 
 	if (end)
-		oss << "\r\n";
+		buffer += "\r\n";
 
-	m_socket->send(oss.str());
-#else
-	if (tag)
-	{
-		m_socket->send(*m_tag);
-		m_socket->send(" ");
-	}
+	m_socket->send(buffer);
 
-	m_socket->send(what);
-
-	if (end)
-	{
-		m_socket->send("\r\n");
-	}
-#endif
+	if (utility::instrumentation::isEnabled())
+		onCommandSent(tag, what);
 
 	if (tag)
 		m_firstTag = false;
@@ -761,7 +760,97 @@ void IMAPConnection::sendRaw(const byte_t* buffer, const size_t count)
 
 IMAPParser::response* IMAPConnection::readResponse(IMAPParser::literalHandler* lh)
 {
-	return (m_parser->readResponse(lh));
+	IMAPParser::response* resp = m_parser->readResponse(lh);
+
+	if (utility::instrumentation::isEnabled())
+		onResponseReceived();
+
+	return resp;
+}
+
+
+const string IMAPConnection::sendCommand(const string& what)
+{
+	send(true, what, true);
+	return string(*m_tag);
+}
+
+
+IMAPParser::response* IMAPConnection::readResponse
+	(const std::set <string>& tags, string& tag, IMAPParser::literalHandler* lh)
+{
+	m_parser->setExpectedTags(tags);
+
+	IMAPParser::response* resp = NULL;
+
+	try
+	{
+		resp = m_parser->readResponse(lh);
+	}
+	catch (...)
+	{
+		m_parser->setExpectedTags(std::set <string>());
+		throw;
+	}
+
+	m_parser->setExpectedTags(std::set <string>());
+
+	tag = m_parser->getLastTag();
+
+	if (utility::instrumentation::isEnabled())
+		onResponseReceived();
+
+	return resp;
+}
+
+
+void IMAPConnection::onCommandSent(const bool tag, const string& what)
+{
+	m_awaitingResponse = true;
+
+	// Continuation data (literal, SASL response...) is not a command
+	if (!tag)
+		return;
+
+	// Command name, eg. "FETCH" or "UID FETCH"
+	std::istringstream iss(what);
+	string name;
+	iss >> name;
+
+	name = utility::stringUtils::toUpper(name);
+
+	if (name == "UID")
+	{
+		string sub;
+		iss >> sub;
+
+		name += " " + utility::stringUtils::toUpper(sub);
+	}
+
+	utility::instrumentation::increment(utility::instrumentation::IMAP_COMMANDS, name);
+
+	m_pendingCommands[string(*m_tag)] = std::make_pair(name, utility::instrumentation::now());
+}
+
+
+void IMAPConnection::onResponseReceived()
+{
+	if (m_awaitingResponse)
+	{
+		utility::instrumentation::increment(utility::instrumentation::IMAP_ROUND_TRIPS, "");
+		m_awaitingResponse = false;
+	}
+
+	std::map <string, std::pair <string, vmime_uint64> >::iterator it =
+		m_pendingCommands.find(m_parser->getLastTag());
+
+	if (it != m_pendingCommands.end())
+	{
+		utility::instrumentation::record(utility::instrumentation::IMAP_COMMAND_DURATION,
+			it->second.first, utility::instrumentation::now() - it->second.second);
+
+		m_pendingCommands.erase(it);
+	}
 }
 
 
@@ -807,6 +896,12 @@ shared_ptr <const socket> IMAPConnection::getSocket() const
 }
 
 
+shared_ptr <socket> IMAPConnection::getSocket()
+{
+	return m_socket;
+}
+
+
 bool IMAPConnection::isMODSEQDisabled() const
 {
 	return m_noModSeq;
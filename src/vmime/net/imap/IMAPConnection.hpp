@@ -40,6 +40,8 @@
 
 #include "vmime/security/authenticator.hpp"
 
+#include <map>
+
 
 namespace vmime {
 namespace net {
@@ -84,6 +86,25 @@ public:
 
 	IMAPParser::response* readResponse(IMAPParser::literalHandler* lh = NULL);
 
+	/** Send a tagged command and return the tag which was used.
+	  * This allows several commands to be in flight at the same time.
+	  *
+	  * @param what command text
+	  * @return tag of the command
+	  */
+	const string sendCommand(const string& what);
+
+	/** Read the response to one of several pipelined commands.
+	  *
+	  * @param tags tags of the commands for which a completion
+	  * is awaited
+	  * @param tag will receive the tag of the completed command
+	  * @param lh literal handler, if any
+	  * @return server response
+	  */
+	IMAPParser::response* readResponse(const std::set <string>& tags,
+		string& tag, IMAPParser::literalHandler* lh = NULL);
+
 
 	shared_ptr <const IMAPStore> getStore() const;
 	shared_ptr <IMAPStore> getStore();
@@ -102,6 +123,7 @@ public:
 	shared_ptr <connectionInfos> getConnectionInfos() const;
 
 	shared_ptr <const socket> getSocket() const;
+	shared_ptr <socket> getSocket();
 
 	bool isMODSEQDisabled() const;
 	void disableMODSEQ();
@@ -120,6 +142,9 @@ private:
 	bool processCapabilityResponseData(const IMAPParser::response* resp);
 	void processCapabilityResponseData(const IMAPParser::capability_data* capaData);
 
+	void onCommandSent(const bool tag, const string& what);
+	void onResponseReceived();
+
 
 	weak_ptr <IMAPStore> m_store;
 
@@ -147,6 +172,10 @@ private:
 
 	bool m_noModSeq;
 
+	// Instrumentation: commands waiting for completion, by tag
+	bool m_awaitingResponse;
+	std::map <string, std::pair <string, vmime_uint64> > m_pendingCommands;
+
 
 	void internalDisconnect();
 
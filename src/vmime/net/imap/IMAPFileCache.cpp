@@ -0,0 +1,492 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP && VMIME_HAVE_FILESYSTEM_FEATURES
+
+
+#include "vmime/net/imap/IMAPFileCache.hpp"
+
+#include "vmime/platform.hpp"
+#include "vmime/exception.hpp"
+
+#include "vmime/utility/sync/autoLock.hpp"
+#include "vmime/utility/streamUtils.hpp"
+#include "vmime/utility/outputStreamStringAdapter.hpp"
+#include "vmime/utility/random.hpp"
+
+#include <sstream>
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+
+// Mailbox names may contain characters which are not allowed
+// in file names, so they are hex-encoded
+const string encodeName(const string& name)
+{
+	static const char hexChars[] = "0123456789abcdef";
+
+	string res;
+	res.reserve(name.length() * 2 + 1);
+
+	res += 'm';  // never empty
+
+	for (string::const_iterator it = name.begin() ; it != name.end() ; ++it)
+	{
+		const unsigned char c = static_cast <unsigned char>(*it);
+
+		res += hexChars[c >> 4];
+		res += hexChars[c & 0xf];
+	}
+
+	return res;
+}
+
+
+const string messageFileName(const message::uid& uid)
+{
+	return static_cast <string>(uid) + ".msg";
+}
+
+
+const string partFilePrefix(const message::uid& uid)
+{
+	return static_cast <string>(uid) + "_";
+}
+
+
+const string partFileName(const message::uid& uid, const string& section)
+{
+	return partFilePrefix(uid) + section + ".part";
+}
+
+
+void removeRecursive(shared_ptr <utility::file> file)
+{
+	if (file->isDirectory())
+	{
+		shared_ptr <utility::fileIterator> it = file->getFiles();
+
+		while (it->hasMoreElements())
+			removeRecursive(it->nextElement());
+	}
+
+	file->remove();
+}
+
+
+bool readFile(shared_ptr <utility::file> file, utility::outputStream& os)
+{
+	if (!file->exists() || !file->isFile())
+		return false;
+
+	shared_ptr <utility::inputStream> is = file->getFileReader()->getInputStream();
+	utility::bufferedStreamCopy(*is, os);
+
+	return true;
+}
+
+
+bool readBlob(std::istream& is, const string& name, string& data)
+{
+	string tag;
+	size_t length = 0;
+
+	if (!(is >> tag >> length) || tag != name || is.get() != '\n')
+		return false;
+
+	data.resize(length);
+
+	if (length != 0 && !is.read(&data[0], static_cast <std::streamsize>(length)))
+		return false;
+
+	return is.get() == '\n';
+}
+
+
+template <typename T>
+bool readValue(std::istream& is, const string& name, T& value)
+{
+	string tag;
+	return (is >> tag >> value) && tag == name;
+}
+
+
+} // unnamed namespace
+
+
+// Writes an entry to a temporary file, which replaces the entry
+// when it is committed
+class IMAPFileCache::fileContentsWriter : public IMAPCache::partContentsWriter
+{
+public:
+
+	fileContentsWriter(IMAPFileCache* cache, const utility::file::path& dir, const string& name)
+		: m_cache(cache), m_path(dir / utility::file::path::component(name))
+	{
+		shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
+
+		shared_ptr <utility::file> dirFile = fsf->create(dir);
+
+		if (!dirFile->exists())
+		{
+			try
+			{
+				dirFile->createDirectory(/* createAll */ true);
+			}
+			catch (exceptions::filesystem_exception&)
+			{
+				// May have been created by another thread
+				if (!dirFile->exists())
+					throw;
+			}
+		}
+
+		// Temporary files have a random name, so that several threads
+		// can write the same entry; the last one to commit wins
+		for (int attempt = 0 ; !m_tmpFile ; ++attempt)
+		{
+			shared_ptr <utility::file> tmpFile = fsf->create(dir / utility::file::path::component
+				(name + "." + utility::random::getString(8) + ".tmp"));
+
+			try
+			{
+				tmpFile->createFile();
+				m_tmpFile = tmpFile;
+			}
+			catch (exceptions::filesystem_exception&)
+			{
+				if (attempt >= 10)
+					throw;
+			}
+		}
+
+		m_stream = m_tmpFile->getFileWriter()->getOutputStream();
+	}
+
+	~fileContentsWriter()
+	{
+		if (m_tmpFile)
+		{
+			try
+			{
+				m_stream = null;
+				m_tmpFile->remove();
+			}
+			catch (...)
+			{
+				// Don't throw in destructor
+			}
+		}
+	}
+
+	utility::outputStream& getOutputStream()
+	{
+		return *m_stream;
+	}
+
+	void commit()
+	{
+		m_stream->flush();
+		m_stream = null;
+
+		m_cache->commitFile(m_tmpFile, m_path);
+		m_tmpFile = null;
+	}
+
+private:
+
+	IMAPFileCache* m_cache;
+	const utility::file::path m_path;
+
+	shared_ptr <utility::file> m_tmpFile;
+	shared_ptr <utility::outputStream> m_stream;
+};
+
+#endif // VMIME_BUILDING_DOC
+
+
+IMAPFileCache::IMAPFileCache(const utility::file::path& root)
+	: m_root(root), m_cachePartContents(true),
+	  m_lock(platform::getHandler()->createCriticalSection())
+{
+}
+
+
+const utility::file::path& IMAPFileCache::getRootDirectory() const
+{
+	return m_root;
+}
+
+
+void IMAPFileCache::setCachePartContents(const bool enable)
+{
+	m_cachePartContents = enable;
+}
+
+
+bool IMAPFileCache::getCachePartContents() const
+{
+	return m_cachePartContents;
+}
+
+
+const utility::file::path IMAPFileCache::getMailboxDirectory(const string& mailbox) const
+{
+	return m_root / utility::file::path::component(encodeName(mailbox));
+}
+
+
+const utility::file::path IMAPFileCache::getDirectory
+	(const string& mailbox, const vmime_uint32 uidValidity) const
+{
+	std::ostringstream oss;
+	oss.imbue(std::locale::classic());
+	oss << uidValidity;
+
+	return getMailboxDirectory(mailbox) / utility::file::path::component(oss.str());
+}
+
+
+void IMAPFileCache::writeFile(const utility::file::path& dir, const string& name, const string& data)
+{
+	// Write to a temporary file first, so that an interrupted
+	// write never leaves a truncated entry
+	fileContentsWriter writer(this, dir, name);
+
+	writer.getOutputStream().write(data.data(), data.length());
+	writer.commit();
+}
+
+
+void IMAPFileCache::commitFile(shared_ptr <utility::file> tmpFile, const utility::file::path& path)
+{
+	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
+
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	shared_ptr <utility::file> file = fsf->create(path);
+
+	if (file->exists())
+		file->remove();
+
+	tmpFile->rename(path);
+}
+
+
+void IMAPFileCache::validateMailbox(const string& mailbox, const vmime_uint32 uidValidity)
+{
+	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
+
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	shared_ptr <utility::file> mailboxDir = fsf->create(getMailboxDirectory(mailbox));
+
+	if (!mailboxDir->exists() || !mailboxDir->isDirectory())
+		return;
+
+	const utility::file::path::component keep = getDirectory(mailbox, uidValidity).getLastComponent();
+
+	std::vector <shared_ptr <utility::file> > obsolete;
+
+	shared_ptr <utility::fileIterator> it = mailboxDir->getFiles();
+
+	while (it->hasMoreElements())
+	{
+		shared_ptr <utility::file> file = it->nextElement();
+
+		if (!(file->getFullPath().getLastComponent() == keep))
+			obsolete.push_back(file);
+	}
+
+	for (std::vector <shared_ptr <utility::file> >::iterator
+	     jt = obsolete.begin() ; jt != obsolete.end() ; ++jt)
+	{
+		removeRecursive(*jt);
+	}
+}
+
+
+bool IMAPFileCache::getMessageInfo(const string& mailbox, const vmime_uint32 uidValidity,
+	const message::uid& uid, messageInfo& info)
+{
+	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
+
+	string data;
+	utility::outputStreamStringAdapter dataStream(data);
+
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		shared_ptr <utility::file> file = fsf->create(getDirectory(mailbox, uidValidity)
+			/ utility::file::path::component(messageFileName(uid)));
+
+		if (!readFile(file, dataStream))
+			return false;
+	}
+
+	dataStream.flush();
+
+	std::istringstream is(data);
+	is.imbue(std::locale::classic());
+
+	messageInfo res;
+
+	if (!readValue(is, "attributes", res.attributes) ||
+	    !readValue(is, "size", res.size) ||
+	    !readValue(is, "flags", res.flags) ||
+	    !readValue(is, "modseq", res.modSequence) ||
+	    !readValue(is, "highestmodseq", res.highestModSequence) ||
+	    !readBlob(is, "structure", res.structure) ||
+	    !readBlob(is, "header", res.header))
+	{
+		return false;  // corrupted entry
+	}
+
+	info = res;
+
+	return true;
+}
+
+
+void IMAPFileCache::putMessageInfo(const string& mailbox, const vmime_uint32 uidValidity,
+	const message::uid& uid, const messageInfo& info)
+{
+	std::ostringstream oss;
+	oss.imbue(std::locale::classic());
+
+	oss << "attributes " << info.attributes << "\n";
+	oss << "size " << info.size << "\n";
+	oss << "flags " << info.flags << "\n";
+	oss << "modseq " << info.modSequence << "\n";
+	oss << "highestmodseq " << info.highestModSequence << "\n";
+	oss << "structure " << info.structure.length() << "\n" << info.structure << "\n";
+	oss << "header " << info.header.length() << "\n" << info.header << "\n";
+
+	writeFile(getDirectory(mailbox, uidValidity), messageFileName(uid), oss.str());
+}
+
+
+bool IMAPFileCache::getPartContents(const string& mailbox, const vmime_uint32 uidValidity,
+	const message::uid& uid, const string& section, utility::outputStream& os)
+{
+	if (!m_cachePartContents)
+		return false;
+
+	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
+
+	const utility::file::path::component name(partFileName(uid, section));
+
+	if (!fsf->isValidPathComponent(name))
+		return false;
+
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	return readFile(fsf->create(getDirectory(mailbox, uidValidity) / name), os);
+}
+
+
+void IMAPFileCache::putPartContents(const string& mailbox, const vmime_uint32 uidValidity,
+	const message::uid& uid, const string& section, const string& data)
+{
+	if (!m_cachePartContents)
+		return;
+
+	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
+
+	if (!fsf->isValidPathComponent(utility::file::path::component(partFileName(uid, section))))
+		return;
+
+	writeFile(getDirectory(mailbox, uidValidity), partFileName(uid, section), data);
+}
+
+
+shared_ptr <IMAPCache::partContentsWriter> IMAPFileCache::createPartContentsWriter
+	(const string& mailbox, const vmime_uint32 uidValidity,
+	 const message::uid& uid, const string& section)
+{
+	if (!m_cachePartContents)
+		return null;
+
+	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
+
+	if (!fsf->isValidPathComponent(utility::file::path::component(partFileName(uid, section))))
+		return null;
+
+	return make_shared <fileContentsWriter>(this, getDirectory(mailbox, uidValidity), partFileName(uid, section));
+}
+
+
+void IMAPFileCache::removeMessage(const string& mailbox, const vmime_uint32 uidValidity,
+	const message::uid& uid)
+{
+	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
+
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	shared_ptr <utility::file> dir = fsf->create(getDirectory(mailbox, uidValidity));
+
+	if (!dir->exists() || !dir->isDirectory())
+		return;
+
+	const string msgName = messageFileName(uid);
+	const string partPrefix = partFilePrefix(uid);
+
+	std::vector <shared_ptr <utility::file> > files;
+
+	shared_ptr <utility::fileIterator> it = dir->getFiles();
+
+	while (it->hasMoreElements())
+	{
+		shared_ptr <utility::file> file = it->nextElement();
+		const string name = file->getFullPath().getLastComponent().getBuffer();
+
+		if (name == msgName || name.compare(0, partPrefix.length(), partPrefix) == 0)
+			files.push_back(file);
+	}
+
+	for (std::vector <shared_ptr <utility::file> >::iterator
+	     jt = files.begin() ; jt != files.end() ; ++jt)
+	{
+		(*jt)->remove();
+	}
+}
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP && VMIME_HAVE_FILESYSTEM_FEATURES
@@ -0,0 +1,133 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_NET_IMAP_IMAPFILECACHE_HPP_INCLUDED
+#define VMIME_NET_IMAP_IMAPFILECACHE_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP && VMIME_HAVE_FILESYSTEM_FEATURES
+
+
+#include "vmime/net/imap/IMAPCache.hpp"
+
+#include "vmime/utility/file.hpp"
+#include "vmime/utility/sync/criticalSection.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+/** IMAP cache which stores data in a local directory. There is one
+  * sub-directory per mailbox and UIDVALIDITY value, holding one file
+  * per message plus one file per cached section.
+  */
+
+class VMIME_EXPORT IMAPFileCache : public IMAPCache
+{
+public:
+
+	/** Construct a new cache which stores data into the
+	  * specified directory. The directory is created if needed.
+	  *
+	  * @param root cache directory
+	  */
+	IMAPFileCache(const utility::file::path& root);
+
+	/** Return the directory where data is stored.
+	  *
+	  * @return cache directory
+	  */
+	const utility::file::path& getRootDirectory() const;
+
+	/** Set whether the contents of the sections which are
+	  * extracted should be cached (default is true). If not,
+	  * only the structure, header and flags are cached.
+	  *
+	  * @param enable true to cache section contents, false otherwise
+	  */
+	void setCachePartContents(const bool enable);
+
+	/** Return whether the contents of sections are cached.
+	  *
+	  * @return true if section contents are cached, false otherwise
+	  */
+	bool getCachePartContents() const;
+
+
+	void validateMailbox(const string& mailbox, const vmime_uint32 uidValidity);
+
+	bool getMessageInfo(const string& mailbox, const vmime_uint32 uidValidity,
+		const message::uid& uid, messageInfo& info);
+	void putMessageInfo(const string& mailbox, const vmime_uint32 uidValidity,
+		const message::uid& uid, const messageInfo& info);
+
+	bool getPartContents(const string& mailbox, const vmime_uint32 uidValidity,
+		const message::uid& uid, const string& section, utility::outputStream& os);
+	void putPartContents(const string& mailbox, const vmime_uint32 uidValidity,
+		const message::uid& uid, const string& section, const string& data);
+
+	shared_ptr <partContentsWriter> createPartContentsWriter
+		(const string& mailbox, const vmime_uint32 uidValidity,
+		 const message::uid& uid, const string& section);
+
+	void removeMessage(const string& mailbox, const vmime_uint32 uidValidity,
+		const message::uid& uid);
+
+private:
+
+	const utility::file::path getMailboxDirectory(const string& mailbox) const;
+	const utility::file::path getDirectory(const string& mailbox, const vmime_uint32 uidValidity) const;
+
+	class fileContentsWriter;
+	friend class fileContentsWriter;
+
+	void writeFile(const utility::file::path& dir, const string& name, const string& data);
+
+	/** Replace a cache entry with a file which has been written.
+	  *
+	  * @param tmpFile file holding the new contents
+	  * @param path path of the entry
+	  */
+	void commitFile(shared_ptr <utility::file> tmpFile, const utility::file::path& path);
+
+
+	utility::file::path m_root;
+	bool m_cachePartContents;
+
+	shared_ptr <utility::sync::criticalSection> m_lock;
+};
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP && VMIME_HAVE_FILESYSTEM_FEATURES
+
+#endif // VMIME_NET_IMAP_IMAPFILECACHE_HPP_INCLUDED
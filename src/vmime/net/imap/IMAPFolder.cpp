@@ -35,12 +35,15 @@
 #include "vmime/net/imap/IMAPUtils.hpp"
 #include "vmime/net/imap/IMAPConnection.hpp"
 #include "vmime/net/imap/IMAPFolderStatus.hpp"
+#include "vmime/net/imap/IMAPCommandBatcher.hpp"
+#include "vmime/net/imap/IMAPCache.hpp"
 
 #include "vmime/message.hpp"
 
 #include "vmime/exception.hpp"
 
 #include "vmime/utility/outputStreamAdapter.hpp"
+#include "vmime/utility/bufferedOutputStreamSocketAdapter.hpp"
 
 #include <algorithm>
 #include <sstream>
@@ -54,7 +57,7 @@ namespace imap {
 IMAPFolder::IMAPFolder(const folder::path& path, shared_ptr <IMAPStore> store, shared_ptr <folderAttributes> attribs)
 	: m_store(store), m_connection(store->connection()), m_path(path),
 	  m_name(path.isEmpty() ? folder::path::component("") : path.getLastComponent()), m_mode(-1),
-	  m_open(false), m_attribs(attribs)
+	  m_open(false), m_cachedFlagsValid(false), m_attribs(attribs)
 {
 	store->registerFolder(this);
 
@@ -262,6 +265,13 @@ void IMAPFolder::open(const int mode, bool failIfModeIsNotAvailable)
 		m_connection = connection;
 		m_open = true;
 		m_mode = mode;
+
+		// Discard cached data if UIDVALIDITY has changed
+		if (shared_ptr <IMAPCache> cache = getCache())
+		{
+			cache->validateMailbox(getCacheMailboxName(), getUIDValidity());
+			m_cachedFlagsValid = true;
+		}
 	}
 	catch (std::exception&)
 	{
@@ -309,10 +319,15 @@ void IMAPFolder::close(const bool expunge)
 
 void IMAPFolder::onClose()
 {
-	for (std::vector <IMAPMessage*>::iterator it = m_messages.begin() ;
-	     it != m_messages.end() ; ++it)
+	std::vector <std::pair <size_t, IMAPMessage*> > msgs;
+	m_messages.getMessages(msgs);
+
+	for (std::vector <std::pair <size_t, IMAPMessage*> >::iterator it = msgs.begin() ;
+	     it != msgs.end() ; ++it)
 	{
-		(*it)->onFolderClosed();
+		// Messages keep their last known number
+		(*it).second->renumber(static_cast <int>(m_messages.getNumber((*it).first)));
+		(*it).second->onFolderClosed();
 	}
 
 	m_messages.clear();
@@ -545,12 +560,14 @@ std::vector <shared_ptr <message> > IMAPFolder::getMessages(const messageSet& ms
 
 	if (msgs.isNumberSet())
 	{
-		const std::vector <int> numbers = IMAPUtils::messageSetToNumberList(msgs);
+		const numberSet numbers = IMAPUtils::messageSetToNumberSet(msgs);
 
 		shared_ptr <IMAPFolder> thisFolder = dynamicCast <IMAPFolder>(shared_from_this());
 
-		for (std::vector <int>::const_iterator it = numbers.begin() ; it != numbers.end() ; ++it)
-			messages.push_back(make_shared <IMAPMessage>(thisFolder, *it));
+		messages.reserve(static_cast <size_t>(numbers.getCount()));
+
+		for (numberSet::const_iterator it = numbers.begin() ; it != numbers.end() ; ++it)
+			messages.push_back(make_shared <IMAPMessage>(thisFolder, static_cast <int>(*it)));
 	}
 	else if (msgs.isUIDSet())
 	{
@@ -757,6 +774,122 @@ std::vector <shared_ptr <folder> > IMAPFolder::getFolders(const bool recursive)
 }
 
 
+#ifndef VMIME_BUILDING_DOC
+
+class IMAPFolder::fetchResponseHandler : public IMAPCommandBatcher::responseHandler
+{
+public:
+
+	fetchResponseHandler(IMAPFolder* folder, const fetchAttributes& options,
+		std::map <int, shared_ptr <IMAPMessage> >& numberToMsg,
+		utility::progressListener* progress, const size_t total)
+		: m_folder(folder), m_options(options), m_numberToMsg(numberToMsg),
+		  m_progress(progress), m_current(0), m_total(total)
+	{
+	}
+
+	void handleResponse(const size_t /* index */, const IMAPParser::response* resp)
+	{
+		const std::vector <IMAPParser::continue_req_or_response_data*>& respDataList =
+			resp->continue_req_or_response_data();
+
+		for (std::vector <IMAPParser::continue_req_or_response_data*>::const_iterator
+		     it = respDataList.begin() ; it != respDataList.end() ; ++it)
+		{
+			if ((*it)->response_data() == NULL)
+			{
+				throw exceptions::command_error("FETCH",
+					resp->getErrorLog(), "invalid response");
+			}
+
+			const IMAPParser::message_data* messageData =
+				(*it)->response_data()->message_data();
+
+			// We are only interested in responses of type "FETCH"
+			if (messageData == NULL || messageData->type() != IMAPParser::message_data::FETCH)
+				continue;
+
+			// Process fetch response for this message
+			const int num = static_cast <int>(messageData->number());
+
+			std::map <int, shared_ptr <IMAPMessage> >::iterator msg = m_numberToMsg.find(num);
+
+			if (msg != m_numberToMsg.end())
+			{
+				(*msg).second->processFetchResponse(m_options, messageData);
+				++m_current;
+			}
+		}
+
+		// Report progress once per command
+		if (m_progress)
+			m_progress->progress(m_current, m_total);
+
+		m_folder->processStatusUpdate(resp);
+	}
+
+private:
+
+	IMAPFolder* m_folder;
+	const fetchAttributes& m_options;
+	std::map <int, shared_ptr <IMAPMessage> >& m_numberToMsg;
+	utility::progressListener* m_progress;
+	size_t m_current;
+	const size_t m_total;
+};
+
+
+class IMAPFolder::statusResponseHandler : public IMAPCommandBatcher::responseHandler
+{
+public:
+
+	statusResponseHandler(IMAPFolder* folder, messageSet* copyUIDs = NULL)
+		: m_folder(folder), m_copyUIDs(copyUIDs)
+	{
+	}
+
+	void handleResponse(const size_t index, const IMAPParser::response* resp)
+	{
+		m_completed.push_back(index);
+
+		m_folder->processStatusUpdate(resp);
+
+		if (m_copyUIDs == NULL)
+			return;
+
+		// Merge the UIDs of the copied messages
+		const IMAPParser::resp_text_code* respTextCode =
+			resp->response_done()->response_tagged()->resp_cond_state()->resp_text()->resp_text_code();
+
+		if (respTextCode && respTextCode->type() == IMAPParser::resp_text_code::COPYUID)
+		{
+			const messageSet uids = IMAPUtils::buildMessageSet(respTextCode->uid_set2());
+
+			for (size_t i = 0, n = uids.getRangeCount() ; i < n ; ++i)
+				m_copyUIDs->addRange(uids.getRangeAt(i));
+		}
+	}
+
+	/** Return the indexes of the commands which completed successfully.
+	  *
+	  * @return indexes of completed commands
+	  */
+	const std::vector <size_t>& getCompletedCommands() const
+	{
+		return m_completed;
+	}
+
+private:
+
+	IMAPFolder* m_folder;
+	messageSet* m_copyUIDs;
+
+	std::vector <size_t> m_completed;
+};
+
+#endif // VMIME_BUILDING_DOC
+
+
 void IMAPFolder::fetchMessages(std::vector <shared_ptr <message> >& msg, const fetchAttributes& options,
                                utility::progressListener* progress)
 {
@@ -767,6 +900,88 @@ void IMAPFolder::fetchMessages(std::vector <shared_ptr <message> >& msg, const f
 	else if (!isOpen())
 		throw exceptions::illegal_state("Folder not open");
 
+	shared_ptr <IMAPCache> cache = getCache();
+
+	if (!cache)
+	{
+		fetchMessagesImpl(msg, options, progress);
+		return;
+	}
+
+	// Messages are identified by their UID in the cache
+	std::vector <shared_ptr <message> > noUID;
+
+	for (std::vector <shared_ptr <message> >::iterator it = msg.begin() ; it != msg.end() ; ++it)
+	{
+		if ((*it)->getUID().empty())
+			noUID.push_back(*it);
+	}
+
+	if (!noUID.empty())
+		fetchMessagesImpl(noUID, fetchAttributes(fetchAttributes::UID), NULL);
+
+	// Take from the cache what is available
+	const string mailbox = getCacheMailboxName();
+	const vmime_uint32 uidValidity = getUIDValidity();
+	const vmime_uint64 highestModSeq = getHighestModSequence();
+
+	std::vector <shared_ptr <message> > remaining;
+
+	for (std::vector <shared_ptr <message> >::iterator it = msg.begin() ; it != msg.end() ; ++it)
+	{
+		shared_ptr <IMAPMessage> imapMsg = dynamicCast <IMAPMessage>(*it);
+
+		IMAPCache::messageInfo info;
+
+		if (!imapMsg->getUID().empty() &&
+		    cache->getMessageInfo(mailbox, uidValidity, imapMsg->getUID(), info))
+		{
+			const bool flagsValid = m_cachedFlagsValid && highestModSeq != 0 &&
+				info.highestModSequence == highestModSeq;
+
+			if (imapMsg->processCachedInfo(options, info, flagsValid))
+				continue;
+		}
+
+		remaining.push_back(*it);
+	}
+
+	if (remaining.empty())
+		return;
+
+	// Fetch the rest from the server, and store it in the cache
+	fetchAttributes serverOptions(options);
+	serverOptions.add(fetchAttributes::UID);
+
+	fetchMessagesImpl(remaining, serverOptions, progress);
+
+	for (std::vector <shared_ptr <message> >::iterator it = remaining.begin() ; it != remaining.end() ; ++it)
+	{
+		shared_ptr <IMAPMessage> imapMsg = dynamicCast <IMAPMessage>(*it);
+
+		if (imapMsg->getUID().empty())
+			continue;
+
+		IMAPCache::messageInfo info;
+		cache->getMessageInfo(mailbox, uidValidity, imapMsg->getUID(), info);
+
+		imapMsg->updateCachedInfo(options, info);
+
+		try
+		{
+			cache->putMessageInfo(mailbox, uidValidity, imapMsg->getUID(), info);
+		}
+		catch (std::exception&)
+		{
+			// Cache errors must not make the fetch fail
+		}
+	}
+}
+
+
+void IMAPFolder::fetchMessagesImpl(std::vector <shared_ptr <message> >& msg, const fetchAttributes& options,
+                                   utility::progressListener* progress)
+{
 	// Build message numbers list
 	std::vector <int> list;
 	list.reserve(msg.size());
@@ -779,62 +994,32 @@ void IMAPFolder::fetchMessages(std::vector <shared_ptr <message> >& msg, const f
 		numberToMsg[(*it)->getNumber()] = dynamicCast <IMAPMessage>(*it);
 	}
 
-	// Send the request
-	const string command = IMAPUtils::buildFetchRequest
-		(m_connection, messageSet::byNumber(list), options);
+	// Split the request into several commands if needed
+	IMAPCommandBatcher batcher(m_connection);
 
-	m_connection->send(true, command, true);
+	const size_t reservedLength = IMAPUtils::buildFetchRequest
+		(m_connection, messageSet::byNumber(1), options).length() - 1;
 
-	// Get the response
-	std::auto_ptr <IMAPParser::response> resp(m_connection->readResponse());
+	const std::vector <messageSet> chunks =
+		batcher.split(messageSet::byNumber(list), reservedLength);
 
-	if (resp->isBad() || resp->response_done()->response_tagged()->
-		resp_cond_state()->status() != IMAPParser::resp_cond_state::OK)
-	{
-		throw exceptions::command_error("FETCH",
-			resp->getErrorLog(), "bad response");
-	}
+	std::vector <string> commands;
+	commands.reserve(chunks.size());
 
-	const std::vector <IMAPParser::continue_req_or_response_data*>& respDataList =
-		resp->continue_req_or_response_data();
+	for (std::vector <messageSet>::const_iterator it = chunks.begin() ; it != chunks.end() ; ++it)
+		commands.push_back(IMAPUtils::buildFetchRequest(m_connection, *it, options));
 
+	// Send the requests and process the responses
 	const size_t total = msg.size();
-	size_t current = 0;
+
+	fetchResponseHandler handler(this, options, numberToMsg, progress, total);
 
 	if (progress)
 		progress->start(total);
 
 	try
 	{
-		for (std::vector <IMAPParser::continue_req_or_response_data*>::const_iterator
-		     it = respDataList.begin() ; it != respDataList.end() ; ++it)
-		{
-			if ((*it)->response_data() == NULL)
-			{
-				throw exceptions::command_error("FETCH",
-					resp->getErrorLog(), "invalid response");
-			}
-
-			const IMAPParser::message_data* messageData =
-				(*it)->response_data()->message_data();
-
-			// We are only interested in responses of type "FETCH"
-			if (messageData == NULL || messageData->type() != IMAPParser::message_data::FETCH)
-				continue;
-
-			// Process fetch response for this message
-			const int num = static_cast <int>(messageData->number());
-
-			std::map <int, shared_ptr <IMAPMessage> >::iterator msg = numberToMsg.find(num);
-
-			if (msg != numberToMsg.end())
-			{
-				(*msg).second->processFetchResponse(options, messageData);
-
-				if (progress)
-					progress->progress(++current, total);
-			}
-		}
+		batcher.execute(m_connection, "FETCH", commands, handler);
 	}
 	catch (...)
 	{
@@ -846,8 +1031,6 @@ void IMAPFolder::fetchMessages(std::vector <shared_ptr <message> >& msg, const f
 
 	if (progress)
 		progress->stop(total);
-
-	processStatusUpdate(resp.get());
 }
 
 
@@ -878,6 +1061,23 @@ shared_ptr <folder> IMAPFolder::getParent()
 }
 
 
+shared_ptr <IMAPCache> IMAPFolder::getCache() const
+{
+	shared_ptr <IMAPStore> store = m_store.lock();
+
+	if (!store || !m_open || getUIDValidity() == 0)
+		return null;
+
+	return store->getCache();
+}
+
+
+const string IMAPFolder::getCacheMailboxName() const
+{
+	return IMAPUtils::pathToString(m_connection->hierarchySeparator(), getFullPath());
+}
+
+
 shared_ptr <const store> IMAPFolder::getStore() const
 {
 	return m_store.lock();
@@ -890,19 +1090,21 @@ shared_ptr <store> IMAPFolder::getStore()
 }
 
 
-void IMAPFolder::registerMessage(IMAPMessage* msg)
+size_t IMAPFolder::registerMessage(IMAPMessage* msg, const int num)
 {
-	m_messages.push_back(msg);
+	return m_messages.add(msg, num);
 }
 
 
-void IMAPFolder::unregisterMessage(IMAPMessage* msg)
+void IMAPFolder::unregisterMessage(IMAPMessage* msg, const size_t slot)
 {
-	std::vector <IMAPMessage*>::iterator it =
-		std::find(m_messages.begin(), m_messages.end(), msg);
+	m_messages.remove(msg, slot);
+}
+
 
-	if (it != m_messages.end())
-		m_messages.erase(it);
+int IMAPFolder::getMessageNumber(const size_t slot) const
+{
+	return static_cast <int>(m_messages.getNumber(slot));
 }
 
 
@@ -926,74 +1128,52 @@ void IMAPFolder::deleteMessages(const messageSet& msgs)
 	else if (m_mode == MODE_READ_ONLY)
 		throw exceptions::illegal_state("Folder is read-only");
 
-	// Build the request text
-	std::ostringstream command;
-	command.imbue(std::locale::classic());
-
-	if (msgs.isUIDSet())
-		command << "UID STORE " << IMAPUtils::messageSetToSequenceSet(msgs);
-	else
-		command << "STORE " << IMAPUtils::messageSetToSequenceSet(msgs);
+	// Build the request text, split into several commands if needed
+	IMAPCommandBatcher batcher(m_connection);
 
-	command << " +FLAGS (\\Deleted)";
+	const std::vector <string> commands = batcher.buildCommands
+		(msgs, msgs.isUIDSet() ? "UID STORE " : "STORE ", " +FLAGS (\\Deleted)");
 
-	// Send the request
-	m_connection->send(true, command.str(), true);
+	// Cached flags may not be up to date anymore
+	m_cachedFlagsValid = false;
 
-	// Get the response
-	std::auto_ptr <IMAPParser::response> resp(m_connection->readResponse());
-
-	if (resp->isBad() || resp->response_done()->response_tagged()->
-		resp_cond_state()->status() != IMAPParser::resp_cond_state::OK)
-	{
-		throw exceptions::command_error("STORE",
-			resp->getErrorLog(), "bad response");
-	}
-
-	processStatusUpdate(resp.get());
+	// Send the requests and process the responses
+	statusResponseHandler handler(this);
+	batcher.execute(m_connection, "STORE", commands, handler);
 }
 
 
 void IMAPFolder::setMessageFlags(const messageSet& msgs, const int flags, const int mode)
 {
-	// Build the request text
-	std::ostringstream command;
-	command.imbue(std::locale::classic());
+	const string flagList = IMAPUtils::messageFlagList(flags);
 
-	if (msgs.isUIDSet())
-		command << "UID STORE " << IMAPUtils::messageSetToSequenceSet(msgs);
-	else
-		command << "STORE " << IMAPUtils::messageSetToSequenceSet(msgs);
+	if (flagList.empty())
+		return;
+
+	// Build the request text, split into several commands if needed
+	string suffix;
 
 	switch (mode)
 	{
-	case message::FLAG_MODE_ADD:    command << " +FLAGS "; break;
-	case message::FLAG_MODE_REMOVE: command << " -FLAGS "; break;
+	case message::FLAG_MODE_ADD:    suffix = " +FLAGS "; break;
+	case message::FLAG_MODE_REMOVE: suffix = " -FLAGS "; break;
 	default:
-	case message::FLAG_MODE_SET:    command << " FLAGS "; break;
+	case message::FLAG_MODE_SET:    suffix = " FLAGS "; break;
 	}
 
-	const string flagList = IMAPUtils::messageFlagList(flags);
+	suffix += flagList;
 
-	if (!flagList.empty())
-	{
-		command << flagList;
+	IMAPCommandBatcher batcher(m_connection);
 
-		// Send the request
-		m_connection->send(true, command.str(), true);
-
-		// Get the response
-		std::auto_ptr <IMAPParser::response> resp(m_connection->readResponse());
+	const std::vector <string> commands = batcher.buildCommands
+		(msgs, msgs.isUIDSet() ? "UID STORE " : "STORE ", suffix);
 
-		if (resp->isBad() || resp->response_done()->response_tagged()->
-			resp_cond_state()->status() != IMAPParser::resp_cond_state::OK)
-		{
-			throw exceptions::command_error("STORE",
-				resp->getErrorLog(), "bad response");
-		}
+	// Cached flags may not be up to date anymore
+	m_cachedFlagsValid = false;
 
-		processStatusUpdate(resp.get());
-	}
+	// Send the requests and process the responses
+	statusResponseHandler handler(this);
+	batcher.execute(m_connection, "STORE", commands, handler);
 }
 
 
@@ -1087,21 +1267,25 @@ messageSet IMAPFolder::addMessage
 	std::vector <byte_t> vbuffer(blockSize);
 	byte_t* buffer = &vbuffer.front();
 
+	utility::bufferedOutputStreamSocketAdapter os(*m_connection->getSocket());
+
 	while (!is.eof())
 	{
 		// Read some data from the input stream
-		const size_t read = is.read(buffer, sizeof(buffer));
+		const size_t read = is.read(buffer, blockSize);
 		current += read;
 
 		// Put read data into socket output stream
-		m_connection->sendRaw(buffer, read);
+		os.write(buffer, read);
 
 		// Notify progress
 		if (progress)
 			progress->progress(current, total);
 	}
 
-	m_connection->send(false, "", true);
+	// End of literal and command
+	os.write("\r\n", 2);
+	os.flush();
 
 	if (progress)
 		progress->stop(total);
@@ -1238,35 +1422,55 @@ messageSet IMAPFolder::copyMessages(const folder::path& dest, const messageSet&
 		throw exceptions::illegal_state("Folder not open");
 
 	// Build the request text
-	std::ostringstream command;
-	command.imbue(std::locale::classic());
+	IMAPCommandBatcher batcher(m_connection);
 
-	command << "COPY " << IMAPUtils::messageSetToSequenceSet(set) << " ";
-	command << IMAPUtils::quoteString(IMAPUtils::pathToString
-			(m_connection->hierarchySeparator(), dest));
+	const string prefix = set.isUIDSet() ? "UID COPY " : "COPY ";
+	const string suffix = " " + IMAPUtils::quoteString(IMAPUtils::pathToString
+		(m_connection->hierarchySeparator(), dest));
 
-	// Send the request
-	m_connection->send(true, command.str(), true);
+	// Sets of UIDs are split into several commands if needed. Sets of
+	// message numbers are not: the server may send EXPUNGE responses
+	// while processing COPY, which would shift the numbers of the
+	// messages addressed by the next commands
+	std::vector <messageSet> chunks;
 
-	// Get the response
-	std::auto_ptr <IMAPParser::response> resp(m_connection->readResponse());
+	if (set.isUIDSet())
+		chunks = batcher.split(set, prefix.length() + suffix.length());
+	else
+		chunks.push_back(set);
 
-	if (resp->isBad() || resp->response_done()->response_tagged()->
-		resp_cond_state()->status() != IMAPParser::resp_cond_state::OK)
+	std::vector <string> commands;
+	commands.reserve(chunks.size());
+
+	for (std::vector <messageSet>::const_iterator it = chunks.begin() ; it != chunks.end() ; ++it)
+		commands.push_back(prefix + IMAPUtils::messageSetToSequenceSet(*it) + suffix);
+
+	// Send the requests and process the responses
+	messageSet copyUIDs = messageSet::empty();
+
+	statusResponseHandler handler(this, &copyUIDs);
+
+	try
 	{
-		throw exceptions::command_error("COPY",
-			resp->getErrorLog(), "bad response");
+		batcher.execute(m_connection, "COPY", commands, handler);
 	}
+	catch (exceptions::command_error& e)
+	{
+		const std::vector <size_t>& completed = handler.getCompletedCommands();
 
-	processStatusUpdate(resp.get());
+		if (completed.empty())
+			throw;
 
-	const IMAPParser::resp_text_code* respTextCode =
-		resp->response_done()->response_tagged()->resp_cond_state()->resp_text()->resp_text_code();
+		// Some messages have been copied: tell the caller which ones
+		numberSet done;
 
-	if (respTextCode && respTextCode->type() == IMAPParser::resp_text_code::COPYUID)
-		return IMAPUtils::buildMessageSet(respTextCode->uid_set2());
+		for (std::vector <size_t>::const_iterator it = completed.begin() ; it != completed.end() ; ++it)
+			done.unionWith(numberSet::fromSequenceSet(IMAPUtils::messageSetToSequenceSet(chunks[*it])));
 
-	return messageSet::empty();
+		throw exceptions::partial_command_error("COPY", e.response(), done.toSequenceSet(), e);
+	}
+
+	return copyUIDs;
 }
 
 
@@ -1296,14 +1500,7 @@ shared_ptr <folderStatus> IMAPFolder::getStatus()
 	command << "STATUS ";
 	command << IMAPUtils::quoteString(IMAPUtils::pathToString
 			(m_connection->hierarchySeparator(), getFullPath()));
-	command << " (";
-
-	command << "MESSAGES" << ' ' << "UNSEEN" << ' ' << "UIDNEXT" << ' ' << "UIDVALIDITY";
-
-	if (m_connection->hasCapability("CONDSTORE"))
-		command << ' ' << "HIGHESTMODSEQ";
-
-	command << ")";
+	command << ' ' << IMAPUtils::buildStatusItemList(m_connection);
 
 	// Send the request
 	m_connection->send(true, command.str(), true);
@@ -1479,11 +1676,13 @@ void IMAPFolder::processStatusUpdate(const IMAPParser::response* resp)
 			if ((*it)->response_data()->message_data()->type() == IMAPParser::message_data::FETCH)
 			{
 				// Message changed
+				std::vector <IMAPMessage*> msgs;
+				m_messages.find(msgNumber, msgs);
+
 				for (std::vector <IMAPMessage*>::iterator mit =
-				     m_messages.begin() ; mit != m_messages.end() ; ++mit)
+				     msgs.begin() ; mit != msgs.end() ; ++mit)
 				{
-					if ((*mit)->getNumber() == msgNumber)
-						(*mit)->processFetchResponse(/* options */ 0, msgData);
+					(*mit)->processFetchResponse(/* options */ 0, msgData);
 				}
 
 				events.push_back(make_shared <events::messageChangedEvent>
@@ -1493,14 +1692,16 @@ void IMAPFolder::processStatusUpdate(const IMAPParser::response* resp)
 			}
 			else if ((*it)->response_data()->message_data()->type() == IMAPParser::message_data::EXPUNGE)
 			{
-				// A message has been expunged, renumber messages
+				// A message has been expunged: messages which follow
+				// are implicitly renumbered by the registry
+				std::vector <IMAPMessage*> msgs;
+				m_messages.expunge(msgNumber, msgs);
+
 				for (std::vector <IMAPMessage*>::iterator jt =
-				     m_messages.begin() ; jt != m_messages.end() ; ++jt)
+				     msgs.begin() ; jt != msgs.end() ; ++jt)
 				{
-					if ((*jt)->getNumber() == msgNumber)
-						(*jt)->setExpunged();
-					else if ((*jt)->getNumber() > msgNumber)
-						(*jt)->renumber((*jt)->getNumber() - 1);
+					(*jt)->renumber(msgNumber);
+					(*jt)->setExpunged();
 				}
 
 				events.push_back(make_shared <events::messageCountEvent>
@@ -37,6 +37,7 @@
 #include "vmime/types.hpp"
 
 #include "vmime/net/folder.hpp"
+#include "vmime/net/messageRegistry.hpp"
 
 #include "vmime/net/imap/IMAPParser.hpp"
 
@@ -50,6 +51,7 @@ class IMAPStore;
 class IMAPMessage;
 class IMAPConnection;
 class IMAPFolderStatus;
+class IMAPCache;
 
 
 /** IMAP folder implementation.
@@ -158,8 +160,10 @@ public:
 
 private:
 
-	void registerMessage(IMAPMessage* msg);
-	void unregisterMessage(IMAPMessage* msg);
+	size_t registerMessage(IMAPMessage* msg, const int num);
+	void unregisterMessage(IMAPMessage* msg, const size_t slot);
+
+	int getMessageNumber(const size_t slot) const;
 
 	void onStoreDisconnected();
 
@@ -171,6 +175,25 @@ private:
 
 	void copyMessagesImpl(const string& set, const folder::path& dest);
 
+	void fetchMessagesImpl(std::vector <shared_ptr <message> >& msg, const fetchAttributes& options, utility::progressListener* progress);
+
+	/** Return the local cache, if one is set on the store and
+	  * the folder is open.
+	  *
+	  * @return cache, or NULL if there is no cache
+	  */
+	shared_ptr <IMAPCache> getCache() const;
+
+	/** Return the name of this folder, as used in the cache.
+	  *
+	  * @return mailbox name
+	  */
+	const string getCacheMailboxName() const;
+
+	// Handlers for the responses to batched commands
+	class fetchResponseHandler;
+	class statusResponseHandler;
+
 
 	/** Process status updates ("unsolicited responses") contained in the
 	  * specified response. Example:
@@ -193,11 +216,13 @@ private:
 	int m_mode;
 	bool m_open;
 
+	bool m_cachedFlagsValid;  // false after flags have been changed by us
+
 	shared_ptr <folderAttributes> m_attribs;
 
 	shared_ptr <IMAPFolderStatus> m_status;
 
-	std::vector <IMAPMessage*> m_messages;
+	messageRegistry <IMAPMessage> m_messages;
 };
 
 
@@ -104,7 +104,8 @@ bool IMAPFolderStatus::updateFromResponse(const IMAPParser::mailbox_data* resp)
 {
 	bool changed = false;
 
-	if (resp->type() == IMAPParser::mailbox_data::STATUS)
+	// Status attribute list may be empty: "STATUS mbox ()"
+	if (resp->type() == IMAPParser::mailbox_data::STATUS && resp->status_att_list())
 	{
 		const IMAPParser::status_att_list* statusAttList = resp->status_att_list();
 
@@ -52,6 +52,58 @@ namespace imap {
 
 #ifndef VMIME_BUILDING_DOC
 
+//
+// IMAPMessage_teeOutputStream
+//
+
+// Copies data written to a stream into the cache. If the cache
+// fails, data is still written to the stream
+class IMAPMessage_teeOutputStream : public utility::outputStream
+{
+public:
+
+	IMAPMessage_teeOutputStream(utility::outputStream& os, shared_ptr <IMAPCache::partContentsWriter> writer)
+		: m_os(os), m_writer(writer)
+	{
+	}
+
+	shared_ptr <IMAPCache::partContentsWriter> getCacheWriter()
+	{
+		return m_writer;
+	}
+
+	void flush()
+	{
+		m_os.flush();
+	}
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count)
+	{
+		m_os.write(data, count);
+
+		if (m_writer)
+		{
+			try
+			{
+				m_writer->getOutputStream().write(data, count);
+			}
+			catch (std::exception&)
+			{
+				// Do not cache the contents
+				m_writer = null;
+			}
+		}
+	}
+
+private:
+
+	utility::outputStream& m_os;
+	shared_ptr <IMAPCache::partContentsWriter> m_writer;
+};
+
+
 //
 // IMAPMessage_literalHandler
 //
@@ -101,7 +153,7 @@ IMAPMessage::IMAPMessage(shared_ptr <IMAPFolder> folder, const int num)
 	: m_folder(folder), m_num(num), m_size(-1U), m_flags(FLAG_UNDEFINED),
 	  m_expunged(false), m_modseq(0), m_structure(null)
 {
-	folder->registerMessage(this);
+	m_slot = folder->registerMessage(this, num);
 }
 
 
@@ -109,7 +161,7 @@ IMAPMessage::IMAPMessage(shared_ptr <IMAPFolder> folder, const int num, const ui
 	: m_folder(folder), m_num(num), m_size(-1), m_flags(FLAG_UNDEFINED),
 	  m_expunged(false), m_uid(uid), m_modseq(0), m_structure(null)
 {
-	folder->registerMessage(this);
+	m_slot = folder->registerMessage(this, num);
 }
 
 
@@ -117,8 +169,8 @@ IMAPMessage::~IMAPMessage()
 {
 	shared_ptr <IMAPFolder> folder = m_folder.lock();
 
-	if (folder)
-		folder->unregisterMessage(this);
+	if (folder && !m_expunged)
+		folder->unregisterMessage(this, m_slot);
 }
 
 
@@ -130,6 +182,13 @@ void IMAPMessage::onFolderClosed()
 
 int IMAPMessage::getNumber() const
 {
+	shared_ptr <IMAPFolder> folder = m_folder.lock();
+
+	// Number of a live message may have changed since it was last
+	// read, if messages have been expunged from the folder
+	if (folder && !m_expunged)
+		return folder->getMessageNumber(m_slot);
+
 	return (m_num);
 }
 
@@ -237,42 +296,81 @@ void IMAPMessage::fetchPartHeader(shared_ptr <messagePart> p)
 	if (!folder)
 		throw exceptions::folder_not_found();
 
-	std::ostringstream oss;
-	utility::outputStreamAdapter ossAdapter(oss);
+	vmime::header& partHeader = dynamicCast <IMAPMessagePart>(p)->getOrCreateHeader();
 
-	extractImpl(p, ossAdapter, NULL, 0, -1, EXTRACT_HEADER | EXTRACT_PEEK);
+	// The cache holds raw section data, which is handled by extractImpl()
+	if (folder->getCache() && !m_uid.empty())
+	{
+		std::ostringstream oss;
+		utility::outputStreamAdapter ossAdapter(oss);
 
-	dynamicCast <IMAPMessagePart>(p)->getOrCreateHeader().parse(oss.str());
-}
+		extractImpl(p, ossAdapter, NULL, 0, -1, EXTRACT_HEADER | EXTRACT_PEEK);
 
+		partHeader.parse(oss.str());
 
-void IMAPMessage::fetchPartHeaderForStructure(shared_ptr <messageStructure> str)
-{
-	for (size_t i = 0, n = str->getPartCount() ; i < n ; ++i)
+		return;
+	}
+
+	// Else, the header literal is parsed directly from the receive buffer
+	const string section = getPartSection(p);
+
+	std::ostringstream command;
+	command.imbue(std::locale::classic());
+
+	if (m_uid.empty())
+		command << "FETCH " << getNumber();
+	else
+		command << "UID FETCH " << m_uid;
+
+	command << " BODY.PEEK[" << (section.empty() ? "HEADER" : section + ".MIME") << "]";
+
+	folder->m_connection->send(true, command.str(), true);
+
+	std::auto_ptr <IMAPParser::response> resp(folder->m_connection->readResponse());
+
+	if (resp->isBad() || resp->response_done()->response_tagged()->
+		resp_cond_state()->status() != IMAPParser::resp_cond_state::OK)
 	{
-		shared_ptr <messagePart> part = str->getPartAt(i);
+		throw exceptions::command_error("FETCH",
+			resp->getErrorLog(), "bad response");
+	}
 
-		// Fetch header of current part
-		fetchPartHeader(part);
+	const std::vector <IMAPParser::continue_req_or_response_data*>& respDataList =
+		resp->continue_req_or_response_data();
 
-		// Fetch header of sub-parts
-		fetchPartHeaderForStructure(part->getStructure());
+	for (std::vector <IMAPParser::continue_req_or_response_data*>::const_iterator
+	     it = respDataList.begin() ; it != respDataList.end() ; ++it)
+	{
+		if ((*it)->response_data() == NULL)
+			continue;
+
+		const IMAPParser::message_data* msgData = (*it)->response_data()->message_data();
+
+		if (msgData == NULL || msgData->type() != IMAPParser::message_data::FETCH)
+			continue;
+
+		const std::vector <IMAPParser::msg_att_item*> atts = msgData->msg_att()->items();
+
+		for (std::vector <IMAPParser::msg_att_item*>::const_iterator
+		     jt = atts.begin() ; jt != atts.end() ; ++jt)
+		{
+			if ((*jt)->type() != IMAPParser::msg_att_item::BODY_SECTION)
+				continue;
+
+			shared_ptr <vmime::header> hdr = (*jt)->header();
+
+			if (hdr)
+				IMAPUtils::moveHeaderFields(*hdr, partHeader, /* replace */ true);
+			else
+				partHeader.removeAllFields();
+		}
 	}
 }
 
 
-void IMAPMessage::extractImpl
-	(shared_ptr <const messagePart> p,
-	 utility::outputStream& os,
-	 utility::progressListener* progress,
-	 const size_t start, const size_t length,
-	 const int extractFlags) const
+// static
+const string IMAPMessage::getPartSection(shared_ptr <const messagePart> p)
 {
-	shared_ptr <const IMAPFolder> folder = m_folder.lock();
-
-	IMAPMessage_literalHandler literalHandler(os, progress);
-
-	// Construct section identifier
 	std::ostringstream section;
 	section.imbue(std::locale::classic());
 
@@ -299,12 +397,45 @@ void IMAPMessage::extractImpl
 		}
 	}
 
+	return section.str();
+}
+
+
+void IMAPMessage::fetchPartHeaderForStructure(shared_ptr <messageStructure> str)
+{
+	for (size_t i = 0, n = str->getPartCount() ; i < n ; ++i)
+	{
+		shared_ptr <messagePart> part = str->getPartAt(i);
+
+		// Fetch header of current part
+		fetchPartHeader(part);
+
+		// Fetch header of sub-parts
+		fetchPartHeaderForStructure(part->getStructure());
+	}
+}
+
+
+void IMAPMessage::extractImpl
+	(shared_ptr <const messagePart> p,
+	 utility::outputStream& os,
+	 utility::progressListener* progress,
+	 const size_t start, const size_t length,
+	 const int extractFlags) const
+{
+	shared_ptr <const IMAPFolder> folder = m_folder.lock();
+
+	IMAPMessage_literalHandler literalHandler(os, progress);
+
+	// Construct section identifier
+	const string section = getPartSection(p);
+
 	// Build the request text
 	std::ostringstream command;
 	command.imbue(std::locale::classic());
 
 	if (m_uid.empty())
-		command << "FETCH " << m_num << " BODY";
+		command << "FETCH " << getNumber() << " BODY";
 	else
 		command << "UID FETCH " << m_uid << " BODY";
 
@@ -322,7 +453,7 @@ void IMAPMessage::extractImpl
 
 	command << "[";
 
-	if (section.str().empty())
+	if (section.empty())
 	{
 		// header + body
 		if ((extractFlags & EXTRACT_HEADER) && (extractFlags & EXTRACT_BODY))
@@ -336,7 +467,7 @@ void IMAPMessage::extractImpl
 	}
 	else
 	{
-		command << section.str();
+		command << section;
 
 		// header + body
 		if ((extractFlags & EXTRACT_HEADER) && (extractFlags & EXTRACT_BODY))
@@ -348,15 +479,63 @@ void IMAPMessage::extractImpl
 
 	command << "]";
 
-	if (start != 0 || length != static_cast <size_t>(-1))
+	const bool partial = (start != 0 || length != static_cast <size_t>(-1));
+
+	if (partial)
 		command << "<" << start << "." << length << ">";
 
+	// Only complete sections are cached. As the server would set the
+	// "\Seen" flag, data is taken from the cache only if this would
+	// not change anything.
+	shared_ptr <IMAPCache> cache = folder->getCache();
+
+	if (partial || m_uid.empty())
+		cache = null;
+
+	// Section specification, between the brackets (eg. "1.2.MIME")
+	const string cmd = command.str();
+	const size_t bracket = cmd.find('[') + 1;
+	const string cacheSection = cmd.substr(bracket, cmd.length() - bracket - 1);
+
+	if (cache)
+	{
+		const bool seen = (m_flags != FLAG_UNDEFINED && (m_flags & FLAG_SEEN));
+
+		if (((extractFlags & EXTRACT_PEEK) || seen || !(extractFlags & EXTRACT_BODY)) &&
+		    cache->getPartContents(folder->getCacheMailboxName(), folder->getUIDValidity(),
+		                           m_uid, cacheSection, os))
+		{
+			return;
+		}
+	}
+
+	// Contents are written to the cache while they are received. Cache
+	// errors are ignored: they must not make the fetch fail
+	shared_ptr <IMAPCache::partContentsWriter> cacheWriter;
+
+	if (cache)
+	{
+		try
+		{
+			cacheWriter = cache->createPartContentsWriter
+				(folder->getCacheMailboxName(), folder->getUIDValidity(), m_uid, cacheSection);
+		}
+		catch (std::exception&)
+		{
+			// Do not cache the contents
+		}
+	}
+
+	IMAPMessage_teeOutputStream teeStream(os, cacheWriter);
+	IMAPMessage_literalHandler teeLiteralHandler(teeStream, progress);
+
 	// Send the request
 	constCast <IMAPFolder>(folder)->m_connection->send(true, command.str(), true);
 
 	// Get the response
 	std::auto_ptr <IMAPParser::response> resp
-		(constCast <IMAPFolder>(folder)->m_connection->readResponse(&literalHandler));
+		(constCast <IMAPFolder>(folder)->m_connection->readResponse
+			(cacheWriter ? &teeLiteralHandler : &literalHandler));
 
 	if (resp->isBad() || resp->response_done()->response_tagged()->
 		resp_cond_state()->status() != IMAPParser::resp_cond_state::OK)
@@ -366,6 +545,18 @@ void IMAPMessage::extractImpl
 	}
 
 
+	if (teeStream.getCacheWriter())
+	{
+		try
+		{
+			teeStream.getCacheWriter()->commit();
+		}
+		catch (std::exception&)
+		{
+			// Ignore
+		}
+	}
+
 	if (extractFlags & EXTRACT_BODY)
 	{
 		// TODO: update the flags (eg. flag "\Seen" may have been set)
@@ -476,7 +667,15 @@ int IMAPMessage::processFetchResponse
 		}
 		case IMAPParser::msg_att_item::RFC822_HEADER:
 		{
-			getOrCreateHeader()->parse((*it)->nstring()->value());
+			shared_ptr <vmime::header> hdr = (*it)->header();
+
+			if (!hdr)  // NIL
+				getOrCreateHeader()->removeAllFields();
+			else if (!m_header)
+				m_header = hdr;
+			else
+				IMAPUtils::moveHeaderFields(*hdr, *m_header, /* replace */ true);
+
 			break;
 		}
 		case IMAPParser::msg_att_item::RFC822_SIZE:
@@ -492,17 +691,10 @@ int IMAPMessage::processFetchResponse
 				    (*it)->section()->section_text1()->type()
 				        == IMAPParser::section_text::HEADER_FIELDS)
 				{
-					header tempHeader;
-					tempHeader.parse((*it)->nstring()->value());
-
-					vmime::header& hdr = *getOrCreateHeader();
-					std::vector <shared_ptr <headerField> > fields = tempHeader.getFieldList();
+					shared_ptr <vmime::header> hdr = (*it)->header();
 
-					for (std::vector <shared_ptr <headerField> >::const_iterator jt = fields.begin() ;
-					     jt != fields.end() ; ++jt)
-					{
-						hdr.appendField(vmime::clone(*jt));
-					}
+					if (hdr)
+						IMAPUtils::moveHeaderFields(*hdr, *getOrCreateHeader(), /* replace */ false);
 				}
 			}
 
@@ -523,6 +715,123 @@ int IMAPMessage::processFetchResponse
 }
 
 
+bool IMAPMessage::processCachedInfo
+	(const fetchAttributes& options, const IMAPCache::messageInfo& info, const bool flagsValid)
+{
+	static const int HEADER_ATTRIBUTES =
+		fetchAttributes::ENVELOPE | fetchAttributes::CONTENT_INFO | fetchAttributes::IMPORTANCE;
+
+	static const int CACHEABLE_ATTRIBUTES =
+		HEADER_ATTRIBUTES | fetchAttributes::FULL_HEADER | fetchAttributes::STRUCTURE |
+		fetchAttributes::SIZE | fetchAttributes::FLAGS | fetchAttributes::UID;
+
+	if (options.has(~CACHEABLE_ATTRIBUTES))
+		return false;
+
+	// Check that everything is available
+	const bool fullHeader = (info.attributes & fetchAttributes::FULL_HEADER) != 0;
+	const bool needHeader = options.has(HEADER_ATTRIBUTES | fetchAttributes::FULL_HEADER) ||
+		!options.getHeaderFields().empty();
+
+	if (!fullHeader)
+	{
+		if (options.has(fetchAttributes::FULL_HEADER) || !options.getHeaderFields().empty())
+			return false;
+
+		if (options.has(HEADER_ATTRIBUTES & ~info.attributes))
+			return false;
+	}
+
+	if (options.has(fetchAttributes::STRUCTURE) && !(info.attributes & fetchAttributes::STRUCTURE))
+		return false;
+
+	if (options.has(fetchAttributes::SIZE) && !(info.attributes & fetchAttributes::SIZE))
+		return false;
+
+	if (options.has(fetchAttributes::FLAGS) && (!flagsValid || !(info.attributes & fetchAttributes::FLAGS)))
+		return false;
+
+	shared_ptr <IMAPMessageStructure> structure;
+
+	if (options.has(fetchAttributes::STRUCTURE))
+	{
+		if (!(structure = IMAPMessageStructure::unserialize(info.structure)))
+			return false;
+	}
+
+	// Update message attributes
+	if (needHeader)
+		getOrCreateHeader()->parse(info.header);
+
+	if (structure)
+		m_structure = structure;
+
+	if (options.has(fetchAttributes::SIZE))
+		m_size = info.size;
+
+	if (options.has(fetchAttributes::FLAGS))
+	{
+		m_flags = info.flags;
+		m_modseq = info.modSequence;
+	}
+
+	return true;
+}
+
+
+void IMAPMessage::updateCachedInfo(const fetchAttributes& options, IMAPCache::messageInfo& info) const
+{
+	static const int HEADER_ATTRIBUTES =
+		fetchAttributes::ENVELOPE | fetchAttributes::CONTENT_INFO |
+		fetchAttributes::IMPORTANCE | fetchAttributes::FULL_HEADER;
+
+	if (options.has(fetchAttributes::STRUCTURE))
+	{
+		shared_ptr <IMAPMessageStructure> structure = dynamicCast <IMAPMessageStructure>(m_structure);
+
+		if (structure)
+		{
+			info.structure = structure->serialize();
+			info.attributes |= fetchAttributes::STRUCTURE;
+		}
+	}
+
+	if (options.has(HEADER_ATTRIBUTES) && m_header)
+	{
+		// Do not replace a full header with a partial one
+		if (options.has(fetchAttributes::FULL_HEADER) || !(info.attributes & fetchAttributes::FULL_HEADER))
+		{
+			int headerAttribs = 0;
+
+			for (int attr = fetchAttributes::ENVELOPE ; attr <= fetchAttributes::IMPORTANCE ; attr <<= 1)
+			{
+				if ((attr & HEADER_ATTRIBUTES) && options.has(attr))
+					headerAttribs |= attr;
+			}
+
+			info.header = m_header->generate();
+			info.attributes = (info.attributes & ~HEADER_ATTRIBUTES) | headerAttribs;
+		}
+	}
+
+	if (options.has(fetchAttributes::SIZE) && m_size != static_cast <size_t>(-1))
+	{
+		info.size = m_size;
+		info.attributes |= fetchAttributes::SIZE;
+	}
+
+	if (options.has(fetchAttributes::FLAGS) && m_flags != FLAG_UNDEFINED)
+	{
+		shared_ptr <const IMAPFolder> folder = m_folder.lock();
+
+		info.flags = m_flags;
+		info.modSequence = m_modseq;
+		info.highestModSequence = folder ? folder->getHighestModSequence() : 0;
+		info.attributes |= fetchAttributes::FLAGS;
+	}
+}
+
+
 shared_ptr <header> IMAPMessage::getOrCreateHeader()
 {
 	if (m_header != NULL)
@@ -542,7 +851,7 @@ void IMAPMessage::setFlags(const int flags, const int mode)
 	if (!m_uid.empty())
 		folder->setMessageFlags(messageSet::byUID(m_uid), flags, mode);
 	else
-		folder->setMessageFlags(messageSet::byNumber(m_num), flags, mode);
+		folder->setMessageFlags(messageSet::byNumber(getNumber()), flags, mode);
 }
 
 
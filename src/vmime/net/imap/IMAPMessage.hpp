@@ -35,6 +35,7 @@
 #include "vmime/net/folder.hpp"
 
 #include "vmime/net/imap/IMAPParser.hpp"
+#include "vmime/net/imap/IMAPCache.hpp"
 
 
 namespace vmime {
@@ -54,6 +55,7 @@ private:
 
 	friend class IMAPFolder;
 	friend class IMAPMessagePartContentHandler;
+	friend class IMAPMessagePartInputStream;
 
 	IMAPMessage(const IMAPMessage&) : message() { }
 
@@ -131,6 +133,25 @@ private:
 	  */
 	int processFetchResponse(const fetchAttributes& options, const IMAPParser::message_data* msgData);
 
+	/** Fill in message attributes from data stored in the local cache.
+	  * Nothing is changed unless all the requested attributes are
+	  * available from the cache.
+	  *
+	  * @param options attributes to fetch
+	  * @param info data from the cache
+	  * @param flagsValid whether the cached flags are up to date
+	  * @return true if all attributes were taken from the cache,
+	  * false otherwise
+	  */
+	bool processCachedInfo(const fetchAttributes& options, const IMAPCache::messageInfo& info, const bool flagsValid);
+
+	/** Update cache data with the attributes which have been fetched.
+	  *
+	  * @param options attributes which have been fetched
+	  * @param info cache data to update
+	  */
+	void updateCachedInfo(const fetchAttributes& options, IMAPCache::messageInfo& info) const;
+
 	/** Recursively fetch part header for all parts in the structure.
 	  *
 	  * @param str structure for which to fetch parts headers
@@ -154,6 +175,14 @@ private:
 		EXTRACT_PEEK = 0x10
 	};
 
+	/** Return the section specification of a part, as used
+	  * in FETCH commands (eg. "1.2").
+	  *
+	  * @param p part, or NULL for the whole message
+	  * @return section specification, or empty for the whole message
+	  */
+	static const string getPartSection(shared_ptr <const messagePart> p);
+
 	void extractImpl
 		(shared_ptr <const messagePart> p,
 		 utility::outputStream& os,
@@ -170,6 +199,7 @@ private:
 	weak_ptr <IMAPFolder> m_folder;
 
 	int m_num;
+	size_t m_slot;
 	size_t m_size;
 	int m_flags;
 	bool m_expunged;
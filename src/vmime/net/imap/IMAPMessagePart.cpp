@@ -74,6 +74,13 @@ IMAPMessagePart::IMAPMessagePart(shared_ptr <IMAPMessagePart> parent, const int
 }
 
 
+IMAPMessagePart::IMAPMessagePart(shared_ptr <IMAPMessagePart> parent, const int number,
+	const mediaType& type, const size_t size)
+	: m_parent(parent), m_header(null), m_number(number), m_size(size), m_mediaType(type)
+{
+}
+
+
 shared_ptr <const messageStructure> IMAPMessagePart::getStructure() const
 {
 	if (m_structure != NULL)
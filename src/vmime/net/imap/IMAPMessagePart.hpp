@@ -46,10 +46,13 @@ class IMAPMessageStructure;
 
 class VMIME_EXPORT IMAPMessagePart : public messagePart
 {
+	friend class IMAPMessageStructure;
+
 public:
 
 	IMAPMessagePart(shared_ptr <IMAPMessagePart> parent, const int number, const IMAPParser::body_type_mpart* mpart);
 	IMAPMessagePart(shared_ptr <IMAPMessagePart> parent, const int number, const IMAPParser::body_type_1part* part);
+	IMAPMessagePart(shared_ptr <IMAPMessagePart> parent, const int number, const mediaType& type, const size_t size);
 
 	shared_ptr <const messageStructure> getStructure() const;
 	shared_ptr <messageStructure> getStructure();
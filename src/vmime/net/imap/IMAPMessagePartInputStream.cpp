@@ -0,0 +1,78 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+
+#include "vmime/net/imap/IMAPMessagePartInputStream.hpp"
+#include "vmime/net/imap/IMAPMessage.hpp"
+
+#include "vmime/utility/outputStreamStringAdapter.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+IMAPMessagePartInputStream::IMAPMessagePartInputStream
+	(shared_ptr <IMAPMessage> msg, shared_ptr <const messagePart> part)
+	: windowedInputStream(getSourceSize(msg, part)), m_message(msg), m_part(part)
+{
+}
+
+
+// static
+size_t IMAPMessagePartInputStream::getSourceSize
+	(shared_ptr <IMAPMessage> msg, shared_ptr <const messagePart> part)
+{
+	// The size is not known for message parts (message/rfc822):
+	// it will be found when the end is reached
+	const size_t size = part ? part->getSize() : msg->getSize();
+
+	return size != 0 ? size : UNKNOWN_SIZE;
+}
+
+
+void IMAPMessagePartInputStream::fetch(const size_t offset, const size_t length, string& data)
+{
+	utility::outputStreamStringAdapter os(data);
+
+	const int flags = IMAPMessage::EXTRACT_BODY | IMAPMessage::EXTRACT_PEEK |
+		(m_part ? 0 : IMAPMessage::EXTRACT_HEADER);
+
+	m_message->extractImpl(m_part, os, NULL, offset, length, flags);
+
+	os.flush();
+}
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
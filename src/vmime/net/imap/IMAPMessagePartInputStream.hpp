@@ -0,0 +1,89 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_NET_IMAP_IMAPMESSAGEPARTINPUTSTREAM_HPP_INCLUDED
+#define VMIME_NET_IMAP_IMAPMESSAGEPARTINPUTSTREAM_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+
+#include "vmime/net/message.hpp"
+
+#include "vmime/utility/windowedInputStream.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace imap {
+
+
+class IMAPMessage;
+
+
+/** A seekable stream over the contents of a message part stored on an
+  * IMAP server. Contents are fetched on demand using partial fetches
+  * (BODY.PEEK[section]<offset.length>), so reading the beginning of a
+  * large attachment does not download all of it.
+  *
+  * Contents are returned as stored on the server (ie. not decoded).
+  * Reading from the stream does not set the "\Seen" flag.
+  */
+
+class VMIME_EXPORT IMAPMessagePartInputStream : public utility::windowedInputStream
+{
+public:
+
+	/** Construct a stream over a message part.
+	  *
+	  * @param msg message
+	  * @param part message part, as returned by getStructure(), or NULL
+	  * to read the whole message (its size must have been fetched before)
+	  */
+	IMAPMessagePartInputStream(shared_ptr <IMAPMessage> msg, shared_ptr <const messagePart> part);
+
+protected:
+
+	void fetch(const size_t offset, const size_t length, string& data);
+
+private:
+
+	static size_t getSourceSize(shared_ptr <IMAPMessage> msg, shared_ptr <const messagePart> part);
+
+
+	shared_ptr <IMAPMessage> m_message;
+	shared_ptr <const messagePart> m_part;
+};
+
+
+} // imap
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_IMAP
+
+#endif // VMIME_NET_IMAP_IMAPMESSAGEPARTINPUTSTREAM_HPP_INCLUDED
@@ -30,6 +30,8 @@
 #include "vmime/net/imap/IMAPMessageStructure.hpp"
 #include "vmime/net/imap/IMAPMessagePart.hpp"
 
+#include <sstream>
+
 
 namespace vmime {
 namespace net {
@@ -85,6 +87,118 @@ shared_ptr <IMAPMessageStructure> IMAPMessageStructure::emptyStructure()
 }
 
 
+const string IMAPMessageStructure::serialize() const
+{
+	std::ostringstream oss;
+	oss.imbue(std::locale::classic());
+
+	serialize(oss);
+
+	return oss.str();
+}
+
+
+void IMAPMessageStructure::serialize(std::ostream& os) const
+{
+	// Format, for each structure:
+	//    <part count> LF
+	// then, for each part:
+	//    <media type> SP <size> SP <header length or "-"> LF [header]
+	//    <structure of sub-parts>
+	os << m_parts.size() << "\n";
+
+	for (std::vector <shared_ptr <IMAPMessagePart> >::const_iterator
+	     it = m_parts.begin() ; it != m_parts.end() ; ++it)
+	{
+		const IMAPMessagePart& part = **it;
+
+		os << part.m_mediaType.generate() << ' ' << part.m_size << ' ';
+
+		if (part.m_header)
+		{
+			const string hdr = part.m_header->generate();
+			os << hdr.length() << "\n" << hdr;
+		}
+		else
+		{
+			os << "-\n";
+		}
+
+		if (part.m_structure)
+			part.m_structure->serialize(os);
+		else
+			os << "0\n";
+	}
+}
+
+
+// static
+shared_ptr <IMAPMessageStructure> IMAPMessageStructure::unserialize(const string& data)
+{
+	std::istringstream iss(data);
+	iss.imbue(std::locale::classic());
+
+	shared_ptr <IMAPMessageStructure> str = make_shared <IMAPMessageStructure>();
+
+	if (!str->unserialize(iss, null))
+		return null;
+
+	return str;
+}
+
+
+bool IMAPMessageStructure::unserialize(std::istream& is, shared_ptr <IMAPMessagePart> parent)
+{
+	size_t count = 0;
+
+	if (!(is >> count) || is.get() != '\n')
+		return false;
+
+	for (size_t i = 0 ; i < count ; ++i)
+	{
+		string type, headerLength;
+		size_t size = 0;
+
+		if (!(is >> type >> size >> headerLength) || is.get() != '\n')
+			return false;
+
+		mediaType mt;
+		mt.parse(type);
+
+		shared_ptr <IMAPMessagePart> part = make_shared <IMAPMessagePart>
+			(parent, static_cast <int>(i), mt, size);
+
+		if (headerLength != "-")
+		{
+			std::istringstream lenStream(headerLength);
+			size_t length = 0;
+
+			if (!(lenStream >> length))
+				return false;
+
+			string hdr(length, '\0');
+
+			if (length != 0 && !is.read(&hdr[0], static_cast <std::streamsize>(length)))
+				return false;
+
+			part->getOrCreateHeader().parse(hdr);
+		}
+
+		shared_ptr <IMAPMessageStructure> sub = make_shared <IMAPMessageStructure>();
+
+		if (!sub->unserialize(is, part))
+			return false;
+
+		if (sub->getPartCount() != 0)
+			part->m_structure = sub;
+
+		m_parts.push_back(part);
+	}
+
+	return true;
+}
+
+
 } // imap
 } // net
 } // vmime
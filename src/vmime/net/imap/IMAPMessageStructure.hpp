@@ -35,6 +35,9 @@
 
 #include "vmime/net/imap/IMAPParser.hpp"
 
+#include <istream>
+#include <ostream>
+
 
 namespace vmime {
 namespace net {
@@ -58,8 +61,27 @@ public:
 
 	static shared_ptr <IMAPMessageStructure> emptyStructure();
 
+	/** Serialize this structure to a string, so that it can be
+	  * stored in a cache. Part headers are included if they have
+	  * been fetched.
+	  *
+	  * @return serialized structure
+	  * @see unserialize()
+	  */
+	const string serialize() const;
+
+	/** Rebuild a structure from the output of serialize().
+	  *
+	  * @param data serialized structure
+	  * @return structure, or NULL if the data is not valid
+	  */
+	static shared_ptr <IMAPMessageStructure> unserialize(const string& data);
+
 private:
 
+	void serialize(std::ostream& os) const;
+	bool unserialize(std::istream& is, shared_ptr <IMAPMessagePart> parent);
+
 	std::vector <shared_ptr <IMAPMessagePart> > m_parts;
 };
 
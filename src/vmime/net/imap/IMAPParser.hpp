@@ -35,6 +35,7 @@
 #include "vmime/dateTime.hpp"
 #include "vmime/charset.hpp"
 #include "vmime/exception.hpp"
+#include "vmime/header.hpp"
 
 #include "vmime/utility/stringUtils.hpp"
 #include "vmime/utility/progressListener.hpp"
@@ -53,6 +54,7 @@
 #include "vmime/net/imap/IMAPTag.hpp"
 
 #include <vector>
+#include <set>
 #include <stdexcept>
 #include <memory>
 
@@ -180,6 +182,41 @@ public:
 		return m_strict;
 	}
 
+	/** Set the tags a tagged response may carry. When the set is
+	  * empty (default), only the current connection tag is accepted.
+	  * This is used when several commands are pipelined, as their
+	  * completions may arrive for any of the outstanding tags.
+	  *
+	  * @param tags set of accepted tags
+	  */
+	void setExpectedTags(const std::set <string>& tags)
+	{
+		m_expectedTags = tags;
+	}
+
+	/** Return the tag of the last tagged response which was read.
+	  *
+	  * @return tag of the last tagged response
+	  */
+	const string& getLastTag() const
+	{
+		return m_lastTag;
+	}
+
+	/** Return whether the specified tag is accepted for a
+	  * tagged response.
+	  *
+	  * @param tag tag string read from the server
+	  * @return true if the tag is expected, false otherwise
+	  */
+	bool isExpectedTag(const string& tag) const
+	{
+		if (m_expectedTags.empty())
+			return tag == string(*getTag());
+
+		return m_expectedTags.find(tag) != m_expectedTags.end();
+	}
+
 
 
 	//
@@ -458,8 +495,9 @@ public:
 				}
 			}
 
-			if (tagString == string(*parser.getTag()))
+			if (parser.isExpectedTag(tagString))
 			{
+				parser.m_lastTag = tagString;
 				*currentPos = pos;
 			}
 			else
@@ -593,7 +631,7 @@ public:
 			size_t pos = *currentPos;
 
 			m_uniqueid1 = parser.get <uniqueid>(line, &pos);
-			parser.check <one_char <','> >(line, &pos);
+			parser.check <one_char <':'> >(line, &pos);
 			m_uniqueid2 = parser.get <uniqueid>(line, &pos);
 
 			*currentPos = pos;
@@ -1016,12 +1054,12 @@ public:
 						}
 						else
 						{
-							m_value = text->value();
+							storeQuoted(text->value());
 						}
 					}
 					else
 					{
-						m_value = text->value();
+						storeQuoted(text->value());
 					}
 
 					DEBUG_FOUND("string[quoted]", "<length=" << m_value.length() << ", value='" << m_value << "'>");
@@ -1058,14 +1096,12 @@ public:
 						}
 						else
 						{
-							literalHandler::targetString target(NULL, m_value);
-							parser.readLiteral(target, length);
+							storeLiteral(parser, length);
 						}
 					}
 					else
 					{
-						literalHandler::targetString target(NULL, m_value);
-						parser.readLiteral(target, length);
+						storeLiteral(parser, length);
 					}
 
 					line += parser.readLine();
@@ -1077,6 +1113,23 @@ public:
 			*currentPos = pos;
 		}
 
+	protected:
+
+		// Store the value of a quoted string which has not been
+		// redirected to a literal handler target
+		virtual void storeQuoted(const string& value)
+		{
+			m_value = value;
+		}
+
+		// Read and store a literal which has not been redirected
+		// to a literal handler target
+		virtual void storeLiteral(IMAPParser& parser, const size_t length)
+		{
+			literalHandler::targetString target(NULL, m_value);
+			parser.readLiteral(target, length);
+		}
+
 	private:
 
 		bool m_canBeNIL;
@@ -1107,6 +1160,52 @@ public:
 	};
 
 
+	//
+	// header_nstring  ::= nstring
+	//                     ;; Message or MIME header (RFC822.HEADER,
+	//                     ;; BODY[HEADER], BODY[HEADER.FIELDS (...)],
+	//                     ;; BODY[part.MIME]...)
+	//
+	// The header is parsed directly from the receive buffer, and
+	// value() is left empty.
+	//
+
+	class header_nstring : public nstring
+	{
+	public:
+
+		header_nstring(component* comp = NULL, const int data = 0)
+			: nstring(comp, data)
+		{
+		}
+
+	protected:
+
+		void storeQuoted(const string& value)
+		{
+			m_header = make_shared <vmime::header>();
+			m_header->parse(value);
+		}
+
+		void storeLiteral(IMAPParser& parser, const size_t length)
+		{
+			m_header = make_shared <vmime::header>();
+			m_header->parse(parser.peekLiteral(length), 0, length);
+
+			parser.skipLiteral(length);
+		}
+
+	private:
+
+		shared_ptr <vmime::header> m_header;
+
+	public:
+
+		// NULL if the server returned NIL
+		shared_ptr <vmime::header> header() const { return (m_header); }
+	};
+
+
 	//
 	// astring ::= atom / string
 	//
@@ -4127,7 +4226,8 @@ public:
 
 				parser.check <SPACE>(line, &pos);
 
-				m_nstring = parser.get <IMAPParser::nstring>(line, &pos);
+				m_nstring = parser.getWithArgs <IMAPParser::header_nstring>
+					(line, &pos, this, RFC822_HEADER);
 			}
 			// "RFC822" ".TEXT" SPACE nstring
 			else if (parser.checkWithArg <special_atom>(line, &pos, "rfc822.text", true))
@@ -4184,8 +4284,20 @@ public:
 
 					parser.check <SPACE>(line, &pos);
 
-					m_nstring = parser.getWithArgs <IMAPParser::nstring>
-						(line, &pos, this, BODY_SECTION);
+					// Complete header sections are parsed as headers
+					const section_text* text = m_section->section_text1() ?
+						m_section->section_text1() : m_section->section_text2();
+
+					if (m_number == NULL && text != NULL && text->type() != section_text::TEXT)
+					{
+						m_nstring = parser.getWithArgs <IMAPParser::header_nstring>
+							(line, &pos, this, BODY_SECTION);
+					}
+					else
+					{
+						m_nstring = parser.getWithArgs <IMAPParser::nstring>
+							(line, &pos, this, BODY_SECTION);
+					}
 				}
 				// "BODY" SPACE body
 				else
@@ -4264,6 +4376,15 @@ public:
 		const IMAPParser::uniqueid* unique_id() const { return (m_uniqueid); }
 		const IMAPParser::nstring* nstring() const { return (m_nstring); }
 		const IMAPParser::xbody* body() const { return (m_body); }
+
+		// Parsed header, for RFC822_HEADER and header sections of
+		// BODY_SECTION; NULL otherwise
+		shared_ptr <vmime::header> header() const
+		{
+			const header_nstring* hdr = dynamic_cast <const header_nstring*>(m_nstring);
+			return (hdr ? hdr->header() : null);
+		}
+
 		const IMAPParser::flag_list* flag_list() const { return (m_flag_list); }
 		const IMAPParser::section* section() const { return (m_section); }
 		const IMAPParser::mod_sequence_value* mod_sequence_value() { return m_mod_sequence_value; }
@@ -5684,6 +5805,9 @@ private:
 
 	weak_ptr <timeoutHandler> m_timeoutHandler;
 
+	std::set <string> m_expectedTags;
+	string m_lastTag;
+
 
 	string m_buffer;
 
@@ -5765,6 +5889,27 @@ public:
 	}
 
 
+	//
+	// Make the next "count" bytes of a literal available at the
+	// beginning of the receive buffer, and return the buffer.
+	// skipLiteral() must be called once the literal is processed.
+	//
+
+	const string& peekLiteral(const size_t count)
+	{
+		while (m_buffer.length() < count)
+			read();
+
+		return (m_buffer);
+	}
+
+
+	void skipLiteral(const size_t count)
+	{
+		m_buffer.erase(0, count);
+	}
+
+
 	void readLiteral(literalHandler::target& buffer, size_t count)
 	{
 		size_t len = 0;
@@ -59,6 +59,10 @@ const IMAPServiceInfos::props& IMAPServiceInfos::getProperties() const
 		property("options.sasl", serviceInfos::property::TYPE_BOOLEAN, "true"),
 		property("options.sasl.fallback", serviceInfos::property::TYPE_BOOLEAN, "true"),
 #endif // VMIME_HAVE_SASL_SUPPORT
+		property("options.batch.maxcommandlength", serviceInfos::property::TYPE_INTEGER, "8192"),
+		property("options.batch.maxmessages", serviceInfos::property::TYPE_INTEGER, "1000"),
+		property("options.batch.maxinflight", serviceInfos::property::TYPE_INTEGER, "1"),
+		property("options.status.maxinflight", serviceInfos::property::TYPE_INTEGER, "16"),
 
 		// Common properties
 		property(serviceInfos::property::AUTH_USERNAME, serviceInfos::property::FLAG_REQUIRED),
@@ -80,6 +84,10 @@ const IMAPServiceInfos::props& IMAPServiceInfos::getProperties() const
 		property("options.sasl", serviceInfos::property::TYPE_BOOLEAN, "true"),
 		property("options.sasl.fallback", serviceInfos::property::TYPE_BOOLEAN, "true"),
 #endif // VMIME_HAVE_SASL_SUPPORT
+		property("options.batch.maxcommandlength", serviceInfos::property::TYPE_INTEGER, "8192"),
+		property("options.batch.maxmessages", serviceInfos::property::TYPE_INTEGER, "1000"),
+		property("options.batch.maxinflight", serviceInfos::property::TYPE_INTEGER, "1"),
+		property("options.status.maxinflight", serviceInfos::property::TYPE_INTEGER, "16"),
 
 		// Common properties
 		property(serviceInfos::property::AUTH_USERNAME, serviceInfos::property::FLAG_REQUIRED),
@@ -108,6 +116,10 @@ const std::vector <serviceInfos::property> IMAPServiceInfos::getAvailablePropert
 	list.push_back(p.PROPERTY_OPTIONS_SASL);
 	list.push_back(p.PROPERTY_OPTIONS_SASL_FALLBACK);
 #endif // VMIME_HAVE_SASL_SUPPORT
+	list.push_back(p.PROPERTY_OPTIONS_BATCH_MAXCOMMANDLENGTH);
+	list.push_back(p.PROPERTY_OPTIONS_BATCH_MAXMESSAGES);
+	list.push_back(p.PROPERTY_OPTIONS_BATCH_MAXINFLIGHT);
+	list.push_back(p.PROPERTY_OPTIONS_STATUS_MAXINFLIGHT);
 
 	// Common properties
 	list.push_back(p.PROPERTY_AUTH_USERNAME);
@@ -55,6 +55,10 @@ public:
 		serviceInfos::property PROPERTY_OPTIONS_SASL;
 		serviceInfos::property PROPERTY_OPTIONS_SASL_FALLBACK;
 #endif // VMIME_HAVE_SASL_SUPPORT
+		serviceInfos::property PROPERTY_OPTIONS_BATCH_MAXCOMMANDLENGTH;
+		serviceInfos::property PROPERTY_OPTIONS_BATCH_MAXMESSAGES;
+		serviceInfos::property PROPERTY_OPTIONS_BATCH_MAXINFLIGHT;
+		serviceInfos::property PROPERTY_OPTIONS_STATUS_MAXINFLIGHT;
 
 		// Common properties
 		serviceInfos::property PROPERTY_AUTH_USERNAME;
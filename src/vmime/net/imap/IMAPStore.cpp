@@ -31,6 +31,9 @@
 #include "vmime/net/imap/IMAPFolder.hpp"
 #include "vmime/net/imap/IMAPConnection.hpp"
 #include "vmime/net/imap/IMAPFolderStatus.hpp"
+#include "vmime/net/imap/IMAPCommandBatcher.hpp"
+#include "vmime/net/imap/IMAPServiceInfos.hpp"
+#include "vmime/net/imap/IMAPUtils.hpp"
 
 #include "vmime/exception.hpp"
 #include "vmime/platform.hpp"
@@ -43,6 +46,142 @@ namespace net {
 namespace imap {
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+
+/** Collects the status of folders returned by "LIST ... RETURN (STATUS ...)".
+  */
+class listStatusResponseHandler : public IMAPCommandBatcher::responseHandler
+{
+public:
+
+	listStatusResponseHandler(const char hierarchySeparator,
+		const std::set <folder::path>* selection,
+		std::map <folder::path, shared_ptr <folderStatus> >& result)
+		: m_hierarchySeparator(hierarchySeparator), m_selection(selection), m_result(result)
+	{
+	}
+
+	void handleResponse(const size_t /* index */, const IMAPParser::response* resp)
+	{
+		const std::vector <IMAPParser::continue_req_or_response_data*>& respDataList =
+			resp->continue_req_or_response_data();
+
+		// Each STATUS response follows the LIST response for the same
+		// mailbox, which gives the hierarchy separator to use
+		std::map <string, folder::path> names;
+
+		for (std::vector <IMAPParser::continue_req_or_response_data*>::const_iterator
+		     it = respDataList.begin() ; it != respDataList.end() ; ++it)
+		{
+			if ((*it)->response_data() == NULL)
+				continue;
+
+			const IMAPParser::mailbox_data* mailboxData =
+				(*it)->response_data()->mailbox_data();
+
+			if (mailboxData == NULL)
+				continue;
+
+			if (mailboxData->type() == IMAPParser::mailbox_data::LIST)
+			{
+				const string& name = mailboxData->mailbox_list()->mailbox()->name();
+
+				names[name] = IMAPUtils::stringToPath
+					(mailboxData->mailbox_list()->quoted_char(), name);
+			}
+			else if (mailboxData->type() == IMAPParser::mailbox_data::STATUS)
+			{
+				const string& name = mailboxData->mailbox()->name();
+				const std::map <string, folder::path>::const_iterator jt = names.find(name);
+
+				const folder::path path = (jt != names.end())
+					? jt->second : IMAPUtils::stringToPath(m_hierarchySeparator, name);
+
+				// Patterns may match more folders than requested
+				if (m_selection && m_selection->find(path) == m_selection->end())
+					continue;
+
+				shared_ptr <IMAPFolderStatus> status = make_shared <IMAPFolderStatus>();
+				status->updateFromResponse(mailboxData);
+
+				m_result[path] = status;
+			}
+		}
+	}
+
+private:
+
+	const char m_hierarchySeparator;
+	const std::set <folder::path>* m_selection;
+	std::map <folder::path, shared_ptr <folderStatus> >& m_result;
+};
+
+
+/** Collects the status of folders returned by pipelined STATUS commands.
+  */
+class statusResponseHandler : public IMAPCommandBatcher::responseHandler
+{
+public:
+
+	statusResponseHandler(const char hierarchySeparator,
+		std::map <folder::path, shared_ptr <folderStatus> >& result)
+		: m_hierarchySeparator(hierarchySeparator), m_result(result)
+	{
+	}
+
+	void handleResponse(const size_t /* index */, const IMAPParser::response* resp)
+	{
+		const std::vector <IMAPParser::continue_req_or_response_data*>& respDataList =
+			resp->continue_req_or_response_data();
+
+		// As commands are pipelined, the STATUS response for a mailbox
+		// may come with the completion of another command
+		for (std::vector <IMAPParser::continue_req_or_response_data*>::const_iterator
+		     it = respDataList.begin() ; it != respDataList.end() ; ++it)
+		{
+			if ((*it)->response_data() == NULL)
+				continue;
+
+			const IMAPParser::mailbox_data* mailboxData =
+				(*it)->response_data()->mailbox_data();
+
+			if (mailboxData && mailboxData->type() == IMAPParser::mailbox_data::STATUS)
+			{
+				const folder::path path = IMAPUtils::stringToPath
+					(m_hierarchySeparator, mailboxData->mailbox()->name());
+
+				shared_ptr <IMAPFolderStatus> status = make_shared <IMAPFolderStatus>();
+				status->updateFromResponse(mailboxData);
+
+				m_result[path] = status;
+			}
+		}
+	}
+
+	bool handleError(const size_t /* index */, const IMAPParser::response* resp)
+	{
+		// The folder does not exist or cannot be selected: skip it.
+		// Other errors are reported.
+		return !resp->isBad() && resp->response_done()->response_tagged()->
+			resp_cond_state()->status() == IMAPParser::resp_cond_state::NO;
+	}
+
+private:
+
+	const char m_hierarchySeparator;
+	std::map <folder::path, shared_ptr <folderStatus> >& m_result;
+};
+
+
+} // unnamed namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
 IMAPStore::IMAPStore(shared_ptr <session> sess, shared_ptr <security::authenticator> auth, const bool secured)
 	: store(sess, getInfosInstance(), auth), m_connection(null), m_isIMAPS(secured)
 {
@@ -111,6 +250,166 @@ bool IMAPStore::isValidFolderName(const folder::path::component& /* name */) con
 }
 
 
+std::map <folder::path, shared_ptr <folderStatus> > IMAPStore::getFolderStatus()
+{
+	if (!isConnected())
+		throw exceptions::illegal_state("Not connected");
+
+	std::map <folder::path, shared_ptr <folderStatus> > result;
+
+	if (m_connection->hasCapability("LIST-STATUS"))
+	{
+		listStatus(std::vector <string>(1, "*"), NULL, result);
+	}
+	else
+	{
+		const std::vector <shared_ptr <folder> > folders =
+			getRootFolder()->getFolders(/* recursive */ true);
+
+		std::vector <folder::path> paths;
+		paths.reserve(folders.size());
+
+		for (std::vector <shared_ptr <folder> >::const_iterator it = folders.begin() ;
+		     it != folders.end() ; ++it)
+		{
+			// Attributes are known from the LIST response
+			const folderAttributes attribs = (*it)->getAttributes();
+
+			if ((attribs.getType() & folderAttributes::TYPE_CONTAINS_MESSAGES) &&
+			    !(attribs.getFlags() & folderAttributes::FLAG_NO_OPEN))
+			{
+				paths.push_back((*it)->getFullPath());
+			}
+		}
+
+		pipelineStatus(paths, result);
+	}
+
+	return result;
+}
+
+
+std::map <folder::path, shared_ptr <folderStatus> > IMAPStore::getFolderStatus
+	(const std::vector <folder::path>& paths)
+{
+	if (!isConnected())
+		throw exceptions::illegal_state("Not connected");
+
+	std::map <folder::path, shared_ptr <folderStatus> > result;
+
+	// The root folder cannot be selected
+	std::vector <folder::path> selectable;
+	selectable.reserve(paths.size());
+
+	for (std::vector <folder::path>::const_iterator it = paths.begin() ;
+	     it != paths.end() ; ++it)
+	{
+		if (!it->isEmpty())
+			selectable.push_back(*it);
+	}
+
+	if (selectable.empty())
+		return result;
+
+	if (m_connection->hasCapability("LIST-STATUS"))
+	{
+		const std::set <folder::path> selection(selectable.begin(), selectable.end());
+
+		std::vector <string> patterns;
+		patterns.reserve(selection.size());
+
+		for (std::set <folder::path>::const_iterator it = selection.begin() ;
+		     it != selection.end() ; ++it)
+		{
+			patterns.push_back(IMAPUtils::quoteString(IMAPUtils::pathToString
+				(m_connection->hierarchySeparator(), *it)));
+		}
+
+		listStatus(patterns, &selection, result);
+	}
+	else
+	{
+		pipelineStatus(selectable, result);
+	}
+
+	return result;
+}
+
+
+void IMAPStore::listStatus(const std::vector <string>& patterns,
+	const std::set <folder::path>* selection,
+	std::map <folder::path, shared_ptr <folderStatus> >& result)
+{
+	// Eg. Get status of all folders (RFC 5819)
+	//
+	//     C: a005 LIST "" * RETURN (STATUS (MESSAGES UNSEEN))
+	//     S: * LIST (\HasNoChildren) "/" INBOX
+	//     S: * STATUS INBOX (MESSAGES 17 UNSEEN 16)
+	//     S: * LIST (\Noselect) "/" foo
+	//     S: a005 OK LIST completed
+	//
+	// Several patterns can be specified in a single command, as
+	// LIST-STATUS is an extension to LIST-EXTENDED (RFC 5258)
+
+	IMAPCommandBatcher batcher(m_connection);
+
+	const string prefix = "LIST \"\" ";
+	const string suffix = " RETURN (STATUS " + IMAPUtils::buildStatusItemList(m_connection) + ")";
+
+	std::vector <string> commands;
+	std::vector <string>::const_iterator it = patterns.begin();
+
+	while (it != patterns.end())
+	{
+		string list = *it++;
+		size_t count = 1;
+
+		while (it != patterns.end() && prefix.length() + list.length() + 3 +
+		       it->length() + suffix.length() <= batcher.getMaxCommandLength())
+		{
+			list += ' ';
+			list += *it++;
+
+			++count;
+		}
+
+		if (count == 1)
+			commands.push_back(prefix + list + suffix);
+		else
+			commands.push_back(prefix + "(" + list + ")" + suffix);
+	}
+
+	listStatusResponseHandler handler(m_connection->hierarchySeparator(), selection, result);
+	batcher.execute(m_connection, "LIST", commands, handler);
+}
+
+
+void IMAPStore::pipelineStatus(const std::vector <folder::path>& paths,
+	std::map <folder::path, shared_ptr <folderStatus> >& result)
+{
+	const IMAPServiceInfos& infos = dynamic_cast <const IMAPServiceInfos&>(getInfos());
+
+	IMAPCommandBatcher batcher(m_connection);
+	batcher.setMaxCommandsInFlight(infos.getPropertyValue <size_t>
+		(getSession(), infos.getProperties().PROPERTY_OPTIONS_STATUS_MAXINFLIGHT));
+
+	const string items = IMAPUtils::buildStatusItemList(m_connection);
+
+	std::vector <string> commands;
+	commands.reserve(paths.size());
+
+	for (std::vector <folder::path>::const_iterator it = paths.begin() ;
+	     it != paths.end() ; ++it)
+	{
+		commands.push_back("STATUS " + IMAPUtils::quoteString(IMAPUtils::pathToString
+			(m_connection->hierarchySeparator(), *it)) + " " + items);
+	}
+
+	statusResponseHandler handler(m_connection->hierarchySeparator(), result);
+	batcher.execute(m_connection, "STATUS", commands, handler);
+}
+
+
 void IMAPStore::connect()
 {
 	if (isConnected())
@@ -167,6 +466,18 @@ shared_ptr <IMAPConnection> IMAPStore::getConnection()
 }
 
 
+void IMAPStore::setCache(shared_ptr <IMAPCache> cache)
+{
+	m_cache = cache;
+}
+
+
+shared_ptr <IMAPCache> IMAPStore::getCache() const
+{
+	return m_cache;
+}
+
+
 void IMAPStore::disconnect()
 {
 	if (!isConnected())
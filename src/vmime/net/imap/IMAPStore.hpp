@@ -37,6 +37,11 @@
 
 #include "vmime/net/imap/IMAPServiceInfos.hpp"
 #include "vmime/net/imap/IMAPConnection.hpp"
+#include "vmime/net/imap/IMAPCache.hpp"
+
+#include <map>
+#include <set>
+#include <vector>
 
 
 namespace vmime {
@@ -71,6 +76,27 @@ public:
 
 	bool isValidFolderName(const folder::path::component& name) const;
 
+	/** Return the status of all the folders which can be selected.
+	  * If the server supports the LIST-STATUS extension (RFC 5819),
+	  * the folders and their status are retrieved with a single LIST
+	  * command. Otherwise, folders are listed and STATUS commands are
+	  * pipelined (see the "options.status.maxinflight" property).
+	  *
+	  * @return status of each folder, indexed by folder path
+	  */
+	std::map <folder::path, shared_ptr <folderStatus> > getFolderStatus();
+
+	/** Return the status of the specified folders, using LIST-STATUS
+	  * if it is supported by the server, or pipelined STATUS commands.
+	  * Folders which do not exist or cannot be selected are not
+	  * included in the returned map.
+	  *
+	  * @param paths absolute paths of the folders
+	  * @return status of each folder, indexed by folder path
+	  */
+	std::map <folder::path, shared_ptr <folderStatus> > getFolderStatus
+		(const std::vector <folder::path>& paths);
+
 	static const serviceInfos& getInfosInstance();
 	const serviceInfos& getInfos() const;
 
@@ -88,6 +114,20 @@ public:
 	shared_ptr <connectionInfos> getConnectionInfos() const;
 	shared_ptr <IMAPConnection> getConnection();
 
+	/** Set the local cache used to avoid fetching again the data of
+	  * messages which have already been downloaded. By default, no
+	  * cache is used.
+	  *
+	  * @param cache cache, or NULL to disable caching
+	  */
+	void setCache(shared_ptr <IMAPCache> cache);
+
+	/** Return the local cache used by this store, if any.
+	  *
+	  * @return cache, or NULL if caching is disabled
+	  */
+	shared_ptr <IMAPCache> getCache() const;
+
 protected:
 
 	// Connection
@@ -98,6 +138,14 @@ protected:
 	shared_ptr <IMAPConnection> connection();
 
 
+	void listStatus(const std::vector <string>& patterns,
+		const std::set <folder::path>* selection,
+		std::map <folder::path, shared_ptr <folderStatus> >& result);
+
+	void pipelineStatus(const std::vector <folder::path>& paths,
+		std::map <folder::path, shared_ptr <folderStatus> >& result);
+
+
 	void registerFolder(IMAPFolder* folder);
 	void unregisterFolder(IMAPFolder* folder);
 
@@ -105,6 +153,8 @@ protected:
 
 	const bool m_isIMAPS;  // Use IMAPS
 
+	shared_ptr <IMAPCache> m_cache;
+
 
 	static IMAPServiceInfos sm_infos;
 };
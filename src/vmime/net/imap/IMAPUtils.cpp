@@ -630,7 +630,7 @@ const string IMAPUtils::buildFetchRequest
 		std::vector <string> headerFields;
 
 		if (options.has(fetchAttributes::CONTENT_INFO))
-			headerFields.push_back("CONTENT_TYPE");
+			headerFields.push_back(vmime::fields::CONTENT_TYPE);
 
 		if (options.has(fetchAttributes::IMPORTANCE))
 		{
@@ -681,6 +681,24 @@ const string IMAPUtils::buildFetchRequest
 }
 
 
+// static
+const string IMAPUtils::buildStatusItemList(shared_ptr <const IMAPConnection> cnt)
+{
+	std::ostringstream list;
+	list.imbue(std::locale::classic());
+
+	list << "(";
+	list << "MESSAGES" << ' ' << "UNSEEN" << ' ' << "UIDNEXT" << ' ' << "UIDVALIDITY";
+
+	if (cnt->hasCapability("CONDSTORE"))
+		list << ' ' << "HIGHESTMODSEQ";
+
+	list << ")";
+
+	return list.str();
+}
+
+
 // static
 void IMAPUtils::convertAddressList
 	(const IMAPParser::address_list& src, mailboxList& dest)
@@ -701,6 +719,24 @@ void IMAPUtils::convertAddressList
 }
 
 
+// static
+void IMAPUtils::moveHeaderFields(header& src, header& dest, const bool replace)
+{
+	if (replace)
+		dest.removeAllFields();
+
+	const std::vector <shared_ptr <headerField> > fields = src.getFieldList();
+
+	src.removeAllFields();
+
+	for (std::vector <shared_ptr <headerField> >::const_iterator it = fields.begin() ;
+	     it != fields.end() ; ++it)
+	{
+		dest.appendField(*it);
+	}
+}
+
+
 
 class IMAPUIDMessageSetEnumerator : public messageSetEnumerator
 {
@@ -755,8 +791,8 @@ public:
 
 	void enumerateNumberMessageRange(const vmime::net::numberMessageRange& range)
 	{
-		for (int i = range.getFirst(), last = range.getLast() ; i <= last ; ++i)
-			m_list.push_back(i);
+		if (range.getLast() != -1)
+			m_set.add(range.getFirst(), range.getLast());
 	}
 
 	void enumerateUIDMessageRange(const vmime::net::UIDMessageRange& /* range */)
@@ -764,14 +800,14 @@ public:
 		// Not used
 	}
 
-	const std::vector <int>& list() const
+	const numberSet& set() const
 	{
-		return m_list;
+		return m_set;
 	}
 
-public:
+private:
 
-	std::vector <int> m_list;
+	numberSet m_set;
 };
 
 
@@ -788,11 +824,26 @@ const string IMAPUtils::messageSetToSequenceSet(const messageSet& msgs)
 
 // static
 const std::vector <int> IMAPUtils::messageSetToNumberList(const messageSet& msgs)
+{
+	const numberSet set = messageSetToNumberSet(msgs);
+
+	std::vector <int> list;
+	list.reserve(static_cast <size_t>(set.getCount()));
+
+	for (numberSet::const_iterator it = set.begin() ; it != set.end() ; ++it)
+		list.push_back(static_cast <int>(*it));
+
+	return list;
+}
+
+
+// static
+const numberSet IMAPUtils::messageSetToNumberSet(const messageSet& msgs)
 {
 	IMAPMessageSetEnumerator en;
 	msgs.enumerate(en);
 
-	return en.list();
+	return en.set();
 }
 
 
@@ -99,6 +99,14 @@ public:
 	static const string buildFetchRequest
 		(shared_ptr <IMAPConnection> cnt, const messageSet& msgs, const fetchAttributes& options);
 
+	/** Construct the list of status data items requested with the
+	  * STATUS command, or with the STATUS return option of LIST.
+	  *
+	  * @param cnt connection
+	  * @return parenthesized list of status data items
+	  */
+	static const string buildStatusItemList(shared_ptr <const IMAPConnection> cnt);
+
 	/** Convert a parser-style address list to a mailbox list.
 	  *
 	  * @param src input address list
@@ -106,6 +114,15 @@ public:
 	  */
 	static void convertAddressList(const IMAPParser::address_list& src, mailboxList& dest);
 
+	/** Move the fields of a header returned by the parser to another
+	  * header. Fields are not copied.
+	  *
+	  * @param src header from which the fields are taken (emptied)
+	  * @param dest header to which the fields are appended
+	  * @param replace if true, the fields of dest are removed first
+	  */
+	static void moveHeaderFields(header& src, header& dest, const bool replace);
+
 	/** Returns an IMAP-formatted sequence set given a message set.
 	  *
 	  * @param msgs message set
@@ -120,6 +137,15 @@ public:
 	  */
 	static const std::vector <int> messageSetToNumberList(const messageSet& msgs);
 
+	/** Returns the set of message sequence numbers given a message set,
+	  * without expanding the ranges. Ranges which extend to the last
+	  * message in the folder are ignored.
+	  *
+	  * @param msgs message set
+	  * @return set of message numbers
+	  */
+	static const numberSet messageSetToNumberSet(const messageSet& msgs);
+
 	/** Constructs a message set from a parser 'uid_set' structure.
 	  *
 	  * @param uidSet UID set, as returned by the parser
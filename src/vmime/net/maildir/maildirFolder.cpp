@@ -159,29 +159,36 @@ void maildirFolder::close(const bool expunge)
 
 void maildirFolder::onClose()
 {
-	for (std::vector <maildirMessage*>::iterator it = m_messages.begin() ;
-	     it != m_messages.end() ; ++it)
+	std::vector <std::pair <size_t, maildirMessage*> > msgs;
+	m_messages.getMessages(msgs);
+
+	for (std::vector <std::pair <size_t, maildirMessage*> >::iterator it = msgs.begin() ;
+	     it != msgs.end() ; ++it)
 	{
-		(*it)->onFolderClosed();
+		// Messages keep their last known number
+		(*it).second->m_num = static_cast <int>(m_messages.getNumber((*it).first));
+		(*it).second->onFolderClosed();
 	}
 
 	m_messages.clear();
 }
 
 
-void maildirFolder::registerMessage(maildirMessage* msg)
+size_t maildirFolder::registerMessage(maildirMessage* msg, const int num)
 {
-	m_messages.push_back(msg);
+	return m_messages.add(msg, num);
 }
 
 
-void maildirFolder::unregisterMessage(maildirMessage* msg)
+void maildirFolder::unregisterMessage(maildirMessage* msg, const size_t slot)
 {
-	std::vector <maildirMessage*>::iterator it =
-		std::find(m_messages.begin(), m_messages.end(), msg);
+	m_messages.remove(msg, slot);
+}
 
-	if (it != m_messages.end())
-		m_messages.erase(it);
+
+int maildirFolder::getMessageNumber(const size_t slot) const
+{
+	return static_cast <int>(m_messages.getNumber(slot));
 }
 
 
@@ -635,52 +642,27 @@ void maildirFolder::setMessageFlags
 		}
 
 		// Update local flags
-		switch (mode)
-		{
-		case message::FLAG_MODE_ADD:
-		{
-			for (std::vector <maildirMessage*>::iterator it =
-				 m_messages.begin() ; it != m_messages.end() ; ++it)
-			{
-				if (std::binary_search(nums.begin(), nums.end(), (*it)->getNumber()) &&
-					(*it)->m_flags != maildirMessage::FLAG_UNDEFINED)
-				{
-					(*it)->m_flags |= flags;
-				}
-			}
+		std::vector <maildirMessage*> updated;
 
-			break;
-		}
-		case message::FLAG_MODE_REMOVE:
+		for (std::vector <int>::const_iterator it =
+			 nums.begin() ; it != nums.end() ; ++it)
 		{
-			for (std::vector <maildirMessage*>::iterator it =
-				 m_messages.begin() ; it != m_messages.end() ; ++it)
-			{
-				if (std::binary_search(nums.begin(), nums.end(), (*it)->getNumber()) &&
-					(*it)->m_flags != maildirMessage::FLAG_UNDEFINED)
-				{
-					(*it)->m_flags &= ~flags;
-				}
-			}
-
-			break;
+			m_messages.find(*it, updated);
 		}
-		default:
-		case message::FLAG_MODE_SET:
+
+		for (std::vector <maildirMessage*>::iterator it =
+			 updated.begin() ; it != updated.end() ; ++it)
 		{
-			for (std::vector <maildirMessage*>::iterator it =
-				 m_messages.begin() ; it != m_messages.end() ; ++it)
+			if ((*it)->m_flags == maildirMessage::FLAG_UNDEFINED)
+				continue;
+
+			switch (mode)
 			{
-				if (std::binary_search(nums.begin(), nums.end(), (*it)->getNumber()) &&
-					(*it)->m_flags != maildirMessage::FLAG_UNDEFINED)
-				{
-					(*it)->m_flags = flags;
-				}
+			case message::FLAG_MODE_ADD:    (*it)->m_flags |= flags; break;
+			case message::FLAG_MODE_REMOVE: (*it)->m_flags &= ~flags; break;
+			default:
+			case message::FLAG_MODE_SET:    (*it)->m_flags = flags; break;
 			}
-
-			break;
-		}
-
 		}
 
 		// Notify message flags changed
@@ -1091,13 +1073,18 @@ void maildirFolder::expunge()
 		{
 			nums.push_back(num);
 
+			// Messages which follow are implicitly renumbered; 'num' is
+			// the original number, so adjust for already expunged ones
+			const int currentNum = num - static_cast <int>(nums.size() - 1);
+
+			std::vector <maildirMessage*> expunged;
+			m_messages.expunge(currentNum, expunged);
+
 			for (std::vector <maildirMessage*>::iterator it =
-			     m_messages.begin() ; it != m_messages.end() ; ++it)
+			     expunged.begin() ; it != expunged.end() ; ++it)
 			{
-				if ((*it)->m_num == num)
-					(*it)->m_expunged = true;
-				else if ((*it)->m_num > num)
-					(*it)->m_num--;
+				(*it)->m_num = currentNum;
+				(*it)->m_expunged = true;
 			}
 
 			if (maildirUtils::extractFlags(infos.path) & message::FLAG_SEEN)
@@ -37,6 +37,7 @@
 #include "vmime/types.hpp"
 
 #include "vmime/net/folder.hpp"
+#include "vmime/net/messageRegistry.hpp"
 
 #include "vmime/utility/file.hpp"
 
@@ -129,8 +130,10 @@ private:
 
 	void listFolders(std::vector <shared_ptr <folder> >& list, const bool recursive);
 
-	void registerMessage(maildirMessage* msg);
-	void unregisterMessage(maildirMessage* msg);
+	size_t registerMessage(maildirMessage* msg, const int num);
+	void unregisterMessage(maildirMessage* msg, const size_t slot);
+
+	int getMessageNumber(const size_t slot) const;
 
 	const utility::file::path getMessageFSPath(const int number) const;
 
@@ -174,7 +177,7 @@ private:
 	std::vector <messageInfos> m_messageInfos;
 
 	// Instanciated message objects
-	std::vector <maildirMessage*> m_messages;
+	messageRegistry <maildirMessage> m_messages;
 };
 
 
@@ -39,9 +39,6 @@
 #include "vmime/exception.hpp"
 #include "vmime/platform.hpp"
 
-#include "vmime/utility/outputStreamAdapter.hpp"
-#include "vmime/utility/stringUtils.hpp"
-
 
 namespace vmime {
 namespace net {
@@ -52,7 +49,7 @@ maildirMessage::maildirMessage(shared_ptr <maildirFolder> folder, const int num)
 	: m_folder(folder), m_num(num), m_size(-1), m_flags(FLAG_UNDEFINED),
 	  m_expunged(false), m_structure(null)
 {
-	folder->registerMessage(this);
+	m_slot = folder->registerMessage(this, num);
 }
 
 
@@ -61,7 +58,7 @@ maildirMessage::~maildirMessage()
 	shared_ptr <maildirFolder> folder = m_folder.lock();
 
 	if (folder)
-		folder->unregisterMessage(this);
+		folder->unregisterMessage(this, m_slot);
 }
 
 
@@ -73,6 +70,12 @@ void maildirMessage::onFolderClosed()
 
 int maildirMessage::getNumber() const
 {
+	shared_ptr <maildirFolder> folder = m_folder.lock();
+
+	// Number of a live message changes when messages are expunged
+	if (folder && !m_expunged)
+		return folder->getMessageNumber(m_slot);
+
 	return (m_num);
 }
 
@@ -141,7 +144,7 @@ void maildirMessage::setFlags(const int flags, const int mode)
 	if (!folder)
 		throw exceptions::folder_not_found();
 
-	folder->setMessageFlags(messageSet::byNumber(m_num), flags, mode);
+	folder->setMessageFlags(messageSet::byNumber(getNumber()), flags, mode);
 }
 
 
@@ -172,7 +175,7 @@ void maildirMessage::extractImpl(utility::outputStream& os, utility::progressLis
 
 	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
 
-	const utility::file::path path = folder->getMessageFSPath(m_num);
+	const utility::file::path path = folder->getMessageFSPath(getNumber());
 	shared_ptr <utility::file> file = fsf->create(path);
 
 	shared_ptr <utility::fileReader> reader = file->getFileReader();
@@ -218,30 +221,17 @@ void maildirMessage::fetchPartHeader(shared_ptr <messagePart> p)
 
 	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
 
-	const utility::file::path path = folder->getMessageFSPath(m_num);
+	const utility::file::path path = folder->getMessageFSPath(getNumber());
 	shared_ptr <utility::file> file = fsf->create(path);
 
 	shared_ptr <utility::fileReader> reader = file->getFileReader();
 	shared_ptr <utility::inputStream> is = reader->getInputStream();
 
-	is->skip(mp->getHeaderParsedOffset());
-
-	byte_t buffer[1024];
-	size_t remaining = mp->getHeaderParsedLength();
-
-	string contents;
-	contents.reserve(remaining);
-
-	while (!is->eof() && remaining > 0)
-	{
-		const size_t read = is->read(buffer, std::min(remaining, sizeof(buffer)));
-
-		remaining -= read;
-
-		vmime::utility::stringUtils::appendBytesToString(contents, buffer, read);
-	}
+	// Parse directly from the file stream
+	const size_t headerStart = mp->getHeaderParsedOffset();
+	const size_t headerEnd = headerStart + mp->getHeaderParsedLength();
 
-	mp->getOrCreateHeader().parse(contents);
+	mp->getOrCreateHeader().parse(is, headerStart, headerEnd, NULL);
 }
 
 
@@ -254,7 +244,7 @@ void maildirMessage::fetch(shared_ptr <maildirFolder> msgFolder, const fetchAttr
 
 	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
 
-	const utility::file::path path = folder->getMessageFSPath(m_num);
+	const utility::file::path path = folder->getMessageFSPath(getNumber());
 	shared_ptr <utility::file> file = fsf->create(path);
 
 	if (options.has(fetchAttributes::FLAGS))
@@ -266,73 +256,50 @@ void maildirMessage::fetch(shared_ptr <maildirFolder> msgFolder, const fetchAttr
 	if (options.has(fetchAttributes::UID))
 		m_uid = maildirUtils::extractId(path.getLastComponent()).getBuffer();
 
-	if (options.has(fetchAttributes::ENVELOPE | fetchAttributes::CONTENT_INFO |
-	                fetchAttributes::FULL_HEADER | fetchAttributes::STRUCTURE |
-	                fetchAttributes::IMPORTANCE))
+	// Need whole message contents for structure
+	if (options.has(fetchAttributes::STRUCTURE))
 	{
-		string contents;
-
 		shared_ptr <utility::fileReader> reader = file->getFileReader();
 		shared_ptr <utility::inputStream> is = reader->getInputStream();
 
-		// Need whole message contents for structure
-		if (options.has(fetchAttributes::STRUCTURE))
-		{
-			byte_t buffer[16384];
+		// Parse directly from the file stream: this avoids copying
+		// the message contents into memory
+		vmime::message msg;
+		msg.parse(is, 0, file->getLength(), NULL);
 
-			contents.reserve(file->getLength());
+		// Extract structure
+		m_structure = make_shared <maildirMessageStructure>(shared_ptr <maildirMessagePart>(), msg);
 
-			while (!is->eof())
-			{
-				const size_t read = is->read(buffer, sizeof(buffer));
-				vmime::utility::stringUtils::appendBytesToString(contents, buffer, read);
-			}
-		}
-		// Need only header
-		else
-		{
-			byte_t buffer[1024];
-
-			contents.reserve(4096);
-
-			while (!is->eof())
-			{
-				const size_t read = is->read(buffer, sizeof(buffer));
-				vmime::utility::stringUtils::appendBytesToString(contents, buffer, read);
-
-				const size_t sep1 = contents.rfind("\r\n\r\n");
-				const size_t sep2 = contents.rfind("\n\n");
-
-				if (sep1 != string::npos)
-				{
-					contents.erase(contents.begin() + sep1 + 4, contents.end());
-					break;
-				}
-				else if (sep2 != string::npos)
-				{
-					contents.erase(contents.begin() + sep2 + 2, contents.end());
-					break;
-				}
-			}
-		}
+		// Extract some header fields or whole header
+		if (options.isHeaderRequired())
+			getOrCreateHeader()->copyFrom(*(msg.getHeader()));
+	}
+	// Need only header
+	else if (options.isHeaderRequired())
+	{
+		shared_ptr <utility::fileReader> reader = file->getFileReader();
+		shared_ptr <utility::inputStream> is = reader->getInputStream();
 
-		vmime::message msg;
-		msg.parse(contents);
+		parsingContext ctx(parsingContext::getDefaultContext());
+		size_t end = 0;
 
-		// Extract structure
-		if (options.has(fetchAttributes::STRUCTURE))
+		if (options.has(fetchAttributes::FULL_HEADER))
 		{
-			m_structure = make_shared <maildirMessageStructure>(shared_ptr <maildirMessagePart>(), msg);
+			end = maildirUtils::findHeaderEnd(*is);
 		}
-
-		// Extract some header fields or whole header
-		if (options.has(fetchAttributes::ENVELOPE |
-		                fetchAttributes::CONTENT_INFO |
-		                fetchAttributes::FULL_HEADER |
-		                fetchAttributes::IMPORTANCE))
+		// Read the whole header, but skip the fields which were not
+		// requested when parsing
+		else
 		{
-			getOrCreateHeader()->copyFrom(*(msg.getHeader()));
+			const std::vector <string> fields = options.getRequiredHeaderFields();
+
+			end = maildirUtils::findHeaderFieldsEnd(*is, fields);
+			ctx.setHeaderFieldFilter(fields);
 		}
+
+		is->reset();
+
+		getOrCreateHeader()->parse(ctx, is, 0, end, NULL);
 	}
 }
 
@@ -348,13 +315,23 @@ shared_ptr <header> maildirMessage::getOrCreateHeader()
 
 shared_ptr <vmime::message> maildirMessage::getParsedMessage()
 {
-	std::ostringstream oss;
-	utility::outputStreamAdapter os(oss);
+	shared_ptr <maildirFolder> folder = m_folder.lock();
+
+	if (!folder)
+		throw exceptions::folder_not_found();
 
-	extract(os);
+	shared_ptr <utility::fileSystemFactory> fsf = platform::getHandler()->getFileSystemFactory();
+
+	const utility::file::path path = folder->getMessageFSPath(getNumber());
+	shared_ptr <utility::file> file = fsf->create(path);
+
+	shared_ptr <utility::fileReader> reader = file->getFileReader();
+	shared_ptr <utility::inputStream> is = reader->getInputStream();
 
+	// Body contents are not copied: they will be read from the
+	// file stream when needed
 	shared_ptr <vmime::message> msg = make_shared <vmime::message>();
-	msg->parse(oss.str());
+	msg->parse(is, 0, file->getLength(), NULL);
 
 	return msg;
 }
@@ -96,6 +96,7 @@ private:
 	weak_ptr <maildirFolder> m_folder;
 
 	int m_num;
+	size_t m_slot;
 	size_t m_size;
 	int m_flags;
 	bool m_expunged;
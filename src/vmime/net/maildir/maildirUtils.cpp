@@ -245,6 +245,52 @@ const std::vector <int> maildirUtils::messageSetToNumberList(const messageSet& m
 }
 
 
+// static
+size_t maildirUtils::findHeaderEnd(utility::inputStream& is)
+{
+	byte_t buffer[4096];
+	size_t offset = 0;
+
+	// Number of line feeds seen, separated only by carriage returns
+	int lineFeeds = 0;
+
+	while (!is.eof())
+	{
+		const size_t read = is.read(buffer, sizeof(buffer));
+
+		if (read == 0)
+			break;
+
+		for (size_t i = 0 ; i < read ; ++i)
+		{
+			if (buffer[i] == '\n')
+			{
+				if (++lineFeeds == 2)
+					return offset + i + 1;
+			}
+			else if (buffer[i] != '\r')
+			{
+				lineFeeds = 0;
+			}
+		}
+
+		offset += read;
+	}
+
+	return offset;
+}
+
+
+// static
+size_t maildirUtils::findHeaderFieldsEnd(utility::inputStream& is, const std::vector <string>& /* fields */)
+{
+	// Occurrences of a requested field may appear anywhere in the
+	// header (eg. "Received" fields), so it must be read completely;
+	// the other fields are skipped when parsing
+	return findHeaderEnd(is);
+}
+
+
 
 //
 // messageIdComparator
@@ -33,6 +33,7 @@
 
 #include "vmime/utility/file.hpp"
 #include "vmime/utility/path.hpp"
+#include "vmime/utility/inputStream.hpp"
 
 #include "vmime/net/messageSet.hpp"
 
@@ -138,6 +139,29 @@ public:
 	  * @return list of message numbers
 	  */
 	static const std::vector <int> messageSetToNumberList(const messageSet& msgs);
+
+	/** Find the end of the header in a message file. Data is read
+	  * from the current position until the empty line separating the
+	  * header from the body is found, or the end of the stream is
+	  * reached.
+	  *
+	  * @param is input stream, positioned at the start of the header
+	  * @return number of bytes occupied by the header, including the
+	  * empty line separating it from the body
+	  */
+	static size_t findHeaderEnd(utility::inputStream& is);
+
+	/** Find where to stop reading the header of a message file to get
+	  * the specified fields. As occurrences of a field may appear anywhere
+	  * in the header, this is the same as findHeaderEnd(is): the fields
+	  * which were not requested are to be skipped when parsing (see
+	  * parsingContext::setHeaderFieldFilter()).
+	  *
+	  * @param is input stream, positioned at the start of the header
+	  * @param fields names of the fields to look for (case-insensitive)
+	  * @return number of bytes to read to get the fields
+	  */
+	static size_t findHeaderFieldsEnd(utility::inputStream& is, const std::vector <string>& fields);
 };
 
 
@@ -0,0 +1,277 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_NET_MESSAGEREGISTRY_HPP_INCLUDED
+#define VMIME_NET_MESSAGEREGISTRY_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include <vector>
+#include <map>
+
+#include "vmime/types.hpp"
+
+
+namespace vmime {
+namespace net {
+
+
+/** Keeps track of the message objects which are alive in a folder,
+  * and of their sequence number.
+  *
+  * Each registered message is attached to a slot, which represents a
+  * position in the folder. The current number of a slot is the count
+  * of non-expunged slots up to and including it, which is maintained
+  * in a Fenwick tree. Expunging a message and retrieving the current
+  * number of a message both cost O(log n), instead of renumbering all
+  * the messages which follow the expunged one.
+  *
+  * This is used internally by the folder implementations.
+  */
+
+template <class MSG>
+class messageRegistry
+{
+public:
+
+	messageRegistry()
+		: m_liveCount(0)
+	{
+		m_tree.push_back(0);   // index 0 is not used
+		m_live.push_back(false);
+	}
+
+	/** Register a message.
+	  *
+	  * @param msg message object
+	  * @param num current sequence number of the message (1-based)
+	  * @return slot to which the message is attached; it must be
+	  * passed to getNumber() and remove()
+	  */
+	size_t add(MSG* msg, const size_t num)
+	{
+		// Slot 0 is never live: use it for invalid numbers
+		const size_t slot = (num == 0 ? 0 : getSlot(num));
+		m_messages.insert(typename MessageMap::value_type(slot, msg));
+
+		return slot;
+	}
+
+	/** Unregister a message.
+	  *
+	  * @param msg message object
+	  * @param slot slot returned by add()
+	  */
+	void remove(MSG* msg, const size_t slot)
+	{
+		std::pair <typename MessageMap::iterator, typename MessageMap::iterator>
+			range = m_messages.equal_range(slot);
+
+		for (typename MessageMap::iterator it = range.first ; it != range.second ; ++it)
+		{
+			if ((*it).second == msg)
+			{
+				m_messages.erase(it);
+				break;
+			}
+		}
+	}
+
+	/** Return the current sequence number of a slot.
+	  *
+	  * @param slot slot returned by add()
+	  * @return current sequence number, or 0 if the slot has been expunged
+	  */
+	size_t getNumber(const size_t slot) const
+	{
+		if (slot >= m_live.size() || !m_live[slot])
+			return 0;
+
+		return prefixSum(slot);
+	}
+
+	/** Find the messages which have the specified sequence number.
+	  *
+	  * @param num sequence number (1-based)
+	  * @param msgs will receive the messages having this number
+	  */
+	void find(const size_t num, std::vector <MSG*>& msgs) const
+	{
+		if (num < 1 || num > m_liveCount)
+			return;
+
+		std::pair <typename MessageMap::const_iterator, typename MessageMap::const_iterator>
+			range = m_messages.equal_range(findSlot(num));
+
+		for (typename MessageMap::const_iterator it = range.first ; it != range.second ; ++it)
+			msgs.push_back((*it).second);
+	}
+
+	/** Expunge the message at the specified sequence number: messages
+	  * which follow are implicitly renumbered, and the messages which
+	  * have this number are unregistered.
+	  *
+	  * @param num sequence number (1-based)
+	  * @param msgs will receive the messages which had this number
+	  */
+	void expunge(const size_t num, std::vector <MSG*>& msgs)
+	{
+		if (num < 1 || num > m_liveCount)
+			return;  // no message registered at or after this number
+
+		const size_t slot = findSlot(num);
+
+		update(slot, -1);
+
+		m_live[slot] = false;
+		--m_liveCount;
+
+		std::pair <typename MessageMap::iterator, typename MessageMap::iterator>
+			range = m_messages.equal_range(slot);
+
+		for (typename MessageMap::iterator it = range.first ; it != range.second ; ++it)
+			msgs.push_back((*it).second);
+
+		m_messages.erase(range.first, range.second);
+	}
+
+	/** Return all the registered messages, with their slot.
+	  *
+	  * @param msgs will receive the (slot, message) pairs
+	  */
+	void getMessages(std::vector <std::pair <size_t, MSG*> >& msgs) const
+	{
+		for (typename MessageMap::const_iterator it = m_messages.begin() ;
+		     it != m_messages.end() ; ++it)
+		{
+			msgs.push_back(*it);
+		}
+	}
+
+	/** Return the number of registered messages.
+	  *
+	  * @return number of registered messages
+	  */
+	size_t getMessageCount() const
+	{
+		return m_messages.size();
+	}
+
+	/** Unregister all messages and forget about expunged slots.
+	  */
+	void clear()
+	{
+		m_messages.clear();
+
+		m_tree.resize(1);
+		m_live.resize(1);
+
+		m_liveCount = 0;
+	}
+
+private:
+
+	// Return the slot for a sequence number, creating new slots at
+	// the end if the number is past the last known one
+	size_t getSlot(const size_t num)
+	{
+		while (m_liveCount < num)
+			appendSlot();
+
+		return findSlot(num);
+	}
+
+	void appendSlot()
+	{
+		const size_t i = m_tree.size();
+		const size_t parent = i - (i & (~i + 1));
+
+		// Node i covers the range (parent, i]
+		m_tree.push_back(1 + static_cast <int>(prefixSum(i - 1) - prefixSum(parent)));
+		m_live.push_back(true);
+
+		++m_liveCount;
+	}
+
+	size_t prefixSum(size_t i) const
+	{
+		size_t sum = 0;
+
+		for ( ; i > 0 ; i -= (i & (~i + 1)))
+			sum += m_tree[i];
+
+		return sum;
+	}
+
+	void update(size_t i, const int delta)
+	{
+		for ( ; i < m_tree.size() ; i += (i & (~i + 1)))
+			m_tree[i] += delta;
+	}
+
+	// Return the smallest slot whose prefix sum is 'num'
+	size_t findSlot(size_t num) const
+	{
+		size_t step = 1;
+
+		while (step * 2 < m_tree.size())
+			step *= 2;
+
+		size_t pos = 0;
+
+		for ( ; step > 0 ; step /= 2)
+		{
+			if (pos + step < m_tree.size() && static_cast <size_t>(m_tree[pos + step]) < num)
+			{
+				pos += step;
+				num -= m_tree[pos];
+			}
+		}
+
+		return pos + 1;
+	}
+
+
+	typedef std::multimap <size_t, MSG*> MessageMap;
+
+	MessageMap m_messages;
+
+	std::vector <int> m_tree;
+	std::vector <bool> m_live;
+
+	size_t m_liveCount;
+};
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
+
+#endif // VMIME_NET_MESSAGEREGISTRY_HPP_INCLUDED
@@ -32,6 +32,41 @@ namespace vmime {
 namespace net {
 
 
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+
+// Build a set from a list of values: the list is sorted, and runs of
+// consecutive values are added in ascending order, which is linear
+const numberSet sortedValuesToSet(std::vector <numberSet::value_type>& values)
+{
+	std::sort(values.begin(), values.end());
+	values.erase(std::unique(values.begin(), values.end()), values.end());
+
+	numberSet set;
+
+	for (size_t i = 0, n = values.size() ; i < n ; )
+	{
+		const numberSet::value_type first = values[i];
+		numberSet::value_type last = first;
+
+		for (++i ; i < n && values[i] == last + 1 ; ++i)
+			last = values[i];
+
+		set.add(first, last);
+	}
+
+	return set;
+}
+
+
+} // unnamed namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
 // messageRange
 
 messageRange::messageRange()
@@ -193,49 +228,34 @@ messageSet messageSet::byNumber(const int first, const int last)
 // static
 messageSet messageSet::byNumber(const std::vector <int>& numbers)
 {
-	// Sort a copy of the list
-	std::vector <int> sortedNumbers;
+	std::vector <numberSet::value_type> values;
+	values.reserve(numbers.size());
+
+	for (std::vector <int>::const_iterator it = numbers.begin() ; it != numbers.end() ; ++it)
+	{
+		if (*it < 1)
+			throw std::invalid_argument("number");
 
-	sortedNumbers.resize(numbers.size());
+		values.push_back(static_cast <numberSet::value_type>(*it));
+	}
+
+	return byNumber(sortedValuesToSet(values));
+}
 
-	std::copy(numbers.begin(), numbers.end(), sortedNumbers.begin());
-	std::sort(sortedNumbers.begin(), sortedNumbers.end());
 
-	// Build the set by detecting ranges of continuous numbers
-	int previous = -1, rangeStart = -1;
+// static
+messageSet messageSet::byNumber(const numberSet& numbers)
+{
 	messageSet set;
 
-	for (std::vector <int>::const_iterator it = sortedNumbers.begin() ;
-	     it != sortedNumbers.end() ; ++it)
+	for (size_t i = 0, n = numbers.getRangeCount() ; i < n ; ++i)
 	{
-		const int current = *it;
-
-		if (current == previous)
-			continue;  // skip duplicates
+		const numberSet::range& range = numbers.getRangeAt(i);
 
-		if (previous == -1)
-		{
-			previous = current;
-			rangeStart = current;
-		}
-		else
-		{
-			if (current == previous + 1)
-			{
-				previous = current;
-			}
-			else
-			{
-				set.m_ranges.push_back(new numberMessageRange(rangeStart, previous));
-
-				previous = current;
-				rangeStart = current;
-			}
-		}
+		set.m_ranges.push_back(new numberMessageRange
+			(static_cast <int>(range.first), static_cast <int>(range.second)));
 	}
 
-	set.m_ranges.push_back(new numberMessageRange(rangeStart, previous));
-
 	return set;
 }
 
@@ -261,19 +281,20 @@ messageSet messageSet::byUID(const message::uid& first, const message::uid& last
 
 messageSet messageSet::byUID(const std::vector <message::uid>& uids)
 {
-	std::vector <vmime_uint32> numericUIDs;
+	std::vector <numberSet::value_type> numericUIDs;
+	numericUIDs.reserve(uids.size());
 
 	for (size_t i = 0, n = uids.size() ; i < n ; ++i)
 	{
 		const string uid = uids[i];
-		int numericUID = 0;
+		vmime_uint64 numericUID = 0;
 
 		const char* p = uid.c_str();
 
-		for ( ; *p >= '0' && *p <= '9' ; ++p)
+		for ( ; *p >= '0' && *p <= '9' && numericUID <= static_cast <vmime_uint32>(-1) ; ++p)
 			 numericUID = (numericUID * 10) + (*p - '0');
 
-		if (*p != '\0')
+		if (*p != '\0' || numericUID > static_cast <vmime_uint32>(-1))
 		{
 			messageSet set;
 
@@ -284,56 +305,27 @@ messageSet messageSet::byUID(const std::vector <message::uid>& uids)
 			return set;
 		}
 
-		numericUIDs.push_back(numericUID);
+		numericUIDs.push_back(static_cast <numberSet::value_type>(numericUID));
 	}
 
-	// Sort a copy of the list
-	std::vector <vmime_uint32> sortedUIDs;
-
-	sortedUIDs.resize(numericUIDs.size());
+	return byUID(sortedValuesToSet(numericUIDs));
+}
 
-	std::copy(numericUIDs.begin(), numericUIDs.end(), sortedUIDs.begin());
-	std::sort(sortedUIDs.begin(), sortedUIDs.end());
 
-	// Build the set by detecting ranges of continuous numbers
-	vmime_uint32 previous = -1U, rangeStart = -1U;
+// static
+messageSet messageSet::byUID(const numberSet& uids)
+{
 	messageSet set;
 
-	for (std::vector <vmime_uint32>::const_iterator it = sortedUIDs.begin() ;
-	     it != sortedUIDs.end() ; ++it)
+	for (size_t i = 0, n = uids.getRangeCount() ; i < n ; ++i)
 	{
-		const vmime_uint32 current = *it;
-
-		if (current == previous)
-			continue;  // skip duplicates
+		const numberSet::range& range = uids.getRangeAt(i);
 
-		if (previous == -1U)
-		{
-			previous = current;
-			rangeStart = current;
-		}
-		else
-		{
-			if (current == previous + 1)
-			{
-				previous = current;
-			}
-			else
-			{
-				set.m_ranges.push_back(new UIDMessageRange
-					(utility::stringUtils::toString(rangeStart),
-					 utility::stringUtils::toString(previous)));
-
-				previous = current;
-				rangeStart = current;
-			}
-		}
+		set.m_ranges.push_back(new UIDMessageRange
+			(utility::stringUtils::toString(range.first),
+			 utility::stringUtils::toString(range.second)));
 	}
 
-	set.m_ranges.push_back(new UIDMessageRange
-		(utility::stringUtils::toString(rangeStart),
-	     utility::stringUtils::toString(previous)));
-
 	return set;
 }
 
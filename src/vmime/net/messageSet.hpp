@@ -26,6 +26,7 @@
 
 
 #include "vmime/net/message.hpp"
+#include "vmime/net/numberSet.hpp"
 
 
 namespace vmime {
@@ -251,9 +252,19 @@ public:
 	  *
 	  * @param numbers a vector containing numbers of the messages
 	  * @return new message set
+	  * @throw std::invalid_argument if a number is less than 1
 	  */
 	static messageSet byNumber(const std::vector <int>& numbers);
 
+	/** Constructs a new message set from a set of message sequence
+	  * numbers. Each range of consecutive numbers results in a single
+	  * message range.
+	  *
+	  * @param numbers set of message numbers
+	  * @return new message set
+	  */
+	static messageSet byNumber(const numberSet& numbers);
+
 	/** Constructs a new message set and initializes it with a single
 	  * message represented by its UID.
 	  *
@@ -287,6 +298,15 @@ public:
 	  */
 	static messageSet byUID(const std::vector <message::uid>& uids);
 
+	/** Constructs a new message set from a set of numeric UIDs (this
+	  * is the case for IMAP). Each range of consecutive UIDs results in
+	  * a single message range.
+	  *
+	  * @param uids set of message UIDs
+	  * @return new message set
+	  */
+	static messageSet byUID(const numberSet& uids);
+
 	/** Adds the specified range to this set. The type of message range
 	  * (either number or UID) must match the type of the ranges already
 	  * contained in this set (ie. it's not possible to have a message
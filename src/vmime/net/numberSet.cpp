@@ -0,0 +1,452 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/net/numberSet.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace vmime {
+namespace net {
+
+
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+// Order ranges by their last value
+struct rangeLastLess
+{
+	bool operator()(const numberSet::range& r, const vmime_uint64 value) const
+	{
+		return r.second < value;
+	}
+};
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+//
+// numberSet::const_iterator
+//
+
+numberSet::const_iterator::const_iterator()
+	: m_ranges(NULL), m_index(0), m_value(0)
+{
+}
+
+
+numberSet::const_iterator::const_iterator
+	(const std::vector <range>* ranges, const size_t index, const value_type value)
+	: m_ranges(ranges), m_index(index), m_value(value)
+{
+}
+
+
+numberSet::value_type numberSet::const_iterator::operator*() const
+{
+	return m_value;
+}
+
+
+numberSet::const_iterator& numberSet::const_iterator::operator++()
+{
+	if (m_value == (*m_ranges)[m_index].second)
+	{
+		++m_index;
+		m_value = (m_index < m_ranges->size() ? (*m_ranges)[m_index].first : 0);
+	}
+	else
+	{
+		++m_value;
+	}
+
+	return *this;
+}
+
+
+numberSet::const_iterator numberSet::const_iterator::operator++(int)
+{
+	const_iterator old(*this);
+	++(*this);
+
+	return old;
+}
+
+
+bool numberSet::const_iterator::operator==(const const_iterator& it) const
+{
+	return m_ranges == it.m_ranges && m_index == it.m_index && m_value == it.m_value;
+}
+
+
+bool numberSet::const_iterator::operator!=(const const_iterator& it) const
+{
+	return !(*this == it);
+}
+
+
+//
+// numberSet
+//
+
+numberSet::numberSet()
+{
+}
+
+
+// static
+numberSet numberSet::fromSequenceSet(const string& str)
+{
+	numberSet set;
+
+	const char* p = str.c_str();
+	const char* const pend = p + str.length();
+
+	while (p < pend)
+	{
+		value_type values[2] = { 0, 0 };
+		int count = 0;
+
+		for ( ; count < 2 ; ++count)
+		{
+			if (p == pend || *p < '0' || *p > '9')
+				throw std::invalid_argument("str");
+
+			vmime_uint64 value = 0;
+
+			for ( ; p < pend && *p >= '0' && *p <= '9' ; ++p)
+			{
+				value = value * 10 + (*p - '0');
+
+				if (value > static_cast <value_type>(-1))
+					throw std::invalid_argument("str");
+			}
+
+			values[count] = static_cast <value_type>(value);
+
+			if (p == pend || *p != ':')
+				break;
+
+			++p;  // skip ':'
+		}
+
+		if (count == 0)
+			set.add(values[0]);
+		else if (count == 1)
+			set.add(std::min(values[0], values[1]), std::max(values[0], values[1]));
+		else
+			throw std::invalid_argument("str");  // "a:b:c"
+
+		if (p < pend)
+		{
+			if (*p != ',' || p + 1 == pend)
+				throw std::invalid_argument("str");
+
+			++p;  // skip ','
+		}
+	}
+
+	return set;
+}
+
+
+const string numberSet::toSequenceSet() const
+{
+	std::ostringstream oss;
+	oss.imbue(std::locale::classic());
+
+	for (std::vector <range>::const_iterator it = m_ranges.begin() ; it != m_ranges.end() ; ++it)
+	{
+		if (it != m_ranges.begin())
+			oss << ',';
+
+		if ((*it).first == (*it).second)
+			oss << (*it).first;
+		else
+			oss << (*it).first << ':' << (*it).second;
+	}
+
+	return oss.str();
+}
+
+
+void numberSet::add(const value_type value)
+{
+	add(value, value);
+}
+
+
+void numberSet::add(const value_type first, const value_type last)
+{
+	if (first > last)
+		return;
+
+	// Fast path: values are often added in ascending order
+	if (m_ranges.empty() || static_cast <vmime_uint64>(m_ranges.back().second) + 1 < first)
+	{
+		m_ranges.push_back(range(first, last));
+		return;
+	}
+
+	// Find the first range which overlaps or touches [first, last]
+	std::vector <range>::iterator begin = std::lower_bound
+		(m_ranges.begin(), m_ranges.end(),
+		 first == 0 ? 0 : static_cast <vmime_uint64>(first) - 1, rangeLastLess());
+
+	// Find the range past the last one which overlaps or touches [first, last]
+	std::vector <range>::iterator end = begin;
+
+	while (end != m_ranges.end() && (*end).first <= static_cast <vmime_uint64>(last) + 1)
+		++end;
+
+	if (begin == end)
+	{
+		m_ranges.insert(begin, range(first, last));
+	}
+	else
+	{
+		(*begin).first = std::min((*begin).first, first);
+		(*begin).second = std::max((*(end - 1)).second, last);
+
+		m_ranges.erase(begin + 1, end);
+	}
+}
+
+
+void numberSet::remove(const value_type value)
+{
+	remove(value, value);
+}
+
+
+void numberSet::remove(const value_type first, const value_type last)
+{
+	if (first > last)
+		return;
+
+	// Find the first range which overlaps [first, last]
+	std::vector <range>::iterator it = std::lower_bound
+		(m_ranges.begin(), m_ranges.end(), first, rangeLastLess());
+
+	while (it != m_ranges.end() && (*it).first <= last)
+	{
+		if ((*it).first < first && (*it).second > last)
+		{
+			// Split range
+			const range tail(last + 1, (*it).second);
+			(*it).second = first - 1;
+
+			m_ranges.insert(it + 1, tail);
+			return;
+		}
+		else if ((*it).first < first)
+		{
+			(*it).second = first - 1;
+			++it;
+		}
+		else if ((*it).second > last)
+		{
+			(*it).first = last + 1;
+			return;
+		}
+		else
+		{
+			it = m_ranges.erase(it);
+		}
+	}
+}
+
+
+bool numberSet::contains(const value_type value) const
+{
+	std::vector <range>::const_iterator it = std::lower_bound
+		(m_ranges.begin(), m_ranges.end(), value, rangeLastLess());
+
+	return it != m_ranges.end() && (*it).first <= value;
+}
+
+
+void numberSet::unionWith(const numberSet& other)
+{
+	if (other.m_ranges.empty())
+		return;
+
+	std::vector <range> result;
+	result.reserve(m_ranges.size() + other.m_ranges.size());
+
+	std::vector <range>::const_iterator a = m_ranges.begin(), b = other.m_ranges.begin();
+
+	while (a != m_ranges.end() || b != other.m_ranges.end())
+	{
+		range r;
+
+		if (b == other.m_ranges.end() || (a != m_ranges.end() && (*a).first <= (*b).first))
+			r = *a++;
+		else
+			r = *b++;
+
+		// Merge with previous range if they overlap or touch
+		if (!result.empty() && static_cast <vmime_uint64>(result.back().second) + 1 >= r.first)
+			result.back().second = std::max(result.back().second, r.second);
+		else
+			result.push_back(r);
+	}
+
+	m_ranges.swap(result);
+}
+
+
+void numberSet::intersectWith(const numberSet& other)
+{
+	std::vector <range> result;
+
+	std::vector <range>::const_iterator a = m_ranges.begin(), b = other.m_ranges.begin();
+
+	while (a != m_ranges.end() && b != other.m_ranges.end())
+	{
+		const value_type first = std::max((*a).first, (*b).first);
+		const value_type last = std::min((*a).second, (*b).second);
+
+		if (first <= last)
+			result.push_back(range(first, last));
+
+		if ((*a).second < (*b).second)
+			++a;
+		else
+			++b;
+	}
+
+	m_ranges.swap(result);
+}
+
+
+void numberSet::subtract(const numberSet& other)
+{
+	std::vector <range> result;
+
+	std::vector <range>::const_iterator b = other.m_ranges.begin();
+
+	for (std::vector <range>::const_iterator a = m_ranges.begin() ; a != m_ranges.end() ; ++a)
+	{
+		vmime_uint64 first = (*a).first;
+		const vmime_uint64 last = (*a).second;
+
+		// Skip ranges which are entirely before this one
+		while (b != other.m_ranges.end() && (*b).second < first)
+			++b;
+
+		std::vector <range>::const_iterator bb = b;
+
+		for ( ; bb != other.m_ranges.end() && (*bb).first <= last ; ++bb)
+		{
+			if ((*bb).first > first)
+				result.push_back(range(static_cast <value_type>(first), (*bb).first - 1));
+
+			first = static_cast <vmime_uint64>((*bb).second) + 1;
+		}
+
+		if (first <= last)
+			result.push_back(range(static_cast <value_type>(first), static_cast <value_type>(last)));
+	}
+
+	m_ranges.swap(result);
+}
+
+
+void numberSet::clear()
+{
+	m_ranges.clear();
+}
+
+
+bool numberSet::isEmpty() const
+{
+	return m_ranges.empty();
+}
+
+
+vmime_uint64 numberSet::getCount() const
+{
+	vmime_uint64 count = 0;
+
+	for (std::vector <range>::const_iterator it = m_ranges.begin() ; it != m_ranges.end() ; ++it)
+		count += static_cast <vmime_uint64>((*it).second - (*it).first) + 1;
+
+	return count;
+}
+
+
+size_t numberSet::getRangeCount() const
+{
+	return m_ranges.size();
+}
+
+
+const numberSet::range& numberSet::getRangeAt(const size_t i) const
+{
+	return m_ranges[i];
+}
+
+
+numberSet::const_iterator numberSet::begin() const
+{
+	if (m_ranges.empty())
+		return end();
+
+	return const_iterator(&m_ranges, 0, m_ranges[0].first);
+}
+
+
+numberSet::const_iterator numberSet::end() const
+{
+	return const_iterator(&m_ranges, m_ranges.size(), 0);
+}
+
+
+bool numberSet::operator==(const numberSet& other) const
+{
+	return m_ranges == other.m_ranges;
+}
+
+
+bool numberSet::operator!=(const numberSet& other) const
+{
+	return !(*this == other);
+}
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
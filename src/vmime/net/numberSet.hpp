@@ -0,0 +1,218 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_NET_NUMBERSET_HPP_INCLUDED
+#define VMIME_NET_NUMBERSET_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include <vector>
+
+#include "vmime/types.hpp"
+
+
+namespace vmime {
+namespace net {
+
+
+/** A compact set of message numbers or numeric UIDs.
+  *
+  * Values are stored as a sorted list of disjoint ranges of
+  * consecutive values, so that a set of a million contiguous UIDs
+  * takes a few bytes. It supports union, intersection and difference,
+  * converts to and from IMAP sequence-set syntax (eg. "1:5,7,9:12"),
+  * and enumerates its values lazily.
+  */
+
+class VMIME_EXPORT numberSet
+{
+public:
+
+	typedef vmime_uint32 value_type;
+	typedef std::pair <value_type, value_type> range;
+
+
+	/** Iterates over the values of a set, in ascending order,
+	  * without expanding the ranges.
+	  */
+	class VMIME_EXPORT const_iterator
+	{
+	public:
+
+		const_iterator();
+
+		value_type operator*() const;
+
+		const_iterator& operator++();
+		const_iterator operator++(int);
+
+		bool operator==(const const_iterator& it) const;
+		bool operator!=(const const_iterator& it) const;
+
+	private:
+
+		friend class numberSet;
+
+		const_iterator(const std::vector <range>* ranges, const size_t index, const value_type value);
+
+		const std::vector <range>* m_ranges;
+		size_t m_index;
+		value_type m_value;
+	};
+
+
+	/** Construct an empty set.
+	  */
+	numberSet();
+
+	/** Parse a set from IMAP sequence-set syntax (eg. "1:5,7,9:12").
+	  * The special value '*' is not supported.
+	  *
+	  * @param str sequence set
+	  * @return parsed set
+	  * @throw std::invalid_argument if the string is not a valid
+	  * sequence set
+	  */
+	static numberSet fromSequenceSet(const string& str);
+
+	/** Return the IMAP sequence-set representation of this set,
+	  * eg. "1:5,7,9:12".
+	  *
+	  * @return sequence set, or an empty string if the set is empty
+	  */
+	const string toSequenceSet() const;
+
+	/** Add a value to this set.
+	  *
+	  * @param value value to add
+	  */
+	void add(const value_type value);
+
+	/** Add a range of values to this set.
+	  *
+	  * @param first first value of the range
+	  * @param last last value of the range (inclusive)
+	  */
+	void add(const value_type first, const value_type last);
+
+	/** Remove a value from this set.
+	  *
+	  * @param value value to remove
+	  */
+	void remove(const value_type value);
+
+	/** Remove a range of values from this set.
+	  *
+	  * @param first first value of the range
+	  * @param last last value of the range (inclusive)
+	  */
+	void remove(const value_type first, const value_type last);
+
+	/** Test whether this set contains the specified value.
+	  *
+	  * @param value value to look for
+	  * @return true if the value is in this set, false otherwise
+	  */
+	bool contains(const value_type value) const;
+
+	/** Add all the values of another set to this set.
+	  *
+	  * @param other other set
+	  */
+	void unionWith(const numberSet& other);
+
+	/** Keep only the values which are also in another set.
+	  *
+	  * @param other other set
+	  */
+	void intersectWith(const numberSet& other);
+
+	/** Remove all the values which are in another set.
+	  *
+	  * @param other other set
+	  */
+	void subtract(const numberSet& other);
+
+	/** Remove all values from this set.
+	  */
+	void clear();
+
+	/** Test whether this set is empty.
+	  *
+	  * @return true if this set contains no value, false otherwise
+	  */
+	bool isEmpty() const;
+
+	/** Return the number of values in this set.
+	  *
+	  * @return number of values
+	  */
+	vmime_uint64 getCount() const;
+
+	/** Return the number of ranges of consecutive values in this set.
+	  *
+	  * @return number of ranges
+	  */
+	size_t getRangeCount() const;
+
+	/** Return the range of consecutive values at the specified index.
+	  * Ranges are sorted in ascending order and never overlap or touch.
+	  *
+	  * @param i range index (from 0 to getRangeCount() - 1)
+	  * @return range (first and last values, inclusive)
+	  */
+	const range& getRangeAt(const size_t i) const;
+
+	/** Return an iterator to the first (smallest) value of the set.
+	  *
+	  * @return iterator to the first value
+	  */
+	const_iterator begin() const;
+
+	/** Return an iterator past the last value of the set.
+	  *
+	  * @return iterator past the last value
+	  */
+	const_iterator end() const;
+
+	bool operator==(const numberSet& other) const;
+	bool operator!=(const numberSet& other) const;
+
+private:
+
+	std::vector <range> m_ranges;
+};
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
+
+#endif // VMIME_NET_NUMBERSET_HPP_INCLUDED
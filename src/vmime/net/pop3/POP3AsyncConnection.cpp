@@ -0,0 +1,143 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_POP3
+
+
+#include "vmime/net/pop3/POP3AsyncConnection.hpp"
+
+#include "vmime/utility/stringUtils.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace pop3 {
+
+
+#ifndef VMIME_BUILDING_DOC
+
+// Sends PASS after a successful USER command
+class POP3AsyncLoginHandler : public asyncResponseHandler
+{
+public:
+
+	POP3AsyncLoginHandler(const string& password, shared_ptr <asyncResponseHandler> handler)
+		: m_password(password), m_handler(handler)
+	{
+	}
+
+	void onResponse(shared_ptr <asyncConnection> conn, const std::vector <string>& lines)
+	{
+		if (conn->isSuccessResponse(lines))
+			conn->sendCommand("PASS " + m_password, m_handler);
+		else if (m_handler)
+			m_handler->onResponse(conn, lines);
+	}
+
+	void onError(shared_ptr <asyncConnection> conn, const exception& e)
+	{
+		if (m_handler)
+			m_handler->onError(conn, e);
+	}
+
+private:
+
+	const string m_password;
+	shared_ptr <asyncResponseHandler> m_handler;
+};
+
+#endif // VMIME_BUILDING_DOC
+
+
+POP3AsyncConnection::POP3AsyncConnection()
+{
+}
+
+
+void POP3AsyncConnection::expectGreeting(shared_ptr <asyncResponseHandler> handler)
+{
+	expectResponse(handler);
+}
+
+
+void POP3AsyncConnection::login
+	(const string& username, const string& password, shared_ptr <asyncResponseHandler> handler)
+{
+	sendCommand("USER " + username,
+		make_shared <POP3AsyncLoginHandler>(password, handler));
+}
+
+
+const string POP3AsyncConnection::prepareCommand(const string& command, pendingResponse& resp)
+{
+	const size_t sp = command.find(' ');
+	const string verb = utility::stringUtils::toUpper(command.substr(0, sp));
+	const bool hasArgs = (sp != string::npos &&
+		!utility::stringUtils::trim(command.substr(sp + 1)).empty());
+
+	resp.multiLine = (verb == "RETR" || verb == "TOP" || verb == "CAPA" ||
+		((verb == "LIST" || verb == "UIDL") && !hasArgs));
+
+	return command + "\r\n";
+}
+
+
+bool POP3AsyncConnection::processResponseLine(pendingResponse& resp, const string& line)
+{
+	// Status line
+	if (resp.lines.empty())
+	{
+		resp.lines.push_back(line);
+
+		return !resp.multiLine || line.empty() || line[0] != '+';
+	}
+
+	// Data lines, terminated by a single dot
+	if (line == ".")
+		return true;
+
+	if (!line.empty() && line[0] == '.')
+		resp.lines.push_back(string(line.begin() + 1, line.end()));
+	else
+		resp.lines.push_back(line);
+
+	return false;
+}
+
+
+bool POP3AsyncConnection::isSuccessResponse(const std::vector <string>& lines) const
+{
+	return !lines.empty() && !lines[0].empty() && lines[0][0] == '+';
+}
+
+
+} // pop3
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_POP3
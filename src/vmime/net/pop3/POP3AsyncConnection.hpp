@@ -0,0 +1,87 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_POP3_POP3ASYNCCONNECTION_HPP_INCLUDED
+#define VMIME_NET_POP3_POP3ASYNCCONNECTION_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_POP3
+
+
+#include "vmime/net/asyncConnection.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace pop3 {
+
+
+/** An asynchronous connection to a POP3 server (see asyncEngine).
+  *
+  * The response to RETR, TOP, CAPA, and to LIST and UIDL without
+  * argument, is multi-line: it contains the status line followed by the
+  * data lines, without the terminating "." and with dot-stuffing removed.
+  */
+class VMIME_EXPORT POP3AsyncConnection : public asyncConnection
+{
+public:
+
+	POP3AsyncConnection();
+
+	/** Wait for the greeting sent by the server after connection.
+	  *
+	  * @param handler handler to be notified of the greeting
+	  */
+	void expectGreeting(shared_ptr <asyncResponseHandler> handler);
+
+	/** Authenticate with the USER and PASS commands. The handler is
+	  * notified of the response to PASS, or of the response to USER
+	  * if it failed.
+	  *
+	  * @param username user name
+	  * @param password password
+	  * @param handler handler to be notified of the response
+	  */
+	void login(const string& username, const string& password, shared_ptr <asyncResponseHandler> handler);
+
+	bool isSuccessResponse(const std::vector <string>& lines) const;
+
+protected:
+
+	const string prepareCommand(const string& command, pendingResponse& resp);
+	bool processResponseLine(pendingResponse& resp, const string& line);
+};
+
+
+} // pop3
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_POP3
+
+#endif // VMIME_NET_POP3_POP3ASYNCCONNECTION_HPP_INCLUDED
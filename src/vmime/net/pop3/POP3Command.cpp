@@ -35,6 +35,7 @@
 
 #include "vmime/mailbox.hpp"
 #include "vmime/utility/outputStreamAdapter.hpp"
+#include "vmime/utility/instrumentation.hpp"
 
 
 namespace vmime {
@@ -219,6 +220,9 @@ const string POP3Command::getText() const
 void POP3Command::send(shared_ptr <POP3Connection> conn)
 {
 	conn->getSocket()->send(m_text + "\r\n");
+
+	if (utility::instrumentation::isEnabled())
+		conn->onCommandSent(m_text);
 }
 
 
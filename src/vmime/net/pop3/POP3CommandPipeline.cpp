@@ -0,0 +1,148 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_POP3
+
+
+#include "vmime/net/pop3/POP3CommandPipeline.hpp"
+#include "vmime/net/pop3/POP3Connection.hpp"
+
+#include "vmime/net/socket.hpp"
+
+#include "vmime/exception.hpp"
+
+#include "vmime/utility/instrumentation.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace pop3 {
+
+
+const size_t POP3CommandPipeline::DEFAULT_WINDOW_SIZE;
+
+
+POP3CommandPipeline::POP3CommandPipeline
+	(shared_ptr <POP3Connection> conn, const bool pipeline, const size_t windowSize)
+	: m_conn(conn), m_windowSize(pipeline && windowSize > 1 ? windowSize : 1)
+{
+}
+
+
+// static
+shared_ptr <POP3CommandPipeline> POP3CommandPipeline::create
+	(shared_ptr <POP3Connection> conn, const bool pipeline, const size_t windowSize)
+{
+	return shared_ptr <POP3CommandPipeline>
+		(new POP3CommandPipeline(conn, pipeline, windowSize));
+}
+
+
+void POP3CommandPipeline::addCommand
+	(shared_ptr <POP3Command> cmd, responseHandler* handler)
+{
+	pendingCommand pc;
+	pc.command = cmd;
+	pc.handler = handler;
+
+	m_commands.push_back(pc);
+}
+
+
+size_t POP3CommandPipeline::getCommandCount() const
+{
+	return m_commands.size();
+}
+
+
+void POP3CommandPipeline::execute()
+{
+	std::vector <pendingCommand> commands;
+	commands.swap(m_commands);
+
+	const size_t count = commands.size();
+
+	// Refill the window when half of it has been consumed, so that
+	// commands are sent in batches rather than one by one
+	const size_t refillThreshold = m_windowSize / 2;
+
+	size_t sent = 0;
+
+	bool hasError = false;
+	string errorCommand, errorResponse;
+
+	for (size_t recv = 0 ; recv < count ; ++recv)
+	{
+		if (sent == recv || (sent < count && sent - recv <= refillThreshold))
+		{
+			string buffer;
+			const size_t first = sent;
+
+			for ( ; sent < count && sent - recv < m_windowSize ; ++sent)
+			{
+				buffer += commands[sent].command->getText();
+				buffer += "\r\n";
+			}
+
+			m_conn->getSocket()->send(buffer);
+
+			if (utility::instrumentation::isEnabled())
+			{
+				for (size_t i = first ; i < sent ; ++i)
+					m_conn->onCommandSent(commands[i].command->getText());
+			}
+		}
+
+		try
+		{
+			commands[recv].handler->handleResponse(m_conn);
+		}
+		catch (exceptions::command_error& e)
+		{
+			// The response has been read entirely, so the next
+			// responses can still be read: report the first error
+			// only once the whole pipeline has been processed
+			if (!hasError)
+			{
+				hasError = true;
+				errorCommand = e.command();
+				errorResponse = e.response();
+			}
+		}
+	}
+
+	if (hasError)
+		throw exceptions::command_error(errorCommand, errorResponse);
+}
+
+
+} // pop3
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_POP3
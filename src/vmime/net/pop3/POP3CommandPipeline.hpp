@@ -0,0 +1,148 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_POP3_POP3COMMANDPIPELINE_HPP_INCLUDED
+#define VMIME_NET_POP3_POP3COMMANDPIPELINE_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_POP3
+
+
+#include "vmime/object.hpp"
+#include "vmime/base.hpp"
+
+#include "vmime/net/pop3/POP3Command.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace pop3 {
+
+
+class POP3Connection;
+
+
+/** A list of POP3 commands which are sent to the server without
+  * waiting for the response of the previous command, if the server
+  * supports the PIPELINING capability (RFC 2449).
+  *
+  * Responses are read in the same order as the commands were sent.
+  * Not more than a limited number of commands are in flight at the
+  * same time, so that the server is not blocked writing responses
+  * the client is not reading.
+  */
+class VMIME_EXPORT POP3CommandPipeline : public object
+{
+public:
+
+	/** Reads the response to a command sent in a pipeline.
+	  */
+	class VMIME_EXPORT responseHandler
+	{
+	public:
+
+		virtual ~responseHandler() { }
+
+		/** Called when the response to the command is the next data
+		  * expected from the server. Implementations must read the
+		  * response using one of the POP3Response::read*() functions.
+		  *
+		  * An exceptions::command_error thrown from this function does
+		  * not interrupt the pipeline: remaining responses are read and
+		  * the first error is thrown again from execute().
+		  *
+		  * @param conn connection from which to read the response
+		  */
+		virtual void handleResponse(shared_ptr <POP3Connection> conn) = 0;
+	};
+
+	/** Default maximum number of commands sent without having
+	  * received their response. */
+	static const size_t DEFAULT_WINDOW_SIZE = 32;
+
+
+	/** Creates a new pipeline of POP3 commands.
+	  *
+	  * @param conn connection on which commands will be sent
+	  * @param pipeline set to true if the server supports pipelining;
+	  * if false, commands are sent one at a time
+	  * @param windowSize maximum number of commands in flight
+	  * @return a new POP3CommandPipeline object
+	  */
+	static shared_ptr <POP3CommandPipeline> create
+		(shared_ptr <POP3Connection> conn, const bool pipeline,
+		 const size_t windowSize = DEFAULT_WINDOW_SIZE);
+
+	/** Adds a new command to this pipeline.
+	  *
+	  * @param cmd command to add
+	  * @param handler object which will read the response to the
+	  * command (not owned by the pipeline, must be valid until
+	  * execute() returns)
+	  */
+	void addCommand(shared_ptr <POP3Command> cmd, responseHandler* handler);
+
+	/** Returns the number of commands in this pipeline.
+	  *
+	  * @return number of commands
+	  */
+	size_t getCommandCount() const;
+
+	/** Sends all commands to the server and reads their responses.
+	  * The list of commands is cleared afterwards.
+	  *
+	  * @throw exceptions::command_error if a response handler failed
+	  */
+	void execute();
+
+private:
+
+	POP3CommandPipeline(shared_ptr <POP3Connection> conn, const bool pipeline, const size_t windowSize);
+	POP3CommandPipeline(const POP3CommandPipeline&);
+
+
+	struct pendingCommand
+	{
+		shared_ptr <POP3Command> command;
+		responseHandler* handler;
+	};
+
+	shared_ptr <POP3Connection> m_conn;
+	size_t m_windowSize;
+
+	std::vector <pendingCommand> m_commands;
+};
+
+
+} // pop3
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_POP3
+
+#endif // VMIME_NET_POP3_POP3COMMANDPIPELINE_HPP_INCLUDED
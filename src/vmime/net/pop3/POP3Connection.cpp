@@ -33,10 +33,15 @@
 #include "vmime/exception.hpp"
 #include "vmime/platform.hpp"
 
+#include "vmime/utility/stringUtils.hpp"
+#include "vmime/utility/instrumentation.hpp"
+
 #include "vmime/security/digest/messageDigestFactory.hpp"
 
 #include "vmime/net/defaultConnectionInfos.hpp"
 
+#include <sstream>
+
 #if VMIME_HAVE_SASL_SUPPORT
 	#include "vmime/security/sasl/SASLContext.hpp"
 #endif // VMIME_HAVE_SASL_SUPPORT
@@ -65,7 +70,8 @@ namespace pop3 {
 
 POP3Connection::POP3Connection(shared_ptr <POP3Store> store, shared_ptr <security::authenticator> auth)
 	: m_store(store), m_auth(auth), m_socket(null), m_timeoutHandler(null),
-	  m_authenticated(false), m_secured(false), m_capabilitiesFetched(false)
+	  m_authenticated(false), m_secured(false), m_capabilitiesFetched(false),
+	  m_awaitingResponse(false)
 {
 }
 
@@ -175,6 +181,10 @@ void POP3Connection::connect()
 
 	// Start authentication process
 	authenticate(messageId(response->getText()));
+
+	// Server may announce a different set of capabilities
+	// once the client has authenticated (RFC-2449)
+	invalidateCapabilities();
 }
 
 
@@ -211,10 +221,17 @@ void POP3Connection::internalDisconnect()
 
 	m_timeoutHandler = null;
 
+	m_responseState = POP3Response::state();
+
 	m_authenticated = false;
 	m_secured = false;
 
 	m_cntInfos = null;
+
+	m_awaitingResponse = false;
+	m_pendingCommands.clear();
+
+	invalidateCapabilities();
 }
 
 
@@ -552,10 +569,16 @@ void POP3Connection::startTLS()
 		shared_ptr <tls::TLSSocket> tlsSocket =
 			tlsSession->getSocket(m_socket);
 
+		tlsSocket->setServerIdentity(tls::TLSSessionCache::makeServerIdentity
+			(m_cntInfos->getHost(), m_cntInfos->getPort()));
+
 		tlsSocket->handshake();
 
 		m_socket = tlsSocket;
 
+		// Discard any data received before the TLS negotiation
+		m_responseState = POP3Response::state();
+
 		m_secured = true;
 		m_cntInfos = make_shared <tls::TLSSecuredConnectionInfos>
 			(m_cntInfos->getHost(), m_cntInfos->getPort(), tlsSession, tlsSocket);
@@ -592,6 +615,33 @@ const std::vector <string> POP3Connection::getCapabilities()
 }
 
 
+bool POP3Connection::hasCapability(const string& capa)
+{
+	const std::vector <string> capabilities = getCapabilities();
+
+	for (unsigned int i = 0 ; i < capabilities.size() ; ++i)
+	{
+		// Capability name is the first word of the line
+		// (eg. "SASL DIGEST-MD5 CRAM-MD5")
+		const string& line = capabilities[i];
+		const size_t end = line.find_first_of(" \t");
+		const string name = (end == string::npos ? line : line.substr(0, end));
+
+		if (utility::stringUtils::isStringEqualNoCase(name, capa))
+			return true;
+	}
+
+	return false;
+}
+
+
+bool POP3Connection::canPipeline()
+{
+	return GET_PROPERTY(bool, PROPERTY_OPTIONS_PIPELINING) &&
+		hasCapability("PIPELINING");
+}
+
+
 void POP3Connection::invalidateCapabilities()
 {
 	m_capabilities.clear();
@@ -625,6 +675,43 @@ bool POP3Connection::isConnected() const
 }
 
 
+void POP3Connection::onCommandSent(const string& text)
+{
+	m_awaitingResponse = true;
+
+	// Command name, eg. "RETR" or "UIDL"
+	std::istringstream iss(text);
+	string name;
+	iss >> name;
+
+	name = utility::stringUtils::toUpper(name);
+
+	utility::instrumentation::increment(utility::instrumentation::POP3_COMMANDS, name);
+
+	m_pendingCommands.push_back(std::make_pair(name, utility::instrumentation::now()));
+}
+
+
+void POP3Connection::onResponseReceived()
+{
+	if (m_awaitingResponse)
+	{
+		utility::instrumentation::increment(utility::instrumentation::POP3_ROUND_TRIPS, "");
+		m_awaitingResponse = false;
+	}
+
+	// The greeting does not answer a command, and is not timed
+	if (!m_pendingCommands.empty())
+	{
+		const std::pair <string, vmime_uint64> cmd = m_pendingCommands.front();
+		m_pendingCommands.pop_front();
+
+		utility::instrumentation::record(utility::instrumentation::POP3_COMMAND_DURATION,
+			cmd.first, utility::instrumentation::now() - cmd.second);
+	}
+}
+
+
 bool POP3Connection::isSecuredConnection() const
 {
 	return m_secured;
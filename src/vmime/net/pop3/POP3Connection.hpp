@@ -31,6 +31,8 @@
 #if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_POP3
 
 
+#include <deque>
+
 #include "vmime/messageId.hpp"
 
 #include "vmime/net/socket.hpp"
@@ -62,6 +64,10 @@ class POP3Store;
   */
 class VMIME_EXPORT POP3Connection : public object
 {
+	friend class POP3Command;
+	friend class POP3CommandPipeline;
+	friend class POP3Response;
+
 public:
 
 	POP3Connection(shared_ptr <POP3Store> store, shared_ptr <security::authenticator> auth);
@@ -81,6 +87,22 @@ public:
 	virtual shared_ptr <security::authenticator> getAuthenticator();
 	virtual shared_ptr <session> getSession();
 
+	/** Returns whether the server announced the specified capability
+	  * in its response to the CAPA command (RFC 2449).
+	  *
+	  * @param capa capability name (eg. "PIPELINING")
+	  * @return true if the capability is supported, false otherwise
+	  */
+	bool hasCapability(const string& capa);
+
+	/** Returns whether commands can be pipelined on this connection,
+	  * ie. the server supports the PIPELINING capability and the
+	  * "options.pipelining" property is enabled.
+	  *
+	  * @return true if commands can be pipelined, false otherwise
+	  */
+	bool canPipeline();
+
 private:
 
 	void authenticate(const messageId& randomMID);
@@ -98,6 +120,9 @@ private:
 
 	void internalDisconnect();
 
+	void onCommandSent(const string& text);
+	void onResponseReceived();
+
 
 	weak_ptr <POP3Store> m_store;
 
@@ -105,6 +130,8 @@ private:
 	shared_ptr <socket> m_socket;
 	shared_ptr <timeoutHandler> m_timeoutHandler;
 
+	POP3Response::state m_responseState;
+
 	bool m_authenticated;
 	bool m_secured;
 
@@ -112,6 +139,11 @@ private:
 
 	std::vector <string> m_capabilities;
 	bool m_capabilitiesFetched;
+
+	// Instrumentation: commands awaiting a response, in the order they
+	// were sent (responses come in the same order, even when pipelining)
+	bool m_awaitingResponse;
+	std::deque <std::pair <string, vmime_uint64> > m_pendingCommands;
 };
 
 
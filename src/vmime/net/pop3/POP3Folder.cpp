@@ -32,6 +32,7 @@
 #include "vmime/net/pop3/POP3Store.hpp"
 #include "vmime/net/pop3/POP3Message.hpp"
 #include "vmime/net/pop3/POP3Command.hpp"
+#include "vmime/net/pop3/POP3CommandPipeline.hpp"
 #include "vmime/net/pop3/POP3Response.hpp"
 #include "vmime/net/pop3/POP3FolderStatus.hpp"
 
@@ -45,6 +46,117 @@ namespace net {
 namespace pop3 {
 
 
+/** Reads the response to a "TOP <num> 0" command into the header
+  * of a message, and reports progress.
+  */
+class POP3Folder::headerResponseHandler : public POP3CommandPipeline::responseHandler
+{
+public:
+
+	headerResponseHandler(shared_ptr <POP3Message> msg, const fetchAttributes& options,
+	                      utility::progressListener* progress,
+	                      size_t* current, const size_t total)
+		: m_msg(msg), m_options(options), m_progress(progress),
+		  m_current(current), m_total(total)
+	{
+	}
+
+	void handleResponse(shared_ptr <POP3Connection> conn)
+	{
+		m_msg->readHeader(conn, m_options);
+
+		if (m_progress)
+			m_progress->progress(++(*m_current), m_total);
+	}
+
+private:
+
+	shared_ptr <POP3Message> m_msg;
+	const fetchAttributes& m_options;
+	utility::progressListener* m_progress;
+	size_t* m_current;
+	size_t m_total;
+};
+
+
+/** Reads a multi-line response (eg. to "LIST" or "UIDL" command).
+  */
+class POP3Folder::multilineResponseHandler : public POP3CommandPipeline::responseHandler
+{
+public:
+
+	void handleResponse(shared_ptr <POP3Connection> conn)
+	{
+		m_response = POP3Response::readMultilineResponse(conn);
+	}
+
+	shared_ptr <POP3Response> getResponse() const
+	{
+		return m_response;
+	}
+
+private:
+
+	shared_ptr <POP3Response> m_response;
+};
+
+
+/** Reads the response to a "DELE" command.
+  */
+class POP3Folder::deleteResponseHandler : public POP3CommandPipeline::responseHandler
+{
+public:
+
+	void handleResponse(shared_ptr <POP3Connection> conn)
+	{
+		shared_ptr <POP3Response> response = POP3Response::readResponse(conn);
+
+		if (!response->isSuccess())
+			throw exceptions::command_error("DELE", response->getFirstLine());
+	}
+};
+
+
+/** Reads the response to a "RETR" command into an output stream,
+  * and reports progress.
+  */
+class POP3Folder::retrieveResponseHandler : public POP3CommandPipeline::responseHandler
+{
+public:
+
+	retrieveResponseHandler(utility::outputStream* os, const size_t size,
+	                        utility::progressListener* progress,
+	                        size_t* current, const size_t total)
+		: m_os(os), m_size(size), m_progress(progress),
+		  m_current(current), m_total(total)
+	{
+	}
+
+	void handleResponse(shared_ptr <POP3Connection> conn)
+	{
+		try
+		{
+			POP3Response::readLargeResponse(conn, *m_os, NULL, m_size);
+		}
+		catch (exceptions::command_error& e)
+		{
+			throw exceptions::command_error("RETR", e.response());
+		}
+
+		if (m_progress)
+			m_progress->progress(++(*m_current), m_total);
+	}
+
+private:
+
+	utility::outputStream* m_os;
+	size_t m_size;
+	utility::progressListener* m_progress;
+	size_t* m_current;
+	size_t m_total;
+};
+
+
 POP3Folder::POP3Folder(const folder::path& path, shared_ptr <POP3Store> store)
 	: m_store(store), m_path(path),
 	  m_name(path.isEmpty() ? folder::path::component("") : path.getLastComponent()),
@@ -61,7 +173,18 @@ POP3Folder::~POP3Folder()
 	if (store)
 	{
 		if (m_open)
-			close(false);
+		{
+			try
+			{
+				close(false);
+			}
+			catch (vmime::exception&)
+			{
+				// Connection lost: just release the messages
+				m_open = false;
+				onClose();
+			}
+		}
 
 		store->unregisterFolder(this);
 	}
@@ -176,8 +299,14 @@ void POP3Folder::close(const bool expunge)
 
 void POP3Folder::onClose()
 {
-	for (MessageMap::iterator it = m_messages.begin() ; it != m_messages.end() ; ++it)
-		(*it).first->onFolderClosed();
+	std::vector <std::pair <size_t, POP3Message*> > msgs;
+	m_messages.getMessages(msgs);
+
+	for (std::vector <std::pair <size_t, POP3Message*> >::iterator it = msgs.begin() ;
+	     it != msgs.end() ; ++it)
+	{
+		(*it).second->onFolderClosed();
+	}
 
 	m_messages.clear();
 }
@@ -315,30 +444,58 @@ void POP3Folder::fetchMessages(std::vector <shared_ptr <message> >& msg, const f
 	else if (!isOpen())
 		throw exceptions::illegal_state("Folder not open");
 
+	// STRUCTURE and FLAGS attributes are not supported by POP3
+	if (options.has(fetchAttributes::STRUCTURE | fetchAttributes::FLAGS))
+		throw exceptions::operation_not_supported();
+
 	const size_t total = msg.size();
 	size_t current = 0;
 
 	if (progress)
 		progress->start(total);
 
-	for (std::vector <shared_ptr <message> >::iterator it = msg.begin() ;
-	     it != msg.end() ; ++it)
+	// Send all the commands needed at once, if the server supports
+	// pipelining, instead of waiting for each response in turn
+	shared_ptr <POP3Connection> conn = store->getConnection();
+	shared_ptr <POP3CommandPipeline> pipeline =
+		POP3CommandPipeline::create(conn, conn->canPipeline());
+
+	std::vector <shared_ptr <headerResponseHandler> > headerHandlers;
+
+	if (options.isHeaderRequired())
 	{
-		dynamicCast <POP3Message>(*it)->fetch
-			(dynamicCast <POP3Folder>(shared_from_this()), options);
+		headerHandlers.reserve(msg.size());
 
-		if (progress)
-			progress->progress(++current, total);
+		for (std::vector <shared_ptr <message> >::iterator it = msg.begin() ;
+		     it != msg.end() ; ++it)
+		{
+			shared_ptr <POP3Message> m = dynamicCast <POP3Message>(*it);
+
+			if (m->m_folder.lock() != dynamicCast <POP3Folder>(shared_from_this()))
+				throw exceptions::folder_not_found();
+
+			shared_ptr <headerResponseHandler> handler =
+				make_shared <headerResponseHandler>(m, options, progress, &current, total);
+
+			headerHandlers.push_back(handler);
+			pipeline->addCommand(POP3Command::TOP(m->m_num, 0), handler.get());
+		}
 	}
 
+	multilineResponseHandler listHandler;
+	multilineResponseHandler uidlHandler;
+
 	if (options.has(fetchAttributes::SIZE))
-	{
-		// Send the "LIST" command
-		POP3Command::LIST()->send(store->getConnection());
+		pipeline->addCommand(POP3Command::LIST(), &listHandler);
 
-		// Get the response
-		shared_ptr <POP3Response> response =
-			POP3Response::readMultilineResponse(store->getConnection());
+	if (options.has(fetchAttributes::UID))
+		pipeline->addCommand(POP3Command::UIDL(), &uidlHandler);
+
+	pipeline->execute();
+
+	if (options.has(fetchAttributes::SIZE))
+	{
+		shared_ptr <POP3Response> response = listHandler.getResponse();
 
 		if (response->isSuccess())
 		{
@@ -373,12 +530,7 @@ void POP3Folder::fetchMessages(std::vector <shared_ptr <message> >& msg, const f
 
 	if (options.has(fetchAttributes::UID))
 	{
-		// Send the "UIDL" command
-		POP3Command::UIDL()->send(store->getConnection());
-
-		// Get the response
-		shared_ptr <POP3Response> response =
-			POP3Response::readMultilineResponse(store->getConnection());
+		shared_ptr <POP3Response> response = uidlHandler.getResponse();
 
 		if (response->isSuccess())
 		{
@@ -408,6 +560,55 @@ void POP3Folder::fetchMessages(std::vector <shared_ptr <message> >& msg, const f
 }
 
 
+void POP3Folder::extractMessages
+	(const std::vector <shared_ptr <message> >& msg,
+	 const std::vector <utility::outputStream*>& os,
+	 utility::progressListener* progress)
+{
+	shared_ptr <POP3Store> store = m_store.lock();
+
+	if (msg.size() != os.size())
+		throw exceptions::invalid_argument();
+
+	if (!store)
+		throw exceptions::illegal_state("Store disconnected");
+	else if (!isOpen())
+		throw exceptions::illegal_state("Folder not open");
+
+	const size_t total = msg.size();
+	size_t current = 0;
+
+	shared_ptr <POP3Connection> conn = store->getConnection();
+	shared_ptr <POP3CommandPipeline> pipeline =
+		POP3CommandPipeline::create(conn, conn->canPipeline());
+
+	std::vector <shared_ptr <retrieveResponseHandler> > handlers;
+	handlers.reserve(total);
+
+	for (size_t i = 0 ; i < total ; ++i)
+	{
+		shared_ptr <POP3Message> m = dynamicCast <POP3Message>(msg[i]);
+
+		if (!m || m->m_folder.lock() != dynamicCast <POP3Folder>(shared_from_this()))
+			throw exceptions::folder_not_found();
+
+		shared_ptr <retrieveResponseHandler> handler =
+			make_shared <retrieveResponseHandler>(os[i], m->m_size, progress, &current, total);
+
+		handlers.push_back(handler);
+		pipeline->addCommand(POP3Command::RETR(m->m_num), handler.get());
+	}
+
+	if (progress)
+		progress->start(total);
+
+	pipeline->execute();
+
+	if (progress)
+		progress->stop(total);
+}
+
+
 void POP3Folder::fetchMessage(shared_ptr <message> msg, const fetchAttributes& options)
 {
 	shared_ptr <POP3Store> store = m_store.lock();
@@ -513,15 +714,16 @@ shared_ptr <store> POP3Folder::getStore()
 }
 
 
-void POP3Folder::registerMessage(POP3Message* msg)
+size_t POP3Folder::registerMessage(POP3Message* msg, const int num)
 {
-	m_messages.insert(MessageMap::value_type(msg, msg->getNumber()));
+	// Message numbers do not change during a POP3 session
+	return m_messages.add(msg, num);
 }
 
 
-void POP3Folder::unregisterMessage(POP3Message* msg)
+void POP3Folder::unregisterMessage(POP3Message* msg, const size_t slot)
 {
-	m_messages.erase(msg);
+	m_messages.remove(msg, slot);
 }
 
 
@@ -545,18 +747,20 @@ void POP3Folder::deleteMessages(const messageSet& msgs)
 	else if (!isOpen())
 		throw exceptions::illegal_state("Folder not open");
 
+	shared_ptr <POP3Connection> conn = store->getConnection();
+	shared_ptr <POP3CommandPipeline> pipeline =
+		POP3CommandPipeline::create(conn, conn->canPipeline());
+
+	deleteResponseHandler handler;
+
 	for (std::vector <int>::const_iterator
 	     it = nums.begin() ; it != nums.end() ; ++it)
 	{
-		POP3Command::DELE(*it)->send(store->getConnection());
-
-		shared_ptr <POP3Response> response =
-			POP3Response::readResponse(store->getConnection());
-
-		if (!response->isSuccess())
-			throw exceptions::command_error("DELE", response->getFirstLine());
+		pipeline->addCommand(POP3Command::DELE(*it), &handler);
 	}
 
+	pipeline->execute();
+
 	// Sort message list
 	std::vector <int> list;
 
@@ -566,14 +770,13 @@ void POP3Folder::deleteMessages(const messageSet& msgs)
 	std::sort(list.begin(), list.end());
 
 	// Update local flags
-	for (std::map <POP3Message*, int>::iterator it =
-	     m_messages.begin() ; it != m_messages.end() ; ++it)
-	{
-		POP3Message* msg = (*it).first;
+	std::vector <POP3Message*> deleted;
 
-		if (std::binary_search(list.begin(), list.end(), msg->getNumber()))
-			msg->m_deleted = true;
-	}
+	for (std::vector <int>::const_iterator it = list.begin() ; it != list.end() ; ++it)
+		m_messages.find(*it, deleted);
+
+	for (std::vector <POP3Message*>::iterator it = deleted.begin() ; it != deleted.end() ; ++it)
+		(*it)->m_deleted = true;
 
 	// Notify message flags changed
 	shared_ptr <events::messageChangedEvent> event =
@@ -37,6 +37,7 @@
 #include "vmime/types.hpp"
 
 #include "vmime/net/folder.hpp"
+#include "vmime/net/messageRegistry.hpp"
 
 
 namespace vmime {
@@ -118,12 +119,38 @@ public:
 
 	int getFetchCapabilities() const;
 
+	/** Retrieves the contents of several messages. If the server
+	  * supports pipelining, the "RETR" commands are sent without waiting
+	  * for the previous message to be received, which saves one round
+	  * trip per message.
+	  *
+	  * The contents of each message is written to the corresponding
+	  * stream in 'os' as soon as it is received, so that the messages
+	  * are never held in memory.
+	  *
+	  * @param msg messages to retrieve (must belong to this folder)
+	  * @param os output streams, one for each message in 'msg'
+	  * @param progress progress listener, notified once per message
+	  * received, or NULL if not used
+	  * @throw exceptions::command_error if a message could not be
+	  * retrieved; the other messages are still received
+	  */
+	void extractMessages
+		(const std::vector <shared_ptr <message> >& msg,
+		 const std::vector <utility::outputStream*>& os,
+		 utility::progressListener* progress = NULL);
+
 	std::vector <int> getMessageNumbersStartingOnUID(const message::uid& uid);
 
 private:
 
-	void registerMessage(POP3Message* msg);
-	void unregisterMessage(POP3Message* msg);
+	class headerResponseHandler;
+	class multilineResponseHandler;
+	class deleteResponseHandler;
+	class retrieveResponseHandler;
+
+	size_t registerMessage(POP3Message* msg, const int num);
+	void unregisterMessage(POP3Message* msg, const size_t slot);
 
 	void onStoreDisconnected();
 
@@ -140,8 +167,7 @@ private:
 
 	int m_messageCount;
 
-	typedef std::map <POP3Message*, int> MessageMap;
-	MessageMap m_messages;
+	messageRegistry <POP3Message> m_messages;
 };
 
 
@@ -47,7 +47,7 @@ namespace pop3 {
 POP3Message::POP3Message(shared_ptr <POP3Folder> folder, const int num)
 	: m_folder(folder), m_num(num), m_size(-1), m_deleted(false)
 {
-	folder->registerMessage(this);
+	m_slot = folder->registerMessage(this, num);
 }
 
 
@@ -56,7 +56,7 @@ POP3Message::~POP3Message()
 	shared_ptr <POP3Folder> folder = m_folder.lock();
 
 	if (folder)
-		folder->unregisterMessage(this);
+		folder->unregisterMessage(this, m_slot);
 }
 
 
@@ -186,33 +186,38 @@ void POP3Message::fetch(shared_ptr <POP3Folder> msgFolder, const fetchAttributes
 	if (options.has(fetchAttributes::STRUCTURE | fetchAttributes::FLAGS))
 		throw exceptions::operation_not_supported();
 
-	// Check for the real need to fetch the full header
-	static const int optionsRequiringHeader =
-		fetchAttributes::ENVELOPE | fetchAttributes::CONTENT_INFO |
-		fetchAttributes::FULL_HEADER | fetchAttributes::IMPORTANCE;
-
-	if (!options.has(optionsRequiringHeader))
+	if (!options.isHeaderRequired())
 		return;
 
-	// No need to differenciate between ENVELOPE, CONTENT_INFO, ...
-	// since POP3 only permits to retrieve the whole header and not
-	// fields in particular.
-
 	// Emit the "TOP" command
 	shared_ptr <POP3Store> store = folder->m_store.lock();
 
 	POP3Command::TOP(m_num, 0)->send(store->getConnection());
 
+	readHeader(store->getConnection(), options);
+}
+
+
+void POP3Message::readHeader(shared_ptr <POP3Connection> conn, const fetchAttributes& options)
+{
 	try
 	{
 		string buffer;
 		utility::outputStreamStringAdapter bufferStream(buffer);
 
-		POP3Response::readLargeResponse(store->getConnection(),
+		// POP3 only permits to retrieve the whole header, and the response
+		// has to be read completely to keep the connection synchronized
+		POP3Response::readLargeResponse(conn,
 			bufferStream, /* progress */ NULL, /* predictedSize */ 0);
 
+		// Skip the fields which have not been requested
+		parsingContext ctx(parsingContext::getDefaultContext());
+
+		if (!options.has(fetchAttributes::FULL_HEADER))
+			ctx.setHeaderFieldFilter(options.getRequiredHeaderFields());
+
 		m_header = make_shared <header>();
-		m_header->parse(buffer);
+		m_header->parse(ctx, buffer);
 	}
 	catch (exceptions::command_error& e)
 	{
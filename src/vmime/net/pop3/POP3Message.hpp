@@ -41,6 +41,7 @@ namespace pop3 {
 
 
 class POP3Folder;
+class POP3Connection;
 
 
 /** POP3 message implementation.
@@ -98,10 +99,21 @@ private:
 
 	void fetch(shared_ptr <POP3Folder> folder, const fetchAttributes& options);
 
+	/** Reads the response to a "TOP <num> 0" command previously sent
+	  * on the connection, and parses the message header from it.
+	  * Unless the full header is requested, only the header fields
+	  * needed for the fetch attributes are parsed.
+	  *
+	  * @param conn connection from which to read the response
+	  * @param options fetch attributes
+	  */
+	void readHeader(shared_ptr <POP3Connection> conn, const fetchAttributes& options);
+
 	void onFolderClosed();
 
 	weak_ptr <POP3Folder> m_folder;
 	int m_num;
+	size_t m_slot;
 	uid m_uid;
 	size_t m_size;
 
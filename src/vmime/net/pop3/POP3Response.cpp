@@ -33,9 +33,7 @@
 #include "vmime/platform.hpp"
 
 #include "vmime/utility/stringUtils.hpp"
-#include "vmime/utility/filteredStream.hpp"
-#include "vmime/utility/stringUtils.hpp"
-#include "vmime/utility/inputStreamSocketAdapter.hpp"
+#include "vmime/utility/instrumentation.hpp"
 
 #include "vmime/net/socket.hpp"
 #include "vmime/net/timeoutHandler.hpp"
@@ -47,7 +45,7 @@ namespace pop3 {
 
 
 POP3Response::POP3Response(shared_ptr <socket> sok, shared_ptr <timeoutHandler> toh)
-	: m_socket(sok), m_timeoutHandler(toh)
+	: m_socket(sok), m_timeoutHandler(toh), m_responseBufferPos(0), m_code(CODE_ERR)
 {
 }
 
@@ -58,12 +56,22 @@ shared_ptr <POP3Response> POP3Response::readResponse(shared_ptr <POP3Connection>
 	shared_ptr <POP3Response> resp = shared_ptr <POP3Response>
 		(new POP3Response(conn->getSocket(), conn->getTimeoutHandler()));
 
-	string buffer;
-	resp->readResponseImpl(buffer, /* multiLine */ false);
+	resp->restoreState(conn);
+
+	try
+	{
+		resp->readResponseImpl(/* multiLine */ false);
+	}
+	catch (...)
+	{
+		resp->saveState(conn);
+		throw;
+	}
+
+	resp->saveState(conn);
 
-	resp->m_firstLine = buffer;
-	resp->m_code = getResponseCode(buffer);
-	stripResponseCode(buffer, resp->m_text);
+	if (utility::instrumentation::isEnabled())
+		conn->onResponseReceived();
 
 	return resp;
 }
@@ -75,21 +83,22 @@ shared_ptr <POP3Response> POP3Response::readMultilineResponse(shared_ptr <POP3Co
 	shared_ptr <POP3Response> resp = shared_ptr <POP3Response>
 		(new POP3Response(conn->getSocket(), conn->getTimeoutHandler()));
 
-	string buffer;
-	resp->readResponseImpl(buffer, /* multiLine */ true);
-
-	string firstLine, nextLines;
-	stripFirstLine(buffer, nextLines, &firstLine);
+	resp->restoreState(conn);
 
-	resp->m_firstLine = firstLine;
-	resp->m_code = getResponseCode(firstLine);
-	stripResponseCode(firstLine, resp->m_text);
+	try
+	{
+		resp->readResponseImpl(/* multiLine */ true);
+	}
+	catch (...)
+	{
+		resp->saveState(conn);
+		throw;
+	}
 
-	std::istringstream iss(nextLines);
-	string line;
+	resp->saveState(conn);
 
-	while (std::getline(iss, line, '\n'))
-		resp->m_lines.push_back(utility::stringUtils::trim(line));
+	if (utility::instrumentation::isEnabled())
+		conn->onResponseReceived();
 
 	return resp;
 }
@@ -103,12 +112,22 @@ shared_ptr <POP3Response> POP3Response::readLargeResponse
 	shared_ptr <POP3Response> resp = shared_ptr <POP3Response>
 		(new POP3Response(conn->getSocket(), conn->getTimeoutHandler()));
 
-	string firstLine;
-	resp->readResponseImpl(firstLine, os, progress, predictedSize);
+	resp->restoreState(conn);
 
-	resp->m_firstLine = firstLine;
-	resp->m_code = getResponseCode(firstLine);
-	stripResponseCode(firstLine, resp->m_text);
+	try
+	{
+		resp->readResponseImpl(os, progress, predictedSize);
+	}
+	catch (...)
+	{
+		resp->saveState(conn);
+		throw;
+	}
+
+	resp->saveState(conn);
+
+	if (utility::instrumentation::isEnabled())
+		conn->onResponseReceived();
 
 	return resp;
 }
@@ -150,18 +169,26 @@ size_t POP3Response::getLineCount() const
 }
 
 
-void POP3Response::readResponseImpl(string& buffer, const bool multiLine)
+void POP3Response::restoreState(shared_ptr <POP3Connection> conn)
 {
-	bool foundTerminator = false;
+	m_responseBuffer.swap(conn->m_responseState.responseBuffer);
+	m_responseBufferPos = 0;
+}
 
-	if (m_timeoutHandler)
-		m_timeoutHandler->resetTimeOut();
 
-	buffer.clear();
+void POP3Response::saveState(shared_ptr <POP3Connection> conn)
+{
+	// Keep data which has not been consumed by this response
+	m_responseBuffer.erase(0, m_responseBufferPos);
+	m_responseBufferPos = 0;
+
+	m_responseBuffer.swap(conn->m_responseState.responseBuffer);
+}
 
-	char last1 = '\0', last2 = '\0';
 
-	for ( ; !foundTerminator ; )
+void POP3Response::receiveData()
+{
+	for ( ; ; )
 	{
 		// Check whether the time-out delay is elapsed
 		if (m_timeoutHandler && m_timeoutHandler->isTimeOut())
@@ -190,135 +217,139 @@ void POP3Response::readResponseImpl(string& buffer, const bool multiLine)
 		if (m_timeoutHandler)
 			m_timeoutHandler->resetTimeOut();
 
-		// Check for transparent characters: '\n..' becomes '\n.'
-		const char first = receiveBuffer[0];
+		// Discard data already consumed, and append new data
+		m_responseBuffer.erase(0, m_responseBufferPos);
+		m_responseBufferPos = 0;
 
-		if (first == '.' && last2 == '\n' && last1 == '.')
-		{
-			receiveBuffer.erase(receiveBuffer.begin());
-		}
-		else if (receiveBuffer.length() >= 2 && first == '.' &&
-		         receiveBuffer[1] == '.' && last1 == '\n')
-		{
-			receiveBuffer.erase(receiveBuffer.begin());
-		}
+		m_responseBuffer += receiveBuffer;
 
-		for (size_t trans ;
-		     string::npos != (trans = receiveBuffer.find("\n..")) ; )
-		{
-			receiveBuffer.replace(trans, 3, "\n.");
-		}
+		break;
+	}
+}
 
-		last1 = receiveBuffer[receiveBuffer.length() - 1];
-		last2 = static_cast <char>((receiveBuffer.length() >= 2) ? receiveBuffer[receiveBuffer.length() - 2] : 0);
 
-		// Append the data to the response buffer
-		buffer += receiveBuffer;
+void POP3Response::readLine(string& line)
+{
+	size_t eol;
 
-		// Check for terminator string (and strip it if present)
-		foundTerminator = checkTerminator(buffer, multiLine);
+	while ((eol = m_responseBuffer.find('\n', m_responseBufferPos)) == string::npos)
+		receiveData();
 
-		// If there is an error (-ERR) when executing a command that
-		// requires a multi-line response, the error response will
-		// include only one line, so we stop waiting for a multi-line
-		// terminator and check for a "normal" one.
-		if (multiLine && !foundTerminator && buffer.length() >= 4 && buffer[0] == '-')
-		{
-			foundTerminator = checkTerminator(buffer, false);
-		}
+	line.assign(m_responseBuffer, m_responseBufferPos, eol + 1 - m_responseBufferPos);
+
+	m_responseBufferPos = eol + 1;
+}
+
+
+void POP3Response::readResponseImpl(const bool multiLine)
+{
+	if (m_timeoutHandler)
+		m_timeoutHandler->resetTimeOut();
+
+	string line;
+	readLine(line);
+
+	m_firstLine = utility::stringUtils::trim(line);
+	m_code = getResponseCode(m_firstLine);
+	stripResponseCode(m_firstLine, m_text);
+
+	// If there is an error (-ERR) when executing a command that
+	// requires a multi-line response, the error response will
+	// include only one line.
+	if (!multiLine || m_code != CODE_OK)
+		return;
+
+	for ( ; ; )
+	{
+		readLine(line);
+
+		if (isTerminator(line, 0, line.length()))
+			break;
+
+		// Check for transparent characters: '..' becomes '.'
+		if (line[0] == '.')
+			line.erase(line.begin());
+
+		m_lines.push_back(utility::stringUtils::trim(line));
 	}
 }
 
 
 void POP3Response::readResponseImpl
-	(string& firstLine, utility::outputStream& os,
-	 utility::progressListener* progress, const size_t predictedSize)
+	(utility::outputStream& os, utility::progressListener* progress,
+	 const size_t predictedSize)
 {
 	size_t current = 0, total = predictedSize;
 
-	string temp;
-	bool codeDone = false;
-
 	if (progress)
 		progress->start(total);
 
 	if (m_timeoutHandler)
 		m_timeoutHandler->resetTimeOut();
 
-	utility::inputStreamSocketAdapter sis(*m_socket);
-	utility::stopSequenceFilteredInputStream <5> sfis1(sis, "\r\n.\r\n");
-	utility::stopSequenceFilteredInputStream <3> sfis2(sfis1, "\n.\n");
-	utility::dotFilteredInputStream dfis(sfis2);   // "\n.." --> "\n."
+	// Read response code
+	string line;
+	readLine(line);
+
+	m_firstLine = utility::stringUtils::trim(line);
+	m_code = getResponseCode(m_firstLine);
+	stripResponseCode(m_firstLine, m_text);
 
-	utility::inputStream& is = dfis;
+	if (m_code != CODE_OK)
+		throw exceptions::command_error("?", m_firstLine);
 
-	while (!is.eof())
+	// Read response data. The line terminator of the last line is
+	// not part of the data, so it is written only when we know that
+	// another line follows.
+	string pendingEOL;
+	bool foundTerminator = false;
+
+	while (!foundTerminator)
 	{
-#if 0 // not supported
-		// Check for possible cancellation
-		if (progress && progress->cancel())
-			throw exceptions::operation_cancelled();
-#endif
+		string data;
+		size_t eol;
 
-		// Check whether the time-out delay is elapsed
-		if (m_timeoutHandler && m_timeoutHandler->isTimeOut())
+		while (!foundTerminator &&
+		       (eol = m_responseBuffer.find('\n', m_responseBufferPos)) != string::npos)
 		{
-			if (!m_timeoutHandler->handleTimeOut())
-				throw exceptions::operation_timed_out();
-		}
+			const size_t lineStart = m_responseBufferPos;
+			const size_t lineLength = eol + 1 - lineStart;
 
-		// Receive data from the socket
-		byte_t buffer[65536];
-		const size_t read = is.read(buffer, sizeof(buffer));
+			m_responseBufferPos = eol + 1;
+			current += lineLength;
 
-		if (read == 0)   // buffer is empty
-		{
-			if (m_socket->getStatus() & socket::STATUS_WANT_WRITE)
-				m_socket->waitForWrite();
-			else
-				m_socket->waitForRead();
+			if (isTerminator(m_responseBuffer, lineStart, lineLength))
+			{
+				foundTerminator = true;
+				break;
+			}
 
-			continue;
+			const size_t eolLength =
+				(lineLength >= 2 && m_responseBuffer[eol - 1] == '\r') ? 2 : 1;
+
+			// Check for transparent characters: '..' becomes '.'
+			const size_t dataStart =
+				(m_responseBuffer[lineStart] == '.') ? lineStart + 1 : lineStart;
+
+			data += pendingEOL;
+			data.append(m_responseBuffer, dataStart, eol + 1 - eolLength - dataStart);
+
+			pendingEOL.assign(m_responseBuffer, eol + 1 - eolLength, eolLength);
 		}
 
-		// We have received data: reset the time-out counter
-		if (m_timeoutHandler)
-			m_timeoutHandler->resetTimeOut();
+		// Inject the data into the output stream
+		if (!data.empty())
+			os.write(data.data(), data.length());
 
 		// Notify progress
-		current += read;
-
 		if (progress)
 		{
 			total = std::max(total, current);
 			progress->progress(current, total);
 		}
 
-		// If we don't have extracted the response code yet
-		if (!codeDone)
-		{
-			vmime::utility::stringUtils::appendBytesToString(temp, buffer, read);
-
-			string responseData;
-
-			if (stripFirstLine(temp, responseData, &firstLine) == true)
-			{
-				if (getResponseCode(firstLine) != CODE_OK)
-					throw exceptions::command_error("?", firstLine);
-
-				codeDone = true;
-
-				os.write(responseData.data(), responseData.length());
-				temp.clear();
-
-				continue;
-			}
-		}
-		else
-		{
-			// Inject the data into the output stream
-			os.write(buffer, read);
-		}
+		if (!foundTerminator)
+			receiveData();
 	}
 
 	if (progress)
@@ -326,27 +357,6 @@ void POP3Response::readResponseImpl
 }
 
 
-// static
-bool POP3Response::stripFirstLine
-	(const string& buffer, string& result, string* firstLine)
-{
-	const size_t end = buffer.find('\n');
-
-	if (end != string::npos)
-	{
-		if (firstLine) *firstLine = utility::stringUtils::trim(buffer.substr(0, end));
-		result = buffer.substr(end + 1);
-		return true;
-	}
-	else
-	{
-		if (firstLine) *firstLine = utility::stringUtils::trim(buffer);
-		result = "";
-		return false;
-	}
-}
-
-
 // static
 POP3Response::ResponseCode POP3Response::getResponseCode(const string& buffer)
 {
@@ -389,39 +399,21 @@ void POP3Response::stripResponseCode(const string& buffer, string& result)
 
 
 // static
-bool POP3Response::checkTerminator(string& buffer, const bool multiLine)
+bool POP3Response::isTerminator
+	(const string& buffer, const size_t lineStart, const size_t lineLength)
 {
-	// Multi-line response
-	if (multiLine)
+	// Multi-line response is terminated by a line
+	// containing only a dot: ".\r\n" (or ".\n")
+	if (lineLength == 3)
 	{
-		static const string term1("\r\n.\r\n");
-		static const string term2("\n.\n");
-
-		return (checkOneTerminator(buffer, term1) ||
-		        checkOneTerminator(buffer, term2));
-	}
-	// Normal response
-	else
-	{
-		static const string term1("\r\n");
-		static const string term2("\n");
-
-		return (checkOneTerminator(buffer, term1) ||
-		        checkOneTerminator(buffer, term2));
+		return buffer[lineStart] == '.' &&
+		       buffer[lineStart + 1] == '\r' &&
+		       buffer[lineStart + 2] == '\n';
 	}
-
-	return false;
-}
-
-
-// static
-bool POP3Response::checkOneTerminator(string& buffer, const string& term)
-{
-	if (buffer.length() >= term.length() &&
-		std::equal(buffer.end() - term.length(), buffer.end(), term.begin()))
+	else if (lineLength == 2)
 	{
-		buffer.erase(buffer.end() - term.length(), buffer.end());
-		return true;
+		return buffer[lineStart] == '.' &&
+		       buffer[lineStart + 1] == '\n';
 	}
 
 	return false;
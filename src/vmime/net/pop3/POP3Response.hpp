@@ -67,6 +67,15 @@ public:
 		CODE_ERR
 	};
 
+	/** Current state of response parser. */
+	struct state
+	{
+		/** Data received from the server which does not belong to the
+		  * response that has just been read (eg. when commands are
+		  * pipelined, the beginning of the next response). */
+		string responseBuffer;
+	};
+
 
 	/** Receive and parse a POP3 response from the
 	  * specified connection.
@@ -145,25 +154,31 @@ private:
 
 	POP3Response(shared_ptr <socket> sok, shared_ptr <timeoutHandler> toh);
 
-	void readResponseImpl(string& buffer, const bool multiLine);
-	void readResponseImpl
-		(string& firstLine, utility::outputStream& os,
-		 utility::progressListener* progress, const size_t predictedSize);
+	void restoreState(shared_ptr <POP3Connection> conn);
+	void saveState(shared_ptr <POP3Connection> conn);
+
+	void receiveData();
+	void readLine(string& line);
 
+	void readResponseImpl(const bool multiLine);
+	void readResponseImpl
+		(utility::outputStream& os, utility::progressListener* progress,
+		 const size_t predictedSize);
 
-	static bool stripFirstLine(const string& buffer, string& result, string* firstLine);
 
 	static ResponseCode getResponseCode(const string& buffer);
 
 	static void stripResponseCode(const string& buffer, string& result);
 
-	static bool checkTerminator(string& buffer, const bool multiLine);
-	static bool checkOneTerminator(string& buffer, const string& term);
+	static bool isTerminator(const string& buffer, const size_t lineStart, const size_t lineLength);
 
 
 	shared_ptr <socket> m_socket;
 	shared_ptr <timeoutHandler> m_timeoutHandler;
 
+	string m_responseBuffer;
+	size_t m_responseBufferPos;
+
 	string m_firstLine;
 	ResponseCode m_code;
 	string m_text;
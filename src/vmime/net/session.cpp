@@ -32,6 +32,7 @@
 
 #include "vmime/net/store.hpp"
 #include "vmime/net/transport.hpp"
+#include "vmime/net/transportPool.hpp"
 
 
 namespace vmime {
@@ -126,6 +127,33 @@ shared_ptr <store> session::getStore
 }
 
 
+shared_ptr <transportPool> session::getTransportPool
+	(const utility::url& url, shared_ptr <security::authenticator> auth)
+{
+	const string key = url;
+
+	std::map <string, weak_ptr <transportPool> >::iterator
+		it = m_transportPools.find(key);
+
+	shared_ptr <transportPool> pool;
+
+	if (it != m_transportPools.end())
+		pool = (*it).second.lock();
+
+	if (!pool)
+	{
+		// The pool holds a reference to the session, so only a weak
+		// reference to the pool is kept here
+		pool = make_shared <transportPool>
+			(dynamicCast <session>(shared_from_this()), url, auth);
+
+		m_transportPools[key] = pool;
+	}
+
+	return pool;
+}
+
+
 const propertySet& session::getProperties() const
 {
 	return (m_props);
@@ -39,6 +39,8 @@
 
 #include "vmime/propertySet.hpp"
 
+#include <map>
+
 
 namespace vmime {
 namespace net {
@@ -46,6 +48,7 @@ namespace net {
 
 class store;
 class transport;
+class transportPool;
 
 
 /** An object that contains all the information needed
@@ -141,6 +144,20 @@ public:
 		(const utility::url& url,
 		 shared_ptr <security::authenticator> auth = null);
 
+	/** Return a pool of connections to the transport service at the
+	  * specified URL. The same pool is returned for the same URL, as
+	  * long as a reference to it is held by the caller.
+	  *
+	  * @param url full URL with at least the protocol to use (eg: "smtp://myserver.com/")
+	  * @param auth authenticator object to use for the transport services
+	  * created by the pool, if the pool does not exist yet. If NULL, a default
+	  * one is used.
+	  * @return pool of transport services
+	  */
+	shared_ptr <transportPool> getTransportPool
+		(const utility::url& url,
+		 shared_ptr <security::authenticator> auth = null);
+
 	/** Properties for the session and for the services.
 	  */
 	const propertySet& getProperties() const;
@@ -166,6 +183,8 @@ private:
 	propertySet m_props;
 
 	shared_ptr <tls::TLSProperties> m_tlsProps;
+
+	std::map <string, weak_ptr <transportPool> > m_transportPools;
 };
 
 
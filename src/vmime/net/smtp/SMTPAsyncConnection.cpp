@@ -0,0 +1,108 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
+
+
+#include "vmime/net/smtp/SMTPAsyncConnection.hpp"
+
+#include "vmime/utility/encoder/encoderFactory.hpp"
+#include "vmime/utility/inputStreamStringAdapter.hpp"
+#include "vmime/utility/outputStreamStringAdapter.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace smtp {
+
+
+SMTPAsyncConnection::SMTPAsyncConnection()
+{
+}
+
+
+void SMTPAsyncConnection::expectGreeting(shared_ptr <asyncResponseHandler> handler)
+{
+	expectResponse(handler);
+}
+
+
+void SMTPAsyncConnection::hello(const string& domain, shared_ptr <asyncResponseHandler> handler)
+{
+	sendCommand("EHLO " + domain, handler);
+}
+
+
+void SMTPAsyncConnection::authenticate
+	(const string& username, const string& password, shared_ptr <asyncResponseHandler> handler)
+{
+	// RFC-4616: [authzid] NUL authcid NUL passwd
+	string credentials;
+	credentials += '\0';
+	credentials += username;
+	credentials += '\0';
+	credentials += password;
+
+	string encoded;
+
+	utility::inputStreamStringAdapter is(credentials);
+	utility::outputStreamStringAdapter os(encoded);
+
+	utility::encoder::encoderFactory::getInstance()->create("base64")->encode(is, os);
+
+	sendCommand("AUTH PLAIN " + encoded, handler);
+}
+
+
+const string SMTPAsyncConnection::prepareCommand(const string& command, pendingResponse& /* resp */)
+{
+	return command + "\r\n";
+}
+
+
+bool SMTPAsyncConnection::processResponseLine(pendingResponse& resp, const string& line)
+{
+	resp.lines.push_back(line);
+
+	// Continuation lines have a '-' after the reply code
+	return line.length() < 4 || line[3] != '-';
+}
+
+
+bool SMTPAsyncConnection::isSuccessResponse(const std::vector <string>& lines) const
+{
+	return !lines.empty() && !lines.back().empty() &&
+		(lines.back()[0] == '2' || lines.back()[0] == '3');
+}
+
+
+} // smtp
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
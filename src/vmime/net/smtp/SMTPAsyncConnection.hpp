@@ -0,0 +1,90 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_SMTP_SMTPASYNCCONNECTION_HPP_INCLUDED
+#define VMIME_NET_SMTP_SMTPASYNCCONNECTION_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
+
+
+#include "vmime/net/asyncConnection.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace smtp {
+
+
+/** An asynchronous connection to a SMTP server (see asyncEngine).
+  *
+  * A response contains all the lines of a (possibly multi-line) reply.
+  */
+class VMIME_EXPORT SMTPAsyncConnection : public asyncConnection
+{
+public:
+
+	SMTPAsyncConnection();
+
+	/** Wait for the greeting sent by the server after connection.
+	  *
+	  * @param handler handler to be notified of the greeting
+	  */
+	void expectGreeting(shared_ptr <asyncResponseHandler> handler);
+
+	/** Send the EHLO command.
+	  *
+	  * @param domain client domain name
+	  * @param handler handler to be notified of the response
+	  */
+	void hello(const string& domain, shared_ptr <asyncResponseHandler> handler);
+
+	/** Authenticate with the PLAIN mechanism.
+	  *
+	  * @param username user name
+	  * @param password password
+	  * @param handler handler to be notified of the response
+	  */
+	void authenticate(const string& username, const string& password, shared_ptr <asyncResponseHandler> handler);
+
+	bool isSuccessResponse(const std::vector <string>& lines) const;
+
+protected:
+
+	const string prepareCommand(const string& command, pendingResponse& resp);
+	bool processResponseLine(pendingResponse& resp, const string& line);
+};
+
+
+} // smtp
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
+
+#endif // VMIME_NET_SMTP_SMTPASYNCCONNECTION_HPP_INCLUDED
@@ -32,6 +32,9 @@
 #include "vmime/net/smtp/SMTPConnection.hpp"
 #include "vmime/net/smtp/SMTPTransport.hpp"
 
+#include "vmime/utility/bufferedOutputStreamSocketAdapter.hpp"
+#include "vmime/utility/instrumentation.hpp"
+
 #include <algorithm>
 
 
@@ -59,9 +62,18 @@ void SMTPChunkingOutputStreamAdapter::sendChunk
 		return;
 	}
 
-	// Send this chunk
-	m_connection->sendRequest(SMTPCommand::BDAT(count, last));
-	m_connection->getSocket()->sendRaw(data, count);
+	// Send this chunk; the command is sent along with the first bytes
+	// of data, instead of in a separate packet
+	shared_ptr <SMTPCommand> bdat = SMTPCommand::BDAT(count, last);
+	const string cmd = bdat->getText() + "\r\n";
+
+	utility::bufferedOutputStreamSocketAdapter os(*m_connection->getSocket());
+	os.write(cmd.data(), cmd.length());
+	os.write(data, count);
+	os.flush();
+
+	if (utility::instrumentation::isEnabled())
+		m_connection->onCommandSent(bdat->getText());
 
 	++m_chunkCount;
 
@@ -120,7 +132,7 @@ void SMTPChunkingOutputStreamAdapter::writeImpl
 		const size_t remaining = sizeof(m_buffer) - m_bufferSize;
 		const size_t bytesToCopy = std::min(remaining, curCount);
 
-		std::copy(data, data + bytesToCopy, m_buffer + m_bufferSize);
+		std::copy(curData, curData + bytesToCopy, m_buffer + m_bufferSize);
 
 		m_bufferSize += bytesToCopy;
 		curData += bytesToCopy;
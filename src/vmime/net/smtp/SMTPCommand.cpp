@@ -28,11 +28,14 @@
 
 
 #include "vmime/net/smtp/SMTPCommand.hpp"
+#include "vmime/net/smtp/SMTPConnection.hpp"
 
 #include "vmime/net/socket.hpp"
+#include "vmime/net/dsnAttributes.hpp"
 
 #include "vmime/mailbox.hpp"
 #include "vmime/utility/outputStreamAdapter.hpp"
+#include "vmime/utility/instrumentation.hpp"
 
 
 namespace vmime {
@@ -95,6 +98,14 @@ shared_ptr <SMTPCommand> SMTPCommand::MAIL(const mailbox& mbox, const bool utf8)
 
 // static
 shared_ptr <SMTPCommand> SMTPCommand::MAIL(const mailbox& mbox, const bool utf8, const size_t size)
+{
+	return MAIL(mbox, utf8, size, "", dsnAttributes());
+}
+
+
+// static
+shared_ptr <SMTPCommand> SMTPCommand::MAIL(const mailbox& mbox, const bool utf8, const size_t size,
+	const string& bodyType, const dsnAttributes& dsnAttrs)
 {
 	std::ostringstream cmd;
 	cmd.imbue(std::locale::classic());
@@ -118,12 +129,32 @@ shared_ptr <SMTPCommand> SMTPCommand::MAIL(const mailbox& mbox, const bool utf8,
 	if (size != 0)
 		cmd << " SIZE=" << size;
 
+	// 8BITMIME/BINARYMIME extensions (RFC-6152, RFC-3030)
+	if (!bodyType.empty())
+		cmd << " BODY=" << bodyType;
+
+	// DSN extension (RFC-3461)
+	if (dsnAttrs.getReturnType() == dsnAttributes::RETURN_FULL)
+		cmd << " RET=FULL";
+	else if (dsnAttrs.getReturnType() == dsnAttributes::RETURN_HEADERS)
+		cmd << " RET=HDRS";
+
+	if (!dsnAttrs.getEnvelopeId().empty())
+		cmd << " ENVID=" << encodeXText(dsnAttrs.getEnvelopeId());
+
 	return createCommand(cmd.str());
 }
 
 
 // static
 shared_ptr <SMTPCommand> SMTPCommand::RCPT(const mailbox& mbox, const bool utf8)
+{
+	return RCPT(mbox, utf8, dsnAttributes());
+}
+
+
+// static
+shared_ptr <SMTPCommand> SMTPCommand::RCPT(const mailbox& mbox, const bool utf8, const dsnAttributes& dsnAttrs)
 {
 	std::ostringstream cmd;
 	cmd.imbue(std::locale::classic());
@@ -141,10 +172,64 @@ shared_ptr <SMTPCommand> SMTPCommand::RCPT(const mailbox& mbox, const bool utf8)
 
 	cmd << ">";
 
+	// DSN extension (RFC-3461)
+	const int notify = dsnAttrs.getNotifyFlags();
+
+	if (notify & dsnAttributes::NOTIFY_NEVER)
+	{
+		cmd << " NOTIFY=NEVER";
+	}
+	else if (notify != 0)
+	{
+		string conds;
+
+		if (notify & dsnAttributes::NOTIFY_SUCCESS)
+			conds += ",SUCCESS";
+		if (notify & dsnAttributes::NOTIFY_FAILURE)
+			conds += ",FAILURE";
+		if (notify & dsnAttributes::NOTIFY_DELAY)
+			conds += ",DELAY";
+
+		cmd << " NOTIFY=" << conds.substr(1);
+	}
+
+	if (dsnAttrs.getSendOriginalRecipient())
+		cmd << " ORCPT=rfc822;" << encodeXText(mbox.getEmail().generate());
+
 	return createCommand(cmd.str());
 }
 
 
+// static
+const string SMTPCommand::encodeXText(const string& str)
+{
+	static const char hexChars[] = "0123456789ABCDEF";
+
+	string res;
+	res.reserve(str.length());
+
+	for (string::const_iterator it = str.begin() ; it != str.end() ; ++it)
+	{
+		const unsigned char c = static_cast <unsigned char>(*it);
+
+		// RFC-3461: xchar = any ASCII CHAR between "!" (33) and "~" (126)
+		// inclusive, except for "+" and "="
+		if (c >= 33 && c <= 126 && c != '+' && c != '=')
+		{
+			res += static_cast <char>(c);
+		}
+		else
+		{
+			res += '+';
+			res += hexChars[c >> 4];
+			res += hexChars[c & 0xf];
+		}
+	}
+
+	return res;
+}
+
+
 // static
 shared_ptr <SMTPCommand> SMTPCommand::RSET()
 {
@@ -206,6 +291,15 @@ void SMTPCommand::writeToSocket(shared_ptr <socket> sok)
 }
 
 
+void SMTPCommand::send(shared_ptr <SMTPConnection> conn)
+{
+	writeToSocket(conn->getSocket());
+
+	if (utility::instrumentation::isEnabled())
+		conn->onCommandSent(m_text);
+}
+
+
 } // smtp
 } // net
 } // vmime
@@ -46,11 +46,15 @@ namespace net {
 
 class socket;
 class timeoutHandler;
+class dsnAttributes;
 
 
 namespace smtp {
 
 
+class SMTPConnection;
+
+
 /** A SMTP command, as sent to server.
   */
 class VMIME_EXPORT SMTPCommand : public object
@@ -63,7 +67,10 @@ public:
 	static shared_ptr <SMTPCommand> STARTTLS();
 	static shared_ptr <SMTPCommand> MAIL(const mailbox& mbox, const bool utf8);
 	static shared_ptr <SMTPCommand> MAIL(const mailbox& mbox, const bool utf8, const size_t size);
+	static shared_ptr <SMTPCommand> MAIL(const mailbox& mbox, const bool utf8, const size_t size,
+		const string& bodyType, const dsnAttributes& dsnAttrs);
 	static shared_ptr <SMTPCommand> RCPT(const mailbox& mbox, const bool utf8);
+	static shared_ptr <SMTPCommand> RCPT(const mailbox& mbox, const bool utf8, const dsnAttributes& dsnAttrs);
 	static shared_ptr <SMTPCommand> RSET();
 	static shared_ptr <SMTPCommand> DATA();
 	static shared_ptr <SMTPCommand> BDAT(const size_t chunkSize, const bool last);
@@ -83,6 +90,13 @@ public:
 	  */
 	virtual void writeToSocket(shared_ptr <socket> sok);
 
+	/** Sends this command over the specified connection, and
+	  * notifies the connection of the command(s) sent.
+	  *
+	  * @param conn connection to which the command will be written
+	  */
+	virtual void send(shared_ptr <SMTPConnection> conn);
+
 	/** Returns the full text of the command, including command name
 	  * and parameters (if any).
 	  *
@@ -97,6 +111,14 @@ protected:
 
 private:
 
+	/** Encodes a string as "xtext", as defined in RFC-3461.
+	  *
+	  * @param str string to encode
+	  * @return encoded string
+	  */
+	static const string encodeXText(const string& str);
+
+
 	string m_text;
 };
 
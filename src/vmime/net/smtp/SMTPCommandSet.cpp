@@ -28,12 +28,15 @@
 
 
 #include "vmime/net/smtp/SMTPCommandSet.hpp"
+#include "vmime/net/smtp/SMTPConnection.hpp"
 
 #include "vmime/net/socket.hpp"
 
 #include "vmime/mailbox.hpp"
+#include "vmime/utility/instrumentation.hpp"
 
 #include <stdexcept>
+#include <vector>
 
 
 namespace vmime {
@@ -73,13 +76,19 @@ void SMTPCommandSet::writeToSocket(shared_ptr <socket> sok)
 	{
 		if (!m_started)
 		{
-			// Send all commands at once
+			// Send all commands at once, in a single write
+			string buffer;
+
 			for (std::list <shared_ptr <SMTPCommand> >::const_iterator it = m_commands.begin() ;
 			     it != m_commands.end() ; ++it)
 			{
 				shared_ptr <SMTPCommand> cmd = *it;
-				cmd->writeToSocket(sok);
+
+				buffer += cmd->getText();
+				buffer += "\r\n";
 			}
+
+			sok->send(buffer);
 		}
 
 		if (!m_commands.empty())
@@ -109,6 +118,38 @@ void SMTPCommandSet::writeToSocket(shared_ptr <socket> sok)
 }
 
 
+void SMTPCommandSet::send(shared_ptr <SMTPConnection> conn)
+{
+	if (!utility::instrumentation::isEnabled())
+	{
+		writeToSocket(conn->getSocket());
+		return;
+	}
+
+	// Commands written by this call: all of them on the first call when
+	// pipelining, else only the next one
+	std::vector <string> sent;
+
+	if (m_pipeline && !m_started)
+	{
+		for (std::list <shared_ptr <SMTPCommand> >::const_iterator it = m_commands.begin() ;
+		     it != m_commands.end() ; ++it)
+		{
+			sent.push_back((*it)->getText());
+		}
+	}
+	else if (!m_pipeline && !m_commands.empty())
+	{
+		sent.push_back(m_commands.front()->getText());
+	}
+
+	writeToSocket(conn->getSocket());
+
+	for (size_t i = 0 ; i < sent.size() ; ++i)
+		conn->onCommandSent(sent[i]);
+}
+
+
 const string SMTPCommandSet::getText() const
 {
 	std::ostringstream cmd;
@@ -136,6 +177,12 @@ shared_ptr <SMTPCommand> SMTPCommandSet::getLastCommandSent() const
 }
 
 
+size_t SMTPCommandSet::getPendingCommandCount() const
+{
+	return (m_pipeline && m_started) ? m_commands.size() : 0;
+}
+
+
 } // smtp
 } // net
 } // vmime
@@ -77,8 +77,17 @@ public:
 	  */
 	shared_ptr <SMTPCommand> getLastCommandSent() const;
 
+	/** Returns the number of commands which have been sent to the
+	  * server along with the last command sent, and whose response
+	  * has not been read yet. This is always 0 without pipelining.
+	  *
+	  * @return number of pipelined commands waiting for a response
+	  */
+	size_t getPendingCommandCount() const;
+
 
 	void writeToSocket(shared_ptr <socket> sok);
+	void send(shared_ptr <SMTPConnection> conn);
 
 	const string getText() const;
 
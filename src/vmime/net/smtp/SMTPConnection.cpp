@@ -38,6 +38,11 @@
 
 #include "vmime/net/defaultConnectionInfos.hpp"
 
+#include "vmime/utility/instrumentation.hpp"
+#include "vmime/utility/stringUtils.hpp"
+
+#include <sstream>
+
 #if VMIME_HAVE_SASL_SUPPORT
 	#include "vmime/security/sasl/SASLContext.hpp"
 #endif // VMIME_HAVE_SASL_SUPPORT
@@ -66,7 +71,8 @@ namespace smtp {
 
 SMTPConnection::SMTPConnection(shared_ptr <SMTPTransport> transport, shared_ptr <security::authenticator> auth)
 	: m_transport(transport), m_auth(auth), m_socket(null), m_timeoutHandler(null),
-	  m_authenticated(false), m_secured(false), m_extendedSMTP(false)
+	  m_authenticated(false), m_secured(false), m_extendedSMTP(false),
+	  m_awaitingResponse(false)
 {
 }
 
@@ -474,6 +480,9 @@ void SMTPConnection::startTLS()
 		shared_ptr <tls::TLSSocket> tlsSocket =
 			tlsSession->getSocket(m_socket);
 
+		tlsSocket->setServerIdentity(tls::TLSSessionCache::makeServerIdentity
+			(m_cntInfos->getHost(), m_cntInfos->getPort()));
+
 		tlsSocket->handshake();
 
 		m_socket = tlsSocket;
@@ -534,12 +543,15 @@ void SMTPConnection::internalDisconnect()
 
 	m_secured = false;
 	m_cntInfos = null;
+
+	m_awaitingResponse = false;
+	m_pendingCommands.clear();
 }
 
 
 void SMTPConnection::sendRequest(shared_ptr <SMTPCommand> cmd)
 {
-	cmd->writeToSocket(m_socket);
+	cmd->send(dynamicCast <SMTPConnection>(shared_from_this()));
 }
 
 
@@ -550,10 +562,51 @@ shared_ptr <SMTPResponse> SMTPConnection::readResponse()
 
 	m_responseState = resp->getCurrentState();
 
+	if (utility::instrumentation::isEnabled())
+		onResponseReceived();
+
 	return resp;
 }
 
 
+void SMTPConnection::onCommandSent(const string& text)
+{
+	m_awaitingResponse = true;
+
+	// Command name, eg. "MAIL" or "RCPT"
+	std::istringstream iss(text);
+	string name;
+	iss >> name;
+
+	name = utility::stringUtils::toUpper(name);
+
+	utility::instrumentation::increment(utility::instrumentation::SMTP_COMMANDS, name);
+
+	m_pendingCommands.push_back(std::make_pair(name, utility::instrumentation::now()));
+}
+
+
+void SMTPConnection::onResponseReceived()
+{
+	if (m_awaitingResponse)
+	{
+		utility::instrumentation::increment(utility::instrumentation::SMTP_ROUND_TRIPS, "");
+		m_awaitingResponse = false;
+	}
+
+	// Responses which do not answer a command (eg. greeting, or final
+	// response to DATA) are not timed
+	if (!m_pendingCommands.empty())
+	{
+		const std::pair <string, vmime_uint64> cmd = m_pendingCommands.front();
+		m_pendingCommands.pop_front();
+
+		utility::instrumentation::record(utility::instrumentation::SMTP_COMMAND_DURATION,
+			cmd.first, utility::instrumentation::now() - cmd.second);
+	}
+}
+
+
 bool SMTPConnection::isConnected() const
 {
 	return m_socket && m_socket->isConnected() && m_authenticated;
@@ -31,6 +31,8 @@
 #if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
 
 
+#include <deque>
+
 #include "vmime/messageId.hpp"
 
 #include "vmime/net/socket.hpp"
@@ -62,6 +64,10 @@ class SMTPTransport;
   */
 class VMIME_EXPORT SMTPConnection : public object
 {
+	friend class SMTPCommand;
+	friend class SMTPCommandSet;
+	friend class SMTPChunkingOutputStreamAdapter;
+
 public:
 
 	SMTPConnection(shared_ptr <SMTPTransport> transport, shared_ptr <security::authenticator> auth);
@@ -100,6 +106,9 @@ private:
 	void startTLS();
 #endif // VMIME_HAVE_TLS_SUPPORT
 
+	void onCommandSent(const string& text);
+	void onResponseReceived();
+
 
 	weak_ptr <SMTPTransport> m_transport;
 
@@ -116,6 +125,11 @@ private:
 
 	bool m_extendedSMTP;
 	std::map <string, std::vector <string> > m_extensions;
+
+	// Instrumentation: commands awaiting a response, in the order they
+	// were sent (responses come in the same order, even when pipelining)
+	bool m_awaitingResponse;
+	std::deque <std::pair <string, vmime_uint64> > m_pendingCommands;
 };
 
 
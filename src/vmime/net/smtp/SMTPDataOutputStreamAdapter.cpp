@@ -0,0 +1,99 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
+
+
+#include "vmime/net/smtp/SMTPDataOutputStreamAdapter.hpp"
+
+#include "vmime/net/smtp/SMTPConnection.hpp"
+
+#include <algorithm>
+
+
+namespace vmime {
+namespace net {
+namespace smtp {
+
+
+SMTPDataOutputStreamAdapter::SMTPDataOutputStreamAdapter
+	(shared_ptr <SMTPConnection> conn, const size_t size, utility::progressListener* progress)
+	: m_connection(conn), m_stream(*conn->getSocket()),
+	  m_totalSize(size), m_totalWritten(0), m_totalSent(0), m_progress(progress)
+{
+	if (progress)
+		progress->start(size);
+}
+
+
+void SMTPDataOutputStreamAdapter::writeImpl
+	(const byte_t* const data, const size_t count)
+{
+	m_stream.write(data, count);
+	m_totalWritten += count;
+
+	// Notify progress only when data has actually been sent
+	const size_t sent = m_totalWritten - m_stream.getBufferedSize();
+
+	if (m_progress && sent != m_totalSent)
+	{
+		m_totalSent = sent;
+		m_totalSize = std::max(m_totalSize, m_totalSent);
+
+		m_progress->progress(m_totalSent, m_totalSize);
+	}
+}
+
+
+void SMTPDataOutputStreamAdapter::sendEndOfData()
+{
+	m_stream.write("\r\n.\r\n", 5);
+	m_stream.flush();
+
+	if (m_progress)
+		m_progress->stop(m_totalSize);
+}
+
+
+void SMTPDataOutputStreamAdapter::flush()
+{
+	m_stream.flush();
+}
+
+
+size_t SMTPDataOutputStreamAdapter::getBlockSize()
+{
+	return m_stream.getBlockSize();
+}
+
+
+} // smtp
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_MESSAGING_PROTO_SMTP
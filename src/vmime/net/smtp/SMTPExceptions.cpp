@@ -143,6 +143,33 @@ const char* SMTPMessageSizeExceedsCurLimitsException::name() const throw()
 }
 
 
+//
+// SMTPConnectionClosedException
+//
+
+SMTPConnectionClosedException::SMTPConnectionClosedException(const exception& other)
+	: socket_exception("Connection closed before the mail transaction was started.", other)
+{
+}
+
+
+SMTPConnectionClosedException::~SMTPConnectionClosedException() throw()
+{
+}
+
+
+exception* SMTPConnectionClosedException::clone() const
+{
+	return new SMTPConnectionClosedException(*this);
+}
+
+
+const char* SMTPConnectionClosedException::name() const throw()
+{
+	return "SMTPConnectionClosedException";
+}
+
+
 } // smtp
 } // net
 } // vmime
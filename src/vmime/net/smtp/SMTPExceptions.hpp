@@ -116,6 +116,24 @@ public:
 };
 
 
+/** SMTP error: the connection was closed before the server accepted
+  * the "MAIL" command (eg. a connection which was closed by the server
+  * after some idle time). The message has not been sent, so it can be
+  * sent again on another connection.
+  */
+
+class VMIME_EXPORT SMTPConnectionClosedException : public exceptions::socket_exception
+{
+public:
+
+	SMTPConnectionClosedException(const exception& other = NO_EXCEPTION);
+	~SMTPConnectionClosedException() throw();
+
+	exception* clone() const;
+	const char* name() const throw();
+};
+
+
 } // smtp
 } // net
 } // vmime
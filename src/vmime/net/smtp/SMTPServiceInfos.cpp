@@ -63,6 +63,8 @@ const SMTPServiceInfos::props& SMTPServiceInfos::getProperties() const
 
 		property("options.pipelining", serviceInfos::property::TYPE_BOOLEAN, "true"),
 		property("options.chunking", serviceInfos::property::TYPE_BOOLEAN, "true"),
+		property("options.8bitmime", serviceInfos::property::TYPE_BOOLEAN, "true"),
+		property("options.binarymime", serviceInfos::property::TYPE_BOOLEAN, "true"),
 
 		// Common properties
 		property(serviceInfos::property::AUTH_USERNAME, serviceInfos::property::FLAG_REQUIRED),
@@ -88,6 +90,8 @@ const SMTPServiceInfos::props& SMTPServiceInfos::getProperties() const
 
 		property("options.pipelining", serviceInfos::property::TYPE_BOOLEAN, "true"),
 		property("options.chunking", serviceInfos::property::TYPE_BOOLEAN, "true"),
+		property("options.8bitmime", serviceInfos::property::TYPE_BOOLEAN, "true"),
+		property("options.binarymime", serviceInfos::property::TYPE_BOOLEAN, "true"),
 
 		// Common properties
 		property(serviceInfos::property::AUTH_USERNAME, serviceInfos::property::FLAG_REQUIRED),
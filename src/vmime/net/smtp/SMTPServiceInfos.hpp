@@ -59,6 +59,8 @@ public:
 
 		serviceInfos::property PROPERTY_OPTIONS_PIPELINING;
 		serviceInfos::property PROPERTY_OPTIONS_CHUNKING;
+		serviceInfos::property PROPERTY_OPTIONS_8BITMIME;
+		serviceInfos::property PROPERTY_OPTIONS_BINARYMIME;
 
 		// Common properties
 		serviceInfos::property PROPERTY_AUTH_USERNAME;
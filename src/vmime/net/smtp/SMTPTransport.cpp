@@ -32,6 +32,7 @@
 #include "vmime/net/smtp/SMTPCommand.hpp"
 #include "vmime/net/smtp/SMTPCommandSet.hpp"
 #include "vmime/net/smtp/SMTPChunkingOutputStreamAdapter.hpp"
+#include "vmime/net/smtp/SMTPDataOutputStreamAdapter.hpp"
 #include "vmime/net/smtp/SMTPExceptions.hpp"
 
 #include "vmime/exception.hpp"
@@ -40,10 +41,7 @@
 
 #include "vmime/utility/filteredStream.hpp"
 #include "vmime/utility/stringUtils.hpp"
-#include "vmime/utility/outputStreamSocketAdapter.hpp"
 #include "vmime/utility/streamUtils.hpp"
-#include "vmime/utility/outputStreamAdapter.hpp"
-#include "vmime/utility/inputStreamStringAdapter.hpp"
 
 
 namespace vmime {
@@ -83,6 +81,18 @@ bool SMTPTransport::isSMTPS() const
 }
 
 
+void SMTPTransport::setDSNAttributes(const dsnAttributes& attrs)
+{
+	m_dsnAttributes = attrs;
+}
+
+
+const dsnAttributes& SMTPTransport::getDSNAttributes() const
+{
+	return m_dsnAttributes;
+}
+
+
 void SMTPTransport::connect()
 {
 	if (isConnected())
@@ -163,7 +173,7 @@ void SMTPTransport::noop()
 void SMTPTransport::sendEnvelope
 	(const mailbox& expeditor, const mailboxList& recipients,
 	 const mailbox& sender, bool sendDATACommand,
-	 const size_t size)
+	 const size_t size, const string& bodyType)
 {
 	// If no recipient/expeditor was found, throw an exception
 	if (recipients.isEmpty())
@@ -188,10 +198,21 @@ void SMTPTransport::sendEnvelope
 	const bool hasSMTPUTF8 = m_connection->hasExtension("SMTPUTF8");
 	const bool hasSize = m_connection->hasExtension("SIZE");
 
+	// DSN parameters are only sent if the server supports them
+	const dsnAttributes noDSNAttrs;
+	const dsnAttributes& dsnAttrs =
+		m_connection->hasExtension("DSN") ? m_dsnAttributes : noDSNAttrs;
+
 	if (!sender.isEmpty())
-		commands->addCommand(SMTPCommand::MAIL(sender, hasSMTPUTF8, hasSize ? size : 0));
+	{
+		commands->addCommand(SMTPCommand::MAIL
+			(sender, hasSMTPUTF8, hasSize ? size : 0, bodyType, dsnAttrs));
+	}
 	else
-		commands->addCommand(SMTPCommand::MAIL(expeditor, hasSMTPUTF8, hasSize ? size : 0));
+	{
+		commands->addCommand(SMTPCommand::MAIL
+			(expeditor, hasSMTPUTF8, hasSize ? size : 0, bodyType, dsnAttrs));
+	}
 
 	// Now, we will need to reset next time
 	m_needReset = true;
@@ -200,69 +221,40 @@ void SMTPTransport::sendEnvelope
 	for (size_t i = 0 ; i < recipients.getMailboxCount() ; ++i)
 	{
 		const mailbox& mbox = *recipients.getMailboxAt(i);
-		commands->addCommand(SMTPCommand::RCPT(mbox, hasSMTPUTF8));
+		commands->addCommand(SMTPCommand::RCPT(mbox, hasSMTPUTF8, dsnAttrs));
 	}
 
 	// Prepare sending of message data
 	if (sendDATACommand)
 		commands->addCommand(SMTPCommand::DATA());
 
-	// Read response for "RSET" command
-	if (needReset)
-	{
-		commands->writeToSocket(m_connection->getSocket());
+	bool mailAccepted = false;
 
-		resp = m_connection->readResponse();
-
-		if (resp->getCode() != 250 &&
-		    resp->getCode() != 200)   // RFC-876: << In reply to a RSET and/or a NOOP command,
-		                              //             some servers reply "200" >>
+	try
+	{
+		// Read response for "RSET" command
+		if (needReset)
 		{
-			disconnect();
+			m_connection->sendRequest(commands);
 
-			throw SMTPCommandError
-				(commands->getLastCommandSent()->getText(), resp->getText(),
-				 resp->getCode(), resp->getEnhancedCode());
-		}
-	}
+			resp = m_connection->readResponse();
 
-	// Read response for "MAIL" command
-	commands->writeToSocket(m_connection->getSocket());
+			if (resp->getCode() != 250 &&
+			    resp->getCode() != 200)   // RFC-876: << In reply to a RSET and/or a NOOP command,
+			                              //             some servers reply "200" >>
+			{
+				disconnect();
 
-	if ((resp = m_connection->readResponse())->getCode() != 250)
-	{
-		// SIZE extension: insufficient system storage
-		if (resp->getCode() == 452)
-		{
-			throw SMTPMessageSizeExceedsCurLimitsException
-				(SMTPCommandError(commands->getLastCommandSent()->getText(), resp->getText(),
-				 resp->getCode(), resp->getEnhancedCode()));
-		}
-		// SIZE extension: message size exceeds fixed maximum message size
-		else if (resp->getCode() == 552)
-		{
-			throw SMTPMessageSizeExceedsMaxLimitsException
-				(SMTPCommandError(commands->getLastCommandSent()->getText(), resp->getText(),
-				 resp->getCode(), resp->getEnhancedCode()));
-		}
-		// Other error
-		else
-		{
-			throw SMTPCommandError
-				(commands->getLastCommandSent()->getText(), resp->getText(),
-				 resp->getCode(), resp->getEnhancedCode());
+				throw SMTPCommandError
+					(commands->getLastCommandSent()->getText(), resp->getText(),
+					 resp->getCode(), resp->getEnhancedCode());
+			}
 		}
-	}
 
-	// Read responses for "RCPT TO" commands
-	for (size_t i = 0 ; i < recipients.getMailboxCount() ; ++i)
-	{
-		commands->writeToSocket(m_connection->getSocket());
+		// Read response for "MAIL" command
+		m_connection->sendRequest(commands);
 
-		resp = m_connection->readResponse();
-
-		if (resp->getCode() != 250 &&
-		    resp->getCode() != 251)
+		if ((resp = m_connection->readResponse())->getCode() != 250)
 		{
 			// SIZE extension: insufficient system storage
 			if (resp->getCode() == 452)
@@ -286,18 +278,126 @@ void SMTPTransport::sendEnvelope
 					 resp->getCode(), resp->getEnhancedCode());
 			}
 		}
+
+		mailAccepted = true;
+
+		// Read responses for "RCPT TO" commands
+		for (size_t i = 0 ; i < recipients.getMailboxCount() ; ++i)
+		{
+			m_connection->sendRequest(commands);
+
+			resp = m_connection->readResponse();
+
+			if (resp->getCode() != 250 &&
+			    resp->getCode() != 251)
+			{
+				// SIZE extension: insufficient system storage
+				if (resp->getCode() == 452)
+				{
+					throw SMTPMessageSizeExceedsCurLimitsException
+						(SMTPCommandError(commands->getLastCommandSent()->getText(), resp->getText(),
+						 resp->getCode(), resp->getEnhancedCode()));
+				}
+				// SIZE extension: message size exceeds fixed maximum message size
+				else if (resp->getCode() == 552)
+				{
+					throw SMTPMessageSizeExceedsMaxLimitsException
+						(SMTPCommandError(commands->getLastCommandSent()->getText(), resp->getText(),
+						 resp->getCode(), resp->getEnhancedCode()));
+				}
+				// Other error
+				else
+				{
+					throw SMTPCommandError
+						(commands->getLastCommandSent()->getText(), resp->getText(),
+						 resp->getCode(), resp->getEnhancedCode());
+				}
+			}
+		}
+
+		// Read response for "DATA" command
+		if (sendDATACommand)
+		{
+			m_connection->sendRequest(commands);
+
+			if ((resp = m_connection->readResponse())->getCode() != 354)
+			{
+				throw SMTPCommandError
+					(commands->getLastCommandSent()->getText(), resp->getText(),
+					 resp->getCode(), resp->getEnhancedCode());
+			}
+		}
 	}
+	catch (exceptions::command_error&)
+	{
+		resetAfterRejection(commands);
+		throw;
+	}
+	catch (SMTPMessageSizeExceedsCurLimitsException&)
+	{
+		resetAfterRejection(commands);
+		throw;
+	}
+	catch (SMTPMessageSizeExceedsMaxLimitsException&)
+	{
+		resetAfterRejection(commands);
+		throw;
+	}
+	catch (exceptions::socket_exception& e)
+	{
+		// The server closed the connection (eg. after some idle time)
+		// before the transaction was started: nothing has been sent
+		if (!mailAccepted)
+			throw SMTPConnectionClosedException(e);
 
-	// Read response for "DATA" command
-	if (sendDATACommand)
+		throw;
+	}
+}
+
+
+void SMTPTransport::resetAfterRejection(shared_ptr <SMTPCommandSet> commands)
+{
+	if (!isConnected())
+		return;
+
+	try
 	{
-		commands->writeToSocket(m_connection->getSocket());
+		// Read the responses to the commands pipelined after the
+		// rejected one
+		for (size_t n = commands ? commands->getPendingCommandCount() : 0 ; n != 0 ; --n)
+		{
+			m_connection->sendRequest(commands);
 
-		if ((resp = m_connection->readResponse())->getCode() != 354)
+			// The server is waiting for the message data: a DATA
+			// command cannot be aborted without closing the connection
+			if (m_connection->readResponse()->getCode() == 354)
+			{
+				disconnect();
+				return;
+			}
+		}
+
+		m_connection->sendRequest(SMTPCommand::RSET());
+
+		shared_ptr <SMTPResponse> resp = m_connection->readResponse();
+
+		if (resp->getCode() != 250 && resp->getCode() != 200)
 		{
-			throw SMTPCommandError
-				(commands->getLastCommandSent()->getText(), resp->getText(),
-				 resp->getCode(), resp->getEnhancedCode());
+			disconnect();
+			return;
+		}
+
+		m_needReset = false;
+	}
+	catch (exception&)
+	{
+		try
+		{
+			disconnect();
+		}
+		catch (exception&)
+		{
+			// Ignore
 		}
 	}
 }
@@ -316,20 +416,20 @@ void SMTPTransport::send
 
 	// Send the message data
 	// Stream copy with "\n." to "\n.." transformation
-	utility::outputStreamSocketAdapter sos(*m_connection->getSocket());
-	utility::dotFilteredOutputStream fos(sos);
+	SMTPDataOutputStreamAdapter dataStream(m_connection, size, /* progress */ NULL);
+	utility::dotFilteredOutputStream fos(dataStream);
 
 	utility::bufferedStreamCopy(is, fos, size, progress);
 
-	fos.flush();
-
 	// Send end-of-data delimiter
-	m_connection->getSocket()->send("\r\n.\r\n");
+	dataStream.sendEndOfData();
 
 	shared_ptr <SMTPResponse> resp;
 
 	if ((resp = m_connection->readResponse())->getCode() != 250)
 	{
+		resetAfterRejection(null);
+
 		throw SMTPCommandError
 			("DATA", resp->getText(), resp->getCode(), resp->getEnhancedCode());
 	}
@@ -343,36 +443,69 @@ void SMTPTransport::send
 	if (!isConnected())
 		throw exceptions::not_connected();
 
+	const SMTPServiceInfos::props& props =
+		dynamic_cast <const SMTPServiceInfos&>(getInfos()).getProperties();
+
+	const bool useChunking = m_connection->hasExtension("CHUNKING") &&
+		getInfos().getPropertyValue <bool>(getSession(), props.PROPERTY_OPTIONS_CHUNKING);
+
 	// Generate the message with Internationalized Email support,
 	// if this is supported by the SMTP server
 	generationContext ctx(generationContext::getDefaultContext());
 	ctx.setInternationalizedEmailSupport(m_connection->hasExtension("SMTPUTF8"));
 
-	// If CHUNKING is not supported, generate the message to a temporary
-	// buffer then use the send() method which takes an inputStream
-	if (!m_connection->hasExtension("CHUNKING") ||
-	    !getInfos().getPropertyValue <bool>(getSession(),
-			dynamic_cast <const SMTPServiceInfos&>(getInfos()).getProperties().PROPERTY_OPTIONS_CHUNKING))
+	// Avoid transfer-encoding the contents if the server can transport
+	// 8-bit data (RFC-6152) or binary data (RFC-3030, requires BDAT)
+	string bodyType;
+
+	if (useChunking && m_connection->hasExtension("BINARYMIME") &&
+	    getInfos().getPropertyValue <bool>(getSession(), props.PROPERTY_OPTIONS_BINARYMIME))
+	{
+		ctx.setTransferEncodingSupport(generationContext::TRANSFER_BINARY);
+		bodyType = "BINARYMIME";
+	}
+	else if (m_connection->hasExtension("8BITMIME") &&
+	         getInfos().getPropertyValue <bool>(getSession(), props.PROPERTY_OPTIONS_8BITMIME))
+	{
+		ctx.setTransferEncodingSupport(generationContext::TRANSFER_8BIT);
+		bodyType = "8BITMIME";
+	}
 
+	const size_t msgSize = msg->getGeneratedSize(ctx);
+
+	// If CHUNKING is not supported, generate the message directly
+	// to the socket after the DATA command
+	if (!useChunking)
 	{
-		std::ostringstream oss;
-		utility::outputStreamAdapter ossAdapter(oss);
+		// Send message envelope
+		sendEnvelope(expeditor, recipients, sender,
+			/* sendDATACommand */ true, msgSize, bodyType);
+
+		// Send the message data, with "\n." to "\n.." transformation
+		SMTPDataOutputStreamAdapter dataStream(m_connection, msgSize, progress);
+		utility::dotFilteredOutputStream fos(dataStream);
 
-		msg->generate(ctx, ossAdapter);
+		msg->generate(ctx, fos);
 
-		const string& str(oss.str());
+		// Send end-of-data delimiter
+		dataStream.sendEndOfData();
 
-		utility::inputStreamStringAdapter isAdapter(str);
+		shared_ptr <SMTPResponse> resp;
+
+		if ((resp = m_connection->readResponse())->getCode() != 250)
+		{
+			resetAfterRejection(null);
+
+			throw SMTPCommandError
+				("DATA", resp->getText(), resp->getCode(), resp->getEnhancedCode());
+		}
 
-		send(expeditor, recipients, isAdapter, str.length(), progress, sender);
 		return;
 	}
 
 	// Send message envelope
-	const size_t msgSize = msg->getGeneratedSize(ctx);
-
 	sendEnvelope(expeditor, recipients, sender,
-		/* sendDATACommand */ false, msgSize);
+		/* sendDATACommand */ false, msgSize, bodyType);
 
 	// Send the message by chunks
 	SMTPChunkingOutputStreamAdapter chunkStream(m_connection, msgSize, progress);
@@ -34,6 +34,7 @@
 #include "vmime/net/transport.hpp"
 #include "vmime/net/socket.hpp"
 #include "vmime/net/timeoutHandler.hpp"
+#include "vmime/net/dsnAttributes.hpp"
 
 #include "vmime/net/smtp/SMTPServiceInfos.hpp"
 #include "vmime/net/smtp/SMTPConnection.hpp"
@@ -45,6 +46,7 @@ namespace smtp {
 
 
 class SMTPCommand;
+class SMTPCommandSet;
 
 
 /** SMTP transport service.
@@ -89,6 +91,21 @@ public:
 
 	bool isSMTPS() const;
 
+	/** Sets the Delivery Status Notification parameters (RFC-3461)
+	  * sent with the next messages. They are ignored if the server
+	  * does not support the DSN extension.
+	  *
+	  * @param attrs DSN parameters
+	  */
+	void setDSNAttributes(const dsnAttributes& attrs);
+
+	/** Returns the Delivery Status Notification parameters (RFC-3461)
+	  * sent with the messages.
+	  *
+	  * @return DSN parameters
+	  */
+	const dsnAttributes& getDSNAttributes() const;
+
 private:
 
 	/** Send the MAIL and RCPT commands to the server, checking the
@@ -100,13 +117,26 @@ private:
 	  * @param sender envelope sender (if empty, expeditor will be used)
 	  * @param sendDATACommand if true, the DATA command will be sent
 	  * @param size message size, in bytes (or 0, if not known)
+	  * @param bodyType value of the BODY parameter (eg. "8BITMIME"),
+	  * or empty if the message is 7-bit
 	  */
 	void sendEnvelope
 		(const mailbox& expeditor,
 		 const mailboxList& recipients,
 		 const mailbox& sender,
 		 bool sendDATACommand,
-		 const size_t size);
+		 const size_t size,
+		 const string& bodyType = "");
+
+	/** Bring the connection back to a known state after the server
+	  * rejected a command of a mail transaction: the responses to the
+	  * pipelined commands are read, and the transaction is aborted
+	  * with RSET. If this is not possible (eg. the server already
+	  * accepted DATA), the connection is closed.
+	  *
+	  * @param commands commands of the transaction, or NULL
+	  */
+	void resetAfterRejection(shared_ptr <SMTPCommandSet> commands);
 
 
 	shared_ptr <SMTPConnection> m_connection;
@@ -116,6 +146,8 @@ private:
 
 	bool m_needReset;
 
+	dsnAttributes m_dsnAttributes;
+
 	// Service infos
 	static SMTPServiceInfos sm_infos;
 };
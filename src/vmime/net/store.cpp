@@ -0,0 +1,88 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/net/store.hpp"
+
+
+namespace vmime {
+namespace net {
+
+
+std::map <folder::path, shared_ptr <folderStatus> > store::getFolderStatus()
+{
+	std::vector <folder::path> paths;
+
+	shared_ptr <folder> root = getRootFolder();
+	paths.push_back(root->getFullPath());
+
+	const std::vector <shared_ptr <folder> > folders = root->getFolders(/* recursive */ true);
+
+	for (std::vector <shared_ptr <folder> >::const_iterator it = folders.begin() ;
+	     it != folders.end() ; ++it)
+	{
+		paths.push_back((*it)->getFullPath());
+	}
+
+	return getFolderStatus(paths);
+}
+
+
+std::map <folder::path, shared_ptr <folderStatus> > store::getFolderStatus
+	(const std::vector <folder::path>& paths)
+{
+	std::map <folder::path, shared_ptr <folderStatus> > result;
+
+	for (std::vector <folder::path>::const_iterator it = paths.begin() ;
+	     it != paths.end() ; ++it)
+	{
+		shared_ptr <folder> f = getFolder(*it);
+
+		if (!f->exists())
+			continue;
+
+		const folderAttributes attribs = f->getAttributes();
+
+		if (!(attribs.getType() & folderAttributes::TYPE_CONTAINS_MESSAGES) ||
+		    (attribs.getFlags() & folderAttributes::FLAG_NO_OPEN))
+		{
+			continue;
+		}
+
+		result[*it] = f->getStatus();
+	}
+
+	return result;
+}
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
@@ -34,6 +34,9 @@
 #include "vmime/net/service.hpp"
 #include "vmime/net/folder.hpp"
 
+#include <map>
+#include <vector>
+
 
 namespace vmime {
 namespace net {
@@ -80,6 +83,27 @@ public:
 	  */
 	virtual bool isValidFolderName(const folder::path::component& name) const = 0;
 
+	/** Return the status of all the folders of this store which
+	  * can contain messages. This is more efficient than calling
+	  * folder::getStatus() on each folder, as some protocols can
+	  * retrieve the status of many folders in a single operation.
+	  *
+	  * @return status of each folder, indexed by folder path
+	  */
+	virtual std::map <folder::path, shared_ptr <folderStatus> > getFolderStatus();
+
+	/** Return the status of the specified folders. Folders which
+	  * do not exist or cannot contain messages are not included in
+	  * the returned map.
+	  *
+	  * @param paths absolute paths of the folders
+	  * @return status of each folder, indexed by folder path
+	  * @throw exceptions::net_exception if an error other than a
+	  * folder not being found occurs
+	  */
+	virtual std::map <folder::path, shared_ptr <folderStatus> > getFolderStatus
+		(const std::vector <folder::path>& paths);
+
 	/** Store capabilities. */
 	enum Capabilities
 	{
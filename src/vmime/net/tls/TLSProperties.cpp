@@ -35,6 +35,18 @@ namespace net {
 namespace tls {
 
 
+void TLSProperties::setSessionCache(shared_ptr <TLSSessionCache> cache)
+{
+	m_sessionCache = cache;
+}
+
+
+shared_ptr <TLSSessionCache> TLSProperties::getSessionCache() const
+{
+	return m_sessionCache;
+}
+
+
 } // tls
 } // net
 } // vmime
@@ -33,6 +33,8 @@
 
 #include "vmime/types.hpp"
 
+#include "vmime/net/tls/TLSSessionCache.hpp"
+
 
 namespace vmime {
 namespace net {
@@ -89,9 +91,26 @@ public:
 	  */
 	const string getCipherSuite() const;
 
+	/** Sets the cache used to resume previous TLS sessions with the
+	  * same server, which avoids a full handshake on reconnection.
+	  * By default, each TLSProperties object has its own cache, which
+	  * is shared by its copies. Use the same cache for several sessions
+	  * to share resumption data between them.
+	  *
+	  * @param cache session cache, or NULL to disable session resumption
+	  */
+	void setSessionCache(shared_ptr <TLSSessionCache> cache);
+
+	/** Returns the cache used to resume previous TLS sessions.
+	  *
+	  * @return session cache, or NULL if session resumption is disabled
+	  */
+	shared_ptr <TLSSessionCache> getSessionCache() const;
+
 private:
 
 	shared_ptr <object> m_data;
+	shared_ptr <TLSSessionCache> m_sessionCache;
 };
 
 
@@ -0,0 +1,173 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_TLS_SUPPORT
+
+
+#include "vmime/net/tls/TLSSessionCache.hpp"
+
+#include "vmime/platform.hpp"
+
+#include "vmime/utility/sync/autoLock.hpp"
+
+#include <sstream>
+
+
+namespace vmime {
+namespace net {
+namespace tls {
+
+
+const size_t TLSSessionCache::DEFAULT_MAX_ENTRIES = 100;
+
+
+TLSSessionCache::TLSSessionCache(const size_t maxEntries)
+	: m_maxEntries(maxEntries), m_useCounter(0), m_hitCount(0), m_missCount(0),
+	  m_lock(platform::getHandler()->createCriticalSection())
+{
+}
+
+
+// static
+const string TLSSessionCache::makeServerIdentity(const string& address, const port_t port)
+{
+	std::ostringstream oss;
+	oss.imbue(std::locale::classic());
+	oss << address << ':' << port;
+
+	return oss.str();
+}
+
+
+void TLSSessionCache::store(const string& serverId, const byteArray& data)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	if (m_maxEntries == 0)
+		return;
+
+	EntryMap::iterator it = m_entries.find(serverId);
+
+	// Discard the least recently used entry if the cache is full
+	if (it == m_entries.end() && m_entries.size() >= m_maxEntries)
+	{
+		EntryMap::iterator oldest = m_entries.begin();
+
+		for (EntryMap::iterator jt = m_entries.begin() ; jt != m_entries.end() ; ++jt)
+		{
+			if (jt->second.lastUse < oldest->second.lastUse)
+				oldest = jt;
+		}
+
+		m_entries.erase(oldest);
+	}
+
+	entry& e = m_entries[serverId];
+	e.data = data;
+	e.lastUse = ++m_useCounter;
+}
+
+
+bool TLSSessionCache::retrieve(const string& serverId, byteArray& data)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	EntryMap::iterator it = m_entries.find(serverId);
+
+	if (it == m_entries.end())
+		return false;
+
+	it->second.lastUse = ++m_useCounter;
+	data = it->second.data;
+
+	return true;
+}
+
+
+void TLSSessionCache::remove(const string& serverId)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	m_entries.erase(serverId);
+}
+
+
+void TLSSessionCache::clear()
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	m_entries.clear();
+}
+
+
+size_t TLSSessionCache::getEntryCount() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	return m_entries.size();
+}
+
+
+size_t TLSSessionCache::getMaxEntries() const
+{
+	return m_maxEntries;
+}
+
+
+void TLSSessionCache::recordHandshake(const bool resumed)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	if (resumed)
+		++m_hitCount;
+	else
+		++m_missCount;
+}
+
+
+size_t TLSSessionCache::getHitCount() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	return m_hitCount;
+}
+
+
+size_t TLSSessionCache::getMissCount() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	return m_missCount;
+}
+
+
+} // tls
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_TLS_SUPPORT
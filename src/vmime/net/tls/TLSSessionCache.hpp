@@ -0,0 +1,168 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_TLS_TLSSESSIONCACHE_HPP_INCLUDED
+#define VMIME_NET_TLS_TLSSESSIONCACHE_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_TLS_SUPPORT
+
+
+#include <map>
+
+#include "vmime/types.hpp"
+
+#include "vmime/utility/sync/criticalSection.hpp"
+
+
+namespace vmime {
+namespace net {
+namespace tls {
+
+
+/** Client-side cache of TLS session resumption data (session IDs or
+  * session tickets), keyed by server identity.
+  *
+  * When a cache is set in TLS properties (see TLSProperties::setSessionCache()),
+  * TLS sockets try to resume a previous session with the same server instead
+  * of performing a full handshake. The cache is shared by all services using
+  * the same TLS properties, and may be shared between sessions.
+  *
+  * This class is thread-safe.
+  */
+class VMIME_EXPORT TLSSessionCache : public object
+{
+public:
+
+	/** Default maximum number of servers for which data is kept. */
+	static const size_t DEFAULT_MAX_ENTRIES;
+
+
+	/** Construct a new, empty cache.
+	  *
+	  * @param maxEntries maximum number of servers for which data is kept;
+	  * the least recently used entry is discarded when this is exceeded
+	  */
+	TLSSessionCache(const size_t maxEntries = DEFAULT_MAX_ENTRIES);
+
+	/** Build the identity of a server, to be used as a cache key.
+	  *
+	  * @param address server address
+	  * @param port server port
+	  * @return server identity
+	  */
+	static const string makeServerIdentity(const string& address, const port_t port);
+
+	/** Store resumption data for the specified server, replacing
+	  * any previously stored data.
+	  *
+	  * @param serverId server identity
+	  * @param data opaque session data, as returned by the TLS library
+	  */
+	void store(const string& serverId, const byteArray& data);
+
+	/** Retrieve resumption data for the specified server.
+	  *
+	  * @param serverId server identity
+	  * @param data will receive session data, if found
+	  * @return true if data was found for this server, false otherwise
+	  */
+	bool retrieve(const string& serverId, byteArray& data);
+
+	/** Discard resumption data for the specified server.
+	  *
+	  * @param serverId server identity
+	  */
+	void remove(const string& serverId);
+
+	/** Discard all resumption data.
+	  */
+	void clear();
+
+	/** Return the number of servers for which data is stored.
+	  *
+	  * @return number of entries
+	  */
+	size_t getEntryCount() const;
+
+	/** Return the maximum number of servers for which data is kept.
+	  *
+	  * @return maximum number of entries
+	  */
+	size_t getMaxEntries() const;
+
+	/** Record the result of a handshake, for statistics. This is
+	  * called by TLS sockets after each successful handshake.
+	  *
+	  * @param resumed true if a previous session has been resumed,
+	  * false if a full handshake was performed
+	  */
+	void recordHandshake(const bool resumed);
+
+	/** Return the number of handshakes which resumed a previous session.
+	  *
+	  * @return number of cache hits
+	  */
+	size_t getHitCount() const;
+
+	/** Return the number of full handshakes, either because no data was
+	  * cached for the server or because it refused to resume the session.
+	  *
+	  * @return number of cache misses
+	  */
+	size_t getMissCount() const;
+
+private:
+
+	struct entry
+	{
+		byteArray data;
+		unsigned long lastUse;
+	};
+
+	typedef std::map <string, entry> EntryMap;
+
+	EntryMap m_entries;
+	size_t m_maxEntries;
+
+	unsigned long m_useCounter;
+
+	size_t m_hitCount;
+	size_t m_missCount;
+
+	shared_ptr <utility::sync::criticalSection> m_lock;
+};
+
+
+} // tls
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES && VMIME_HAVE_TLS_SUPPORT
+
+#endif // VMIME_NET_TLS_TLSSESSIONCACHE_HPP_INCLUDED
@@ -69,12 +69,36 @@ public:
 	  */
 	virtual void handshake() = 0;
 
+	/** Performs the next step of the TLS handshake, without waiting
+	  * for the peer. This is meant for non-blocking sockets driven by
+	  * an event loop: call it again when the wrapped socket is ready,
+	  * until it returns 0.
+	  *
+	  * @return 0 if the handshake is complete, or STATUS_WANT_READ
+	  * (resp. STATUS_WANT_WRITE) if it must be resumed when data can be
+	  * read from (resp. written to) the wrapped socket
+	  * @throw exceptions::tls_exception if a fatal error occurs
+	  * during the negociation process
+	  */
+	virtual unsigned int handshakeNonBlocking() = 0;
+
 	/** Return the peer's certificate (chain) as sent by the peer.
 	  *
 	  * @return server certificate chain, or NULL if the handshake
 	  * has not been performed yet
 	  */
 	virtual shared_ptr <security::cert::certificateChain> getPeerCertificates() const = 0;
+
+	/** Set the identity of the server this socket is connected to,
+	  * which is used to look up resumption data in the session cache
+	  * (see TLSProperties::setSessionCache()). This is done automatically
+	  * by connect(); it must be called before handshake() when the
+	  * security layer is added to an already-connected socket (STARTTLS).
+	  *
+	  * @param serverId server identity, as returned by
+	  * TLSSessionCache::makeServerIdentity()
+	  */
+	virtual void setServerIdentity(const string& serverId) = 0;
 };
 
 
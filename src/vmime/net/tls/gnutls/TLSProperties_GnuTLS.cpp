@@ -42,7 +42,8 @@ namespace tls {
 
 
 TLSProperties::TLSProperties()
-	: m_data(make_shared <TLSProperties_GnuTLS>())
+	: m_data(make_shared <TLSProperties_GnuTLS>()),
+	  m_sessionCache(make_shared <TLSSessionCache>())
 {
 	setCipherSuite(CIPHERSUITE_DEFAULT);
 }
@@ -50,7 +51,8 @@ TLSProperties::TLSProperties()
 
 TLSProperties::TLSProperties(const TLSProperties& props)
 	: object(),
-	  m_data(make_shared <TLSProperties_GnuTLS>())
+	  m_data(make_shared <TLSProperties_GnuTLS>()),
+	  m_sessionCache(props.m_sessionCache)
 {
 	*dynamicCast <TLSProperties_GnuTLS>(m_data) = *dynamicCast <TLSProperties_GnuTLS>(props.m_data);
 }
@@ -40,6 +40,7 @@
 #include "vmime/security/cert/X509Certificate.hpp"
 
 #include "vmime/utility/stringUtils.hpp"
+#include "vmime/utility/instrumentation.hpp"
 
 #include <cstring>
 
@@ -59,7 +60,7 @@ shared_ptr <TLSSocket> TLSSocket::wrap(shared_ptr <TLSSession> session, shared_p
 
 TLSSocket_GnuTLS::TLSSocket_GnuTLS(shared_ptr <TLSSession_GnuTLS> session, shared_ptr <socket> sok)
 	: m_session(session), m_wrapped(sok), m_connected(false),
-	  m_ex(NULL), m_status(0)
+	  m_handshaking(false), m_handshakeStart(0), m_ex(NULL), m_status(0)
 {
 	gnutls_transport_set_ptr(*m_session->m_gnutlsSession, this);
 
@@ -93,6 +94,8 @@ void TLSSocket_GnuTLS::connect(const string& address, const port_t port)
 	{
 		m_wrapped->connect(address, port);
 
+		setServerIdentity(TLSSessionCache::makeServerIdentity(address, port));
+
 		handshake();
 	}
 	catch (...)
@@ -107,6 +110,10 @@ void TLSSocket_GnuTLS::disconnect()
 {
 	if (m_connected)
 	{
+		// With TLS 1.3, session tickets are sent by the server after the
+		// handshake, so resumption data is only complete at this point
+		storeSessionData();
+
 		gnutls_bye(*m_session->m_gnutlsSession, GNUTLS_SHUT_RDWR);
 
 		m_wrapped->disconnect();
@@ -286,45 +293,67 @@ void TLSSocket_GnuTLS::handshake()
 	if (toHandler)
 		toHandler->resetTimeOut();
 
-	// Start handshaking process
-	try
+	unsigned int wants;
+
+	while ((wants = handshakeNonBlocking()) != 0)
 	{
-		while (true)
-		{
-			const int ret = gnutls_handshake(*m_session->m_gnutlsSession);
+		if (wants & STATUS_WANT_WRITE)
+			m_wrapped->waitForWrite();
+		else
+			m_wrapped->waitForRead();
+	}
+}
 
-			if (m_ex)
-				internalThrow();
 
-			if (ret < 0)
-			{
-				if (ret == GNUTLS_E_AGAIN)
-				{
-					if (gnutls_record_get_direction(*m_session->m_gnutlsSession) == 0)
-						m_wrapped->waitForRead();
-					else
-						m_wrapped->waitForWrite();
-				}
-				else if (ret == GNUTLS_E_INTERRUPTED)
-				{
-					// Non-fatal error
-					m_wrapped->waitForRead();
-				}
-				else
-				{
-					TLSSession_GnuTLS::throwTLSException("gnutls_handshake", ret);
-				}
-			}
-			else
-			{
-				// Successful handshake
-				break;
-			}
+unsigned int TLSSocket_GnuTLS::handshakeNonBlocking()
+{
+	shared_ptr <TLSSessionCache> cache = m_session->m_props->getSessionCache();
+
+	if (!m_handshaking)
+	{
+		m_handshaking = true;
+		m_handshakeStart = utility::instrumentation::isEnabled()
+			? utility::instrumentation::now() : 0;
+
+		// Try to resume a previous session with this server
+		byteArray sessionData;
+
+		if (cache && !m_serverId.empty() && cache->retrieve(m_serverId, sessionData))
+		{
+			gnutls_session_set_data(*m_session->m_gnutlsSession,
+				&sessionData[0], sessionData.size());
 		}
 	}
-	catch (...)
+
+	const int ret = gnutls_handshake(*m_session->m_gnutlsSession);
+
+	if (m_ex)
+		internalThrow();
+
+	if (ret == GNUTLS_E_AGAIN)
 	{
-		throw;
+		if (gnutls_record_get_direction(*m_session->m_gnutlsSession) == 0)
+			return STATUS_WANT_READ;
+		else
+			return STATUS_WANT_WRITE;
+	}
+	else if (ret == GNUTLS_E_INTERRUPTED)
+	{
+		// Non-fatal error
+		return STATUS_WANT_READ;
+	}
+	else if (ret < 0)
+	{
+		TLSSession_GnuTLS::throwTLSException("gnutls_handshake", ret);
+	}
+
+	// Successful handshake
+	m_handshaking = false;
+
+	if (m_handshakeStart != 0)
+	{
+		utility::instrumentation::record(utility::instrumentation::TLS_HANDSHAKE_DURATION,
+			"", utility::instrumentation::now() - m_handshakeStart);
 	}
 
 	// Verify server's certificate(s)
@@ -335,7 +364,44 @@ void TLSSocket_GnuTLS::handshake()
 
 	m_session->getCertificateVerifier()->verify(certs, getPeerName());
 
+	if (cache && !m_serverId.empty())
+		cache->recordHandshake(gnutls_session_is_resumed(*m_session->m_gnutlsSession) != 0);
+
 	m_connected = true;
+
+	// Save the session now, in case the connection is not closed
+	// properly; with TLS 1.3, data is only complete on disconnection
+#if GNUTLS_VERSION_NUMBER >= 0x030603
+	if (gnutls_protocol_get_version(*m_session->m_gnutlsSession) != GNUTLS_TLS1_3)
+#endif
+		storeSessionData();
+
+	return 0;
+}
+
+
+void TLSSocket_GnuTLS::setServerIdentity(const string& serverId)
+{
+	m_serverId = serverId;
+}
+
+
+void TLSSocket_GnuTLS::storeSessionData()
+{
+	shared_ptr <TLSSessionCache> cache = m_session->m_props->getSessionCache();
+
+	if (!cache || m_serverId.empty())
+		return;
+
+	gnutls_datum_t data;
+
+	if (gnutls_session_get_data2(*m_session->m_gnutlsSession, &data) != GNUTLS_E_SUCCESS)
+		return;
+
+	if (data.size != 0)
+		cache->store(m_serverId, byteArray(data.data, data.data + data.size));
+
+	gnutls_free(data.data);
 }
 
 
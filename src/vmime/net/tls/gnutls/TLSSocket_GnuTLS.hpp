@@ -55,9 +55,12 @@ public:
 
 
 	void handshake();
+	unsigned int handshakeNonBlocking();
 
 	shared_ptr <security::cert::certificateChain> getPeerCertificates() const;
 
+	void setServerIdentity(const string& serverId);
+
 	// Implementation of 'socket'
 	void connect(const string& address, const port_t port);
 	void disconnect();
@@ -87,6 +90,8 @@ private:
 
 	void internalThrow();
 
+	void storeSessionData();
+
 #ifdef LIBGNUTLS_VERSION
 	static ssize_t gnutlsPushFunc(gnutls_transport_ptr trspt, const void* data, size_t len);
 	static ssize_t gnutlsPullFunc(gnutls_transport_ptr trspt, void* data, size_t len);
@@ -101,6 +106,11 @@ private:
 
 	bool m_connected;
 
+	bool m_handshaking;
+	vmime_uint64 m_handshakeStart;
+
+	string m_serverId;
+
 	byte_t m_buffer[65536];
 
 	exception* m_ex;
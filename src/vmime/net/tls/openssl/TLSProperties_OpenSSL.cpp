@@ -40,7 +40,8 @@ namespace tls {
 
 
 TLSProperties::TLSProperties()
-	: m_data(make_shared <TLSProperties_OpenSSL>())
+	: m_data(make_shared <TLSProperties_OpenSSL>()),
+	  m_sessionCache(make_shared <TLSSessionCache>())
 {
 	setCipherSuite(CIPHERSUITE_DEFAULT);
 }
@@ -48,7 +49,8 @@ TLSProperties::TLSProperties()
 
 TLSProperties::TLSProperties(const TLSProperties& props)
 	: object(),
-	  m_data(make_shared <TLSProperties_OpenSSL>())
+	  m_data(make_shared <TLSProperties_OpenSSL>()),
+	  m_sessionCache(props.m_sessionCache)
 {
 	*dynamicCast <TLSProperties_OpenSSL>(m_data) = *dynamicCast <TLSProperties_OpenSSL>(props.m_data);
 }
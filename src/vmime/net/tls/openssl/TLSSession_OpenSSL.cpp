@@ -59,7 +59,8 @@ TLSSession_OpenSSL::TLSSession_OpenSSL(shared_ptr <vmime::security::cert::certif
 	SSL_CTX_set_options(m_sslctx, SSL_OP_ALL | SSL_OP_NO_SSLv2);
 	SSL_CTX_set_mode(m_sslctx, SSL_MODE_AUTO_RETRY);
 	SSL_CTX_set_cipher_list(m_sslctx, m_props->getCipherSuite().c_str());
-	SSL_CTX_set_session_cache_mode(m_sslctx, SSL_SESS_CACHE_OFF);
+	// Sessions are kept in the TLSSessionCache set in properties, not in the context
+	SSL_CTX_set_session_cache_mode(m_sslctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
 }
 
 
@@ -39,6 +39,7 @@
 #include "vmime/security/cert/openssl/X509Certificate_OpenSSL.hpp"
 
 #include "vmime/utility/stringUtils.hpp"
+#include "vmime/utility/instrumentation.hpp"
 
 #include <vector>
 #include <cstring>
@@ -52,20 +53,67 @@ namespace tls {
 static OpenSSLInitializer::autoInitializer openSSLInitializer;
 
 
+// BIO structures are opaque since OpenSSL 1.1.0
+#if OPENSSL_VERSION_NUMBER < 0x10100000L || \
+    (defined(LIBRESSL_VERSION_NUMBER) && LIBRESSL_VERSION_NUMBER < 0x2070000fL)
+
+#define VMIME_OPENSSL_HAVE_BIO_ACCESSORS 0
+
+static void* BIO_get_data(BIO* bio) { return bio->ptr; }
+static void BIO_set_data(BIO* bio, void* ptr) { bio->ptr = ptr; }
+static int BIO_get_init(BIO* bio) { return bio->init; }
+static void BIO_set_init(BIO* bio, int init) { bio->init = init; }
+static int BIO_get_shutdown(BIO* bio) { return bio->shutdown; }
+static void BIO_set_shutdown(BIO* bio, int shut) { bio->shutdown = shut; }
+
+#else
+
+#define VMIME_OPENSSL_HAVE_BIO_ACCESSORS 1
+
+#endif
+
+
 // static
-BIO_METHOD TLSSocket_OpenSSL::sm_customBIOMethod =
+BIO_METHOD* TLSSocket_OpenSSL::createCustomBIOMethod()
 {
-	100 | BIO_TYPE_SOURCE_SINK,
-	"vmime::socket glue",
-	TLSSocket_OpenSSL::bio_write,
-	TLSSocket_OpenSSL::bio_read,
-	TLSSocket_OpenSSL::bio_puts,
-	NULL,  // gets
-	TLSSocket_OpenSSL::bio_ctrl,
-	TLSSocket_OpenSSL::bio_create,
-	TLSSocket_OpenSSL::bio_destroy,
-	0
-};
+#if VMIME_OPENSSL_HAVE_BIO_ACCESSORS
+
+	BIO_METHOD* method = BIO_meth_new
+		(BIO_get_new_index() | BIO_TYPE_SOURCE_SINK, "vmime::socket glue");
+
+	BIO_meth_set_write(method, TLSSocket_OpenSSL::bio_write);
+	BIO_meth_set_read(method, TLSSocket_OpenSSL::bio_read);
+	BIO_meth_set_puts(method, TLSSocket_OpenSSL::bio_puts);
+	BIO_meth_set_ctrl(method, TLSSocket_OpenSSL::bio_ctrl);
+	BIO_meth_set_create(method, TLSSocket_OpenSSL::bio_create);
+	BIO_meth_set_destroy(method, TLSSocket_OpenSSL::bio_destroy);
+
+	return method;
+
+#else
+
+	static BIO_METHOD method =
+	{
+		100 | BIO_TYPE_SOURCE_SINK,
+		"vmime::socket glue",
+		TLSSocket_OpenSSL::bio_write,
+		TLSSocket_OpenSSL::bio_read,
+		TLSSocket_OpenSSL::bio_puts,
+		NULL,  // gets
+		TLSSocket_OpenSSL::bio_ctrl,
+		TLSSocket_OpenSSL::bio_create,
+		TLSSocket_OpenSSL::bio_destroy,
+		0
+	};
+
+	return &method;
+
+#endif
+}
+
+
+// static
+BIO_METHOD* TLSSocket_OpenSSL::sm_customBIOMethod = TLSSocket_OpenSSL::createCustomBIOMethod();
 
 
 // static
@@ -77,7 +125,8 @@ shared_ptr <TLSSocket> TLSSocket::wrap(shared_ptr <TLSSession> session, shared_p
 
 
 TLSSocket_OpenSSL::TLSSocket_OpenSSL(shared_ptr <TLSSession_OpenSSL> session, shared_ptr <socket> sok)
-	: m_session(session), m_wrapped(sok), m_connected(false), m_ssl(0), m_status(0), m_ex(NULL)
+	: m_session(session), m_wrapped(sok), m_connected(false),
+	  m_handshaking(false), m_handshakeStart(0), m_ssl(0), m_status(0), m_ex(NULL)
 {
 }
 
@@ -99,9 +148,13 @@ void TLSSocket_OpenSSL::createSSLHandle()
 {
 	if (m_wrapped->isConnected())
 	{
-		BIO* sockBio = BIO_new(&sm_customBIOMethod);
-		sockBio->ptr = this;
-		sockBio->init = 1;
+		BIO* sockBio = BIO_new(sm_customBIOMethod);
+
+		if (!sockBio)
+			throw exceptions::tls_exception("Cannot create BIO object");
+
+		BIO_set_data(sockBio, this);
+		BIO_set_init(sockBio, 1);
 
 		m_ssl = SSL_new(m_session->getContext());
 
@@ -128,6 +181,8 @@ void TLSSocket_OpenSSL::connect(const string& address, const port_t port)
 	{
 		m_wrapped->connect(address, port);
 
+		setServerIdentity(TLSSessionCache::makeServerIdentity(address, port));
+
 		createSSLHandle();
 
 		handshake();
@@ -144,6 +199,11 @@ void TLSSocket_OpenSSL::disconnect()
 {
 	if (m_ssl)
 	{
+		// With TLS 1.3, session tickets are sent by the server after the
+		// handshake, so resumption data is only complete at this point
+		if (m_connected)
+			storeSessionData();
+
 		// Don't shut down the socket more than once.
 		int shutdownState = SSL_get_shutdown(m_ssl);
 		bool shutdownSent = (shutdownState & SSL_SENT_SHUTDOWN) == SSL_SENT_SHUTDOWN;
@@ -335,49 +395,94 @@ size_t TLSSocket_OpenSSL::sendRawNonBlocking(const byte_t* buffer, const size_t
 
 void TLSSocket_OpenSSL::handshake()
 {
-	if (!m_ssl)
-		throw exceptions::socket_not_connected_exception();
-
 	shared_ptr <timeoutHandler> toHandler = m_wrapped->getTimeoutHandler();
 
 	if (toHandler)
 		toHandler->resetTimeOut();
 
-	// Start handshaking process
+	unsigned int wants;
+
+	while ((wants = handshakeNonBlocking()) != 0)
+	{
+		if (wants & STATUS_WANT_WRITE)
+			m_wrapped->waitForWrite();
+		else
+			m_wrapped->waitForRead();
+
+		// Check whether the time-out delay is elapsed
+		if (toHandler && toHandler->isTimeOut())
+		{
+			if (!toHandler->handleTimeOut())
+				throw exceptions::operation_timed_out();
+
+			toHandler->resetTimeOut();
+		}
+	}
+}
+
+
+unsigned int TLSSocket_OpenSSL::handshakeNonBlocking()
+{
+	// Not created yet if the security layer is added to an
+	// already-connected socket (STARTTLS)
 	if (!m_ssl)
 		createSSLHandle();
 
-	try
+	shared_ptr <TLSSessionCache> cache = m_session->m_props->getSessionCache();
+
+	if (!m_handshaking)
 	{
-		int rc;
+		m_handshaking = true;
+		m_handshakeStart = utility::instrumentation::isEnabled()
+			? utility::instrumentation::now() : 0;
+
+		// Try to resume a previous session with this server
+		byteArray sessionData;
 
-		while ((rc = SSL_do_handshake(m_ssl)) <= 0)
+		if (cache && !m_serverId.empty() && cache->retrieve(m_serverId, sessionData))
 		{
-			const int err = SSL_get_error(m_ssl, rc);
+			const unsigned char* p = &sessionData[0];
+			SSL_SESSION* sess = d2i_SSL_SESSION(NULL, &p, static_cast <long>(sessionData.size()));
 
-			if (err == SSL_ERROR_WANT_READ)
-				m_wrapped->waitForRead();
-			else if (err == SSL_ERROR_WANT_WRITE)
-				m_wrapped->waitForWrite();
+			if (sess)
+			{
+				SSL_set_session(m_ssl, sess);
+				SSL_SESSION_free(sess);  // SSL_set_session() holds its own reference
+			}
 			else
-				handleError(rc);
-
-			// Check whether the time-out delay is elapsed
-			if (toHandler && toHandler->isTimeOut())
 			{
-				if (!toHandler->handleTimeOut())
-					throw exceptions::operation_timed_out();
-
-				toHandler->resetTimeOut();
+				cache->remove(m_serverId);
 			}
 		}
 	}
-	catch (...)
+
+	const int rc = SSL_do_handshake(m_ssl);
+
+	if (rc <= 0)
 	{
-		throw;
+		const int err = SSL_get_error(m_ssl, rc);
+
+		if (err == SSL_ERROR_WANT_READ)
+			return STATUS_WANT_READ;
+		else if (err == SSL_ERROR_WANT_WRITE)
+			return STATUS_WANT_WRITE;
+
+		handleError(rc);
+
+		// Non-fatal error
+		return STATUS_WANT_READ;
+	}
+
+	m_handshaking = false;
+
+	if (m_handshakeStart != 0)
+	{
+		utility::instrumentation::record(utility::instrumentation::TLS_HANDSHAKE_DURATION,
+			"", utility::instrumentation::now() - m_handshakeStart);
 	}
 
-	// Verify server's certificate(s)
+	// Verify server's certificate(s), also when the session is resumed:
+	// it may have been established with another certificate verifier
 	shared_ptr <security::cert::certificateChain> certs = getPeerCertificates();
 
 	if (certs == NULL)
@@ -385,7 +490,57 @@ void TLSSocket_OpenSSL::handshake()
 
 	m_session->getCertificateVerifier()->verify(certs, getPeerName());
 
+	if (cache && !m_serverId.empty())
+		cache->recordHandshake(SSL_session_reused(m_ssl) != 0);
+
 	m_connected = true;
+
+	// Save the session now, in case the connection is not closed
+	// properly; with TLS 1.3, data is only complete on disconnection
+#ifdef TLS1_3_VERSION
+	if (SSL_version(m_ssl) != TLS1_3_VERSION)
+#endif
+		storeSessionData();
+
+	return 0;
+}
+
+
+void TLSSocket_OpenSSL::setServerIdentity(const string& serverId)
+{
+	m_serverId = serverId;
+}
+
+
+void TLSSocket_OpenSSL::storeSessionData()
+{
+	shared_ptr <TLSSessionCache> cache = m_session->m_props->getSessionCache();
+
+	if (!cache || m_serverId.empty())
+		return;
+
+	SSL_SESSION* sess = SSL_get_session(m_ssl);
+
+	if (!sess)
+		return;
+
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L && !defined(LIBRESSL_VERSION_NUMBER)
+	// TLS 1.3 session without a ticket
+	if (!SSL_SESSION_is_resumable(sess))
+		return;
+#endif
+
+	const int len = i2d_SSL_SESSION(sess, NULL);
+
+	if (len <= 0)
+		return;
+
+	byteArray data(len);
+	unsigned char* p = &data[0];
+
+	i2d_SSL_SESSION(sess, &p);
+
+	cache->store(m_serverId, data);
 }
 
 
@@ -393,13 +548,30 @@ shared_ptr <security::cert::certificateChain> TLSSocket_OpenSSL::getPeerCertific
 {
 	STACK_OF(X509)* chain = SSL_get_peer_cert_chain(m_ssl);
 
-	if (chain == NULL)
-		return null;
+	// The chain is not saved with the session data: when a session
+	// is resumed, only the server certificate is available
+	if (chain == NULL || sk_X509_num(chain) == 0)
+	{
+		X509* peerCert = SSL_get_peer_certificate(m_ssl);  // +1 reference
 
-	int certCount = sk_X509_num(chain);
+		if (peerCert == NULL)
+			return null;
 
-	if (certCount == 0)
-		return null;
+		shared_ptr <vmime::security::cert::X509Certificate> cert =
+			vmime::security::cert::X509Certificate_OpenSSL::importInternal(peerCert);
+
+		X509_free(peerCert);
+
+		if (!cert)
+			return null;
+
+		std::vector <shared_ptr <security::cert::certificate> > certs;
+		certs.push_back(cert);
+
+		return make_shared <security::cert::certificateChain>(certs);
+	}
+
+	int certCount = sk_X509_num(chain);
 
 	bool error = false;
 	std::vector <shared_ptr <security::cert::certificate> > certs;
@@ -516,9 +688,9 @@ int TLSSocket_OpenSSL::bio_write(BIO* bio, const char* buf, int len)
 	if (buf == NULL || len <= 0)
 		return -1;
 
-	TLSSocket_OpenSSL *sok = reinterpret_cast <TLSSocket_OpenSSL*>(bio->ptr);
+	TLSSocket_OpenSSL *sok = reinterpret_cast <TLSSocket_OpenSSL*>(BIO_get_data(bio));
 
-	if (!bio->init || !sok)
+	if (!BIO_get_init(bio) || !sok)
 		return -1;
 
 	try
@@ -551,9 +723,9 @@ int TLSSocket_OpenSSL::bio_read(BIO* bio, char* buf, int len)
 	if (buf == NULL || len <= 0)
 		return -1;
 
-	TLSSocket_OpenSSL *sok = reinterpret_cast <TLSSocket_OpenSSL*>(bio->ptr);
+	TLSSocket_OpenSSL *sok = reinterpret_cast <TLSSocket_OpenSSL*>(BIO_get_data(bio));
 
-	if (!bio->init || !sok)
+	if (!BIO_get_init(bio) || !sok)
 		return -1;
 
 	try
@@ -599,12 +771,12 @@ long TLSSocket_OpenSSL::bio_ctrl(BIO* bio, int cmd, long num, void* ptr)
 
 	case BIO_CTRL_GET_CLOSE:
 
-		ret = bio->shutdown;
+		ret = BIO_get_shutdown(bio);
 		break;
 
 	case BIO_CTRL_SET_CLOSE:
 
-		bio->shutdown = static_cast <int>(num);
+		BIO_set_shutdown(bio, static_cast <int>(num));
 		break;
 
 	case BIO_CTRL_PENDING:
@@ -632,10 +804,9 @@ long TLSSocket_OpenSSL::bio_ctrl(BIO* bio, int cmd, long num, void* ptr)
 // static
 int TLSSocket_OpenSSL::bio_create(BIO* bio)
 {
-	bio->init = 0;
-	bio->num = 0;
-	bio->ptr = NULL;
-	bio->flags = 0;
+	BIO_set_init(bio, 0);
+	BIO_set_data(bio, NULL);
+	BIO_clear_flags(bio, ~0);
 
 	return 1;
 }
@@ -647,11 +818,11 @@ int TLSSocket_OpenSSL::bio_destroy(BIO* bio)
 	if (bio == NULL)
 		return 0;
 
-	if (bio->shutdown)
+	if (BIO_get_shutdown(bio))
 	{
-		bio->ptr = NULL;
-		bio->init = 0;
-		bio->flags = 0;
+		BIO_set_data(bio, NULL);
+		BIO_set_init(bio, 0);
+		BIO_clear_flags(bio, ~0);
 	}
 
 	return 1;
@@ -59,9 +59,12 @@ public:
 
 
 	void handshake();
+	unsigned int handshakeNonBlocking();
 
 	shared_ptr <security::cert::certificateChain> getPeerCertificates() const;
 
+	void setServerIdentity(const string& serverId);
+
 	// Implementation of 'socket'
 	void connect(const string& address, const port_t port);
 	void disconnect();
@@ -89,7 +92,9 @@ public:
 
 private:
 
-	static BIO_METHOD sm_customBIOMethod;
+	static BIO_METHOD* sm_customBIOMethod;
+
+	static BIO_METHOD* createCustomBIOMethod();
 
 	static int bio_write(BIO* bio, const char* buf, int len);
 	static int bio_read(BIO* bio, char* buf, int len);
@@ -104,6 +109,8 @@ private:
 	void internalThrow();
 	void handleError(int rc);
 
+	void storeSessionData();
+
 
 	shared_ptr <TLSSession_OpenSSL> m_session;
 
@@ -111,6 +118,11 @@ private:
 
 	bool m_connected;
 
+	bool m_handshaking;
+	vmime_uint64 m_handshakeStart;
+
+	string m_serverId;
+
 	byte_t m_buffer[65536];
 
 	SSL* m_ssl;
@@ -0,0 +1,822 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/net/transportPool.hpp"
+#include "vmime/net/session.hpp"
+
+#include "vmime/exception.hpp"
+#include "vmime/platform.hpp"
+#include "vmime/headerFieldFactory.hpp"
+#include "vmime/generationContext.hpp"
+
+#if VMIME_HAVE_MESSAGING_PROTO_SMTP
+#	include "vmime/net/smtp/SMTPExceptions.hpp"
+#endif // VMIME_HAVE_MESSAGING_PROTO_SMTP
+
+#include "vmime/utility/encoder/encoderFactory.hpp"
+#include "vmime/utility/sync/autoLock.hpp"
+#include "vmime/utility/sync/runnable.hpp"
+#include "vmime/utility/sync/thread.hpp"
+
+#include <algorithm>
+
+
+namespace vmime {
+namespace net {
+
+
+const size_t transportPool::DEFAULT_MAX_CONNECTIONS;
+const unsigned long transportPool::DEFAULT_IDLE_TIMEOUT;
+const unsigned long transportPool::DEFAULT_HEALTH_CHECK_INTERVAL;
+
+
+/** Messages of a batch, which are taken one by one by the threads
+  * sending them, and the results of sending.
+  */
+class transportPool::batchQueue
+{
+public:
+
+	batchQueue(const std::vector <shared_ptr <vmime::message> >& msgs,
+	           const bool continueOnRejection, utility::progressListener* progress)
+		: m_msgs(msgs), m_continueOnRejection(continueOnRejection),
+		  m_progress(progress), m_next(0), m_done(0), m_aborted(false),
+		  m_lock(platform::getHandler()->createCriticalSection())
+	{
+	}
+
+	shared_ptr <vmime::message> getMessageAt(const size_t index) const
+	{
+		return m_msgs[index];
+	}
+
+	bool continueOnRejection() const
+	{
+		return m_continueOnRejection;
+	}
+
+	// Returns false when all messages have been taken, or after an error
+	bool nextMessage(size_t* index)
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		if (m_aborted || m_next >= m_msgs.size())
+			return false;
+
+		*index = m_next++;
+
+		return true;
+	}
+
+	void onMessageProcessed(const size_t index, const bool rejected)
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		if (rejected)
+			m_rejected.push_back(index);
+
+		++m_done;
+
+		// Listeners are not expected to be thread-safe
+		if (m_progress)
+			m_progress->progress(m_done, m_msgs.size());
+	}
+
+	void abort()
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+		m_aborted = true;
+	}
+
+	// Called by the other threads, which cannot throw the error themselves
+	void setError(const exception& e)
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		if (!m_error)
+			m_error = shared_ptr <exception>(e.clone());
+
+		m_aborted = true;
+	}
+
+	shared_ptr <exception> getError() const
+	{
+		return m_error;
+	}
+
+	const std::vector <size_t>& getRejected() const
+	{
+		return m_rejected;
+	}
+
+private:
+
+	const std::vector <shared_ptr <vmime::message> >& m_msgs;
+	const bool m_continueOnRejection;
+	utility::progressListener* m_progress;
+
+	size_t m_next;
+	size_t m_done;
+	bool m_aborted;
+
+	std::vector <size_t> m_rejected;
+	shared_ptr <exception> m_error;
+
+	shared_ptr <utility::sync::criticalSection> m_lock;
+};
+
+
+/** Sends messages of a batch on another thread.
+  */
+class transportPool::batchWorker : public utility::sync::runnable
+{
+public:
+
+	batchWorker(transportPool* pool, batchQueue* queue)
+		: m_pool(pool), m_queue(queue)
+	{
+	}
+
+	void run()
+	{
+		try
+		{
+			m_pool->processBatch(*m_queue);
+		}
+		catch (exception& e)
+		{
+			m_queue->setError(e);
+		}
+		catch (std::exception& e)
+		{
+			m_queue->setError(exceptions::net_exception(e.what()));
+		}
+	}
+
+private:
+
+	// Both are valid until the thread is joined
+	transportPool* m_pool;
+	batchQueue* m_queue;
+};
+
+
+transportPool::transportPool(shared_ptr <session> sess, const utility::url& url,
+                             shared_ptr <security::authenticator> auth)
+	: m_session(sess), m_url(url), m_auth(auth),
+	  m_maxConnections(DEFAULT_MAX_CONNECTIONS),
+	  m_idleTimeout(DEFAULT_IDLE_TIMEOUT),
+	  m_healthCheckInterval(DEFAULT_HEALTH_CHECK_INTERVAL),
+	  m_activeCount(0),
+	  m_lock(platform::getHandler()->createCriticalSection())
+{
+}
+
+
+transportPool::~transportPool()
+{
+	for (std::list <idleTransport>::iterator it = m_idle.begin() ;
+	     it != m_idle.end() ; ++it)
+	{
+		disconnectQuietly((*it).service);
+	}
+}
+
+
+void transportPool::setMaxConnections(const size_t maxConnections)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	m_maxConnections = maxConnections;
+}
+
+
+size_t transportPool::getMaxConnections() const
+{
+	return m_maxConnections;
+}
+
+
+void transportPool::setIdleTimeout(const unsigned long secs)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	m_idleTimeout = secs;
+}
+
+
+unsigned long transportPool::getIdleTimeout() const
+{
+	return m_idleTimeout;
+}
+
+
+void transportPool::setHealthCheckInterval(const unsigned long secs)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	m_healthCheckInterval = secs;
+}
+
+
+unsigned long transportPool::getHealthCheckInterval() const
+{
+	return m_healthCheckInterval;
+}
+
+
+#if VMIME_HAVE_TLS_SUPPORT
+
+void transportPool::setCertificateVerifier(shared_ptr <security::cert::certificateVerifier> cv)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	m_certVerifier = cv;
+}
+
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+
+void transportPool::setSocketFactory(shared_ptr <socketFactory> sf)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	m_socketFactory = sf;
+}
+
+
+void transportPool::setTimeoutHandlerFactory(shared_ptr <timeoutHandlerFactory> thf)
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	m_toHandlerFactory = thf;
+}
+
+
+shared_ptr <transport> transportPool::createTransport()
+{
+	// Connections may be created from several threads at once
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+	shared_ptr <transport> tr = m_session->getTransport(m_url, m_auth);
+
+	if (!tr)
+		throw exceptions::no_factory_available();
+
+#if VMIME_HAVE_TLS_SUPPORT
+	if (m_certVerifier)
+		tr->setCertificateVerifier(m_certVerifier);
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+	if (m_socketFactory)
+		tr->setSocketFactory(m_socketFactory);
+
+	if (m_toHandlerFactory)
+		tr->setTimeoutHandlerFactory(m_toHandlerFactory);
+
+	return tr;
+}
+
+
+void transportPool::expireIdleConnections
+	(const unsigned long now, std::vector <shared_ptr <transport> >& expired)
+{
+	// Oldest connections are at the front of the list
+	while (!m_idle.empty() && now - m_idle.front().lastUsed >= m_idleTimeout)
+	{
+		expired.push_back(m_idle.front().service);
+		m_idle.pop_front();
+	}
+}
+
+
+// static
+void transportPool::disconnectQuietly(shared_ptr <transport> tr)
+{
+	try
+	{
+		if (tr->isConnected())
+			tr->disconnect();
+	}
+	catch (exception&)
+	{
+		// Ignore
+	}
+}
+
+
+shared_ptr <transport> transportPool::acquire()
+{
+	bool reused = false;
+	return acquireConnection(&reused);
+}
+
+
+shared_ptr <transport> transportPool::acquireConnection(bool* reused)
+{
+	for ( ; ; )
+	{
+		shared_ptr <transport> tr;
+		unsigned long lastUsed = 0;
+		unsigned long now = 0;
+
+		std::vector <shared_ptr <transport> > expired;
+
+		{
+			utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+			now = platform::getHandler()->getUnixTime();
+
+			expireIdleConnections(now, expired);
+
+			++m_activeCount;
+
+			// Reuse the most recently used connection
+			if (!m_idle.empty())
+			{
+				tr = m_idle.back().service;
+				lastUsed = m_idle.back().lastUsed;
+
+				m_idle.pop_back();
+			}
+		}
+
+		// Close expired connections outside of the lock
+		for (std::vector <shared_ptr <transport> >::iterator it = expired.begin() ;
+		     it != expired.end() ; ++it)
+		{
+			disconnectQuietly(*it);
+		}
+
+		// No idle connection: create a new one
+		if (!tr)
+		{
+			try
+			{
+				tr = createTransport();
+				tr->connect();
+			}
+			catch (...)
+			{
+				utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+				--m_activeCount;
+
+				throw;
+			}
+
+			*reused = false;
+
+			return tr;
+		}
+
+		// Ensure the connection is still alive if it has not been
+		// used recently (the server may have closed it)
+		if (!tr->isConnected())
+		{
+			discard(tr);
+			continue;
+		}
+
+		if (now - lastUsed >= m_healthCheckInterval)
+		{
+			try
+			{
+				tr->noop();
+			}
+			catch (exception&)
+			{
+				discard(tr);
+				continue;
+			}
+		}
+
+		*reused = true;
+
+		return tr;
+	}
+}
+
+
+void transportPool::release(shared_ptr <transport> tr)
+{
+	bool keep = false;
+
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		--m_activeCount;
+
+		if (tr->isConnected() && m_idle.size() < m_maxConnections)
+		{
+			idleTransport idle;
+			idle.service = tr;
+			idle.lastUsed = platform::getHandler()->getUnixTime();
+
+			m_idle.push_back(idle);
+
+			keep = true;
+		}
+	}
+
+	if (!keep)
+		disconnectQuietly(tr);
+}
+
+
+void transportPool::discard(shared_ptr <transport> tr)
+{
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+		--m_activeCount;
+	}
+
+	disconnectQuietly(tr);
+}
+
+
+void transportPool::warmUp(const size_t count)
+{
+	size_t missing = 0;
+
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		const size_t wanted = std::min(count, m_maxConnections);
+		const size_t open = m_idle.size() + m_activeCount;
+
+		if (wanted > open)
+			missing = wanted - open;
+
+		// New connections are active until they are connected
+		m_activeCount += missing;
+	}
+
+	for (size_t i = 0 ; i < missing ; ++i)
+	{
+		shared_ptr <transport> tr;
+
+		try
+		{
+			tr = createTransport();
+			tr->connect();
+		}
+		catch (...)
+		{
+			utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+			m_activeCount -= missing - i;
+
+			throw;
+		}
+
+		release(tr);
+	}
+}
+
+
+// static
+transportPool::sendErrorType transportPool::getSendErrorType()
+{
+	// Called from a catch block: identify the exception being handled
+	try
+	{
+		throw;
+	}
+	// The server rejected the message: the transaction has been reset
+	// (or the connection closed), so the connection can be reused
+	catch (exceptions::command_error&)
+	{
+		return SEND_ERROR_REJECTED;
+	}
+#if VMIME_HAVE_MESSAGING_PROTO_SMTP
+	catch (smtp::SMTPMessageSizeExceedsCurLimitsException&)
+	{
+		return SEND_ERROR_REJECTED;
+	}
+	catch (smtp::SMTPMessageSizeExceedsMaxLimitsException&)
+	{
+		return SEND_ERROR_REJECTED;
+	}
+	catch (smtp::SMTPConnectionClosedException&)
+	{
+		return SEND_ERROR_NOT_STARTED;
+	}
+#endif // VMIME_HAVE_MESSAGING_PROTO_SMTP
+	// Nothing has been sent
+	catch (exceptions::no_recipient&)
+	{
+		return SEND_ERROR_REJECTED;
+	}
+	catch (exceptions::no_expeditor&)
+	{
+		return SEND_ERROR_REJECTED;
+	}
+	// Connection in an unknown state
+	catch (...)
+	{
+		return SEND_ERROR_FATAL;
+	}
+}
+
+
+void transportPool::sendMessage
+	(shared_ptr <vmime::message> msg,
+	 const mailbox* expeditor, const mailboxList* recipients,
+	 utility::progressListener* progress, const mailbox& sender)
+{
+	for (bool retried = false ; ; retried = true)
+	{
+		bool reused = false;
+		shared_ptr <transport> tr = acquireConnection(&reused);
+
+		try
+		{
+			if (expeditor)
+				tr->send(msg, *expeditor, *recipients, progress, sender);
+			else
+				tr->send(msg, progress);
+		}
+		catch (...)
+		{
+			const sendErrorType error = getSendErrorType();
+
+			if (error == SEND_ERROR_REJECTED)
+			{
+				release(tr);
+				throw;
+			}
+
+			discard(tr);
+
+			// The server closed an idle connection: send the message
+			// again on a new connection
+			if (error == SEND_ERROR_NOT_STARTED && reused && !retried)
+				continue;
+
+			throw;
+		}
+
+		release(tr);
+
+		return;
+	}
+}
+
+
+void transportPool::send(shared_ptr <vmime::message> msg, utility::progressListener* progress)
+{
+	sendMessage(msg, NULL, NULL, progress, mailbox());
+}
+
+
+void transportPool::send
+	(shared_ptr <vmime::message> msg, const mailbox& expeditor,
+	 const mailboxList& recipients, utility::progressListener* progress,
+	 const mailbox& sender)
+{
+	sendMessage(msg, &expeditor, &recipients, progress, sender);
+}
+
+
+void transportPool::processBatch(batchQueue& queue)
+{
+	shared_ptr <transport> tr;
+	bool reused = false;
+
+	try
+	{
+		size_t index = 0;
+
+		while (queue.nextMessage(&index))
+		{
+			for (bool retried = false ; ; retried = true)
+			{
+				// If no connection can be established, nothing has been
+				// sent yet: try again once
+				if (!tr)
+				{
+					try
+					{
+						tr = acquireConnection(&reused);
+					}
+					catch (exception&)
+					{
+						tr = acquireConnection(&reused);
+					}
+				}
+
+				try
+				{
+					tr->send(queue.getMessageAt(index));
+				}
+				catch (...)
+				{
+					const sendErrorType error = getSendErrorType();
+
+					// The message was rejected, but the connection can
+					// still be used for the next messages
+					if (error == SEND_ERROR_REJECTED)
+					{
+						if (!queue.continueOnRejection())
+							throw;
+
+						queue.onMessageProcessed(index, /* rejected */ true);
+						break;
+					}
+
+					shared_ptr <transport> deadTr = tr;
+					tr = null;
+
+					discard(deadTr);
+
+					// The server closed an idle connection: send the
+					// message again on a new connection
+					if (error == SEND_ERROR_NOT_STARTED && reused && !retried)
+						continue;
+
+					// Connection failed: the message is not sent again,
+					// as it may already have been delivered
+					throw;
+				}
+
+				queue.onMessageProcessed(index, /* rejected */ false);
+				break;
+			}
+		}
+	}
+	catch (...)
+	{
+		if (tr)
+			release(tr);
+
+		throw;
+	}
+
+	if (tr)
+		release(tr);
+}
+
+
+void transportPool::sendBatch
+	(const std::vector <shared_ptr <vmime::message> >& msgs,
+	 std::vector <size_t>* failed, utility::progressListener* progress)
+{
+	const size_t total = msgs.size();
+
+	if (progress)
+		progress->start(total);
+
+	// Do not use more connections than allowed in the pool
+	size_t connectionCount = 1;
+
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+
+		if (m_maxConnections > m_activeCount)
+			connectionCount = m_maxConnections - m_activeCount;
+	}
+
+	connectionCount = std::min(connectionCount, total);
+
+	batchQueue queue(msgs, failed != NULL, progress);
+
+	std::vector <shared_ptr <utility::sync::thread> > threads;
+
+	if (connectionCount > 1)
+	{
+		// Make sure shared instances are created before threads are started
+		headerFieldFactory::getInstance();
+		utility::encoder::encoderFactory::getInstance();
+		generationContext::getDefaultContext();
+
+		try
+		{
+			// The calling thread also sends messages
+			for (size_t i = 1 ; i < connectionCount ; ++i)
+			{
+				shared_ptr <utility::sync::thread> thread =
+					platform::getHandler()->createThread
+						(make_shared <batchWorker>(this, &queue));
+
+				// Threads not supported by the platform handler
+				if (!thread)
+					break;
+
+				threads.push_back(thread);
+			}
+		}
+		catch (exceptions::system_error&)
+		{
+			// Continue with the threads already started
+		}
+	}
+
+	try
+	{
+		processBatch(queue);
+	}
+	catch (...)
+	{
+		queue.abort();
+
+		for (size_t i = 0 ; i < threads.size() ; ++i)
+			threads[i]->join();
+
+		throw;
+	}
+
+	for (size_t i = 0 ; i < threads.size() ; ++i)
+		threads[i]->join();
+
+	// Error on another thread
+	shared_ptr <exception> error = queue.getError();
+
+	if (error)
+		throw exceptions::net_exception(error->what(), *error);
+
+	if (failed)
+	{
+		const std::vector <size_t>& rejected = queue.getRejected();
+
+		failed->insert(failed->end(), rejected.begin(), rejected.end());
+		std::sort(failed->end() - rejected.size(), failed->end());
+	}
+
+	if (progress)
+		progress->stop(total);
+}
+
+
+void transportPool::closeIdleConnections()
+{
+	std::vector <shared_ptr <transport> > expired;
+
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+		expireIdleConnections(platform::getHandler()->getUnixTime(), expired);
+	}
+
+	for (std::vector <shared_ptr <transport> >::iterator it = expired.begin() ;
+	     it != expired.end() ; ++it)
+	{
+		disconnectQuietly(*it);
+	}
+}
+
+
+void transportPool::disconnect()
+{
+	std::list <idleTransport> idle;
+
+	{
+		utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+		idle.swap(m_idle);
+	}
+
+	for (std::list <idleTransport>::iterator it = idle.begin() ;
+	     it != idle.end() ; ++it)
+	{
+		disconnectQuietly((*it).service);
+	}
+}
+
+
+size_t transportPool::getActiveConnectionCount() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	return m_activeCount;
+}
+
+
+size_t transportPool::getIdleConnectionCount() const
+{
+	utility::sync::autoLock <utility::sync::criticalSection> lock(m_lock);
+	return m_idle.size();
+}
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
@@ -0,0 +1,357 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_NET_TRANSPORTPOOL_HPP_INCLUDED
+#define VMIME_NET_TRANSPORTPOOL_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/net/transport.hpp"
+#include "vmime/net/socket.hpp"
+#include "vmime/net/timeoutHandler.hpp"
+
+#include "vmime/security/authenticator.hpp"
+
+#if VMIME_HAVE_TLS_SUPPORT
+#	include "vmime/security/cert/certificateVerifier.hpp"
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+#include "vmime/utility/url.hpp"
+#include "vmime/utility/progressListener.hpp"
+#include "vmime/utility/sync/criticalSection.hpp"
+
+#include <list>
+
+
+namespace vmime {
+namespace net {
+
+
+class session;
+
+
+/** A pool of connected transport services to the same server.
+  *
+  * Setting up a connection (TCP connection, TLS negotiation, greeting
+  * and authentication) is expensive. When several messages have to be
+  * sent to the same server, connections are kept open and reused for
+  * the next messages. On SMTP, a RSET command is issued before each new
+  * mail transaction on a reused connection.
+  *
+  * Connections which have not been used for some time are checked with
+  * a NOOP command before being reused, and closed after an idle timeout.
+  *
+  * A pool may be used concurrently from several threads: each thread
+  * obtains its own connection with acquire(), or calls send(). The
+  * sendBatch() function spreads a list of messages over several
+  * connections by itself, if the platform handler supports threads.
+  */
+
+class VMIME_EXPORT transportPool : public object
+{
+public:
+
+	/** Creates a new pool of connections. Use session::getTransportPool()
+	  * to share a pool between all users of a session.
+	  *
+	  * @param sess session from which transport services are created
+	  * @param url URL of the transport service (eg. "smtp://myserver.com/")
+	  * @param auth authenticator used by the transport services, or NULL
+	  * to use the default one
+	  */
+	transportPool(shared_ptr <session> sess, const utility::url& url,
+	              shared_ptr <security::authenticator> auth = null);
+
+	~transportPool();
+
+	/** Default maximum number of connections kept open. */
+	static const size_t DEFAULT_MAX_CONNECTIONS = 4;
+
+	/** Default delay, in seconds, after which an unused connection
+	  * is closed. */
+	static const unsigned long DEFAULT_IDLE_TIMEOUT = 60;
+
+	/** Default delay, in seconds, after which an unused connection
+	  * is checked before being reused. */
+	static const unsigned long DEFAULT_HEALTH_CHECK_INTERVAL = 10;
+
+
+	/** Sets the maximum number of connections kept open in this pool.
+	  * If more connections are required at the same time with acquire(),
+	  * additional connections are created but they are closed when
+	  * released. This is also the maximum number of connections used
+	  * at the same time by sendBatch().
+	  *
+	  * @param maxConnections maximum number of connections
+	  */
+	void setMaxConnections(const size_t maxConnections);
+
+	/** Returns the maximum number of connections kept open in this pool.
+	  *
+	  * @return maximum number of connections
+	  */
+	size_t getMaxConnections() const;
+
+	/** Sets the delay after which a connection which has not been
+	  * used is closed.
+	  *
+	  * @param secs delay, in seconds
+	  */
+	void setIdleTimeout(const unsigned long secs);
+
+	/** Returns the delay after which a connection which has not been
+	  * used is closed.
+	  *
+	  * @return delay, in seconds
+	  */
+	unsigned long getIdleTimeout() const;
+
+	/** Sets the delay after which a connection which has not been
+	  * used is checked (with a NOOP command) before being reused.
+	  * Set to 0 to check the connection every time it is reused.
+	  *
+	  * @param secs delay, in seconds
+	  */
+	void setHealthCheckInterval(const unsigned long secs);
+
+	/** Returns the delay after which a connection which has not been
+	  * used is checked before being reused.
+	  *
+	  * @return delay, in seconds
+	  */
+	unsigned long getHealthCheckInterval() const;
+
+#if VMIME_HAVE_TLS_SUPPORT
+
+	/** Set the object responsible for verifying certificates on
+	  * the connections created by this pool.
+	  *
+	  * @param cv certificate verifier
+	  */
+	void setCertificateVerifier(shared_ptr <security::cert::certificateVerifier> cv);
+
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+	/** Set the factory used to create socket objects for the
+	  * connections created by this pool.
+	  *
+	  * @param sf socket factory
+	  */
+	void setSocketFactory(shared_ptr <socketFactory> sf);
+
+	/** Set the factory used to create timeoutHandler objects for
+	  * the connections created by this pool.
+	  *
+	  * @param thf timeoutHandler factory
+	  */
+	void setTimeoutHandlerFactory(shared_ptr <timeoutHandlerFactory> thf);
+
+	/** Returns a connected transport service, either by reusing an
+	  * idle connection from the pool or by creating a new one. The
+	  * service must be given back with release() when done.
+	  *
+	  * @return connected transport service
+	  * @throw exceptions::connection_error if a new connection could
+	  * not be established
+	  */
+	shared_ptr <transport> acquire();
+
+	/** Gives back a transport service obtained with acquire(), so
+	  * that it can be reused. If it is not connected anymore, or if
+	  * the pool already holds the maximum number of connections, the
+	  * service is disconnected.
+	  *
+	  * @param tr transport service
+	  */
+	void release(shared_ptr <transport> tr);
+
+	/** Gives back a transport service obtained with acquire(), which
+	  * should not be reused (eg. after a network error). The service
+	  * is disconnected.
+	  *
+	  * @param tr transport service
+	  */
+	void discard(shared_ptr <transport> tr);
+
+	/** Opens new connections (including authentication), so that
+	  * the first messages sent do not have to wait for the connection
+	  * to be set up. Connections are opened one after the other on the
+	  * calling thread, and are kept idle in the pool.
+	  *
+	  * @param count number of connections wanted in the pool (limited
+	  * to the maximum number of connections); connections which are
+	  * already open, idle or in use, are counted
+	  * @throw exceptions::connection_error if a new connection could
+	  * not be established (connections opened so far are kept)
+	  */
+	void warmUp(const size_t count);
+
+	/** Sends a message using a connection from the pool. If the
+	  * message is rejected by the server, the connection is given back
+	  * to the pool; on any other error, it is closed. If an idle
+	  * connection has been closed by the server before the transaction
+	  * was started, the message is sent again once on a new connection.
+	  *
+	  * @param msg message to send
+	  * @param progress progress listener, or NULL if not used
+	  */
+	void send(shared_ptr <vmime::message> msg, utility::progressListener* progress = NULL);
+
+	/** Sends a message using a connection from the pool.
+	  *
+	  * @param msg message to send
+	  * @param expeditor expeditor mailbox
+	  * @param recipients list of recipient mailboxes
+	  * @param progress progress listener, or NULL if not used
+	  * @param sender envelope sender (if empty, expeditor will be used)
+	  */
+	void send
+		(shared_ptr <vmime::message> msg,
+		 const mailbox& expeditor,
+		 const mailboxList& recipients,
+		 utility::progressListener* progress = NULL,
+		 const mailbox& sender = mailbox());
+
+	/** Sends several messages over several connections. Each connection
+	  * is used by its own thread, created with the platform handler; the
+	  * calling thread also sends messages. Not more connections than the
+	  * maximum number of connections of the pool (minus the connections
+	  * currently in use) are used; if the platform handler does not
+	  * support threads, all messages are sent on the calling thread
+	  * using a single connection.
+	  *
+	  * If a connection fails while a message is being sent, no more
+	  * messages are sent and the error is thrown: the message is not
+	  * sent again, as it may already have been delivered. An error
+	  * which occurred on another thread is thrown as a
+	  * exceptions::net_exception, whose other() is the original error.
+	  *
+	  * @param msgs messages to send
+	  * @param failed if not NULL, receives the index of each message
+	  * which was rejected by the server, in ascending order, and
+	  * processing continues with the next message; if NULL, the first
+	  * error is thrown
+	  * @param progress progress listener (unit is the number of messages),
+	  * or NULL if not used
+	  */
+	void sendBatch
+		(const std::vector <shared_ptr <vmime::message> >& msgs,
+		 std::vector <size_t>* failed = NULL,
+		 utility::progressListener* progress = NULL);
+
+	/** Closes the connections which have not been used for more than
+	  * the idle timeout. This is also done automatically each time a
+	  * connection is acquired.
+	  */
+	void closeIdleConnections();
+
+	/** Closes all the connections currently not in use. Connections
+	  * currently in use are closed when they are released.
+	  */
+	void disconnect();
+
+	/** Returns the number of connections currently in use.
+	  *
+	  * @return number of connections acquired and not yet released
+	  */
+	size_t getActiveConnectionCount() const;
+
+	/** Returns the number of idle connections in the pool.
+	  *
+	  * @return number of connections ready to be reused
+	  */
+	size_t getIdleConnectionCount() const;
+
+private:
+
+	transportPool(const transportPool&);
+
+	class batchQueue;
+	class batchWorker;
+
+	struct idleTransport
+	{
+		shared_ptr <transport> service;
+		unsigned long lastUsed;
+	};
+
+	/** What to do after a message could not be sent. */
+	enum sendErrorType
+	{
+		SEND_ERROR_REJECTED,      /**< Message rejected, connection can be reused. */
+		SEND_ERROR_NOT_STARTED,   /**< Connection closed, nothing has been sent. */
+		SEND_ERROR_FATAL          /**< Connection in an unknown state. */
+	};
+
+	shared_ptr <transport> createTransport();
+	shared_ptr <transport> acquireConnection(bool* reused);
+
+	void sendMessage
+		(shared_ptr <vmime::message> msg,
+		 const mailbox* expeditor, const mailboxList* recipients,
+		 utility::progressListener* progress, const mailbox& sender);
+
+	void processBatch(batchQueue& queue);
+
+	static sendErrorType getSendErrorType();
+
+	void expireIdleConnections
+		(const unsigned long now, std::vector <shared_ptr <transport> >& expired);
+
+	static void disconnectQuietly(shared_ptr <transport> tr);
+
+
+	shared_ptr <session> m_session;
+	utility::url m_url;
+	shared_ptr <security::authenticator> m_auth;
+
+#if VMIME_HAVE_TLS_SUPPORT
+	shared_ptr <security::cert::certificateVerifier> m_certVerifier;
+#endif // VMIME_HAVE_TLS_SUPPORT
+	shared_ptr <socketFactory> m_socketFactory;
+	shared_ptr <timeoutHandlerFactory> m_toHandlerFactory;
+
+	size_t m_maxConnections;
+	unsigned long m_idleTimeout;
+	unsigned long m_healthCheckInterval;
+
+	std::list <idleTransport> m_idle;
+	size_t m_activeCount;
+
+	shared_ptr <utility::sync::criticalSection> m_lock;
+};
+
+
+} // net
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
+
+#endif // VMIME_NET_TRANSPORTPOOL_HPP_INCLUDED
@@ -23,18 +23,25 @@
 
 #include "vmime/parsingContext.hpp"
 
+#include "vmime/utility/stringUtils.hpp"
+
 
 namespace vmime
 {
 
 
 parsingContext::parsingContext()
+	: m_parallelParsingThreadCount(0),
+	  m_parallelParsingThreshold(256 * 1024)
 {
 }
 
 
 parsingContext::parsingContext(const parsingContext& ctx)
-	: context(ctx)
+	: context(ctx),
+	  m_parallelParsingThreadCount(ctx.m_parallelParsingThreadCount),
+	  m_parallelParsingThreshold(ctx.m_parallelParsingThreshold),
+	  m_headerFieldFilter(ctx.m_headerFieldFilter)
 {
 }
 
@@ -46,4 +53,77 @@ parsingContext& parsingContext::getDefaultContext()
 }
 
 
+size_t parsingContext::getParallelParsingThreadCount() const
+{
+	return m_parallelParsingThreadCount;
+}
+
+
+void parsingContext::setParallelParsingThreadCount(const size_t count)
+{
+	m_parallelParsingThreadCount = count;
+}
+
+
+size_t parsingContext::getParallelParsingThreshold() const
+{
+	return m_parallelParsingThreshold;
+}
+
+
+void parsingContext::setParallelParsingThreshold(const size_t size)
+{
+	m_parallelParsingThreshold = size;
+}
+
+
+const std::vector <string>& parsingContext::getHeaderFieldFilter() const
+{
+	return m_headerFieldFilter;
+}
+
+
+void parsingContext::setHeaderFieldFilter(const std::vector <string>& names)
+{
+	m_headerFieldFilter.clear();
+
+	for (std::vector <string>::const_iterator it = names.begin() ; it != names.end() ; ++it)
+		m_headerFieldFilter.push_back(utility::stringUtils::toLower(*it));
+}
+
+
+bool parsingContext::isHeaderFieldSelected(const string& name) const
+{
+	if (m_headerFieldFilter.empty())
+		return true;
+
+	for (std::vector <string>::const_iterator it = m_headerFieldFilter.begin() ;
+	     it != m_headerFieldFilter.end() ; ++it)
+	{
+		if (name.length() == it->length() &&
+		    utility::stringUtils::isStringEqualNoCase(name, it->data(), it->length()))
+			return true;
+	}
+
+	return false;
+}
+
+
+parsingContext& parsingContext::operator=(const parsingContext& ctx)
+{
+	copyFrom(ctx);
+	return *this;
+}
+
+
+void parsingContext::copyFrom(const parsingContext& ctx)
+{
+	context::copyFrom(ctx);
+
+	m_parallelParsingThreadCount = ctx.m_parallelParsingThreadCount;
+	m_parallelParsingThreshold = ctx.m_parallelParsingThreshold;
+	m_headerFieldFilter = ctx.m_headerFieldFilter;
+}
+
+
 } // vmime
@@ -27,6 +27,8 @@
 
 #include "vmime/context.hpp"
 
+#include <vector>
+
 
 namespace vmime
 {
@@ -43,13 +45,85 @@ public:
 	parsingContext(const parsingContext& ctx);
 
 	/** Returns the default context used for parsing messages.
+	  * The default context must not be modified while messages
+	  * are being parsed by other threads.
 	  *
 	  * @return a reference to the default parsing context
 	  */
 	static parsingContext& getDefaultContext();
 
+	/** Returns the number of threads used to parse the parts of
+	  * a multipart body concurrently.
+	  *
+	  * @return number of threads, or 0 if parts are parsed sequentially
+	  */
+	size_t getParallelParsingThreadCount() const;
+
+	/** Sets the number of threads used to parse the parts of a
+	  * multipart body concurrently. This is disabled by default.
+	  *
+	  * When enabled, the boundaries of a multipart body are located
+	  * first, then the parts whose size is at least the threshold set
+	  * with setParallelParsingThreshold() are parsed on a pool of
+	  * threads (smaller parts are parsed on the calling thread). Parts
+	  * parsed concurrently are copied into memory, even if the message
+	  * is parsed from a stream.
+	  *
+	  * @param count number of threads, or 0 to parse parts sequentially
+	  */
+	void setParallelParsingThreadCount(const size_t count);
+
+	/** Returns the minimum size of a part for it to be parsed on
+	  * a separate thread.
+	  *
+	  * @return minimum part size, in bytes
+	  */
+	size_t getParallelParsingThreshold() const;
+
+	/** Sets the minimum size of a part for it to be parsed on a
+	  * separate thread, when parallel parsing is enabled. The default
+	  * is 256 KB.
+	  *
+	  * @param size minimum part size, in bytes
+	  */
+	void setParallelParsingThreshold(const size_t size);
+
+	/** Returns the names of the header fields to parse.
+	  *
+	  * @return field names (in lower case), or an empty list if
+	  * all fields are parsed
+	  */
+	const std::vector <string>& getHeaderFieldFilter() const;
+
+	/** Restricts header parsing to the specified fields. Other fields
+	  * are skipped without their value being parsed, and do not appear
+	  * in the parsed header. This applies to all the headers parsed
+	  * with this context, including those of body parts. By default,
+	  * all fields are parsed.
+	  *
+	  * @param names names of the fields to parse (case-insensitive),
+	  * or an empty list to parse all fields
+	  */
+	void setHeaderFieldFilter(const std::vector <string>& names);
+
+	/** Tests whether a header field is to be parsed, according to the
+	  * filter set with setHeaderFieldFilter().
+	  *
+	  * @param name field name
+	  * @return true if the field is to be parsed, false if it should
+	  * be skipped
+	  */
+	bool isHeaderFieldSelected(const string& name) const;
+
+	parsingContext& operator=(const parsingContext& ctx);
+	void copyFrom(const parsingContext& ctx);
+
 protected:
 
+	size_t m_parallelParsingThreadCount;
+	size_t m_parallelParsingThreshold;
+
+	std::vector <string> m_headerFieldFilter;
 };
 
 
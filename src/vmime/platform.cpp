@@ -40,6 +40,20 @@ platform::handler::~handler()
 }
 
 
+vmime_uint64 platform::handler::getMonotonicTime() const
+{
+	return static_cast <vmime_uint64>(getUnixTime()) * 1000000;
+}
+
+
+shared_ptr <utility::sync::thread> platform::handler::createThread
+	(shared_ptr <utility::sync::runnable> /* task */)
+{
+	// Threads not supported
+	return null;
+}
+
+
 // static
 shared_ptr <platform::handler> platform::getDefaultHandler()
 {
@@ -41,6 +41,8 @@
 #endif
 
 #include "vmime/utility/sync/criticalSection.hpp"
+#include "vmime/utility/sync/thread.hpp"
+#include "vmime/utility/sync/runnable.hpp"
 
 
 namespace vmime
@@ -71,6 +73,16 @@ public:
 		  */
 		virtual unsigned long getUnixTime() const = 0;
 
+		/** Return the current value of a monotonic clock, which is
+		  * not affected by changes of the system time. Used to
+		  * measure elapsed time. The default implementation is based
+		  * on getUnixTime(), so it has a resolution of one second and
+		  * is not monotonic.
+		  *
+		  * @return time in microseconds, from an unspecified origin
+		  */
+		virtual vmime_uint64 getMonotonicTime() const;
+
 		/** Return the current date and time, in the local time zone.
 		  *
 		  * @return current date and time
@@ -138,6 +150,17 @@ public:
 		/** Creates and initializes a critical section.
 		  */
 		virtual shared_ptr <utility::sync::criticalSection> createCriticalSection() = 0;
+
+		/** Creates a new thread which runs the specified task.
+		  * The default implementation does not support threads and
+		  * returns NULL: the work is then done on the calling thread.
+		  *
+		  * @param task task to run on the new thread
+		  * @return thread object, which must be joined before
+		  * the task is destroyed, or NULL if threads are not supported
+		  * @throw exceptions::system_error if the thread cannot be created
+		  */
+		virtual shared_ptr <utility::sync::thread> createThread(shared_ptr <utility::sync::runnable> task);
 	};
 
 
@@ -0,0 +1,239 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/platforms/posix/posixAddressCache.hpp"
+
+#include "vmime/platform.hpp"
+#include "vmime/exception.hpp"
+
+#include "vmime/utility/sync/autoLock.hpp"
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <string.h>
+
+#include <sstream>
+
+
+namespace vmime {
+namespace platforms {
+namespace posix {
+
+
+typedef utility::sync::autoLock <utility::sync::criticalSection> cacheLock;
+
+
+const unsigned int posixAddressCache::DEFAULT_TTL = 300;  // 5 minutes
+
+
+posixAddressCache::posixAddressCache(const unsigned int ttl)
+	: m_ttl(ttl), m_hitCount(0), m_missCount(0),
+	  m_lock(platform::getHandler()->createCriticalSection())
+{
+}
+
+
+// static
+const string posixAddressCache::makeKey(const string& host, const port_t port)
+{
+	std::ostringstream oss;
+	oss.imbue(std::locale::classic());
+	oss << host << ':' << port;
+
+	return oss.str();
+}
+
+
+void posixAddressCache::resolve(const string& host, const port_t port, std::vector <address>& addresses)
+{
+	const string key = makeKey(host, port);
+
+	{
+		cacheLock lock(m_lock);
+
+		EntryMap::iterator it = m_entries.find(key);
+
+		if (it != m_entries.end())
+		{
+			if (it->second.expires > ::time(NULL))
+			{
+				++m_hitCount;
+				addresses = it->second.addresses;
+
+				return;
+			}
+
+			m_entries.erase(it);
+		}
+
+		++m_missCount;
+	}
+
+	// Do not hold the lock while querying
+	resolveUncached(host, port, addresses);
+
+	cacheLock lock(m_lock);
+
+	entry& e = m_entries[key];
+	e.addresses = addresses;
+	e.expires = ::time(NULL) + m_ttl;
+}
+
+
+// static
+void posixAddressCache::resolveUncached(const string& host, const port_t port, std::vector <address>& addresses)
+{
+	addresses.clear();
+
+#if VMIME_HAVE_GETADDRINFO  // use thread-safe and IPv6-aware getaddrinfo() if available
+
+	struct ::addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+
+	hints.ai_family = PF_UNSPEC;  // both A and AAAA records
+	hints.ai_socktype = SOCK_STREAM;
+
+	std::ostringstream portStr;
+	portStr.imbue(std::locale::classic());
+
+	portStr << port;
+
+	struct ::addrinfo* res0;
+
+	if (::getaddrinfo(host.c_str(), portStr.str().c_str(), &hints, &res0) != 0)
+		throw vmime::exceptions::connection_error("Cannot resolve address.");
+
+	for (struct ::addrinfo* res = res0 ; res != NULL ; res = res->ai_next)
+	{
+		if (res->ai_family != AF_INET && res->ai_family != AF_INET6)
+			continue;
+
+		if (res->ai_addrlen > sizeof(sockaddr_storage))
+			continue;
+
+		address addr;
+		memset(&addr, 0, sizeof(addr));
+
+		addr.family = res->ai_family;
+		addr.socketType = res->ai_socktype;
+		addr.protocol = res->ai_protocol;
+		addr.length = static_cast <socklen_t>(res->ai_addrlen);
+
+		memcpy(&addr.storage, res->ai_addr, res->ai_addrlen);
+
+		addresses.push_back(addr);
+	}
+
+	::freeaddrinfo(res0);
+
+#else // !VMIME_HAVE_GETADDRINFO
+
+	::sockaddr_in sin;
+	memset(&sin, 0, sizeof(sin));
+
+	sin.sin_family = AF_INET;
+	sin.sin_port = htons(static_cast <unsigned short>(port));
+	sin.sin_addr.s_addr = ::inet_addr(host.c_str());
+
+	if (sin.sin_addr.s_addr == static_cast <in_addr_t>(-1))
+	{
+		::hostent* hostInfo = ::gethostbyname(host.c_str());
+
+		if (hostInfo == NULL)
+			throw vmime::exceptions::connection_error("Cannot resolve address.");
+
+		::memcpy(reinterpret_cast <char*>(&sin.sin_addr), hostInfo->h_addr, hostInfo->h_length);
+	}
+
+	address addr;
+	memset(&addr, 0, sizeof(addr));
+
+	addr.family = AF_INET;
+	addr.socketType = SOCK_STREAM;
+	addr.protocol = 0;
+	addr.length = sizeof(sin);
+
+	memcpy(&addr.storage, &sin, sizeof(sin));
+
+	addresses.push_back(addr);
+
+#endif // VMIME_HAVE_GETADDRINFO
+
+	if (addresses.empty())
+		throw vmime::exceptions::connection_error("Cannot resolve address.");
+}
+
+
+void posixAddressCache::invalidate(const string& host, const port_t port)
+{
+	cacheLock lock(m_lock);
+
+	m_entries.erase(makeKey(host, port));
+}
+
+
+void posixAddressCache::clear()
+{
+	cacheLock lock(m_lock);
+
+	m_entries.clear();
+}
+
+
+size_t posixAddressCache::getEntryCount() const
+{
+	cacheLock lock(m_lock);
+
+	return m_entries.size();
+}
+
+
+size_t posixAddressCache::getHitCount() const
+{
+	cacheLock lock(m_lock);
+
+	return m_hitCount;
+}
+
+
+size_t posixAddressCache::getMissCount() const
+{
+	cacheLock lock(m_lock);
+
+	return m_missCount;
+}
+
+
+} // posix
+} // platforms
+} // vmime
+
+
+#endif // VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
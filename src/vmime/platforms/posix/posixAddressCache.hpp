@@ -0,0 +1,170 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_PLATFORMS_POSIX_ADDRESSCACHE_HPP_INCLUDED
+#define VMIME_PLATFORMS_POSIX_ADDRESSCACHE_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include <map>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include "vmime/base.hpp"
+
+#include "vmime/utility/sync/criticalSection.hpp"
+
+
+namespace vmime {
+namespace platforms {
+namespace posix {
+
+
+/** Caches the result of host name resolution, so that reconnecting
+  * to a server does not require a DNS query each time.
+  *
+  * The system resolver does not report record TTLs, so entries are kept
+  * for a fixed delay. Entries are discarded when connection fails on all
+  * the addresses, so that a stale entry does not prevent reconnecting.
+  *
+  * This class is thread-safe, and may be shared by several socket
+  * factories (see posixSocketFactory::setAddressCache()).
+  */
+class VMIME_EXPORT posixAddressCache : public object
+{
+public:
+
+	/** A resolved socket address. */
+	struct address
+	{
+		int family;
+		int socketType;
+		int protocol;
+
+		socklen_t length;
+		sockaddr_storage storage;
+	};
+
+
+	/** Default time during which an entry is kept (in seconds). */
+	static const unsigned int DEFAULT_TTL;
+
+
+	/** Construct a new, empty cache.
+	  *
+	  * @param ttl time during which an entry is kept, in seconds
+	  */
+	posixAddressCache(const unsigned int ttl = DEFAULT_TTL);
+
+	/** Resolve a host name, using the cached result if it has
+	  * not expired.
+	  *
+	  * @param host host name or numeric address
+	  * @param port port number
+	  * @param addresses will receive the addresses, in the order
+	  * returned by the system resolver
+	  * @throw exceptions::connection_error if the name cannot be resolved
+	  */
+	void resolve(const string& host, const port_t port, std::vector <address>& addresses);
+
+	/** Resolve a host name, without using a cache. IPv4 and IPv6
+	  * addresses are queried at the same time.
+	  *
+	  * @param host host name or numeric address
+	  * @param port port number
+	  * @param addresses will receive the addresses, in the order
+	  * returned by the system resolver
+	  * @throw exceptions::connection_error if the name cannot be resolved
+	  */
+	static void resolveUncached(const string& host, const port_t port, std::vector <address>& addresses);
+
+	/** Discard the cached entry for the specified host, if any.
+	  *
+	  * @param host host name or numeric address
+	  * @param port port number
+	  */
+	void invalidate(const string& host, const port_t port);
+
+	/** Discard all the cached entries.
+	  */
+	void clear();
+
+	/** Return the number of cached entries (including expired ones
+	  * which have not been discarded yet).
+	  *
+	  * @return number of entries
+	  */
+	size_t getEntryCount() const;
+
+	/** Return the number of resolutions which used the cache.
+	  *
+	  * @return number of cache hits
+	  */
+	size_t getHitCount() const;
+
+	/** Return the number of resolutions which required a query.
+	  *
+	  * @return number of cache misses
+	  */
+	size_t getMissCount() const;
+
+private:
+
+	struct entry
+	{
+		std::vector <address> addresses;
+		time_t expires;
+	};
+
+	typedef std::map <string, entry> EntryMap;
+
+	static const string makeKey(const string& host, const port_t port);
+
+
+	const unsigned int m_ttl;
+
+	EntryMap m_entries;
+
+	size_t m_hitCount;
+	size_t m_missCount;
+
+	shared_ptr <utility::sync::criticalSection> m_lock;
+};
+
+
+} // posix
+} // platforms
+} // vmime
+
+
+#endif // VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
+
+#endif // VMIME_PLATFORMS_POSIX_ADDRESSCACHE_HPP_INCLUDED
@@ -0,0 +1,441 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/platforms/posix/posixAsyncEngine.hpp"
+
+#include "vmime/exception.hpp"
+
+#if VMIME_HAVE_TLS_SUPPORT
+#	include "vmime/net/tls/TLSSessionCache.hpp"
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+#include <time.h>
+
+
+namespace vmime {
+namespace platforms {
+namespace posix {
+
+
+posixAsyncEngine::posixAsyncEngine()
+	: m_reactor(make_shared <posixSocketReactor>()), m_stop(false),
+	  m_connectionTimeout(30000)
+{
+}
+
+
+posixAsyncEngine::~posixAsyncEngine()
+{
+	for (ConnectionMap::iterator it = m_connections.begin() ; it != m_connections.end() ; ++it)
+	{
+		it->second.conn->detach();
+
+		try
+		{
+			it->second.socket->disconnect();
+		}
+		catch (...)
+		{
+			// Don't throw in destructor
+		}
+	}
+}
+
+
+void posixAsyncEngine::connect
+	(shared_ptr <vmime::net::asyncConnection> conn, const string& address, const port_t port)
+{
+	connectionInfo info;
+	info.conn = conn;
+	info.address = address;
+	info.port = port;
+
+	startConnection(info);
+}
+
+
+#if VMIME_HAVE_TLS_SUPPORT
+
+void posixAsyncEngine::connectTLS
+	(shared_ptr <vmime::net::asyncConnection> conn, const string& address,
+	 const port_t port, shared_ptr <vmime::net::tls::TLSSession> tlsSession)
+{
+	connectionInfo info;
+	info.conn = conn;
+	info.address = address;
+	info.port = port;
+	info.tlsSession = tlsSession;
+
+	startConnection(info);
+}
+
+
+void posixAsyncEngine::startTLS
+	(shared_ptr <vmime::net::asyncConnection> conn, shared_ptr <vmime::net::tls::TLSSession> tlsSession)
+{
+	ConnectionMap::iterator it = m_connections.find(conn.get());
+
+	if (it == m_connections.end() || it->second.connecting || it->second.tlsSocket)
+		throw exceptions::socket_not_connected_exception();
+
+	connectionInfo& info = it->second;
+
+	try
+	{
+		info.tlsSocket = tlsSession->getSocket(info.socket);
+
+		info.tlsSocket->setServerIdentity(vmime::net::tls::TLSSessionCache::makeServerIdentity
+			(info.address, info.port));
+
+		// The connection is not attached until the handshake is complete
+		conn->detach();
+
+		if (m_connectionTimeout != 0)
+			info.deadline = getMonotonicTime() + m_connectionTimeout;
+
+		continueHandshake(info);
+	}
+	catch (exception& e)
+	{
+		removeConnection(conn.get(), e);
+	}
+}
+
+
+void posixAsyncEngine::continueHandshake(connectionInfo& info)
+{
+	info.tlsWants = info.tlsSocket->handshakeNonBlocking();
+
+	if (info.tlsWants != 0)
+	{
+		// Resume when the socket is ready
+		updateInterest(info);
+		return;
+	}
+
+	shared_ptr <vmime::net::tls::TLSSocket> tlsSocket = info.tlsSocket;
+
+	info.tlsSocket = null;
+	info.deadline = 0;
+
+	info.conn->attach(tlsSocket, dynamicCast <posixAsyncEngine>(shared_from_this()));
+}
+
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+
+void posixAsyncEngine::startConnection(connectionInfo& info)
+{
+	if (m_connections.find(info.conn.get()) != m_connections.end())
+		disconnect(info.conn);
+
+	info.socket = make_shared <posixSocket>(shared_ptr <vmime::net::timeoutHandler>());
+	info.socket->setNonBlocking(true);
+
+	info.connecting = true;
+	info.events = 0;
+	info.deadline = 0;
+
+#if VMIME_HAVE_TLS_SUPPORT
+	info.tlsWants = 0;
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+	if (m_connectionTimeout != 0)
+		info.deadline = getMonotonicTime() + m_connectionTimeout;
+
+	try
+	{
+		info.socket->startConnect(info.address, info.port);
+	}
+	catch (exception& e)
+	{
+		info.conn->fail(e);
+		return;
+	}
+
+	m_sockets[info.socket.get()] = info.conn.get();
+
+	updateInterest(m_connections[info.conn.get()] = info);
+}
+
+
+void posixAsyncEngine::disconnect(shared_ptr <vmime::net::asyncConnection> conn)
+{
+	removeConnection(conn.get(), exceptions::socket_not_connected_exception("Disconnected."));
+}
+
+
+void posixAsyncEngine::removeConnection(vmime::net::asyncConnection* key, const exception& e)
+{
+	ConnectionMap::iterator it = m_connections.find(key);
+
+	if (it == m_connections.end())
+		return;
+
+	shared_ptr <vmime::net::asyncConnection> conn = it->second.conn;
+	shared_ptr <posixSocket> sok = it->second.socket;
+
+	m_sockets.erase(sok.get());
+	m_connections.erase(it);
+
+	m_reactor->unregisterSocket(sok);
+
+	try
+	{
+		// Also shuts down the security layer, if any
+		shared_ptr <vmime::net::socket> connSocket = conn->getSocket();
+
+		if (connSocket)
+			connSocket->disconnect();
+		else
+			sok->disconnect();
+	}
+	catch (exception&)
+	{
+		// Ignore
+	}
+
+	conn->fail(e);
+}
+
+
+size_t posixAsyncEngine::runOnce(const int msecs)
+{
+	std::vector <shared_ptr <posixSocket> > ready;
+	m_reactor->wait(ready, getWaitTime(msecs));
+
+	size_t count = 0;
+
+	for (size_t i = 0 ; i < ready.size() ; ++i)
+	{
+		// The connection may have been removed by a handler
+		SocketMap::const_iterator it = m_sockets.find(ready[i].get());
+
+		if (it == m_sockets.end())
+			continue;
+
+		processConnection(it->second);
+		++count;
+	}
+
+	return count + expireConnections();
+}
+
+
+int posixAsyncEngine::getWaitTime(const int msecs) const
+{
+	int waitTime = msecs;
+
+	// Wake up in time to fail connections which are not established yet
+	const vmime_uint64 now = getMonotonicTime();
+
+	for (ConnectionMap::const_iterator it = m_connections.begin() ; it != m_connections.end() ; ++it)
+	{
+		const vmime_uint64 deadline = it->second.deadline;
+
+		if (deadline == 0)
+			continue;
+
+		const int remaining = (deadline > now) ? static_cast <int>(deadline - now) : 0;
+
+		if (waitTime < 0 || remaining < waitTime)
+			waitTime = remaining;
+	}
+
+	return waitTime;
+}
+
+
+size_t posixAsyncEngine::expireConnections()
+{
+	std::vector <vmime::net::asyncConnection*> expired;
+
+	const vmime_uint64 now = getMonotonicTime();
+
+	for (ConnectionMap::const_iterator it = m_connections.begin() ; it != m_connections.end() ; ++it)
+	{
+		if (it->second.deadline != 0 && it->second.deadline <= now)
+			expired.push_back(it->first);
+	}
+
+	for (size_t i = 0 ; i < expired.size() ; ++i)
+		removeConnection(expired[i], exceptions::operation_timed_out());
+
+	return expired.size();
+}
+
+
+// static
+vmime_uint64 posixAsyncEngine::getMonotonicTime()
+{
+	::timespec ts;
+	::clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return static_cast <vmime_uint64>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+
+void posixAsyncEngine::processConnection(vmime::net::asyncConnection* key)
+{
+	ConnectionMap::iterator it = m_connections.find(key);
+
+	shared_ptr <vmime::net::asyncConnection> conn = it->second.conn;
+
+	try
+	{
+		if (it->second.connecting)
+		{
+			if (!it->second.socket->finishConnect())
+				return;
+
+			it->second.connecting = false;
+			it->second.deadline = 0;
+
+#if VMIME_HAVE_TLS_SUPPORT
+			if (it->second.tlsSession)
+			{
+				shared_ptr <vmime::net::tls::TLSSession> tlsSession = it->second.tlsSession;
+				it->second.tlsSession = null;
+
+				startTLS(conn, tlsSession);
+			}
+			else
+#endif // VMIME_HAVE_TLS_SUPPORT
+			{
+				conn->attach(it->second.socket, dynamicCast <posixAsyncEngine>(shared_from_this()));
+			}
+		}
+#if VMIME_HAVE_TLS_SUPPORT
+		else if (it->second.tlsSocket)
+		{
+			continueHandshake(it->second);
+		}
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+		// The handshake may have failed, or may still be in progress
+		it = m_connections.find(key);
+
+		if (it == m_connections.end())
+			return;
+
+#if VMIME_HAVE_TLS_SUPPORT
+		if (it->second.tlsSocket)
+			return;
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+		conn->processInput();
+		conn->processOutput();
+	}
+	catch (exception& e)
+	{
+		removeConnection(key, e);
+		return;
+	}
+
+	// Handlers may have closed the connection
+	it = m_connections.find(key);
+
+	if (it != m_connections.end())
+		updateInterest(it->second);
+}
+
+
+void posixAsyncEngine::updateInterest(connectionInfo& info)
+{
+	int events = 0;
+
+	if (info.connecting)
+		events = posixSocketReactor::EVENT_WRITE;
+#if VMIME_HAVE_TLS_SUPPORT
+	else if (info.tlsSocket)
+		events = (info.tlsWants & vmime::net::socket::STATUS_WANT_WRITE)
+			? posixSocketReactor::EVENT_WRITE : posixSocketReactor::EVENT_READ;
+#endif // VMIME_HAVE_TLS_SUPPORT
+	else if (info.conn->hasPendingOutput())
+		events = posixSocketReactor::EVENT_READ | posixSocketReactor::EVENT_WRITE;
+	else
+		events = posixSocketReactor::EVENT_READ;
+
+	if (events != info.events)
+	{
+		m_reactor->registerSocket(info.socket, events);
+		info.events = events;
+	}
+}
+
+
+void posixAsyncEngine::notifyOutputPending(shared_ptr <vmime::net::asyncConnection> conn)
+{
+	ConnectionMap::iterator it = m_connections.find(conn.get());
+
+	if (it != m_connections.end())
+		updateInterest(it->second);
+}
+
+
+void posixAsyncEngine::run()
+{
+	m_stop = false;
+
+	while (!m_stop && !m_connections.empty())
+		runOnce(-1);
+}
+
+
+void posixAsyncEngine::stop()
+{
+	m_stop = true;
+}
+
+
+size_t posixAsyncEngine::getConnectionCount() const
+{
+	return m_connections.size();
+}
+
+
+void posixAsyncEngine::setConnectionTimeout(const unsigned int msecs)
+{
+	m_connectionTimeout = msecs;
+}
+
+
+unsigned int posixAsyncEngine::getConnectionTimeout() const
+{
+	return m_connectionTimeout;
+}
+
+
+} // posix
+} // platforms
+} // vmime
+
+
+#endif // VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
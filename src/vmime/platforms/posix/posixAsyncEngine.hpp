@@ -0,0 +1,164 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_PLATFORMS_POSIX_ASYNCENGINE_HPP_INCLUDED
+#define VMIME_PLATFORMS_POSIX_ASYNCENGINE_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include <map>
+
+#include "vmime/net/asyncEngine.hpp"
+
+#include "vmime/platforms/posix/posixSocket.hpp"
+#include "vmime/platforms/posix/posixSocketReactor.hpp"
+
+#if VMIME_HAVE_TLS_SUPPORT
+#	include "vmime/net/tls/TLSSocket.hpp"
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+
+namespace vmime {
+namespace platforms {
+namespace posix {
+
+
+/** An asynchronous engine built on posixSocketReactor. Objects
+  * of this class must be created with make_shared().
+  *
+  * Connections are established and TLS handshakes are performed
+  * without blocking, and fail if they do not complete within the
+  * connection time-out (see setConnectionTimeout()). Note that host
+  * names are still resolved synchronously by connect() and connectTLS(),
+  * so numeric addresses should be used where this may take long.
+  */
+class VMIME_EXPORT posixAsyncEngine : public vmime::net::asyncEngine
+{
+public:
+
+	posixAsyncEngine();
+	~posixAsyncEngine();
+
+	void connect(shared_ptr <vmime::net::asyncConnection> conn, const string& address, const port_t port);
+
+#if VMIME_HAVE_TLS_SUPPORT
+
+	void connectTLS(shared_ptr <vmime::net::asyncConnection> conn, const string& address,
+		const port_t port, shared_ptr <vmime::net::tls::TLSSession> tlsSession);
+
+	void startTLS(shared_ptr <vmime::net::asyncConnection> conn, shared_ptr <vmime::net::tls::TLSSession> tlsSession);
+
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+	void disconnect(shared_ptr <vmime::net::asyncConnection> conn);
+
+	size_t runOnce(const int msecs);
+	void run();
+	void stop();
+
+	size_t getConnectionCount() const;
+
+	void notifyOutputPending(shared_ptr <vmime::net::asyncConnection> conn);
+
+	/** Set the maximum time allowed for establishing a connection,
+	  * including the TLS handshake, if any. The same limit applies to
+	  * handshakes started with startTLS(). Default is 30 seconds.
+	  *
+	  * @param msecs time-out, in milliseconds, or 0 for no time-out
+	  */
+	void setConnectionTimeout(const unsigned int msecs);
+
+	/** Return the maximum time allowed for establishing a connection.
+	  *
+	  * @return time-out, in milliseconds, or 0 if there is no time-out
+	  */
+	unsigned int getConnectionTimeout() const;
+
+private:
+
+	struct connectionInfo
+	{
+		shared_ptr <vmime::net::asyncConnection> conn;
+		shared_ptr <posixSocket> socket;
+
+		string address;
+		port_t port;
+
+		bool connecting;
+		int events;
+
+		vmime_uint64 deadline;   // monotonic time, in milliseconds (0 if none)
+
+#if VMIME_HAVE_TLS_SUPPORT
+		shared_ptr <vmime::net::tls::TLSSession> tlsSession;
+		shared_ptr <vmime::net::tls::TLSSocket> tlsSocket;   // while handshaking
+		unsigned int tlsWants;
+#endif // VMIME_HAVE_TLS_SUPPORT
+	};
+
+	typedef std::map <vmime::net::asyncConnection*, connectionInfo> ConnectionMap;
+	typedef std::map <posixSocket*, vmime::net::asyncConnection*> SocketMap;
+
+
+	void startConnection(connectionInfo& info);
+
+	void processConnection(vmime::net::asyncConnection* key);
+	void updateInterest(connectionInfo& info);
+
+#if VMIME_HAVE_TLS_SUPPORT
+	void continueHandshake(connectionInfo& info);
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+	size_t expireConnections();
+	int getWaitTime(const int msecs) const;
+
+	static vmime_uint64 getMonotonicTime();
+
+	void removeConnection(vmime::net::asyncConnection* conn, const exception& e);
+
+
+	shared_ptr <posixSocketReactor> m_reactor;
+
+	ConnectionMap m_connections;
+	SocketMap m_sockets;
+
+	bool m_stop;
+
+	unsigned int m_connectionTimeout;
+};
+
+
+} // posix
+} // platforms
+} // vmime
+
+
+#endif // VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
+
+#endif // VMIME_PLATFORMS_POSIX_ASYNCENGINE_HPP_INCLUDED
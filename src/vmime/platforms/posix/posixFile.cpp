@@ -35,12 +35,16 @@
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 
 #include <dirent.h>
 
 #include <stdio.h>
 #include <string.h>
 
+#include <algorithm>
+#include <limits>
+
 #include "vmime/exception.hpp"
 
 
@@ -169,8 +173,12 @@ void posixFileWriterOutputStream::flush()
 // posixFileReaderInputStream
 //
 
+const size_t posixFileReaderInputStream::BUFFER_SIZE;
+
+
 posixFileReaderInputStream::posixFileReaderInputStream(const vmime::utility::file::path& path, const int fd)
-	: m_path(path), m_fd(fd), m_eof(false)
+	: m_path(path), m_fd(fd), m_eof(false),
+	  m_bufferOffset(0), m_bufferLength(0), m_bufferPos(0)
 {
 }
 
@@ -190,61 +198,168 @@ bool posixFileReaderInputStream::eof() const
 
 void posixFileReaderInputStream::reset()
 {
-	if (::lseek(m_fd, 0, SEEK_SET) == off_t(-1))
-		posixFileSystemFactory::reportError(m_path, errno);
+	seek(0);
+}
 
-	m_eof = false;
+
+bool posixFileReaderInputStream::fillBuffer()
+{
+	// File descriptor is always positioned just after the buffered data
+	ssize_t c = 0;
+
+	while ((c = ::read(m_fd, m_buffer, BUFFER_SIZE)) == -1)
+	{
+		if (errno != EINTR)
+			posixFileSystemFactory::reportError(m_path, errno);
+	}
+
+	m_bufferOffset += m_bufferLength;
+	m_bufferLength = static_cast <size_t>(c);
+	m_bufferPos = 0;
+
+	return (c != 0);
 }
 
 
 size_t posixFileReaderInputStream::read
 	(byte_t* const data, const size_t count)
 {
-	ssize_t c = 0;
+	size_t total = 0;
 
-	if ((c = ::read(m_fd, data, count)) == -1)
-		posixFileSystemFactory::reportError(m_path, errno);
+	while (total < count)
+	{
+		if (m_bufferPos < m_bufferLength)
+		{
+			const size_t n = std::min(count - total, m_bufferLength - m_bufferPos);
 
-	if (c == 0 && count != 0)
-		m_eof = true;
+			::memcpy(data + total, m_buffer + m_bufferPos, n);
+
+			m_bufferPos += n;
+			total += n;
+		}
+		else if (!fillBuffer())
+		{
+			m_eof = true;
+			break;
+		}
+	}
 
-	return static_cast <size_t>(c);
+	return (total);
 }
 
 
 size_t posixFileReaderInputStream::skip(const size_t count)
 {
-	const off_t curPos = ::lseek(m_fd, 0, SEEK_CUR);
+	const size_t curPos = getPosition();
 
-	if (curPos == off_t(-1))
-		posixFileSystemFactory::reportError(m_path, errno);
+	seek(curPos + count);
+
+	return (count);
+}
+
+
+size_t posixFileReaderInputStream::getPosition() const
+{
+	return (m_bufferOffset + m_bufferPos);
+}
+
+
+void posixFileReaderInputStream::seek(const size_t pos)
+{
+	m_eof = false;
+
+	// Seek inside the buffer, if possible
+	if (pos >= m_bufferOffset && pos <= m_bufferOffset + m_bufferLength)
+	{
+		m_bufferPos = pos - m_bufferOffset;
+		return;
+	}
 
-	const off_t newPos = ::lseek(m_fd, count, SEEK_CUR);
+	const off_t newPos = ::lseek(m_fd, pos, SEEK_SET);
 
 	if (newPos == off_t(-1))
 		posixFileSystemFactory::reportError(m_path, errno);
 
-	return static_cast <size_t>(newPos - curPos);
+	m_bufferOffset = static_cast <size_t>(newPos);
+	m_bufferLength = 0;
+	m_bufferPos = 0;
 }
 
 
-size_t posixFileReaderInputStream::getPosition() const
+
+//
+// posixFileMappedInputStream
+//
+
+posixFileMappedInputStream::posixFileMappedInputStream
+	(const vmime::utility::file::path& path, void* data, const size_t length)
+	: m_path(path), m_data(data), m_length(length), m_position(0)
 {
-	const off_t curPos = ::lseek(m_fd, 0, SEEK_CUR);
+}
 
-	if (curPos == off_t(-1))
-		posixFileSystemFactory::reportError(m_path, errno);
 
-	return static_cast <size_t>(curPos);
+posixFileMappedInputStream::~posixFileMappedInputStream()
+{
+	// Must not throw: the mapping is released when the process exits
+	::munmap(m_data, m_length);
 }
 
 
-void posixFileReaderInputStream::seek(const size_t pos)
+bool posixFileMappedInputStream::eof() const
 {
-	const off_t newPos = ::lseek(m_fd, pos, SEEK_SET);
+	return (m_position >= m_length);
+}
 
-	if (newPos == off_t(-1))
-		posixFileSystemFactory::reportError(m_path, errno);
+
+void posixFileMappedInputStream::reset()
+{
+	m_position = 0;
+}
+
+
+size_t posixFileMappedInputStream::read
+	(byte_t* const data, const size_t count)
+{
+	const size_t n = std::min(count, m_length - m_position);
+
+	::memcpy(data, getData() + m_position, n);
+	m_position += n;
+
+	return (n);
+}
+
+
+size_t posixFileMappedInputStream::skip(const size_t count)
+{
+	const size_t n = std::min(count, m_length - m_position);
+
+	m_position += n;
+
+	return (n);
+}
+
+
+size_t posixFileMappedInputStream::getPosition() const
+{
+	return (m_position);
+}
+
+
+void posixFileMappedInputStream::seek(const size_t pos)
+{
+	m_position = std::min(pos, m_length);
+}
+
+
+const byte_t* posixFileMappedInputStream::getData() const
+{
+	return (static_cast <const byte_t*>(m_data));
+}
+
+
+size_t posixFileMappedInputStream::getLength() const
+{
+	return (m_length);
 }
 
 
@@ -288,6 +403,27 @@ shared_ptr <vmime::utility::inputStream> posixFileReader::getInputStream()
 	if ((fd = ::open(m_nativePath.c_str(), O_RDONLY, 0640)) == -1)
 		posixFileSystemFactory::reportError(m_path, errno);
 
+	// Try to map regular files into memory
+	struct stat buf;
+
+	if (::fstat(fd, &buf) == 0 && S_ISREG(buf.st_mode) && buf.st_size > 0 &&
+	    static_cast <unsigned long long>(buf.st_size) <= std::numeric_limits <size_t>::max())
+	{
+		const size_t length = static_cast <size_t>(buf.st_size);
+		void* data = ::mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		if (data != MAP_FAILED)
+		{
+			::posix_madvise(data, length, POSIX_MADV_SEQUENTIAL);
+
+			// Mapping remains valid after the descriptor is closed
+			::close(fd);
+
+			return make_shared <posixFileMappedInputStream>(m_path, data, length);
+		}
+	}
+
+	// Fall back to buffered reads
 	return make_shared <posixFileReaderInputStream>(m_path, fd);
 }
 
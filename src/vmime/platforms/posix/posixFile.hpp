@@ -64,6 +64,11 @@ private:
 
 
 
+/** Buffered input stream over a file descriptor. Data is read
+  * by blocks, and the current position is tracked locally so that
+  * small reads and seeks within the buffer do not issue any syscall.
+  */
+
 class posixFileReaderInputStream : public vmime::utility::seekableInputStream
 {
 public:
@@ -84,10 +89,72 @@ public:
 
 private:
 
+	static const size_t BUFFER_SIZE = 16384;
+
+	bool fillBuffer();
+
 	const vmime::utility::file::path m_path;
 	const int m_fd;
 
 	bool m_eof;
+
+	byte_t m_buffer[BUFFER_SIZE];
+	size_t m_bufferOffset;  // file offset of the first byte in buffer
+	size_t m_bufferLength;  // number of valid bytes in buffer
+	size_t m_bufferPos;     // current position in buffer
+};
+
+
+
+/** Input stream over a file which has been mapped into memory.
+  * Reading and seeking are simple memory operations.
+  */
+
+class posixFileMappedInputStream : public vmime::utility::seekableInputStream
+{
+public:
+
+	/** Construct a new stream from a memory-mapped file. The stream
+	  * takes ownership of the mapping, and will unmap it when destroyed.
+	  *
+	  * @param path path of the mapped file (used for error reporting)
+	  * @param data pointer to mapped memory
+	  * @param length length of mapped memory, in bytes
+	  */
+	posixFileMappedInputStream(const vmime::utility::file::path& path, void* data, const size_t length);
+	~posixFileMappedInputStream();
+
+	bool eof() const;
+
+	void reset();
+
+	size_t read(byte_t* const data, const size_t count);
+
+	size_t skip(const size_t count);
+
+	size_t getPosition() const;
+	void seek(const size_t pos);
+
+	/** Return a pointer to the mapped file contents.
+	  *
+	  * @return pointer to the first byte of the file
+	  */
+	const byte_t* getData() const;
+
+	/** Return the length of the mapped file contents.
+	  *
+	  * @return file length, in bytes
+	  */
+	size_t getLength() const;
+
+private:
+
+	const vmime::utility::file::path m_path;
+
+	void* m_data;
+	const size_t m_length;
+
+	size_t m_position;
 };
 
 
@@ -114,6 +181,12 @@ public:
 
 	posixFileReader(const vmime::utility::file::path& path, const vmime::string& nativePath);
 
+	/** Return an input stream for reading the file. Regular files are
+	  * mapped into memory if possible; if not, a buffered stream is
+	  * returned. In both cases, the stream is seekable.
+	  *
+	  * @return input stream for reading the file
+	  */
 	shared_ptr <vmime::utility::inputStream> getInputStream();
 
 private:
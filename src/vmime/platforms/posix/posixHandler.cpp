@@ -30,10 +30,12 @@
 #include "vmime/platforms/posix/posixHandler.hpp"
 
 #include "vmime/platforms/posix/posixCriticalSection.hpp"
+#include "vmime/platforms/posix/posixThread.hpp"
 
 #include "vmime/utility/stringUtils.hpp"
 
 #include <time.h>
+#include <sys/time.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <locale.h>
@@ -129,6 +131,26 @@ unsigned long posixHandler::getUnixTime() const
 }
 
 
+vmime_uint64 posixHandler::getMonotonicTime() const
+{
+#if defined(CLOCK_MONOTONIC)
+	timespec ts;
+
+	if (::clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+	{
+		return static_cast <vmime_uint64>(ts.tv_sec) * 1000000
+			+ static_cast <vmime_uint64>(ts.tv_nsec) / 1000;
+	}
+#endif // defined(CLOCK_MONOTONIC)
+
+	timeval tv;
+	::gettimeofday(&tv, NULL);
+
+	return static_cast <vmime_uint64>(tv.tv_sec) * 1000000
+		+ static_cast <vmime_uint64>(tv.tv_usec);
+}
+
+
 const vmime::datetime posixHandler::getCurrentLocalTime() const
 {
 	const time_t t(::time(NULL));
@@ -292,6 +314,12 @@ shared_ptr <utility::sync::criticalSection> posixHandler::createCriticalSection(
 }
 
 
+shared_ptr <utility::sync::thread> posixHandler::createThread(shared_ptr <utility::sync::runnable> task)
+{
+	return make_shared <posixThread>(task);
+}
+
+
 } // posix
 } // platforms
 } // vmime
@@ -29,12 +29,14 @@
 
 #include "vmime/platforms/posix/posixSocket.hpp"
 #include "vmime/platforms/posix/posixHandler.hpp"
+#include "vmime/platforms/posix/posixSocketReactor.hpp"
 
 #include <unistd.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <poll.h>
 #include <netinet/in.h>
 #include <netdb.h>
 #include <fcntl.h>
@@ -42,9 +44,12 @@
 #include <string.h>
 
 #include "vmime/utility/stringUtils.hpp"
+#include "vmime/utility/instrumentation.hpp"
 
 #include "vmime/exception.hpp"
 
+#include <algorithm>
+
 
 #if defined(EWOULDBLOCK)
 #   define IS_EAGAIN(x)  ((x) == EAGAIN || (x) == EWOULDBLOCK || (x) == EINTR || (x) == EINPROGRESS)
@@ -58,12 +63,25 @@ namespace platforms {
 namespace posix {
 
 
+// Return the number of milliseconds elapsed since the specified time
+static long getElapsedMillis(const timeval& start)
+{
+	timeval now = { 0, 0 };
+	gettimeofday(&now, /* timezone */ NULL);
+
+	return (now.tv_sec - start.tv_sec) * 1000L + (now.tv_usec - start.tv_usec) / 1000L;
+}
+
+
 //
 // posixSocket
 //
 
-posixSocket::posixSocket(shared_ptr <vmime::net::timeoutHandler> th)
-	: m_timeoutHandler(th), m_desc(-1), m_status(0)
+posixSocket::posixSocket(shared_ptr <vmime::net::timeoutHandler> th,
+                         shared_ptr <posixSocketReactor> reactor)
+	: m_timeoutHandler(th), m_autoReactor(reactor), m_happyEyeballs(false),
+	  m_desc(-1), m_status(0), m_nonBlocking(false),
+	  m_connectIndex(0), m_connectPort(0)
 {
 }
 
@@ -71,7 +89,21 @@ posixSocket::posixSocket(shared_ptr <vmime::net::timeoutHandler> th)
 posixSocket::~posixSocket()
 {
 	if (m_desc != -1)
+	{
+		unregisterFromReactor();
 		::close(m_desc);
+	}
+}
+
+
+void posixSocket::unregisterFromReactor()
+{
+	shared_ptr <posixSocketReactor> reactor = m_reactor.lock();
+
+	if (reactor)
+		reactor->unregisterDescriptor(m_desc);
+
+	m_reactor.reset();
 }
 
 
@@ -80,49 +112,75 @@ void posixSocket::connect(const vmime::string& address, const vmime::port_t port
 	// Close current connection, if any
 	if (m_desc != -1)
 	{
+		unregisterFromReactor();
 		::close(m_desc);
 		m_desc = -1;
 	}
 
-#if VMIME_HAVE_GETADDRINFO  // use thread-safe and IPv6-aware getaddrinfo() if available
-
 	// Resolve address, if needed
-	struct ::addrinfo hints;
-	memset(&hints, 0, sizeof(hints));
+	std::vector <posixAddressCache::address> addresses;
+	resolve(address, port, addresses);
 
-	hints.ai_flags = AI_CANONNAME;
-	hints.ai_family = PF_UNSPEC;
-	hints.ai_socktype = SOCK_STREAM;
+	m_serverAddress = address;
 
-	std::ostringstream portStr;
-	portStr.imbue(std::locale::classic());
+	// Connect to host
+	int connectErrno = 0;
 
-	portStr << port;
+	if (m_timeoutHandler != NULL)
+		m_timeoutHandler->resetTimeOut();
 
-	struct ::addrinfo* res0;
+	const int sock = m_happyEyeballs
+		? connectHappyEyeballs(addresses, connectErrno)
+		: connectSequential(addresses, connectErrno);
 
-	if (::getaddrinfo(address.c_str(), portStr.str().c_str(), &hints, &res0) != 0)
+	if (sock == -1)
 	{
-		// Error: cannot resolve address
-		throw vmime::exceptions::connection_error("Cannot resolve address.");
+		// Addresses may be stale
+		if (m_addressCache)
+			m_addressCache->invalidate(address, port);
+
+		try
+		{
+			throwSocketError(connectErrno);
+		}
+		catch (exceptions::socket_exception& e)
+		{
+			throw vmime::exceptions::connection_error
+				("Error while connecting socket.", e);
+		}
 	}
 
-	m_serverAddress = address;
+	m_desc = sock;
 
-	// Connect to host
-	int sock = -1;
-	struct ::addrinfo* res = res0;
-	int connectErrno = 0;
+	::fcntl(m_desc, F_SETFL, ::fcntl(m_desc, F_GETFL) | O_NONBLOCK);
 
-	if (m_timeoutHandler != NULL)
-		m_timeoutHandler->resetTimeOut();
+	if (m_autoReactor)
+	{
+		m_autoReactor->registerSocket
+			(dynamicCast <posixSocket>(shared_from_this()), posixSocketReactor::EVENT_READ);
+	}
+}
+
+
+void posixSocket::resolve(const vmime::string& address, const vmime::port_t port,
+                          std::vector <posixAddressCache::address>& addresses)
+{
+	if (m_addressCache)
+		m_addressCache->resolve(address, port, addresses);
+	else
+		posixAddressCache::resolveUncached(address, port, addresses);
+}
 
-	for ( ; sock == -1 && res != NULL ; res = res->ai_next, connectErrno = ETIMEDOUT)
+
+int posixSocket::connectSequential(const std::vector <posixAddressCache::address>& addresses, int& connectErrno)
+{
+	int sock = -1;
+
+	for (size_t i = 0 ; sock == -1 && i < addresses.size() ; ++i, connectErrno = ETIMEDOUT)
 	{
-		if (res->ai_family != AF_INET && res->ai_family != AF_INET6)
-			continue;
+		const posixAddressCache::address& addr = addresses[i];
 
-		sock = ::socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+		sock = ::socket(addr.family, addr.socketType, addr.protocol);
 
 		if (sock < 0)
 		{
@@ -134,7 +192,7 @@ void posixSocket::connect(const vmime::string& address, const vmime::port_t port
 		{
 			::fcntl(sock, F_SETFL, ::fcntl(sock, F_GETFL) | O_NONBLOCK);
 
-			if (::connect(sock, res->ai_addr, res->ai_addrlen) < 0)
+			if (::connect(sock, reinterpret_cast <const sockaddr*>(&addr.storage), addr.length) < 0)
 			{
 				switch (errno)
 				{
@@ -162,7 +220,7 @@ void posixSocket::connect(const vmime::string& address, const vmime::port_t port
 				// Wait for socket to be connected.
 				bool connected = false;
 
-				const int selectTimeout = 1000;   // select() timeout (ms)
+				const int pollTimeout = 1000;     // poll() timeout (ms)
 				const int tryNextTimeout = 5000;  // maximum time before trying next (ms)
 
 				timeval startTime = { 0, 0 };
@@ -170,15 +228,12 @@ void posixSocket::connect(const vmime::string& address, const vmime::port_t port
 
 				do
 				{
-					struct timeval tm;
-					tm.tv_sec = selectTimeout / 1000;
-					tm.tv_usec = selectTimeout % 1000;
-
-					fd_set fds;
-					FD_ZERO(&fds);
-					FD_SET(sock, &fds);
+					::pollfd fds;
+					fds.fd = sock;
+					fds.events = POLLOUT;
+					fds.revents = 0;
 
-					const int ret = select(sock + 1, NULL, &fds, NULL, &tm);
+					const int ret = ::poll(&fds, 1, pollTimeout);
 
 					// Success
 					if (ret > 0)
@@ -201,7 +256,7 @@ void posixSocket::connect(const vmime::string& address, const vmime::port_t port
 						break;
 					}
 					// Error
-					else if (ret < -1)
+					else if (ret < 0)
 					{
 						if (errno != EINTR)
 						{
@@ -233,11 +288,8 @@ void posixSocket::connect(const vmime::string& address, const vmime::port_t port
 						}
 					}
 
-					timeval curTime = { 0, 0 };
-					gettimeofday(&curTime, /* timezone */ NULL);
-
-					if (res->ai_next != NULL &&
-						curTime.tv_usec - startTime.tv_usec >= tryNextTimeout * 1000)
+					if (i + 1 < addresses.size() &&
+						getElapsedMillis(startTime) >= tryNextTimeout)
 					{
 						connectErrno = ETIMEDOUT;
 						break;
@@ -262,7 +314,7 @@ void posixSocket::connect(const vmime::string& address, const vmime::port_t port
 		}
 		else
 		{
-			if (::connect(sock, res->ai_addr, res->ai_addrlen) < 0)
+			if (::connect(sock, reinterpret_cast <const sockaddr*>(&addr.storage), addr.length) < 0)
 			{
 				connectErrno = errno;
 				::close(sock);
@@ -272,86 +324,312 @@ void posixSocket::connect(const vmime::string& address, const vmime::port_t port
 		}
 	}
 
-	::freeaddrinfo(res0);
+	return sock;
+}
 
-	if (sock == -1)
+
+int posixSocket::connectHappyEyeballs(const std::vector <posixAddressCache::address>& addresses, int& connectErrno)
+{
+	// RFC-8305: interleave address families, starting with the
+	// family of the first address returned by the resolver
+	std::vector <const posixAddressCache::address*> order;
+	std::vector <const posixAddressCache::address*> first, second;
+
+	for (size_t i = 0 ; i < addresses.size() ; ++i)
 	{
-		try
+		if (addresses[i].family == addresses[0].family)
+			first.push_back(&addresses[i]);
+		else
+			second.push_back(&addresses[i]);
+	}
+
+	for (size_t i = 0 ; i < first.size() || i < second.size() ; ++i)
+	{
+		if (i < first.size())
+			order.push_back(first[i]);
+		if (i < second.size())
+			order.push_back(second[i]);
+	}
+
+	// Start a new attempt each time this delay elapses without any
+	// connection being established ("Connection Attempt Delay")
+	const int attemptDelay = 250;  // ms
+
+	std::vector < ::pollfd> attempts;
+	size_t next = 0;
+
+	timeval lastStart = { 0, 0 };
+	int sock = -1;
+
+	connectErrno = ETIMEDOUT;
+
+	while (sock == -1)
+	{
+		// Start next attempt
+		if (next < order.size() &&
+		    (attempts.empty() || getElapsedMillis(lastStart) >= attemptDelay))
 		{
-			throwSocketError(connectErrno);
+			const posixAddressCache::address& addr = *order[next++];
+
+			const int desc = ::socket(addr.family, addr.socketType, addr.protocol);
+
+			if (desc < 0)
+			{
+				connectErrno = errno;
+				continue;
+			}
+
+			::fcntl(desc, F_SETFL, ::fcntl(desc, F_GETFL) | O_NONBLOCK);
+
+			if (::connect(desc, reinterpret_cast <const sockaddr*>(&addr.storage), addr.length) == 0)
+			{
+				sock = desc;  // connected immediately
+				break;
+			}
+			else if (!IS_EAGAIN(errno))
+			{
+				connectErrno = errno;
+				::close(desc);
+				continue;
+			}
+
+			::pollfd fd;
+			fd.fd = desc;
+			fd.events = POLLOUT;
+			fd.revents = 0;
+
+			attempts.push_back(fd);
+
+			gettimeofday(&lastStart, /* timezone */ NULL);
 		}
-		catch (exceptions::socket_exception& e)
+
+		// All attempts failed
+		if (attempts.empty())
+			break;
+
+		// Wait for an attempt to complete, or for the next one to start
+		int pollTimeout = 1000;
+
+		if (next < order.size())
+			pollTimeout = static_cast <int>(std::max(0L, attemptDelay - getElapsedMillis(lastStart)));
+
+		const int ret = ::poll(&attempts[0], attempts.size(), pollTimeout);
+
+		if (ret < 0 && errno != EINTR)
 		{
-			throw vmime::exceptions::connection_error
-				("Error while connecting socket.", e);
+			connectErrno = errno;
+			break;
 		}
-	}
 
-	m_desc = sock;
+		for (size_t i = 0 ; ret > 0 && i < attempts.size() ; )
+		{
+			if (attempts[i].revents == 0)
+			{
+				++i;
+				continue;
+			}
 
-#else // !VMIME_HAVE_GETADDRINFO
+			int error = 0;
+			socklen_t len = sizeof(error);
 
-	// Resolve address
-	::sockaddr_in addr;
+			if (getsockopt(attempts[i].fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0)
+				error = errno;
 
-	memset(&addr, 0, sizeof(addr));
+			if (error == 0)
+			{
+				sock = attempts[i].fd;
+				attempts.erase(attempts.begin() + i);
 
-	addr.sin_family = AF_INET;
-	addr.sin_port = htons(static_cast <unsigned short>(port));
-	addr.sin_addr.s_addr = ::inet_addr(address.c_str());
+				break;
+			}
 
-	if (addr.sin_addr.s_addr == static_cast <in_addr_t>(-1))
-	{
-		::hostent* hostInfo = ::gethostbyname(address.c_str());
+			connectErrno = error;
 
-		if (hostInfo == NULL)
+			::close(attempts[i].fd);
+			attempts.erase(attempts.begin() + i);
+		}
+
+		// Check for timeout
+		if (sock == -1 && ret == 0 && m_timeoutHandler && m_timeoutHandler->isTimeOut())
 		{
-			// Error: cannot resolve address
-			throw vmime::exceptions::connection_error("Cannot resolve address.");
+			if (!m_timeoutHandler->handleTimeOut())
+			{
+				connectErrno = ETIMEDOUT;
+				break;
+			}
+
+			m_timeoutHandler->resetTimeOut();
 		}
+	}
+
+	// Cancel other attempts
+	for (size_t i = 0 ; i < attempts.size() ; ++i)
+		::close(attempts[i].fd);
+
+	return sock;
+}
+
 
-		::memcpy(reinterpret_cast <char*>(&addr.sin_addr), hostInfo->h_addr, hostInfo->h_length);
+void posixSocket::startConnect(const vmime::string& address, const vmime::port_t port)
+{
+	// Close current connection, if any
+	if (m_desc != -1)
+	{
+		unregisterFromReactor();
+		::close(m_desc);
+		m_desc = -1;
 	}
 
+	m_connectAddresses.clear();
+	resolve(address, port, m_connectAddresses);
+
 	m_serverAddress = address;
+	m_connectPort = port;
+	m_connectIndex = 0;
 
-	// Get a new socket
-	m_desc = ::socket(AF_INET, SOCK_STREAM, 0);
+	int connectErrno = 0;
 
-	if (m_desc == -1)
+	if (!startNextConnect(connectErrno))
+		throwConnectError(connectErrno);
+}
+
+
+bool posixSocket::startNextConnect(int& connectErrno)
+{
+	// Use the next address for which the connection can be started
+	while (m_desc == -1 && m_connectIndex < m_connectAddresses.size())
 	{
-		try
+		const posixAddressCache::address& addr = m_connectAddresses[m_connectIndex++];
+
+		const int sock = ::socket(addr.family, addr.socketType, addr.protocol);
+
+		if (sock < 0)
 		{
-			throwSocketError(errno);
+			connectErrno = errno;
+			continue;
 		}
-		catch (exceptions::socket_exception& e)
+
+		::fcntl(sock, F_SETFL, ::fcntl(sock, F_GETFL) | O_NONBLOCK);
+
+		if (::connect(sock, reinterpret_cast <const sockaddr*>(&addr.storage), addr.length) < 0 && !IS_EAGAIN(errno))
 		{
-			throw vmime::exceptions::connection_error
-				("Error while creating socket.", e);
+			connectErrno = errno;
+			::close(sock);
+			continue;
 		}
+
+		m_desc = sock;
 	}
 
-	// Start connection
-	if (::connect(m_desc, reinterpret_cast <sockaddr*>(&addr), sizeof(addr)) == -1)
+	return m_desc != -1;
+}
+
+
+void posixSocket::throwConnectError(const int connectErrno)
+{
+	m_connectAddresses.clear();
+
+	// Addresses may be stale
+	if (m_addressCache)
+		m_addressCache->invalidate(m_serverAddress, m_connectPort);
+
+	try
 	{
-		try
+		throwSocketError(connectErrno);
+	}
+	catch (exceptions::socket_exception& e)
+	{
+		throw vmime::exceptions::connection_error
+			("Error while connecting socket.", e);
+	}
+}
+
+
+bool posixSocket::finishConnect()
+{
+	if (m_desc == -1)
+		throw exceptions::socket_not_connected_exception();
+
+	::pollfd fds;
+	fds.fd = m_desc;
+	fds.events = POLLOUT;
+	fds.revents = 0;
+
+	if (::poll(&fds, 1, 0) <= 0)
+		return false;  // still in progress
+
+	int error = 0;
+	socklen_t len = sizeof(error);
+
+	if (getsockopt(m_desc, SOL_SOCKET, SO_ERROR, &error, &len) < 0)
+		error = errno;
+
+	if (error != 0)
+	{
+		shared_ptr <posixSocketReactor> reactor = m_reactor.lock();
+
+		unregisterFromReactor();
+		::close(m_desc);
+		m_desc = -1;
+
+		// Try the next address, like connect() does
+		if (!startNextConnect(error))
+			throwConnectError(error);
+
+		if (reactor)
 		{
-			throwSocketError(errno);
+			reactor->registerSocket
+				(dynamicCast <posixSocket>(shared_from_this()), posixSocketReactor::EVENT_WRITE);
 		}
-		catch (exceptions::socket_exception& e)
-		{
-			::close(m_desc);
-			m_desc = -1;
 
-			// Error
-			throw vmime::exceptions::connection_error
-				("Error while connecting socket.", e);
-		}
+		return false;
 	}
 
-#endif // VMIME_HAVE_GETADDRINFO
+	m_connectAddresses.clear();
 
-	::fcntl(m_desc, F_SETFL, ::fcntl(m_desc, F_GETFL) | O_NONBLOCK);
+	if (m_autoReactor)
+	{
+		m_autoReactor->registerSocket
+			(dynamicCast <posixSocket>(shared_from_this()), posixSocketReactor::EVENT_READ);
+	}
+
+	return true;
+}
+
+
+void posixSocket::setNonBlocking(const bool nonBlocking)
+{
+	m_nonBlocking = nonBlocking;
+}
+
+
+bool posixSocket::isNonBlocking() const
+{
+	return m_nonBlocking;
+}
+
+
+void posixSocket::setAddressCache(shared_ptr <posixAddressCache> cache)
+{
+	m_addressCache = cache;
+}
+
+
+shared_ptr <posixAddressCache> posixSocket::getAddressCache() const
+{
+	return m_addressCache;
+}
+
+
+void posixSocket::setHappyEyeballsEnabled(const bool enable)
+{
+	m_happyEyeballs = enable;
+}
+
+
+bool posixSocket::isHappyEyeballsEnabled() const
+{
+	return m_happyEyeballs;
 }
 
 
@@ -370,6 +648,8 @@ void posixSocket::disconnect()
 {
 	if (m_desc != -1)
 	{
+		unregisterFromReactor();
+
 		::shutdown(m_desc, SHUT_RDWR);
 		::close(m_desc);
 
@@ -477,46 +757,53 @@ size_t posixSocket::getBlockSize() const
 
 bool posixSocket::waitForData(const bool read, const bool write, const int msecs)
 {
-	for (int i = 0 ; i <= msecs / 10 ; ++i)
+	// Wake up at least once per second to check for time-out; poll() has
+	// no limit on the descriptor value, contrary to select()
+	const int maxPollTimeout = 1000;
+
+	int remaining = msecs;
+
+	do
 	{
-		// Check whether data is available
-		fd_set fds;
-		FD_ZERO(&fds);
-		FD_SET(m_desc, &fds);
+		const int pollTimeout = std::min(std::max(remaining, 0), maxPollTimeout);
 
-		struct timeval tv;
-		tv.tv_sec = 0;
-		tv.tv_usec = 10000;  // 10 ms
+		::pollfd fds;
+		fds.fd = m_desc;
+		fds.events = static_cast <short>((read ? POLLIN : 0) | (write ? POLLOUT : 0));
+		fds.revents = 0;
 
-		ssize_t ret = ::select(m_desc + 1, read ? &fds : NULL, write ? &fds : NULL, NULL, &tv);
+		const int ret = ::poll(&fds, 1, pollTimeout);
 
-		if (ret <= 0)
+		if (ret > 0)
 		{
-			if (ret < 0 && !IS_EAGAIN(errno))
-				throwSocketError(errno);
+			// Also returned on error or hang-up: the next read or
+			// write operation will report it
+			return true;
+		}
+
+		if (ret < 0 && !IS_EAGAIN(errno))
+			throwSocketError(errno);
 
-			// No data available at this time
-			// Check if we are timed out
-			if (m_timeoutHandler &&
-			    m_timeoutHandler->isTimeOut())
+		// No data available at this time
+		// Check if we are timed out
+		if (m_timeoutHandler &&
+		    m_timeoutHandler->isTimeOut())
+		{
+			if (!m_timeoutHandler->handleTimeOut())
 			{
-				if (!m_timeoutHandler->handleTimeOut())
-				{
-					// Server did not react within timeout delay
-					throw exceptions::operation_timed_out();
-				}
-				else
-				{
-					// Reset timeout
-					m_timeoutHandler->resetTimeOut();
-				}
+				// Server did not react within timeout delay
+				throw exceptions::operation_timed_out();
+			}
+			else
+			{
+				// Reset timeout
+				m_timeoutHandler->resetTimeOut();
 			}
 		}
-		else if (ret > 0)
-		{
-			return true;
-		}
-	}
+
+		remaining -= pollTimeout;
+
+	} while (remaining > 0);
 
 	return false;  // time out
 }
@@ -546,7 +833,7 @@ size_t posixSocket::receiveRaw(byte_t* buffer, const size_t count)
 	m_status &= ~STATUS_WOULDBLOCK;
 
 	// Check whether data is available
-	if (!waitForRead(50 /* msecs */))
+	if (!waitForRead(m_nonBlocking ? 0 : 50 /* msecs */))
 	{
 		m_status |= STATUS_WOULDBLOCK;
 
@@ -593,6 +880,12 @@ size_t posixSocket::receiveRaw(byte_t* buffer, const size_t count)
 		// Data received, reset timeout
 		if (m_timeoutHandler)
 			m_timeoutHandler->resetTimeOut();
+
+		if (utility::instrumentation::isEnabled())
+		{
+			utility::instrumentation::increment
+				(utility::instrumentation::SOCKET_RECEIVED_BYTES, "", ret);
+		}
 	}
 
 	return ret;
@@ -638,6 +931,9 @@ void posixSocket::sendRaw(const byte_t* buffer, const size_t count)
 	// Reset timeout
 	if (m_timeoutHandler)
 		m_timeoutHandler->resetTimeOut();
+
+	if (utility::instrumentation::isEnabled())
+		utility::instrumentation::increment(utility::instrumentation::SOCKET_SENT_BYTES, "", count);
 }
 
 
@@ -678,6 +974,9 @@ size_t posixSocket::sendRawNonBlocking(const byte_t* buffer, const size_t count)
 	if (m_timeoutHandler)
 		m_timeoutHandler->resetTimeOut();
 
+	if (utility::instrumentation::isEnabled())
+		utility::instrumentation::increment(utility::instrumentation::SOCKET_SENT_BYTES, "", ret);
+
 	return ret;
 }
 
@@ -735,16 +1034,63 @@ shared_ptr <net::timeoutHandler> posixSocket::getTimeoutHandler()
 // posixSocketFactory
 //
 
+posixSocketFactory::posixSocketFactory()
+	: m_happyEyeballs(false)
+{
+}
+
+
 shared_ptr <vmime::net::socket> posixSocketFactory::create()
 {
 	shared_ptr <vmime::net::timeoutHandler> th;
-	return make_shared <posixSocket>(th);
+	return create(th);
 }
 
 
 shared_ptr <vmime::net::socket> posixSocketFactory::create(shared_ptr <vmime::net::timeoutHandler> th)
 {
-	return make_shared <posixSocket>(th);
+	shared_ptr <posixSocket> sok = make_shared <posixSocket>(th, m_reactor);
+
+	sok->setAddressCache(m_addressCache);
+	sok->setHappyEyeballsEnabled(m_happyEyeballs);
+
+	return sok;
+}
+
+
+void posixSocketFactory::setAddressCache(shared_ptr <posixAddressCache> cache)
+{
+	m_addressCache = cache;
+}
+
+
+shared_ptr <posixAddressCache> posixSocketFactory::getAddressCache() const
+{
+	return m_addressCache;
+}
+
+
+void posixSocketFactory::setHappyEyeballsEnabled(const bool enable)
+{
+	m_happyEyeballs = enable;
+}
+
+
+bool posixSocketFactory::isHappyEyeballsEnabled() const
+{
+	return m_happyEyeballs;
+}
+
+
+void posixSocketFactory::setReactor(shared_ptr <posixSocketReactor> reactor)
+{
+	m_reactor = reactor;
+}
+
+
+shared_ptr <posixSocketReactor> posixSocketFactory::getReactor() const
+{
+	return m_reactor;
 }
 
 
@@ -33,21 +33,104 @@
 
 #include "vmime/net/socket.hpp"
 
+#include "vmime/platforms/posix/posixAddressCache.hpp"
+
 
 namespace vmime {
 namespace platforms {
 namespace posix {
 
 
-class posixSocket : public vmime::net::socket
+class posixSocketReactor;
+
+
+class VMIME_EXPORT posixSocket : public vmime::net::socket
 {
 public:
 
-	posixSocket(shared_ptr <vmime::net::timeoutHandler> th);
+	friend class posixSocketReactor;
+
+	/** Construct a new socket.
+	  *
+	  * @param th time-out handler, or NULL
+	  * @param reactor if not NULL, the socket will be registered for
+	  * read events with this reactor as soon as it is connected
+	  */
+	posixSocket(shared_ptr <vmime::net::timeoutHandler> th,
+	            shared_ptr <posixSocketReactor> reactor = null);
 	~posixSocket();
 
 	void connect(const vmime::string& address, const vmime::port_t port);
 	bool isConnected() const;
+
+	/** Start connecting to the specified address, without waiting for
+	  * the connection to be established. Address resolution is still
+	  * synchronous. Call finishConnect() when the socket is writable.
+	  * If the address resolves to several addresses, they are tried
+	  * in turn until a connection succeeds.
+	  *
+	  * @param address server address
+	  * @param port server port
+	  * @throw exceptions::connection_error if the address cannot be
+	  * resolved or the connection cannot be started
+	  */
+	void startConnect(const vmime::string& address, const vmime::port_t port);
+
+	/** Complete a connection started with startConnect(). If the
+	  * connection failed, a connection to the next address is started
+	  * (the socket descriptor changes, and the socket is registered
+	  * again with its reactor).
+	  *
+	  * @return true if the connection is established, or false if it
+	  * is still in progress
+	  * @throw exceptions::connection_error if the connection failed
+	  * with all the addresses
+	  */
+	bool finishConnect();
+
+	/** Set whether receiveRaw() should return immediately if no data
+	  * is available, instead of waiting briefly for data. This is used
+	  * when the socket is driven by an event loop.
+	  *
+	  * @param nonBlocking true to never wait in receiveRaw()
+	  */
+	void setNonBlocking(const bool nonBlocking);
+
+	/** Return whether receiveRaw() never waits for data.
+	  *
+	  * @return true if the socket is in non-blocking mode
+	  */
+	bool isNonBlocking() const;
+
+	/** Set the cache used to resolve server addresses. If no cache
+	  * is set, the address is resolved each time connect() is called.
+	  *
+	  * @param cache address cache, or NULL
+	  */
+	void setAddressCache(shared_ptr <posixAddressCache> cache);
+
+	/** Return the cache used to resolve server addresses, if any.
+	  *
+	  * @return address cache, or NULL
+	  */
+	shared_ptr <posixAddressCache> getAddressCache() const;
+
+	/** Enable or disable "Happy Eyeballs" connection (RFC-8305).
+	  * When enabled, connection attempts to the resolved addresses
+	  * are raced, alternating IPv6 and IPv4, with a new attempt
+	  * started every 250 ms until one succeeds. Otherwise, addresses
+	  * are tried one after the other.
+	  *
+	  * @param enable true to race connection attempts
+	  */
+	void setHappyEyeballsEnabled(const bool enable);
+
+	/** Return whether "Happy Eyeballs" connection is enabled.
+	  *
+	  * @return true if connection attempts are raced
+	  */
+	bool isHappyEyeballsEnabled() const;
+
 	void disconnect();
 
 	bool waitForRead(const int msecs = 30000);
@@ -76,26 +159,103 @@ protected:
 
 	static void throwSocketError(const int err);
 
+	void unregisterFromReactor();
+
+	void resolve(const vmime::string& address, const vmime::port_t port,
+	             std::vector <posixAddressCache::address>& addresses);
+
+	int connectSequential(const std::vector <posixAddressCache::address>& addresses, int& connectErrno);
+	int connectHappyEyeballs(const std::vector <posixAddressCache::address>& addresses, int& connectErrno);
+
+	bool startNextConnect(int& connectErrno);
+	void throwConnectError(const int connectErrno);
+
 private:
 
 	shared_ptr <vmime::net::timeoutHandler> m_timeoutHandler;
 
+	shared_ptr <posixSocketReactor> m_autoReactor;
+	weak_ptr <posixSocketReactor> m_reactor;
+
+	shared_ptr <posixAddressCache> m_addressCache;
+	bool m_happyEyeballs;
+
 	byte_t m_buffer[65536];
 	int m_desc;
 
 	unsigned int m_status;
 
+	bool m_nonBlocking;
+
 	string m_serverAddress;
+
+	// Addresses left to try for a connection started with startConnect()
+	std::vector <posixAddressCache::address> m_connectAddresses;
+	size_t m_connectIndex;
+	vmime::port_t m_connectPort;
 };
 
 
 
-class posixSocketFactory : public vmime::net::socketFactory
+class VMIME_EXPORT posixSocketFactory : public vmime::net::socketFactory
 {
 public:
 
+	posixSocketFactory();
+
 	shared_ptr <vmime::net::socket> create();
 	shared_ptr <vmime::net::socket> create(shared_ptr <vmime::net::timeoutHandler> th);
+
+	/** Set a reactor with which all the sockets created by this factory
+	  * are registered when connected. This allows waiting for activity
+	  * on all the connections at once (for example, when many IMAP
+	  * connections are idle).
+	  *
+	  * @param reactor socket reactor, or NULL
+	  */
+	void setReactor(shared_ptr <posixSocketReactor> reactor);
+
+	/** Return the reactor set with setReactor(), if any.
+	  *
+	  * @return socket reactor, or NULL
+	  */
+	shared_ptr <posixSocketReactor> getReactor() const;
+
+	/** Set a cache used by all the sockets created by this factory
+	  * to resolve server addresses. Resolved addresses are kept for
+	  * the time-to-live of the cache, avoiding a DNS query on each
+	  * connection to the same server.
+	  *
+	  * @param cache address cache, or NULL to disable caching
+	  */
+	void setAddressCache(shared_ptr <posixAddressCache> cache);
+
+	/** Return the address cache set with setAddressCache(), if any.
+	  *
+	  * @return address cache, or NULL
+	  */
+	shared_ptr <posixAddressCache> getAddressCache() const;
+
+	/** Enable or disable "Happy Eyeballs" connection (RFC-8305)
+	  * for the sockets created by this factory.
+	  *
+	  * @param enable true to race connection attempts
+	  * @see posixSocket::setHappyEyeballsEnabled()
+	  */
+	void setHappyEyeballsEnabled(const bool enable);
+
+	/** Return whether sockets created by this factory use
+	  * "Happy Eyeballs" connection.
+	  *
+	  * @return true if connection attempts are raced
+	  */
+	bool isHappyEyeballsEnabled() const;
+
+private:
+
+	shared_ptr <posixSocketReactor> m_reactor;
+	shared_ptr <posixAddressCache> m_addressCache;
+	bool m_happyEyeballs;
 };
 
 
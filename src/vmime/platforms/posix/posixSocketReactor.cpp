@@ -0,0 +1,251 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/platforms/posix/posixSocketReactor.hpp"
+
+#include "vmime/platform.hpp"
+
+#include "vmime/utility/sync/autoLock.hpp"
+
+#include "vmime/exception.hpp"
+
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+
+#if VMIME_HAVE_EPOLL
+#	include <sys/epoll.h>
+#endif // VMIME_HAVE_EPOLL
+
+
+namespace vmime {
+namespace platforms {
+namespace posix {
+
+
+typedef utility::sync::autoLock <utility::sync::criticalSection> reactorLock;
+
+
+posixSocketReactor::posixSocketReactor()
+	: m_lock(platform::getHandler()->createCriticalSection())
+{
+#if VMIME_HAVE_EPOLL
+
+	m_epollDesc = ::epoll_create1(EPOLL_CLOEXEC);
+
+	if (m_epollDesc == -1)
+		posixSocket::throwSocketError(errno);
+
+#endif // VMIME_HAVE_EPOLL
+}
+
+
+posixSocketReactor::~posixSocketReactor()
+{
+#if VMIME_HAVE_EPOLL
+	::close(m_epollDesc);
+#endif // VMIME_HAVE_EPOLL
+}
+
+
+void posixSocketReactor::registerSocket(shared_ptr <posixSocket> sok, const int events)
+{
+	if (sok->m_desc == -1)
+		throw exceptions::socket_not_connected_exception();
+
+	const int desc = sok->m_desc;
+
+	// A socket can only be watched by one reactor at a time
+	shared_ptr <posixSocketReactor> previous = sok->m_reactor.lock();
+
+	if (previous && previous.get() != this)
+		previous->unregisterDescriptor(desc);
+
+	reactorLock lock(m_lock);
+
+#if VMIME_HAVE_EPOLL
+
+	const bool registered = (m_entries.find(desc) != m_entries.end());
+
+	::epoll_event ev;
+	ev.events = 0;
+
+	if (events & EVENT_READ)
+		ev.events |= EPOLLIN;
+	if (events & EVENT_WRITE)
+		ev.events |= EPOLLOUT;
+
+	ev.data.fd = desc;
+
+	if (::epoll_ctl(m_epollDesc, registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, desc, &ev) == -1)
+		posixSocket::throwSocketError(errno);
+
+#endif // VMIME_HAVE_EPOLL
+
+	entry& e = m_entries[desc];
+	e.socket = sok;
+	e.events = events;
+
+	sok->m_reactor = dynamicCast <posixSocketReactor>(shared_from_this());
+}
+
+
+void posixSocketReactor::unregisterSocket(shared_ptr <posixSocket> sok)
+{
+	if (sok->m_desc == -1)
+		return;
+
+	unregisterDescriptor(sok->m_desc);
+
+	sok->m_reactor.reset();
+}
+
+
+void posixSocketReactor::unregisterDescriptor(const int desc)
+{
+	reactorLock lock(m_lock);
+
+	if (m_entries.erase(desc) == 0)
+		return;
+
+#if VMIME_HAVE_EPOLL
+	::epoll_event ev;  // ignored, but must be non-NULL with kernels before 2.6.9
+	::epoll_ctl(m_epollDesc, EPOLL_CTL_DEL, desc, &ev);
+#endif // VMIME_HAVE_EPOLL
+}
+
+
+size_t posixSocketReactor::getSocketCount() const
+{
+	reactorLock lock(m_lock);
+
+	return m_entries.size();
+}
+
+
+size_t posixSocketReactor::wait(std::vector <shared_ptr <posixSocket> >& ready, const int msecs)
+{
+	ready.clear();
+
+	std::vector <int> readyDescs;
+
+#if VMIME_HAVE_EPOLL
+
+	const int maxEvents = 256;
+	::epoll_event events[maxEvents];
+
+	const int count = ::epoll_wait(m_epollDesc, events, maxEvents, msecs);
+
+	if (count < 0)
+	{
+		if (errno == EINTR)
+			return 0;
+
+		posixSocket::throwSocketError(errno);
+	}
+
+	for (int i = 0 ; i < count ; ++i)
+		readyDescs.push_back(events[i].data.fd);
+
+#else // !VMIME_HAVE_EPOLL
+
+	std::vector < ::pollfd> fds;
+
+	{
+		reactorLock lock(m_lock);
+
+		fds.reserve(m_entries.size());
+
+		for (EntryMap::const_iterator it = m_entries.begin() ; it != m_entries.end() ; ++it)
+		{
+			::pollfd fd;
+			fd.fd = it->first;
+			fd.events = static_cast <short>
+				(((it->second.events & EVENT_READ) ? POLLIN : 0) |
+				 ((it->second.events & EVENT_WRITE) ? POLLOUT : 0));
+			fd.revents = 0;
+
+			fds.push_back(fd);
+		}
+	}
+
+	if (fds.empty())
+	{
+		if (msecs > 0)
+			::poll(NULL, 0, msecs);
+
+		return 0;
+	}
+
+	const int count = ::poll(&fds[0], fds.size(), msecs);
+
+	if (count < 0)
+	{
+		if (errno == EINTR)
+			return 0;
+
+		posixSocket::throwSocketError(errno);
+	}
+
+	for (size_t i = 0 ; i < fds.size() ; ++i)
+	{
+		if (fds[i].revents != 0)
+			readyDescs.push_back(fds[i].fd);
+	}
+
+#endif // VMIME_HAVE_EPOLL
+
+	// Map descriptors back to sockets; ignore sockets which have been
+	// unregistered or destroyed in the meantime
+	reactorLock lock(m_lock);
+
+	for (size_t i = 0 ; i < readyDescs.size() ; ++i)
+	{
+		EntryMap::const_iterator it = m_entries.find(readyDescs[i]);
+
+		if (it == m_entries.end())
+			continue;
+
+		shared_ptr <posixSocket> sok = it->second.socket.lock();
+
+		if (sok)
+			ready.push_back(sok);
+	}
+
+	return ready.size();
+}
+
+
+} // posix
+} // platforms
+} // vmime
+
+
+#endif // VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
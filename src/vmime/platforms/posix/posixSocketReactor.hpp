@@ -0,0 +1,142 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_PLATFORMS_POSIX_SOCKETREACTOR_HPP_INCLUDED
+#define VMIME_PLATFORMS_POSIX_SOCKETREACTOR_HPP_INCLUDED
+
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include <map>
+#include <vector>
+
+#include "vmime/platforms/posix/posixSocket.hpp"
+
+#include "vmime/utility/sync/criticalSection.hpp"
+
+
+namespace vmime {
+namespace platforms {
+namespace posix {
+
+
+/** Waits for activity on many sockets at once.
+  *
+  * This uses epoll() where available, and falls back to poll() elsewhere.
+  * Neither has a limit on descriptor values, so this can be used by a
+  * process holding thousands of connections.
+  *
+  * A socket stays registered until it is unregistered, disconnected or
+  * destroyed. The reactor does not keep sockets alive. Registration
+  * functions may be called from any thread, including while another
+  * thread is blocked in wait().
+  *
+  * Note that a TLS socket may have decrypted data buffered even though its
+  * underlying socket is not readable, so TLS sockets should be read until
+  * no more data is available before waiting again.
+  */
+class VMIME_EXPORT posixSocketReactor : public object
+{
+public:
+
+	/** Events for which sockets can be watched. */
+	enum Events
+	{
+		EVENT_READ = (1 << 0),    /**< Data is available for reading. */
+		EVENT_WRITE = (1 << 1)    /**< Data can be written without blocking. */
+	};
+
+
+	posixSocketReactor();
+	~posixSocketReactor();
+
+	/** Start watching a socket, or change the events for which
+	  * a socket is watched if it is already registered.
+	  *
+	  * @param sok connected socket
+	  * @param events combination of Events flags
+	  * @throw exceptions::socket_not_connected_exception if the
+	  * socket is not connected
+	  */
+	void registerSocket(shared_ptr <posixSocket> sok, const int events = EVENT_READ);
+
+	/** Stop watching a socket. Does nothing if it is not registered.
+	  *
+	  * @param sok socket
+	  */
+	void unregisterSocket(shared_ptr <posixSocket> sok);
+
+	/** Return the number of sockets currently watched.
+	  *
+	  * @return number of registered sockets
+	  */
+	size_t getSocketCount() const;
+
+	/** Wait until at least one of the registered sockets is ready, or
+	  * the specified delay has elapsed. Sockets on which an error or
+	  * a hang-up occurred are also reported as ready.
+	  *
+	  * @param ready will receive the sockets which are ready
+	  * @param msecs maximum time to wait, in milliseconds, or -1
+	  * to wait indefinitely
+	  * @return number of sockets which are ready (0 if timed out)
+	  */
+	size_t wait(std::vector <shared_ptr <posixSocket> >& ready, const int msecs);
+
+private:
+
+	friend class posixSocket;
+
+	void unregisterDescriptor(const int desc);
+
+
+	struct entry
+	{
+		weak_ptr <posixSocket> socket;
+		int events;
+	};
+
+	typedef std::map <int, entry> EntryMap;
+
+	EntryMap m_entries;
+	shared_ptr <utility::sync::criticalSection> m_lock;
+
+#if VMIME_HAVE_EPOLL
+	int m_epollDesc;
+#endif // VMIME_HAVE_EPOLL
+};
+
+
+} // posix
+} // platforms
+} // vmime
+
+
+#endif // VMIME_PLATFORM_IS_POSIX && VMIME_HAVE_MESSAGING_FEATURES
+
+#endif // VMIME_PLATFORMS_POSIX_SOCKETREACTOR_HPP_INCLUDED
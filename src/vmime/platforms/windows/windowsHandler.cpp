@@ -30,6 +30,7 @@
 #include "vmime/platforms/windows/windowsHandler.hpp"
 
 #include "vmime/platforms/windows/windowsCriticalSection.hpp"
+#include "vmime/platforms/windows/windowsThread.hpp"
 
 #include "vmime/utility/stringUtils.hpp"
 
@@ -77,6 +78,21 @@ unsigned long windowsHandler::getUnixTime() const
 }
 
 
+vmime_uint64 windowsHandler::getMonotonicTime() const
+{
+	LARGE_INTEGER frequency, counter;
+
+	if (!::QueryPerformanceFrequency(&frequency) || !::QueryPerformanceCounter(&counter))
+		return static_cast <vmime_uint64>(::GetTickCount()) * 1000;
+
+	// Split the computation to avoid overflow
+	const vmime_uint64 freq = static_cast <vmime_uint64>(frequency.QuadPart);
+	const vmime_uint64 count = static_cast <vmime_uint64>(counter.QuadPart);
+
+	return (count / freq) * 1000000 + (count % freq) * 1000000 / freq;
+}
+
+
 const vmime::datetime windowsHandler::getCurrentLocalTime() const
 {
 	const time_t t(::time(NULL));
@@ -314,6 +330,12 @@ shared_ptr <utility::sync::criticalSection> windowsHandler::createCriticalSectio
 }
 
 
+shared_ptr <utility::sync::thread> windowsHandler::createThread(shared_ptr <utility::sync::runnable> task)
+{
+	return make_shared <windowsThread>(task);
+}
+
+
 } // posix
 } // platforms
 } // vmime
@@ -56,6 +56,8 @@ public:
 
 	unsigned long getUnixTime() const;
 
+	vmime_uint64 getMonotonicTime() const;
+
 	const vmime::datetime getCurrentLocalTime() const;
 
 	const vmime::charset getLocalCharset() const;
@@ -79,6 +81,8 @@ public:
 
 	shared_ptr <utility::sync::criticalSection> createCriticalSection();
 
+	shared_ptr <utility::sync::thread> createThread(shared_ptr <utility::sync::runnable> task);
+
 private:
 
 #if VMIME_HAVE_MESSAGING_FEATURES
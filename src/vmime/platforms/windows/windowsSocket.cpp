@@ -32,6 +32,7 @@
 #include "vmime/platforms/windows/windowsSocket.hpp"
 
 #include "vmime/utility/stringUtils.hpp"
+#include "vmime/utility/instrumentation.hpp"
 #include "vmime/exception.hpp"
 
 #include <ws2tcpip.h>
@@ -298,6 +299,12 @@ size_t windowsSocket::receiveRaw(byte_t* buffer, const size_t count)
 		if (m_timeoutHandler)
 			m_timeoutHandler->resetTimeOut();
 
+		if (utility::instrumentation::isEnabled())
+		{
+			utility::instrumentation::increment
+				(utility::instrumentation::SOCKET_RECEIVED_BYTES, "", ret);
+		}
+
 		return ret;
 	}
 }
@@ -344,6 +351,9 @@ void windowsSocket::sendRaw(const byte_t* buffer, const size_t count)
 	// Reset timeout
 	if (m_timeoutHandler)
 		m_timeoutHandler->resetTimeOut();
+
+	if (utility::instrumentation::isEnabled())
+		utility::instrumentation::increment(utility::instrumentation::SOCKET_SENT_BYTES, "", count);
 }
 
 
@@ -390,6 +400,9 @@ size_t windowsSocket::sendRawNonBlocking(const byte_t* buffer, const size_t coun
 	if (m_timeoutHandler)
 		m_timeoutHandler->resetTimeOut();
 
+	if (utility::instrumentation::isEnabled())
+		utility::instrumentation::increment(utility::instrumentation::SOCKET_SENT_BYTES, "", ret);
+
 	return ret;
 }
 
@@ -0,0 +1,83 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/config.hpp"
+
+
+#if VMIME_PLATFORM_IS_WINDOWS
+
+
+#include "vmime/platforms/windows/windowsThread.hpp"
+
+#include "vmime/exception.hpp"
+
+
+namespace vmime {
+namespace platforms {
+namespace windows {
+
+
+windowsThread::windowsThread(shared_ptr <utility::sync::runnable> task)
+	: m_task(task), m_thread(NULL)
+{
+	m_thread = CreateThread(NULL, 0, threadProc, this, 0, NULL);
+
+	if (m_thread == NULL)
+		throw exceptions::system_error("CreateThread() failed");
+}
+
+
+windowsThread::~windowsThread()
+{
+	join();
+}
+
+
+void windowsThread::join()
+{
+	if (m_thread != NULL)
+	{
+		WaitForSingleObject(m_thread, INFINITE);
+		CloseHandle(m_thread);
+
+		m_thread = NULL;
+	}
+}
+
+
+// static
+DWORD WINAPI windowsThread::threadProc(LPVOID param)
+{
+	windowsThread* thread = static_cast <windowsThread*>(param);
+	thread->m_task->run();
+
+	return 0;
+}
+
+
+} // windows
+} // platforms
+} // vmime
+
+
+#endif // VMIME_PLATFORM_IS_WINDOWS
@@ -30,18 +30,20 @@ namespace vmime
 
 
 propertySet::propertySet()
+	: m_modificationCount(0)
 {
 }
 
 
 propertySet::propertySet(const string& props)
+	: m_modificationCount(0)
 {
 	parse(props);
 }
 
 
 propertySet::propertySet(const propertySet& set)
-	: object()
+	: object(), m_modificationCount(0)
 {
 	for (std::list <shared_ptr <property> >::const_iterator it = set.m_props.begin() ; it != set.m_props.end() ; ++it)
 		m_props.push_back(make_shared <property>(**it));
@@ -61,6 +63,8 @@ propertySet& propertySet::operator=(const propertySet& set)
 	for (std::list <shared_ptr <property> >::const_iterator it = set.m_props.begin() ; it != set.m_props.end() ; ++it)
 		m_props.push_back(make_shared <property>(**it));
 
+	++m_modificationCount;
+
 	return (*this);
 }
 
@@ -74,6 +78,7 @@ void propertySet::setFromString(const string& props)
 void propertySet::removeAllProperties()
 {
 	m_props.clear();
+	++m_modificationCount;
 }
 
 
@@ -83,7 +88,10 @@ void propertySet::removeProperty(const string& name)
 		(m_props.begin(), m_props.end(), propFinder(name));
 
 	if (it != m_props.end())
+	{
 		m_props.erase(it);
+		++m_modificationCount;
+	}
 }
 
 
@@ -177,6 +185,14 @@ void propertySet::parse(const string& props)
 			m_props.push_back(make_shared <property>(option, value));
 		}
 	}
+
+	++m_modificationCount;
+}
+
+
+unsigned int propertySet::getModificationCount() const
+{
+	return m_modificationCount;
 }
 
 
@@ -310,8 +310,17 @@ public:
 	void setProperty(const string& name, const TYPE& value)
 	{
 		findOrCreate(name)->setValue(value);
+		++m_modificationCount;
 	}
 
+	/** Return a number which changes each time a property is set
+	  * or removed. This can be used to detect whether values computed
+	  * from the properties need to be computed again.
+	  *
+	  * @return modification counter
+	  */
+	unsigned int getModificationCount() const;
+
 	/** Return a proxy object to access the specified property
 	  * suitable for reading or writing. If the property does not
 	  * exist and the value is changed, a new property will
@@ -357,6 +366,8 @@ private:
 	typedef std::list <shared_ptr <property> > list_type;
 	list_type m_props;
 
+	unsigned int m_modificationCount;
+
 public:
 
 	template <typename TYPE>
@@ -392,18 +392,21 @@ bool X509Certificate_OpenSSL::verifyHostName
 
 			if ((method = X509V3_EXT_get(ext)) != NULL)
 			{
-				const unsigned char* extVal = ext->value->data;
+				// X509_EXTENSION is opaque since OpenSSL 1.1.0
+				ASN1_OCTET_STRING* extData = X509_EXTENSION_get_data(ext);
+
+				const unsigned char* extVal = extData->data;
 				void *extValStr;
 
 				if (method->it)
 				{
 					extValStr = ASN1_item_d2i
-						(NULL, &extVal, ext->value->length, ASN1_ITEM_ptr(method->it));
+						(NULL, &extVal, extData->length, ASN1_ITEM_ptr(method->it));
 				}
 				else
 				{
 					extValStr = method->d2i
-						(NULL, &extVal, ext->value->length);
+						(NULL, &extVal, extData->length);
 				}
 
 				if (extValStr && method->i2v)
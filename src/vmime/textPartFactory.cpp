@@ -53,14 +53,23 @@ textPartFactory* textPartFactory::getInstance()
 }
 
 
+void textPartFactory::registerAllocFunc(const mediaType& type, AllocFunc func)
+{
+	m_map.push_back(MapType::value_type(type, func));
+
+	// If a type is registered more than once, the first one wins
+	m_index.insert(std::map <string, AllocFunc>::value_type
+		(type.getType() + '/' + type.getSubType(), func));
+}
+
+
 shared_ptr <textPart> textPartFactory::create(const mediaType& type)
 {
-	for (MapType::const_iterator it = m_map.begin() ;
-	     it != m_map.end() ; ++it)
-	{
-		if ((*it).first == type)
-			return ((*it).second)();
-	}
+	std::map <string, AllocFunc>::const_iterator it =
+		m_index.find(type.getType() + '/' + type.getSubType());
+
+	if (it != m_index.end())
+		return ((*it).second)();
 
 	throw exceptions::no_factory_available("No 'textPart' class registered for media type '" + type.generate() + "'.");
 }
@@ -45,6 +45,11 @@ protected:
 
 	MapType m_map;
 
+	/** Registered types indexed by "type/subtype", for fast lookup. */
+	std::map <string, AllocFunc> m_index;
+
+	void registerAllocFunc(const mediaType& type, AllocFunc func);
+
 #ifndef VMIME_BUILDING_DOC
 	template <class TYPE>
 	class registerer
@@ -66,7 +71,7 @@ public:
 	template <class T>
 	void registerType(const mediaType& type)
 	{
-		m_map.push_back(MapType::value_type(type, &registerer<T>::creator));
+		registerAllocFunc(type, &registerer<T>::creator);
 	}
 
 	shared_ptr <textPart> create(const mediaType& type);
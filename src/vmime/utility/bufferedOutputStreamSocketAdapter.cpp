@@ -0,0 +1,122 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "vmime/utility/bufferedOutputStreamSocketAdapter.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include "vmime/net/socket.hpp"
+
+#include <algorithm>
+
+
+namespace vmime {
+namespace utility {
+
+
+bufferedOutputStreamSocketAdapter::bufferedOutputStreamSocketAdapter
+	(net::socket& sok, const size_t watermark)
+	: m_socket(sok), m_bufferSize(0)
+{
+	m_buffer.resize(watermark != 0 ? watermark : std::max(sok.getBlockSize(), static_cast <size_t>(1)));
+}
+
+
+size_t bufferedOutputStreamSocketAdapter::getWatermark() const
+{
+	return m_buffer.size();
+}
+
+
+size_t bufferedOutputStreamSocketAdapter::getBufferedSize() const
+{
+	return m_bufferSize;
+}
+
+
+void bufferedOutputStreamSocketAdapter::writeImpl
+	(const byte_t* const data, const size_t count)
+{
+	const size_t watermark = m_buffer.size();
+
+	const byte_t* curData = data;
+	size_t curCount = count;
+
+	while (curCount != 0)
+	{
+		// Nothing buffered: send whole blocks directly
+		if (m_bufferSize == 0 && curCount >= watermark)
+		{
+			const size_t blocks = curCount - (curCount % watermark);
+
+			m_socket.sendRaw(curData, blocks);
+
+			curData += blocks;
+			curCount -= blocks;
+
+			continue;
+		}
+
+		// Fill the buffer
+		const size_t bytesToCopy = std::min(watermark - m_bufferSize, curCount);
+
+		std::copy(curData, curData + bytesToCopy, &m_buffer[0] + m_bufferSize);
+
+		m_bufferSize += bytesToCopy;
+		curData += bytesToCopy;
+		curCount -= bytesToCopy;
+
+		// If the buffer is full, send it
+		if (m_bufferSize == watermark)
+		{
+			m_socket.sendRaw(&m_buffer[0], m_bufferSize);
+			m_bufferSize = 0;
+		}
+	}
+}
+
+
+void bufferedOutputStreamSocketAdapter::flush()
+{
+	if (m_bufferSize != 0)
+	{
+		m_socket.sendRaw(&m_buffer[0], m_bufferSize);
+		m_bufferSize = 0;
+	}
+}
+
+
+size_t bufferedOutputStreamSocketAdapter::getBlockSize()
+{
+	return m_buffer.size();
+}
+
+
+} // utility
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
@@ -0,0 +1,115 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#ifndef VMIME_UTILITY_BUFFEREDOUTPUTSTREAMSOCKETADAPTER_HPP_INCLUDED
+#define VMIME_UTILITY_BUFFEREDOUTPUTSTREAMSOCKETADAPTER_HPP_INCLUDED
+
+
+#include "vmime/utility/outputStream.hpp"
+
+
+#if VMIME_HAVE_MESSAGING_FEATURES
+
+
+#include <vector>
+
+
+namespace vmime {
+namespace net {
+	class socket;  // forward reference
+} // net
+} // vmime
+
+
+namespace vmime {
+namespace utility {
+
+
+/** An output stream that is connected to a socket, and which buffers
+  * data so that many small writes result in a few large sends.
+  *
+  * Data is sent when the amount of buffered data reaches the watermark,
+  * or when flush() is called. Sends are always done in blocks of the
+  * watermark size (except the last one when flushing), so that with the
+  * default watermark each send fills exactly one TLS record on secured
+  * connections. Writes larger than the watermark are sent directly from
+  * the caller's buffer, without copying.
+  *
+  * Buffered data is not sent when the object is destroyed: flush()
+  * must be called explicitly.
+  */
+
+class VMIME_EXPORT bufferedOutputStreamSocketAdapter : public outputStream
+{
+public:
+
+	/** Construct a new buffered stream on the specified socket.
+	  *
+	  * @param sok socket to which data will be sent
+	  * @param watermark amount of buffered data, in bytes, above which
+	  * data is sent to the socket; if 0, the block size of the socket
+	  * is used (which is also the maximum payload of a TLS record)
+	  */
+	bufferedOutputStreamSocketAdapter(net::socket& sok, const size_t watermark = 0);
+
+	/** Return the amount of buffered data above which data is sent.
+	  *
+	  * @return watermark, in bytes
+	  */
+	size_t getWatermark() const;
+
+	/** Return the amount of data currently buffered, not sent yet.
+	  *
+	  * @return number of buffered bytes
+	  */
+	size_t getBufferedSize() const;
+
+	void flush();
+
+	size_t getBlockSize();
+
+protected:
+
+	void writeImpl(const byte_t* const data, const size_t count);
+
+private:
+
+	bufferedOutputStreamSocketAdapter(const bufferedOutputStreamSocketAdapter&);
+
+
+	net::socket& m_socket;
+
+	std::vector <byte_t> m_buffer;
+	size_t m_bufferSize;
+};
+
+
+} // utility
+} // vmime
+
+
+#endif // VMIME_HAVE_MESSAGING_FEATURES
+
+
+#endif // VMIME_UTILITY_BUFFEREDOUTPUTSTREAMSOCKETADAPTER_HPP_INCLUDED
@@ -80,8 +80,7 @@ size_t b64Encoder::encode(utility::inputStream& in,
 {
 	in.reset();  // may not work...
 
-	const size_t propMaxLineLength =
-		getProperties().getProperty <size_t>("maxlinelength", static_cast <size_t>(-1));
+	const size_t propMaxLineLength = getSettings().maxLineLength;
 
 	const bool cutLines = (propMaxLineLength != static_cast <size_t>(-1));
 	const size_t maxLineLength = std::min(propMaxLineLength, static_cast <size_t>(76));
@@ -306,8 +305,7 @@ size_t b64Encoder::decode(utility::inputStream& in,
 
 size_t b64Encoder::getEncodedSize(const size_t n) const
 {
-	const size_t propMaxLineLength =
-		getProperties().getProperty <size_t>("maxlinelength", static_cast <size_t>(-1));
+	const size_t propMaxLineLength = getSettings().maxLineLength;
 
 	const bool cutLines = (propMaxLineLength != static_cast <size_t>(-1));
 	const size_t maxLineLength = std::min(propMaxLineLength, static_cast <size_t>(76));
@@ -30,7 +30,14 @@ namespace utility {
 namespace encoder {
 
 
+encoder::settings::settings()
+	: maxLineLength(static_cast <size_t>(-1)), text(false), rfc2047(false)
+{
+}
+
+
 encoder::encoder()
+	: m_settingsValid(false), m_settingsModificationCount(0)
 {
 }
 
@@ -52,6 +59,24 @@ propertySet& encoder::getProperties()
 }
 
 
+const encoder::settings& encoder::getSettings() const
+{
+	// Properties may have been modified since settings were read
+	if (!m_settingsValid || m_settingsModificationCount != m_props.getModificationCount())
+	{
+		m_settings.maxLineLength =
+			m_props.getProperty <size_t>("maxlinelength", static_cast <size_t>(-1));
+		m_settings.text = m_props.getProperty <bool>("text", false);
+		m_settings.rfc2047 = m_props.getProperty <bool>("rfc2047", false);
+
+		m_settingsValid = true;
+		m_settingsModificationCount = m_props.getModificationCount();
+	}
+
+	return (m_settings);
+}
+
+
 const propertySet& encoder::getResults() const
 {
 	return (m_results);
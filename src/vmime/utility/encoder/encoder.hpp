@@ -43,6 +43,22 @@ class VMIME_EXPORT encoder : public object
 {
 public:
 
+	/** Typed values of the standard encoder properties, as read
+	  * from the property set of the encoder.
+	  */
+	struct settings
+	{
+		settings();
+
+		/** Value of "maxlinelength", or -1 (size_t) if not set. */
+		size_t maxLineLength;
+		/** Value of "text" (default is false). */
+		bool text;
+		/** Value of "rfc2047" (default is false). */
+		bool rfc2047;
+	};
+
+
 	encoder();
 	virtual ~encoder();
 
@@ -78,6 +94,14 @@ public:
 	  */
 	propertySet& getProperties();
 
+	/** Return the standard properties of the encoder, converted
+	  * to their native types. Conversion happens only once after
+	  * the properties have been modified.
+	  *
+	  * @return typed settings of the encoder
+	  */
+	const settings& getSettings() const;
+
 	/** Return a list of property names that can be set for
 	  * this encoder.
 	  *
@@ -117,6 +141,10 @@ private:
 
 	propertySet m_props;
 	propertySet m_results;
+
+	mutable settings m_settings;
+	mutable bool m_settingsValid;
+	mutable unsigned int m_settingsModificationCount;
 };
 
 
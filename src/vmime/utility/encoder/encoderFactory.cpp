@@ -68,22 +68,39 @@ shared_ptr <encoderFactory> encoderFactory::getInstance()
 }
 
 
+void encoderFactory::registerEncoder(const shared_ptr <registeredEncoder>& enc)
+{
+	m_encoders.push_back(enc);
+
+	// If a name is registered more than once, the first one wins
+	m_encodersByName.insert(std::map <string, shared_ptr <registeredEncoder> >
+		::value_type(enc->getName(), enc));
+}
+
+
 shared_ptr <encoder> encoderFactory::create(const string& name)
 {
 	return (getEncoderByName(name)->create());
 }
 
 
+shared_ptr <const encoder> encoderFactory::getSharedInstance(const string& name) const
+{
+	return (getEncoderByName(name)->getSharedInstance());
+}
+
+
 const shared_ptr <const encoderFactory::registeredEncoder> encoderFactory::getEncoderByName(const string& name) const
 {
-	const string lcName(utility::stringUtils::toLower(name));
+	// Names are usually already in lower-case: try without converting first
+	std::map <string, shared_ptr <registeredEncoder> >::const_iterator it =
+		m_encodersByName.find(name);
 
-	for (std::vector <shared_ptr <registeredEncoder> >::const_iterator it = m_encoders.begin() ;
-	     it != m_encoders.end() ; ++it)
-	{
-		if ((*it)->getName() == lcName)
-			return (*it);
-	}
+	if (it == m_encodersByName.end())
+		it = m_encodersByName.find(utility::stringUtils::toLower(name));
+
+	if (it != m_encodersByName.end())
+		return (*it).second;
 
 	throw exceptions::no_encoder_available(name);
 }
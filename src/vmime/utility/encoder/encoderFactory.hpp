@@ -59,6 +59,15 @@ public:
 
 		virtual shared_ptr <encoder> create() const = 0;
 
+		/** Return an encoder instance with default properties which
+		  * is shared by all callers. As it cannot be modified, it is
+		  * safe to use it from several threads, eg. to compute the
+		  * encoded or decoded size of some data.
+		  *
+		  * @return shared encoder instance
+		  */
+		virtual shared_ptr <const encoder> getSharedInstance() const = 0;
+
 		virtual const string& getName() const = 0;
 	};
 
@@ -69,13 +78,24 @@ private:
 	{
 	public:
 
-		registeredEncoderImpl(const string& name) : m_name(name) { }
+		registeredEncoderImpl(const string& name)
+			: m_name(name), m_sharedInstance(vmime::make_shared <E>())
+		{
+			// Convert properties now, so that the shared instance
+			// is never modified afterwards
+			m_sharedInstance->getSettings();
+		}
 
 		shared_ptr <encoder> create() const
 		{
 			return vmime::make_shared <E>();
 		}
 
+		shared_ptr <const encoder> getSharedInstance() const
+		{
+			return (m_sharedInstance);
+		}
+
 		const string& getName() const
 		{
 			return (m_name);
@@ -84,11 +104,17 @@ private:
 	private:
 
 		const string m_name;
+		shared_ptr <const encoder> m_sharedInstance;
 	};
 
 
 	std::vector <shared_ptr <registeredEncoder> > m_encoders;
 
+	/** Registered encoders indexed by their (lower-case) name. */
+	std::map <string, shared_ptr <registeredEncoder> > m_encodersByName;
+
+	void registerEncoder(const shared_ptr <registeredEncoder>& enc);
+
 public:
 
 	/** Register a new encoder by its encoding name.
@@ -98,7 +124,7 @@ public:
 	template <class E>
 	void registerName(const string& name)
 	{
-		m_encoders.push_back(vmime::make_shared <registeredEncoderImpl <E> >(utility::stringUtils::toLower(name)));
+		registerEncoder(vmime::make_shared <registeredEncoderImpl <E> >(utility::stringUtils::toLower(name)));
 	}
 
 	/** Create a new encoder instance from an encoding name.
@@ -110,6 +136,17 @@ public:
 	  */
 	shared_ptr <encoder> create(const string& name);
 
+	/** Return the shared, read-only encoder instance for an encoding
+	  * name. This avoids allocating a new encoder when only const
+	  * operations are needed.
+	  *
+	  * @param name encoding name (eg. "base64")
+	  * @return shared encoder instance for the specified encoding
+	  * @throw exceptions::no_encoder_available if no encoder is registered
+	  * for this encoding
+	  */
+	shared_ptr <const encoder> getSharedInstance(const string& name) const;
+
 	/** Return information about a registered encoder.
 	  *
 	  * @param name encoding name
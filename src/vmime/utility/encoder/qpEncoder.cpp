@@ -167,11 +167,10 @@ size_t qpEncoder::encode(utility::inputStream& in,
 {
 	in.reset();  // may not work...
 
-	const size_t propMaxLineLength =
-		getProperties().getProperty <size_t>("maxlinelength", static_cast <size_t>(-1));
+	const size_t propMaxLineLength = getSettings().maxLineLength;
 
-	const bool rfc2047 = getProperties().getProperty <bool>("rfc2047", false);
-	const bool text = getProperties().getProperty <bool>("text", false);  // binary mode by default
+	const bool rfc2047 = getSettings().rfc2047;
+	const bool text = getSettings().text;  // binary mode by default
 
 	const bool cutLines = (propMaxLineLength != static_cast <size_t>(-1));
 	const size_t maxLineLength = std::min(propMaxLineLength, static_cast <size_t>(74));
@@ -380,7 +379,7 @@ size_t qpEncoder::decode(utility::inputStream& in,
 	in.reset();  // may not work...
 
 	// Process the data
-	const bool rfc2047 = getProperties().getProperty <bool>("rfc2047", false);
+	const bool rfc2047 = getSettings().rfc2047;
 
 	byte_t buffer[16384];
 	size_t bufferLength = 0;
@@ -537,8 +536,7 @@ size_t qpEncoder::decode(utility::inputStream& in,
 
 size_t qpEncoder::getEncodedSize(const size_t n) const
 {
-	const size_t propMaxLineLength =
-		getProperties().getProperty <size_t>("maxlinelength", static_cast <size_t>(-1));
+	const size_t propMaxLineLength = getSettings().maxLineLength;
 
 	const bool cutLines = (propMaxLineLength != static_cast <size_t>(-1));
 	const size_t maxLineLength = std::min(propMaxLineLength, static_cast <size_t>(74));
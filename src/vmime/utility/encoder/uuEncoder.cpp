@@ -73,7 +73,7 @@ size_t uuEncoder::encode(utility::inputStream& in,
 	const string propMode = getProperties().getProperty <string>("mode", "644");
 
 	const size_t maxLineLength =
-		std::min(getProperties().getProperty <size_t>("maxlinelength", 46), static_cast <size_t>(46));
+		std::min(getSettings().maxLineLength, static_cast <size_t>(46));
 
 	size_t total = 0;
 	size_t inTotal = 0;
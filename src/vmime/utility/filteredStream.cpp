@@ -158,15 +158,14 @@ void dotFilteredOutputStream::writeImpl
 	const byte_t* end = data + count;
 	const byte_t* start = data;
 
-	if (m_previousChar == '.')
+	// <DOT> at the beginning of content was the only byte of the
+	// previous write: we now know whether it is followed by <CR><LF>
+	if (m_start && m_previousChar == '.')
 	{
 		if (data[0] == '\n' || data[0] == '\r')
-		{
 			m_stream.write(".", 1);  // extra <DOT>
-			m_stream.write(data, 1);
 
-			pos = data + 1;
-		}
+		m_start = false;
 	}
 
 	// Replace "\n." with "\n.."
@@ -199,7 +198,7 @@ void dotFilteredOutputStream::writeImpl
 
 	m_stream.write(start, end - start);
 	m_previousChar = data[count - 1];
-	m_start = false;
+	m_start = (m_start && count == 1 && data[0] == '.');
 }
 
 
@@ -0,0 +1,237 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/utility/instrumentation.hpp"
+#include "vmime/platform.hpp"
+
+#include "vmime/utility/sync/autoLock.hpp"
+
+#include <map>
+
+#if defined(__GNUC__)
+#	include <cxxabi.h>
+#	include <cstdlib>
+#endif
+
+
+namespace vmime {
+namespace utility {
+
+
+shared_ptr <instrumentation> instrumentation::sm_instance;
+
+
+const instrumentation::metric instrumentation::SOCKET_SENT_BYTES =
+	{ "vmime_socket_sent_bytes_total", NULL, "Bytes written to sockets." };
+const instrumentation::metric instrumentation::SOCKET_RECEIVED_BYTES =
+	{ "vmime_socket_received_bytes_total", NULL, "Bytes read from sockets." };
+const instrumentation::metric instrumentation::IMAP_COMMANDS =
+	{ "vmime_imap_commands_total", "command", "IMAP commands sent." };
+const instrumentation::metric instrumentation::IMAP_ROUND_TRIPS =
+	{ "vmime_imap_round_trips_total", NULL, "Waits for an IMAP server response." };
+const instrumentation::metric instrumentation::POP3_COMMANDS =
+	{ "vmime_pop3_commands_total", "command", "POP3 commands sent." };
+const instrumentation::metric instrumentation::POP3_ROUND_TRIPS =
+	{ "vmime_pop3_round_trips_total", NULL, "Waits for a POP3 server response." };
+const instrumentation::metric instrumentation::SMTP_COMMANDS =
+	{ "vmime_smtp_commands_total", "command", "SMTP commands sent." };
+const instrumentation::metric instrumentation::SMTP_ROUND_TRIPS =
+	{ "vmime_smtp_round_trips_total", NULL, "Waits for a SMTP server response." };
+
+const instrumentation::metric instrumentation::IMAP_COMMAND_DURATION =
+	{ "vmime_imap_command_duration_seconds", "command", "Time until an IMAP command completes." };
+const instrumentation::metric instrumentation::POP3_COMMAND_DURATION =
+	{ "vmime_pop3_command_duration_seconds", "command", "Time until a POP3 response is received." };
+const instrumentation::metric instrumentation::SMTP_COMMAND_DURATION =
+	{ "vmime_smtp_command_duration_seconds", "command", "Time until a SMTP response is received." };
+const instrumentation::metric instrumentation::TLS_HANDSHAKE_DURATION =
+	{ "vmime_tls_handshake_duration_seconds", NULL, "Time spent in TLS handshakes." };
+const instrumentation::metric instrumentation::PARSE_DURATION =
+	{ "vmime_parse_duration_seconds", "component", "Time spent parsing components, including sub-components." };
+const instrumentation::metric instrumentation::CHARSET_CONVERSION_DURATION =
+	{ "vmime_charset_conversion_duration_seconds", "conversion", "Time spent converting text between charsets." };
+
+
+// static
+void instrumentation::setInstance(shared_ptr <instrumentation> inst)
+{
+	sm_instance = inst;
+}
+
+
+// static
+shared_ptr <instrumentation> instrumentation::getInstance()
+{
+	return sm_instance;
+}
+
+
+// static
+vmime_uint64 instrumentation::now()
+{
+	return platform::getHandler()->getMonotonicTime();
+}
+
+
+#ifndef VMIME_BUILDING_DOC
+
+namespace {
+
+
+struct typeInfoLess
+{
+	bool operator()(const std::type_info* a, const std::type_info* b) const
+	{
+		return a->before(*b) != 0;
+	}
+};
+
+
+// Names already computed by getTypeName(), created when the library
+// is loaded so that it does not rely on thread-safe initialization
+// of local statics
+struct typeNameCache
+{
+	typeNameCache()
+	{
+		try
+		{
+			lock = platform::getHandler()->createCriticalSection();
+		}
+		catch (exceptions::no_platform_handler&)
+		{
+			// Handler will be installed by the application: lock is
+			// created on first use
+		}
+	}
+
+	std::map <const std::type_info*, string, typeInfoLess> names;
+	shared_ptr <sync::criticalSection> lock;
+};
+
+static typeNameCache typeNames;
+
+
+const string computeTypeName(const std::type_info& type)
+{
+	string name = type.name();
+
+#if defined(__GNUC__)
+	int status = 0;
+	char* demangled = abi::__cxa_demangle(type.name(), NULL, NULL, &status);
+
+	if (demangled != NULL)
+	{
+		if (status == 0)
+			name = demangled;
+
+		free(demangled);
+	}
+#endif // defined(__GNUC__)
+
+	// MSVC prefixes names with "class "
+	if (name.compare(0, 6, "class ") == 0)
+		name.erase(0, 6);
+
+	// Keep the unqualified class name
+	const size_t sep = name.rfind("::");
+
+	if (sep != string::npos)
+		name.erase(0, sep + 2);
+
+	return name;
+}
+
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+// static
+const string instrumentation::getTypeName(const std::type_info& type)
+{
+	if (!typeNames.lock)
+		typeNames.lock = platform::getHandler()->createCriticalSection();
+
+	sync::autoLock <sync::criticalSection> autoLock(typeNames.lock);
+
+	std::map <const std::type_info*, string, typeInfoLess>::const_iterator
+		it = typeNames.names.find(&type);
+
+	if (it == typeNames.names.end())
+		it = typeNames.names.insert(std::make_pair(&type, computeTypeName(type))).first;
+
+	return it->second;
+}
+
+
+
+// instrumentation::span
+
+instrumentation::span::span(const metric& m)
+	: m_instance(sm_instance), m_metric(m), m_start(0)
+{
+	if (m_instance)
+		m_start = now();
+}
+
+
+instrumentation::span::span(const metric& m, const string& label)
+	: m_instance(sm_instance), m_metric(m), m_start(0)
+{
+	if (m_instance)
+	{
+		m_label = label;
+		m_start = now();
+	}
+}
+
+
+instrumentation::span::~span()
+{
+	if (m_instance)
+	{
+		const vmime_uint64 end = now();
+
+		try
+		{
+			m_instance->measure(m_metric, m_label, end >= m_start ? end - m_start : 0);
+		}
+		catch (...)
+		{
+			// Never let instrumentation break the operation
+		}
+	}
+}
+
+
+void instrumentation::span::setLabel(const string& label)
+{
+	if (m_instance)
+		m_label = label;
+}
+
+
+} // utility
+} // vmime
@@ -0,0 +1,213 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_UTILITY_INSTRUMENTATION_HPP_INCLUDED
+#define VMIME_UTILITY_INSTRUMENTATION_HPP_INCLUDED
+
+
+#include "vmime/types.hpp"
+
+#include <typeinfo>
+
+
+namespace vmime {
+namespace utility {
+
+
+/** Receives counters and timings from the library.
+  *
+  * Implement this interface to export metrics to your monitoring
+  * system, or use metricsRegistry which aggregates them and can
+  * produce the Prometheus text format. Install it globally with
+  * setInstance(); when no instance is installed, instrumentation
+  * points cost a single test.
+  *
+  * Implementations may be called concurrently from several threads.
+  */
+
+class VMIME_EXPORT instrumentation : public object
+{
+public:
+
+	/** Describes a metric reported by the library.
+	  */
+	struct metric
+	{
+		const char* name;       /**< Metric name (eg. "vmime_imap_commands_total"). */
+		const char* labelName;  /**< Name of the label, or NULL if the metric has no label. */
+		const char* help;       /**< Short description of the metric. */
+	};
+
+
+	// Counters
+	static const metric SOCKET_SENT_BYTES;         /**< Bytes written to sockets. */
+	static const metric SOCKET_RECEIVED_BYTES;     /**< Bytes read from sockets. */
+	static const metric IMAP_COMMANDS;             /**< IMAP commands sent, by command. */
+	static const metric IMAP_ROUND_TRIPS;          /**< Waits for an IMAP server response. */
+	static const metric POP3_COMMANDS;             /**< POP3 commands sent, by command. */
+	static const metric POP3_ROUND_TRIPS;          /**< Waits for a POP3 server response. */
+	static const metric SMTP_COMMANDS;             /**< SMTP commands sent, by command. */
+	static const metric SMTP_ROUND_TRIPS;          /**< Waits for a SMTP server response. */
+
+	// Durations
+	static const metric IMAP_COMMAND_DURATION;     /**< Time until an IMAP command completes, by command. */
+	static const metric POP3_COMMAND_DURATION;     /**< Time until a POP3 response is received, by command. */
+	static const metric SMTP_COMMAND_DURATION;     /**< Time until a SMTP response is received, by command. */
+	static const metric TLS_HANDSHAKE_DURATION;    /**< Time spent in TLS handshakes. */
+	static const metric PARSE_DURATION;            /**< Time spent parsing, by component (includes sub-components). */
+	static const metric CHARSET_CONVERSION_DURATION;  /**< Time spent converting text, by charsets. */
+
+
+	/** Called to increment a counter.
+	  *
+	  * @param m metric
+	  * @param label label value, or empty if the metric has no label
+	  * @param value value to add to the counter
+	  */
+	virtual void count(const metric& m, const string& label, const vmime_uint64 value) = 0;
+
+	/** Called when a timed operation (span) has completed.
+	  *
+	  * @param m metric
+	  * @param label label value, or empty if the metric has no label
+	  * @param micros duration of the operation, in microseconds
+	  */
+	virtual void measure(const metric& m, const string& label, const vmime_uint64 micros) = 0;
+
+
+	/** Install the instrumentation which receives metrics from
+	  * the whole library. This should be done before using the
+	  * library, as this is not synchronized with instrumentation
+	  * points running in other threads.
+	  *
+	  * @param inst instrumentation, or NULL to disable instrumentation
+	  */
+	static void setInstance(shared_ptr <instrumentation> inst);
+
+	/** Return the installed instrumentation.
+	  *
+	  * @return instrumentation, or NULL if none is installed
+	  */
+	static shared_ptr <instrumentation> getInstance();
+
+	/** Test whether an instrumentation is installed.
+	  *
+	  * @return true if metrics should be reported, false otherwise
+	  */
+	static bool isEnabled()
+	{
+		return sm_instance.get() != NULL;
+	}
+
+	/** Increment a counter on the installed instrumentation, if any.
+	  *
+	  * @param m metric
+	  * @param label label value
+	  * @param value value to add to the counter
+	  */
+	static void increment(const metric& m, const string& label, const vmime_uint64 value = 1)
+	{
+		if (sm_instance)
+			sm_instance->count(m, label, value);
+	}
+
+	/** Report a duration on the installed instrumentation, if any.
+	  * Use this when the operation does not fit in a scope (see span).
+	  *
+	  * @param m metric
+	  * @param label label value
+	  * @param micros duration of the operation, in microseconds
+	  */
+	static void record(const metric& m, const string& label, const vmime_uint64 micros)
+	{
+		if (sm_instance)
+			sm_instance->measure(m, label, micros);
+	}
+
+	/** Return the current time of the monotonic clock used for
+	  * measuring spans.
+	  *
+	  * @return time in microseconds, from an unspecified origin
+	  */
+	static vmime_uint64 now();
+
+	/** Return a readable name for a type, to be used as a label.
+	  * The name is computed once per type, then cached.
+	  *
+	  * @param type type information
+	  * @return unqualified class name if it can be determined,
+	  * or implementation-defined name otherwise
+	  */
+	static const string getTypeName(const std::type_info& type);
+
+
+	/** Measures the duration of an operation, from construction
+	  * to destruction. Does nothing if no instrumentation was
+	  * installed at construction time.
+	  */
+	class VMIME_EXPORT span
+	{
+	public:
+
+		span(const metric& m);
+		span(const metric& m, const string& label);
+		~span();
+
+		/** Test whether this span is being measured. Use this
+		  * to avoid computing labels when it is not.
+		  *
+		  * @return true if the span will be reported, false otherwise
+		  */
+		bool isActive() const
+		{
+			return m_instance.get() != NULL;
+		}
+
+		/** Set the label reported with this span.
+		  *
+		  * @param label label value
+		  */
+		void setLabel(const string& label);
+
+	private:
+
+		span(const span&);
+		span& operator=(const span&);
+
+		shared_ptr <instrumentation> m_instance;
+		const metric& m_metric;
+		string m_label;
+		vmime_uint64 m_start;
+	};
+
+private:
+
+	static shared_ptr <instrumentation> sm_instance;
+};
+
+
+} // utility
+} // vmime
+
+
+#endif // VMIME_UTILITY_INSTRUMENTATION_HPP_INCLUDED
@@ -0,0 +1,299 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/utility/metricsRegistry.hpp"
+#include "vmime/utility/sync/autoLock.hpp"
+#include "vmime/platform.hpp"
+
+#include <sstream>
+
+
+namespace vmime {
+namespace utility {
+
+
+#ifndef VMIME_BUILDING_DOC
+
+namespace
+{
+
+// Escape a label value for the Prometheus text format
+const string escapeLabelValue(const string& value)
+{
+	string res;
+	res.reserve(value.length());
+
+	for (size_t i = 0 ; i < value.length() ; ++i)
+	{
+		const char c = value[i];
+
+		if (c == '\\')
+			res += "\\\\";
+		else if (c == '"')
+			res += "\\\"";
+		else if (c == '\n')
+			res += "\\n";
+		else
+			res += c;
+	}
+
+	return res;
+}
+
+
+// Format a set of labels, eg. {command="FETCH",le="0.5"}
+const string formatLabels(const char* labelName, const string& label,
+                          const char* extraName = NULL, const string& extra = "")
+{
+	string res;
+
+	if (labelName != NULL)
+		res += string(labelName) + "=\"" + escapeLabelValue(label) + "\"";
+
+	if (extraName != NULL)
+	{
+		if (!res.empty())
+			res += ",";
+
+		res += string(extraName) + "=\"" + extra + "\"";
+	}
+
+	return res.empty() ? res : "{" + res + "}";
+}
+
+
+const string formatSeconds(const vmime_uint64 micros)
+{
+	std::ostringstream oss;
+	oss.imbue(std::locale::classic());
+
+	oss << static_cast <double>(micros) / 1000000.0;
+
+	return oss.str();
+}
+
+} // namespace
+
+#endif // VMIME_BUILDING_DOC
+
+
+const vmime_uint64 metricsRegistry::BUCKETS[] =
+{
+	100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000, 10000000
+};
+
+const size_t metricsRegistry::BUCKET_COUNT = sizeof(BUCKETS) / sizeof(BUCKETS[0]);
+
+
+metricsRegistry::histogram::histogram()
+	: count(0), sum(0), buckets(BUCKET_COUNT, 0)
+{
+}
+
+
+metricsRegistry::metricsRegistry()
+	: m_lock(platform::getHandler()->createCriticalSection())
+{
+}
+
+
+void metricsRegistry::count(const metric& m, const string& label, const vmime_uint64 value)
+{
+	sync::autoLock <sync::criticalSection> lock(m_lock);
+
+	counterFamily& family = m_counters[m.name];
+	family.desc = &m;
+	family.values[label] += value;
+}
+
+
+void metricsRegistry::measure(const metric& m, const string& label, const vmime_uint64 micros)
+{
+	sync::autoLock <sync::criticalSection> lock(m_lock);
+
+	histogramFamily& family = m_durations[m.name];
+	family.desc = &m;
+
+	histogram& h = family.values[label];
+
+	++h.count;
+	h.sum += micros;
+
+	for (size_t i = 0 ; i < BUCKET_COUNT ; ++i)
+	{
+		if (micros <= BUCKETS[i])
+		{
+			++h.buckets[i];
+			break;
+		}
+	}
+}
+
+
+vmime_uint64 metricsRegistry::getCounter(const metric& m, const string& label) const
+{
+	sync::autoLock <sync::criticalSection> lock(m_lock);
+
+	std::map <string, counterFamily>::const_iterator it = m_counters.find(m.name);
+
+	if (it == m_counters.end())
+		return 0;
+
+	std::map <string, vmime_uint64>::const_iterator vit = it->second.values.find(label);
+
+	return (vit == it->second.values.end()) ? 0 : vit->second;
+}
+
+
+vmime_uint64 metricsRegistry::getDurationCount(const metric& m, const string& label) const
+{
+	sync::autoLock <sync::criticalSection> lock(m_lock);
+
+	std::map <string, histogramFamily>::const_iterator it = m_durations.find(m.name);
+
+	if (it == m_durations.end())
+		return 0;
+
+	std::map <string, histogram>::const_iterator vit = it->second.values.find(label);
+
+	return (vit == it->second.values.end()) ? 0 : vit->second.count;
+}
+
+
+vmime_uint64 metricsRegistry::getDurationSum(const metric& m, const string& label) const
+{
+	sync::autoLock <sync::criticalSection> lock(m_lock);
+
+	std::map <string, histogramFamily>::const_iterator it = m_durations.find(m.name);
+
+	if (it == m_durations.end())
+		return 0;
+
+	std::map <string, histogram>::const_iterator vit = it->second.values.find(label);
+
+	return (vit == it->second.values.end()) ? 0 : vit->second.sum;
+}
+
+
+const std::vector <string> metricsRegistry::getLabels(const metric& m) const
+{
+	sync::autoLock <sync::criticalSection> lock(m_lock);
+
+	std::vector <string> labels;
+
+	std::map <string, counterFamily>::const_iterator cit = m_counters.find(m.name);
+
+	if (cit != m_counters.end())
+	{
+		for (std::map <string, vmime_uint64>::const_iterator it = cit->second.values.begin() ;
+		     it != cit->second.values.end() ; ++it)
+		{
+			labels.push_back(it->first);
+		}
+	}
+
+	std::map <string, histogramFamily>::const_iterator hit = m_durations.find(m.name);
+
+	if (hit != m_durations.end())
+	{
+		for (std::map <string, histogram>::const_iterator it = hit->second.values.begin() ;
+		     it != hit->second.values.end() ; ++it)
+		{
+			labels.push_back(it->first);
+		}
+	}
+
+	return labels;
+}
+
+
+void metricsRegistry::reset()
+{
+	sync::autoLock <sync::criticalSection> lock(m_lock);
+
+	m_counters.clear();
+	m_durations.clear();
+}
+
+
+void metricsRegistry::writePrometheus(outputStream& os) const
+{
+	sync::autoLock <sync::criticalSection> lock(m_lock);
+
+	std::ostringstream oss;
+	oss.imbue(std::locale::classic());
+
+	for (std::map <string, counterFamily>::const_iterator it = m_counters.begin() ;
+	     it != m_counters.end() ; ++it)
+	{
+		const metric& m = *it->second.desc;
+
+		oss << "# HELP " << m.name << " " << m.help << "\n";
+		oss << "# TYPE " << m.name << " counter\n";
+
+		for (std::map <string, vmime_uint64>::const_iterator vit = it->second.values.begin() ;
+		     vit != it->second.values.end() ; ++vit)
+		{
+			oss << m.name << formatLabels(m.labelName, vit->first) << " " << vit->second << "\n";
+		}
+	}
+
+	for (std::map <string, histogramFamily>::const_iterator it = m_durations.begin() ;
+	     it != m_durations.end() ; ++it)
+	{
+		const metric& m = *it->second.desc;
+
+		oss << "# HELP " << m.name << " " << m.help << "\n";
+		oss << "# TYPE " << m.name << " histogram\n";
+
+		for (std::map <string, histogram>::const_iterator vit = it->second.values.begin() ;
+		     vit != it->second.values.end() ; ++vit)
+		{
+			const histogram& h = vit->second;
+			vmime_uint64 cumulative = 0;
+
+			for (size_t i = 0 ; i < BUCKET_COUNT ; ++i)
+			{
+				cumulative += h.buckets[i];
+
+				oss << m.name << "_bucket"
+				    << formatLabels(m.labelName, vit->first, "le", formatSeconds(BUCKETS[i]))
+				    << " " << cumulative << "\n";
+			}
+
+			oss << m.name << "_bucket" << formatLabels(m.labelName, vit->first, "le", "+Inf")
+			    << " " << h.count << "\n";
+			oss << m.name << "_sum" << formatLabels(m.labelName, vit->first)
+			    << " " << formatSeconds(h.sum) << "\n";
+			oss << m.name << "_count" << formatLabels(m.labelName, vit->first)
+			    << " " << h.count << "\n";
+		}
+	}
+
+	const string str = oss.str();
+	os.write(str.data(), str.length());
+}
+
+
+} // utility
+} // vmime
@@ -0,0 +1,143 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_UTILITY_METRICSREGISTRY_HPP_INCLUDED
+#define VMIME_UTILITY_METRICSREGISTRY_HPP_INCLUDED
+
+
+#include "vmime/utility/instrumentation.hpp"
+#include "vmime/utility/outputStream.hpp"
+#include "vmime/utility/sync/criticalSection.hpp"
+
+#include <map>
+#include <vector>
+
+
+namespace vmime {
+namespace utility {
+
+
+/** An instrumentation which aggregates metrics in memory:
+  * counters are summed, and durations are recorded in histograms.
+  * Metrics can be read back, or exported in the Prometheus text
+  * exposition format.
+  *
+  * Example:
+  *
+  *    shared_ptr <metricsRegistry> metrics = make_shared <metricsRegistry>();
+  *    instrumentation::setInstance(metrics);
+  *    ...
+  *    metrics->writePrometheus(os);
+  */
+
+class VMIME_EXPORT metricsRegistry : public instrumentation
+{
+public:
+
+	metricsRegistry();
+
+	void count(const metric& m, const string& label, const vmime_uint64 value);
+	void measure(const metric& m, const string& label, const vmime_uint64 micros);
+
+	/** Return the value of a counter.
+	  *
+	  * @param m metric
+	  * @param label label value
+	  * @return counter value, or 0 if nothing was reported
+	  */
+	vmime_uint64 getCounter(const metric& m, const string& label = "") const;
+
+	/** Return the number of operations measured for a duration metric.
+	  *
+	  * @param m metric
+	  * @param label label value
+	  * @return number of spans reported
+	  */
+	vmime_uint64 getDurationCount(const metric& m, const string& label = "") const;
+
+	/** Return the total duration reported for a duration metric.
+	  *
+	  * @param m metric
+	  * @param label label value
+	  * @return sum of durations, in microseconds
+	  */
+	vmime_uint64 getDurationSum(const metric& m, const string& label = "") const;
+
+	/** Return the label values reported for a metric.
+	  *
+	  * @param m metric
+	  * @return label values
+	  */
+	const std::vector <string> getLabels(const metric& m) const;
+
+	/** Discard all the collected metrics.
+	  */
+	void reset();
+
+	/** Write all the collected metrics in the Prometheus text
+	  * exposition format (version 0.0.4). Durations are exported
+	  * as histograms, in seconds.
+	  *
+	  * @param os output stream
+	  */
+	void writePrometheus(outputStream& os) const;
+
+	/** Upper bounds of histogram buckets, in microseconds. */
+	static const vmime_uint64 BUCKETS[];
+	static const size_t BUCKET_COUNT;
+
+private:
+
+	struct histogram
+	{
+		histogram();
+
+		vmime_uint64 count;
+		vmime_uint64 sum;
+		std::vector <vmime_uint64> buckets;
+	};
+
+	struct counterFamily
+	{
+		const metric* desc;
+		std::map <string, vmime_uint64> values;
+	};
+
+	struct histogramFamily
+	{
+		const metric* desc;
+		std::map <string, histogram> values;
+	};
+
+	std::map <string, counterFamily> m_counters;
+	std::map <string, histogramFamily> m_durations;
+
+	shared_ptr <sync::criticalSection> m_lock;
+};
+
+
+} // utility
+} // vmime
+
+
+#endif // VMIME_UTILITY_METRICSREGISTRY_HPP_INCLUDED
@@ -22,6 +22,7 @@
 //
 
 #include "vmime/utility/path.hpp"
+#include "vmime/constants.hpp"
 
 #include <algorithm>
 
@@ -146,6 +147,23 @@ bool path::operator!=(const path& p) const
 }
 
 
+bool path::operator<(const path& p) const
+{
+	const size_t count = std::min(m_list.size(), p.m_list.size());
+
+	for (size_t i = 0 ; i < count ; ++i)
+	{
+		const string a = m_list[i].getConvertedText(charset(charsets::UTF_8));
+		const string b = p.m_list[i].getConvertedText(charset(charsets::UTF_8));
+
+		if (a != b)
+			return (a < b);
+	}
+
+	return (m_list.size() < p.m_list.size());
+}
+
+
 bool path::isEmpty() const
 {
 	return (m_list.empty());
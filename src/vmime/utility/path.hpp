@@ -69,6 +69,15 @@ public:
 	bool operator==(const path& p) const;
 	bool operator!=(const path& p) const;
 
+	/** Compare two paths, component by component. This defines
+	  * a strict weak ordering consistent with operator==, so that
+	  * paths can be used as keys in sorted containers.
+	  *
+	  * @param p path to compare with
+	  * @return true if this path sorts before the specified path
+	  */
+	bool operator<(const path& p) const;
+
 	/** Append a component to the path.
 	  *
 	  * @param c component to add
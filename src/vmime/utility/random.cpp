@@ -24,6 +24,8 @@
 #include "vmime/utility/random.hpp"
 #include "vmime/platform.hpp"
 
+#include "vmime/utility/sync/autoLock.hpp"
+
 #include <ctime>
 
 
@@ -42,15 +44,51 @@ static unsigned int getRandomSeed()
 }
 
 
+#ifndef VMIME_BUILDING_DOC
+
+// State of the generator, created when the library is loaded so that
+// it does not rely on thread-safe initialization of local statics
+struct randomGeneratorState
+{
+	randomGeneratorState()
+		: next(0)
+	{
+		try
+		{
+			next = getRandomSeed();
+			lock = platform::getHandler()->createCriticalSection();
+		}
+		catch (exceptions::no_platform_handler&)
+		{
+			// Handler will be installed by the application: state is
+			// initialized on first use
+		}
+	}
+
+	unsigned int next;
+	shared_ptr <sync::criticalSection> lock;
+};
+
+static randomGeneratorState generatorState;
+
+#endif // VMIME_BUILDING_DOC
+
+
 unsigned int random::getNext()
 {
-	static unsigned int next = getRandomSeed();
+	if (!generatorState.lock)
+	{
+		generatorState.next = getRandomSeed();
+		generatorState.lock = platform::getHandler()->createCriticalSection();
+	}
+
+	sync::autoLock <sync::criticalSection> autoLock(generatorState.lock);
 
 	// Park and Miller's minimal standard generator:
 	// xn+1 = (a * xn + b) mod c
 	// xn+1 = (16807 * xn) mod (2^31 - 1)
-	next = static_cast<unsigned int>((16807 * next) % 2147483647ul);
-	return next;
+	generatorState.next = static_cast<unsigned int>((16807 * generatorState.next) % 2147483647ul);
+	return generatorState.next;
 }
 
 
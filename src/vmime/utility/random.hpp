@@ -39,7 +39,7 @@ class random
 {
 public:
 
-	/** Return a new random number.
+	/** Return a new random number. This function is thread-safe.
 	  *
 	  * @return random number
 	  */
@@ -0,0 +1,256 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "vmime/utility/windowedInputStream.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+namespace vmime {
+namespace utility {
+
+
+const size_t windowedInputStream::DEFAULT_WINDOW_SIZE;
+const size_t windowedInputStream::DEFAULT_MAX_READ_AHEAD;
+const size_t windowedInputStream::DEFAULT_CACHED_WINDOW_COUNT;
+const size_t windowedInputStream::UNKNOWN_SIZE;
+
+
+class windowedInputStream::window
+{
+public:
+
+	window(const size_t offset)
+		: m_offset(offset)
+	{
+	}
+
+	bool contains(const size_t pos) const
+	{
+		return pos >= m_offset && pos - m_offset < m_data.length();
+	}
+
+	size_t m_offset;
+	string m_data;
+};
+
+
+windowedInputStream::windowedInputStream(const size_t size)
+	: m_size(size), m_position(0), m_windowSize(DEFAULT_WINDOW_SIZE),
+	  m_maxReadAhead(DEFAULT_MAX_READ_AHEAD), m_cachedWindowCount(DEFAULT_CACHED_WINDOW_COUNT),
+	  m_lastFetchEnd(0), m_lastFetchLength(0), m_fetchCount(0), m_fetchedBytes(0)
+{
+}
+
+
+windowedInputStream::~windowedInputStream()
+{
+}
+
+
+void windowedInputStream::setWindowSize(const size_t size)
+{
+	m_windowSize = std::max(size, static_cast <size_t>(1));
+}
+
+
+size_t windowedInputStream::getWindowSize() const
+{
+	return m_windowSize;
+}
+
+
+void windowedInputStream::setMaxReadAhead(const size_t size)
+{
+	m_maxReadAhead = size;
+}
+
+
+size_t windowedInputStream::getMaxReadAhead() const
+{
+	return m_maxReadAhead;
+}
+
+
+void windowedInputStream::setCachedWindowCount(const size_t count)
+{
+	m_cachedWindowCount = std::max(count, static_cast <size_t>(1));
+
+	while (m_windows.size() > m_cachedWindowCount)
+		m_windows.pop_back();
+}
+
+
+size_t windowedInputStream::getCachedWindowCount() const
+{
+	return m_cachedWindowCount;
+}
+
+
+size_t windowedInputStream::getSize() const
+{
+	return m_size;
+}
+
+
+size_t windowedInputStream::getFetchCount() const
+{
+	return m_fetchCount;
+}
+
+
+size_t windowedInputStream::getFetchedBytes() const
+{
+	return m_fetchedBytes;
+}
+
+
+bool windowedInputStream::eof() const
+{
+	return m_size != UNKNOWN_SIZE && m_position >= m_size;
+}
+
+
+void windowedInputStream::reset()
+{
+	m_position = 0;
+}
+
+
+size_t windowedInputStream::read(byte_t* const data, const size_t count)
+{
+	size_t total = 0;
+
+	while (total < count)
+	{
+		shared_ptr <window> w = getWindow(m_position);
+
+		if (!w)
+			break;
+
+		const size_t offset = m_position - w->m_offset;
+		const size_t n = std::min(count - total, w->m_data.length() - offset);
+
+		std::memcpy(data + total, w->m_data.data() + offset, n);
+
+		total += n;
+		m_position += n;
+	}
+
+	return total;
+}
+
+
+size_t windowedInputStream::skip(const size_t count)
+{
+	size_t n = count;
+
+	if (m_size != UNKNOWN_SIZE)
+		n = std::min(count, m_size > m_position ? m_size - m_position : 0);
+
+	m_position += n;
+
+	return n;
+}
+
+
+size_t windowedInputStream::getPosition() const
+{
+	return m_position;
+}
+
+
+void windowedInputStream::seek(const size_t pos)
+{
+	m_position = pos;
+}
+
+
+shared_ptr <windowedInputStream::window> windowedInputStream::getWindow(const size_t pos)
+{
+	if (m_size != UNKNOWN_SIZE && pos >= m_size)
+		return null;
+
+	// Look in the windows already fetched
+	for (std::list <shared_ptr <window> >::iterator it = m_windows.begin() ; it != m_windows.end() ; ++it)
+	{
+		if ((*it)->contains(pos))
+		{
+			shared_ptr <window> w = *it;
+
+			m_windows.erase(it);
+			m_windows.push_front(w);
+
+			return w;
+		}
+	}
+
+	// Sequential read: fetch from the current position and grow the
+	// window; random access: fetch an aligned window
+	size_t offset, length;
+
+	if (m_lastFetchLength != 0 && pos == m_lastFetchEnd)
+	{
+		offset = pos;
+		length = std::max(m_windowSize, std::min(m_lastFetchLength * 2, m_maxReadAhead));
+	}
+	else
+	{
+		offset = pos - pos % m_windowSize;
+		length = m_windowSize;
+	}
+
+	if (m_size != UNKNOWN_SIZE && length > m_size - offset)
+		length = m_size - offset;
+
+	shared_ptr <window> w = make_shared <window>(offset);
+	fetch(offset, length, w->m_data);
+
+	++m_fetchCount;
+	m_fetchedBytes += w->m_data.length();
+
+	m_lastFetchEnd = offset + w->m_data.length();
+	m_lastFetchLength = length;
+
+	// End of the source has been reached
+	if (w->m_data.length() < length)
+	{
+		if (m_size == UNKNOWN_SIZE || m_lastFetchEnd < m_size)
+			m_size = m_lastFetchEnd;
+	}
+
+	if (!w->contains(pos))
+		return null;
+
+	m_windows.push_front(w);
+
+	if (m_windows.size() > m_cachedWindowCount)
+		m_windows.pop_back();
+
+	return w;
+}
+
+
+} // utility
+} // vmime
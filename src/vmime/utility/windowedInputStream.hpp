@@ -0,0 +1,169 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_UTILITY_WINDOWEDINPUTSTREAM_HPP_INCLUDED
+#define VMIME_UTILITY_WINDOWEDINPUTSTREAM_HPP_INCLUDED
+
+
+#include "vmime/utility/seekableInputStream.hpp"
+
+#include <list>
+
+
+namespace vmime {
+namespace utility {
+
+
+/** A seekable input stream over a remote source which is fetched in
+  * windows of limited size. Recently used windows are kept in memory,
+  * and the window size grows while data is read sequentially, so that
+  * fewer requests are needed to read large contents. Only the data
+  * which is actually read is fetched.
+  */
+
+class VMIME_EXPORT windowedInputStream : public seekableInputStream
+{
+public:
+
+	static const size_t DEFAULT_WINDOW_SIZE = 256 * 1024;
+	static const size_t DEFAULT_MAX_READ_AHEAD = 4 * 1024 * 1024;
+	static const size_t DEFAULT_CACHED_WINDOW_COUNT = 4;
+
+	/** Size value to use when the size of the source is not known. */
+	static const size_t UNKNOWN_SIZE = static_cast <size_t>(-1);
+
+
+	/** Construct a new stream.
+	  *
+	  * @param size size of the source data, or UNKNOWN_SIZE
+	  */
+	windowedInputStream(const size_t size);
+
+	~windowedInputStream();
+
+	/** Set the size of the data fetched on a random access.
+	  *
+	  * @param size window size, in bytes
+	  */
+	void setWindowSize(const size_t size);
+
+	/** Return the size of the data fetched on a random access.
+	  *
+	  * @return window size, in bytes
+	  */
+	size_t getWindowSize() const;
+
+	/** Set the maximum size of the data fetched at once when
+	  * reading sequentially. Each sequential request doubles the
+	  * window size, up to this limit.
+	  *
+	  * @param size maximum read-ahead size, in bytes
+	  */
+	void setMaxReadAhead(const size_t size);
+
+	/** Return the maximum size of the data fetched at once when
+	  * reading sequentially.
+	  *
+	  * @return maximum read-ahead size, in bytes
+	  */
+	size_t getMaxReadAhead() const;
+
+	/** Set how many windows are kept in memory.
+	  *
+	  * @param count number of windows
+	  */
+	void setCachedWindowCount(const size_t count);
+
+	/** Return how many windows are kept in memory.
+	  *
+	  * @return number of windows
+	  */
+	size_t getCachedWindowCount() const;
+
+	/** Return the size of the source data.
+	  *
+	  * @return size of the data, or UNKNOWN_SIZE if it is not known
+	  * (yet); the size becomes known when the end of the data is reached
+	  */
+	size_t getSize() const;
+
+	/** Return the number of requests made to the source.
+	  *
+	  * @return number of requests
+	  */
+	size_t getFetchCount() const;
+
+	/** Return the number of bytes fetched from the source.
+	  *
+	  * @return number of bytes
+	  */
+	size_t getFetchedBytes() const;
+
+
+	bool eof() const;
+	void reset();
+	size_t read(byte_t* const data, const size_t count);
+	size_t skip(const size_t count);
+	size_t getPosition() const;
+	void seek(const size_t pos);
+
+protected:
+
+	/** Fetch data from the source.
+	  *
+	  * @param offset offset of the data to fetch
+	  * @param length number of bytes to fetch
+	  * @param data will receive the data; it may be shorter than
+	  * requested only if the end of the source has been reached
+	  */
+	virtual void fetch(const size_t offset, const size_t length, string& data) = 0;
+
+private:
+
+	class window;
+
+	shared_ptr <window> getWindow(const size_t pos);
+
+
+	size_t m_size;
+	size_t m_position;
+
+	size_t m_windowSize;
+	size_t m_maxReadAhead;
+	size_t m_cachedWindowCount;
+
+	size_t m_lastFetchEnd;
+	size_t m_lastFetchLength;
+
+	size_t m_fetchCount;
+	size_t m_fetchedBytes;
+
+	std::list <shared_ptr <window> > m_windows;  // most recently used first
+};
+
+
+} // utility
+} // vmime
+
+
+#endif // VMIME_UTILITY_WINDOWEDINPUTSTREAM_HPP_INCLUDED
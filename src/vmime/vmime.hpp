@@ -57,6 +57,8 @@
 #include "vmime/fileContentHandler.hpp"
 #include "vmime/stringContentHandler.hpp"
 #include "vmime/streamContentHandler.hpp"
+#include "vmime/cachedContentHandler.hpp"
+#include "vmime/encodedContentCache.hpp"
 
 #include "vmime/generationContext.hpp"
 #include "vmime/parsingContext.hpp"
@@ -85,12 +87,14 @@
 #include "vmime/utility/outputStreamAdapter.hpp"
 #include "vmime/utility/outputStreamByteArrayAdapter.hpp"
 #include "vmime/utility/outputStreamSocketAdapter.hpp"
+#include "vmime/utility/bufferedOutputStreamSocketAdapter.hpp"
 #include "vmime/utility/outputStreamStringAdapter.hpp"
 #include "vmime/utility/streamUtils.hpp"
 
 // Message builder/parser
 #include "vmime/messageBuilder.hpp"
 #include "vmime/messageParser.hpp"
+#include "vmime/messageStreamParser.hpp"
 
 #include "vmime/fileAttachment.hpp"
 #include "vmime/defaultAttachment.hpp"
@@ -114,6 +118,8 @@
 #include "vmime/utility/datetimeUtils.hpp"
 #include "vmime/utility/filteredStream.hpp"
 #include "vmime/charsetConverter.hpp"
+#include "vmime/utility/instrumentation.hpp"
+#include "vmime/utility/metricsRegistry.hpp"
 
 // Security
 #include "vmime/security/authenticator.hpp"
@@ -137,11 +143,17 @@
 	#include "vmime/net/serviceFactory.hpp"
 	#include "vmime/net/store.hpp"
 	#include "vmime/net/transport.hpp"
+	#include "vmime/net/transportPool.hpp"
+	#include "vmime/net/dsnAttributes.hpp"
 
 	#include "vmime/net/session.hpp"
 
 	#include "vmime/net/folder.hpp"
 	#include "vmime/net/message.hpp"
+
+	#include "vmime/net/asyncEngine.hpp"
+	#include "vmime/net/asyncConnection.hpp"
+	#include "vmime/net/asyncResponseHandler.hpp"
 #endif // VMIME_HAVE_MESSAGING_FEATURES
 
 // Net/TLS
@@ -155,6 +167,7 @@
 	#include "vmime/security/cert/defaultCertificateVerifier.hpp"
 
 	#include "vmime/net/tls/TLSSession.hpp"
+	#include "vmime/net/tls/TLSSessionCache.hpp"
 #endif // VMIME_HAVE_TLS_SUPPORT
 
 
@@ -0,0 +1,341 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2014 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/net/imap/IMAPAsyncConnection.hpp"
+#include "vmime/net/pop3/POP3AsyncConnection.hpp"
+#include "vmime/net/smtp/SMTPAsyncConnection.hpp"
+
+
+/** Records the responses and errors it is notified of.
+  */
+class recordingResponseHandler : public vmime::net::asyncResponseHandler
+{
+public:
+
+	recordingResponseHandler()
+		: errorCount(0)
+	{
+	}
+
+	void onResponse(vmime::shared_ptr <vmime::net::asyncConnection> conn, const std::vector <vmime::string>& lines)
+	{
+		responses.push_back(lines);
+		success.push_back(conn->isSuccessResponse(lines));
+	}
+
+	void onError(vmime::shared_ptr <vmime::net::asyncConnection> /* conn */, const vmime::exception& /* e */)
+	{
+		++errorCount;
+	}
+
+	std::vector <std::vector <vmime::string> > responses;
+	std::vector <bool> success;
+	int errorCount;
+};
+
+
+VMIME_TEST_SUITE_BEGIN(asyncConnectionTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testSMTPPipelining)
+		VMIME_TEST(testSMTPAuthenticate)
+		VMIME_TEST(testPOP3MultiLine)
+		VMIME_TEST(testPOP3Login)
+		VMIME_TEST(testIMAPTaggedResponse)
+		VMIME_TEST(testIMAPLiteral)
+		VMIME_TEST(testIMAPEmptyLiteral)
+		VMIME_TEST(testIMAPUnsolicited)
+		VMIME_TEST(testPartialInput)
+		VMIME_TEST(testFail)
+	VMIME_TEST_LIST_END
+
+
+	void testSMTPPipelining()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::smtp::SMTPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::smtp::SMTPAsyncConnection>();
+		vmime::shared_ptr <recordingResponseHandler> handler =
+			vmime::make_shared <recordingResponseHandler>();
+
+		conn->expectGreeting(handler);
+		conn->hello("client.vmime.org", handler);
+		conn->sendCommand("NOOP", handler);
+
+		VASSERT_EQ("1", 3, conn->getPendingResponseCount());
+
+		conn->attach(sok, vmime::null);
+		conn->processOutput();
+
+		vmime::string out;
+		sok->localReceive(out);
+
+		VASSERT_EQ("2", "EHLO client.vmime.org\r\nNOOP\r\n", out);
+
+		sok->localSend("220 Service ready\r\n250-test.vmime.org\r\n250-PIPELINING\r\n250 8BITMIME\r\n550 No\r\n");
+		conn->processInput();
+
+		VASSERT_EQ("3", 0, conn->getPendingResponseCount());
+		VASSERT_EQ("4", 3, handler->responses.size());
+		VASSERT_EQ("5", 1, handler->responses[0].size());
+		VASSERT_EQ("6", 3, handler->responses[1].size());
+		VASSERT_EQ("7", "250 8BITMIME", handler->responses[1][2]);
+		VASSERT_TRUE("8", handler->success[1]);
+		VASSERT_FALSE("9", handler->success[2]);
+	}
+
+	void testSMTPAuthenticate()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::smtp::SMTPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::smtp::SMTPAsyncConnection>();
+
+		conn->attach(sok, vmime::null);
+		conn->authenticate("user", "pass", vmime::null);
+		conn->processOutput();
+
+		vmime::string out;
+		sok->localReceive(out);
+
+		VASSERT_EQ("1", "AUTH PLAIN AHVzZXIAcGFzcw==\r\n", out);
+	}
+
+	void testPOP3MultiLine()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::pop3::POP3AsyncConnection> conn =
+			vmime::make_shared <vmime::net::pop3::POP3AsyncConnection>();
+		vmime::shared_ptr <recordingResponseHandler> handler =
+			vmime::make_shared <recordingResponseHandler>();
+
+		conn->attach(sok, vmime::null);
+		conn->sendCommand("LIST 1", handler);
+		conn->sendCommand("RETR 1", handler);
+		conn->sendCommand("RETR 2", handler);
+
+		sok->localSend("+OK 1 120\r\n+OK message follows\r\nLine 1\r\n..Line 2\r\n.\r\n-ERR no such message\r\n");
+		conn->processInput();
+
+		VASSERT_EQ("1", 3, handler->responses.size());
+		VASSERT_EQ("2", 1, handler->responses[0].size());
+		VASSERT_EQ("3", 3, handler->responses[1].size());
+		VASSERT_EQ("4", "Line 1", handler->responses[1][1]);
+		VASSERT_EQ("5", ".Line 2", handler->responses[1][2]);
+		VASSERT_TRUE("6", handler->success[1]);
+		VASSERT_EQ("7", 1, handler->responses[2].size());
+		VASSERT_FALSE("8", handler->success[2]);
+	}
+
+	void testPOP3Login()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::pop3::POP3AsyncConnection> conn =
+			vmime::make_shared <vmime::net::pop3::POP3AsyncConnection>();
+		vmime::shared_ptr <recordingResponseHandler> handler =
+			vmime::make_shared <recordingResponseHandler>();
+
+		conn->attach(sok, vmime::null);
+		conn->login("user", "pass", handler);
+		conn->processOutput();
+
+		vmime::string out;
+		sok->localReceive(out);
+
+		VASSERT_EQ("1", "USER user\r\n", out);
+
+		sok->localSend("+OK\r\n");
+		conn->processInput();
+		conn->processOutput();
+
+		sok->localReceive(out);
+
+		VASSERT_EQ("2", "PASS pass\r\n", out);
+		VASSERT_EQ("3", 0, handler->responses.size());
+
+		sok->localSend("+OK logged in\r\n");
+		conn->processInput();
+
+		VASSERT_EQ("4", 1, handler->responses.size());
+		VASSERT_TRUE("5", handler->success[0]);
+	}
+
+	void testIMAPTaggedResponse()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::imap::IMAPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::imap::IMAPAsyncConnection>();
+		vmime::shared_ptr <recordingResponseHandler> handler =
+			vmime::make_shared <recordingResponseHandler>();
+
+		conn->attach(sok, vmime::null);
+		conn->expectGreeting(handler);
+		conn->login("user", "pass", handler);
+		conn->processOutput();
+
+		vmime::string out;
+		sok->localReceive(out);
+
+		const vmime::string tag = out.substr(0, out.find(' '));
+
+		VASSERT_EQ("1", tag + " LOGIN user pass\r\n", out);
+
+		sok->localSend("* OK IMAP4rev1 ready\r\n* CAPABILITY IMAP4rev1\r\n"
+			+ tag + " OK LOGIN completed\r\n");
+		conn->processInput();
+
+		VASSERT_EQ("2", 2, handler->responses.size());
+		VASSERT_TRUE("3", handler->success[0]);
+		VASSERT_EQ("4", 2, handler->responses[1].size());
+		VASSERT_TRUE("5", handler->success[1]);
+	}
+
+	void testIMAPLiteral()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::imap::IMAPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::imap::IMAPAsyncConnection>();
+		vmime::shared_ptr <recordingResponseHandler> handler =
+			vmime::make_shared <recordingResponseHandler>();
+
+		conn->attach(sok, vmime::null);
+		conn->sendCommand("FETCH 1 BODY[HEADER]", handler);
+		conn->processOutput();
+
+		vmime::string out;
+		sok->localReceive(out);
+
+		const vmime::string tag = out.substr(0, out.find(' '));
+
+		// Literal contains a line which looks like a tagged response
+		sok->localSend("* 1 FETCH (BODY[HEADER] {14}\r\n" + tag + " OK x\r\n\r\n)\r\n"
+			+ tag + " NO failed\r\n");
+		conn->processInput();
+
+		VASSERT_EQ("1", 1, handler->responses.size());
+		VASSERT_EQ("2", 2, handler->responses[0].size());
+		VASSERT_EQ("3", "* 1 FETCH (BODY[HEADER] {14}\r\n" + tag + " OK x\r\n\r\n)", handler->responses[0][0]);
+		VASSERT_FALSE("4", handler->success[0]);
+	}
+
+	void testIMAPEmptyLiteral()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::imap::IMAPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::imap::IMAPAsyncConnection>();
+		vmime::shared_ptr <recordingResponseHandler> handler =
+			vmime::make_shared <recordingResponseHandler>();
+
+		conn->attach(sok, vmime::null);
+		conn->sendCommand("FETCH 1 BODY[TEXT]", handler);
+		conn->processOutput();
+
+		vmime::string out;
+		sok->localReceive(out);
+
+		const vmime::string tag = out.substr(0, out.find(' '));
+
+		// "{0}" is followed by the rest of the line
+		sok->localSend("* 1 FETCH (BODY[TEXT] {0}\r\n)\r\n" + tag + " OK done\r\n");
+		conn->processInput();
+
+		VASSERT_EQ("1", 1, handler->responses.size());
+		VASSERT_EQ("2", 2, handler->responses[0].size());
+		VASSERT_EQ("3", "* 1 FETCH (BODY[TEXT] {0}\r\n)", handler->responses[0][0]);
+		VASSERT_TRUE("4", handler->success[0]);
+	}
+
+	void testIMAPUnsolicited()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::imap::IMAPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::imap::IMAPAsyncConnection>();
+		vmime::shared_ptr <recordingResponseHandler> handler =
+			vmime::make_shared <recordingResponseHandler>();
+		vmime::shared_ptr <recordingResponseHandler> unsolicitedHandler =
+			vmime::make_shared <recordingResponseHandler>();
+
+		conn->attach(sok, vmime::null);
+		conn->setUnsolicitedResponseHandler(unsolicitedHandler);
+		conn->sendCommand("IDLE", handler);
+
+		sok->localSend("+ idling\r\n* 4 EXISTS\r\n* 1 RECENT\r\n");
+		conn->processInput();
+
+		VASSERT_EQ("1", 1, handler->responses.size());
+		VASSERT_TRUE("2", handler->success[0]);
+		VASSERT_EQ("3", 2, unsolicitedHandler->responses.size());
+		VASSERT_EQ("4", "* 4 EXISTS", unsolicitedHandler->responses[0][0]);
+	}
+
+	void testPartialInput()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::smtp::SMTPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::smtp::SMTPAsyncConnection>();
+		vmime::shared_ptr <recordingResponseHandler> handler =
+			vmime::make_shared <recordingResponseHandler>();
+
+		conn->attach(sok, vmime::null);
+		conn->expectGreeting(handler);
+
+		sok->localSend("220 Serv");
+		conn->processInput();
+
+		VASSERT_EQ("1", 0, handler->responses.size());
+
+		sok->localSend("ice ready\r");
+		conn->processInput();
+
+		VASSERT_EQ("2", 0, handler->responses.size());
+
+		sok->localSend("\n");
+		conn->processInput();
+
+		VASSERT_EQ("3", 1, handler->responses.size());
+		VASSERT_EQ("4", "220 Service ready", handler->responses[0][0]);
+	}
+
+	void testFail()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::smtp::SMTPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::smtp::SMTPAsyncConnection>();
+		vmime::shared_ptr <recordingResponseHandler> handler =
+			vmime::make_shared <recordingResponseHandler>();
+
+		conn->attach(sok, vmime::null);
+		conn->sendCommand("NOOP", handler);
+		conn->sendCommand("NOOP", handler);
+
+		conn->fail(vmime::exceptions::connection_error("test"));
+
+		VASSERT_EQ("1", 2, handler->errorCount);
+		VASSERT_EQ("2", 0, conn->getPendingResponseCount());
+		VASSERT_FALSE("3", conn->isConnected());
+		VASSERT_FALSE("4", conn->hasPendingOutput());
+	}
+
+VMIME_TEST_SUITE_END
+
@@ -0,0 +1,136 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/net/imap/IMAPCommandBatcher.hpp"
+#include "vmime/net/imap/IMAPUtils.hpp"
+
+
+using namespace vmime::net;
+using namespace vmime::net::imap;
+
+
+VMIME_TEST_SUITE_BEGIN(IMAPCommandBatcherTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testSmallSet)
+		VMIME_TEST(testSplitByCount)
+		VMIME_TEST(testSplitByLength)
+		VMIME_TEST(testSplitUIDs)
+		VMIME_TEST(testOpenRange)
+		VMIME_TEST(testBuildCommands)
+	VMIME_TEST_LIST_END
+
+
+	static const vmime::string toString(const std::vector <messageSet>& chunks)
+	{
+		std::ostringstream oss;
+
+		for (size_t i = 0 ; i < chunks.size() ; ++i)
+		{
+			if (i != 0)
+				oss << " | ";
+
+			oss << IMAPUtils::messageSetToSequenceSet(chunks[i]);
+		}
+
+		return oss.str();
+	}
+
+
+	void testSmallSet()
+	{
+		IMAPCommandBatcher batcher;
+
+		VASSERT_EQ("1", "1:5,7,10:20",
+			toString(batcher.split(messageSet::byNumber(numberSet::fromSequenceSet("1:5,7,10:20")), 20)));
+	}
+
+	void testSplitByCount()
+	{
+		IMAPCommandBatcher batcher;
+		batcher.setMaxMessagesPerCommand(4);
+
+		VASSERT_EQ("1", "1:3,7 | 8:11 | 20:21",
+			toString(batcher.split(messageSet::byNumber(numberSet::fromSequenceSet("1:3,7:11,20:21")), 0)));
+
+		batcher.setMaxMessagesPerCommand(1000);
+
+		VASSERT_EQ("2", "1:1000 | 1001:2000 | 2001:2500",
+			toString(batcher.split(messageSet::byNumber(1, 2500), 0)));
+	}
+
+	void testSplitByLength()
+	{
+		IMAPCommandBatcher batcher;
+		batcher.setMaxCommandLength(20);
+
+		// 10 characters are left for the sequence set
+		VASSERT_EQ("1", "1,3,5,7,9 | 11,13,15 | 17,19",
+			toString(batcher.split(messageSet::byNumber
+				(numberSet::fromSequenceSet("1,3,5,7,9,11,13,15,17,19")), 10)));
+
+		std::vector <messageSet> chunks = batcher.split
+			(messageSet::byNumber(numberSet::fromSequenceSet("100:200,300:400,500:600")), 10);
+
+		VASSERT_EQ("2", 3, chunks.size());
+		VASSERT_TRUE("number", chunks[0].isNumberSet());
+	}
+
+	void testSplitUIDs()
+	{
+		IMAPCommandBatcher batcher;
+		batcher.setMaxMessagesPerCommand(10);
+
+		std::vector <messageSet> chunks = batcher.split(messageSet::byUID(1000, 1014), 0);
+
+		VASSERT_EQ("count", 2, chunks.size());
+		VASSERT_TRUE("uid", chunks[0].isUIDSet());
+		VASSERT_EQ("str", "1000:1009 | 1010:1014", toString(chunks));
+	}
+
+	void testOpenRange()
+	{
+		IMAPCommandBatcher batcher;
+		batcher.setMaxMessagesPerCommand(2);
+
+		// Sets extending to the last message are not split
+		VASSERT_EQ("number", 1, batcher.split(messageSet::byNumber(1, -1), 0).size());
+		VASSERT_EQ("uid", "1000:*", toString(batcher.split(messageSet::byUID(1000, "*"), 0)));
+	}
+
+	void testBuildCommands()
+	{
+		IMAPCommandBatcher batcher;
+		batcher.setMaxMessagesPerCommand(3);
+
+		std::vector <vmime::string> commands = batcher.buildCommands
+			(messageSet::byNumber(1, 5), "STORE ", " +FLAGS (\\Deleted)");
+
+		VASSERT_EQ("count", 2, commands.size());
+		VASSERT_EQ("1", "STORE 1:3 +FLAGS (\\Deleted)", commands[0]);
+		VASSERT_EQ("2", "STORE 4:5 +FLAGS (\\Deleted)", commands[1]);
+	}
+
+VMIME_TEST_SUITE_END
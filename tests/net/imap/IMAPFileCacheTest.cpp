@@ -0,0 +1,291 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/platform.hpp"
+
+#include "vmime/net/imap/IMAPFileCache.hpp"
+#include "vmime/net/imap/IMAPMessageStructure.hpp"
+#include "vmime/net/imap/IMAPMessagePart.hpp"
+
+#include "vmime/utility/outputStreamStringAdapter.hpp"
+
+#include <ctime>
+
+
+typedef vmime::utility::file::path fspath;
+typedef vmime::utility::file::path::component fspathc;
+
+
+VMIME_TEST_SUITE_BEGIN(IMAPFileCacheTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testStructureSerialization)
+		VMIME_TEST(testMessageInfo)
+		VMIME_TEST(testPartContents)
+		VMIME_TEST(testPartContentsWriter)
+		VMIME_TEST(testValidateMailbox)
+		VMIME_TEST(testRemoveMessage)
+	VMIME_TEST_LIST_END
+
+
+	fspath m_tempPath;
+
+
+	IMAPFileCacheTest()
+	{
+		m_tempPath = fspath() / fspathc("tmp")   // Use /tmp
+			/ fspathc("vmime-imapcache" + vmime::utility::stringUtils::toString(std::time(NULL))
+				+ vmime::utility::stringUtils::toString(std::rand()));
+	}
+
+	void tearDown()
+	{
+		vmime::shared_ptr <vmime::utility::fileSystemFactory> fsf =
+			vmime::platform::getHandler()->getFileSystemFactory();
+
+		recursiveDelete(fsf->create(m_tempPath));
+	}
+
+	void recursiveDelete(vmime::shared_ptr <vmime::utility::file> file)
+	{
+		if (!file->exists())
+			return;
+
+		if (file->isDirectory())
+		{
+			vmime::shared_ptr <vmime::utility::fileIterator> files = file->getFiles();
+
+			while (files->hasMoreElements())
+				recursiveDelete(files->nextElement());
+		}
+
+		file->remove();
+	}
+
+	const vmime::string getPart(vmime::net::imap::IMAPFileCache& cache,
+		const vmime::string& mailbox, const vmime_uint32 uidValidity,
+		const vmime::string& uid, const vmime::string& section)
+	{
+		vmime::string data;
+		vmime::utility::outputStreamStringAdapter os(data);
+
+		if (!cache.getPartContents(mailbox, uidValidity, uid, section, os))
+			return "<none>";
+
+		os.flush();
+
+		return data;
+	}
+
+
+	void testStructureSerialization()
+	{
+		// multipart/mixed, containing text/plain and multipart/alternative
+		const vmime::string data =
+			"1\n"
+			"multipart/mixed 0 -\n"
+			"2\n"
+			"text/plain 120 -\n"
+			"0\n"
+			"multipart/alternative 0 -\n"
+			"2\n"
+			"text/plain 42 -\n"
+			"0\n"
+			"text/html 84 -\n"
+			"0\n";
+
+		vmime::shared_ptr <vmime::net::imap::IMAPMessageStructure> str =
+			vmime::net::imap::IMAPMessageStructure::unserialize(data);
+
+		VASSERT_NOT_NULL("structure", str);
+		VASSERT_EQ("count", 1, str->getPartCount());
+
+		vmime::shared_ptr <vmime::net::messagePart> root = str->getPartAt(0);
+
+		VASSERT_EQ("root type", "multipart/mixed", root->getType().generate());
+		VASSERT_EQ("root count", 2, root->getPartCount());
+		VASSERT_EQ("text size", 120, root->getPartAt(0)->getSize());
+		VASSERT_EQ("alt type", "multipart/alternative", root->getPartAt(1)->getType().generate());
+		VASSERT_EQ("html type", "text/html", root->getPartAt(1)->getPartAt(1)->getType().generate());
+		VASSERT_EQ("html number", 1, root->getPartAt(1)->getPartAt(1)->getNumber());
+
+		VASSERT_EQ("serialize", data, str->serialize());
+
+		// Part header
+		vmime::dynamicCast <vmime::net::imap::IMAPMessagePart>(root->getPartAt(0))->
+			getOrCreateHeader().parse("Content-Type: text/plain; charset=utf-8\r\n");
+
+		vmime::shared_ptr <vmime::net::imap::IMAPMessageStructure> str2 =
+			vmime::net::imap::IMAPMessageStructure::unserialize(str->serialize());
+
+		VASSERT_NOT_NULL("structure 2", str2);
+		VASSERT_EQ("header", "Content-Type: text/plain; charset=utf-8\r\n",
+			str2->getPartAt(0)->getPartAt(0)->getHeader()->generate());
+
+		// Invalid data
+		VASSERT_NULL("invalid", vmime::net::imap::IMAPMessageStructure::unserialize("2\ntext/plain 1 -\n0\n"));
+	}
+
+	void testMessageInfo()
+	{
+		vmime::net::imap::IMAPFileCache cache(m_tempPath);
+
+		vmime::net::imap::IMAPCache::messageInfo info;
+
+		VASSERT_FALSE("miss", cache.getMessageInfo("INBOX", 42, "1000", info));
+
+		info.attributes = vmime::net::fetchAttributes::FULL_HEADER | vmime::net::fetchAttributes::SIZE;
+		info.header = "Subject: test\r\nFrom: me@example.com\r\n";
+		info.structure = "";
+		info.size = 12345;
+		info.flags = 3;
+		info.modSequence = 17;
+		info.highestModSequence = 99;
+
+		cache.putMessageInfo("INBOX", 42, "1000", info);
+
+		vmime::net::imap::IMAPCache::messageInfo info2;
+
+		VASSERT_TRUE("hit", cache.getMessageInfo("INBOX", 42, "1000", info2));
+		VASSERT_EQ("attributes", info.attributes, info2.attributes);
+		VASSERT_EQ("header", info.header, info2.header);
+		VASSERT_EQ("size", 12345, info2.size);
+		VASSERT_EQ("flags", 3, info2.flags);
+		VASSERT_EQ("modseq", 17, info2.modSequence);
+		VASSERT_EQ("highest modseq", 99, info2.highestModSequence);
+
+		// Replace
+		info.header = "Subject: x\r\n";
+		cache.putMessageInfo("INBOX", 42, "1000", info);
+
+		VASSERT_TRUE("hit 2", cache.getMessageInfo("INBOX", 42, "1000", info2));
+		VASSERT_EQ("header 2", "Subject: x\r\n", info2.header);
+
+		// Other UIDVALIDITY or mailbox
+		VASSERT_FALSE("uidvalidity", cache.getMessageInfo("INBOX", 43, "1000", info2));
+		VASSERT_FALSE("mailbox", cache.getMessageInfo("Sent/Old", 42, "1000", info2));
+	}
+
+	void testPartContents()
+	{
+		vmime::net::imap::IMAPFileCache cache(m_tempPath);
+
+		cache.putPartContents("INBOX", 42, "1000", "1.2", "part data");
+		cache.putPartContents("INBOX", 42, "1000", "", "whole message");
+
+		VASSERT_EQ("section", "part data", getPart(cache, "INBOX", 42, "1000", "1.2"));
+		VASSERT_EQ("whole", "whole message", getPart(cache, "INBOX", 42, "1000", ""));
+		VASSERT_EQ("miss", "<none>", getPart(cache, "INBOX", 42, "1000", "TEXT"));
+
+		cache.setCachePartContents(false);
+
+		VASSERT_EQ("disabled", "<none>", getPart(cache, "INBOX", 42, "1000", "1.2"));
+	}
+
+	void testPartContentsWriter()
+	{
+		vmime::net::imap::IMAPFileCache cache(m_tempPath);
+
+		cache.putPartContents("INBOX", 42, "1000", "1.2", "old data");
+
+		// Contents are stored on commit only
+		vmime::shared_ptr <vmime::net::imap::IMAPCache::partContentsWriter> writer =
+			cache.createPartContentsWriter("INBOX", 42, "1000", "1.2");
+
+		writer->getOutputStream().write("new ", 4);
+		writer->getOutputStream().write("data", 4);
+
+		VASSERT_EQ("before commit", "old data", getPart(cache, "INBOX", 42, "1000", "1.2"));
+
+		writer->commit();
+		writer = vmime::null;
+
+		VASSERT_EQ("after commit", "new data", getPart(cache, "INBOX", 42, "1000", "1.2"));
+
+		// Contents are discarded if not committed
+		writer = cache.createPartContentsWriter("INBOX", 42, "1000", "TEXT");
+		writer->getOutputStream().write("text", 4);
+		writer = vmime::null;
+
+		VASSERT_EQ("discarded", "<none>", getPart(cache, "INBOX", 42, "1000", "TEXT"));
+
+		// No temporary file is left
+		vmime::shared_ptr <vmime::utility::fileSystemFactory> fsf =
+			vmime::platform::getHandler()->getFileSystemFactory();
+
+		vmime::shared_ptr <vmime::utility::file> dir =
+			fsf->create(m_tempPath / fspathc("m494e424f58") / fspathc("42"));
+		vmime::shared_ptr <vmime::utility::fileIterator> files = dir->getFiles();
+
+		int count = 0;
+
+		for ( ; files->hasMoreElements() ; files->nextElement())
+			++count;
+
+		VASSERT_EQ("files", 1, count);
+
+		cache.setCachePartContents(false);
+
+		VASSERT_TRUE("disabled", cache.createPartContentsWriter("INBOX", 42, "1000", "1.2") == NULL);
+	}
+
+	void testValidateMailbox()
+	{
+		vmime::net::imap::IMAPFileCache cache(m_tempPath);
+
+		vmime::net::imap::IMAPCache::messageInfo info;
+
+		cache.putMessageInfo("INBOX", 42, "1", info);
+		cache.putMessageInfo("INBOX", 43, "1", info);
+		cache.putMessageInfo("Other", 42, "1", info);
+
+		cache.validateMailbox("INBOX", 43);
+
+		VASSERT_FALSE("old", cache.getMessageInfo("INBOX", 42, "1", info));
+		VASSERT_TRUE("current", cache.getMessageInfo("INBOX", 43, "1", info));
+		VASSERT_TRUE("other", cache.getMessageInfo("Other", 42, "1", info));
+	}
+
+	void testRemoveMessage()
+	{
+		vmime::net::imap::IMAPFileCache cache(m_tempPath);
+
+		vmime::net::imap::IMAPCache::messageInfo info;
+
+		cache.putMessageInfo("INBOX", 42, "1", info);
+		cache.putPartContents("INBOX", 42, "1", "TEXT", "text");
+		cache.putMessageInfo("INBOX", 42, "10", info);
+		cache.putPartContents("INBOX", 42, "10", "TEXT", "text 10");
+
+		cache.removeMessage("INBOX", 42, "1");
+
+		VASSERT_FALSE("info", cache.getMessageInfo("INBOX", 42, "1", info));
+		VASSERT_EQ("part", "<none>", getPart(cache, "INBOX", 42, "1", "TEXT"));
+
+		VASSERT_TRUE("other info", cache.getMessageInfo("INBOX", 42, "10", info));
+		VASSERT_EQ("other part", "text 10", getPart(cache, "INBOX", 42, "10", "TEXT"));
+	}
+
+VMIME_TEST_SUITE_END
@@ -32,6 +32,8 @@ VMIME_TEST_SUITE_BEGIN(IMAPParserTest)
 	VMIME_TEST_LIST_BEGIN
 		VMIME_TEST(testExtraSpaceInCapaResponse)
 		VMIME_TEST(testContinueReqWithoutSpace)
+		VMIME_TEST(testExpectedTags)
+		VMIME_TEST(testHeaderLiteral)
 	VMIME_TEST_LIST_END
 
 
@@ -101,4 +103,96 @@ VMIME_TEST_SUITE_BEGIN(IMAPParserTest)
 		VASSERT_THROW("strict mode", parser->readResponse(), vmime::exceptions::invalid_response);
 	}
 
+	void testExpectedTags()
+	{
+		vmime::shared_ptr <testSocket> socket = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::timeoutHandler> toh = vmime::make_shared <testTimeoutHandler>();
+
+		vmime::shared_ptr <vmime::net::imap::IMAPTag> tag =
+				vmime::make_shared <vmime::net::imap::IMAPTag>();
+
+		vmime::shared_ptr <vmime::net::imap::IMAPParser> parser =
+				vmime::make_shared <vmime::net::imap::IMAPParser>
+						(tag, vmime::dynamicCast <vmime::net::socket>(socket), toh);
+
+		// Commands a001 and a002 are in flight; a002 completes first
+		++(*tag);
+
+		std::set <vmime::string> tags;
+		tags.insert("a001");
+		tags.insert("a002");
+
+		socket->localSend(
+			"* 1 FETCH (FLAGS (\\Seen))\r\n"
+			"a002 OK Store completed.\r\n"
+			"a001 OK Fetch completed.\r\n");
+
+		parser->setExpectedTags(tags);
+
+		delete parser->readResponse();
+		VASSERT_EQ("first", "a002", parser->getLastTag());
+
+		tags.erase("a002");
+		parser->setExpectedTags(tags);
+
+		delete parser->readResponse();
+		VASSERT_EQ("second", "a001", parser->getLastTag());
+
+		// Only the current tag is accepted by default
+		parser->setExpectedTags(std::set <vmime::string>());
+
+		socket->localSend("a001 OK Done.\r\n");
+
+		VASSERT_THROW("unexpected tag", parser->readResponse(), vmime::exceptions::invalid_response);
+	}
+
+	void testHeaderLiteral()
+	{
+		vmime::shared_ptr <testSocket> socket = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::timeoutHandler> toh = vmime::make_shared <testTimeoutHandler>();
+
+		vmime::shared_ptr <vmime::net::imap::IMAPTag> tag =
+				vmime::make_shared <vmime::net::imap::IMAPTag>();
+
+		const vmime::string header =
+			"From: me@vmime.org\r\n"
+			"Subject: Test\r\n"
+			"\r\n";
+
+		std::ostringstream oss;
+		oss << "* 1 FETCH (RFC822.HEADER {" << header.length() << "}\r\n" << header
+		    << " BODY[1.MIME] {" << header.length() << "}\r\n" << header
+		    << " BODY[TEXT] {4}\r\nbody)\r\n"
+		    << "a001 OK Fetch completed.\r\n";
+
+		socket->localSend(oss.str());
+
+		vmime::shared_ptr <vmime::net::imap::IMAPParser> parser =
+				vmime::make_shared <vmime::net::imap::IMAPParser>
+						(tag, vmime::dynamicCast <vmime::net::socket>(socket), toh);
+
+		std::auto_ptr <vmime::net::imap::IMAPParser::response> resp(parser->readResponse());
+
+		const std::vector <vmime::net::imap::IMAPParser::msg_att_item*> items =
+			resp->continue_req_or_response_data()[0]->response_data()->message_data()->msg_att()->items();
+
+		VASSERT_EQ("count", 3, items.size());
+
+		// Header literals are parsed into headers
+		vmime::shared_ptr <vmime::header> hdr1 = items[0]->header();
+
+		VASSERT_NOT_NULL("header 1", hdr1);
+		VASSERT_EQ("header 1 fields", 2, hdr1->getFieldCount());
+		VASSERT_EQ("header 1 subject", "Test", hdr1->Subject()->getValue <vmime::text>()->getWholeBuffer());
+
+		vmime::shared_ptr <vmime::header> hdr2 = items[1]->header();
+
+		VASSERT_NOT_NULL("header 2", hdr2);
+		VASSERT_EQ("header 2 fields", 2, hdr2->getFieldCount());
+
+		// Other literals are kept as strings
+		VASSERT_NULL("text", items[2]->header());
+		VASSERT_EQ("text value", "body", items[2]->nstring()->value());
+	}
+
 VMIME_TEST_SUITE_END
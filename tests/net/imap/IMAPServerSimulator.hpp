@@ -0,0 +1,740 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_TESTS_NET_IMAP_IMAPSERVERSIMULATOR_HPP_INCLUDED
+#define VMIME_TESTS_NET_IMAP_IMAPSERVERSIMULATOR_HPP_INCLUDED
+
+
+#include "tests/net/serverSimulator.hpp"
+
+#include "vmime/utility/stringUtils.hpp"
+
+
+/** Simulated IMAP server.
+  *
+  * Serves the folders of the simulator, all filled with the same
+  * synthetic messages (UIDs are equal to sequence numbers). Capabilities
+  * listed in the simulator are advertised in the greeting; CONDSTORE
+  * enables MODSEQ and HIGHESTMODSEQ responses, and LIST-STATUS enables
+  * the STATUS return option of LIST. Any user name and password are
+  * accepted.
+  */
+class IMAPServerSimulatorSocket : public serverSimulatorSocket
+{
+public:
+
+	IMAPServerSimulatorSocket(vmime::shared_ptr <serverSimulator> sim)
+		: serverSimulatorSocket(sim), m_appending(false)
+	{
+	}
+
+protected:
+
+	void sendGreeting()
+	{
+		localSend("* OK [CAPABILITY " + getCapabilityList()
+			+ "] test.vmime.org IMAP4rev1 server simulator ready\r\n");
+	}
+
+	void processLine(const vmime::string& line)
+	{
+		if (m_appending)
+		{
+			// End of APPEND command, after the message literal
+			m_appending = false;
+
+			std::ostringstream oss;
+			oss.imbue(std::locale::classic());
+			oss << m_tag << " OK [APPENDUID 1 "
+			    << (getSimulator()->getMessageCount() + getSimulator()->getDeliveredMessages().size())
+			    << "] APPEND completed\r\n";
+
+			localSend(oss.str());
+			return;
+		}
+
+		std::istringstream iss(line);
+		iss.imbue(std::locale::classic());
+
+		vmime::string cmd;
+		iss >> m_tag >> cmd;
+
+		cmd = vmime::utility::stringUtils::toUpper(cmd);
+
+		bool uid = false;
+
+		if (cmd == "UID")
+		{
+			iss >> cmd;
+			cmd = vmime::utility::stringUtils::toUpper(cmd);
+
+			uid = true;
+		}
+
+		if (!checkCommand(cmd))
+			return;
+
+		vmime::string args;
+		std::getline(iss, args);
+
+		if (!args.empty() && args[0] == ' ')
+			args.erase(0, 1);
+
+		if (cmd == "CAPABILITY")
+		{
+			localSend("* CAPABILITY " + getCapabilityList() + "\r\n");
+			sendOK("CAPABILITY completed");
+		}
+		else if (cmd == "LOGIN")
+		{
+			localSend("* CAPABILITY " + getCapabilityList() + "\r\n");
+			sendOK("LOGIN completed");
+		}
+		else if (cmd == "NOOP" || cmd == "CHECK" || cmd == "ENABLE" ||
+		         cmd == "CLOSE" || cmd == "EXPUNGE" || cmd == "STORE")
+		{
+			sendOK(cmd + " completed");
+		}
+		else if (cmd == "COPY")
+		{
+			processCopy(args);
+		}
+		else if (cmd == "LOGOUT")
+		{
+			localSend("* BYE Logging out\r\n");
+			sendOK("LOGOUT completed");
+		}
+		else if (cmd == "LIST" || cmd == "LSUB")
+		{
+			processList(cmd, args);
+		}
+		else if (cmd == "SELECT" || cmd == "EXAMINE")
+		{
+			processSelect(cmd);
+		}
+		else if (cmd == "STATUS")
+		{
+			processStatus(args);
+		}
+		else if (cmd == "SEARCH")
+		{
+			std::ostringstream oss;
+			oss.imbue(std::locale::classic());
+			oss << "* SEARCH";
+
+			for (size_t i = 1 ; i <= getSimulator()->getMessageCount() ; ++i)
+				oss << " " << i;
+
+			oss << "\r\n";
+
+			localSend(oss.str());
+			sendOK("SEARCH completed");
+		}
+		else if (cmd == "FETCH")
+		{
+			processFetch(args, uid);
+		}
+		else if (cmd == "APPEND")
+		{
+			processAppend(args);
+		}
+		else
+		{
+			localSend(m_tag + " BAD Command not recognized\r\n");
+		}
+	}
+
+	void processRawData(const vmime::string& data)
+	{
+		getSimulator()->onMessageDelivered(data);
+		m_appending = true;
+	}
+
+	void sendFailure(const vmime::string& command)
+	{
+		localSend(m_tag + " NO [UNAVAILABLE] Simulated " + command + " failure\r\n");
+	}
+
+private:
+
+	void sendOK(const vmime::string& text)
+	{
+		localSend(m_tag + " OK " + text + "\r\n");
+	}
+
+	const vmime::string getCapabilityList() const
+	{
+		const std::vector <vmime::string> capa = getSimulator()->getCapabilities();
+
+		vmime::string list = "IMAP4rev1";
+
+		for (size_t i = 0 ; i < capa.size() ; ++i)
+			list += " " + capa[i];
+
+		return list;
+	}
+
+	void processSelect(const vmime::string& cmd)
+	{
+		const size_t count = getSimulator()->getMessageCount();
+
+		std::ostringstream oss;
+		oss.imbue(std::locale::classic());
+
+		oss << "* " << count << " EXISTS\r\n";
+		oss << "* 0 RECENT\r\n";
+		oss << "* OK [UIDVALIDITY 1] UIDs valid\r\n";
+		oss << "* OK [UIDNEXT " << (count + 1) << "] Predicted next UID\r\n";
+		oss << "* FLAGS (\\Answered \\Flagged \\Deleted \\Seen \\Draft)\r\n";
+		oss << "* OK [PERMANENTFLAGS (\\Answered \\Flagged \\Deleted \\Seen \\Draft)] Limited\r\n";
+
+		if (getSimulator()->hasCapability("CONDSTORE"))
+			oss << "* OK [HIGHESTMODSEQ " << (count + 1) << "] Highest\r\n";
+
+		if (cmd == "EXAMINE")
+			oss << m_tag << " OK [READ-ONLY] EXAMINE completed\r\n";
+		else
+			oss << m_tag << " OK [READ-WRITE] SELECT completed\r\n";
+
+		localSend(oss.str());
+	}
+
+	void processList(const vmime::string& cmd, const vmime::string& args)
+	{
+		std::istringstream iss(args);
+		iss.imbue(std::locale::classic());
+
+		vmime::string ref;
+		iss >> ref;
+
+		ref = unquote(ref);
+
+		if (ref.empty() && args == "\"\" \"\"")
+		{
+			// Hierarchy separator
+			localSend("* " + cmd + " (\\Noselect) \"/\" \"\"\r\n");
+			sendOK(cmd + " completed");
+			return;
+		}
+
+		// One pattern or a parenthesized list of patterns (LIST-EXTENDED),
+		// optionally followed by "RETURN (STATUS (items))" (LIST-STATUS)
+		vmime::string rest;
+		std::getline(iss, rest);
+
+		vmime::string statusItems;
+		const size_t ret = rest.find(" RETURN ");
+
+		if (ret != vmime::string::npos)
+		{
+			const size_t st = rest.find("STATUS (", ret);
+
+			if (st != vmime::string::npos)
+				statusItems = vmime::string(rest, st + 8, rest.find(')', st) - st - 8);
+
+			rest.erase(ret);
+		}
+
+		rest = vmime::utility::stringUtils::trim(rest);
+
+		if (!rest.empty() && rest[0] == '(')
+			rest = vmime::string(rest, 1, rest.length() - 2);
+
+		std::vector <vmime::string> patterns;
+		std::istringstream piss(rest);
+		vmime::string pattern;
+
+		while (piss >> pattern)
+			patterns.push_back(ref + unquote(pattern));
+
+		const std::vector <vmime::string>& folders = getSimulator()->getFolders();
+
+		std::ostringstream oss;
+		oss.imbue(std::locale::classic());
+
+		for (size_t i = 0 ; i < folders.size() ; ++i)
+		{
+			bool match = false;
+
+			for (size_t j = 0 ; !match && j < patterns.size() ; ++j)
+				match = matchPattern(patterns[j].c_str(), folders[i].c_str());
+
+			if (!match)
+				continue;
+
+			oss << "* " << cmd << " (\\HasNoChildren) \"/\" \"" << folders[i] << "\"\r\n";
+
+			if (!statusItems.empty() && getSimulator()->hasCapability("LIST-STATUS"))
+				oss << getStatusResponse(folders[i], statusItems);
+		}
+
+		oss << m_tag << " OK " << cmd << " completed\r\n";
+
+		localSend(oss.str());
+	}
+
+	void processStatus(const vmime::string& args)
+	{
+		const size_t lp = args.find('(');
+		const size_t rp = args.rfind(')');
+
+		if (lp == vmime::string::npos || rp == vmime::string::npos || rp < lp)
+		{
+			localSend(m_tag + " BAD Invalid arguments\r\n");
+			return;
+		}
+
+		const vmime::string mailbox = unquote(vmime::utility::stringUtils::trim
+			(vmime::string(args.begin(), args.begin() + lp)));
+
+		// Wildcards are not allowed here
+		if (mailbox.find_first_of("%*") != vmime::string::npos)
+		{
+			localSend(m_tag + " BAD Invalid mailbox name\r\n");
+			return;
+		}
+		else if (!getSimulator()->hasFolder(mailbox))
+		{
+			localSend(m_tag + " NO [NONEXISTENT] No such mailbox\r\n");
+			return;
+		}
+
+		localSend(getStatusResponse(mailbox, vmime::string(args.begin() + lp + 1, args.begin() + rp))
+			+ m_tag + " OK STATUS completed\r\n");
+	}
+
+	const vmime::string getStatusResponse(const vmime::string& mailbox, const vmime::string& items) const
+	{
+		const size_t count = getSimulator()->getMessageCount();
+
+		std::istringstream iss(items);
+		iss.imbue(std::locale::classic());
+
+		std::ostringstream oss;
+		oss.imbue(std::locale::classic());
+
+		oss << "* STATUS \"" << mailbox << "\" (";
+
+		vmime::string item;
+
+		for (bool first = true ; iss >> item ; first = false)
+		{
+			item = vmime::utility::stringUtils::toUpper(item);
+
+			if (!first)
+				oss << " ";
+
+			oss << item << " ";
+
+			if (item == "MESSAGES")
+				oss << count;
+			else if (item == "UIDNEXT")
+				oss << (count + 1);
+			else if (item == "UIDVALIDITY")
+				oss << 1;
+			else if (item == "HIGHESTMODSEQ")
+				oss << (count + 1);
+			else  // RECENT, UNSEEN
+				oss << 0;
+		}
+
+		oss << ")\r\n";
+
+		return oss.str();
+	}
+
+	static const vmime::string unquote(const vmime::string& str)
+	{
+		if (str.length() >= 2 && str[0] == '"' && str[str.length() - 1] == '"')
+			return vmime::string(str, 1, str.length() - 2);
+
+		return str;
+	}
+
+	/** Match a folder name against a LIST pattern: '*' matches any
+	  * characters, '%' matches any characters but the separator.
+	  */
+	static bool matchPattern(const char* pattern, const char* name)
+	{
+		if (*pattern == '\0')
+			return *name == '\0';
+
+		if (*pattern == '*' || *pattern == '%')
+		{
+			for (const char* p = name ; ; ++p)
+			{
+				if (matchPattern(pattern + 1, p))
+					return true;
+
+				if (*p == '\0' || (*pattern == '%' && *p == '/'))
+					return false;
+			}
+		}
+
+		return *pattern == *name && matchPattern(pattern + 1, name + 1);
+	}
+
+	void processAppend(const vmime::string& args)
+	{
+		const size_t lb = args.rfind('{');
+
+		if (lb == vmime::string::npos || args[args.length() - 1] != '}')
+		{
+			localSend(m_tag + " BAD Missing literal\r\n");
+			return;
+		}
+
+		std::istringstream iss(vmime::string(args.begin() + lb + 1, args.end() - 1));
+		iss.imbue(std::locale::classic());
+
+		size_t length = 0;
+		iss >> length;
+
+		// Synchronizing literal, unless LITERAL+ is used
+		if (args[args.length() - 2] != '+')
+			localSend("+ Ready for literal data\r\n");
+
+		expectRawData(length);
+	}
+
+	/** Parse an IMAP sequence set, and return the message numbers
+	  * it contains that exist in the mailbox.
+	  */
+	const std::vector <size_t> parseSequenceSet(const vmime::string& set) const
+	{
+		const size_t count = getSimulator()->getMessageCount();
+
+		std::vector <size_t> nums;
+		std::istringstream iss(set);
+		vmime::string range;
+
+		while (std::getline(iss, range, ','))
+		{
+			const size_t colon = range.find(':');
+
+			size_t first = parseSequenceNumber(vmime::string(range, 0, colon));
+			size_t last = (colon == vmime::string::npos)
+				? first : parseSequenceNumber(vmime::string(range, colon + 1));
+
+			if (first > last)
+				std::swap(first, last);
+
+			for (size_t i = first ; i <= last && i <= count ; ++i)
+				nums.push_back(i);
+		}
+
+		std::sort(nums.begin(), nums.end());
+		nums.erase(std::unique(nums.begin(), nums.end()), nums.end());
+
+		return nums;
+	}
+
+	size_t parseSequenceNumber(const vmime::string& str) const
+	{
+		if (str == "*")
+			return getSimulator()->getMessageCount();
+
+		std::istringstream iss(str);
+		iss.imbue(std::locale::classic());
+
+		size_t n = 0;
+		iss >> n;
+
+		return n;
+	}
+
+	/** Split a FETCH item list into items, keeping brackets,
+	  * parentheses and partial specifiers together.
+	  */
+	static const std::vector <vmime::string> splitFetchItems(const vmime::string& list)
+	{
+		std::vector <vmime::string> items;
+		vmime::string item;
+		int depth = 0;
+
+		for (size_t i = 0 ; i < list.length() ; ++i)
+		{
+			const char c = list[i];
+
+			if (c == '[' || c == '(' || c == '<')
+				++depth;
+			else if (c == ']' || c == ')' || c == '>')
+				--depth;
+
+			if (c == ' ' && depth == 0)
+			{
+				if (!item.empty())
+					items.push_back(item);
+
+				item.clear();
+			}
+			else
+			{
+				item += c;
+			}
+		}
+
+		if (!item.empty())
+			items.push_back(item);
+
+		return items;
+	}
+
+	void processCopy(const vmime::string& args)
+	{
+		const vmime::string set(args, 0, args.find(' '));
+
+		// Fail if the set addresses messages which do not exist
+		std::istringstream iss(set);
+		vmime::string range;
+
+		while (std::getline(iss, range, ','))
+		{
+			const size_t colon = range.find(':');
+
+			if (parseSequenceNumber(vmime::string(range, 0, colon)) > getSimulator()->getMessageCount() ||
+			    (colon != vmime::string::npos &&
+			     parseSequenceNumber(vmime::string(range, colon + 1)) > getSimulator()->getMessageCount()))
+			{
+				localSend(m_tag + " NO [NONEXISTENT] No such message\r\n");
+				return;
+			}
+		}
+
+		// Copied messages get the same UIDs in the destination folder
+		sendOK("[COPYUID 1 " + set + " " + set + "] COPY completed");
+	}
+
+	void processFetch(const vmime::string& args, const bool uid)
+	{
+		const size_t sp = args.find(' ');
+
+		if (sp == vmime::string::npos)
+		{
+			localSend(m_tag + " BAD Invalid arguments\r\n");
+			return;
+		}
+
+		const std::vector <size_t> nums = parseSequenceSet(vmime::string(args, 0, sp));
+
+		// Item list, either a single item or a parenthesized list
+		// (optionally followed by modifiers, which are ignored)
+		vmime::string list(args, sp + 1);
+
+		if (!list.empty() && list[0] == '(')
+		{
+			int depth = 0;
+			size_t end = 0;
+
+			for ( ; end < list.length() ; ++end)
+			{
+				if (list[end] == '(')
+					++depth;
+				else if (list[end] == ')' && --depth == 0)
+					break;
+			}
+
+			list = vmime::string(list, 1, end - 1);
+		}
+
+		std::vector <vmime::string> items = splitFetchItems(list);
+
+		if (uid && std::find(items.begin(), items.end(), "UID") == items.end())
+			items.push_back("UID");
+
+		for (size_t i = 0 ; i < nums.size() ; ++i)
+		{
+			std::ostringstream oss;
+			oss.imbue(std::locale::classic());
+
+			oss << "* " << nums[i] << " FETCH (";
+
+			for (size_t j = 0 ; j < items.size() ; ++j)
+			{
+				if (j != 0)
+					oss << " ";
+
+				writeFetchItem(oss, nums[i], items[j]);
+			}
+
+			oss << ")\r\n";
+
+			localSend(oss.str());
+		}
+
+		sendOK("FETCH completed");
+	}
+
+	void writeFetchItem(std::ostream& os, const size_t num, const vmime::string& item)
+	{
+		const vmime::string name = vmime::utility::stringUtils::toUpper(item);
+		const serverSimulator& sim = *getSimulator();
+
+		if (name == "UID")
+		{
+			os << "UID " << num;
+		}
+		else if (name == "FLAGS")
+		{
+			os << "FLAGS (\\Seen)";
+		}
+		else if (name == "MODSEQ")
+		{
+			os << "MODSEQ (" << num << ")";
+		}
+		else if (name == "RFC822.SIZE")
+		{
+			os << "RFC822.SIZE " << sim.getMessage(num).length();
+		}
+		else if (name == "INTERNALDATE")
+		{
+			os << "INTERNALDATE \"01-Jan-2024 10:00:00 +0000\"";
+		}
+		else if (name == "ENVELOPE")
+		{
+			os << "ENVELOPE (\"Mon, 01 Jan 2024 10:00:00 +0000\" \"Message " << num << "\" "
+			   << "((\"Sender\" NIL \"sender\" \"test.vmime.org\")) "
+			   << "((\"Sender\" NIL \"sender\" \"test.vmime.org\")) "
+			   << "((\"Sender\" NIL \"sender\" \"test.vmime.org\")) "
+			   << "((\"Recipient\" NIL \"recipient\" \"test.vmime.org\")) "
+			   << "NIL NIL NIL \"<" << num << "@test.vmime.org>\")";
+		}
+		else if (name == "BODYSTRUCTURE" || name == "BODY")
+		{
+			const vmime::string body = sim.getMessageBody(num);
+
+			os << name << " (\"text\" \"plain\" (\"charset\" \"us-ascii\") NIL NIL \"7bit\" "
+			   << body.length() << " " << std::count(body.begin(), body.end(), '\n') << ")";
+		}
+		else if (name == "RFC822" || name == "RFC822.HEADER" || name == "RFC822.TEXT")
+		{
+			vmime::string data;
+
+			if (name == "RFC822")
+				data = sim.getMessage(num);
+			else if (name == "RFC822.HEADER")
+				data = sim.getMessageHeader(num);
+			else
+				data = sim.getMessageBody(num);
+
+			os << name << " {" << data.length() << "}\r\n" << data;
+		}
+		else if (name.compare(0, 5, "BODY[") == 0 || name.compare(0, 10, "BODY.PEEK[") == 0)
+		{
+			const size_t lb = item.find('[');
+			const size_t rb = item.find(']');
+
+			const vmime::string section(item.begin() + lb + 1, item.begin() + rb);
+			vmime::string data = getSection(num, section);
+
+			// Partial fetch: "<origin.length>"
+			vmime::string partial;
+
+			if (rb + 1 < item.length() && item[rb + 1] == '<')
+			{
+				std::istringstream iss(vmime::string(item, rb + 2));
+				iss.imbue(std::locale::classic());
+
+				size_t origin = 0, length = 0;
+				char dot = 0;
+
+				iss >> origin >> dot >> length;
+
+				data = (origin < data.length()) ? vmime::string(data, origin, length) : "";
+
+				std::ostringstream poss;
+				poss.imbue(std::locale::classic());
+				poss << "<" << origin << ">";
+
+				partial = poss.str();
+			}
+
+			os << "BODY[" << section << "]" << partial << " {" << data.length() << "}\r\n" << data;
+		}
+		else
+		{
+			os << name << " NIL";
+		}
+	}
+
+	const vmime::string getSection(const size_t num, const vmime::string& section) const
+	{
+		const serverSimulator& sim = *getSimulator();
+		const vmime::string name = vmime::utility::stringUtils::toUpper(section);
+
+		if (name.empty())
+			return sim.getMessage(num);
+		else if (name == "HEADER" || name == "MIME" || name == "1.MIME")
+			return sim.getMessageHeader(num);
+		else if (name == "TEXT" || name == "1")
+			return sim.getMessageBody(num);
+		else if (name.compare(0, 13, "HEADER.FIELDS") == 0)
+		{
+			const bool exclude = (name.compare(0, 17, "HEADER.FIELDS.NOT") == 0);
+
+			// Field names between parentheses
+			const size_t lp = name.find('(');
+			const size_t rp = name.find(')');
+
+			std::set <vmime::string> fields;
+
+			if (lp != vmime::string::npos && rp != vmime::string::npos)
+			{
+				std::istringstream iss(vmime::string(name.begin() + lp + 1, name.begin() + rp));
+				vmime::string field;
+
+				while (iss >> field)
+					fields.insert(field);
+			}
+
+			// Filter header lines (synthetic headers are never folded)
+			std::istringstream iss(sim.getMessageHeader(num));
+			vmime::string line, result;
+
+			while (std::getline(iss, line))
+			{
+				const size_t colon = line.find(':');
+
+				if (colon == vmime::string::npos)
+					continue;
+
+				const vmime::string field =
+					vmime::utility::stringUtils::toUpper(vmime::string(line, 0, colon));
+
+				if ((fields.find(field) != fields.end()) != exclude)
+					result += line + "\n";
+			}
+
+			return result + "\r\n";
+		}
+
+		return "";
+	}
+
+
+	vmime::string m_tag;
+	bool m_appending;
+};
+
+
+#endif // VMIME_TESTS_NET_IMAP_IMAPSERVERSIMULATOR_HPP_INCLUDED
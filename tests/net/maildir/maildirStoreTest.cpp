@@ -27,6 +27,9 @@
 
 #include "vmime/net/maildir/maildirStore.hpp"
 #include "vmime/net/maildir/maildirFormat.hpp"
+#include "vmime/net/maildir/maildirUtils.hpp"
+
+#include "vmime/utility/inputStreamStringAdapter.hpp"
 
 
 // Shortcuts and helpers
@@ -153,6 +156,11 @@ VMIME_TEST_SUITE_BEGIN(maildirStoreTest)
 		VMIME_TEST(testListMessages_KMail)
 		VMIME_TEST(testListMessages_Courier)
 
+		VMIME_TEST(testFetchHeader_KMail)
+		VMIME_TEST(testFetchHeader_Courier)
+		VMIME_TEST(testFetchHeaderFields)
+		VMIME_TEST(testFindHeaderFieldsEnd)
+
 		VMIME_TEST(testRenameFolder_KMail)
 		VMIME_TEST(testRenameFolder_Courier)
 
@@ -316,6 +324,116 @@ public:
 	}
 
 
+	void testFetchHeader_KMail()
+	{
+		testFetchHeaderImpl(TEST_MAILDIR_KMAIL, TEST_MAILDIRFILES_KMAIL);
+	}
+
+	void testFetchHeader_Courier()
+	{
+		testFetchHeaderImpl(TEST_MAILDIR_COURIER, TEST_MAILDIRFILES_COURIER);
+	}
+
+	void testFetchHeaderImpl(const vmime::string* const dirs, const vmime::string* const files)
+	{
+		createMaildir(dirs, files);
+
+		vmime::shared_ptr <vmime::net::store> store = createAndConnectStore();
+
+		vmime::shared_ptr <vmime::net::folder> folder = store->getFolder
+			(fpath() / "Folder" / "SubFolder" / "SubSubFolder2");
+
+		folder->open(vmime::net::folder::MODE_READ_ONLY);
+
+		vmime::shared_ptr <vmime::net::message> msg = folder->getMessage(1);
+
+		folder->fetchMessage(msg, vmime::net::fetchAttributes::FULL_HEADER);
+
+		vmime::shared_ptr <const vmime::header> hdr = msg->getHeader();
+
+		VASSERT_EQ("Header field count", 3, hdr->getFieldCount());
+		VASSERT_EQ("Subject", "VMime Test",
+			hdr->Subject()->getValue <vmime::text>()->getWholeBuffer());
+
+		vmime::shared_ptr <vmime::message> parsedMsg = msg->getParsedMessage();
+
+		std::ostringstream oss;
+		vmime::utility::outputStreamAdapter os(oss);
+		parsedMsg->getBody()->getContents()->extract(os);
+
+		VASSERT_EQ("Body contents", "Hello, world!", oss.str());
+
+		folder->close(false);
+
+		destroyMaildir();
+	}
+
+
+	void testFetchHeaderFields()
+	{
+		createMaildir(TEST_MAILDIR_KMAIL, TEST_MAILDIRFILES_KMAIL);
+
+		vmime::shared_ptr <vmime::net::store> store = createAndConnectStore();
+
+		vmime::shared_ptr <vmime::net::folder> folder = store->getFolder
+			(fpath() / "Folder" / "SubFolder" / "SubSubFolder2");
+
+		folder->open(vmime::net::folder::MODE_READ_ONLY);
+
+		vmime::shared_ptr <vmime::net::message> msg = folder->getMessage(1);
+
+		vmime::net::fetchAttributes attribs;
+		attribs.add("subject");
+
+		folder->fetchMessage(msg, attribs);
+
+		// Only the requested field is parsed
+		vmime::shared_ptr <const vmime::header> hdr = msg->getHeader();
+
+		VASSERT_EQ("Header field count", 1, hdr->getFieldCount());
+		VASSERT_EQ("Subject", "VMime Test",
+			hdr->Subject()->getValue <vmime::text>()->getWholeBuffer());
+
+		folder->close(false);
+
+		destroyMaildir();
+	}
+
+
+	static size_t findHeaderFieldsEnd(const vmime::string& data, const vmime::string& fields)
+	{
+		std::vector <vmime::string> list;
+		std::istringstream iss(fields);
+
+		for (vmime::string field ; std::getline(iss, field, ',') ; )
+			list.push_back(field);
+
+		vmime::utility::inputStreamStringAdapter is(data);
+
+		return vmime::net::maildir::maildirUtils::findHeaderFieldsEnd(is, list);
+	}
+
+	void testFindHeaderFieldsEnd()
+	{
+		const vmime::string hdr =
+			"Received: from a\r\n"
+			"\tby b\r\n"
+			"Received: from c\r\n"
+			"Subject: Test\r\n"
+			"From: me@vmime.org\r\n"
+			"Received: from d\r\n"
+			"\r\n"
+			"Body\r\n";
+
+		// Requested fields may appear anywhere: the whole header is read
+		VASSERT_EQ("1", hdr.find("Body"), findHeaderFieldsEnd(hdr, "subject"));
+		VASSERT_EQ("2", hdr.find("Body"), findHeaderFieldsEnd(hdr, "received,subject"));
+		VASSERT_EQ("3", hdr.find("Body"), findHeaderFieldsEnd(hdr, "received"));
+		VASSERT_EQ("4", hdr.find("Body"), findHeaderFieldsEnd(hdr, "received,from"));
+		VASSERT_EQ("5", hdr.find("Body"), findHeaderFieldsEnd(hdr, "to"));
+	}
+
+
 	void testRenameFolder_KMail()
 	{
 		try
@@ -0,0 +1,217 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/net/messageRegistry.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(messageRegistryTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testAdd)
+		VMIME_TEST(testFind)
+		VMIME_TEST(testRemove)
+		VMIME_TEST(testExpunge)
+		VMIME_TEST(testExpunge_Many)
+		VMIME_TEST(testAddAfterExpunge)
+		VMIME_TEST(testClear)
+	VMIME_TEST_LIST_END
+
+
+	struct msg
+	{
+		int id;
+	};
+
+
+	void testAdd()
+	{
+		vmime::net::messageRegistry <msg> reg;
+		msg m1, m2, m3;
+
+		const size_t s5 = reg.add(&m1, 5);
+		const size_t s2 = reg.add(&m2, 2);
+		const size_t s0 = reg.add(&m3, 0);
+
+		VASSERT_EQ("1", 5, reg.getNumber(s5));
+		VASSERT_EQ("2", 2, reg.getNumber(s2));
+		VASSERT_EQ("3", 0, reg.getNumber(s0));
+		VASSERT_EQ("4", 3, reg.getMessageCount());
+	}
+
+	void testFind()
+	{
+		vmime::net::messageRegistry <msg> reg;
+		msg m1, m2, m3;
+
+		reg.add(&m1, 3);
+		reg.add(&m2, 3);
+		reg.add(&m3, 4);
+
+		std::vector <msg*> res;
+		reg.find(3, res);
+
+		VASSERT_EQ("1", 2, res.size());
+
+		res.clear();
+		reg.find(4, res);
+
+		VASSERT_EQ("2", 1, res.size());
+		VASSERT("3", res[0] == &m3);
+
+		res.clear();
+		reg.find(1, res);
+		reg.find(10, res);
+
+		VASSERT_EQ("4", 0, res.size());
+	}
+
+	void testRemove()
+	{
+		vmime::net::messageRegistry <msg> reg;
+		msg m1, m2;
+
+		const size_t s1 = reg.add(&m1, 3);
+		reg.add(&m2, 3);
+
+		reg.remove(&m1, s1);
+
+		std::vector <msg*> res;
+		reg.find(3, res);
+
+		VASSERT_EQ("1", 1, res.size());
+		VASSERT("2", res[0] == &m2);
+		VASSERT_EQ("3", 1, reg.getMessageCount());
+	}
+
+	void testExpunge()
+	{
+		vmime::net::messageRegistry <msg> reg;
+		msg m1, m2, m3;
+
+		const size_t s1 = reg.add(&m1, 1);
+		const size_t s2 = reg.add(&m2, 2);
+		const size_t s3 = reg.add(&m3, 3);
+
+		std::vector <msg*> res;
+		reg.expunge(2, res);
+
+		VASSERT_EQ("1", 1, res.size());
+		VASSERT("2", res[0] == &m2);
+
+		VASSERT_EQ("3", 1, reg.getNumber(s1));
+		VASSERT_EQ("4", 0, reg.getNumber(s2));
+		VASSERT_EQ("5", 2, reg.getNumber(s3));
+		VASSERT_EQ("6", 2, reg.getMessageCount());
+
+		// Nothing registered at or after this number
+		res.clear();
+		reg.expunge(10, res);
+
+		VASSERT_EQ("7", 0, res.size());
+		VASSERT_EQ("8", 2, reg.getNumber(s3));
+	}
+
+	void testExpunge_Many()
+	{
+		vmime::net::messageRegistry <msg> reg;
+
+		const size_t count = 1000;
+
+		std::vector <msg> msgs(count);
+		std::vector <size_t> slots(count);
+
+		for (size_t i = 0 ; i < count ; ++i)
+		{
+			msgs[i].id = static_cast <int>(i + 1);
+			slots[i] = reg.add(&msgs[i], i + 1);
+		}
+
+		// Expunge all messages with an even number, as an IMAP server
+		// would report them (numbers shift after each expunge)
+		for (size_t i = 2, expunged = 0 ; i <= count ; i += 2, ++expunged)
+		{
+			std::vector <msg*> res;
+			reg.expunge(i - expunged, res);
+
+			VASSERT_EQ("1", 1, res.size());
+			VASSERT_EQ("2", static_cast <int>(i), res[0]->id);
+		}
+
+		for (size_t i = 0 ; i < count ; ++i)
+		{
+			if ((i + 1) % 2 == 0)
+				VASSERT_EQ("3", 0, reg.getNumber(slots[i]));
+			else
+				VASSERT_EQ("4", i / 2 + 1, reg.getNumber(slots[i]));
+		}
+
+		VASSERT_EQ("5", count / 2, reg.getMessageCount());
+	}
+
+	void testAddAfterExpunge()
+	{
+		vmime::net::messageRegistry <msg> reg;
+		msg m1, m2, m3, m4;
+
+		reg.add(&m1, 1);
+		const size_t s3 = reg.add(&m2, 3);
+
+		std::vector <msg*> res;
+		reg.expunge(2, res);
+
+		// Numbers are those of the current state of the folder
+		const size_t s2 = reg.add(&m3, 2);
+		const size_t s5 = reg.add(&m4, 5);
+
+		VASSERT("1", s2 == s3);
+		VASSERT_EQ("2", 2, reg.getNumber(s3));
+		VASSERT_EQ("3", 5, reg.getNumber(s5));
+
+		res.clear();
+		reg.find(2, res);
+
+		VASSERT_EQ("4", 2, res.size());
+	}
+
+	void testClear()
+	{
+		vmime::net::messageRegistry <msg> reg;
+		msg m1;
+
+		reg.add(&m1, 3);
+
+		std::vector <msg*> res;
+		reg.expunge(1, res);
+
+		reg.clear();
+
+		VASSERT_EQ("1", 0, reg.getMessageCount());
+
+		const size_t s = reg.add(&m1, 3);
+
+		VASSERT_EQ("2", 3, reg.getNumber(s));
+	}
+
+VMIME_TEST_SUITE_END
@@ -131,6 +131,10 @@ VMIME_TEST_SUITE_BEGIN(messageSetTest)
 		numbers.push_back(99);
 
 		VASSERT_EQ("str", "1:3,42,53:57,89,99", enumerateAsString(vmime::net::messageSet::byNumber(numbers)));
+
+		numbers.push_back(0);
+
+		VASSERT_THROW("invalid", vmime::net::messageSet::byNumber(numbers), std::invalid_argument);
 	}
 
 
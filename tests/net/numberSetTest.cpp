@@ -0,0 +1,222 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/net/numberSet.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(numberSetTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testAdd)
+		VMIME_TEST(testAdd_Merge)
+		VMIME_TEST(testRemove)
+		VMIME_TEST(testContains)
+		VMIME_TEST(testUnion)
+		VMIME_TEST(testIntersection)
+		VMIME_TEST(testDifference)
+		VMIME_TEST(testIterate)
+		VMIME_TEST(testSequenceSet)
+		VMIME_TEST(testSequenceSet_Invalid)
+		VMIME_TEST(testLimits)
+		VMIME_TEST(testLargeSet)
+	VMIME_TEST_LIST_END
+
+
+	static vmime::net::numberSet set(const char* str)
+	{
+		return vmime::net::numberSet::fromSequenceSet(str);
+	}
+
+
+	void testAdd()
+	{
+		vmime::net::numberSet s;
+
+		VASSERT_TRUE("1", s.isEmpty());
+
+		s.add(5);
+		s.add(1, 3);
+		s.add(10);
+
+		VASSERT_EQ("2", "1:3,5,10", s.toSequenceSet());
+		VASSERT_EQ("3", 5, s.getCount());
+		VASSERT_EQ("4", 3, s.getRangeCount());
+	}
+
+	void testAdd_Merge()
+	{
+		vmime::net::numberSet s = set("1:3,5,10:12,20");
+
+		s.add(4);
+		VASSERT_EQ("1", "1:5,10:12,20", s.toSequenceSet());
+
+		s.add(6, 19);
+		VASSERT_EQ("2", "1:20", s.toSequenceSet());
+
+		s.add(2, 8);
+		VASSERT_EQ("3", "1:20", s.toSequenceSet());
+
+		s.add(22);
+		s.add(21);
+		VASSERT_EQ("4", "1:22", s.toSequenceSet());
+	}
+
+	void testRemove()
+	{
+		vmime::net::numberSet s = set("1:10,15:20");
+
+		s.remove(5);
+		VASSERT_EQ("1", "1:4,6:10,15:20", s.toSequenceSet());
+
+		s.remove(1);
+		s.remove(20);
+		VASSERT_EQ("2", "2:4,6:10,15:19", s.toSequenceSet());
+
+		s.remove(8, 16);
+		VASSERT_EQ("3", "2:4,6:7,17:19", s.toSequenceSet());
+
+		s.remove(1, 100);
+		VASSERT_TRUE("4", s.isEmpty());
+	}
+
+	void testContains()
+	{
+		const vmime::net::numberSet s = set("2:4,8,10:12");
+
+		VASSERT_FALSE("1", s.contains(1));
+		VASSERT_TRUE("2", s.contains(2));
+		VASSERT_TRUE("3", s.contains(4));
+		VASSERT_FALSE("4", s.contains(5));
+		VASSERT_TRUE("5", s.contains(8));
+		VASSERT_TRUE("6", s.contains(11));
+		VASSERT_FALSE("7", s.contains(13));
+	}
+
+	void testUnion()
+	{
+		vmime::net::numberSet s = set("1:3,10:12,20");
+		s.unionWith(set("4,8:11,15,21:25"));
+
+		VASSERT_EQ("1", "1:4,8:12,15,20:25", s.toSequenceSet());
+
+		s.unionWith(vmime::net::numberSet());
+
+		VASSERT_EQ("2", "1:4,8:12,15,20:25", s.toSequenceSet());
+	}
+
+	void testIntersection()
+	{
+		vmime::net::numberSet s = set("1:10,15:20,30");
+		s.intersectWith(set("5:16,18,25:35"));
+
+		VASSERT_EQ("1", "5:10,15:16,18,30", s.toSequenceSet());
+
+		s.intersectWith(vmime::net::numberSet());
+
+		VASSERT_TRUE("2", s.isEmpty());
+	}
+
+	void testDifference()
+	{
+		vmime::net::numberSet s = set("1:10,15:20,30");
+		s.subtract(set("3,5:6,9:16,25:40"));
+
+		VASSERT_EQ("1", "1:2,4,7:8,17:20", s.toSequenceSet());
+	}
+
+	void testIterate()
+	{
+		const vmime::net::numberSet s = set("1:3,7,9:10");
+
+		std::ostringstream oss;
+
+		for (vmime::net::numberSet::const_iterator it = s.begin() ; it != s.end() ; ++it)
+			oss << *it << " ";
+
+		VASSERT_EQ("1", "1 2 3 7 9 10 ", oss.str());
+
+		const vmime::net::numberSet empty;
+
+		VASSERT("2", empty.begin() == empty.end());
+	}
+
+	void testSequenceSet()
+	{
+		VASSERT_EQ("1", "", set("").toSequenceSet());
+		VASSERT_EQ("2", "42", set("42").toSequenceSet());
+		VASSERT_EQ("3", "1:5,7", set("5:1,7").toSequenceSet());
+		VASSERT_EQ("4", "1:5", set("1,2,3,4,5").toSequenceSet());
+		VASSERT_EQ("5", "1:10", set("5:10,1:4,3").toSequenceSet());
+	}
+
+	void testSequenceSet_Invalid()
+	{
+		VASSERT_THROW("1", set("1:*"), std::invalid_argument);
+		VASSERT_THROW("2", set("1,"), std::invalid_argument);
+		VASSERT_THROW("3", set(",1"), std::invalid_argument);
+		VASSERT_THROW("4", set("1:2:3"), std::invalid_argument);
+		VASSERT_THROW("5", set("1 2"), std::invalid_argument);
+		VASSERT_THROW("6", set("4294967296"), std::invalid_argument);
+	}
+
+	void testLimits()
+	{
+		vmime::net::numberSet s;
+
+		s.add(4294967295U);
+		s.add(0);
+		s.add(4294967294U);
+
+		VASSERT_EQ("1", "0,4294967294:4294967295", s.toSequenceSet());
+
+		s.add(0, 4294967295U);
+
+		VASSERT_EQ("2", "0:4294967295", s.toSequenceSet());
+		VASSERT_EQ("3", 4294967296ULL, s.getCount());
+
+		s.remove(0);
+		s.remove(4294967295U);
+
+		VASSERT_EQ("4", "1:4294967294", s.toSequenceSet());
+	}
+
+	void testLargeSet()
+	{
+		vmime::net::numberSet s;
+
+		for (vmime_uint32 i = 1 ; i <= 1000000 ; ++i)
+			s.add(i);
+
+		VASSERT_EQ("1", 1, s.getRangeCount());
+		VASSERT_EQ("2", 1000000, s.getCount());
+
+		for (vmime_uint32 i = 2 ; i <= 1000000 ; i += 2)
+			s.remove(i);
+
+		VASSERT_EQ("3", 500000, s.getRangeCount());
+		VASSERT_EQ("4", 500000, s.getCount());
+	}
+
+VMIME_TEST_SUITE_END
@@ -0,0 +1,221 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "tests/net/pop3/POP3TestUtils.hpp"
+
+#include "vmime/net/pop3/POP3CommandPipeline.hpp"
+#include "vmime/net/pop3/POP3Response.hpp"
+
+
+using namespace vmime::net::pop3;
+
+
+// Counts the number of write operations on the socket
+class sendCountingTestSocket : public testSocket
+{
+public:
+
+	sendCountingTestSocket()
+		: m_sendCount(0)
+	{
+	}
+
+	void send(const vmime::string& buffer)
+	{
+		++m_sendCount;
+		testSocket::send(buffer);
+	}
+
+	unsigned int getSendCount() const
+	{
+		return m_sendCount;
+	}
+
+private:
+
+	unsigned int m_sendCount;
+};
+
+
+// Records the text of the responses
+class testResponseHandler : public POP3CommandPipeline::responseHandler
+{
+public:
+
+	void handleResponse(vmime::shared_ptr <POP3Connection> conn)
+	{
+		vmime::shared_ptr <POP3Response> resp = POP3Response::readResponse(conn);
+
+		if (!resp->isSuccess())
+			throw vmime::exceptions::command_error("TEST", resp->getFirstLine());
+
+		texts.push_back(resp->getText());
+	}
+
+	std::vector <vmime::string> texts;
+};
+
+
+VMIME_TEST_SUITE_BEGIN(POP3CommandPipelineTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testPipelining)
+		VMIME_TEST(testNoPipelining)
+		VMIME_TEST(testWindowSize)
+		VMIME_TEST(testErrorResponse)
+	VMIME_TEST_LIST_END
+
+
+	void testPipelining()
+	{
+		vmime::shared_ptr <sendCountingTestSocket> sok = vmime::make_shared <sendCountingTestSocket>();
+		vmime::shared_ptr <POP3ConnectionTest> conn = vmime::make_shared <POP3ConnectionTest>
+			(vmime::dynamicCast <vmime::net::socket>(sok),
+			 vmime::shared_ptr <vmime::net::timeoutHandler>());
+
+		sok->localSend("+OK 1\r\n+OK 2\r\n+OK 3\r\n");
+
+		testResponseHandler handler;
+
+		vmime::shared_ptr <POP3CommandPipeline> pipeline =
+			POP3CommandPipeline::create(conn, /* pipeline */ true);
+
+		pipeline->addCommand(POP3Command::DELE(1), &handler);
+		pipeline->addCommand(POP3Command::DELE(2), &handler);
+		pipeline->addCommand(POP3Command::DELE(3), &handler);
+
+		VASSERT_EQ("Command count", 3, pipeline->getCommandCount());
+
+		pipeline->execute();
+
+		vmime::string sent;
+		sok->localReceive(sent);
+
+		VASSERT_EQ("Sent buffer", "DELE 1\r\nDELE 2\r\nDELE 3\r\n", sent);
+		VASSERT_EQ("Send count", 1, sok->getSendCount());
+
+		VASSERT_EQ("Response count", 3, handler.texts.size());
+		VASSERT_EQ("Response 1", "1", handler.texts[0]);
+		VASSERT_EQ("Response 2", "2", handler.texts[1]);
+		VASSERT_EQ("Response 3", "3", handler.texts[2]);
+
+		VASSERT_EQ("Command count after execute", 0, pipeline->getCommandCount());
+	}
+
+	void testNoPipelining()
+	{
+		vmime::shared_ptr <sendCountingTestSocket> sok = vmime::make_shared <sendCountingTestSocket>();
+		vmime::shared_ptr <POP3ConnectionTest> conn = vmime::make_shared <POP3ConnectionTest>
+			(vmime::dynamicCast <vmime::net::socket>(sok),
+			 vmime::shared_ptr <vmime::net::timeoutHandler>());
+
+		sok->localSend("+OK 1\r\n+OK 2\r\n+OK 3\r\n");
+
+		testResponseHandler handler;
+
+		vmime::shared_ptr <POP3CommandPipeline> pipeline =
+			POP3CommandPipeline::create(conn, /* pipeline */ false);
+
+		pipeline->addCommand(POP3Command::DELE(1), &handler);
+		pipeline->addCommand(POP3Command::DELE(2), &handler);
+		pipeline->addCommand(POP3Command::DELE(3), &handler);
+
+		pipeline->execute();
+
+		vmime::string sent;
+		sok->localReceive(sent);
+
+		VASSERT_EQ("Sent buffer", "DELE 1\r\nDELE 2\r\nDELE 3\r\n", sent);
+		VASSERT_EQ("Send count", 3, sok->getSendCount());
+		VASSERT_EQ("Response count", 3, handler.texts.size());
+	}
+
+	void testWindowSize()
+	{
+		vmime::shared_ptr <sendCountingTestSocket> sok = vmime::make_shared <sendCountingTestSocket>();
+		vmime::shared_ptr <POP3ConnectionTest> conn = vmime::make_shared <POP3ConnectionTest>
+			(vmime::dynamicCast <vmime::net::socket>(sok),
+			 vmime::shared_ptr <vmime::net::timeoutHandler>());
+
+		std::ostringstream responses, commands;
+
+		for (unsigned int i = 1 ; i <= 10 ; ++i)
+		{
+			responses << "+OK " << i << "\r\n";
+			commands << "DELE " << i << "\r\n";
+		}
+
+		sok->localSend(responses.str());
+
+		testResponseHandler handler;
+
+		vmime::shared_ptr <POP3CommandPipeline> pipeline =
+			POP3CommandPipeline::create(conn, /* pipeline */ true, /* windowSize */ 4);
+
+		for (unsigned int i = 1 ; i <= 10 ; ++i)
+			pipeline->addCommand(POP3Command::DELE(i), &handler);
+
+		pipeline->execute();
+
+		vmime::string sent;
+		sok->localReceive(sent);
+
+		VASSERT_EQ("Sent buffer", commands.str(), sent);
+		// 4 commands, then 2 more each time 2 responses have been read
+		VASSERT_EQ("Send count", 4, sok->getSendCount());
+		VASSERT_EQ("Response count", 10, handler.texts.size());
+		VASSERT_EQ("Last response", "10", handler.texts[9]);
+	}
+
+	void testErrorResponse()
+	{
+		vmime::shared_ptr <testSocket> sok = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <POP3ConnectionTest> conn = vmime::make_shared <POP3ConnectionTest>
+			(vmime::dynamicCast <vmime::net::socket>(sok),
+			 vmime::shared_ptr <vmime::net::timeoutHandler>());
+
+		sok->localSend("+OK 1\r\n-ERR 2\r\n+OK 3\r\n+OK Next\r\n");
+
+		testResponseHandler handler;
+
+		vmime::shared_ptr <POP3CommandPipeline> pipeline =
+			POP3CommandPipeline::create(conn, /* pipeline */ true);
+
+		pipeline->addCommand(POP3Command::DELE(1), &handler);
+		pipeline->addCommand(POP3Command::DELE(2), &handler);
+		pipeline->addCommand(POP3Command::DELE(3), &handler);
+
+		VASSERT_THROW("Error", pipeline->execute(), vmime::exceptions::command_error);
+
+		// Remaining responses have been read anyway
+		VASSERT_EQ("Response count", 2, handler.texts.size());
+		VASSERT_EQ("Response 3", "3", handler.texts[1]);
+
+		vmime::shared_ptr <POP3Response> resp = POP3Response::readResponse(conn);
+
+		VASSERT_EQ("Next response", "Next", resp->getText());
+	}
+
+VMIME_TEST_SUITE_END
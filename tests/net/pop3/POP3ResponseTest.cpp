@@ -42,6 +42,8 @@ VMIME_TEST_SUITE_BEGIN(POP3ResponseTest)
 		VMIME_TEST(testMultiLineResponse)
 		VMIME_TEST(testMultiLineResponseLF)
 		VMIME_TEST(testLargeResponse)
+		VMIME_TEST(testLargeResponseDotStuffing)
+		VMIME_TEST(testPipelinedResponses)
 	VMIME_TEST_LIST_END
 
 
@@ -226,5 +228,75 @@ VMIME_TEST_SUITE_BEGIN(POP3ResponseTest)
 		VASSERT_EQ("Data Bytes", data.str(), receivedData);
 	}
 
+	void testLargeResponseDotStuffing()
+	{
+		vmime::shared_ptr <testSocket> socket = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::timeoutHandler> toh = vmime::make_shared <testTimeoutHandler>();
+
+		vmime::shared_ptr <POP3ConnectionTest> conn = vmime::make_shared <POP3ConnectionTest>
+			(vmime::dynamicCast <vmime::net::socket>(socket), toh);
+
+		socket->localSend("+OK Large Response Follows\r\n");
+		socket->localSend("..Line 1\r\nLine 2\r\n...\r\n.\r\n");
+
+		vmime::string receivedData;
+		vmime::utility::outputStreamStringAdapter receivedDataStream(receivedData);
+
+		vmime::shared_ptr <POP3Response> resp =
+			POP3Response::readLargeResponse(conn, receivedDataStream, NULL, 0);
+
+		VASSERT_TRUE("Success", resp->isSuccess());
+		VASSERT_EQ("Data", ".Line 1\r\nLine 2\r\n..", receivedData);
+	}
+
+	void testPipelinedResponses()
+	{
+		vmime::shared_ptr <testSocket> socket = vmime::make_shared <testSocket>();
+		vmime::shared_ptr <vmime::net::timeoutHandler> toh = vmime::make_shared <testTimeoutHandler>();
+
+		vmime::shared_ptr <POP3ConnectionTest> conn = vmime::make_shared <POP3ConnectionTest>
+			(vmime::dynamicCast <vmime::net::socket>(socket), toh);
+
+		// All responses are received at once
+		socket->localSend
+		(
+			"+OK Response 1\r\n"
+			"+OK Response 2\r\nLine 1\r\nLine 2\r\n.\r\n"
+			"+OK Response 3\r\nData\r\n.\r\n"
+			"-ERR Response 4\r\n"
+		);
+
+		vmime::shared_ptr <POP3Response> resp1 =
+			POP3Response::readResponse(conn);
+
+		VASSERT_TRUE("1: Success", resp1->isSuccess());
+		VASSERT_EQ("1: Text", "Response 1", resp1->getText());
+
+		vmime::shared_ptr <POP3Response> resp2 =
+			POP3Response::readMultilineResponse(conn);
+
+		VASSERT_TRUE("2: Success", resp2->isSuccess());
+		VASSERT_EQ("2: Text", "Response 2", resp2->getText());
+		VASSERT_EQ("2: Lines", 2, resp2->getLineCount());
+		VASSERT_EQ("2: Line 1", "Line 1", resp2->getLineAt(0));
+		VASSERT_EQ("2: Line 2", "Line 2", resp2->getLineAt(1));
+
+		vmime::string receivedData;
+		vmime::utility::outputStreamStringAdapter receivedDataStream(receivedData);
+
+		vmime::shared_ptr <POP3Response> resp3 =
+			POP3Response::readLargeResponse(conn, receivedDataStream, NULL, 0);
+
+		VASSERT_TRUE("3: Success", resp3->isSuccess());
+		VASSERT_EQ("3: Data", "Data", receivedData);
+
+		vmime::shared_ptr <POP3Response> resp4 =
+			POP3Response::readMultilineResponse(conn);
+
+		VASSERT_FALSE("4: Success", resp4->isSuccess());
+		VASSERT_EQ("4: Text", "Response 4", resp4->getText());
+		VASSERT_EQ("4: Lines", 0, resp4->getLineCount());
+	}
+
 VMIME_TEST_SUITE_END
 
@@ -0,0 +1,249 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_TESTS_NET_POP3_POP3SERVERSIMULATOR_HPP_INCLUDED
+#define VMIME_TESTS_NET_POP3_POP3SERVERSIMULATOR_HPP_INCLUDED
+
+
+#include "tests/net/serverSimulator.hpp"
+
+#include "vmime/utility/stringUtils.hpp"
+
+
+/** Simulated POP3 server.
+  *
+  * Serves the synthetic messages of the simulator. USER, TOP and UIDL
+  * are always advertised in response to CAPA, in addition to the
+  * capabilities listed in the simulator (eg. PIPELINING). Any user
+  * name and password are accepted.
+  */
+class POP3ServerSimulatorSocket : public serverSimulatorSocket
+{
+public:
+
+	POP3ServerSimulatorSocket(vmime::shared_ptr <serverSimulator> sim)
+		: serverSimulatorSocket(sim)
+	{
+	}
+
+protected:
+
+	void sendGreeting()
+	{
+		localSend("+OK test.vmime.org POP3 server simulator ready <1.1@test.vmime.org>\r\n");
+	}
+
+	void processLine(const vmime::string& line)
+	{
+		std::istringstream iss(line);
+		iss.imbue(std::locale::classic());
+
+		vmime::string cmd;
+		iss >> cmd;
+
+		cmd = vmime::utility::stringUtils::toUpper(cmd);
+
+		if (!checkCommand(cmd))
+			return;
+
+		const serverSimulator& sim = *getSimulator();
+		const size_t count = sim.getMessageCount();
+
+		size_t num = 0;
+		const bool hasNum = static_cast <bool>(iss >> num);
+
+		if (hasNum && (num < 1 || num > count || m_deleted.count(num)))
+		{
+			localSend("-ERR No such message\r\n");
+			return;
+		}
+
+		if (cmd == "CAPA")
+		{
+			const std::vector <vmime::string> capa = sim.getCapabilities();
+
+			vmime::string resp = "+OK Capability list follows\r\nUSER\r\nTOP\r\nUIDL\r\n";
+
+			for (size_t i = 0 ; i < capa.size() ; ++i)
+				resp += capa[i] + "\r\n";
+
+			localSend(resp + ".\r\n");
+		}
+		else if (cmd == "USER" || cmd == "PASS" || cmd == "APOP" || cmd == "NOOP")
+		{
+			localSend("+OK\r\n");
+		}
+		else if (cmd == "STAT")
+		{
+			size_t total = 0, n = 0;
+
+			for (size_t i = 1 ; i <= count ; ++i)
+			{
+				if (!m_deleted.count(i))
+				{
+					total += sim.getMessage(i).length();
+					++n;
+				}
+			}
+
+			std::ostringstream oss;
+			oss.imbue(std::locale::classic());
+			oss << "+OK " << n << " " << total << "\r\n";
+
+			localSend(oss.str());
+		}
+		else if (cmd == "LIST" || cmd == "UIDL")
+		{
+			std::ostringstream oss;
+			oss.imbue(std::locale::classic());
+
+			if (hasNum)
+			{
+				oss << "+OK " << num << " ";
+
+				if (cmd == "LIST")
+					oss << sim.getMessage(num).length();
+				else
+					oss << "uid-" << num;
+
+				oss << "\r\n";
+			}
+			else
+			{
+				oss << "+OK\r\n";
+
+				for (size_t i = 1 ; i <= count ; ++i)
+				{
+					if (m_deleted.count(i))
+						continue;
+
+					oss << i << " ";
+
+					if (cmd == "LIST")
+						oss << sim.getMessage(i).length();
+					else
+						oss << "uid-" << i;
+
+					oss << "\r\n";
+				}
+
+				oss << ".\r\n";
+			}
+
+			localSend(oss.str());
+		}
+		else if (cmd == "RETR" || cmd == "TOP")
+		{
+			if (!hasNum)
+			{
+				localSend("-ERR Missing message number\r\n");
+				return;
+			}
+
+			vmime::string data;
+
+			if (cmd == "RETR")
+			{
+				data = sim.getMessage(num);
+			}
+			else
+			{
+				size_t lines = 0;
+				iss >> lines;
+
+				data = sim.getMessageHeader(num);
+
+				const vmime::string body = sim.getMessageBody(num);
+				size_t pos = 0;
+
+				for (size_t i = 0 ; i < lines && pos < body.length() ; ++i)
+				{
+					const size_t eol = body.find('\n', pos);
+					pos = (eol == vmime::string::npos) ? body.length() : eol + 1;
+				}
+
+				data += vmime::string(body, 0, pos);
+			}
+
+			localSend("+OK\r\n" + dotStuff(data) + ".\r\n");
+		}
+		else if (cmd == "DELE")
+		{
+			if (!hasNum)
+			{
+				localSend("-ERR Missing message number\r\n");
+				return;
+			}
+
+			m_deleted.insert(num);
+			localSend("+OK Message deleted\r\n");
+		}
+		else if (cmd == "RSET")
+		{
+			m_deleted.clear();
+			localSend("+OK\r\n");
+		}
+		else if (cmd == "QUIT")
+		{
+			localSend("+OK Bye\r\n");
+		}
+		else
+		{
+			localSend("-ERR Command not recognized\r\n");
+		}
+	}
+
+	void sendFailure(const vmime::string& command)
+	{
+		localSend("-ERR Simulated " + command + " failure\r\n");
+	}
+
+private:
+
+	/** Apply byte-stuffing to multi-line response data.
+	  */
+	static const vmime::string dotStuff(const vmime::string& data)
+	{
+		vmime::string res;
+		res.reserve(data.length() + 2);
+
+		for (size_t i = 0 ; i < data.length() ; ++i)
+		{
+			if (data[i] == '.' && (i == 0 || data[i - 1] == '\n'))
+				res += '.';
+
+			res += data[i];
+		}
+
+		if (!res.empty() && res[res.length() - 1] != '\n')
+			res += "\r\n";
+
+		return res;
+	}
+
+
+	std::set <size_t> m_deleted;
+};
+
+
+#endif // VMIME_TESTS_NET_POP3_POP3SERVERSIMULATOR_HPP_INCLUDED
@@ -0,0 +1,626 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_TESTS_NET_SERVERSIMULATOR_HPP_INCLUDED
+#define VMIME_TESTS_NET_SERVERSIMULATOR_HPP_INCLUDED
+
+
+#include <set>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+
+
+/** State shared by all the connections made to a simulated server:
+  * synthetic mailbox contents, advertised capabilities, simulated
+  * network conditions, injected faults and collected statistics.
+  *
+  * Latency and bandwidth are not enforced by sleeping: they are
+  * accounted on a simulated clock, so that runs are deterministic
+  * and do not depend on the load of the machine.
+  */
+class serverSimulator
+{
+public:
+
+	serverSimulator()
+		: m_messageCount(10), m_messageSize(1024), m_latency(0), m_bandwidth(0),
+		  m_failAfterCommands(0)
+	{
+		m_folders.push_back("INBOX");
+
+		resetStatistics();
+	}
+
+
+	// Mailbox contents
+
+	/** Set the number of messages in the synthetic mailbox.
+	  *
+	  * @param count number of messages
+	  */
+	void setMessageCount(const size_t count)
+	{
+		m_messageCount = count;
+	}
+
+	size_t getMessageCount() const
+	{
+		return m_messageCount;
+	}
+
+	/** Set the approximate size of each synthetic message, in bytes.
+	  * Messages are never smaller than their header.
+	  *
+	  * @param size message size
+	  */
+	void setMessageSize(const size_t size)
+	{
+		m_messageSize = size;
+	}
+
+	size_t getMessageSize() const
+	{
+		return m_messageSize;
+	}
+
+	/** Return the header of the specified message.
+	  *
+	  * @param num message number (starting at 1)
+	  * @return message header, including the blank separator line
+	  */
+	const vmime::string getMessageHeader(const size_t num) const
+	{
+		std::ostringstream oss;
+		oss.imbue(std::locale::classic());
+
+		oss << "Date: Mon, 01 Jan 2024 10:00:00 +0000\r\n";
+		oss << "From: Sender <sender@test.vmime.org>\r\n";
+		oss << "To: Recipient <recipient@test.vmime.org>\r\n";
+		oss << "Subject: Message " << num << "\r\n";
+		oss << "Message-Id: <" << num << "@test.vmime.org>\r\n";
+		oss << "MIME-Version: 1.0\r\n";
+		oss << "Content-Type: text/plain; charset=us-ascii\r\n";
+		oss << "Content-Transfer-Encoding: 7bit\r\n";
+		oss << "\r\n";
+
+		return oss.str();
+	}
+
+	/** Return the body of the specified message.
+	  *
+	  * @param num message number (starting at 1)
+	  * @return message body
+	  */
+	const vmime::string getMessageBody(const size_t num) const
+	{
+		const size_t headerSize = getMessageHeader(num).length();
+		const size_t bodySize = (m_messageSize > headerSize ? m_messageSize - headerSize : 0);
+
+		vmime::string body;
+		body.reserve(bodySize);
+
+		for (size_t line = 1 ; body.length() < bodySize ; ++line)
+		{
+			std::ostringstream oss;
+			oss.imbue(std::locale::classic());
+
+			oss << "Line " << line << " of message " << num << ".";
+
+			vmime::string text = oss.str();
+			text.resize(std::max(static_cast <size_t>(70), text.length()), '.');
+			text += "\r\n";
+
+			if (body.length() + text.length() > bodySize)
+			{
+				// Pad the last line so that the body ends with CRLF
+				text.resize(std::max(bodySize - body.length(), static_cast <size_t>(2)) - 2, '.');
+				text += "\r\n";
+			}
+
+			body += text;
+		}
+
+		return body;
+	}
+
+	/** Return the full contents of the specified message.
+	  *
+	  * @param num message number (starting at 1)
+	  * @return message header followed by message body
+	  */
+	const vmime::string getMessage(const size_t num) const
+	{
+		return getMessageHeader(num) + getMessageBody(num);
+	}
+
+
+	// Folders
+
+	/** Add a folder to the store. Every folder holds the same
+	  * synthetic messages. The store initially contains INBOX.
+	  *
+	  * @param name full name of the folder, using '/' as separator
+	  */
+	void addFolder(const vmime::string& name)
+	{
+		m_folders.push_back(name);
+	}
+
+	bool hasFolder(const vmime::string& name) const
+	{
+		return std::find(m_folders.begin(), m_folders.end(), name) != m_folders.end();
+	}
+
+	const std::vector <vmime::string>& getFolders() const
+	{
+		return m_folders;
+	}
+
+
+	// Capabilities
+
+	void addCapability(const vmime::string& capa)
+	{
+		m_capabilities.insert(capa);
+	}
+
+	void removeCapability(const vmime::string& capa)
+	{
+		m_capabilities.erase(capa);
+	}
+
+	bool hasCapability(const vmime::string& capa) const
+	{
+		return m_capabilities.find(capa) != m_capabilities.end();
+	}
+
+	const std::vector <vmime::string> getCapabilities() const
+	{
+		return std::vector <vmime::string>(m_capabilities.begin(), m_capabilities.end());
+	}
+
+
+	// Network conditions
+
+	/** Set the simulated round-trip time.
+	  *
+	  * @param usecs round-trip time, in microseconds
+	  */
+	void setLatency(const unsigned long usecs)
+	{
+		m_latency = usecs;
+	}
+
+	unsigned long getLatency() const
+	{
+		return m_latency;
+	}
+
+	/** Set the simulated link bandwidth.
+	  *
+	  * @param bytesPerSecond bandwidth in bytes per second, or 0 for
+	  * an unlimited bandwidth
+	  */
+	void setBandwidth(const unsigned long bytesPerSecond)
+	{
+		m_bandwidth = bytesPerSecond;
+	}
+
+	unsigned long getBandwidth() const
+	{
+		return m_bandwidth;
+	}
+
+
+	// Fault injection
+
+	/** Make the server drop the connection when it receives the
+	  * specified command (counting across all connections).
+	  *
+	  * @param count number of the command on which the connection
+	  * is dropped, or 0 to disable
+	  */
+	void setFailAfterCommands(const size_t count)
+	{
+		m_failAfterCommands = count;
+	}
+
+	size_t getFailAfterCommands() const
+	{
+		return m_failAfterCommands;
+	}
+
+	/** Make the server answer every command with the specified
+	  * name with a protocol error.
+	  *
+	  * @param command command name (eg. "FETCH", "RETR", "RCPT")
+	  */
+	void addFailingCommand(const vmime::string& command)
+	{
+		m_failingCommands.insert(command);
+	}
+
+	bool isFailingCommand(const vmime::string& command) const
+	{
+		return m_failingCommands.find(command) != m_failingCommands.end();
+	}
+
+
+	// Statistics
+
+	void resetStatistics()
+	{
+		m_connectionCount = 0;
+		m_commandCount = 0;
+		m_roundTrips = 0;
+		m_bytesFromClient = 0;
+		m_bytesToClient = 0;
+		m_deliveredMessages.clear();
+	}
+
+	size_t getConnectionCount() const
+	{
+		return m_connectionCount;
+	}
+
+	size_t getCommandCount() const
+	{
+		return m_commandCount;
+	}
+
+	/** Return the number of times the client had to wait for
+	  * the server. Pipelined commands count as a single round trip.
+	  */
+	size_t getRoundTrips() const
+	{
+		return m_roundTrips;
+	}
+
+	size_t getBytesFromClient() const
+	{
+		return m_bytesFromClient;
+	}
+
+	size_t getBytesToClient() const
+	{
+		return m_bytesToClient;
+	}
+
+	/** Return the time that would have been spent on the network,
+	  * given the simulated latency and bandwidth.
+	  *
+	  * @return simulated network time, in seconds
+	  */
+	double getSimulatedTime() const
+	{
+		double t = static_cast <double>(m_roundTrips) * m_latency / 1000000.0;
+
+		if (m_bandwidth != 0)
+			t += static_cast <double>(m_bytesFromClient + m_bytesToClient) / m_bandwidth;
+
+		return t;
+	}
+
+	/** Return the messages that have been delivered to the server
+	  * (used by transport simulators).
+	  */
+	const std::vector <vmime::string>& getDeliveredMessages() const
+	{
+		return m_deliveredMessages;
+	}
+
+
+	// Used by simulated sockets
+
+	void onConnection()
+	{
+		++m_connectionCount;
+	}
+
+	/** Count a new command.
+	  *
+	  * @return true if the connection should be dropped
+	  */
+	bool onCommand()
+	{
+		++m_commandCount;
+		return m_failAfterCommands != 0 && m_commandCount == m_failAfterCommands;
+	}
+
+	void onRoundTrip()
+	{
+		++m_roundTrips;
+	}
+
+	void onDataFromClient(const size_t count)
+	{
+		m_bytesFromClient += count;
+	}
+
+	void onDataToClient(const size_t count)
+	{
+		m_bytesToClient += count;
+	}
+
+	void onMessageDelivered(const vmime::string& data)
+	{
+		m_deliveredMessages.push_back(data);
+	}
+
+private:
+
+	size_t m_messageCount;
+	size_t m_messageSize;
+
+	std::vector <vmime::string> m_folders;
+
+	std::set <vmime::string> m_capabilities;
+
+	unsigned long m_latency;
+	unsigned long m_bandwidth;
+
+	size_t m_failAfterCommands;
+	std::set <vmime::string> m_failingCommands;
+
+	size_t m_connectionCount;
+	size_t m_commandCount;
+	size_t m_roundTrips;
+	size_t m_bytesFromClient;
+	size_t m_bytesToClient;
+	std::vector <vmime::string> m_deliveredMessages;
+};
+
+
+/** Base class for simulated server sockets.
+  *
+  * Splits the data sent by the client into lines (or raw chunks,
+  * when the protocol expects a literal of known size), accounts
+  * for round trips and transferred bytes, and drops the connection
+  * when the simulator asks for it.
+  */
+class serverSimulatorSocket : public testSocket
+{
+public:
+
+	serverSimulatorSocket(vmime::shared_ptr <serverSimulator> sim)
+		: m_sim(sim), m_waitingForResponse(false), m_dropped(false), m_rawDataExpected(0)
+	{
+	}
+
+	void send(const vmime::string& buffer)
+	{
+		if (m_dropped)
+			throw vmime::exceptions::socket_exception("Connection closed by remote host");
+
+		m_sim->onDataFromClient(buffer.length());
+		m_waitingForResponse = true;
+
+		testSocket::send(buffer);
+	}
+
+	void receive(vmime::string& buffer)
+	{
+		testSocket::receive(buffer);
+		onDataSent(buffer.length());
+	}
+
+	size_t receiveRaw(vmime::byte_t* buffer, const size_t count)
+	{
+		const size_t n = testSocket::receiveRaw(buffer, count);
+		onDataSent(n);
+
+		return n;
+	}
+
+	vmime::shared_ptr <serverSimulator> getSimulator() const
+	{
+		return m_sim;
+	}
+
+protected:
+
+	void onConnected()
+	{
+		m_sim->onConnection();
+
+		// Establishing the connection costs one round trip
+		m_waitingForResponse = true;
+
+		sendGreeting();
+	}
+
+	void onDataReceived()
+	{
+		vmime::string chunk;
+		localReceive(chunk);
+
+		m_buffer += chunk;
+
+		while (!m_dropped && !m_buffer.empty())
+		{
+			if (m_rawDataExpected != 0)
+			{
+				const size_t n = std::min(m_rawDataExpected, m_buffer.length());
+
+				m_rawData.append(m_buffer, 0, n);
+				m_buffer.erase(0, n);
+
+				m_rawDataExpected -= n;
+
+				if (m_rawDataExpected == 0)
+				{
+					vmime::string data;
+					std::swap(data, m_rawData);
+
+					processRawData(data);
+				}
+			}
+			else
+			{
+				const size_t eol = m_buffer.find('\n');
+
+				if (eol == vmime::string::npos)
+					break;
+
+				vmime::string line(m_buffer.begin(), m_buffer.begin() + eol);
+				m_buffer.erase(0, eol + 1);
+
+				if (!line.empty() && line[line.length() - 1] == '\r')
+					line.erase(line.end() - 1, line.end());
+
+				processLine(line);
+			}
+		}
+	}
+
+	/** Check for injected faults before processing a command.
+	  *
+	  * @param command command name
+	  * @return true if the command should be processed normally,
+	  * or false if it has been handled by injecting a fault
+	  */
+	bool checkCommand(const vmime::string& command)
+	{
+		if (m_sim->onCommand())
+		{
+			drop();
+			return false;
+		}
+		else if (m_sim->isFailingCommand(command))
+		{
+			sendFailure(command);
+			return false;
+		}
+
+		return true;
+	}
+
+	/** Close the connection abruptly.
+	  */
+	void drop()
+	{
+		m_dropped = true;
+		disconnect();
+	}
+
+	/** Make the next 'count' bytes sent by the client be passed
+	  * as a whole to processRawData() instead of being split in lines.
+	  */
+	void expectRawData(const size_t count)
+	{
+		m_rawDataExpected = count;
+
+		if (count == 0)
+			processRawData("");
+	}
+
+	/** Called when the client connects.
+	  */
+	virtual void sendGreeting() = 0;
+
+	/** Called for each line received from the client.
+	  *
+	  * @param line line, without CRLF
+	  */
+	virtual void processLine(const vmime::string& line) = 0;
+
+	/** Called when data requested with expectRawData() is complete.
+	  *
+	  * @param data raw data received
+	  */
+	virtual void processRawData(const vmime::string& /* data */)
+	{
+	}
+
+	/** Send a protocol error in response to a command for which
+	  * a failure has been injected.
+	  *
+	  * @param command command name
+	  */
+	virtual void sendFailure(const vmime::string& command) = 0;
+
+private:
+
+	void onDataSent(const size_t count)
+	{
+		if (count == 0)
+		{
+			if (m_dropped)
+				throw vmime::exceptions::socket_exception("Connection closed by remote host");
+
+			return;
+		}
+
+		if (m_waitingForResponse)
+		{
+			m_sim->onRoundTrip();
+			m_waitingForResponse = false;
+		}
+
+		m_sim->onDataToClient(count);
+	}
+
+
+	vmime::shared_ptr <serverSimulator> m_sim;
+
+	bool m_waitingForResponse;
+	bool m_dropped;
+
+	vmime::string m_buffer;
+
+	size_t m_rawDataExpected;
+	vmime::string m_rawData;
+};
+
+
+/** Creates simulated server sockets of type T, all sharing
+  * the same simulator.
+  */
+template <typename T>
+class serverSimulatorSocketFactory : public vmime::net::socketFactory
+{
+public:
+
+	serverSimulatorSocketFactory(vmime::shared_ptr <serverSimulator> sim)
+		: m_sim(sim)
+	{
+	}
+
+	vmime::shared_ptr <vmime::net::socket> create()
+	{
+		return vmime::make_shared <T>(m_sim);
+	}
+
+	vmime::shared_ptr <vmime::net::socket> create(vmime::shared_ptr <vmime::net::timeoutHandler> /* th */)
+	{
+		return vmime::make_shared <T>(m_sim);
+	}
+
+private:
+
+	vmime::shared_ptr <serverSimulator> m_sim;
+};
+
+
+#endif // VMIME_TESTS_NET_SERVERSIMULATOR_HPP_INCLUDED
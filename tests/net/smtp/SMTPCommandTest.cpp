@@ -43,9 +43,12 @@ VMIME_TEST_SUITE_BEGIN(SMTPCommandTest)
 		VMIME_TEST(testMAIL_UTF8)
 		VMIME_TEST(testMAIL_SIZE)
 		VMIME_TEST(testMAIL_SIZE_UTF8)
+		VMIME_TEST(testMAIL_BODY)
+		VMIME_TEST(testMAIL_DSN)
 		VMIME_TEST(testRCPT)
 		VMIME_TEST(testRCPT_Encoded)
 		VMIME_TEST(testRCPT_UTF8)
+		VMIME_TEST(testRCPT_DSN)
 		VMIME_TEST(testRSET)
 		VMIME_TEST(testDATA)
 		VMIME_TEST(testBDAT)
@@ -147,6 +150,28 @@ VMIME_TEST_SUITE_BEGIN(SMTPCommandTest)
 		VASSERT_EQ("Text", "MAIL FROM:<mailtest@例え.テスト> SMTPUTF8 SIZE=123456789", cmd->getText());
 	}
 
+	void testMAIL_BODY()
+	{
+		vmime::shared_ptr <SMTPCommand> cmd = SMTPCommand::MAIL
+			(vmime::mailbox("me@vmime.org"), false, 42, "8BITMIME", vmime::net::dsnAttributes());
+
+		VASSERT_NOT_NULL("Not null", cmd);
+		VASSERT_EQ("Text", "MAIL FROM:<me@vmime.org> SIZE=42 BODY=8BITMIME", cmd->getText());
+	}
+
+	void testMAIL_DSN()
+	{
+		vmime::net::dsnAttributes attrs;
+		attrs.setReturnType(vmime::net::dsnAttributes::RETURN_HEADERS);
+		attrs.setEnvelopeId("QQ314159+x=y");
+
+		vmime::shared_ptr <SMTPCommand> cmd = SMTPCommand::MAIL
+			(vmime::mailbox("me@vmime.org"), false, 0, "", attrs);
+
+		VASSERT_NOT_NULL("Not null", cmd);
+		VASSERT_EQ("Text", "MAIL FROM:<me@vmime.org> RET=HDRS ENVID=QQ314159+2Bx+3Dy", cmd->getText());
+	}
+
 	void testRCPT()
 	{
 		vmime::shared_ptr <SMTPCommand> cmd = SMTPCommand::RCPT(vmime::mailbox("someone@vmime.org"), false);
@@ -173,6 +198,28 @@ VMIME_TEST_SUITE_BEGIN(SMTPCommandTest)
 		VASSERT_EQ("Text", "RCPT TO:<mailtest@例え.テスト>", cmd->getText());
 	}
 
+	void testRCPT_DSN()
+	{
+		vmime::net::dsnAttributes attrs;
+		attrs.setNotifyFlags(vmime::net::dsnAttributes::NOTIFY_SUCCESS |
+		                     vmime::net::dsnAttributes::NOTIFY_FAILURE);
+		attrs.setSendOriginalRecipient(true);
+
+		vmime::shared_ptr <SMTPCommand> cmd = SMTPCommand::RCPT
+			(vmime::mailbox("someone@vmime.org"), false, attrs);
+
+		VASSERT_NOT_NULL("Not null", cmd);
+		VASSERT_EQ("Text", "RCPT TO:<someone@vmime.org> NOTIFY=SUCCESS,FAILURE "
+			"ORCPT=rfc822;someone@vmime.org", cmd->getText());
+
+		attrs.setNotifyFlags(vmime::net::dsnAttributes::NOTIFY_NEVER);
+		attrs.setSendOriginalRecipient(false);
+
+		cmd = SMTPCommand::RCPT(vmime::mailbox("someone@vmime.org"), false, attrs);
+
+		VASSERT_EQ("Text 2", "RCPT TO:<someone@vmime.org> NOTIFY=NEVER", cmd->getText());
+	}
+
 	void testRSET()
 	{
 		vmime::shared_ptr <SMTPCommand> cmd = SMTPCommand::RSET();
@@ -0,0 +1,175 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#ifndef VMIME_TESTS_NET_SMTP_SMTPSERVERSIMULATOR_HPP_INCLUDED
+#define VMIME_TESTS_NET_SMTP_SMTPSERVERSIMULATOR_HPP_INCLUDED
+
+
+#include "tests/net/serverSimulator.hpp"
+
+#include "vmime/utility/stringUtils.hpp"
+
+
+/** Simulated SMTP server.
+  *
+  * Accepts all senders and recipients, and records every message
+  * received with DATA or BDAT in the simulator. Capabilities listed
+  * in the simulator (eg. PIPELINING, CHUNKING, 8BITMIME) are
+  * advertised in response to EHLO.
+  */
+class SMTPServerSimulatorSocket : public serverSimulatorSocket
+{
+public:
+
+	SMTPServerSimulatorSocket(vmime::shared_ptr <serverSimulator> sim)
+		: serverSimulatorSocket(sim), m_inData(false), m_lastChunk(false)
+	{
+	}
+
+protected:
+
+	void sendGreeting()
+	{
+		localSend("220 test.vmime.org SMTP server simulator ready\r\n");
+	}
+
+	void processLine(const vmime::string& line)
+	{
+		if (m_inData)
+		{
+			if (line == ".")
+			{
+				m_inData = false;
+
+				getSimulator()->onMessageDelivered(m_message);
+				m_message.clear();
+
+				localSend("250 2.0.0 Message accepted\r\n");
+			}
+			else if (!line.empty() && line[0] == '.')
+			{
+				m_message += vmime::string(line, 1) + "\r\n";
+			}
+			else
+			{
+				m_message += line + "\r\n";
+			}
+
+			return;
+		}
+
+		std::istringstream iss(line);
+		iss.imbue(std::locale::classic());
+
+		vmime::string cmd;
+		iss >> cmd;
+
+		cmd = vmime::utility::stringUtils::toUpper(cmd);
+
+		if (!checkCommand(cmd))
+			return;
+
+		if (cmd == "EHLO")
+		{
+			const std::vector <vmime::string> capa = getSimulator()->getCapabilities();
+
+			vmime::string resp = "250";
+			resp += (capa.empty() ? " " : "-");
+			resp += "test.vmime.org Hello\r\n";
+
+			for (size_t i = 0 ; i < capa.size() ; ++i)
+			{
+				resp += "250";
+				resp += (i + 1 == capa.size() ? " " : "-");
+				resp += capa[i] + "\r\n";
+			}
+
+			localSend(resp);
+		}
+		else if (cmd == "MAIL" || cmd == "RSET")
+		{
+			m_message.clear();
+			localSend("250 2.0.0 OK\r\n");
+		}
+		else if (cmd == "HELO" || cmd == "RCPT" || cmd == "NOOP")
+		{
+			localSend("250 2.0.0 OK\r\n");
+		}
+		else if (cmd == "DATA")
+		{
+			m_inData = true;
+			localSend("354 Start mail input; end with <CRLF>.<CRLF>\r\n");
+		}
+		else if (cmd == "BDAT")
+		{
+			size_t size = 0;
+			vmime::string last;
+
+			iss >> size >> last;
+
+			m_lastChunk = (vmime::utility::stringUtils::toUpper(last) == "LAST");
+
+			expectRawData(size);
+		}
+		else if (cmd == "QUIT")
+		{
+			localSend("221 2.0.0 Bye\r\n");
+		}
+		else
+		{
+			localSend("500 5.5.1 Command not recognized\r\n");
+		}
+	}
+
+	void processRawData(const vmime::string& data)
+	{
+		m_message += data;
+
+		std::ostringstream oss;
+		oss.imbue(std::locale::classic());
+		oss << "250 2.0.0 " << data.length() << " bytes received\r\n";
+
+		localSend(oss.str());
+
+		if (m_lastChunk)
+		{
+			getSimulator()->onMessageDelivered(m_message);
+			m_message.clear();
+		}
+	}
+
+	void sendFailure(const vmime::string& command)
+	{
+		localSend("451 4.3.0 Simulated " + command + " failure\r\n");
+	}
+
+private:
+
+	bool m_inData;
+	bool m_lastChunk;
+
+	vmime::string m_message;
+};
+
+
+#endif // VMIME_TESTS_NET_SMTP_SMTPSERVERSIMULATOR_HPP_INCLUDED
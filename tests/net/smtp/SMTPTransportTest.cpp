@@ -27,6 +27,8 @@
 #include "vmime/net/smtp/SMTPChunkingOutputStreamAdapter.hpp"
 #include "vmime/net/smtp/SMTPExceptions.hpp"
 
+#include "vmime/utility/metricsRegistry.hpp"
+
 #include "SMTPTransportTestUtils.hpp"
 
 
@@ -39,6 +41,9 @@ VMIME_TEST_SUITE_BEGIN(SMTPTransportTest)
 		VMIME_TEST(testChunking)
 		VMIME_TEST(testSize_Chunking)
 		VMIME_TEST(testSize_NoChunking)
+		VMIME_TEST(testDATA)
+		VMIME_TEST(test8BITMIMEAndDSN)
+		VMIME_TEST(testCommandMetrics)
 	VMIME_TEST_LIST_END
 
 
@@ -174,5 +179,107 @@ VMIME_TEST_SUITE_BEGIN(SMTPTransportTest)
 			vmime::net::smtp::SMTPMessageSizeExceedsMaxLimitsException);
 	}
 
+	void testDATA()
+	{
+		vmime::shared_ptr <vmime::net::session> session =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transport> tr = session->getTransport
+			(vmime::utility::url("smtp://localhost"));
+
+		tr->setSocketFactory(vmime::make_shared <testSocketFactory <DATASMTPTestSocket> >());
+		tr->setTimeoutHandlerFactory(vmime::make_shared <testTimeoutHandlerFactory>());
+
+		tr->connect();
+
+		vmime::mailbox exp("expeditor@test.vmime.org");
+
+		vmime::mailboxList recips;
+		recips.appendMailbox(vmime::make_shared <vmime::mailbox>("recipient@test.vmime.org"));
+
+		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <SMTPDATATestMessage>();
+
+		tr->send(msg, exp, recips);
+	}
+
+	void test8BITMIMEAndDSN()
+	{
+		vmime::shared_ptr <vmime::net::session> session =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::smtp::SMTPTransport> tr =
+			vmime::dynamicCast <vmime::net::smtp::SMTPTransport>
+				(session->getTransport(vmime::utility::url("smtp://localhost")));
+
+		tr->setSocketFactory(vmime::make_shared <testSocketFactory <EightBitMIMESMTPTestSocket> >());
+		tr->setTimeoutHandlerFactory(vmime::make_shared <testTimeoutHandlerFactory>());
+
+		vmime::net::dsnAttributes dsnAttrs;
+		dsnAttrs.setNotifyFlags(vmime::net::dsnAttributes::NOTIFY_FAILURE);
+		dsnAttrs.setReturnType(vmime::net::dsnAttributes::RETURN_HEADERS);
+		dsnAttrs.setEnvelopeId("id+1");
+
+		tr->setDSNAttributes(dsnAttrs);
+
+		tr->connect();
+
+		vmime::mailbox exp("expeditor@test.vmime.org");
+
+		vmime::mailboxList recips;
+		recips.appendMailbox(vmime::make_shared <vmime::mailbox>("recipient@test.vmime.org"));
+
+		// Text which would be encoded in quoted-printable over 7-bit transports
+		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <vmime::message>();
+		msg->getHeader()->ContentType()->setValue(vmime::mediaType("text/plain"));
+		msg->getBody()->setContents(vmime::make_shared <vmime::stringContentHandler>("caf\xc3\xa9\r\n"));
+		msg->getBody()->setEncoding(vmime::encoding(vmime::encodingTypes::QUOTED_PRINTABLE));
+
+		tr->send(msg, exp, recips);
+
+		tr->disconnect();
+	}
+
+	void testCommandMetrics()
+	{
+		vmime::shared_ptr <vmime::utility::metricsRegistry> reg =
+			vmime::make_shared <vmime::utility::metricsRegistry>();
+
+		vmime::utility::instrumentation::setInstance(reg);
+
+		vmime::shared_ptr <vmime::net::session> session =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transport> tr = session->getTransport
+			(vmime::utility::url("smtp://localhost"));
+
+		tr->setSocketFactory(vmime::make_shared <testSocketFactory <chunkingSMTPTestSocket> >());
+		tr->setTimeoutHandlerFactory(vmime::make_shared <testTimeoutHandlerFactory>());
+
+		tr->connect();
+
+		vmime::mailbox exp("expeditor@test.vmime.org");
+
+		vmime::mailboxList recips;
+		recips.appendMailbox(vmime::make_shared <vmime::mailbox>("recipient@test.vmime.org"));
+
+		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <SMTPTestMessage>();
+
+		tr->send(msg, exp, recips);
+
+		vmime::utility::instrumentation::setInstance(vmime::null);
+
+		typedef vmime::utility::instrumentation inst;
+
+		VASSERT_EQ("MAIL", 1, reg->getCounter(inst::SMTP_COMMANDS, "MAIL"));
+		VASSERT_EQ("RCPT", 1, reg->getCounter(inst::SMTP_COMMANDS, "RCPT"));
+		VASSERT_EQ("BDAT", 3, reg->getCounter(inst::SMTP_COMMANDS, "BDAT"));
+
+		// Each command is matched with its own response
+		VASSERT_EQ("MAIL duration", 1, reg->getDurationCount(inst::SMTP_COMMAND_DURATION, "MAIL"));
+		VASSERT_EQ("RCPT duration", 1, reg->getDurationCount(inst::SMTP_COMMAND_DURATION, "RCPT"));
+		VASSERT_EQ("BDAT duration", 3, reg->getDurationCount(inst::SMTP_COMMAND_DURATION, "BDAT"));
+	}
+
+
 VMIME_TEST_SUITE_END
 
@@ -530,6 +530,14 @@ public:
 
 				m_mailSent = true;
 			}
+			else if (cmd == "RSET")
+			{
+				// The transaction is reset after the rejection, so that
+				// the connection can be reused
+				VASSERT("RSET must be sent after MAIL", m_mailSent);
+
+				localSend("250 OK\r\n");
+			}
 			else if (cmd == "NOOP")
 			{
 				localSend("250 Completed\r\n");
@@ -591,3 +599,289 @@ public:
 };
 
 typedef SMTPBigTestMessage <4194304> SMTPBigTestMessage4MB;
+
+
+
+/** SMTP test server 4.
+  *
+  * Test sending message data after DATA command (no CHUNKING).
+  */
+class DATASMTPTestSocket : public lineBasedTestSocket
+{
+public:
+
+	DATASMTPTestSocket()
+	{
+		m_state = STATE_NOT_CONNECTED;
+		m_mailSent = m_dataSent = m_quitSent = false;
+	}
+
+	~DATASMTPTestSocket()
+	{
+		VASSERT("Client must send the DATA command", m_dataSent);
+		VASSERT("Client must send the QUIT command", m_quitSent);
+	}
+
+	void onConnected()
+	{
+		localSend("220 test.vmime.org Service ready\r\n");
+		processCommand();
+
+		m_state = STATE_COMMAND;
+	}
+
+	void processCommand()
+	{
+		if (!haveMoreLines())
+			return;
+
+		vmime::string line = getNextLine();
+		std::istringstream iss(line);
+
+		switch (m_state)
+		{
+		case STATE_NOT_CONNECTED:
+
+			localSend("451 Requested action aborted: invalid state\r\n");
+			break;
+
+		case STATE_COMMAND:
+		{
+			std::string cmd;
+			iss >> cmd;
+
+			if (cmd == "EHLO")
+			{
+				localSend("250-test.vmime.org says hello\r\n");
+				localSend("250 SIZE 1000000\r\n");
+			}
+			else if (cmd == "MAIL")
+			{
+				std::string address;
+				iss >> address;
+
+				std::string option;
+				iss >> option;
+
+				VASSERT_EQ("MAIL/size", "SIZE=42", option);
+
+				localSend("250 OK\r\n");
+
+				m_mailSent = true;
+			}
+			else if (cmd == "RCPT")
+			{
+				localSend("250 OK, recipient accepted\r\n");
+			}
+			else if (cmd == "DATA")
+			{
+				VASSERT("Client must send the MAIL command", m_mailSent);
+
+				localSend("354 Ready to accept data; end with <CRLF>.<CRLF>\r\n");
+
+				m_state = STATE_DATA;
+				m_msgData.clear();
+
+				m_dataSent = true;
+			}
+			else if (cmd == "QUIT")
+			{
+				m_quitSent = true;
+
+				localSend("221 test.vmime.org Service closing transmission channel\r\n");
+			}
+			else
+			{
+				localSend("502 Command not implemented\r\n");
+			}
+
+			break;
+		}
+		case STATE_DATA:
+		{
+			if (line == ".")
+			{
+				VASSERT_EQ("Data", "Line 1\r\n..Line 2\r\n..\r\n..\r\nLine 5\r\n", m_msgData);
+
+				localSend("250 Message accepted for delivery\r\n");
+				m_state = STATE_COMMAND;
+			}
+			else
+			{
+				m_msgData += line + "\r\n";
+			}
+
+			break;
+		}
+
+		}
+
+		processCommand();
+	}
+
+private:
+
+	enum State
+	{
+		STATE_NOT_CONNECTED,
+		STATE_COMMAND,
+		STATE_DATA
+	};
+
+	int m_state;
+
+	std::string m_msgData;
+
+	bool m_mailSent, m_dataSent, m_quitSent;
+};
+
+
+class SMTPDATATestMessage : public vmime::message
+{
+public:
+
+	size_t getGeneratedSize(const vmime::generationContext& /* ctx */)
+	{
+		return 42;
+	}
+
+	void generateImpl(const vmime::generationContext& /* ctx */,
+		 vmime::utility::outputStream& outputStream,
+		 const vmime::size_t /* curLinePos */ = 0,
+		 vmime::size_t* /* newLinePos */ = NULL) const
+	{
+		// Data is written in small pieces, as when generating
+		// a message; lines starting with a dot must be escaped
+		outputStream.write("Line 1\r\n", 8);
+		outputStream.write(".Line 2\r", 8);
+		outputStream.write("\n", 1);
+		outputStream.write(".", 1);
+		outputStream.write("\r\n.", 3);
+		outputStream.write("\r\nLine 5", 8);
+	}
+};
+
+
+
+/** SMTP test server for 8BITMIME and DSN extensions.
+  */
+class EightBitMIMESMTPTestSocket : public lineBasedTestSocket
+{
+public:
+
+	EightBitMIMESMTPTestSocket()
+	{
+		m_state = STATE_NOT_CONNECTED;
+		m_dataSent = false;
+	}
+
+	~EightBitMIMESMTPTestSocket()
+	{
+		VASSERT("Client must send the DATA command", m_dataSent);
+	}
+
+	void onConnected()
+	{
+		localSend("220 test.vmime.org Service ready\r\n");
+		processCommand();
+
+		m_state = STATE_COMMAND;
+	}
+
+	void processCommand()
+	{
+		if (!haveMoreLines())
+			return;
+
+		vmime::string line = getNextLine();
+		std::istringstream iss(line);
+
+		switch (m_state)
+		{
+		case STATE_NOT_CONNECTED:
+
+			localSend("451 Requested action aborted: invalid state\r\n");
+			break;
+
+		case STATE_COMMAND:
+		{
+			std::string cmd;
+			iss >> cmd;
+
+			if (cmd == "EHLO")
+			{
+				localSend("250-test.vmime.org says hello\r\n");
+				localSend("250-8BITMIME\r\n");
+				localSend("250 DSN\r\n");
+			}
+			else if (cmd == "MAIL")
+			{
+				VASSERT_EQ("MAIL", "MAIL FROM:<expeditor@test.vmime.org> "
+					"BODY=8BITMIME RET=HDRS ENVID=id+2B1", line);
+
+				localSend("250 OK\r\n");
+			}
+			else if (cmd == "RCPT")
+			{
+				VASSERT_EQ("RCPT", "RCPT TO:<recipient@test.vmime.org> NOTIFY=FAILURE", line);
+
+				localSend("250 OK, recipient accepted\r\n");
+			}
+			else if (cmd == "DATA")
+			{
+				localSend("354 Ready to accept data; end with <CRLF>.<CRLF>\r\n");
+
+				m_state = STATE_DATA;
+				m_msgData.clear();
+
+				m_dataSent = true;
+			}
+			else if (cmd == "QUIT")
+			{
+				localSend("221 test.vmime.org Service closing transmission channel\r\n");
+			}
+			else
+			{
+				localSend("502 Command not implemented\r\n");
+			}
+
+			break;
+		}
+		case STATE_DATA:
+		{
+			if (line == ".")
+			{
+				VASSERT("8bit", m_msgData.find("Content-Transfer-Encoding: 8bit\r\n") != vmime::string::npos);
+				VASSERT("Data", m_msgData.find("\r\ncaf\xc3\xa9\r\n") != vmime::string::npos);
+
+				localSend("250 Message accepted for delivery\r\n");
+				m_state = STATE_COMMAND;
+			}
+			else
+			{
+				m_msgData += line + "\r\n";
+			}
+
+			break;
+		}
+
+		}
+
+		processCommand();
+	}
+
+private:
+
+	enum State
+	{
+		STATE_NOT_CONNECTED,
+		STATE_COMMAND,
+		STATE_DATA
+	};
+
+	int m_state;
+
+	std::string m_msgData;
+
+	bool m_dataSent;
+};
@@ -0,0 +1,131 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2014 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/net/tls/TLSSessionCache.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(TLSSessionCacheTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testMakeServerIdentity)
+		VMIME_TEST(testStoreRetrieve)
+		VMIME_TEST(testStoreReplace)
+		VMIME_TEST(testRemove)
+		VMIME_TEST(testEviction)
+		VMIME_TEST(testStatistics)
+	VMIME_TEST_LIST_END
+
+
+	static const vmime::byteArray makeData(const vmime::string& str)
+	{
+		return vmime::byteArray(str.begin(), str.end());
+	}
+
+
+	void testMakeServerIdentity()
+	{
+		VASSERT_EQ("1", "mail.vmime.org:993",
+			vmime::net::tls::TLSSessionCache::makeServerIdentity("mail.vmime.org", 993));
+	}
+
+	void testStoreRetrieve()
+	{
+		vmime::net::tls::TLSSessionCache cache;
+		vmime::byteArray data;
+
+		VASSERT_FALSE("1", cache.retrieve("host:25", data));
+
+		cache.store("host:25", makeData("session"));
+
+		VASSERT_EQ("2", 1, cache.getEntryCount());
+		VASSERT_TRUE("3", cache.retrieve("host:25", data));
+		VASSERT_TRUE("4", data == makeData("session"));
+		VASSERT_FALSE("5", cache.retrieve("host:465", data));
+	}
+
+	void testStoreReplace()
+	{
+		vmime::net::tls::TLSSessionCache cache;
+		vmime::byteArray data;
+
+		cache.store("host:25", makeData("old"));
+		cache.store("host:25", makeData("new"));
+
+		VASSERT_EQ("1", 1, cache.getEntryCount());
+		VASSERT_TRUE("2", cache.retrieve("host:25", data));
+		VASSERT_TRUE("3", data == makeData("new"));
+	}
+
+	void testRemove()
+	{
+		vmime::net::tls::TLSSessionCache cache;
+		vmime::byteArray data;
+
+		cache.store("host1:25", makeData("1"));
+		cache.store("host2:25", makeData("2"));
+		cache.remove("host1:25");
+
+		VASSERT_EQ("1", 1, cache.getEntryCount());
+		VASSERT_FALSE("2", cache.retrieve("host1:25", data));
+		VASSERT_TRUE("3", cache.retrieve("host2:25", data));
+
+		cache.clear();
+
+		VASSERT_EQ("4", 0, cache.getEntryCount());
+	}
+
+	void testEviction()
+	{
+		vmime::net::tls::TLSSessionCache cache(2);
+		vmime::byteArray data;
+
+		cache.store("host1:25", makeData("1"));
+		cache.store("host2:25", makeData("2"));
+
+		// Use 'host1', so that 'host2' is the least recently used
+		VASSERT_TRUE("1", cache.retrieve("host1:25", data));
+
+		cache.store("host3:25", makeData("3"));
+
+		VASSERT_EQ("2", 2, cache.getEntryCount());
+		VASSERT_TRUE("3", cache.retrieve("host1:25", data));
+		VASSERT_FALSE("4", cache.retrieve("host2:25", data));
+		VASSERT_TRUE("5", cache.retrieve("host3:25", data));
+	}
+
+	void testStatistics()
+	{
+		vmime::net::tls::TLSSessionCache cache;
+
+		cache.recordHandshake(false);
+		cache.recordHandshake(true);
+		cache.recordHandshake(true);
+
+		VASSERT_EQ("1", 2, cache.getHitCount());
+		VASSERT_EQ("2", 1, cache.getMissCount());
+	}
+
+VMIME_TEST_SUITE_END
+
@@ -0,0 +1,503 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/net/transportPool.hpp"
+#include "vmime/net/smtp/SMTPExceptions.hpp"
+
+#include "vmime/utility/sync/autoLock.hpp"
+
+
+/** SMTP test server which accepts any number of messages
+  * and counts the commands it receives. Several connections may
+  * be used at the same time from different threads.
+  */
+class poolSMTPTestSocket : public lineBasedTestSocket
+{
+public:
+
+	static int connectionCount;
+	static int messageCount;
+	static int rsetCount;
+	static int noopCount;
+	static int quitCount;
+
+	// If true, the next connection which receives a RSET command
+	// behaves as if it had been closed by the server
+	static bool dropOnNextReset;
+
+	static void resetCounters()
+	{
+		connectionCount = messageCount = rsetCount = noopCount = quitCount = 0;
+		dropOnNextReset = false;
+
+		if (!counterLock)
+			counterLock = vmime::platform::getHandler()->createCriticalSection();
+	}
+
+	static void increment(int& counter)
+	{
+		vmime::utility::sync::autoLock <vmime::utility::sync::criticalSection> lock(counterLock);
+		++counter;
+	}
+
+	poolSMTPTestSocket()
+		: m_inData(false), m_dropped(false)
+	{
+	}
+
+	void receive(vmime::string& buffer)
+	{
+		if (m_dropped)
+			throw vmime::exceptions::socket_exception("Connection closed by remote host");
+
+		lineBasedTestSocket::receive(buffer);
+	}
+
+	void onConnected()
+	{
+		increment(connectionCount);
+
+		localSend("220 test.vmime.org Service ready\r\n");
+		processCommand();
+	}
+
+	void processCommand()
+	{
+		if (!haveMoreLines())
+			return;
+
+		vmime::string line = getNextLine();
+
+		if (m_inData)
+		{
+			if (line == ".")
+			{
+				increment(messageCount);
+				m_inData = false;
+
+				localSend("250 Message accepted for delivery\r\n");
+			}
+		}
+		else
+		{
+			std::istringstream iss(line);
+
+			std::string cmd;
+			iss >> cmd;
+
+			if (cmd == "EHLO")
+			{
+				localSend("250 test.vmime.org says hello\r\n");
+			}
+			else if (cmd == "RCPT" && line.find("reject") != vmime::string::npos)
+			{
+				localSend("550 No such user\r\n");
+			}
+			else if (cmd == "RCPT" && line.find("toobig") != vmime::string::npos)
+			{
+				localSend("552 Message size exceeds fixed maximum message size\r\n");
+			}
+			else if (cmd == "MAIL" || cmd == "RCPT")
+			{
+				localSend("250 OK\r\n");
+			}
+			else if (cmd == "DATA")
+			{
+				m_inData = true;
+				localSend("354 Ready to accept data; end with <CRLF>.<CRLF>\r\n");
+			}
+			else if (cmd == "RSET")
+			{
+				if (takeDropOnNextReset())
+				{
+					m_dropped = true;
+					return;
+				}
+
+				increment(rsetCount);
+				localSend("250 OK\r\n");
+			}
+			else if (cmd == "NOOP")
+			{
+				increment(noopCount);
+				localSend("250 Completed\r\n");
+			}
+			else if (cmd == "QUIT")
+			{
+				increment(quitCount);
+				localSend("221 test.vmime.org Service closing transmission channel\r\n");
+			}
+			else
+			{
+				localSend("502 Command not implemented\r\n");
+			}
+		}
+
+		processCommand();
+	}
+
+private:
+
+	static bool takeDropOnNextReset()
+	{
+		vmime::utility::sync::autoLock <vmime::utility::sync::criticalSection> lock(counterLock);
+
+		const bool drop = dropOnNextReset;
+		dropOnNextReset = false;
+
+		return drop;
+	}
+
+
+	static vmime::shared_ptr <vmime::utility::sync::criticalSection> counterLock;
+
+	bool m_inData;
+	bool m_dropped;
+};
+
+
+int poolSMTPTestSocket::connectionCount = 0;
+int poolSMTPTestSocket::messageCount = 0;
+int poolSMTPTestSocket::rsetCount = 0;
+int poolSMTPTestSocket::noopCount = 0;
+int poolSMTPTestSocket::quitCount = 0;
+bool poolSMTPTestSocket::dropOnNextReset = false;
+vmime::shared_ptr <vmime::utility::sync::criticalSection> poolSMTPTestSocket::counterLock;
+
+
+
+VMIME_TEST_SUITE_BEGIN(transportPoolTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testSessionPool)
+		VMIME_TEST(testConnectionReuse)
+		VMIME_TEST(testMaxConnections)
+		VMIME_TEST(testHealthCheck)
+		VMIME_TEST(testIdleTimeout)
+		VMIME_TEST(testSendBatch)
+		VMIME_TEST(testRejectedMessage)
+		VMIME_TEST(testMessageSizeExceeded)
+		VMIME_TEST(testClosedIdleConnection)
+		VMIME_TEST(testWarmUp)
+		VMIME_TEST(testSendBatchParallel)
+	VMIME_TEST_LIST_END
+
+
+	static vmime::shared_ptr <vmime::net::transportPool> createPool
+		(vmime::shared_ptr <vmime::net::session> sess)
+	{
+		vmime::shared_ptr <vmime::net::transportPool> pool =
+			sess->getTransportPool(vmime::utility::url("smtp://localhost"));
+
+		pool->setSocketFactory(vmime::make_shared <testSocketFactory <poolSMTPTestSocket> >());
+		pool->setTimeoutHandlerFactory(vmime::make_shared <testTimeoutHandlerFactory>());
+
+		return pool;
+	}
+
+	static vmime::shared_ptr <vmime::message> createMessage
+		(const vmime::string& to = "recipient@test.vmime.org")
+	{
+		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <vmime::message>();
+
+		msg->parse
+		(
+			"From: expeditor@test.vmime.org\r\n"
+			"To: " + to + "\r\n"
+			"Subject: Test\r\n"
+			"\r\n"
+			"Message data\r\n"
+		);
+
+		return msg;
+	}
+
+	void testSessionPool()
+	{
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool1 =
+			sess->getTransportPool(vmime::utility::url("smtp://localhost"));
+		vmime::shared_ptr <vmime::net::transportPool> pool2 =
+			sess->getTransportPool(vmime::utility::url("smtp://localhost"));
+		vmime::shared_ptr <vmime::net::transportPool> pool3 =
+			sess->getTransportPool(vmime::utility::url("smtp://otherhost"));
+
+		VASSERT("Same URL", pool1 == pool2);
+		VASSERT("Different URL", pool1 != pool3);
+	}
+
+	void testConnectionReuse()
+	{
+		poolSMTPTestSocket::resetCounters();
+
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool = createPool(sess);
+
+		pool->send(createMessage());
+		pool->send(createMessage());
+
+		VASSERT_EQ("Connections", 1, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("Messages", 2, poolSMTPTestSocket::messageCount);
+		VASSERT_EQ("RSET", 1, poolSMTPTestSocket::rsetCount);
+		VASSERT_EQ("Idle", 1, pool->getIdleConnectionCount());
+		VASSERT_EQ("Active", 0, pool->getActiveConnectionCount());
+
+		pool->disconnect();
+
+		VASSERT_EQ("Idle after disconnect", 0, pool->getIdleConnectionCount());
+		VASSERT_EQ("QUIT", 1, poolSMTPTestSocket::quitCount);
+	}
+
+	void testMaxConnections()
+	{
+		poolSMTPTestSocket::resetCounters();
+
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool = createPool(sess);
+		pool->setMaxConnections(1);
+
+		vmime::shared_ptr <vmime::net::transport> tr1 = pool->acquire();
+		vmime::shared_ptr <vmime::net::transport> tr2 = pool->acquire();
+
+		VASSERT("Different connections", tr1 != tr2);
+		VASSERT_EQ("Connections", 2, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("Active", 2, pool->getActiveConnectionCount());
+
+		pool->release(tr1);
+		pool->release(tr2);
+
+		VASSERT_EQ("Idle", 1, pool->getIdleConnectionCount());
+		VASSERT_EQ("QUIT", 1, poolSMTPTestSocket::quitCount);
+		VASSERT_FALSE("Closed connection", tr2->isConnected());
+	}
+
+	void testHealthCheck()
+	{
+		poolSMTPTestSocket::resetCounters();
+
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool = createPool(sess);
+		pool->setHealthCheckInterval(0);
+
+		pool->send(createMessage());
+		pool->send(createMessage());
+		pool->send(createMessage());
+
+		VASSERT_EQ("Connections", 1, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("NOOP", 2, poolSMTPTestSocket::noopCount);
+	}
+
+	void testIdleTimeout()
+	{
+		poolSMTPTestSocket::resetCounters();
+
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool = createPool(sess);
+		pool->setIdleTimeout(0);
+
+		pool->send(createMessage());
+
+		VASSERT_EQ("Idle", 1, pool->getIdleConnectionCount());
+
+		pool->closeIdleConnections();
+
+		VASSERT_EQ("Idle after close", 0, pool->getIdleConnectionCount());
+		VASSERT_EQ("QUIT", 1, poolSMTPTestSocket::quitCount);
+
+		pool->send(createMessage());
+
+		VASSERT_EQ("Connections", 2, poolSMTPTestSocket::connectionCount);
+	}
+
+	void testSendBatch()
+	{
+		poolSMTPTestSocket::resetCounters();
+
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool = createPool(sess);
+		pool->setMaxConnections(1);
+
+		std::vector <vmime::shared_ptr <vmime::message> > msgs;
+		msgs.push_back(createMessage());
+		msgs.push_back(vmime::make_shared <vmime::message>());  // no expeditor
+		msgs.push_back(createMessage());
+
+		std::vector <vmime::size_t> failed;
+		pool->sendBatch(msgs, &failed);
+
+		VASSERT_EQ("Connections", 1, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("Messages", 2, poolSMTPTestSocket::messageCount);
+		VASSERT_EQ("Failed count", 1, failed.size());
+		VASSERT_EQ("Failed index", 1, failed[0]);
+
+		VASSERT_THROW("Error", pool->sendBatch(msgs), vmime::exceptions::no_expeditor);
+		VASSERT_EQ("Active", 0, pool->getActiveConnectionCount());
+	}
+
+	void testRejectedMessage()
+	{
+		poolSMTPTestSocket::resetCounters();
+
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool = createPool(sess);
+
+		VASSERT_THROW("Rejected", pool->send(createMessage("reject@test.vmime.org")),
+			vmime::exceptions::command_error);
+
+		// The transaction is reset, and the connection is reused
+		VASSERT_EQ("RSET", 1, poolSMTPTestSocket::rsetCount);
+		VASSERT_EQ("Idle", 1, pool->getIdleConnectionCount());
+
+		pool->send(createMessage());
+
+		VASSERT_EQ("Connections", 1, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("Messages", 1, poolSMTPTestSocket::messageCount);
+		VASSERT_EQ("RSET after reuse", 1, poolSMTPTestSocket::rsetCount);
+	}
+
+	void testMessageSizeExceeded()
+	{
+		poolSMTPTestSocket::resetCounters();
+
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool = createPool(sess);
+
+		VASSERT_THROW("Size exceeded", pool->send(createMessage("toobig@test.vmime.org")),
+			vmime::net::smtp::SMTPMessageSizeExceedsMaxLimitsException);
+
+		// The transaction is reset, and the connection is reused
+		VASSERT_EQ("Idle", 1, pool->getIdleConnectionCount());
+
+		pool->send(createMessage());
+
+		VASSERT_EQ("Connections", 1, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("Messages", 1, poolSMTPTestSocket::messageCount);
+	}
+
+	void testClosedIdleConnection()
+	{
+		poolSMTPTestSocket::resetCounters();
+
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool = createPool(sess);
+
+		pool->send(createMessage());
+
+		// The server closes the idle connection: this is only noticed
+		// when the next transaction is started
+		poolSMTPTestSocket::dropOnNextReset = true;
+
+		pool->send(createMessage());
+
+		VASSERT_EQ("Connections", 2, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("Messages", 2, poolSMTPTestSocket::messageCount);
+		VASSERT_EQ("Idle", 1, pool->getIdleConnectionCount());
+		VASSERT_EQ("Active", 0, pool->getActiveConnectionCount());
+
+		// Same in a batch
+		std::vector <vmime::shared_ptr <vmime::message> > msgs;
+		msgs.push_back(createMessage());
+
+		poolSMTPTestSocket::dropOnNextReset = true;
+
+		pool->sendBatch(msgs);
+
+		VASSERT_EQ("Connections (batch)", 3, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("Messages (batch)", 3, poolSMTPTestSocket::messageCount);
+	}
+
+	void testWarmUp()
+	{
+		poolSMTPTestSocket::resetCounters();
+
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool = createPool(sess);
+		pool->setMaxConnections(3);
+
+		pool->warmUp(2);
+
+		VASSERT_EQ("Connections", 2, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("Idle", 2, pool->getIdleConnectionCount());
+		VASSERT_EQ("Active", 0, pool->getActiveConnectionCount());
+
+		// Limited to the maximum number of connections
+		pool->warmUp(10);
+
+		VASSERT_EQ("Connections (max)", 3, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("Idle (max)", 3, pool->getIdleConnectionCount());
+	}
+
+	void testSendBatchParallel()
+	{
+		poolSMTPTestSocket::resetCounters();
+
+		vmime::shared_ptr <vmime::net::session> sess =
+			vmime::make_shared <vmime::net::session>();
+
+		vmime::shared_ptr <vmime::net::transportPool> pool = createPool(sess);
+		pool->setMaxConnections(3);
+		pool->warmUp(3);
+
+		std::vector <vmime::shared_ptr <vmime::message> > msgs;
+
+		for (int i = 0 ; i < 20 ; ++i)
+			msgs.push_back(createMessage(i % 5 == 2 ? "reject@test.vmime.org" : "recipient@test.vmime.org"));
+
+		std::vector <vmime::size_t> failed;
+		pool->sendBatch(msgs, &failed);
+
+		// Not more connections than allowed
+		VASSERT_EQ("Connections", 3, poolSMTPTestSocket::connectionCount);
+		VASSERT_EQ("Messages", 16, poolSMTPTestSocket::messageCount);
+		VASSERT_EQ("Failed count", 4, failed.size());
+
+		for (size_t i = 0 ; i < failed.size() ; ++i)
+			VASSERT_EQ("Failed index", 5 * i + 2, failed[i]);
+
+		VASSERT_EQ("Active", 0, pool->getActiveConnectionCount());
+		VASSERT_EQ("Idle", 3, pool->getIdleConnectionCount());
+	}
+
+VMIME_TEST_SUITE_END
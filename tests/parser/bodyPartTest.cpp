@@ -24,6 +24,33 @@
 #include "tests/testUtils.hpp"
 
 
+// Counts the number of times the contents are read
+class countingContentHandler : public vmime::stringContentHandler
+{
+public:
+
+	countingContentHandler(const vmime::string& buffer)
+		: vmime::stringContentHandler(buffer), m_extractCount(0)
+	{
+	}
+
+	void extract(vmime::utility::outputStream& os, vmime::utility::progressListener* progress = NULL) const
+	{
+		++m_extractCount;
+		vmime::stringContentHandler::extract(os, progress);
+	}
+
+	int getExtractCount() const
+	{
+		return m_extractCount;
+	}
+
+private:
+
+	mutable int m_extractCount;
+};
+
+
 VMIME_TEST_SUITE_BEGIN(bodyPartTest)
 
 	VMIME_TEST_LIST_BEGIN
@@ -36,9 +63,14 @@ VMIME_TEST_SUITE_BEGIN(bodyPartTest)
 		VMIME_TEST(testPrologEncoding)
 		VMIME_TEST(testSuccessiveBoundaries)
 		VMIME_TEST(testTransportPaddingInBoundary)
+		VMIME_TEST(testParseBoundaryAcrossChunks)
 		VMIME_TEST(testGenerate7bit)
 		VMIME_TEST(testTextUsageForQPEncoding)
+		VMIME_TEST(testGenerateTransferEncodingSupport)
+		VMIME_TEST(testGenerateTransferEncodingScannedOnce)
+		VMIME_TEST(testGenerateTransferEncodingSigned)
 		VMIME_TEST(testParseVeryBigMessage)
+		VMIME_TEST(testParseParallel)
 	VMIME_TEST_LIST_END
 
 
@@ -220,6 +252,30 @@ VMIME_TEST_SUITE_BEGIN(bodyPartTest)
 		VASSERT_EQ("part2-body", "", extractContents(p.getBody()->getPartAt(1)->getBody()->getContents()));
 	}
 
+	void testParseBoundaryAcrossChunks()
+	{
+		// Boundaries are searched in chunks: make them straddle the first ones
+		for (size_t size = 4000 ; size < 4200 ; size += 7)
+		{
+			const vmime::string body1(size, 'x');
+
+			vmime::string str =
+				"Content-Type: multipart/mixed; boundary=\"MY-BOUNDARY\""
+				"\r\n\r\n"
+				"--MY-BOUNDARY\r\nHEADER1\r\n\r\n" + body1 + "\r\n"
+				"--MY-BOUNDARY\r\nHEADER2\r\n\r\nBODY2\r\n"
+				"--MY-BOUNDARY--\r\n";
+
+			vmime::bodyPart p;
+			p.parse(str);
+
+			VASSERT_EQ("count", 2, p.getBody()->getPartCount());
+
+			VASSERT_EQ("part1-body", body1, extractContents(p.getBody()->getPartAt(0)->getBody()->getContents()));
+			VASSERT_EQ("part2-body", "BODY2", extractContents(p.getBody()->getPartAt(1)->getBody()->getContents()));
+		}
+	}
+
 	/** Ensure '7bit' encoding is used when body is 7-bit only. */
 	void testGenerate7bit()
 	{
@@ -233,6 +289,127 @@ VMIME_TEST_SUITE_BEGIN(bodyPartTest)
 		VASSERT_EQ("1", "7bit", header1->ContentTransferEncoding()->getValue()->generate());
 	}
 
+	static const vmime::string generateWithContext
+		(const vmime::component& comp, const vmime::generationContext& ctx)
+	{
+		std::ostringstream oss;
+		vmime::utility::outputStreamAdapter os(oss);
+
+		comp.generate(ctx, os);
+
+		return oss.str();
+	}
+
+	void testGenerateTransferEncodingSupport()
+	{
+		vmime::bodyPart p1;
+		p1.getHeader()->ContentType()->setValue(vmime::mediaType("text/plain"));
+		p1.getBody()->setContents(vmime::make_shared <vmime::stringContentHandler>("caf\xc3\xa9"));
+		p1.getBody()->setEncoding(vmime::encoding(vmime::encodingTypes::QUOTED_PRINTABLE));
+
+		vmime::bodyPart p2;
+		p2.getHeader()->ContentType()->setValue(vmime::mediaType("application/octet-stream"));
+		p2.getBody()->setContents(vmime::make_shared <vmime::stringContentHandler>(vmime::string("\x01\x02\x00\x03", 4)));
+		p2.getBody()->setEncoding(vmime::encoding(vmime::encodingTypes::BASE64));
+
+		vmime::generationContext ctx;
+
+		VASSERT_EQ("7bit-1", "Content-Type: text/plain\r\nContent-Transfer-Encoding: "
+			"quoted-printable\r\n\r\ncaf=C3=A9", generateWithContext(p1, ctx));
+		VASSERT_EQ("7bit-2", "AQIAAw==", generateWithContext(*p2.getBody(), ctx));
+
+		ctx.setTransferEncodingSupport(vmime::generationContext::TRANSFER_8BIT);
+
+		VASSERT_EQ("8bit-1", "Content-Type: text/plain\r\nContent-Transfer-Encoding: "
+			"8bit\r\n\r\ncaf\xc3\xa9", generateWithContext(p1, ctx));
+		VASSERT_EQ("8bit-2", "AQIAAw==", generateWithContext(*p2.getBody(), ctx));
+
+		// Bare CR or LF cannot be sent as 8bit (RFC-6152)
+		vmime::bodyPart p3;
+		p3.getHeader()->ContentType()->setValue(vmime::mediaType("text/plain"));
+		p3.getBody()->setEncoding(vmime::encoding(vmime::encodingTypes::QUOTED_PRINTABLE));
+
+		p3.getBody()->setContents(vmime::make_shared <vmime::stringContentHandler>("caf\xc3\xa9\r\nline 2\r\n"));
+		VASSERT_EQ("8bit-3", "8bit", p3.getBody()->getGeneratedEncoding(ctx).generate());
+
+		p3.getBody()->setContents(vmime::make_shared <vmime::stringContentHandler>("caf\xc3\xa9\nline 2"));
+		VASSERT_EQ("8bit-4", "quoted-printable", p3.getBody()->getGeneratedEncoding(ctx).generate());
+
+		p3.getBody()->setContents(vmime::make_shared <vmime::stringContentHandler>("caf\xc3\xa9\rline 2"));
+		VASSERT_EQ("8bit-5", "quoted-printable", p3.getBody()->getGeneratedEncoding(ctx).generate());
+
+		p3.getBody()->setContents(vmime::make_shared <vmime::stringContentHandler>("caf\xc3\xa9\r"));
+		VASSERT_EQ("8bit-6", "quoted-printable", p3.getBody()->getGeneratedEncoding(ctx).generate());
+
+		ctx.setTransferEncodingSupport(vmime::generationContext::TRANSFER_BINARY);
+
+		VASSERT_EQ("binary-1", "binary", p2.getBody()->getGeneratedEncoding(ctx).generate());
+		VASSERT_EQ("binary-2", vmime::string("\x01\x02\x00\x03", 4), generateWithContext(*p2.getBody(), ctx));
+
+		// Part itself must not be modified
+		VASSERT_EQ("Not modified", "base64",
+			p2.getHeader()->ContentTransferEncoding()->getValue()->generate());
+	}
+
+	void testGenerateTransferEncodingScannedOnce()
+	{
+		vmime::shared_ptr <countingContentHandler> contents =
+			vmime::make_shared <countingContentHandler>("caf\xc3\xa9\r\n");
+
+		vmime::bodyPart p;
+		p.getHeader()->ContentType()->setValue(vmime::mediaType("text/plain"));
+		p.getBody()->setContents(contents);
+		p.getBody()->setEncoding(vmime::encoding(vmime::encodingTypes::QUOTED_PRINTABLE));
+
+		vmime::generationContext ctx;
+		ctx.setTransferEncodingSupport(vmime::generationContext::TRANSFER_8BIT);
+
+		p.getGeneratedSize(ctx);
+		generateWithContext(p, ctx);
+
+		VASSERT_EQ("Scanned once", 1, contents->getExtractCount());
+
+		// New contents are scanned again
+		p.getBody()->setContents(vmime::make_shared <vmime::stringContentHandler>("caf\xc3\xa9\n"));
+
+		VASSERT_EQ("New contents", "quoted-printable", p.getBody()->getGeneratedEncoding(ctx).generate());
+	}
+
+	void testGenerateTransferEncodingSigned()
+	{
+		vmime::bodyPart signedPart;
+		signedPart.getHeader()->ContentType()->setValue(vmime::mediaType("multipart/signed"));
+
+		vmime::shared_ptr <vmime::bodyPart> textPart = vmime::make_shared <vmime::bodyPart>();
+		textPart->getHeader()->ContentType()->setValue(vmime::mediaType("text/plain"));
+		textPart->getBody()->setContents(vmime::make_shared <vmime::stringContentHandler>("caf\xc3\xa9"));
+		textPart->getBody()->setEncoding(vmime::encoding(vmime::encodingTypes::QUOTED_PRINTABLE));
+
+		vmime::shared_ptr <vmime::bodyPart> sigPart = vmime::make_shared <vmime::bodyPart>();
+		sigPart->getHeader()->ContentType()->setValue(vmime::mediaType("application/pgp-signature"));
+		sigPart->getBody()->setContents(vmime::make_shared <vmime::stringContentHandler>("signature"));
+		sigPart->getBody()->setEncoding(vmime::encoding(vmime::encodingTypes::BASE64));
+
+		signedPart.getBody()->appendPart(textPart);
+		signedPart.getBody()->appendPart(sigPart);
+
+		vmime::generationContext ctx;
+		ctx.setTransferEncodingSupport(vmime::generationContext::TRANSFER_BINARY);
+
+		// Signed parts are generated unchanged, even when nested
+		VASSERT_EQ("Text", "quoted-printable", textPart->getBody()->getGeneratedEncoding(ctx).generate());
+		VASSERT_EQ("Signature", "base64", sigPart->getBody()->getGeneratedEncoding(ctx).generate());
+
+		vmime::bodyPart mixedPart;
+		mixedPart.getHeader()->ContentType()->setValue(vmime::mediaType("multipart/mixed"));
+		mixedPart.getBody()->appendPart(vmime::clone(signedPart));
+
+		vmime::shared_ptr <vmime::bodyPart> nestedText =
+			mixedPart.getBody()->getPartAt(0)->getBody()->getPartAt(0);
+
+		VASSERT_EQ("Nested", "quoted-printable", nestedText->getBody()->getGeneratedEncoding(ctx).generate());
+	}
+
 	void testTextUsageForQPEncoding()
 	{
 		vmime::shared_ptr <vmime::plainTextPart> part = vmime::make_shared <vmime::plainTextPart>();
@@ -365,5 +542,73 @@ VMIME_TEST_SUITE_BEGIN(bodyPartTest)
 		VASSERT("2.2", vmime::dynamicCast <const vmime::streamContentHandler>(body2Cts) != NULL);
 	}
 
+	void testParseParallel()
+	{
+		std::ostringstream oss;
+		oss << "Content-Type: multipart/mixed; boundary=\"LEVEL1\"\r\n"
+		    << "\r\n"
+		    << "PROLOG\r\n";
+
+		for (unsigned int i = 0 ; i < 10 ; ++i)
+		{
+			oss << "--LEVEL1\r\n";
+
+			if (i == 5)
+			{
+				oss << "Content-Type: multipart/alternative; boundary=\"LEVEL2\"\r\n"
+				    << "\r\n"
+				    << "--LEVEL2\r\n"
+				    << "HEADER-A\r\n"
+				    << "\r\n"
+				    << "BODY-A\r\n"
+				    << "--LEVEL2\r\n"
+				    << "HEADER-B\r\n"
+				    << "\r\n"
+				    << "BODY-B\r\n"
+				    << "--LEVEL2--\r\n";
+			}
+			else
+			{
+				oss << "X-Part: " << i << "\r\n"
+				    << "\r\n"
+				    << "BODY" << i << "\r\n";
+			}
+		}
+
+		oss << "--LEVEL1--\r\n"
+		    << "EPILOG";
+
+		const vmime::string str = oss.str();
+
+		vmime::bodyPart serial;
+		serial.parse(str);
+
+		vmime::parsingContext ctx;
+		ctx.setParallelParsingThreadCount(4);
+		ctx.setParallelParsingThreshold(0);
+
+		vmime::bodyPart parallel;
+		parallel.parse(ctx, str);
+
+		VASSERT_EQ("count", 10, parallel.getBody()->getPartCount());
+		VASSERT_EQ("generate", serial.generate(), parallel.generate());
+
+		for (size_t i = 0 ; i < 10 ; ++i)
+		{
+			vmime::shared_ptr <vmime::bodyPart> part1 = serial.getBody()->getPartAt(i);
+			vmime::shared_ptr <vmime::bodyPart> part2 = parallel.getBody()->getPartAt(i);
+
+			VASSERT_EQ("offset", part1->getParsedOffset(), part2->getParsedOffset());
+			VASSERT_EQ("length", part1->getParsedLength(), part2->getParsedLength());
+			VASSERT_EQ("body-offset", part1->getBody()->getParsedOffset(), part2->getBody()->getParsedOffset());
+		}
+
+		vmime::shared_ptr <vmime::body> nested = parallel.getBody()->getPartAt(5)->getBody();
+
+		VASSERT_EQ("nested-count", 2, nested->getPartCount());
+		VASSERT_EQ("nested-body", "BODY-B", extractComponentString(str, *nested->getPartAt(1)->getBody()));
+		VASSERT_EQ("body", "BODY3", extractContents(parallel.getBody()->getPartAt(3)->getBody()->getContents()));
+	}
+
 VMIME_TEST_SUITE_END
 
@@ -0,0 +1,228 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/utility/outputStreamAdapter.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(cachedContentHandlerTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testContentHash)
+		VMIME_TEST(testGenerate)
+		VMIME_TEST(testGenerate_Parameters)
+		VMIME_TEST(testGenerate_MemoryLimit)
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+		VMIME_TEST(testGenerate_Spill)
+		VMIME_TEST(testGenerate_SpillError)
+#endif
+		VMIME_TEST(testGeneratedSize)
+	VMIME_TEST_LIST_END
+
+
+	static const vmime::string generate
+		(const vmime::contentHandler& cth, const vmime::string& enc, const size_t maxLineLength)
+	{
+		std::ostringstream oss;
+		vmime::utility::outputStreamAdapter osa(oss);
+
+		cth.generate(osa, vmime::encoding(enc), maxLineLength);
+
+		return oss.str();
+	}
+
+
+	void testContentHash()
+	{
+		vmime::shared_ptr <vmime::encodedContentCache> cache =
+			vmime::make_shared <vmime::encodedContentCache>();
+
+		vmime::cachedContentHandler cth1
+			(vmime::make_shared <vmime::stringContentHandler>("Test Data"), cache);
+		vmime::cachedContentHandler cth2
+			(vmime::make_shared <vmime::stringContentHandler>("Test Data"), cache);
+		vmime::cachedContentHandler cth3
+			(vmime::make_shared <vmime::stringContentHandler>("Other Data"), cache);
+
+		VASSERT_EQ("1", 40, cth1.getContentHash().length());
+		VASSERT_EQ("2", cth1.getContentHash(), cth2.getContentHash());
+		VASSERT("3", cth1.getContentHash() != cth3.getContentHash());
+	}
+
+	void testGenerate()
+	{
+		vmime::shared_ptr <vmime::encodedContentCache> cache =
+			vmime::make_shared <vmime::encodedContentCache>();
+
+		vmime::stringContentHandler ref("Test Data");
+
+		vmime::cachedContentHandler cth1
+			(vmime::make_shared <vmime::stringContentHandler>("Test Data"), cache);
+		vmime::cachedContentHandler cth2
+			(vmime::make_shared <vmime::stringContentHandler>("Test Data"), cache);
+
+		VASSERT_EQ("1", generate(ref, "base64", 76), generate(cth1, "base64", 76));
+		VASSERT_EQ("2", 1, cache->getEntryCount());
+		VASSERT_EQ("3", 1, cache->getMissCount());
+		VASSERT_EQ("4", 0, cache->getHitCount());
+
+		// Same contents, from another handler
+		VASSERT_EQ("5", generate(ref, "base64", 76), generate(cth2, "base64", 76));
+		VASSERT_EQ("6", 1, cache->getEntryCount());
+		VASSERT_EQ("7", 1, cache->getHitCount());
+	}
+
+	void testGenerate_Parameters()
+	{
+		vmime::shared_ptr <vmime::encodedContentCache> cache =
+			vmime::make_shared <vmime::encodedContentCache>();
+
+		const vmime::string data(200, 'x');
+
+		vmime::stringContentHandler ref(data);
+		vmime::cachedContentHandler cth(vmime::make_shared <vmime::stringContentHandler>(data), cache);
+
+		VASSERT_EQ("1", generate(ref, "base64", 76), generate(cth, "base64", 76));
+		VASSERT_EQ("2", generate(ref, "base64", 40), generate(cth, "base64", 40));
+		VASSERT_EQ("3", generate(ref, "quoted-printable", 76), generate(cth, "quoted-printable", 76));
+
+		VASSERT_EQ("4", 3, cache->getEntryCount());
+		VASSERT_EQ("5", 0, cache->getHitCount());
+	}
+
+	void testGenerate_MemoryLimit()
+	{
+		vmime::shared_ptr <vmime::encodedContentCache> cache =
+			vmime::make_shared <vmime::encodedContentCache>(10);
+
+		vmime::stringContentHandler ref("Test Data Test Data");
+		vmime::cachedContentHandler cth
+			(vmime::make_shared <vmime::stringContentHandler>("Test Data Test Data"), cache);
+
+		// Data does not fit in cache: it should still be generated
+		VASSERT_EQ("1", generate(ref, "base64", 76), generate(cth, "base64", 76));
+		VASSERT_EQ("2", 0, cache->getEntryCount());
+		VASSERT_EQ("3", 0, cache->getMemorySize());
+	}
+
+#if VMIME_HAVE_FILESYSTEM_FEATURES
+
+	void testGenerate_Spill()
+	{
+		vmime::shared_ptr <vmime::utility::fileSystemFactory> fsf =
+			vmime::platform::getHandler()->getFileSystemFactory();
+
+		std::ostringstream dirPath;
+		dirPath << "/tmp/vmime_test_" << (rand() % 999999999);
+
+		const vmime::utility::file::path dir = fsf->stringToPath(dirPath.str());
+
+		fsf->create(dir)->createDirectory();
+
+		{
+			vmime::shared_ptr <vmime::encodedContentCache> cache =
+				vmime::make_shared <vmime::encodedContentCache>(10);
+			cache->setSpillDirectory(dir);
+
+			vmime::stringContentHandler ref1("Test Data Test Data");
+			vmime::stringContentHandler ref2("Other Data Other Data");
+			vmime::cachedContentHandler cth1
+				(vmime::make_shared <vmime::stringContentHandler>("Test Data Test Data"), cache);
+			vmime::cachedContentHandler cth2
+				(vmime::make_shared <vmime::stringContentHandler>("Other Data Other Data"), cache);
+
+			VASSERT_EQ("1", generate(ref1, "base64", 76), generate(cth1, "base64", 76));
+			VASSERT_EQ("2", generate(ref2, "base64", 76), generate(cth2, "base64", 76));
+			VASSERT_EQ("3", 2, cache->getEntryCount());
+			VASSERT_EQ("4", 0, cache->getMemorySize());
+
+			// Data is read back from the spill files
+			VASSERT_EQ("5", generate(ref1, "base64", 76), generate(cth1, "base64", 76));
+			VASSERT_EQ("6", generate(ref2, "base64", 76), generate(cth2, "base64", 76));
+			VASSERT_EQ("7", 2, cache->getHitCount());
+		}
+
+		// Spill files are removed with the cache
+		fsf->create(dir)->remove();
+	}
+
+	void testGenerate_SpillError()
+	{
+		vmime::shared_ptr <vmime::utility::fileSystemFactory> fsf =
+			vmime::platform::getHandler()->getFileSystemFactory();
+
+		std::ostringstream dirPath;
+		dirPath << "/tmp/vmime_test_" << (rand() % 999999999);
+
+		const vmime::utility::file::path dir = fsf->stringToPath(dirPath.str());
+
+		vmime::shared_ptr <vmime::encodedContentCache> cache =
+			vmime::make_shared <vmime::encodedContentCache>(10);
+		cache->setSpillDirectory(dir);  // does not exist
+
+		vmime::stringContentHandler ref("Test Data Test Data");
+		vmime::cachedContentHandler cth
+			(vmime::make_shared <vmime::stringContentHandler>("Test Data Test Data"), cache);
+
+		// Data cannot be spilled: it should still be generated
+		VASSERT_EQ("1", generate(ref, "base64", 76), generate(cth, "base64", 76));
+		VASSERT_EQ("2", 0, cache->getEntryCount());
+	}
+
+#endif // VMIME_HAVE_FILESYSTEM_FEATURES
+
+	void testGeneratedSize()
+	{
+		vmime::shared_ptr <vmime::encodedContentCache> cache =
+			vmime::make_shared <vmime::encodedContentCache>();
+
+		vmime::shared_ptr <vmime::bodyPart> part = vmime::make_shared <vmime::bodyPart>();
+		vmime::shared_ptr <vmime::body> body = part->getBody();
+
+		body->setContents(vmime::make_shared <vmime::cachedContentHandler>
+			(vmime::make_shared <vmime::stringContentHandler>(vmime::string(1000, 'x')), cache),
+			 vmime::mediaType("application/octet-stream"), vmime::charset("us-ascii"),
+			 vmime::encoding("base64"));
+
+		vmime::generationContext ctx;
+
+		std::ostringstream oss1;
+		vmime::utility::outputStreamAdapter osa1(oss1);
+		body->generate(ctx, osa1);
+
+		std::ostringstream oss2;
+		vmime::utility::outputStreamAdapter osa2(oss2);
+		body->generate(ctx, osa2);
+
+		const vmime::string gen1 = oss1.str();
+		const vmime::string gen2 = oss2.str();
+
+		VASSERT_EQ("1", gen1, gen2);
+		VASSERT_EQ("2", 1, cache->getHitCount());
+
+		// Size is exact once encoded data is in the cache
+		VASSERT_EQ("3", gen1.length(), body->getGeneratedSize(ctx));
+	}
+
+VMIME_TEST_SUITE_END
@@ -61,6 +61,8 @@ VMIME_TEST_SUITE_BEGIN(headerTest)
 		VMIME_TEST(testFindAllFields1)
 		VMIME_TEST(testFindAllFields2)
 		VMIME_TEST(testFindAllFields3)
+
+		VMIME_TEST(testParseFieldFilter)
 	VMIME_TEST_LIST_END
 
 
@@ -372,5 +374,27 @@ VMIME_TEST_SUITE_BEGIN(headerTest)
 		VASSERT_EQ("Second value", "C: c2", headerTest::getFieldValue(*res[2]));
 	}
 
+	void testParseFieldFilter()
+	{
+		std::vector <vmime::string> fields;
+		fields.push_back("Subject");
+		fields.push_back("message-id");
+
+		vmime::parsingContext ctx;
+		ctx.setHeaderFieldFilter(fields);
+
+		vmime::header hdr;
+		hdr.parse(ctx, "From: me@vmime.org\r\nSubject: Test\r\n"
+			"Received: from a\r\n by b\r\nMessage-Id: <id@vmime.org>\r\n\r\n");
+
+		VASSERT_EQ("Count", 2, hdr.getFieldCount());
+		VASSERT_EQ("Field 1", "Subject: Test", headerTest::getFieldValue(*hdr.getFieldAt(0)));
+		VASSERT_EQ("Field 2", "Message-Id: <id@vmime.org>", headerTest::getFieldValue(*hdr.getFieldAt(1)));
+
+		VASSERT_TRUE("Selected", ctx.isHeaderFieldSelected("SUBJECT"));
+		VASSERT_FALSE("Not selected", ctx.isHeaderFieldSelected("Subjec"));
+		VASSERT_TRUE("No filter", vmime::parsingContext().isHeaderFieldSelected("Received"));
+	}
+
 VMIME_TEST_SUITE_END
 
@@ -31,6 +31,7 @@ VMIME_TEST_SUITE_BEGIN(htmlTextPartTest)
 		VMIME_TEST(testParseText)
 		VMIME_TEST(testParseEmbeddedObjectsCID)
 		VMIME_TEST(testParseEmbeddedObjectsLocation)
+		VMIME_TEST(testParseEmbeddedObjectsReferences)
 	VMIME_TEST_LIST_END
 
 
@@ -231,6 +232,67 @@ VMIME_TEST_SUITE_BEGIN(htmlTextPartTest)
 		VASSERT_EQ("type-obj", "image/png", obj->getType().generate());
 	}
 
+	/** Test the forms of references to embedded objects.
+	  */
+	void testParseEmbeddedObjectsReferences()
+	{
+		const vmime::string msgString = ""
+"MIME-Version: 1.0\r\n"
+"Content-Type: multipart/related; boundary=\"LEVEL1\"\r\n"
+"\r\n"
+"--LEVEL1\r\n"
+"Content-Type: text/html\r\n"
+"\r\n"
+"<img src=cid:image1@test>\r\n"
+"<div style=\"background: url(Cid:image2@test)\"></div>\r\n"
+"<img src='cid:image%33@test'/>\r\n"
+"<img src=\"cid:image40@test\"/>\r\n"
+"<a href=image5.png>image5.png</a>\r\n"
+"--LEVEL1\r\n"
+"Content-Type: image/png\r\n"
+"Content-ID: <image1@test>\r\n"
+"\r\n"
+"Image1\r\n"
+"--LEVEL1\r\n"
+"Content-Type: image/png\r\n"
+"Content-ID: <image2@test>\r\n"
+"\r\n"
+"Image2\r\n"
+"--LEVEL1\r\n"
+"Content-Type: image/png\r\n"
+"Content-ID: <image3@test>\r\n"
+"\r\n"
+"Image3\r\n"
+"--LEVEL1\r\n"
+"Content-Type: image/png\r\n"
+"Content-ID: <image4@test>\r\n"
+"\r\n"
+"Image4\r\n"
+"--LEVEL1\r\n"
+"Content-Type: image/png\r\n"
+"Content-Location: image5.png\r\n"
+"\r\n"
+"Image5\r\n"
+"--LEVEL1--\r\n"
+"";
+
+		vmime::shared_ptr <vmime::message> msg = vmime::make_shared <vmime::message>();
+		msg->parse(msgString);
+
+		VASSERT_EQ("part-count", 6, msg->getBody()->getPartCount());
+
+		vmime::htmlTextPart htmlPart;
+		htmlPart.parse(msg, msg, msg->getBody()->getPartAt(0));
+
+		VASSERT_EQ("count", 4, htmlPart.getObjectCount());
+
+		VASSERT_EQ("unquoted", true, htmlPart.hasObject("image1@test"));
+		VASSERT_EQ("css-url", true, htmlPart.hasObject("image2@test"));
+		VASSERT_EQ("url-encoded", true, htmlPart.hasObject("image3@test"));
+		VASSERT_EQ("not-referenced", false, htmlPart.hasObject("image4@test"));
+		VASSERT_EQ("location", true, htmlPart.hasObject("image5.png"));
+	}
+
 	// TODO: test generation of text parts
 
 VMIME_TEST_SUITE_END
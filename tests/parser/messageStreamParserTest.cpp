@@ -0,0 +1,318 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/messageStreamParser.hpp"
+
+
+// Forward-only stream which returns data in small chunks
+class chunkedInputStream : public vmime::utility::inputStream
+{
+public:
+
+	chunkedInputStream(const vmime::string& data, const size_t chunkSize)
+		: m_data(data), m_chunkSize(chunkSize), m_pos(0)
+	{
+	}
+
+	bool eof() const
+	{
+		return m_pos >= m_data.length();
+	}
+
+	void reset()
+	{
+		m_pos = 0;
+	}
+
+	size_t read(vmime::byte_t* const data, const size_t count)
+	{
+		const size_t n = std::min(std::min(count, m_chunkSize), m_data.length() - m_pos);
+
+		std::copy(m_data.begin() + m_pos, m_data.begin() + m_pos + n, data);
+		m_pos += n;
+
+		return n;
+	}
+
+	size_t skip(const size_t count)
+	{
+		const size_t n = std::min(count, m_data.length() - m_pos);
+		m_pos += n;
+
+		return n;
+	}
+
+private:
+
+	const vmime::string m_data;
+	const size_t m_chunkSize;
+	size_t m_pos;
+};
+
+
+// Records parsing events in a string
+class eventRecorder : public vmime::messageStreamHandler
+{
+public:
+
+	eventRecorder()
+		: m_maxChunkSize(0)
+	{
+	}
+
+	void onPartBegin(const vmime::mediaType& type)
+	{
+		flushBody();
+		m_events << "begin(" << type.generate() << ")\n";
+	}
+
+	void onHeaderField(const vmime::string& name, const vmime::string& rawValue)
+	{
+		m_events << "field(" << name << "=" << rawValue << ")\n";
+	}
+
+	void onBodyChunk(const vmime::byte_t* data, const size_t count)
+	{
+		m_body.append(reinterpret_cast <const char*>(data), count);
+		m_maxChunkSize = std::max(m_maxChunkSize, count);
+	}
+
+	void onPartEnd()
+	{
+		flushBody();
+		m_events << "end\n";
+	}
+
+	const vmime::string getEvents() const
+	{
+		return m_events.str();
+	}
+
+	size_t getMaxChunkSize() const
+	{
+		return m_maxChunkSize;
+	}
+
+private:
+
+	void flushBody()
+	{
+		if (!m_body.empty())
+		{
+			m_events << "body(" << m_body << ")\n";
+			m_body.clear();
+		}
+	}
+
+	std::ostringstream m_events;
+	vmime::string m_body;
+	size_t m_maxChunkSize;
+};
+
+
+VMIME_TEST_SUITE_BEGIN(messageStreamParserTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testSimpleMessage)
+		VMIME_TEST(testMultipart)
+		VMIME_TEST(testMissingLastBoundary)
+		VMIME_TEST(testEmptyParts)
+		VMIME_TEST(testLargeBody)
+	VMIME_TEST_LIST_END
+
+
+	static const vmime::string parse(const vmime::string& data, const size_t chunkSize = 3)
+	{
+		vmime::shared_ptr <eventRecorder> rec = vmime::make_shared <eventRecorder>();
+
+		chunkedInputStream is(data, chunkSize);
+
+		vmime::messageStreamParser parser(rec);
+		parser.parse(is);
+
+		return rec->getEvents();
+	}
+
+
+	void testSimpleMessage()
+	{
+		const vmime::string msg =
+			"From: me@vmime.org\r\n"
+			"Subject: Hello\r\n"
+			" world\r\n"
+			"\r\n"
+			"Line 1\r\n"
+			"Line 2\r\n";
+
+		VASSERT_EQ("1",
+			"begin(text/plain)\n"
+			"field(From=me@vmime.org)\n"
+			"field(Subject=Hello\r\n world)\n"
+			"body(Line 1\r\nLine 2\r\n)\n"
+			"end\n", parse(msg));
+
+		VASSERT_EQ("2",
+			"begin(text/plain)\n"
+			"field(Subject=Hello)\n"
+			"body(Body)\n"
+			"end\n", parse("Subject: Hello\n\nBody"));
+
+		VASSERT_EQ("3",
+			"begin(text/plain)\n"
+			"body(Body)\n"
+			"end\n", parse("\r\nBody"));
+	}
+
+	void testMultipart()
+	{
+		const vmime::string msg =
+			"Content-Type: multipart/mixed; boundary=\"LEVEL1\"\r\n"
+			"\r\n"
+			"Prolog\r\n"
+			"--LEVEL1\r\n"
+			"Content-Type: multipart/alternative; boundary=LEVEL2\r\n"
+			"\r\n"
+			"--LEVEL2\r\n"
+			"\r\n"
+			"Plain text\r\n"
+			"--LEVEL2\r\n"
+			"Content-Type: text/html\r\n"
+			"\r\n"
+			"<b>HTML</b>\r\n"
+			"--LEVEL2--\r\n"
+			"-- \tLEVEL1\r\n"
+			"Content-Type: multipart/digest; boundary=LEVEL3\r\n"
+			"\r\n"
+			"--LEVEL3\r\n"
+			"\r\n"
+			"Subject: Digest\r\n"
+			"--LEVEL3--\r\n"
+			"Epilog\r\n"
+			"--LEVEL1--\r\n"
+			"Epilog\r\n";
+
+		VASSERT_EQ("1",
+			"begin(multipart/mixed)\n"
+			"field(Content-Type=multipart/mixed; boundary=\"LEVEL1\")\n"
+			"begin(multipart/alternative)\n"
+			"field(Content-Type=multipart/alternative; boundary=LEVEL2)\n"
+			"begin(text/plain)\n"
+			"body(Plain text)\n"
+			"end\n"
+			"begin(text/html)\n"
+			"field(Content-Type=text/html)\n"
+			"body(<b>HTML</b>)\n"
+			"end\n"
+			"end\n"
+			"begin(multipart/digest)\n"
+			"field(Content-Type=multipart/digest; boundary=LEVEL3)\n"
+			"begin(message/rfc822)\n"
+			"body(Subject: Digest)\n"
+			"end\n"
+			"end\n"
+			"end\n", parse(msg));
+
+		// Result should not depend on how data is read
+		VASSERT_EQ("2", parse(msg, 1), parse(msg, 1000));
+	}
+
+	void testMissingLastBoundary()
+	{
+		const vmime::string msg =
+			"Content-Type: multipart/mixed; boundary=\"MY-BOUNDARY\"\r\n"
+			"\r\n"
+			"--MY-BOUNDARY\r\nHEADER1: 1\r\n\r\nBODY1\r\n"
+			"--MY-BOUNDARY\r\nHEADER2: 2\r\n\r\nBODY2";
+
+		VASSERT_EQ("1",
+			"begin(multipart/mixed)\n"
+			"field(Content-Type=multipart/mixed; boundary=\"MY-BOUNDARY\")\n"
+			"begin(text/plain)\n"
+			"field(HEADER1=1)\n"
+			"body(BODY1)\n"
+			"end\n"
+			"begin(text/plain)\n"
+			"field(HEADER2=2)\n"
+			"body(BODY2)\n"
+			"end\n"
+			"end\n", parse(msg));
+	}
+
+	void testEmptyParts()
+	{
+		const vmime::string msg =
+			"Content-Type: multipart/mixed; boundary=\"B\"\r\n"
+			"\r\n"
+			"--B\r\n"
+			"--B\r\n"
+			"X-Header: 1\r\n"
+			"--B--\r\n";
+
+		VASSERT_EQ("1",
+			"begin(multipart/mixed)\n"
+			"field(Content-Type=multipart/mixed; boundary=\"B\")\n"
+			"begin(text/plain)\n"
+			"end\n"
+			"begin(text/plain)\n"
+			"field(X-Header=1)\n"
+			"end\n"
+			"end\n", parse(msg));
+	}
+
+	void testLargeBody()
+	{
+		std::ostringstream body;
+
+		for (unsigned int i = 0 ; i < 100000 ; ++i)
+			body << "Line " << i << "\r\n";
+
+		std::ostringstream oss;
+		oss << "Content-Type: multipart/mixed; boundary=\"B\"\r\n"
+		    << "\r\n"
+		    << "--B\r\n"
+		    << "\r\n"
+		    << body.str() << "\r\n"
+		    << "--B--\r\n";
+
+		vmime::shared_ptr <eventRecorder> rec = vmime::make_shared <eventRecorder>();
+
+		vmime::utility::inputStreamStringAdapter is(oss.str());
+
+		vmime::messageStreamParser parser(rec);
+		parser.parse(is);
+
+		VASSERT_EQ("events",
+			"begin(multipart/mixed)\n"
+			"field(Content-Type=multipart/mixed; boundary=\"B\")\n"
+			"begin(text/plain)\n"
+			"body(" + body.str() + ")\n"
+			"end\n"
+			"end\n", rec->getEvents());
+
+		// Body is not buffered entirely
+		VASSERT("chunk-size", rec->getMaxChunkSize() < 100000);
+	}
+
+VMIME_TEST_SUITE_END
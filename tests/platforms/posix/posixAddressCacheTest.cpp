@@ -0,0 +1,226 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2014 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/platforms/posix/posixAddressCache.hpp"
+#include "vmime/platforms/posix/posixSocket.hpp"
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <string.h>
+
+
+using vmime::platforms::posix::posixAddressCache;
+using vmime::platforms::posix::posixSocket;
+using vmime::platforms::posix::posixSocketFactory;
+
+
+VMIME_TEST_SUITE_BEGIN(posixAddressCacheTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testResolveNumeric)
+		VMIME_TEST(testResolveCached)
+		VMIME_TEST(testExpiry)
+		VMIME_TEST(testInvalidate)
+		VMIME_TEST(testFactoryOptions)
+		VMIME_TEST(testHappyEyeballsConnect)
+		VMIME_TEST(testHappyEyeballsConnectFailure)
+	VMIME_TEST_LIST_END
+
+
+	int m_listenDesc;
+	vmime::port_t m_port;
+
+
+	void setUp()
+	{
+		m_listenDesc = ::socket(AF_INET, SOCK_STREAM, 0);
+
+		::sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+
+		::bind(m_listenDesc, reinterpret_cast <sockaddr*>(&addr), sizeof(addr));
+		::listen(m_listenDesc, 5);
+
+		socklen_t len = sizeof(addr);
+		::getsockname(m_listenDesc, reinterpret_cast <sockaddr*>(&addr), &len);
+
+		m_port = ntohs(addr.sin_port);
+	}
+
+	void tearDown()
+	{
+		::close(m_listenDesc);
+	}
+
+
+	void testResolveNumeric()
+	{
+		std::vector <posixAddressCache::address> addresses;
+		posixAddressCache::resolveUncached("127.0.0.1", 143, addresses);
+
+		VASSERT_EQ("count", 1, addresses.size());
+		VASSERT_EQ("family", AF_INET, addresses[0].family);
+
+		const sockaddr_in* sin = reinterpret_cast <const sockaddr_in*>(&addresses[0].storage);
+
+		VASSERT_EQ("port", 143, ntohs(sin->sin_port));
+		VASSERT_EQ("addr", htonl(INADDR_LOOPBACK), sin->sin_addr.s_addr);
+	}
+
+	void testResolveCached()
+	{
+		posixAddressCache cache;
+		std::vector <posixAddressCache::address> addresses;
+
+		cache.resolve("127.0.0.1", 143, addresses);
+
+		VASSERT_EQ("1.hits", 0, cache.getHitCount());
+		VASSERT_EQ("1.misses", 1, cache.getMissCount());
+		VASSERT_EQ("1.entries", 1, cache.getEntryCount());
+
+		addresses.clear();
+		cache.resolve("127.0.0.1", 143, addresses);
+
+		VASSERT_EQ("2.hits", 1, cache.getHitCount());
+		VASSERT_EQ("2.misses", 1, cache.getMissCount());
+		VASSERT_EQ("2.count", 1, addresses.size());
+
+		// Port is part of the key
+		cache.resolve("127.0.0.1", 993, addresses);
+
+		VASSERT_EQ("3.misses", 2, cache.getMissCount());
+		VASSERT_EQ("3.entries", 2, cache.getEntryCount());
+
+		cache.clear();
+
+		VASSERT_EQ("4.entries", 0, cache.getEntryCount());
+	}
+
+	void testExpiry()
+	{
+		posixAddressCache cache(/* ttl */ 0);
+		std::vector <posixAddressCache::address> addresses;
+
+		cache.resolve("127.0.0.1", 143, addresses);
+		cache.resolve("127.0.0.1", 143, addresses);
+
+		VASSERT_EQ("hits", 0, cache.getHitCount());
+		VASSERT_EQ("misses", 2, cache.getMissCount());
+		VASSERT_EQ("entries", 1, cache.getEntryCount());
+	}
+
+	void testInvalidate()
+	{
+		posixAddressCache cache;
+		std::vector <posixAddressCache::address> addresses;
+
+		cache.resolve("127.0.0.1", 143, addresses);
+		cache.invalidate("127.0.0.1", 143);
+
+		VASSERT_EQ("entries", 0, cache.getEntryCount());
+
+		cache.resolve("127.0.0.1", 143, addresses);
+
+		VASSERT_EQ("misses", 2, cache.getMissCount());
+	}
+
+	void testFactoryOptions()
+	{
+		vmime::shared_ptr <posixAddressCache> cache = vmime::make_shared <posixAddressCache>();
+
+		posixSocketFactory factory;
+
+		VASSERT_FALSE("default", factory.isHappyEyeballsEnabled());
+
+		factory.setAddressCache(cache);
+		factory.setHappyEyeballsEnabled(true);
+
+		vmime::shared_ptr <posixSocket> sok =
+			vmime::dynamicCast <posixSocket>(factory.create());
+
+		VASSERT_TRUE("cache", sok->getAddressCache() == cache);
+		VASSERT_TRUE("happy eyeballs", sok->isHappyEyeballsEnabled());
+	}
+
+	void testHappyEyeballsConnect()
+	{
+		vmime::shared_ptr <posixAddressCache> cache = vmime::make_shared <posixAddressCache>();
+
+		posixSocketFactory factory;
+		factory.setAddressCache(cache);
+		factory.setHappyEyeballsEnabled(true);
+
+		for (int i = 0 ; i < 2 ; ++i)
+		{
+			vmime::shared_ptr <vmime::net::socket> sok = factory.create();
+			sok->connect("127.0.0.1", m_port);
+
+			const int server = ::accept(m_listenDesc, NULL, NULL);
+
+			VASSERT_TRUE("connected", sok->isConnected());
+
+			::send(server, "OK\r\n", 4, 0);
+
+			vmime::byte_t buffer[16];
+			sok->waitForRead(1000);
+
+			VASSERT_EQ("receive", 4, sok->receiveRaw(buffer, sizeof(buffer)));
+
+			sok->disconnect();
+			::close(server);
+		}
+
+		VASSERT_EQ("hits", 1, cache->getHitCount());
+		VASSERT_EQ("misses", 1, cache->getMissCount());
+	}
+
+	void testHappyEyeballsConnectFailure()
+	{
+		// Find a port on which nothing is listening
+		const vmime::port_t port = m_port;
+		::close(m_listenDesc);
+		m_listenDesc = ::socket(AF_INET, SOCK_STREAM, 0);
+
+		vmime::shared_ptr <posixAddressCache> cache = vmime::make_shared <posixAddressCache>();
+
+		posixSocketFactory factory;
+		factory.setAddressCache(cache);
+		factory.setHappyEyeballsEnabled(true);
+
+		vmime::shared_ptr <vmime::net::socket> sok = factory.create();
+
+		VASSERT_THROW("connect", sok->connect("127.0.0.1", port), vmime::exceptions::connection_error);
+
+		// Failed entry is discarded
+		VASSERT_EQ("entries", 0, cache->getEntryCount());
+	}
+
+VMIME_TEST_SUITE_END
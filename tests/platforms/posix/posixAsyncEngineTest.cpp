@@ -0,0 +1,311 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2014 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/platforms/posix/posixAsyncEngine.hpp"
+#include "vmime/net/smtp/SMTPAsyncConnection.hpp"
+
+#if VMIME_HAVE_TLS_SUPPORT
+#	include "vmime/net/tls/TLSSession.hpp"
+#	include "vmime/security/cert/defaultCertificateVerifier.hpp"
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <string.h>
+
+
+/** Records the responses and errors it is notified of.
+  */
+class engineResponseHandler : public vmime::net::asyncResponseHandler
+{
+public:
+
+	engineResponseHandler()
+		: errorCount(0)
+	{
+	}
+
+	void onResponse(vmime::shared_ptr <vmime::net::asyncConnection> /* conn */, const std::vector <vmime::string>& lines)
+	{
+		responses.push_back(lines);
+	}
+
+	void onError(vmime::shared_ptr <vmime::net::asyncConnection> /* conn */, const vmime::exception& /* e */)
+	{
+		++errorCount;
+	}
+
+	std::vector <std::vector <vmime::string> > responses;
+	int errorCount;
+};
+
+
+VMIME_TEST_SUITE_BEGIN(posixAsyncEngineTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testConversation)
+		VMIME_TEST(testManyConnections)
+		VMIME_TEST(testConnectionRefused)
+		VMIME_TEST(testServerClose)
+#if VMIME_HAVE_TLS_SUPPORT
+		VMIME_TEST(testHandshakeDoesNotBlock)
+#endif // VMIME_HAVE_TLS_SUPPORT
+	VMIME_TEST_LIST_END
+
+
+	int m_listenDesc;
+	vmime::port_t m_port;
+
+
+	void setUp()
+	{
+		m_listenDesc = ::socket(AF_INET, SOCK_STREAM, 0);
+
+		::sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+
+		::bind(m_listenDesc, reinterpret_cast <sockaddr*>(&addr), sizeof(addr));
+		::listen(m_listenDesc, 128);
+
+		socklen_t len = sizeof(addr);
+		::getsockname(m_listenDesc, reinterpret_cast <sockaddr*>(&addr), &len);
+
+		m_port = ntohs(addr.sin_port);
+	}
+
+	void tearDown()
+	{
+		::close(m_listenDesc);
+	}
+
+	static const vmime::string receiveLine(const int desc)
+	{
+		vmime::string line;
+		char c;
+
+		while (::recv(desc, &c, 1, 0) == 1 && c != '\n')
+			line += c;
+
+		return line;
+	}
+
+	static void sendString(const int desc, const vmime::string& str)
+	{
+		::send(desc, str.data(), str.length(), 0);
+	}
+
+	// Run the engine until the handler received the specified number of responses
+	static void runUntil(vmime::shared_ptr <vmime::platforms::posix::posixAsyncEngine> engine,
+	                     vmime::shared_ptr <engineResponseHandler> handler, const size_t count)
+	{
+		for (int i = 0 ; i < 100 && handler->responses.size() + handler->errorCount < count ; ++i)
+			engine->runOnce(100);
+	}
+
+
+	void testConversation()
+	{
+		vmime::shared_ptr <vmime::platforms::posix::posixAsyncEngine> engine =
+			vmime::make_shared <vmime::platforms::posix::posixAsyncEngine>();
+		vmime::shared_ptr <vmime::net::smtp::SMTPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::smtp::SMTPAsyncConnection>();
+		vmime::shared_ptr <engineResponseHandler> handler =
+			vmime::make_shared <engineResponseHandler>();
+
+		conn->expectGreeting(handler);
+		conn->hello("client.vmime.org", handler);
+
+		engine->connect(conn, "127.0.0.1", m_port);
+
+		const int serverDesc = ::accept(m_listenDesc, NULL, NULL);
+
+		sendString(serverDesc, "220 Service ready\r\n");
+
+		runUntil(engine, handler, 1);
+
+		VASSERT_EQ("1", 1, handler->responses.size());
+		VASSERT_TRUE("2", conn->isConnected());
+		VASSERT_EQ("3", "EHLO client.vmime.org", receiveLine(serverDesc).substr(0, 21));
+
+		sendString(serverDesc, "250-test.vmime.org\r\n250 PIPELINING\r\n");
+
+		runUntil(engine, handler, 2);
+
+		VASSERT_EQ("4", 2, handler->responses.size());
+		VASSERT_EQ("5", 2, handler->responses[1].size());
+
+		engine->disconnect(conn);
+
+		VASSERT_EQ("6", 0, engine->getConnectionCount());
+		VASSERT_FALSE("7", conn->isConnected());
+
+		::close(serverDesc);
+	}
+
+	void testManyConnections()
+	{
+		const int connCount = 50;
+
+		vmime::shared_ptr <vmime::platforms::posix::posixAsyncEngine> engine =
+			vmime::make_shared <vmime::platforms::posix::posixAsyncEngine>();
+		vmime::shared_ptr <engineResponseHandler> handler =
+			vmime::make_shared <engineResponseHandler>();
+
+		std::vector <int> serverDescs;
+
+		for (int i = 0 ; i < connCount ; ++i)
+		{
+			vmime::shared_ptr <vmime::net::smtp::SMTPAsyncConnection> conn =
+				vmime::make_shared <vmime::net::smtp::SMTPAsyncConnection>();
+
+			conn->expectGreeting(handler);
+
+			engine->connect(conn, "127.0.0.1", m_port);
+
+			const int serverDesc = ::accept(m_listenDesc, NULL, NULL);
+			sendString(serverDesc, "220 Service ready\r\n");
+
+			serverDescs.push_back(serverDesc);
+		}
+
+		VASSERT_EQ("1", connCount, engine->getConnectionCount());
+
+		runUntil(engine, handler, connCount);
+
+		VASSERT_EQ("2", connCount, handler->responses.size());
+
+		for (int i = 0 ; i < connCount ; ++i)
+			::close(serverDescs[i]);
+	}
+
+	void testConnectionRefused()
+	{
+		vmime::shared_ptr <vmime::platforms::posix::posixAsyncEngine> engine =
+			vmime::make_shared <vmime::platforms::posix::posixAsyncEngine>();
+		vmime::shared_ptr <vmime::net::smtp::SMTPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::smtp::SMTPAsyncConnection>();
+		vmime::shared_ptr <engineResponseHandler> handler =
+			vmime::make_shared <engineResponseHandler>();
+
+		conn->expectGreeting(handler);
+
+		// Nobody listens on this port anymore
+		::close(m_listenDesc);
+		m_listenDesc = ::socket(AF_INET, SOCK_STREAM, 0);
+
+		engine->connect(conn, "127.0.0.1", m_port);
+
+		runUntil(engine, handler, 1);
+
+		VASSERT_EQ("1", 1, handler->errorCount);
+		VASSERT_EQ("2", 0, engine->getConnectionCount());
+	}
+
+	void testServerClose()
+	{
+		vmime::shared_ptr <vmime::platforms::posix::posixAsyncEngine> engine =
+			vmime::make_shared <vmime::platforms::posix::posixAsyncEngine>();
+		vmime::shared_ptr <vmime::net::smtp::SMTPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::smtp::SMTPAsyncConnection>();
+		vmime::shared_ptr <engineResponseHandler> handler =
+			vmime::make_shared <engineResponseHandler>();
+
+		conn->expectGreeting(handler);
+
+		engine->connect(conn, "127.0.0.1", m_port);
+
+		::close(::accept(m_listenDesc, NULL, NULL));
+
+		runUntil(engine, handler, 1);
+
+		VASSERT_EQ("1", 1, handler->errorCount);
+		VASSERT_EQ("2", 0, engine->getConnectionCount());
+	}
+
+#if VMIME_HAVE_TLS_SUPPORT
+
+	void testHandshakeDoesNotBlock()
+	{
+		vmime::shared_ptr <vmime::platforms::posix::posixAsyncEngine> engine =
+			vmime::make_shared <vmime::platforms::posix::posixAsyncEngine>();
+		vmime::shared_ptr <engineResponseHandler> handler =
+			vmime::make_shared <engineResponseHandler>();
+
+		engine->setConnectionTimeout(1000);
+
+		// First connection: the server never answers the TLS handshake
+		vmime::shared_ptr <vmime::net::smtp::SMTPAsyncConnection> tlsConn =
+			vmime::make_shared <vmime::net::smtp::SMTPAsyncConnection>();
+
+		tlsConn->expectGreeting(handler);
+
+		vmime::shared_ptr <vmime::net::tls::TLSSession> tlsSession =
+			vmime::net::tls::TLSSession::create
+				(vmime::make_shared <vmime::security::cert::defaultCertificateVerifier>(),
+				 vmime::make_shared <vmime::net::tls::TLSProperties>());
+
+		engine->connectTLS(tlsConn, "127.0.0.1", m_port, tlsSession);
+
+		const int tlsServerDesc = ::accept(m_listenDesc, NULL, NULL);
+
+		// Second connection: plain text, served while the handshake is pending
+		vmime::shared_ptr <vmime::net::smtp::SMTPAsyncConnection> conn =
+			vmime::make_shared <vmime::net::smtp::SMTPAsyncConnection>();
+
+		conn->expectGreeting(handler);
+
+		engine->connect(conn, "127.0.0.1", m_port);
+
+		const int serverDesc = ::accept(m_listenDesc, NULL, NULL);
+
+		sendString(serverDesc, "220 Service ready\r\n");
+
+		runUntil(engine, handler, 1);
+
+		VASSERT_EQ("1", 1, handler->responses.size());
+		VASSERT_EQ("2", 0, handler->errorCount);
+		VASSERT_TRUE("3", conn->isConnected());
+		VASSERT_FALSE("4", tlsConn->isConnected());
+
+		// Then, the handshake times out
+		runUntil(engine, handler, 2);
+
+		VASSERT_EQ("5", 1, handler->errorCount);
+		VASSERT_EQ("6", 1, engine->getConnectionCount());
+
+		::close(serverDesc);
+		::close(tlsServerDesc);
+	}
+
+#endif // VMIME_HAVE_TLS_SUPPORT
+
+VMIME_TEST_SUITE_END
+
@@ -0,0 +1,211 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2014 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/platforms/posix/posixSocketReactor.hpp"
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <string.h>
+
+
+VMIME_TEST_SUITE_BEGIN(posixSocketReactorTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testWaitTimeout)
+		VMIME_TEST(testWaitRead)
+		VMIME_TEST(testUnregister)
+		VMIME_TEST(testAutoRegister)
+		VMIME_TEST(testNotConnected)
+	VMIME_TEST_LIST_END
+
+
+	int m_listenDesc;
+	vmime::port_t m_port;
+
+
+	void setUp()
+	{
+		m_listenDesc = ::socket(AF_INET, SOCK_STREAM, 0);
+
+		::sockaddr_in addr;
+		memset(&addr, 0, sizeof(addr));
+
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		addr.sin_port = 0;
+
+		::bind(m_listenDesc, reinterpret_cast <sockaddr*>(&addr), sizeof(addr));
+		::listen(m_listenDesc, 5);
+
+		socklen_t len = sizeof(addr);
+		::getsockname(m_listenDesc, reinterpret_cast <sockaddr*>(&addr), &len);
+
+		m_port = ntohs(addr.sin_port);
+	}
+
+	void tearDown()
+	{
+		::close(m_listenDesc);
+	}
+
+	// Connect a new socket to the listening socket; returns the server side
+	int connect(vmime::shared_ptr <vmime::platforms::posix::posixSocket> sok)
+	{
+		sok->connect("127.0.0.1", m_port);
+		return ::accept(m_listenDesc, NULL, NULL);
+	}
+
+
+	void testWaitTimeout()
+	{
+		vmime::shared_ptr <vmime::platforms::posix::posixSocketReactor> reactor =
+			vmime::make_shared <vmime::platforms::posix::posixSocketReactor>();
+
+		vmime::shared_ptr <vmime::platforms::posix::posixSocket> sok =
+			vmime::make_shared <vmime::platforms::posix::posixSocket>
+				(vmime::shared_ptr <vmime::net::timeoutHandler>());
+
+		const int serverDesc = connect(sok);
+
+		reactor->registerSocket(sok);
+
+		std::vector <vmime::shared_ptr <vmime::platforms::posix::posixSocket> > ready;
+
+		VASSERT_EQ("1", 1, reactor->getSocketCount());
+		VASSERT_EQ("2", 0, reactor->wait(ready, 10));
+		VASSERT_EQ("3", 0, ready.size());
+
+		::close(serverDesc);
+	}
+
+	void testWaitRead()
+	{
+		vmime::shared_ptr <vmime::platforms::posix::posixSocketReactor> reactor =
+			vmime::make_shared <vmime::platforms::posix::posixSocketReactor>();
+
+		vmime::shared_ptr <vmime::platforms::posix::posixSocket> sok1 =
+			vmime::make_shared <vmime::platforms::posix::posixSocket>
+				(vmime::shared_ptr <vmime::net::timeoutHandler>());
+		vmime::shared_ptr <vmime::platforms::posix::posixSocket> sok2 =
+			vmime::make_shared <vmime::platforms::posix::posixSocket>
+				(vmime::shared_ptr <vmime::net::timeoutHandler>());
+
+		const int serverDesc1 = connect(sok1);
+		const int serverDesc2 = connect(sok2);
+
+		reactor->registerSocket(sok1);
+		reactor->registerSocket(sok2);
+
+		::send(serverDesc2, "data", 4, 0);
+
+		std::vector <vmime::shared_ptr <vmime::platforms::posix::posixSocket> > ready;
+
+		VASSERT_EQ("1", 1, reactor->wait(ready, 1000));
+		VASSERT_EQ("2", 1, ready.size());
+		VASSERT_TRUE("3", ready[0] == sok2);
+
+		vmime::string data;
+		sok2->receive(data);
+
+		VASSERT_EQ("4", "data", data);
+
+		::close(serverDesc1);
+		::close(serverDesc2);
+	}
+
+	void testUnregister()
+	{
+		vmime::shared_ptr <vmime::platforms::posix::posixSocketReactor> reactor =
+			vmime::make_shared <vmime::platforms::posix::posixSocketReactor>();
+
+		vmime::shared_ptr <vmime::platforms::posix::posixSocket> sok1 =
+			vmime::make_shared <vmime::platforms::posix::posixSocket>
+				(vmime::shared_ptr <vmime::net::timeoutHandler>());
+		vmime::shared_ptr <vmime::platforms::posix::posixSocket> sok2 =
+			vmime::make_shared <vmime::platforms::posix::posixSocket>
+				(vmime::shared_ptr <vmime::net::timeoutHandler>());
+
+		const int serverDesc1 = connect(sok1);
+		const int serverDesc2 = connect(sok2);
+
+		reactor->registerSocket(sok1);
+		reactor->registerSocket(sok2);
+
+		reactor->unregisterSocket(sok1);
+		sok2->disconnect();
+
+		VASSERT_EQ("1", 0, reactor->getSocketCount());
+
+		::send(serverDesc1, "data", 4, 0);
+
+		std::vector <vmime::shared_ptr <vmime::platforms::posix::posixSocket> > ready;
+
+		VASSERT_EQ("2", 0, reactor->wait(ready, 10));
+
+		::close(serverDesc1);
+		::close(serverDesc2);
+	}
+
+	void testAutoRegister()
+	{
+		vmime::shared_ptr <vmime::platforms::posix::posixSocketReactor> reactor =
+			vmime::make_shared <vmime::platforms::posix::posixSocketReactor>();
+
+		vmime::platforms::posix::posixSocketFactory factory;
+		factory.setReactor(reactor);
+
+		vmime::shared_ptr <vmime::platforms::posix::posixSocket> sok =
+			vmime::dynamicCast <vmime::platforms::posix::posixSocket>(factory.create());
+
+		VASSERT_EQ("1", 0, reactor->getSocketCount());
+
+		const int serverDesc = connect(sok);
+
+		VASSERT_EQ("2", 1, reactor->getSocketCount());
+
+		sok = vmime::null;
+
+		VASSERT_EQ("3", 0, reactor->getSocketCount());
+
+		::close(serverDesc);
+	}
+
+	void testNotConnected()
+	{
+		vmime::shared_ptr <vmime::platforms::posix::posixSocketReactor> reactor =
+			vmime::make_shared <vmime::platforms::posix::posixSocketReactor>();
+
+		vmime::shared_ptr <vmime::platforms::posix::posixSocket> sok =
+			vmime::make_shared <vmime::platforms::posix::posixSocket>
+				(vmime::shared_ptr <vmime::net::timeoutHandler>());
+
+		VASSERT_THROW("1", reactor->registerSocket(sok),
+			vmime::exceptions::socket_not_connected_exception);
+	}
+
+VMIME_TEST_SUITE_END
+
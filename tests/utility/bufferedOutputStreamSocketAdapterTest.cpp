@@ -0,0 +1,129 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/utility/bufferedOutputStreamSocketAdapter.hpp"
+
+
+VMIME_TEST_SUITE_BEGIN(bufferedOutputStreamSocketAdapterTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testWrite)
+		VMIME_TEST(testSmallWrites)
+		VMIME_TEST(testLargeWrite)
+		VMIME_TEST(testDefaultWatermark)
+	VMIME_TEST_LIST_END
+
+
+	/** A test socket which records the size of each send.
+	  */
+	class countingTestSocket : public testSocket
+	{
+	public:
+
+		void send(const vmime::string& buffer)
+		{
+			sendSizes.push_back(buffer.length());
+			testSocket::send(buffer);
+		}
+
+		std::vector <vmime::size_t> sendSizes;
+	};
+
+
+	void testWrite()
+	{
+		vmime::shared_ptr <countingTestSocket> socket = vmime::make_shared <countingTestSocket>();
+
+		vmime::utility::bufferedOutputStreamSocketAdapter stream(*socket);
+		stream << "some data";
+
+		VASSERT_EQ("Buffered", 0, socket->sendSizes.size());
+		VASSERT_EQ("Buffered size", 9, stream.getBufferedSize());
+
+		stream.flush();
+
+		vmime::string buffer;
+		socket->localReceive(buffer);
+
+		VASSERT_EQ("Write", "some data", buffer);
+		VASSERT_EQ("Send count", 1, socket->sendSizes.size());
+	}
+
+	void testSmallWrites()
+	{
+		vmime::shared_ptr <countingTestSocket> socket = vmime::make_shared <countingTestSocket>();
+
+		vmime::utility::bufferedOutputStreamSocketAdapter stream(*socket, 10);
+
+		for (int i = 0 ; i < 25 ; ++i)
+			stream.write("x", 1);
+
+		stream.flush();
+
+		vmime::string buffer;
+		socket->localReceive(buffer);
+
+		VASSERT_EQ("Write", vmime::string(25, 'x'), buffer);
+		VASSERT_EQ("Send count", 3, socket->sendSizes.size());
+		VASSERT_EQ("Send 1", 10, socket->sendSizes[0]);
+		VASSERT_EQ("Send 2", 10, socket->sendSizes[1]);
+		VASSERT_EQ("Send 3", 5, socket->sendSizes[2]);
+	}
+
+	void testLargeWrite()
+	{
+		vmime::shared_ptr <countingTestSocket> socket = vmime::make_shared <countingTestSocket>();
+
+		vmime::utility::bufferedOutputStreamSocketAdapter stream(*socket, 10);
+
+		stream.write("abc", 3);
+		stream.write("0123456789012345678901234567", 28);
+		stream.write("def", 3);
+		stream.flush();
+
+		vmime::string buffer;
+		socket->localReceive(buffer);
+
+		VASSERT_EQ("Write", "abc0123456789012345678901234567def", buffer);
+
+		// Buffer is completed first, then whole blocks are sent
+		// directly, then the remaining data is buffered
+		VASSERT_EQ("Send count", 3, socket->sendSizes.size());
+		VASSERT_EQ("Send 1", 10, socket->sendSizes[0]);
+		VASSERT_EQ("Send 2", 20, socket->sendSizes[1]);
+		VASSERT_EQ("Send 3", 4, socket->sendSizes[2]);
+	}
+
+	void testDefaultWatermark()
+	{
+		vmime::shared_ptr <countingTestSocket> socket = vmime::make_shared <countingTestSocket>();
+
+		vmime::utility::bufferedOutputStreamSocketAdapter stream(*socket);
+
+		VASSERT_EQ("Watermark", socket->getBlockSize(), stream.getWatermark());
+	}
+
+VMIME_TEST_SUITE_END
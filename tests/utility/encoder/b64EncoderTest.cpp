@@ -30,6 +30,8 @@ VMIME_TEST_SUITE_BEGIN(b64EncoderTest)
 
 	VMIME_TEST_LIST_BEGIN
 		VMIME_TEST(testBase64)
+		VMIME_TEST(testSettings)
+		VMIME_TEST(testFactoryLookup)
 	VMIME_TEST_LIST_END
 
 
@@ -149,5 +151,53 @@ VMIME_TEST_SUITE_BEGIN(b64EncoderTest)
 		}
 	}
 
+	void testSettings()
+	{
+		vmime::shared_ptr <vmime::utility::encoder::encoder> enc = getEncoder("base64");
+
+		VASSERT_EQ("1", static_cast <size_t>(-1), enc->getSettings().maxLineLength);
+		VASSERT_EQ("2", "QUJDREVGR0g=", encode("base64", "ABCDEFGH"));
+
+		// Settings must be updated after properties are modified
+		enc->getProperties()["maxlinelength"] = 8;
+		VASSERT_EQ("3", 8, enc->getSettings().maxLineLength);
+
+		vmime::utility::inputStreamStringAdapter vin("ABCDEFGH");
+
+		std::ostringstream out;
+		vmime::utility::outputStreamAdapter vout(out);
+
+		enc->encode(vin, vout);
+
+		VASSERT_EQ("4", "QUJD\r\nREVG\r\nR0g=\r\n", out.str());
+
+		// Also when modified through a reference obtained before settings were read
+		vmime::propertySet& props = enc->getProperties();
+
+		VASSERT_EQ("5", 8, enc->getSettings().maxLineLength);
+
+		props.setProperty("maxlinelength", 12);
+		VASSERT_EQ("6", 12, enc->getSettings().maxLineLength);
+
+		props.removeProperty("maxlinelength");
+		VASSERT_EQ("7", static_cast <size_t>(-1), enc->getSettings().maxLineLength);
+	}
+
+	void testFactoryLookup()
+	{
+		vmime::shared_ptr <vmime::utility::encoder::encoderFactory> ef =
+			vmime::utility::encoder::encoderFactory::getInstance();
+
+		VASSERT_EQ("1", "base64", ef->getEncoderByName("base64")->getName());
+		VASSERT_EQ("2", "base64", ef->getEncoderByName("BASE64")->getName());
+		VASSERT_EQ("3", "7-bit", ef->getEncoderByName("7-Bit")->getName());
+
+		VASSERT_THROW("4", ef->getEncoderByName("foo"), vmime::exceptions::no_encoder_available);
+
+		// Shared instance is the same for all callers
+		VASSERT("5", ef->getSharedInstance("base64") == ef->getSharedInstance("Base64"));
+		VASSERT("6", ef->create("base64") != ef->create("base64"));
+	}
+
 VMIME_TEST_SUITE_END
 
@@ -167,6 +167,9 @@ VMIME_TEST_SUITE_BEGIN(filteredStreamTest)
 		testFilteredOutputStreamHelper<FILTER>("8", "..\r\nfoobar", ".\r", "\nfoobar");
 		testFilteredOutputStreamHelper<FILTER>("9", ".foobar", ".foobar");
 		testFilteredOutputStreamHelper<FILTER>("10", ".foobar", ".", "foobar");
+		testFilteredOutputStreamHelper<FILTER>("11", "..\r\nfoobar", ".", "\r\nfoobar");
+		testFilteredOutputStreamHelper<FILTER>("12", "foo\n..\r\nbar", "foo\n", ".", "\r\nbar");
+		testFilteredOutputStreamHelper<FILTER>("13", "foo.\r\nbar", "foo.", "\r\nbar");
 	}
 
 	void testCRLFToLFFilteredOutputStream()
@@ -0,0 +1,184 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/utility/metricsRegistry.hpp"
+#include "vmime/utility/outputStreamStringAdapter.hpp"
+
+
+using namespace vmime::utility;
+
+
+VMIME_TEST_SUITE_BEGIN(metricsRegistryTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testCounters)
+		VMIME_TEST(testDurations)
+		VMIME_TEST(testReset)
+		VMIME_TEST(testPrometheus)
+		VMIME_TEST(testDisabled)
+		VMIME_TEST(testSpan)
+		VMIME_TEST(testParse)
+		VMIME_TEST(testTypeName)
+	VMIME_TEST_LIST_END
+
+
+	void testCounters()
+	{
+		metricsRegistry reg;
+
+		reg.count(instrumentation::IMAP_COMMANDS, "FETCH", 1);
+		reg.count(instrumentation::IMAP_COMMANDS, "FETCH", 2);
+		reg.count(instrumentation::IMAP_COMMANDS, "SELECT", 1);
+		reg.count(instrumentation::SOCKET_SENT_BYTES, "", 1234);
+
+		VASSERT_EQ("1", 3, reg.getCounter(instrumentation::IMAP_COMMANDS, "FETCH"));
+		VASSERT_EQ("2", 1, reg.getCounter(instrumentation::IMAP_COMMANDS, "SELECT"));
+		VASSERT_EQ("3", 0, reg.getCounter(instrumentation::IMAP_COMMANDS, "STORE"));
+		VASSERT_EQ("4", 1234, reg.getCounter(instrumentation::SOCKET_SENT_BYTES));
+		VASSERT_EQ("5", 0, reg.getCounter(instrumentation::SOCKET_RECEIVED_BYTES));
+
+		const std::vector <vmime::string> labels = reg.getLabels(instrumentation::IMAP_COMMANDS);
+
+		VASSERT_EQ("6", 2, labels.size());
+		VASSERT_EQ("7", "FETCH", labels[0]);
+		VASSERT_EQ("8", "SELECT", labels[1]);
+	}
+
+	void testDurations()
+	{
+		metricsRegistry reg;
+
+		reg.measure(instrumentation::SMTP_COMMAND_DURATION, "MAIL", 150);
+		reg.measure(instrumentation::SMTP_COMMAND_DURATION, "MAIL", 50);
+		reg.measure(instrumentation::SMTP_COMMAND_DURATION, "DATA", 20000000);
+
+		VASSERT_EQ("1", 2, reg.getDurationCount(instrumentation::SMTP_COMMAND_DURATION, "MAIL"));
+		VASSERT_EQ("2", 200, reg.getDurationSum(instrumentation::SMTP_COMMAND_DURATION, "MAIL"));
+		VASSERT_EQ("3", 1, reg.getDurationCount(instrumentation::SMTP_COMMAND_DURATION, "DATA"));
+		VASSERT_EQ("4", 0, reg.getDurationCount(instrumentation::SMTP_COMMAND_DURATION, "RCPT"));
+	}
+
+	void testReset()
+	{
+		metricsRegistry reg;
+
+		reg.count(instrumentation::POP3_COMMANDS, "RETR", 5);
+		reg.measure(instrumentation::POP3_COMMAND_DURATION, "RETR", 10);
+
+		reg.reset();
+
+		VASSERT_EQ("1", 0, reg.getCounter(instrumentation::POP3_COMMANDS, "RETR"));
+		VASSERT_EQ("2", 0, reg.getDurationCount(instrumentation::POP3_COMMAND_DURATION, "RETR"));
+		VASSERT_EQ("3", 0, reg.getLabels(instrumentation::POP3_COMMANDS).size());
+	}
+
+	void testPrometheus()
+	{
+		metricsRegistry reg;
+
+		reg.count(instrumentation::IMAP_COMMANDS, "UID \"FETCH\"", 2);
+		reg.count(instrumentation::SOCKET_SENT_BYTES, "", 42);
+		reg.measure(instrumentation::TLS_HANDSHAKE_DURATION, "", 200);
+		reg.measure(instrumentation::TLS_HANDSHAKE_DURATION, "", 20000000);
+
+		vmime::string out;
+		outputStreamStringAdapter os(out);
+
+		reg.writePrometheus(os);
+
+		VASSERT("1", out.find("# TYPE vmime_imap_commands_total counter\n") != vmime::string::npos);
+		VASSERT("2", out.find("vmime_imap_commands_total{command=\"UID \\\"FETCH\\\"\"} 2\n") != vmime::string::npos);
+		VASSERT("3", out.find("vmime_socket_sent_bytes_total 42\n") != vmime::string::npos);
+		VASSERT("4", out.find("# TYPE vmime_tls_handshake_duration_seconds histogram\n") != vmime::string::npos);
+		VASSERT("5", out.find("vmime_tls_handshake_duration_seconds_bucket{le=\"0.0001\"} 0\n") != vmime::string::npos);
+		VASSERT("6", out.find("vmime_tls_handshake_duration_seconds_bucket{le=\"0.0005\"} 1\n") != vmime::string::npos);
+		VASSERT("7", out.find("vmime_tls_handshake_duration_seconds_bucket{le=\"10\"} 1\n") != vmime::string::npos);
+		VASSERT("8", out.find("vmime_tls_handshake_duration_seconds_bucket{le=\"+Inf\"} 2\n") != vmime::string::npos);
+		VASSERT("9", out.find("vmime_tls_handshake_duration_seconds_sum 20.0002\n") != vmime::string::npos);
+		VASSERT("10", out.find("vmime_tls_handshake_duration_seconds_count 2\n") != vmime::string::npos);
+	}
+
+	void testDisabled()
+	{
+		instrumentation::setInstance(vmime::null);
+
+		VASSERT_FALSE("1", instrumentation::isEnabled());
+
+		// Must be no-ops
+		instrumentation::increment(instrumentation::SOCKET_SENT_BYTES, "", 10);
+		instrumentation::record(instrumentation::PARSE_DURATION, "header", 10);
+
+		instrumentation::span span(instrumentation::PARSE_DURATION, "header");
+
+		VASSERT_FALSE("2", span.isActive());
+	}
+
+	void testSpan()
+	{
+		vmime::shared_ptr <metricsRegistry> reg = vmime::make_shared <metricsRegistry>();
+		instrumentation::setInstance(reg);
+
+		VASSERT_TRUE("1", instrumentation::isEnabled());
+
+		instrumentation::increment(instrumentation::SOCKET_RECEIVED_BYTES, "", 10);
+
+		{
+			instrumentation::span span(instrumentation::TLS_HANDSHAKE_DURATION);
+
+			VASSERT_TRUE("2", span.isActive());
+		}
+
+		{
+			instrumentation::span span(instrumentation::PARSE_DURATION);
+			span.setLabel("mailbox");
+		}
+
+		instrumentation::setInstance(vmime::null);
+
+		VASSERT_EQ("3", 10, reg->getCounter(instrumentation::SOCKET_RECEIVED_BYTES));
+		VASSERT_EQ("4", 1, reg->getDurationCount(instrumentation::TLS_HANDSHAKE_DURATION));
+		VASSERT_EQ("5", 1, reg->getDurationCount(instrumentation::PARSE_DURATION, "mailbox"));
+	}
+
+	void testParse()
+	{
+		vmime::shared_ptr <metricsRegistry> reg = vmime::make_shared <metricsRegistry>();
+		instrumentation::setInstance(reg);
+
+		vmime::mailbox mbox;
+		mbox.parse("John Doe <john.doe@vmime.org>");
+
+		instrumentation::setInstance(vmime::null);
+
+		VASSERT_EQ("1", 1, reg->getDurationCount(instrumentation::PARSE_DURATION, "mailbox"));
+	}
+
+	void testTypeName()
+	{
+		VASSERT_EQ("1", "mailbox", instrumentation::getTypeName(typeid(vmime::mailbox)));
+		VASSERT_EQ("2", "metricsRegistry", instrumentation::getTypeName(typeid(metricsRegistry)));
+	}
+
+VMIME_TEST_SUITE_END
@@ -0,0 +1,214 @@
+//
+// VMime library (http://www.vmime.org)
+// Copyright (C) 2002-2013 Vincent Richard <vincent@vmime.org>
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License as
+// published by the Free Software Foundation; either version 3 of
+// the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+//
+// Linking this library statically or dynamically with other modules is making
+// a combined work based on this library.  Thus, the terms and conditions of
+// the GNU General Public License cover the whole combination.
+//
+
+#include "tests/testUtils.hpp"
+
+#include "vmime/utility/windowedInputStream.hpp"
+
+
+using namespace vmime::utility;
+
+
+// Serves data from a string and records requests
+class testWindowedInputStream : public windowedInputStream
+{
+public:
+
+	testWindowedInputStream(const vmime::string& data, const bool knownSize = true)
+		: windowedInputStream(knownSize ? data.length() : UNKNOWN_SIZE), m_data(data)
+	{
+	}
+
+	std::vector <std::pair <size_t, size_t> > requests;
+
+protected:
+
+	void fetch(const size_t offset, const size_t length, vmime::string& data)
+	{
+		requests.push_back(std::pair <size_t, size_t>(offset, length));
+
+		if (offset < m_data.length())
+			data = m_data.substr(offset, length);
+	}
+
+private:
+
+	vmime::string m_data;
+};
+
+
+VMIME_TEST_SUITE_BEGIN(windowedInputStreamTest)
+
+	VMIME_TEST_LIST_BEGIN
+		VMIME_TEST(testReadAll)
+		VMIME_TEST(testReadBeginningOnly)
+		VMIME_TEST(testReadAhead)
+		VMIME_TEST(testSeek)
+		VMIME_TEST(testWindowCache)
+		VMIME_TEST(testUnknownSize)
+		VMIME_TEST(testSkip)
+	VMIME_TEST_LIST_END
+
+
+	static const vmime::string makeData(const size_t length)
+	{
+		vmime::string data;
+
+		for (size_t i = 0 ; i < length ; ++i)
+			data += static_cast <char>('a' + i % 26);
+
+		return data;
+	}
+
+	static const vmime::string readAll(inputStream& is)
+	{
+		vmime::string res;
+		vmime::byte_t buffer[7];
+
+		while (!is.eof())
+		{
+			const size_t n = is.read(buffer, sizeof(buffer));
+
+			if (n == 0)
+				break;
+
+			res.append(reinterpret_cast <const char*>(buffer), n);
+		}
+
+		return res;
+	}
+
+
+	void testReadAll()
+	{
+		const vmime::string data = makeData(1000);
+
+		testWindowedInputStream stream(data);
+		stream.setWindowSize(64);
+
+		VASSERT_EQ("data", data, readAll(stream));
+		VASSERT_TRUE("eof", stream.eof());
+		VASSERT_EQ("bytes", 1000, stream.getFetchedBytes());
+	}
+
+	void testReadBeginningOnly()
+	{
+		testWindowedInputStream stream(makeData(100000));
+		stream.setWindowSize(100);
+
+		vmime::byte_t buffer[50];
+
+		VASSERT_EQ("read", 50, stream.read(buffer, 50));
+		VASSERT_EQ("data", "abcdefghij", vmime::string(reinterpret_cast <const char*>(buffer), 10));
+
+		VASSERT_EQ("fetch count", 1, stream.getFetchCount());
+		VASSERT_EQ("fetched bytes", 100, stream.getFetchedBytes());
+	}
+
+	void testReadAhead()
+	{
+		testWindowedInputStream stream(makeData(10000));
+		stream.setWindowSize(100);
+		stream.setMaxReadAhead(800);
+
+		readAll(stream);
+
+		// Window grows while reading sequentially
+		VASSERT_EQ("count", 15, stream.requests.size());
+		VASSERT_EQ("1", 100, stream.requests[0].second);
+		VASSERT_EQ("2", 200, stream.requests[1].second);
+		VASSERT_EQ("3", 400, stream.requests[2].second);
+		VASSERT_EQ("4", 800, stream.requests[3].second);
+		VASSERT_EQ("5", 800, stream.requests[4].second);
+		VASSERT_EQ("offset", 700, stream.requests[3].first);
+	}
+
+	void testSeek()
+	{
+		testWindowedInputStream stream(makeData(10000));
+		stream.setWindowSize(100);
+
+		vmime::byte_t buffer[3];
+
+		stream.seek(5030);
+		VASSERT_EQ("read", 3, stream.read(buffer, 3));
+		VASSERT_EQ("data", makeData(10000).substr(5030, 3),
+			vmime::string(reinterpret_cast <const char*>(buffer), 3));
+		VASSERT_EQ("pos", 5033, stream.getPosition());
+
+		// Aligned window
+		VASSERT_EQ("offset", 5000, stream.requests[0].first);
+		VASSERT_EQ("length", 100, stream.requests[0].second);
+
+		// Read across windows
+		vmime::byte_t buffer2[10];
+
+		stream.seek(9995);
+		VASSERT_EQ("read end", 5, stream.read(buffer2, 10));
+		VASSERT_TRUE("eof", stream.eof());
+	}
+
+	void testWindowCache()
+	{
+		testWindowedInputStream stream(makeData(10000));
+		stream.setWindowSize(100);
+		stream.setCachedWindowCount(2);
+
+		vmime::byte_t c;
+
+		stream.seek(0);    stream.read(&c, 1);
+		stream.seek(5000); stream.read(&c, 1);
+		stream.seek(10);   stream.read(&c, 1);   // cached
+		stream.seek(5050); stream.read(&c, 1);   // cached
+
+		VASSERT_EQ("cached", 2, stream.getFetchCount());
+
+		stream.seek(8000); stream.read(&c, 1);   // evicts window at 0
+		stream.seek(20);   stream.read(&c, 1);
+
+		VASSERT_EQ("evicted", 4, stream.getFetchCount());
+	}
+
+	void testUnknownSize()
+	{
+		const vmime::string data = makeData(250);
+
+		testWindowedInputStream stream(data, /* knownSize */ false);
+		stream.setWindowSize(100);
+
+		VASSERT_EQ("size", windowedInputStream::UNKNOWN_SIZE, stream.getSize());
+		VASSERT_EQ("data", data, readAll(stream));
+		VASSERT_EQ("size 2", 250, stream.getSize());
+	}
+
+	void testSkip()
+	{
+		testWindowedInputStream stream(makeData(1000));
+
+		VASSERT_EQ("skip", 600, stream.skip(600));
+		VASSERT_EQ("skip end", 400, stream.skip(1000));
+		VASSERT_TRUE("eof", stream.eof());
+		VASSERT_EQ("no fetch", 0, stream.getFetchCount());
+	}
+
+VMIME_TEST_SUITE_END